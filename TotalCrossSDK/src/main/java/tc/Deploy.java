@@ -360,6 +360,10 @@ public class Deploy {
           waitIfError = true;
           break;
         case 'p':
+          if (op.equals("/prelink")) {
+            J2TC.prelink = true;
+            break;
+          }
           String type = i >= args.length - 1 ? "" : args[i + 1].toLowerCase();
           // keep compatibility with old sdk by ignoring the parameter after /p
           if (type.startsWith("release") || type.startsWith("demo")) {
@@ -429,6 +433,8 @@ public class Deploy {
         + "   /p      : Package the vm and litebase with the application, creating a single installation file. "
         + "The SDK must be in the path or in the TOTALCROSS3_HOME environment variable. "
         + "The files are always installed at the same folder of the application, so each application will have its own vm.\n"
+        + "   /prelink: Store the tcz uncompressed and aligned, so the vm maps it in memory instead of inflating and copying the classes, and reads each method only when it is first called. "
+        + "The file is bigger, but starts faster and uses less memory on devices that can map files (Linux, Windows, iOS).\n"
         + "   /t      : Just test the classes to see if there are any invalid references. Images are not converted, and nothing is written to disk.\n"
         + "   /v      : Verbose output for information messages\n"
         + "   /w      : Waits for a key press if an error occurs\n"
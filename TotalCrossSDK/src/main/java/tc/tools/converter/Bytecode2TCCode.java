@@ -1927,7 +1927,8 @@ public class Bytecode2TCCode implements JConstants, TCConstants {
           vc.addElement(tc);
           break;
         }
-        case SWITCH: {
+        case SWITCH:
+        case SWITCH_table: {
           Switch_reg i = (Switch_reg) tc;
           vc.addElement(tc);
           int switchIdx = tccodeCount;
@@ -2028,7 +2029,8 @@ public class Bytecode2TCCode implements JConstants, TCConstants {
         i.s24 = newInstructionsCount(newInsts, tccodeCount, tccodeCount + branch) + branch;
         break;
       }
-      case SWITCH: {
+      case SWITCH:
+      case SWITCH_table: {
         Switch_reg i = (Switch_reg) tc;
         int n = i.n;
         // default address
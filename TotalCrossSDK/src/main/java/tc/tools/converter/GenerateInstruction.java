@@ -1092,7 +1092,9 @@ public class GenerateInstruction implements TCConstants {
   }
 
   public static final void newInstruction(Vector vcode, int defAddr, Operand k, BC171_lookupswitch ji, int line) {
-    Switch_reg sswitch = new Switch_reg(SWITCH, line);
+    int n = ji.npairs;
+    boolean dense = n > 0 && ji.values[n - 1] - ji.values[0] == n - 1; // keys are sorted and unique, so they are consecutive
+    Switch_reg sswitch = new Switch_reg(dense ? SWITCH_table : SWITCH, line);
     sswitch.len = 2 + ji.npairs + (ji.npairs + 1) / 2;
     sswitch.params = new Parameter[sswitch.len - 1];
     // promote key to register
@@ -1103,7 +1105,7 @@ public class GenerateInstruction implements TCConstants {
   }
 
   public static final void newInstruction(Vector vcode, int defAddr, Operand index, BC170_tableswitch ji, int line) {
-    Switch_reg sswitch = new Switch_reg(SWITCH, line);
+    Switch_reg sswitch = new Switch_reg(SWITCH_table, line); // the keys go from low to high
     int n = ji.jumps.length; // number of keys
     sswitch.len = 2 + n + (n + 1) / 2;
     sswitch.params = new Parameter[sswitch.len - 1];
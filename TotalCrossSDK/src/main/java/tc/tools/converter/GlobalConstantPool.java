@@ -733,8 +733,24 @@ public class GlobalConstantPool implements tc.tools.converter.tclass.TClassConst
     }
     sc = size - sc;
     ss = size;
-    // Strings
-    for (i = 1; i < strCount; i++) // String constants must be the last written
+    size += writeStrings(ds, strCount, dump); // String constants must be the last written
+    ss = size - ss;
+
+    if (J2TC.dump) {
+      System.out.println("\nConstant pool size: " + size + " (int=" + si + ",long=" + sl + ",double=" + sd
+          + ",static field=" + ssf + ",instance field=" + sif + ",method ref=" + sm + ",method/field names=" + smf
+          + ",class names=" + sc + ",string=" + ss + ")\n");
+    }
+    if (clsCount > 1000 || mtdCount > 1000 || SFCount > 1000 || IFCount > 1000) {
+      System.out.println("Total References - Classes: " + clsCount + ", Methods: " + mtdCount + ", instance fields: "
+          + IFCount + " (each one limited to 4095)");
+    }
+  }
+
+  private static int writeStrings(DataStreamLE ds, int strCount, boolean dump) throws totalcross.io.IOException {
+    TCValue v;
+    int size = 0;
+    for (int i = 1; i < strCount; i++) // String constants must be the last written
     {
       v = (TCValue) vStr.items[i];
       String s = v.asStr;
@@ -764,17 +780,116 @@ public class GlobalConstantPool implements tc.tools.converter.tclass.TClassConst
         System.out.println("str[" + v.index + "] : " + s + " " + (size - s0));
       }
     }
-    ss = size - ss;
+    return size;
+  }
 
-    if (J2TC.dump) {
-      System.out.println("\nConstant pool size: " + size + " (int=" + si + ",long=" + sl + ",double=" + sd
-          + ",static field=" + ssf + ",instance field=" + sif + ",method ref=" + sm + ",method/field names=" + smf
-          + ",class names=" + sc + ",string=" + ss + ")\n");
+  private static void writeArrayLength(DataStreamLE ds, int count) throws totalcross.io.IOException {
+    Storage.align(ds, 8);
+    ds.writeInt(count); // twice, so the vm reads the same length with 32 and 64-bit sizes
+    ds.writeInt(count);
+  }
+
+  private static void writeZeroTerminated(DataStreamLE ds, Vector v, int count, boolean isCls) throws totalcross.io.IOException {
+    int partSize = 0;
+    for (int i = 1; i < count; i++) {
+      String s = ((TCValue) v.items[i]).asStr;
+      partSize += 2 + (isCls && s.charAt(0) == '&' ? s.length() - 1 : s.length());
     }
-    if (clsCount > 1000 || mtdCount > 1000 || SFCount > 1000 || IFCount > 1000) {
-      System.out.println("Total References - Classes: " + clsCount + ", Methods: " + mtdCount + ", instance fields: "
-          + IFCount + " (each one limited to 4095)");
+    Storage.align(ds, 4);
+    ds.writeInt(partSize);
+    for (int i = 1; i < count; i++) {
+      String s = ((TCValue) v.items[i]).asStr;
+      ds.writeSmallString(isCls && s.charAt(0) == '&' ? s.substring(1) : s); // remove the & from the primitives
+      ds.writeByte(0);
+    }
+  }
+
+  /** Writes the constant pool in the prelinked layout, used in place by the vm when the tcz is mapped in memory:
+   * the arrays are 8-byte aligned and preceded by their length, include the unused first element, and the field
+   * references are not delta encoded; the method and class names are zero terminated. The Strings are written
+   * as in the compressed layout, since the vm creates objects for them anyway.
+   * @since TotalCross 6.1.1
+   */
+  public static void writePrelinked(DataStreamLE ds) throws totalcross.io.IOException {
+    int i32Count = vI32.size();
+    int dblCount = dCount;
+    int i64Count = lCount;
+    int mtdCount = vMtd.size();
+    int clsCount = vCls.size();
+    int SFCount = vSF.size();
+    int IFCount = vIF.size();
+    int mtdfldCount = vMtdFld.size();
+    int strCount = vStr.size();
+    int i;
+    ds.writeShort(i32Count);
+    ds.writeShort(i64Count);
+    ds.writeShort(dblCount);
+    ds.writeShort(clsCount);
+    ds.writeShort(SFCount);
+    ds.writeShort(IFCount);
+    ds.writeShort(mtdCount);
+    ds.writeShort(mtdfldCount);
+    ds.writeShort(strCount);
+
+    if (i32Count > 0) {
+      writeArrayLength(ds, i32Count);
+      ds.writeInt(0);
+      for (i = 1; i < i32Count; i++) {
+        ds.writeInt(((TCValue) vI32.items[i]).asInt);
+      }
+    }
+    if (i64Count > 0) {
+      writeArrayLength(ds, i64Count);
+      ds.writeLong(0);
+      for (i = 1; i < i64Count; i++) {
+        ds.writeLong(((TCValue) vI64.items[i]).asLong);
+      }
+    }
+    if (dblCount > 0) {
+      writeArrayLength(ds, dblCount);
+      ds.writeDouble(0);
+      for (i = 1; i < dblCount; i++) {
+        ds.writeDouble(((TCValue) vDbl.items[i]).asDouble);
+      }
+    }
+    Vector[] fields = { vSF, vIF };
+    int[] fieldCounts = { SFCount, IFCount };
+    for (int f = 0; f < 2; f++) {
+      Vector v = fields[f];
+      int n = fieldCounts[f];
+      if (n > 0) {
+        writeArrayLength(ds, n); // field
+        ds.writeShort(0);
+        for (i = 1; i < n; i++) {
+          ds.writeShort(((TCValue) v.items[i]).asInt & 0xFFFF);
+        }
+        writeArrayLength(ds, n); // class
+        ds.writeShort(0);
+        for (i = 1; i < n; i++) {
+          ds.writeShort((((TCValue) v.items[i]).asInt >> 16) & 0xFFFF);
+        }
+      }
+    }
+    if (mtdCount > 0) {
+      int partSize = 0;
+      writeArrayLength(ds, mtdCount);
+      ds.writeByte(0);
+      for (i = 1; i < mtdCount; i++) {
+        int[] s = (int[]) ((TCValue) vMtd.items[i]).asObj;
+        ds.writeByte(s.length - 2);
+        partSize += s.length * 2;
+      }
+      if (mtdCount > 1) {
+        Storage.align(ds, 4);
+        ds.writeInt(partSize);
+        for (i = 1; i < mtdCount; i++) {
+          Storage.writeUnsignedShortArray(ds, (int[]) ((TCValue) vMtd.items[i]).asObj);
+        }
+      }
     }
+    writeZeroTerminated(ds, vMtdFld, mtdfldCount, false);
+    writeZeroTerminated(ds, vCls, clsCount, true);
+    writeStrings(ds, strCount, J2TC.dump);
   }
 
   public static boolean isEmpty() // guich@tc111_2: returns if it contains at least one user class
@@ -65,7 +65,6 @@ import totalcross.crypto.cipher.AESCipher;
 import totalcross.crypto.cipher.AESKey;
 import totalcross.crypto.cipher.Cipher;
 import totalcross.io.ByteArrayStream;
-import totalcross.io.DataStream;
 import totalcross.io.DataStreamLE;
 import totalcross.io.File;
 import totalcross.io.IOException;
@@ -86,6 +85,8 @@ public final class J2TC implements JConstants, TCConstants {
   private static String totalcrossService = "totalcross/Service";
   private static String totalcrossUiMainWindow = "totalcross/ui/MainWindow";
   public static boolean dump, dumpBytecodes;
+  /** Creates a prelinked tcz: chunks are stored uncompressed and aligned, so the vm can map them. */
+  public static boolean prelink;
   /** The output converted TCClass */
   public TCClass converted;
   /** The bytes of the stored class */
@@ -116,7 +117,7 @@ public final class J2TC implements JConstants, TCConstants {
       tcbasz.reset();
       converted.write(new DataStreamLE(tcbas));
       //if (dump) {System.out.println(jc.className); byte[] bytes = tcbas.toByteArray(); System.out.println(TCZ.toString(bytes,0,bytes.length));}
-      tc.tools.converter.Storage.compressAndWrite(tcbas, new DataStream(tcbasz));
+      Storage.packAndWrite(tcbas, tcbasz, prelink);
       bytes = tcbasz.toByteArray();
     } else {
       Utils.println("Replacing " + jc.className + " by its 4D");
@@ -155,7 +156,7 @@ public final class J2TC implements JConstants, TCConstants {
       byte[] bytes = tcbas.toByteArray();
       System.out.println(Utils.toString(bytes, 0, bytes.length));
     }
-    tc.tools.converter.Storage.compressAndWrite(tcbas, new DataStream(tcbasz));
+    Storage.packAndWrite(tcbas, tcbasz, prelink);
     bytes = tcbasz.toByteArray();
   }
 
@@ -947,7 +948,7 @@ public final class J2TC implements JConstants, TCConstants {
             System.out.print(" (converted to PNG)");
           }
 
-          tc.tools.converter.Storage.compressAndWrite(basz, new DataStream(tcbasz));
+          Storage.packAndWrite(basz, tcbasz, prelink);
           bytes = tcbasz.toByteArray();
           vout.addElement(new TCZ.Entry(bytes, name, len)); // note that all files must be added
         }
@@ -1296,9 +1297,13 @@ public final class J2TC implements JConstants, TCConstants {
           // convert the global constant pool
           tcbas.reset();
           tcbasz.reset();
-          GlobalConstantPool.write(new DataStreamLE(tcbas));
+          if (prelink) {
+            GlobalConstantPool.writePrelinked(new DataStreamLE(tcbas));
+          } else {
+            GlobalConstantPool.write(new DataStreamLE(tcbas));
+          }
           int orig = tcbas.getPos();
-          Storage.compressAndWrite(tcbas, new DataStream(tcbasz));
+          Storage.packAndWrite(tcbas, tcbasz, prelink);
           vout.addElement(new TCZ.Entry(tcbasz.toByteArray(), "ConstantPool", orig));
         }
         // now that all files were processed, put everything in a single tcz file.
@@ -1318,6 +1323,9 @@ public final class J2TC implements JConstants, TCConstants {
         } else {
           cn = fName;
         }
+        if (prelink) {
+          attr |= TCZ.ATTR_PRELINKED;
+        }
         if (DeploySettings.resizableWindow) {
           attr |= TCZ.ATTR_RESIZABLE_WINDOW;
         }
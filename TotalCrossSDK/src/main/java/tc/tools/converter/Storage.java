@@ -5,6 +5,7 @@
 package tc.tools.converter;
 
 import totalcross.io.ByteArrayStream;
+import totalcross.io.DataStream;
 import totalcross.io.DataStreamLE;
 import totalcross.io.IOException;
 import totalcross.io.Stream;
@@ -28,6 +29,41 @@ public final class Storage {
     ZLib.deflate(bufIn, dsOut, 9); // the smaller the compression level, the slower is the vm's startup
   }
 
+  /** Compresses the buffer into the output, or copies it as is if the chunk goes to a prelinked tcz. */
+  public static void packAndWrite(ByteArrayStream bufIn, ByteArrayStream bufOut, boolean prelinked) throws IOException {
+    if (!prelinked) {
+      compressAndWrite(bufIn, new DataStream(bufOut));
+    } else {
+      if (bufIn.getPos() > 0) {
+        bufIn.mark();
+      }
+      bufOut.writeBytes(bufIn.getBuffer(), bufIn.getPos(), bufIn.available());
+    }
+  }
+
+  /** Pads the chunk being written with zeros up to a multiple of n. Used by the prelinked layout, whose
+   * chunks start aligned in the tcz. */
+  public static int align(DataStreamLE ds, int n) throws IOException {
+    int pad = (n - ((ByteArrayStream) ds.getStream()).getPos() % n) % n;
+    return pad > 0 ? ds.pad(pad) : 0;
+  }
+
+  /** Writes a placeholder for the size of what is written next, returning where it starts. Used by the prelinked
+   * layout, so the vm can skip parts that it reads later. */
+  public static int beginSize(DataStreamLE ds) throws IOException {
+    ds.writeInt(0);
+    return ((ByteArrayStream) ds.getStream()).getPos();
+  }
+
+  /** Fills the placeholder written by {@link #beginSize} with the number of bytes written since then. */
+  public static void endSize(DataStreamLE ds, int start) throws IOException {
+    ByteArrayStream bas = (ByteArrayStream) ds.getStream();
+    int end = bas.getPos();
+    bas.setPos(start - 4);
+    ds.writeInt(end - start);
+    bas.setPos(end);
+  }
+
   /** ******************************************** */
   /** UTILITY * */
   /**
@@ -32,7 +32,7 @@ public interface TCConstants extends tc.tools.converter.tclass.TClassConstants {
       "RETURN_reg64", "RETURN_void", "RETURN_s24I", "RETURN_null", "RETURN_s24D", "RETURN_s24L", "RETURN_symI",
       "RETURN_symO", "RETURN_symD", "RETURN_symL", "SWITCH", "NEWARRAY_len", "NEWARRAY_regI", "NEWARRAY_multi",
       "NEWOBJ", "THROW", "INSTANCEOF", "CHECKCAST", "CALL_normal", "CALL_virtual", "JUMP_regI", "MONITOR_Enter",
-      "MONITOR_Exit" };
+      "MONITOR_Exit", "MONITOR_Enter2", "MONITOR_Exit2", "SWITCH_table" };
 
   // Opcodes
   public static final int BREAK = 0;
@@ -195,6 +195,8 @@ public interface TCConstants extends tc.tools.converter.tclass.TClassConstants {
   public static final int MONITOR_Exit = 157;
   public static final int MONITOR_Enter2 = 158;
   public static final int MONITOR_Exit2 = 159;
+  /** Same format of SWITCH, but with consecutive keys, so the target is found by indexing instead of a binary search */
+  public static final int SWITCH_table = 160;
 
   public static final int INSTRUCTION_NOT_FOUND = 255;
 
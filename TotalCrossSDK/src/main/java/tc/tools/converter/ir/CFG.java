@@ -46,7 +46,8 @@ final public class CFG implements TCConstants {
         tc = (Instruction) methodCode.items[i];
         int op = tc.opcode;
         switch (op) {
-        case SWITCH: {
+        case SWITCH:
+        case SWITCH_table: {
           Switch_reg inst = (Switch_reg) tc;
           BasicBlock bb = new BasicBlock("SWITCH", this, first, tc, null, null);
           bb.instCases = new Instruction[inst.n + 1];
@@ -363,7 +364,8 @@ final public class CFG implements TCConstants {
       tc = (Instruction) methodCode.items[i];
       int op = tc.opcode;
       switch (op) {
-      case SWITCH: {
+      case SWITCH:
+      case SWITCH_table: {
         Switch_reg inst = (Switch_reg) tc;
         bb = new BasicBlock("SWITCH", this, first, tc, null, null);
         bb.instCases = new Instruction[inst.n + 1];
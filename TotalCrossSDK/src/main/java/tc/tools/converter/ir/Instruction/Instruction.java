@@ -489,7 +489,8 @@ public class Instruction implements TCConstants {
     }
 
     //switch_reg
-    case SWITCH: {
+    case SWITCH:
+    case SWITCH_table: {
       Switch_reg inst = (Switch_reg) this;
       bits[0].on(inst.key);
       break;
@@ -1053,7 +1054,8 @@ public class Instruction implements TCConstants {
     }
 
     //switch_reg
-    case SWITCH: {
+    case SWITCH:
+    case SWITCH_table: {
       Switch_reg inst = (Switch_reg) this;
       inst.key = adjListI[inst.key].color;
       break;
@@ -112,7 +112,8 @@ public final class TCCode implements TCConstants {
             printAsX8x8x8x8Count = len - 1;
           }
           break;
-        case SWITCH: {
+        case SWITCH:
+        case SWITCH_table: {
           sbt.append(" - Informations of Switch Table are next ").append(len - 1).append(" instructions");
           printSwitchDefaultAddress = 1;
           printSwitchKeyCount = x8x16_2();
@@ -123,8 +123,16 @@ public final class TCMethod implements TCConstants {
     if (paramCount > 0) {
       Storage.writeUnsignedShortArray(ds, cpParams);
     }
+    // in a prelinked tcz, the size of the code, exception handlers and line numbers comes first, so the vm can skip
+    // them and read them only when the method is called
+    int bodyStart = J2TC.prelink ? Storage.beginSize(ds) : 0;
     // write the opcodes array - native methods have none
     if (opcodeCount > 0) {
+      if (J2TC.prelink) { // the vm uses the code in place: align it and precede it by the array length
+        Storage.align(ds, 8);
+        ds.writeInt(opcodeCount);
+        ds.writeInt(opcodeCount);
+      }
       Storage.writeIntArray(ds, opcode); // note that the bit fields are inverted when comparing to Java, so we store them in inverse order
       checkMethodInvocations();
     }
@@ -168,6 +176,9 @@ public final class TCMethod implements TCConstants {
         }
       }
     }
+    if (J2TC.prelink) {
+      Storage.endSize(ds, bodyStart);
+    }
   }
 
   private int[] getCode() {
@@ -36,7 +36,12 @@ import totalcross.util.regex.Pattern;
  */
 
 public final class String4D implements Comparable<String4D>, CharSequence {
+  // when Vm.TWEAK_COMPACT_STRINGS is on, this may be a byte array holding the chars of a Latin-1 string. So, it must
+  // never be indexed here: use charAt, copyChars or toUTF16 instead.
   char chars[];
+  // the hash code of the chars, computed by the vm in the first call to hashCode() and kept in the low 32 bits; bit 32
+  // is set once it is stored. A long is used so that chars remains the first field.
+  long hashCache;
   
   private static Charset lastCharset;
 
@@ -63,12 +68,7 @@ public final class String4D implements Comparable<String4D>, CharSequence {
 
   /** Creates a string from the given character array. */
   public String4D(char c[]) {
-    int count = c.length;
-    this.chars = new char[count];
-    // prevent null access error if len = 0 or ac is null. (added by dgecawich 7/9/01)
-    if (count > 0) {
-      copyChars(c, 0, this.chars, 0, count);
-    }
+    this.chars = copyOf(c, 0, c.length);
   }
 
   /**
@@ -87,11 +87,7 @@ public final class String4D implements Comparable<String4D>, CharSequence {
       throw new IndexOutOfBoundsException();
     }
 
-    this.chars = new char[count];
-    // prevent null access error if len = 0 or ac is null. (added by dgecawich 7/9/01)
-    if (count > 0) {
-      copyChars(value, offset, this.chars, 0, count);
-    }
+    this.chars = copyOf(value, offset, count);
   }
 
   /** Creates a string from the given byte array. The bytes are converted to char using the CharacterConverter 
@@ -102,7 +98,7 @@ public final class String4D implements Comparable<String4D>, CharSequence {
    */
   public String4D(byte[] value, int offset, int count) {
     try {
-      chars = Convert.charConverter.bytes2chars(value, offset, count);
+      chars = compact(Convert.charConverter.bytes2chars(value, offset, count));
     } catch (ArrayIndexOutOfBoundsException aioobe) // guich@tc123_33
     {
       throw new StringIndexOutOfBoundsException(
@@ -116,7 +112,7 @@ public final class String4D implements Comparable<String4D>, CharSequence {
             if (charset instanceof AbstractCharacterConverter) {
                 chars = ((AbstractCharacterConverter) charset).bytes2chars(value, offset, count);
             }
-            chars = Convert.charConverter.bytes2chars(value, offset, count);
+            chars = compact(Convert.charConverter.bytes2chars(value, offset, count));
         } catch (ArrayIndexOutOfBoundsException aioobe) {
             throw new IndexOutOfBoundsException(
                     "value: " + value.length + " bytes length, offset: " + offset + ", count: " + count);
@@ -131,21 +127,13 @@ public final class String4D implements Comparable<String4D>, CharSequence {
    */
   public String4D(byte[] value) {
     try {
-      chars = Convert.charConverter.bytes2chars(value, 0, value.length);
+      chars = compact(Convert.charConverter.bytes2chars(value, 0, value.length));
     } catch (ArrayIndexOutOfBoundsException aioobe) // guich@tc123_33
     {
       throw new StringIndexOutOfBoundsException(aioobe.getMessage());
     }
   }
 
-  /**
-   * Private constructor which shares value array for speed. Used by concat().
-   */
-  private String4D(char value[], boolean dummy) // dummy is just to distinguish from the original constructor
-  {
-    this.chars = value;
-  }
-
   /**
    * Creates a new String using the character sequence represented by
    * the StringBuffer. Subsequent changes to buf do not affect the String.
@@ -154,8 +142,7 @@ public final class String4D implements Comparable<String4D>, CharSequence {
    * @throws NullPointerException if buffer is null
    */
   public String4D(StringBuffer4D buffer) {
-    chars = new char[buffer.count];
-    String4D.copyChars(buffer.charbuf, 0, chars, 0, chars.length);
+    chars = copyOf(buffer.charbuf, 0, buffer.count);
   }
 
   /** Returns the length of the string in characters. */
@@ -167,22 +154,15 @@ public final class String4D implements Comparable<String4D>, CharSequence {
   /** Returns the character at the given position. */
   @Override
   public char charAt(int i) {
+    Object c = chars;
+    if (c instanceof byte[]) { // only while Vm.TWEAK_COMPACT_STRINGS is on
+      return (char) (((byte[]) c)[i] & 0xFF);
+    }
     return chars[i];
   }
 
   /** Concatenates the given string to this string and returns the result. */
-  public String4D concat(String4D s) {
-    // changed by dgecawich on 5/14/01 because a = a + "something" or a += "something" caused a stack overflow
-    int otherLen = s != null ? s.chars.length : 0;
-    if (otherLen == 0) {
-      return this;
-    }
-    int curLength = chars.length;
-    char buf[] = new char[curLength + otherLen];
-    getChars(0, curLength, buf, 0);
-    s.getChars(0, otherLen, buf, curLength);
-    return new String4D(buf, true);
-  }
+  native public String4D concat(String4D s);
 
   /**
    * Returns this string as a character array. The array returned is allocated 
@@ -310,13 +290,13 @@ public final class String4D implements Comparable<String4D>, CharSequence {
    * @since SuperWaba 2.0 beta 4 
    */
   public byte[] getBytes() {
-    return Convert.charConverter.chars2bytes(chars, 0, chars.length);
+    return Convert.charConverter.chars2bytes(toUTF16(chars), 0, chars.length);
   }
 
   public byte[] getBytes(Charset charset) {
     if (charset instanceof AbstractCharacterConverter) {
       AbstractCharacterConverter converter = (AbstractCharacterConverter) charset;
-      return converter.chars2bytes(chars, 0, chars.length);
+      return converter.chars2bytes(toUTF16(chars), 0, chars.length);
     }
     return getBytes();
   }
@@ -380,6 +360,15 @@ public final class String4D implements Comparable<String4D>, CharSequence {
   /** Copies the specified srcArray to dstArray */
   native static boolean copyChars(char[] srcArray, int srcStart, char[] dstArray, int dstStart, int length);
 
+  /** Returns a copy of the given range of chars, which is a byte array if the string can be compact. */
+  native static char[] copyOf(char[] src, int start, int count);
+
+  /** Returns the given chars as a byte array if the string can be compact, or the chars themselves otherwise. */
+  native static char[] compact(char[] chars);
+
+  /** Returns the chars of a compact string widened to a new char array, or the chars themselves otherwise. */
+  native static char[] toUTF16(char[] chars);
+
   /** Returns the index of the specified string in this string starting from the given index, or -1 if not found. */
   native public int indexOf(String4D c, int startIndex);
 
@@ -410,7 +399,7 @@ public final class String4D implements Comparable<String4D>, CharSequence {
     }
     int i = chars.length;
     while (--i >= 0) {
-      if (chars[i] != buffer.charbuf[i]) {
+      if (charAt(i) != buffer.charbuf[i]) {
         return false;
       }
     }
@@ -473,8 +462,8 @@ public final class String4D implements Comparable<String4D>, CharSequence {
       return false;
     }
     while (--len >= 0) {
-      char c1 = chars[toffset++];
-      char c2 = other.chars[ooffset++];
+      char c1 = charAt(toffset++);
+      char c2 = other.charAt(ooffset++);
       // Note that checking c1 != c2 is redundant when ignoreCase is true,
       // but it avoids method calls.
       if (c1 != c2 && (!ignoreCase || (Convert.toLowerCase(c1) != Convert.toLowerCase(c2)
@@ -584,7 +584,7 @@ public final class StringBuffer4D {
     int len = other.chars.length;
     int index = 0;
     while (--len >= 0) {
-      if (charbuf[toffset++] != other.chars[index++]) {
+      if (charbuf[toffset++] != other.charAt(index++)) {
         return false;
       }
     }
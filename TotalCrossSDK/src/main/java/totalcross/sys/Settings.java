@@ -653,6 +653,27 @@ public final class Settings {
    */
   public static int chunksCreated;
 
+  /** Longest time, in microseconds, that the application was paused by the GC. With the incremental GC, this is 
+   * the longest slice. Updated by the VM during the application execution.
+   * @see Vm#TWEAK_INCREMENTAL_GC
+   * @since TotalCross 6.1.1
+   */
+  public static int gcMaxPause;
+
+  /** Time, in microseconds, of the last pause caused by the GC (a full collection or a single slice of the 
+   * incremental GC). Updated by the VM during the application execution.
+   * @see Vm#TWEAK_INCREMENTAL_GC
+   * @since TotalCross 6.1.1
+   */
+  public static int gcLastPause;
+
+  /** Maximum time, in microseconds, that each slice of the incremental GC may take. The final slice, which
+   * revisits the roots and frees the objects, may take longer.
+   * @see Vm#TWEAK_INCREMENTAL_GC
+   * @since TotalCross 6.1.1
+   */
+  public static int gcSliceBudget = 2000;
+
   /** Time when the user last interacted with the device using the keyboard, pen, trackball, etc.
    * @since TotalCross 1.14
    */
@@ -638,6 +638,102 @@ public final class Vm {
    */
   public static final int TWEAK_TRACE_METHODS = 8;
 
+  /** Allocates the small objects in a nursery that is collected separately from the rest of the heap.
+   * Most objects die young, so these minor collections are much faster than a full one, and
+   * the allocation itself is just a pointer increment. The objects that survive are moved to the
+   * regular heap. Turning it off runs a full gc and gives the nursery back to the heap.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_GENERATIONAL_GC = 9;
+
+  /** Splits the marking phase of the garbage collector in small slices, which run when the event loop is idle.
+   * This reduces the pauses while the user interacts with the application (during a scroll, for example).
+   * Each slice takes at most {@link Settings#gcSliceBudget} microseconds; the last one, which frees the objects,
+   * may take longer. Use {@link Settings#gcMaxPause} and {@link Settings#gcLastPause} to check the pauses.
+   * Turning it off finishes the current cycle.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_INCREMENTAL_GC = 10;
+
+  /** Counts how the virtual and interface method calls are dispatched between two consecutive calls. For example:
+   * <pre>
+   * Vm.tweak(Vm.TWEAK_INLINE_CACHE_STATS,true);
+   * // now run the program during some time
+   * Vm.tweak(Vm.TWEAK_INLINE_CACHE_STATS,false);
+   * </pre>
+   * When set off, it prints to the debug console the number of calls found in the inline caches (hits), the ones
+   * that had to search the method (misses) and the ones dispatched through the class' table because
+   * the call site saw too many classes (megamorphic). The message is prefixed with P, like the ones of
+   * {@link #TWEAK_MEM_PROFILER}.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_INLINE_CACHE_STATS = 11;
+
+  /** Compiles the methods that are called often to native code, which runs loops with integer and array
+   * operations several times faster. It is available on Linux for x86-64 and ARM64; elsewhere, this flag is ignored.
+   * The native code returns to the interpreter on method calls, allocations, floating point and exceptions,
+   * so these parts run at the usual speed. Turn it on at the start of the application:
+   * <pre>
+   * Vm.tweak(Vm.TWEAK_JIT,true);
+   * </pre>
+   * Methods already compiled keep running the native code if it is turned off.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_JIT = 12;
+
+  /** Uses one thread per processor (up to 4) in the garbage collector, when the heap has at least 8MB. The objects
+   * are marked and freed by all threads, so the pauses of big heaps get shorter on multi-core devices.
+   * The finalizers still run in a single thread. This flag is ignored on single-core devices.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_PARALLEL_GC = 13;
+
+  /** Stores the strings whose chars all fit in Latin-1 (0 to 255), like most identifiers, SQL and JSON, in byte arrays
+   * instead of char arrays, halving the memory they take; comparing, hashing and searching these strings also gets
+   * faster. Applies to the strings created after it is turned on; a compact string passed to a native method that
+   * doesn't understand it is widened when first used. Turn it on at the start of the application:
+   * <pre>
+   * Vm.tweak(Vm.TWEAK_COMPACT_STRINGS,true);
+   * </pre>
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_COMPACT_STRINGS = 14;
+
+  /** Makes the strings with the same contents share a single char array after each garbage collection. Only the
+   * strings whose hashCode was already called are checked, so this mostly applies to the keys of hashtables and to
+   * the strings that are compared often; the arrays that are no longer used are freed by the next collection.
+   * Useful for applications that keep many copies of the same strings, like the ones read from databases or
+   * translation files.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_STRING_DEDUP = 15;
+
+  /** Samples the call stacks of the running threads each 10 ms. When turned off, or when the application exits,
+   * the stacks are written to the file &lt;appPath&gt;/&lt;main class&gt;.folded, in the collapsed format read by the
+   * flame graph tools, with the source line of each method when the class was compiled with debug information.
+   * The profiler can also be turned on at startup by setting the TC_CPU_PROFILE environment variable to the
+   * sampling interval in milliseconds.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_CPU_PROFILER = 16;
+
+  /** Samples one allocation each 512 KB, recording the class of the object and the method and line that created it.
+   * When turned off, or when the application exits, the sites are written to the file
+   * &lt;appPath&gt;/&lt;main class&gt;.allocs.csv, with the number of samples and the estimated bytes allocated by each
+   * one. The profiler can also be turned on at startup by setting the TC_ALLOC_PROFILE environment variable to the
+   * sampling interval in bytes.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_ALLOC_PROFILER = 17;
+
+  /** Runs the garbage collector and writes a histogram of the live objects, and writes another one after each
+   * full collection while this tweak is on. Each histogram is written to &lt;appPath&gt;/&lt;main class&gt;.heapN.csv
+   * (N = 1, 2, ...) with the number of instances of each class, their size and the size of the objects that are
+   * only reachable through them, sorted by class, so the files of two versions of the application can be compared.
+   * @since TotalCross 6.1.1
+   */
+  public static final int TWEAK_HEAP_HISTOGRAM = 18;
+
   /**
    * Tweak some parameters of the virtual machine. Note that these
    * parameters are only available at the device, NOT when running as Java.
@@ -774,6 +870,28 @@ public final class Vm {
   public static void preallocateArray(Object sample, int length) {
   }
 
+  /** Saves the static fields of the classes loaded so far, and the objects reachable from them, so the next
+   * launches can restore them instead of loading these classes and running their static initializers. Call it at
+   * the point where the application finished its initialization, for example, after the first screen is shown:
+   * <pre>
+   * if (firstRun)
+   *    Vm.saveStartupSnapshot();
+   * </pre>
+   * The snapshot is written to a file named after the main class with the <code>.tcs</code> extension in
+   * {@link Settings#appPath}, and it is ignored after the application's tcz changes. Classes whose static fields
+   * reach objects that hold native resources (like images, files and threads), or that are shared with the main class,
+   * are not saved and run their static initializers as usual. The restored objects are copies: a String taken from
+   * a literal is no longer identical (==) to it, and the identity hash codes change, so don't save Hashtables whose
+   * keys use the default hashCode.
+   *
+   * This method does nothing under Java SE.
+   * @return true if the snapshot was written.
+   * @since TotalCross 6.1.1
+   */
+  public static boolean saveStartupSnapshot() {
+    return false;
+  }
+
   /**
    * Returns the same hash code for the given object as would be returned by the default method hashCode(), whether or not the given object's class 
    * overrides <code>hashCode()</code>.
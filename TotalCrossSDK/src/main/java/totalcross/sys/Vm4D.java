@@ -74,6 +74,8 @@ public final class Vm4D {
 
   native public static void preallocateArray(Object sample, int length);
 
+  native public static boolean saveStartupSnapshot();
+
   public static final int TWEAK_AUDIBLE_GC = 1;
   public static final int TWEAK_DUMP_MEM_STATS = 2;
   public static final int TWEAK_MEM_PROFILER = 3;
@@ -82,6 +84,16 @@ public final class Vm4D {
   public static final int TWEAK_TRACE_LOCKED_OBJS = 6;
   public static final int TWEAK_TRACE_OBJECTS_LEFT_BETWEEN_2_GCS = 7;
   public static final int TWEAK_TRACE_METHODS = 8;
+  public static final int TWEAK_GENERATIONAL_GC = 9;
+  public static final int TWEAK_INCREMENTAL_GC = 10;
+  public static final int TWEAK_INLINE_CACHE_STATS = 11;
+  public static final int TWEAK_JIT = 12;
+  public static final int TWEAK_PARALLEL_GC = 13;
+  public static final int TWEAK_COMPACT_STRINGS = 14;
+  public static final int TWEAK_STRING_DEDUP = 15;
+  public static final int TWEAK_CPU_PROFILER = 16;
+  public static final int TWEAK_ALLOC_PROFILER = 17;
+  public static final int TWEAK_HEAP_HISTOGRAM = 18;
 
   public static boolean attachNativeLibrary(String name) {
     if (htLoadedNatLibs.exists(name)) {
@@ -68,7 +68,7 @@ public class ClippedContainer extends Container {
           break;
         }
         if (pw == null || !child.isObscured(pw)) {
-          child.onPaint(child.getGraphics());
+          child.paintControl(child.getGraphics());
           if (child.asContainer != null) {
             child.asContainer.paintChildren();
           }
@@ -86,7 +86,7 @@ public class ClippedContainer extends Container {
               g.drawImage(child.asContainer.offscreen0, child.x, child.y);
             }
           } else {
-            child.onPaint(child.getGraphics());
+            child.paintControl(child.getGraphics());
             if (child.asContainer != null) {
               child.asContainer.paintChildren();
             }
@@ -514,7 +514,7 @@ public class Container extends Control {
             g.drawImage(child.offscreen0, child.x, child.y);
           }
         } else {
-          child.onPaint(child.getGraphics());
+          child.paintControl(child.getGraphics());
           if (child.asContainer != null) {
             child.asContainer.paintChildren();
           }
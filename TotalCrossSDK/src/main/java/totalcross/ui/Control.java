@@ -52,6 +52,7 @@ import totalcross.ui.font.Font;
 import totalcross.ui.font.FontMetrics;
 import totalcross.ui.gfx.Color;
 import totalcross.ui.gfx.Coord;
+import totalcross.ui.gfx.DisplayList;
 import totalcross.ui.gfx.GfxSurface;
 import totalcross.ui.gfx.Graphics;
 import totalcross.ui.gfx.Rect;
@@ -341,6 +342,9 @@ public class Control extends GfxSurface {
    */
   public Image offscreen, offscreen0;
 
+  /** The primitives drawn by onPaint, when the retained paint is on. */
+  DisplayList displayList;
+
   /** Keep the control disabled even if enabled is true. */
   public boolean keepDisabled;
 
@@ -454,6 +458,52 @@ public class Control extends GfxSurface {
     Window.needsPaint = true;
   }
 
+  /** Makes the primitives drawn by onPaint be recorded and, in the next paints, drawn again without calling onPaint,
+   * which saves the time spent in it by controls that draw a lot but change seldom. Only the primitives that are
+   * inside the clip are drawn again. The recording is discarded when the bounds, font, colors or enabled state of the
+   * control change, and by repaintNow and invalidatePaint: call invalidatePaint when anything else that onPaint draws
+   * changes, like a text or a selection. The children are not recorded with their parent; to keep the image of a whole
+   * container, use takeScreenShot. In Java SE, onPaint is always called.
+   * @see totalcross.ui.gfx.DisplayList
+   * @since TotalCross 6.1.1
+   */
+  public void setRetainedPaint(boolean on) {
+    displayList = !on ? null : displayList != null ? displayList : new DisplayList();
+  }
+
+  /** Returns true if the retained paint is on.
+   * @see #setRetainedPaint(boolean)
+   * @since TotalCross 6.1.1
+   */
+  public boolean isRetainedPaint() {
+    return displayList != null;
+  }
+
+  /** Discards the primitives recorded by the retained paint, so the next paint calls onPaint.
+   * @see #setRetainedPaint(boolean)
+   * @since TotalCross 6.1.1
+   */
+  public void invalidatePaint() {
+    if (displayList != null) {
+      displayList.invalidate();
+    }
+  }
+
+  /** Calls onPaint or, if the retained paint is on and has a recording, draws it again. */
+  void paintControl(Graphics g) {
+    DisplayList list = displayList;
+    if (list == null || g == null) {
+      onPaint(g);
+    } else if (!list.isValid() || !g.replay(list)) {
+      g.startRecording(list);
+      try {
+        onPaint(g);
+      } finally {
+        g.stopRecording();
+      }
+    }
+  }
+
   void paint2shot(Graphics g, Control top, boolean shift) {
     // if (asContainer != null || asWindow != null)
     //  this.refreshGraphics(g,0,top);
@@ -616,6 +666,7 @@ public class Control extends GfxSurface {
     this.setFont = this.font = font;
     this.fm = font.fm;
     this.fmH = fm.height;
+    invalidatePaint();
     onFontChanged();
     postEvent(new FontChangeEvent(this, font));
   }
@@ -1375,6 +1426,7 @@ public class Control extends GfxSurface {
       updateTemporary();
     }
     Window.needsPaint = true;
+    invalidatePaint();
     onBoundsChanged(screenChanged);
     if (asContainer != null) {
       if (!asContainer.started) // guich@340_15
@@ -1589,7 +1641,8 @@ public class Control extends GfxSurface {
       } else {
         Graphics g = refreshGraphics(gfx, 0, null, 0, 0);
         if (g != null) {
-          onPaint(g);
+          invalidatePaint();
+          paintControl(g);
           if (asContainer != null) {
             asContainer.paintChildren();
           }
@@ -1744,6 +1797,7 @@ public class Control extends GfxSurface {
   public boolean internalSetEnabled(boolean enabled, boolean post) {
     if (enabled != this.enabled) {
       this.enabled = enabled;
+      invalidatePaint();
       onColorsChanged(false);
       if (post) {
         post();
@@ -1817,6 +1871,7 @@ public class Control extends GfxSurface {
   {
     this.backColor = back;
     this.foreColor = fore;
+    invalidatePaint();
     onColorsChanged(true);
   }
 
@@ -1824,6 +1879,7 @@ public class Control extends GfxSurface {
    @since SuperWaba 2.0 */
   public void setForeColor(int c) {
     this.foreColor = c;
+    invalidatePaint();
     onColorsChanged(true);
   }
 
@@ -1831,6 +1887,7 @@ public class Control extends GfxSurface {
    @since SuperWaba 2.0 */
   public void setBackColor(int c) {
     this.backColor = c;
+    invalidatePaint();
     onColorsChanged(true);
   }
 
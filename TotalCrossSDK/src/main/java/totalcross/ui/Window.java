@@ -392,6 +392,36 @@ public class Window extends Container {
   final public static void setOrientation(int orientation) {
   }
 
+  ////////////////////////////////////////////////////////////////////////////////////
+  /** Index in the array filled by getFrameStats of the number of frames presented. */
+  public static final int FRAME_PRESENTED = 0;
+  /** Index in the array filled by getFrameStats of the number of screen updates that were merged into a frame that
+   * was still waiting to be presented, because the screen was updated faster than it could be presented. */
+  public static final int FRAME_MERGED = 1;
+  /** Index in the array filled by getFrameStats of the interval between the last two frames, in microseconds. */
+  public static final int FRAME_LAST_US = 2;
+  /** Index in the array filled by getFrameStats of the average interval between the frames, in microseconds. */
+  public static final int FRAME_AVERAGE_US = 3;
+  /** Index in the array filled by getFrameStats of the longest interval between two frames since the last call to
+   * getFrameStats, in microseconds. */
+  public static final int FRAME_MAX_US = 4;
+  /** Index in the array filled by getFrameStats of the time spent by the last present, which includes the wait for
+   * the vsync, in microseconds. */
+  public static final int FRAME_PRESENT_US = 5;
+
+  /** Fills the given array with the statistics of the frames presented on the screen, indexed by the FRAME_*
+   * constants. Pauses longer than half a second between the frames are not counted in the intervals. In Linux, the
+   * frames are presented by a render thread, so the application keeps running while the display waits for the vsync;
+   * set the TC_RENDER_THREAD environment variable to 0 to present them in the application's thread, TC_FRAME_BUFFERS
+   * to 3 to use triple buffering, and TC_VSYNC to 0 or 1 to change the vsync pacing.
+   * @return the number of values filled, or 0 if the platform doesn't collect them, like Java SE.
+   * @since TotalCross 6.1.1
+   */
+  @ReplacedByNativeOnDeploy
+  public static int getFrameStats(int[] stats) {
+    return 0;
+  }
+
   ////////////////////////////////////////////////////////////////////////////////////
   /** Sets the border borderStyle.
    * @see #NO_BORDER
@@ -0,0 +1,49 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+package totalcross.ui.gfx;
+
+/**
+ * A list of the primitives drawn with a Graphics, recorded by the vm between Graphics.startRecording and
+ * Graphics.stopRecording, that can be drawn again with Graphics.replay without running the code that drew them.
+ * The coordinates are relative to the translation of the Graphics, so the list can be replayed at another
+ * position. The strings, images and fonts used are kept by reference, and the arrays of points are copied.
+ * <br><br>
+ * Only the devices record the primitives: in Java SE, isValid always returns false.
+ *
+ * @see Graphics#startRecording(DisplayList)
+ * @see Graphics#replay(DisplayList)
+ * @see totalcross.ui.Control#setRetainedPaint(boolean)
+ * @since TotalCross 6.1.1
+ */
+public class DisplayList {
+  // the fields are read and written by the vm; don't change their order
+  int[] cmds; // the origin and clip of the recording, then the commands: opcode and length, bounding box, arguments
+  Object[] refs; // the objects used by the commands
+  int count; // ints used in cmds
+  int refCount; // objects used in refs
+  boolean valid; // set when a recording finished with only primitives that can be replayed
+  boolean failed; // set when a primitive that can't be replayed is recorded
+
+  /** Returns true if the list has a complete recording, which can be replayed. */
+  public boolean isValid() {
+    return valid;
+  }
+
+  /** Discards the recorded primitives. */
+  public void invalidate() {
+    valid = failed = false;
+    count = 0;
+    for (int i = refCount; --i >= 0;) {
+      refs[i] = null;
+    }
+    refCount = 0;
+  }
+
+  /** Returns the size of the recorded commands, in ints. */
+  public int size() {
+    return count;
+  }
+}
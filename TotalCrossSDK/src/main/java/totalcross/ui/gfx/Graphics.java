@@ -103,6 +103,8 @@ public final class Graphics {
 
   protected int[] ints; // used by fillPolygon
 
+  DisplayList displayList; // the list being recorded, or null; used only by the vm
+
   private int cyPoints[], cxPoints[];
 
   // static objects
@@ -3320,4 +3322,39 @@ public final class Graphics {
     }
     pixel[i] = (p & 0xFF000000) | (r << 16) | (g << 8) | b;
   }
+
+  /**
+   * Starts recording the primitives drawn with this Graphics into the given list, discarding what it had. The
+   * primitives are still drawn. The recording ends when stopRecording is called; if a primitive that can't be replayed
+   * is drawn meanwhile, like copyRect, the list will not be valid. In Java SE, nothing is recorded.
+   *
+   * @see DisplayList
+   * @since TotalCross 6.1.1
+   */
+  @ReplacedByNativeOnDeploy
+  public void startRecording(DisplayList list) {
+    list.invalidate();
+  }
+
+  /**
+   * Stops the recording started by startRecording.
+   *
+   * @since TotalCross 6.1.1
+   */
+  @ReplacedByNativeOnDeploy
+  public void stopRecording() {
+  }
+
+  /**
+   * Draws again the primitives recorded in the given list, translated to the current translation and clipped to the
+   * current clip. The primitives completely out of the clip are skipped, so, to redraw only a damaged area, set the
+   * clip to it before calling this method. The colors, font and clip of this Graphics are not changed.
+   *
+   * @return false if the list has no valid recording, in which case nothing is drawn.
+   * @since TotalCross 6.1.1
+   */
+  @ReplacedByNativeOnDeploy
+  public boolean replay(DisplayList list) {
+    return false;
+  }
 }
@@ -33,6 +33,8 @@ import totalcross.util.Vector;
     </ul>
 
     The header is compressed to save space.
+    If the attributes have ATTR_PRELINKED, the data chunks are stored uncompressed instead, and
+    the base offset and every chunk start at a multiple of 8, so the vm can map the file in memory.
     The first record is the class that implements totalcross.MainClass or extends totalcross.ui.MainWindow.
  */
 
@@ -101,6 +103,11 @@ public class TCZ {
   public static final short ATTR_WINDOWSIZE_480X640 = 128;
   /** Defines that the application uses the given window size. */
   public static final short ATTR_WINDOWSIZE_600X800 = 256;
+  /** Defines that the chunks are stored uncompressed and 8-byte aligned, and that the constant pool and the
+   * method code use the prelinked layout, which the vm uses in place instead of copying.
+   * @since TotalCross 6.1.1
+   */
+  public static final short ATTR_PRELINKED = 512;
 
   /** The names of the files. */
   public String[] names;
@@ -151,6 +158,7 @@ public class TCZ {
     // now we process the files.
     int n = vout.size();
 
+    boolean prelinked = (attr & ATTR_PRELINKED) != 0;
     // first pass, we setup the names and offset arrays
     offsets = new int[n + 1]; // first offset is 0
     names = new String[n];
@@ -160,8 +168,11 @@ public class TCZ {
       Entry of = (Entry) vout.items[i];
       names[i] = of.name2write;
       ofs += of.bytes.length;
+      if (prelinked) {
+        ofs = (ofs + 7) & ~7; // each chunk starts aligned
+      }
       offsets[i + 1] = ofs;
-      uncompressedSizes[i] = of.uncompressedSize;
+      uncompressedSizes[i] = prelinked ? of.bytes.length : of.uncompressedSize; // stored chunks are read up to their real size
     }
 
     // prepare the header
@@ -191,11 +202,22 @@ public class TCZ {
     ByteArrayStream bc = new ByteArrayStream(2048);
     header.mark();
     ZLib.deflate(header, bc, 9); // the smaller the compression level, the slower is the vm's startup
-    size += dsf.writeInt(bc.getPos() + 8); // base offset = compressed header size + 4
+    int baseOffset = bc.getPos() + 8; // base offset = compressed header size + 8
+    if (prelinked) {
+      baseOffset = (baseOffset + 7) & ~7;
+    }
+    size += dsf.writeInt(baseOffset);
     size += dsf.writeBytes(bc.getBuffer(), 0, bc.getPos());
+    if (baseOffset - 8 > bc.getPos()) {
+      size += dsf.pad(baseOffset - 8 - bc.getPos());
+    }
     // now write the compressed chunks
     for (int i = 0; i < n; i++) {
-      size += dsf.writeBytes(((Entry) vout.items[i]).bytes);
+      byte[] bytes = ((Entry) vout.items[i]).bytes;
+      size += dsf.writeBytes(bytes);
+      if (offsets[i + 1] - offsets[i] > bytes.length) {
+        size += dsf.pad(offsets[i + 1] - offsets[i] - bytes.length);
+      }
     }
     fout.close();
   }
@@ -245,7 +267,13 @@ public class TCZ {
   public void readNextChunk(Stream out) throws IOException {
     int s = offsets[idx + 1] - offsets[idx];
     idx++;
-    ZLib.inflate(in, out, s);
+    if ((attr & ATTR_PRELINKED) != 0) { // stored as is, followed by the padding up to the next chunk
+      byte[] bytes = new byte[s];
+      new DataStreamLE(in).readBytes(bytes, 0, s);
+      out.writeBytes(bytes, 0, uncompressedSizes[idx - 1]);
+    } else {
+      ZLib.inflate(in, out, s);
+    }
   }
 
   /** Finds the position of the given name in this tcz. */
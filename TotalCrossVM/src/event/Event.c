@@ -22,11 +22,20 @@ void vmSetAutoOff(bool enable); // vm_c.h
 #endif
 //
 
+#ifndef HAS_PRIVATE_WAIT_EVENT // platforms that can't block waiting for events keep polling
+static void privateWakeUp()
+{
+}
+#endif
+
+#define MAX_EVENT_WAIT 250 // the main loop wakes up at least this often (in ms), even without events or timers
+
 static Method onMinimize;
 static Method onRestore;
 static bool isMinimized;
 
-static void checkTimer(Context currentContext)
+// returns the time (in ms) until the next timer tick, or MAX_EVENT_WAIT if there's no timer running
+static int32 checkTimer(Context currentContext)
 {
    if (nextTimerTick != 0 && !isMinimized)
    {
@@ -37,17 +46,30 @@ static void checkTimer(Context currentContext)
          nextTimerTick = 0;
          executeMethod(currentContext, _onTimerTick, mainClass, true);
       }
+      if (nextTimerTick != 0) // the timer may have been rescheduled by _onTimerTick
+         return max32(1, min32(nextTimerTick - getTimeStamp(), MAX_EVENT_WAIT));
    }
+   return MAX_EVENT_WAIT;
 }
 
 extern bool wokeUp();
 
-static bool pumpEvent(Context currentContext)
+void wakeUpEventLoop()
+{
+   privateWakeUp();
+}
+
+/* Pumps the available event and runs the timer. If wait is true and the platform supports it, blocks until the
+ * next event or timer tick, or until another thread calls wakeUpEventLoop; otherwise, just sleeps a bit to avoid
+ * using 100% of the cpu. */
+static bool pumpEvent(Context currentContext, bool wait)
 {          
    bool ok = true;   
+   int32 timeout = 0;
    if (currentContext != mainContext) // only pump events on the mainContext
    {
       ok = false;
+      wait = false;
       goto sleep;
    }
    if (callGConMainThread)
@@ -57,8 +79,22 @@ static bool pumpEvent(Context currentContext)
    }
    if (privateIsEventAvailable())
       privatePumpEvent(currentContext);
-   checkTimer(currentContext);
+   timeout = checkTimer(currentContext); // after pumping a wake up, so the timer set by the thread that sent it is seen
+   if (IS_VMTWEAK_ON(VMTWEAK_INCREMENTAL_GC) && !privateIsEventAvailable()) // use the idle time to run a slice of the gc
+   {
+      gcStep(currentContext);
+      if (incrementalMarking) // keep running the slices while the cycle is not finished
+         timeout = min32(timeout, 1);
+   }
 sleep:
+#ifdef HAS_PRIVATE_WAIT_EVENT
+   if (wait)
+   {
+      if (timeout > 0 && keepRunning && !callGConMainThread && !privateIsEventAvailable())
+         privateWaitEvent(timeout);
+      return ok;
+   }
+#endif
 #ifndef darwin   
    Sleep(1); // avoid 100% cpu - important on Android!
 #endif   
@@ -76,7 +112,7 @@ void pumpEvents(Context currentContext)
    if (keepRunning)
       do
       {
-         if (!pumpEvent(currentContext))
+         if (!pumpEvent(currentContext, false)) // this is called while the application is busy, so it must not block
             break;
       } while (isEventAvailable() && keepRunning);
 
@@ -112,7 +148,7 @@ void mainEventLoop(Context currentContext)
             gc(currentContext);
          }
 #endif         
-         pumpEvent(currentContext);
+         pumpEvent(currentContext, true);
       }
 }
 
@@ -143,3 +179,7 @@ void destroyEvent()
    privateDestroyEvent();
    freeArray(interceptedSpecialKeys);
 }
+
+#ifdef ENABLE_TEST_SUITE
+#include "Event_test.h"
+#endif
@@ -0,0 +1,62 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifdef HAS_PRIVATE_WAIT_EVENT
+static void wakeUpLater(int32 index, VoidP arg) // another thread that posts work for the main loop while it's blocked
+{
+   if (index == 1)
+   {
+      Sleep(100);
+      *(volatile bool*)arg = true;
+      wakeUpEventLoop();
+   }
+}
+#endif
+
+TESTCASE(Event_wakeUp)
+{
+#ifndef HAS_PRIVATE_WAIT_EVENT
+   TEST_SKIP;
+#else
+   static volatile bool posted;
+   TParallelThreads threads;
+   int32 start, elapsed;
+#ifdef HEADLESS
+   if (wakeUpEventType == (Uint32)-1 || privateIsEventAvailable()) // the events were not initialized, or there are others in the queue
+      TEST_CANNOT_RUN;
+   // the wake up is queued only once, until the main loop takes it
+   wakeUpEventLoop();
+   ASSERT2_EQUALS(I32, 1, wakeUpPending);
+   ASSERT1_EQUALS(True, privateIsEventAvailable());
+   wakeUpEventLoop();
+   privatePumpEvent(currentContext);
+   ASSERT2_EQUALS(I32, 0, wakeUpPending);
+   ASSERT1_EQUALS(False, privateIsEventAvailable());
+#else
+   if (deviceCtx == null || !DEVICE_CTX->events)
+      TEST_CANNOT_RUN;
+#endif
+   // the main loop waiting for events returns as soon as the other thread wakes it, and then sees what it posted
+   posted = false;
+   threadStartParallel(&threads, 2, wakeUpLater, (VoidP)&posted);
+   if (!threads.created[1])
+   {
+      threadJoinParallel(&threads);
+      TEST_CANNOT_RUN;
+   }
+   start = getTimeStamp();
+   privateWaitEvent(5000);
+   elapsed = getTimeStamp() - start;
+   threadJoinParallel(&threads);
+   ASSERT_BETWEEN(I32, 0, elapsed, 2000);
+   ASSERT1_EQUALS(True, posted);
+#ifdef HEADLESS
+   ASSERT1_EQUALS(True, privateIsEventAvailable());
+   privatePumpEvent(currentContext);
+   ASSERT2_EQUALS(I32, 0, wakeUpPending);
+#endif
+#endif
+finish: ;
+}
@@ -15,6 +15,8 @@ extern "C" {
 void mainEventLoop(Context currentContext);
 void pumpEvents(Context currentContext);
 bool isEventAvailable();
+/// wakes up the main event loop if it is waiting for events; can be called from any thread
+void wakeUpEventLoop();
 
 bool initEvent();
 void destroyEvent();
@@ -25,6 +25,43 @@ bool privateIsEventAvailable()
 #endif
 }
 
+#define HAS_PRIVATE_WAIT_EVENT
+#ifdef HEADLESS
+static Uint32 wakeUpEventType = (Uint32)-1; // user event pushed by wakeUpEventLoop
+#endif
+static volatile int32 wakeUpPending; // avoids queueing more than one wake up event; cleared when the event is consumed
+
+// blocks until an event arrives, privateWakeUp is called or the timeout (in ms) expires
+static void privateWaitEvent(int32 timeout)
+{
+#ifndef HEADLESS
+   wakeUpPending = 0; // directfb's wake up is not queued as an event
+   DEVICE_CTX->events->WaitForEventWithTimeout(DEVICE_CTX->events, timeout / 1000, timeout % 1000);
+#else
+   SDL_WaitEventTimeout(NULL, timeout); // the wake up event stays in the queue until privatePumpEvent takes it
+#endif
+}
+
+static void privateWakeUp()
+{
+   if (!ATOMIC_CAS32(&wakeUpPending, 0, 1)) // a full barrier: either the pump sees the caller's changes, or the event is queued
+      return;
+#ifndef HEADLESS
+   if (deviceCtx != null && DEVICE_CTX->events)
+      DEVICE_CTX->events->WakeUp(DEVICE_CTX->events);
+#else
+   if (wakeUpEventType != (Uint32)-1)
+   {
+      SDL_Event event;
+      SDL_zero(event);
+      event.type = wakeUpEventType;
+      if (SDL_PushEvent(&event) == 1)
+         return;
+   }
+#endif
+   wakeUpPending = 0;
+}
+
 void handleFingerTouchEvent(SDL_Event event) {
    int width = 0, height = 0;
    TCSDL_GetWindowSize(&screen, &width, &height);
@@ -188,6 +225,11 @@ void privatePumpEvent(Context currentContext)
 #else
    SDL_Event event;
    if(SDL_PollEvent(&event)) {
+      if(event.type == wakeUpEventType) { // only interrupts privateWaitEvent
+         wakeUpPending = 0; // the next wake up queues another event. The caller recomputes the timeout after this
+         MEMORY_BARRIER();
+         return;
+      }
       if(event.type == SDL_WINDOWEVENT) {
          if(event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
             int width, height;
@@ -234,6 +276,7 @@ bool privateInitEvent()
    DFBResult res = DEVICE_CTX->dfb->CreateInputEventBuffer(DEVICE_CTX->dfb, DICAPS_ALL, DFB_TRUE, &DEVICE_CTX->events);
    return (res == DFB_OK && DEVICE_CTX->events);
 #else
+    wakeUpEventType = SDL_RegisterEvents(1);
     return true;
 #endif
 }
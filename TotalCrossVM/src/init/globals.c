@@ -8,8 +8,13 @@
 #include "tcvm.h"
 
 // tcclass.c
-Hashtable htLoadedClasses = { 0 };
+KeyHashtable htLoadedClasses = { 0 };
 TCClassArray vLoadedClasses = { 0 };
+int32 loadedClassesCount = 0;
+
+// snapshot.c
+int32 snapshotFirstClass = -1;
+int32 snapshotTCZCount;
 
 // tcexception.c
 CharP throwableAsCharP[(int32)ThrowableCount] = { 0 };
@@ -125,10 +130,12 @@ bool callGConMainThread = 0;
 bool disableGC = 0;
 bool runningGC = 0;
 bool runningFinalizer = 0;
-TCObjectArray freeList = { 0 }; // the array with lists of free objects
-TCObjectArray usedList = { 0 }; // the array with lists of used objects (allocated after the last GC)
-TCObjectArray lockList = { 0 }; // locked objects list
-uint32 markedAsUsed = 1; // starts as 1
+bool incrementalMarking = 0;
+volatile int32 gcEpoch = 0;
+Slab* partialSlabs = NULL; // the slabs with free cells, per size class
+Slab emptySlabs = NULL; // the slabs that can be given to any size class
+Slab largeObjects = NULL; // the objects that are too big for a size class
+SlabChunk slabChunks = NULL; // the blocks where the slabs are carved from
 uint32 objCreated = 0;
 uint32 skippedGC = 0;
 uint32 objLocked = 0; // a few counters
@@ -139,10 +146,10 @@ Stack objStack = NULL;
 #if defined(ENABLE_TEST_SUITE)
 // The garbage collector tests requires that no objects are created, so we cache the state, then restore it when the test finishes
 bool canTraverse=true;
-TCObjectArray freeList2 = { 0 }; // the array with lists of free objects
-TCObjectArray usedList2 = { 0 }; // the array with lists of used objects (allocated after the last GC)
-TCObjectArray lockList2 = { 0 }; // locked objects list
-uint32 markedAsUsed2 = 1; // starts as 1
+Slab* partialSlabs2 = NULL; // the slabs with free cells, per size class
+Slab emptySlabs2 = NULL; // the slabs that can be given to any size class
+Slab largeObjects2 = NULL; // the objects that are too big for a size class
+SlabChunk slabChunks2 = NULL; // the blocks where the slabs are carved from
 // the current gc count
 uint32 gcCount2 = 0;
 uint32 objCreated2 = 0;
@@ -166,7 +173,11 @@ int32 vmTweaks = 0;
 bool showKeyCodes = false;
 int32 profilerMaxMem = 0; // guich@tc111_4 - also on mem.c
 TCClass lockClass = { 0 };
-Hashtable htMutexes = { 0 };
+bool icStatsOn = false;
+int32 icHits = 0, icMisses = 0, icMegamorphic = 0;
+volatile int32 profilerTick = 0; // incremented by the sampler thread of the cpu profiler
+volatile int32 allocSampleInterval = 0; // in bytes; 0 if the allocation profiler is off
+bool disableQuickening = false;
 
 // file.c
 #ifdef ANDROID
@@ -308,6 +319,8 @@ DECLARE_MUTEX(opengl);
 DECLARE_MUTEX(alloc);
 DECLARE_MUTEX(fonts);
 DECLARE_MUTEX(mutexes);
+DECLARE_MUTEX(jit);
+DECLARE_MUTEX(profiler);
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -324,6 +337,8 @@ bool initGlobals()
    INIT_MUTEX(createdHeaps);
    INIT_MUTEX(fonts);
    INIT_MUTEX(mutexes);
+   INIT_MUTEX(jit);
+   INIT_MUTEX(profiler);
 #if defined (WIN32) || defined (WINCE)
    initWinsock();
 #endif
@@ -348,6 +363,8 @@ void destroyGlobals()
    DESTROY_MUTEX(alloc);
    DESTROY_MUTEX(fonts);
    DESTROY_MUTEX(mutexes);
+   DESTROY_MUTEX(jit);
+   DESTROY_MUTEX(profiler);
 #if defined (WIN32) || defined (WINCE)
    closeWinsock();
 #endif
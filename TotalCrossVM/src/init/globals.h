@@ -13,8 +13,13 @@ extern "C" {
 #endif
 
 // tcclass.c
-extern Hashtable htLoadedClasses;
+extern KeyHashtable htLoadedClasses;
 extern TCClassArray vLoadedClasses;
+extern int32 loadedClassesCount; // the number of classes loaded so far, used to number them in load order
+
+// snapshot.c
+extern int32 snapshotFirstClass; // the index of the first class loaded after the vm started; the classes before it are not saved in the startup snapshot
+extern int32 snapshotTCZCount; // the number of tczs open at that moment, whose sizes identify the snapshot
 
 // tcexception.c
 extern CharP throwableAsCharP[(int32)ThrowableCount];
@@ -105,10 +110,12 @@ extern jmethodID jsetElapsed;
 
 // objectmemorymanager.c    
 extern bool runningGC,runningFinalizer,disableGC,callGConMainThread;
-extern TCObjectArray freeList; // the array with lists of free objects
-extern TCObjectArray usedList; // the array with lists of used objects (allocated after the last GC)
-extern TCObjectArray lockList; // locked objects list
-extern uint32 markedAsUsed; // starts as 1
+extern bool incrementalMarking; // an incremental gc cycle is marking the objects
+extern volatile int32 gcEpoch; // changed when an incremental cycle starts; each thread acknowledges it at a safepoint
+extern Slab* partialSlabs; // the slabs with free cells, per size class
+extern Slab emptySlabs; // the slabs that can be given to any size class
+extern Slab largeObjects; // the objects that are too big for a size class
+extern SlabChunk slabChunks; // the blocks where the slabs are carved from
 extern uint32 objCreated,skippedGC,objLocked; // a few counters
 extern int32 lastGC, markedImages;
 extern Heap ommHeap;
@@ -117,10 +124,9 @@ extern Stack objStack;
 #if defined(ENABLE_TEST_SUITE)
 // The garbage collector tests requires that no objects are created, so we cache the state, then restore it when the test finishes
 extern bool canTraverse;
-extern TCObjectArray freeList2; // the array with lists of free objects
-extern TCObjectArray usedList2; // the array with lists of used objects (allocated after the last GC)
-extern TCObjectArray lockList2; // locked objects list
-extern uint32 markedAsUsed2; // starts as 1
+extern Slab* partialSlabs2; // the slabs with free cells, per size class
+extern Slab emptySlabs2,largeObjects2;
+extern SlabChunk slabChunks2;
 extern uint32 gcCount2,objCreated2,skippedGC2,objLocked2; // the current gc count
 extern Heap ommHeap2,chunksHeap2;
 extern Stack objStack2;
@@ -137,7 +143,15 @@ extern int32 vmTweaks;
 extern bool showKeyCodes;
 extern int32 profilerMaxMem;
 extern TCClass lockClass;
-extern Hashtable htMutexes;
+extern bool icStatsOn;
+extern int32 icHits, icMisses, icMegamorphic;
+extern volatile int32 profilerTick;
+extern volatile int32 allocSampleInterval;
+extern bool disableQuickening;
+#ifdef TRACK_USED_OPCODES
+extern int32 usedOpcodes[];
+extern int32 usedOpcodePairs[][OPCODE_LENGTH];
+#endif
 
 // linux/graphicsprimitives.c, linux/event_c.h, darwin/event.m, tcview.m
 #if !defined(WIN32)
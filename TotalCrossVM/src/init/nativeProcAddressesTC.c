@@ -154,6 +154,9 @@ void fillNativeProcAddressesTC()
    htPutPtr(&htNativeProcAddresses, hashCode("tugG_getRGB_Iiiiii"), &tugG_getRGB_Iiiiii);
    htPutPtr(&htNativeProcAddresses, hashCode("tugG_setRGB_Iiiiii"), &tugG_setRGB_Iiiiii);
    htPutPtr(&htNativeProcAddresses, hashCode("tugG_fadeScreen_i"), &tugG_fadeScreen_i);
+   htPutPtr(&htNativeProcAddresses, hashCode("tugG_startRecording_d"), &tugG_startRecording_d);
+   htPutPtr(&htNativeProcAddresses, hashCode("tugG_stopRecording"), &tugG_stopRecording);
+   htPutPtr(&htNativeProcAddresses, hashCode("tugG_replay_d"), &tugG_replay_d);
    htPutPtr(&htNativeProcAddresses, hashCode("tufF_fontCreate"), &tufF_fontCreate);
    htPutPtr(&htNativeProcAddresses, hashCode("tufFM_fontMetricsCreate"), &tufFM_fontMetricsCreate);
    htPutPtr(&htNativeProcAddresses, hashCode("tufFM_charWidth_c"), &tufFM_charWidth_c);
@@ -173,6 +176,7 @@ void fillNativeProcAddressesTC()
    htPutPtr(&htNativeProcAddresses, hashCode("tuW_setSIP_icb"), &tuW_setSIP_icb);
    htPutPtr(&htNativeProcAddresses, hashCode("tuW_setDeviceTitle_s"), &tuW_setDeviceTitle_s);
    htPutPtr(&htNativeProcAddresses, hashCode("tuW_setOrientation_i"), &tuW_setOrientation_i);
+   htPutPtr(&htNativeProcAddresses, hashCode("tuW_getFrameStats_I"), &tuW_getFrameStats_I);
    htPutPtr(&htNativeProcAddresses, hashCode("tuW_isSipShown"), &tuW_isSipShown);
    htPutPtr(&htNativeProcAddresses, hashCode("tsCC_bytes2chars_Bii"), &tsCC_bytes2chars_Bii);
    htPutPtr(&htNativeProcAddresses, hashCode("tsCC_chars2bytes_Cii"), &tsCC_chars2bytes_Cii);
@@ -219,6 +223,7 @@ void fillNativeProcAddressesTC()
    htPutPtr(&htNativeProcAddresses, hashCode("tsS_refresh"), &tsS_refresh);
    htPutPtr(&htNativeProcAddresses, hashCode("tsV_arrayCopy_oioii"), &tsV_arrayCopy_oioii);
    htPutPtr(&htNativeProcAddresses, hashCode("tsV_preallocateArray_oi"), &tsV_preallocateArray_oi);
+   htPutPtr(&htNativeProcAddresses, hashCode("tsV_saveStartupSnapshot"), &tsV_saveStartupSnapshot);
    htPutPtr(&htNativeProcAddresses, hashCode("tsV_getTimeStamp"), &tsV_getTimeStamp);
    htPutPtr(&htNativeProcAddresses, hashCode("tsV_setTime_t"), &tsV_setTime_t);
    htPutPtr(&htNativeProcAddresses, hashCode("tsV_exitAndReboot"), &tsV_exitAndReboot);
@@ -340,6 +345,10 @@ void fillNativeProcAddressesTC()
    htPutPtr(&htNativeProcAddresses, hashCode("jlS_lastIndexOf_s"), &jlS_lastIndexOf_s);
    htPutPtr(&htNativeProcAddresses, hashCode("jlS_lastIndexOf_si"), &jlS_lastIndexOf_si);
    htPutPtr(&htNativeProcAddresses, hashCode("jlS_getBytes"), &jlS_getBytes);
+   htPutPtr(&htNativeProcAddresses, hashCode("jlS_concat_s"), &jlS_concat_s);
+   htPutPtr(&htNativeProcAddresses, hashCode("jlS_copyOf_Cii"), &jlS_copyOf_Cii);
+   htPutPtr(&htNativeProcAddresses, hashCode("jlS_compact_C"), &jlS_compact_C);
+   htPutPtr(&htNativeProcAddresses, hashCode("jlS_toUTF16_C"), &jlS_toUTF16_C);
    htPutPtr(&htNativeProcAddresses, hashCode("jlSB_ensureCapacity_i"), &jlSB_ensureCapacity_i);
    htPutPtr(&htNativeProcAddresses, hashCode("jlSB_setLength_i"), &jlSB_setLength_i);
    htPutPtr(&htNativeProcAddresses, hashCode("jlSB_append_s"), &jlSB_append_s);
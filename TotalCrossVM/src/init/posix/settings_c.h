@@ -189,12 +189,21 @@ static void setAppSettings(uint32 crid, TCObject ptr, bool bin, bool isHKLM) //
    AppHive hive;
    uint8* data;
    UInt16 len;
-   if (!bin)
-      ptr = String_chars(ptr);
-   len = ARRAYOBJ_LEN(ptr);
-   data = (uint8*)ARRAYOBJ_START(ptr);
+   JCharP chars = null;
+   if (bin)
+   {
+      len = ARRAYOBJ_LEN(ptr);
+      data = (uint8*)ARRAYOBJ_START(ptr);
+   }
+   else // the chars are stored as UTF-16
+   {
+      len = String_charsLen(ptr) * 2;
+      data = (uint8*)(chars = String2JCharP(ptr));
+   }
    TCHAR *k = isHKLM ? getAppSecretHive(hive, applicationId) : getAppHive(hive, applicationId, bin);
-   writeAppPreferences(k, data, bin ? len : len*2);
+   if (data)
+      writeAppPreferences(k, data, len);
+   xfree(chars);
 }
 
 static TCObject getAppSettings(Context currentContext, uint32 crid, bool bin, bool isHKLM) // guich@580_21: use hklm if for secret key
@@ -215,7 +224,10 @@ static TCObject getAppSettings(Context currentContext, uint32 crid, bool bin, bo
       {
          target = createObject(currentContext, "java.lang.String");
          if (target)
+         {
             String_chars(target) = temp;
+            WRITE_BARRIER(target, temp);
+         }
       }
    }
    if (buf) xfree(buf);
@@ -68,6 +68,9 @@ static void createSettingsAliases(Context currentContext, TCZFile loadedTCZ)
    tcSettings.gcCount                     = getStaticFieldInt(settingsClass, "gcCount");
    tcSettings.gcTime                      = getStaticFieldInt(settingsClass, "gcTime");
    tcSettings.chunksCreated               = getStaticFieldInt(settingsClass, "chunksCreated");    *tcSettings.chunksCreated = 3;
+   tcSettings.gcMaxPause                  = getStaticFieldInt(settingsClass, "gcMaxPause");
+   tcSettings.gcLastPause                 = getStaticFieldInt(settingsClass, "gcLastPause");
+   tcSettings.gcSliceBudget               = getStaticFieldInt(settingsClass, "gcSliceBudget");
    tcSettings.appSettingsPtr              = getStaticFieldObject(currentContext,settingsClass, "appSettings");
    tcSettings.appSecretKeyPtr             = getStaticFieldObject(currentContext,settingsClass, "appSecretKey");
    tcSettings.appSettingsBinPtr           = getStaticFieldObject(currentContext,settingsClass, "appSettingsBin");
@@ -185,6 +188,8 @@ bool retrieveSettings(Context currentContext, CharP mainClassName)
          TCObject *imeis = (TCObjectArray) ARRAYOBJ_START(*imeisArrayObj);
          if (imei [0]) setObjectLock(*imeis++ = createStringObjectFromCharP(currentContext, imei, -1), UNLOCKED);
          if (imei2[0]) setObjectLock(*imeis++ = createStringObjectFromCharP(currentContext, imei2,-1), UNLOCKED);
+         for (imeis = (TCObjectArray)ARRAYOBJ_START(*imeisArrayObj); imeis < (TCObjectArray)ARRAYOBJ_START(*imeisArrayObj) + ARRAYOBJ_LEN(*imeisArrayObj); imeis++)
+            WRITE_BARRIER(*imeisArrayObj, *imeis);
          setObjectLock(*imeisArrayObj, UNLOCKED);
       }
    }   
@@ -195,12 +200,8 @@ bool retrieveSettings(Context currentContext, CharP mainClassName)
 void retrieveSettingsChangedAtStaticInitializer(Context currentContext)
 {
    TCObject appId = *getStaticFieldObject(currentContext,settingsClass, "applicationId");
-   JCharP c = String_charsStart(appId);
 
-   applicationIdStr[0] = (char)c[0];
-   applicationIdStr[1] = (char)c[1];
-   applicationIdStr[2] = (char)c[2];
-   applicationIdStr[3] = (char)c[3];
+   String2CharPBufLen(appId, 4, applicationIdStr);
    applicationId = *((int32*)applicationIdStr);
    applicationId = SWAP32_FORCED(applicationId);
    *tcSettings.appSettingsPtr = getAppSettings(currentContext, applicationId, false,false);
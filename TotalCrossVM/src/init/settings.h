@@ -21,6 +21,16 @@ typedef enum
    VMTWEAK_TRACE_LOCKED_OBJS,
    VMTWEAK_TRACE_OBJECTS_LEFT_BETWEEN_2_GCS,
    VMTWEAK_TRACE_METHODS,
+   VMTWEAK_GENERATIONAL_GC,   /// Allocates the small objects in a nursery that is collected separately
+   VMTWEAK_INCREMENTAL_GC,    /// Marks the objects in small slices, during the idle time of the event loop
+   VMTWEAK_INLINE_CACHE_STATS, /// Counts the hits and misses of the virtual method caches
+   VMTWEAK_JIT,               /// Compiles the hot methods to native code, where supported
+   VMTWEAK_PARALLEL_GC,       /// Marks and sweeps the heap using one thread per processor
+   VMTWEAK_COMPACT_STRINGS,   /// Stores the strings whose chars fit in Latin-1 in byte arrays
+   VMTWEAK_STRING_DEDUP,      /// Makes the equal strings with a cached hash share their chars after each gc
+   VMTWEAK_CPU_PROFILER,      /// Samples the call stacks of the threads and writes them to <appPath>/<main class>.folded
+   VMTWEAK_ALLOC_PROFILER,    /// Samples the allocations and writes their sites to <appPath>/<main class>.allocs.csv
+   VMTWEAK_HEAP_HISTOGRAM,    /// Writes the number and size of the live objects of each class after each gc
 } VmTweak;
 
 #define IS_VMTWEAK_ON(x) (vmTweaks & (1 << (x-1))) // guich@tc114_19: better use this macro
@@ -65,6 +75,9 @@ typedef struct
    int32* gcCount;                       // int
    int32* gcTime;                        // int
    int32* chunksCreated;                 // int
+   int32* gcMaxPause;                    // int
+   int32* gcLastPause;                   // int
+   int32* gcSliceBudget;                 // int
    TCObject* appSecretKeyPtr;            // java.lang.String
    TCObject* appSettingsBinPtr;          // byte[]
    int32* showMemoryMessagesAtExit;      // boolean
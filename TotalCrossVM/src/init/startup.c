@@ -8,6 +8,8 @@
 #include "tcvm.h"
 #include "tcz.h"
 #include "nativeProcAddressesTC.h"
+#include "jcharsimd.h"
+#include "../nm/ui/pixelsimd.h"
 
 #if defined (WINCE) || defined (WIN32)
  #include "malloc.h"
@@ -49,6 +51,8 @@ static Context initAll(CharP* args)
    ok = ok && initDebug();
    ok = ok && initGlobals();
    ok = ok && initMem();
+   if (ok) initJCharKernels(true);
+   if (ok) initPixelKernels(true);
    if (ok) firstTS = getTimeStamp();
    ok = ok && (c=initContexts()) != null;
    ok = ok && initObjectMemoryManager();
@@ -60,6 +64,9 @@ static Context initAll(CharP* args)
 
 static void destroyAll() // must be in inverse order of initAll calls
 {
+   stopCpuProfiler(); // the profilers write their files while the classes are still loaded
+   stopAllocProfiler();
+   stopClassPreload(); // the preloading threads read the classes, so they must finish before anything is destroyed
    threadDestroyAll(); // first all threads must be destroyed - NOTE: when debugging on win32, this may hang the Visual C++ ide.
    destroyingApplication = true; // now is safe to destroy all objects
    runFinalizers();
@@ -210,6 +217,12 @@ TC_API int32 startProgram(Context currentContext)
       }
    }
 #endif
+   // the classes saved by Vm.saveStartupSnapshot are loaded without running their static initializers
+   restoreSnapshot(currentContext);
+   // the classes recorded in the load profile are loaded in background
+   startClassPreload(currentContext);
+   // the profilers may be turned on by the environment
+   initProfilers();
    // 3. Load the main class (also calls its static initializer)
    c = loadClass(currentContext, mainClassName, true); // some fields of totalcross.sys.Settings may be set by the programmer at the static initializer, called now
    if (c == null)
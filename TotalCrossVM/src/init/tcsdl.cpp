@@ -10,11 +10,315 @@
 #define SUCCESS(x)      ((x) == 0)
 
 #include "tcsdl.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
+#define MAX_FRAME_BUFFERS 3
+#define MAX_FRAME_RECTS   32
+#define IDLE_INTERVAL_US  500000 // longer intervals between presents are pauses, not frames
+
+static SDL_Window* window;
 static SDL_Renderer* renderer;
 static SDL_Texture* texture;
+static Uint32 windowPixelFormat;
+static int textureW, textureH;
+
+/*
+ * The render thread owns the renderer: updateScreen copies the changed areas of
+ * the screen to a frame buffer and queues it, and the render thread uploads it to
+ * the texture and presents it, waiting for the vsync. So the vm thread never
+ * waits for the driver. With n buffers, up to n-1 frames wait while another one is
+ * uploaded; when they're all waiting, the next update is merged into the last one.
+ */
+typedef struct {
+	uint8* pixels;                      // the changed areas of the screen
+	int32 rects[MAX_FRAME_RECTS * 4];   // x1, y1, x2, y2 of each changed area
+	int32 count;                        // -1 if the whole screen changed
+} TFrame;
+
+typedef struct {
+	TFrame frames[MAX_FRAME_BUFFERS];
+	TFrame* free[MAX_FRAME_BUFFERS];    // the frames that can receive an update
+	TFrame* queued[MAX_FRAME_BUFFERS];  // the frames waiting to be presented, the oldest first
+	int buffers, freeCount, queuedCount;
+	int32 merged;                       // updates merged into a frame that was already queued
+} TFrameQueue;
+
+static bool threaded;
+static SDL_Thread* renderThread;
+static SDL_mutex* frameMutex;
+static SDL_cond* frameCond;
+static TFrameQueue queue;
+static bool stopRendering, presentAgain;
+static int renderInit; // 0 while the render thread is starting, 1 if it created the renderer, -1 if it failed
+
+static struct {
+	int32 presented;
+	int32 lastUs, averageUs, maxUs, presentUs;
+	Uint64 lastPresent;
+} frameStats;
+
+/*
+ * Allocates the given number of frame buffers, each one with size bytes, and
+ * returns how many could be allocated
+ */
+static int allocFrames(TFrameQueue* q, int buffers, int size) {
+	q->freeCount = q->queuedCount = 0;
+	for (q->buffers = 0; q->buffers < buffers; q->buffers++) {
+		if (IS_NULL(q->frames[q->buffers].pixels = (uint8*) malloc(size))) {
+			break;
+		}
+		q->free[q->freeCount++] = &q->frames[q->buffers];
+	}
+	return q->buffers;
+}
+
+static void freeFrames(TFrameQueue* q) {
+	while (q->buffers > 0) {
+		free(q->frames[--q->buffers].pixels);
+		q->frames[q->buffers].pixels = NULL;
+	}
+	q->freeCount = q->queuedCount = 0;
+}
+
+/*
+ * Returns the frame that receives the next update: a free one, queued after the
+ * others, or the last queued one if all the buffers are waiting or being uploaded.
+ * The queue functions must be called with frameMutex locked
+ */
+static TFrame* nextFrame(TFrameQueue* q) {
+	if (q->queuedCount > 0 && (q->queuedCount == q->buffers - 1 || q->freeCount == 0)) {
+		q->merged++;
+		return q->queued[q->queuedCount - 1];
+	}
+	TFrame* frame = q->free[--q->freeCount];
+	frame->count = 0;
+	q->queued[q->queuedCount++] = frame;
+	return frame;
+}
+
+/*
+ * Removes the oldest queued frame, to be uploaded; returns NULL if there's none
+ */
+static TFrame* takeFrame(TFrameQueue* q) {
+	if (q->queuedCount == 0) {
+		return NULL;
+	}
+	TFrame* frame = q->queued[0];
+	std::copy(q->queued + 1, q->queued + q->queuedCount, q->queued);
+	q->queuedCount--;
+	return frame;
+}
+
+/*
+ * Gives back a frame that was uploaded
+ */
+static void releaseFrame(TFrameQueue* q, TFrame* frame) {
+	q->free[q->freeCount++] = frame;
+}
+
+/*
+ * Creates the renderer and the streaming texture where the screen is uploaded;
+ * called by the thread that will use them
+ */
+static bool createRenderer(bool vsync) {
+	std::cout << "SDL_RENDER_DRIVER available:";
+	for (int i = 0; i < SDL_GetNumRenderDrivers(); ++i) {
+		SDL_RendererInfo info;
+		SDL_GetRenderDriverInfo(i, &info);
+		std::cout << " " << info.name;
+	}
+	std::cout << '\n';
+
+	// Create a 2D rendering context for a window
+	if (IS_NULL(renderer = SDL_CreateRenderer(window, -1, vsync ? SDL_RENDERER_PRESENTVSYNC : NO_FLAGS))) {
+		std::cerr << "SDL_CreateRenderer(): " << SDL_GetError() << '\n';
+		std::cout << '\n' << "HINT: try to export SDL_RENDER_DRIVER environment variable with an available render driver!" << '\n';
+		return false;
+	}
+
+	// Get renderer driver information
+	SDL_RendererInfo rendererInfo;
+	if (NOT_SUCCESS(SDL_GetRendererInfo(renderer, &rendererInfo))) {
+		std::cerr << "SDL_GetRendererInfo(): " << SDL_GetError() << '\n';
+		return false;
+	}
+	std::cout << "SDL_RENDER_DRIVER selected : " << rendererInfo.name << (vsync ? " (vsync)" : "") << '\n';
+
+	// MUST USE SDL_TEXTUREACCESS_STREAMING, CANNOT BE REPLACED WITH SDL_CreateTextureFromSurface
+	if (IS_NULL(texture = SDL_CreateTexture(
+							  renderer,
+							  windowPixelFormat,
+							  SDL_TEXTUREACCESS_STREAMING,
+							  textureW,
+							  textureH))) {
+		std::cerr << "SDL_CreateTexturet(): " << SDL_GetError() << '\n';
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Uploads the given rectangles of the pixels to the texture, or all of them if
+ * rects is NULL
+ */
+static void uploadRects(int pitch, void* pixels, const int32* rects, int32 count) {
+	if (IS_NULL(rects) || count <= 0) {
+		// Update the whole texture with new pixel data.
+		SDL_UpdateTexture(texture, NULL, pixels, pitch);
+	} else {
+		int bytesPerPixel = pitch / textureW;
+		for (int i = 0; i < count; i++, rects += 4) {
+			SDL_Rect r;
+			r.x = std::max(rects[0], 0);
+			r.y = std::max(rects[1], 0);
+			r.w = std::min(rects[2], textureW) - r.x;
+			r.h = std::min(rects[3], textureH) - r.y;
+			if (r.w > 0 && r.h > 0) {
+				// Update the given texture rectangle with new pixel data.
+				SDL_UpdateTexture(texture, &r, (uint8*) pixels + r.y * pitch + r.x * bytesPerPixel, pitch);
+			}
+		}
+	}
+}
+
+/*
+ * Presents the texture, measuring the interval between the presents
+ */
+static void present() {
+	Uint64 start = SDL_GetPerformanceCounter(), end;
+	double toUs = 1000000.0 / SDL_GetPerformanceFrequency();
+
+	// Copy a portion of the texture to the current rendering target
+	SDL_RenderCopy(renderer, texture, NULL, NULL);
+	// Update the screen with rendering performed
+	SDL_RenderPresent(renderer);
+	// Clears the entire rendering targe
+	SDL_RenderClear(renderer);
+
+	end = SDL_GetPerformanceCounter();
+	SDL_LockMutex(frameMutex);
+	frameStats.presented++;
+	frameStats.presentUs = (int32) ((end - start) * toUs);
+	if (frameStats.lastPresent != 0) {
+		int32 interval = (int32) std::min((end - frameStats.lastPresent) * toUs, 2e9);
+		if (interval < IDLE_INTERVAL_US) {
+			frameStats.lastUs = interval;
+			frameStats.averageUs = frameStats.averageUs == 0 ? interval : (frameStats.averageUs * 15 + interval) / 16;
+			frameStats.maxUs = std::max(frameStats.maxUs, interval);
+		}
+	}
+	frameStats.lastPresent = end;
+	SDL_UnlockMutex(frameMutex);
+}
+
+/*
+ * Body of the render thread: creates the renderer, then uploads and presents the
+ * queued frames until TCSDL_Destroy stops it
+ */
+static int renderLoop(void* vsync) {
+	bool ok = createRenderer(vsync != NULL);
+	SDL_LockMutex(frameMutex);
+	renderInit = ok ? 1 : -1;
+	SDL_CondBroadcast(frameCond);
+	while (ok && !stopRendering) {
+		if (queue.queuedCount == 0 && !presentAgain) {
+			SDL_CondWait(frameCond, frameMutex);
+			continue;
+		}
+		TFrame* frame = takeFrame(&queue);
+		presentAgain = false;
+		SDL_UnlockMutex(frameMutex);
+
+		if (!IS_NULL(frame)) {
+			uploadRects(textureW * SDL_BYTESPERPIXEL(windowPixelFormat), frame->pixels, frame->count < 0 ? NULL : frame->rects, frame->count);
+			SDL_LockMutex(frameMutex);
+			releaseFrame(&queue, frame);
+			SDL_CondBroadcast(frameCond);
+			SDL_UnlockMutex(frameMutex);
+		}
+		present(); // waits for the vsync
+
+		SDL_LockMutex(frameMutex);
+	}
+	SDL_UnlockMutex(frameMutex);
+	if (!IS_NULL(texture)) {
+		SDL_DestroyTexture(texture);
+	}
+	if (!IS_NULL(renderer)) {
+		SDL_DestroyRenderer(renderer);
+	}
+	texture = NULL;
+	renderer = NULL;
+	return 0;
+}
+
+/*
+ * Starts the render thread with the given number of frame buffers, each one with
+ * size bytes. Returns false if they can't be created or if the thread can't create
+ * the renderer, in which case the buffers are freed and the renderer is used by the
+ * vm thread
+ */
+static bool startRenderThread(int buffers, int size, bool vsync) {
+	if (allocFrames(&queue, buffers, size) < 2 || IS_NULL(renderThread = SDL_CreateThread(renderLoop, "TCRender", vsync ? (void*) 1 : NULL))) {
+		std::cerr << "Could not start the render thread; presenting in the vm thread" << '\n';
+		freeFrames(&queue);
+		return false;
+	}
+	SDL_LockMutex(frameMutex);
+	while (renderInit == 0) {
+		SDL_CondWait(frameCond, frameMutex);
+	}
+	SDL_UnlockMutex(frameMutex);
+	if (renderInit < 0) {
+		std::cerr << "Could not create the renderer in the render thread; presenting in the vm thread" << '\n';
+		SDL_WaitThread(renderThread, NULL); // it already destroyed what it created
+		renderThread = NULL;
+		renderInit = 0;
+		freeFrames(&queue);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Tells if the renderer of the video driver must be used by the main thread: Cocoa
+ * and UIKit only draw there, and emscripten has no threads
+ */
+static bool needsMainThread(const char* driver) {
+	static const char* drivers[] = {"cocoa", "uikit", "emscripten"};
+	for (size_t i = 0; !IS_NULL(driver) && i < sizeof(drivers) / sizeof(drivers[0]); i++) {
+		if (SUCCESS(strcmp(driver, drivers[i]))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Copies the given rectangles of the screen to the frame, or all of it if rects is
+ * NULL or the frame can't hold them
+ */
+static void copyToFrame(TFrame* frame, int w, int h, int pitch, void* pixels, const int32* rects, int32 count) {
+	if (IS_NULL(rects) || count <= 0 || frame->count < 0 || frame->count + count > MAX_FRAME_RECTS) {
+		memcpy(frame->pixels, pixels, pitch * h);
+		frame->count = -1;
+		return;
+	}
+	int bytesPerPixel = pitch / w;
+	for (int i = 0; i < count; i++, rects += 4) {
+		int x1 = std::max(rects[0], 0), y1 = std::max(rects[1], 0);
+		int x2 = std::min(rects[2], w), y2 = std::min(rects[3], h);
+		if (x1 < x2 && y1 < y2) {
+			for (int y = y1; y < y2; y++) {
+				memcpy(frame->pixels + y * pitch + x1 * bytesPerPixel, (uint8*) pixels + y * pitch + x1 * bytesPerPixel, (x2 - x1) * bytesPerPixel);
+			}
+			int32* r = &frame->rects[frame->count++ * 4];
+			r[0] = x1; r[1] = y1; r[2] = x2; r[3] = y2;
+		}
+	}
+}
 
 /*
  * Init steps to create a window and texture to Skia handling
@@ -81,7 +385,6 @@ bool TCSDL_Init(ScreenSurface screen, const char* title, bool fullScreen) {
 	}
 
 	// Create the window
-	SDL_Window* window;
 	if (IS_NULL(window = SDL_CreateWindow(
 							 title,
 							 SDL_WINDOWPOS_UNDEFINED,
@@ -94,52 +397,19 @@ bool TCSDL_Init(ScreenSurface screen, const char* title, bool fullScreen) {
 		return false;
 	}
 
-	std::cout << "SDL_RENDER_DRIVER available:";
-	for (int i = 0; i < SDL_GetNumRenderDrivers(); ++i) {
-		SDL_RendererInfo info;
-		SDL_GetRenderDriverInfo(i, &info);
-		std::cout << " " << info.name;
-	}
-	std::cout << '\n';
-
-	// Create a 2D rendering context for a window
-	if (IS_NULL(renderer = SDL_CreateRenderer(window, -1, NO_FLAGS))) {
-		std::cerr << "SDL_CreateRenderer(): " << SDL_GetError() << '\n';
-		std::cout << '\n' << "HINT: try to export SDL_RENDER_DRIVER environment variable with an available render driver!" << '\n';
-		return false;
-	}
-
-	// Get renderer driver information
-	SDL_RendererInfo rendererInfo;
-	if (NOT_SUCCESS(SDL_GetRendererInfo(renderer, &rendererInfo))) {
-		std::cerr << "SDL_GetRendererInfo(): " << SDL_GetError() << '\n';
-		return 0;
-	}
-	std::cout << "SDL_RENDER_DRIVER selected : " << rendererInfo.name << '\n';
-
 	// Get window pixel format
-	Uint32 windowPixelFormat;
 	if (SDL_PIXELFORMAT_UNKNOWN == (windowPixelFormat = SDL_GetWindowPixelFormat(window))) {
 		std::cerr << "SDL_GetWindowPixelFormat(): " << SDL_GetError() << '\n';
 		return false;
 	}
-
-	// MUST USE SDL_TEXTUREACCESS_STREAMING, CANNOT BE REPLACED WITH SDL_CreateTextureFromSurface
-	if (IS_NULL(texture = SDL_CreateTexture(
-							  renderer,
-							  windowPixelFormat,
-							  SDL_TEXTUREACCESS_STREAMING,
-							  width,
-							  height))) {
-		std::cerr << "SDL_CreateTexturet(): " << SDL_GetError() << '\n';
-		return false;
-	}
 	// Get pixel format struct
 	SDL_PixelFormat* pixelformat;
 	if (IS_NULL(pixelformat = SDL_AllocFormat(windowPixelFormat))) {
 		std::cerr << "SDL_AllocFormat(): " << SDL_GetError() << '\n';
 		return false;
 	}
+	textureW = width;
+	textureH = height;
 
 	// Adjusts screen width to the viewport
 	screen->screenW = width;
@@ -151,6 +421,27 @@ bool TCSDL_Init(ScreenSurface screen, const char* title, bool fullScreen) {
 	screen->pitch = pixelformat->BytesPerPixel * screen->screenW;
 	// pixel order
 	screen->pixelformat = windowPixelFormat;
+	SDL_FreeFormat(pixelformat);
+
+	// TC_RENDER_THREAD=0 presents in the vm thread, as before, and 1 forces the render
+	// thread, which is the default except for the drivers that need the main thread;
+	// TC_FRAME_BUFFERS=3 uses triple buffering; TC_VSYNC=0 or 1 overrides the default,
+	// which is to wait for the vsync only in the render thread
+	threaded = getenv("TC_RENDER_THREAD") == NULL ? !needsMainThread(SDL_GetCurrentVideoDriver()) : atoi(getenv("TC_RENDER_THREAD")) != 0;
+	int buffers = getenv("TC_FRAME_BUFFERS") == NULL ? 2 : std::min(std::max(atoi(getenv("TC_FRAME_BUFFERS")), 2), MAX_FRAME_BUFFERS);
+	if (IS_NULL(frameMutex = SDL_CreateMutex()) || IS_NULL(frameCond = SDL_CreateCond())) {
+		std::cerr << "SDL_CreateMutex(): " << SDL_GetError() << '\n';
+		return false;
+	}
+	const char* vsync = getenv("TC_VSYNC");
+	if (threaded) {
+		threaded = startRenderThread(buffers, (int) screen->pitch * height, vsync == NULL || atoi(vsync) != 0);
+	}
+	if (!threaded && !createRenderer(vsync != NULL && atoi(vsync) != 0)) {
+		return false;
+	}
+	std::cout << "Presenting " << (threaded ? "in the render thread" : "in the vm thread") << " with " << (threaded ? queue.buffers : 1) << " frame buffers" << '\n';
+
 	// Adjusts screen's pixel surface
 	if (IS_NULL(screen->pixels = (uint8*) malloc(screen->pitch * screen->screenH))) {
 		std::cerr << "Failed to alloc " << (screen->pitch * screen->screenH) << " bytes for pixel surface" << '\n';
@@ -166,49 +457,99 @@ bool TCSDL_Init(ScreenSurface screen, const char* title, bool fullScreen) {
 	SCREEN_EX(screen)->renderer = renderer;
 	SCREEN_EX(screen)->texture = texture;
 
-	SDL_FreeFormat(pixelformat);
-
 	return true;
 }
 
 /*
- * Update the given texture rectangle with new pixel data.
+ * Update the texture with new pixel data and present it
  *
- * # MUST BE REVIEWED
+ * Args:
+ * - w, h, pitch: the size of the pixel buffer, which has the size of the texture
+ * - rects: count rectangles (x1, y1, x2, y2, with x2 and y2 exclusive) that changed,
+ *   or NULL to upload the whole buffer
+ *
+ * Uploading only the damaged areas avoids copying the whole framebuffer in each
+ * frame, which dominates the frame time in big screens. The whole texture is still
+ * presented, since the contents of the back buffer are undefined after a present.
  *
- * SDL_UpdateTexture it's too slow and our implementation
- * depends on it
+ * With the render thread, the areas are copied to a frame buffer and this returns
+ * without waiting for the upload and present.
  */
-void TCSDL_UpdateTexture(int w, int h, int pitch, void* pixels) {
-	// Update the given texture rectangle with new pixel data.
-	SDL_UpdateTexture(texture, NULL, pixels, pitch);
-	// Call SDL render present
-	TCSDL_Present();
+void TCSDL_UpdateTexture(int w, int h, int pitch, void* pixels, const int32* rects, int32 count) {
+	if (!threaded) {
+		uploadRects(pitch, pixels, rects, count);
+		present();
+		return;
+	}
+	SDL_LockMutex(frameMutex);
+	copyToFrame(nextFrame(&queue), w, h, pitch, pixels, rects, count);
+	SDL_CondBroadcast(frameCond);
+	SDL_UnlockMutex(frameMutex);
 }
 
 /*
- * Update the screen with rendering performed
+ * Update the screen with rendering performed; with the render thread, just asks it
+ * to present the texture again
  */
 void TCSDL_Present() {
-	// Copy a portion of the texture to the current rendering target
-	SDL_RenderCopy(renderer, texture, NULL, NULL);
-	// Update the screen with rendering performed
-	SDL_RenderPresent(renderer);
-	// Clears the entire rendering targe
-	SDL_RenderClear(renderer);
+	if (!threaded) {
+		present();
+		return;
+	}
+	SDL_LockMutex(frameMutex);
+	presentAgain = true;
+	SDL_CondBroadcast(frameCond);
+	SDL_UnlockMutex(frameMutex);
+}
+
+/*
+ * Copies the frame statistics to stats, which has room for count values, and
+ * resets the maximum interval. Returns the number of values copied
+ */
+int32 TCSDL_GetFrameStats(int32* stats, int32 count) {
+	int32 values[6];
+	if (IS_NULL(frameMutex)) {
+		return 0;
+	}
+	SDL_LockMutex(frameMutex);
+	values[0] = frameStats.presented;
+	values[1] = queue.merged;
+	values[2] = frameStats.lastUs;
+	values[3] = frameStats.averageUs;
+	values[4] = frameStats.maxUs;
+	values[5] = frameStats.presentUs;
+	frameStats.maxUs = 0;
+	SDL_UnlockMutex(frameMutex);
+	count = std::min(count, (int32) 6);
+	std::copy(values, values + count, stats);
+	return count;
 }
 
 /*
  * Destroy all SDL allocated variables
  */
 void TCSDL_Destroy(ScreenSurface screen) {
+	if (!IS_NULL(renderThread)) {
+		SDL_LockMutex(frameMutex);
+		stopRendering = true;
+		SDL_CondBroadcast(frameCond);
+		SDL_UnlockMutex(frameMutex);
+		SDL_WaitThread(renderThread, NULL); // it destroys the renderer
+		renderThread = NULL;
+		freeFrames(&queue);
+	}
+
 	if (screen->pixels != NULL) {
 		free(screen->pixels);
 	}
 
 	if (SCREEN_EX(screen) != NULL) {
-		SDL_DestroyTexture(SCREEN_EX(screen)->texture);
-		SDL_DestroyRenderer(SCREEN_EX(screen)->renderer);
+		if (!IS_NULL(texture)) {
+			SDL_DestroyTexture(texture);
+		}
+		if (!IS_NULL(renderer)) {
+			SDL_DestroyRenderer(renderer);
+		}
 		SDL_DestroyWindow(SCREEN_EX(screen)->window);
 		free(SCREEN_EX(screen));
 	}
@@ -218,3 +559,9 @@ void TCSDL_Destroy(ScreenSurface screen) {
 void TCSDL_GetWindowSize(ScreenSurface screen, int32* width, int32* height) {
 	SDL_GetWindowSize(SCREEN_EX(screen)->window, width, height);
 }
+
+#ifdef ENABLE_TEST_SUITE
+extern "C" {
+#include "tcsdl_test.h"
+}
+#endif
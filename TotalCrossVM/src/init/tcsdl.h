@@ -19,10 +19,11 @@ extern "C" {
     #include "GraphicsPrimitives.h"
 
     bool TCSDL_Init(ScreenSurface screen, const char* title, bool fullScreen);
-    void TCSDL_UpdateTexture(int w, int h, int pitch,void *pixels);
+    void TCSDL_UpdateTexture(int w, int h, int pitch, void *pixels, const int32* rects, int32 count);
     void TCSDL_Present();
     void TCSDL_Destroy(ScreenSurface screen);
     void TCSDL_GetWindowSize(ScreenSurface screen, int32* width, int32* height);
+    int32 TCSDL_GetFrameStats(int32* stats, int32 count);
 
 #ifdef __cplusplus
 }
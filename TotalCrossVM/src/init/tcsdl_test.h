@@ -0,0 +1,121 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+// These tests use queues of their own, so the frames of the render thread are not changed
+
+TESTCASE(TCSDL_frameQueue)
+{
+   static TFrameQueue q;
+   TFrame *a, *b, *c;
+   UNUSED(currentContext);
+
+   // double buffering: while a frame waits, the next updates are merged into it
+   ASSERT2_EQUALS(I32, 2, allocFrames(&q, 2, 64));
+   ASSERT2_EQUALS(I32, 2, q.freeCount);
+   a = nextFrame(&q);
+   ASSERT2_EQUALS(I32, 0, a->count);
+   ASSERT2_EQUALS(I32, 1, q.queuedCount);
+   ASSERT2_EQUALS(Ptr, a, nextFrame(&q));
+   ASSERT2_EQUALS(I32, 1, q.merged);
+   ASSERT2_EQUALS(I32, 1, q.queuedCount);
+   // the render thread takes it: the next update goes to the other buffer, and is merged there until it's taken
+   ASSERT2_EQUALS(Ptr, a, takeFrame(&q));
+   ASSERT1_EQUALS(Null, takeFrame(&q));
+   b = nextFrame(&q);
+   ASSERT1_EQUALS(True, a != b);
+   ASSERT2_EQUALS(Ptr, b, nextFrame(&q));
+   ASSERT2_EQUALS(I32, 2, q.merged);
+   releaseFrame(&q, a); // uploaded
+   ASSERT2_EQUALS(Ptr, b, nextFrame(&q)); // only one frame may wait
+   ASSERT2_EQUALS(Ptr, b, takeFrame(&q));
+   ASSERT2_EQUALS(Ptr, a, nextFrame(&q));
+   freeFrames(&q);
+   ASSERT2_EQUALS(I32, 0, q.buffers);
+
+   // triple buffering: two frames wait, in order
+   q.merged = 0;
+   ASSERT2_EQUALS(I32, 3, allocFrames(&q, 3, 64));
+   a = nextFrame(&q);
+   b = nextFrame(&q);
+   ASSERT1_EQUALS(True, a != b);
+   ASSERT2_EQUALS(I32, 0, q.merged);
+   ASSERT2_EQUALS(Ptr, b, nextFrame(&q)); // merged into the last one
+   ASSERT2_EQUALS(I32, 1, q.merged);
+   ASSERT2_EQUALS(Ptr, a, takeFrame(&q));
+   c = nextFrame(&q);
+   ASSERT1_EQUALS(True, c != a && c != b);
+   ASSERT2_EQUALS(Ptr, b, takeFrame(&q));
+   ASSERT2_EQUALS(Ptr, c, takeFrame(&q));
+   ASSERT1_EQUALS(Null, takeFrame(&q));
+   releaseFrame(&q, a);
+   ASSERT2_EQUALS(I32, 1, q.freeCount); // b and c are still being uploaded
+   releaseFrame(&q, b);
+   releaseFrame(&q, c);
+   ASSERT2_EQUALS(I32, 3, q.freeCount);
+
+   ASSERT1_EQUALS(True, needsMainThread("cocoa"));
+   ASSERT1_EQUALS(False, needsMainThread("x11"));
+   ASSERT1_EQUALS(False, needsMainThread(NULL));
+finish:
+   freeFrames(&q);
+}
+
+TESTCASE(TCSDL_copyToFrame)
+{
+   static TFrameQueue q;
+   uint32 screenPixels[4 * 4], *framePixels;
+   int32 rects[(MAX_FRAME_RECTS + 1) * 4];
+   TFrame* f;
+   int32 i;
+   UNUSED(currentContext);
+
+   for (i = 0; i < 16; i++)
+      screenPixels[i] = i + 1;
+   ASSERT2_EQUALS(I32, 2, allocFrames(&q, 2, sizeof(screenPixels)));
+   f = nextFrame(&q);
+   framePixels = (uint32*)f->pixels;
+   xmemzero(framePixels, sizeof(screenPixels));
+
+   // only the rectangles are copied, clipped to the screen; the empty ones are ignored
+   rects[0] = 1; rects[1] = 1; rects[2] = 3; rects[3] = 2;
+   copyToFrame(f, 4, 4, 16, screenPixels, rects, 1);
+   ASSERT2_EQUALS(I32, 1, f->count);
+   for (i = 0; i < 16; i++)
+      ASSERT2_EQUALS(I32, i == 5 || i == 6 ? i + 1 : 0, framePixels[i]);
+   rects[0] = -5; rects[1] = 3; rects[2] = 2; rects[3] = 10;
+   rects[4] = 3; rects[5] = 3; rects[6] = 3; rects[7] = 4;
+   copyToFrame(nextFrame(&q), 4, 4, 16, screenPixels, rects, 2); // merged into the same frame
+   ASSERT2_EQUALS(I32, 2, f->count);
+   ASSERT2_EQUALS(I32, 0, f->rects[4]);
+   ASSERT2_EQUALS(I32, 3, f->rects[5]);
+   ASSERT2_EQUALS(I32, 2, f->rects[6]);
+   ASSERT2_EQUALS(I32, 4, f->rects[7]);
+   for (i = 0; i < 16; i++)
+      ASSERT2_EQUALS(I32, i == 5 || i == 6 || i == 12 || i == 13 ? i + 1 : 0, framePixels[i]);
+
+   // too many rectangles: the whole screen is copied, and the frame stays whole
+   xmemzero(framePixels, sizeof(screenPixels));
+   f->count = 0;
+   for (i = 0; i <= MAX_FRAME_RECTS; i++)
+   {
+      rects[i*4] = 0; rects[i*4+1] = 0; rects[i*4+2] = 1; rects[i*4+3] = 1;
+   }
+   copyToFrame(f, 4, 4, 16, screenPixels, rects, MAX_FRAME_RECTS);
+   ASSERT2_EQUALS(I32, MAX_FRAME_RECTS, f->count);
+   ASSERT2_EQUALS(I32, 0, framePixels[15]);
+   copyToFrame(f, 4, 4, 16, screenPixels, rects, 1);
+   ASSERT2_EQUALS(I32, -1, f->count);
+   ASSERT3_EQUALS(Block, screenPixels, framePixels, sizeof(screenPixels));
+   copyToFrame(f, 4, 4, 16, screenPixels, rects, 1);
+   ASSERT2_EQUALS(I32, -1, f->count);
+   // no rectangles: the whole screen changed
+   f->count = 0;
+   xmemzero(framePixels, sizeof(screenPixels));
+   copyToFrame(f, 4, 4, 16, screenPixels, NULL, 0);
+   ASSERT2_EQUALS(I32, -1, f->count);
+   ASSERT3_EQUALS(Block, screenPixels, framePixels, sizeof(screenPixels));
+finish:
+   freeFrames(&q);
+}
@@ -133,14 +133,21 @@ static void setAppSettings(uint32 crid, TCObject ptr, bool bin, bool isHKLM) //
       uint8* data;
       uint32 len;
       TCObject obj = (TCObject)ptr;
-      if (!bin)
-         obj = String_chars(obj);
-      len = ARRAYOBJ_LEN(obj);
-      data = (uint8*)ARRAYOBJ_START(obj);
-      if (!bin)
-         len *= 2;
-      fwrite(data,len,1,f);
+      JCharP chars = null;
+      if (bin)
+      {
+         len = ARRAYOBJ_LEN(obj);
+         data = (uint8*)ARRAYOBJ_START(obj);
+      }
+      else // the chars are stored as UTF-16
+      {
+         len = String_charsLen(obj) * 2;
+         data = (uint8*)(chars = String2JCharP(obj));
+      }
+      if (data)
+         fwrite(data,len,1,f);
       fclose(f);
+      xfree(chars);
    }
 #elif !defined WP8
    HKEY handle;
@@ -160,14 +167,21 @@ static void setAppSettings(uint32 crid, TCObject ptr, bool bin, bool isHKLM) //
       uint8* data;
       uint32 len;
       TCObject obj = (TCObject)ptr;
-      if (!bin)
-         obj = String_chars(obj);
-      len = ARRAYOBJ_LEN(obj);
-      data = (uint8*)ARRAYOBJ_START(obj);
-      if (!bin)
-         len *= 2;
-      ret = RegSetValueEx(handle,TEXT("Value"),0,REG_BINARY,data,len); // store the data
+      JCharP chars = null;
+      if (bin)
+      {
+         len = ARRAYOBJ_LEN(obj);
+         data = (uint8*)ARRAYOBJ_START(obj);
+      }
+      else // the chars are stored as UTF-16
+      {
+         len = String_charsLen(obj) * 2;
+         data = (uint8*)(chars = String2JCharP(obj));
+      }
+      if (data)
+         ret = RegSetValueEx(handle,TEXT("Value"),0,REG_BINARY,data,len); // store the data
       RegCloseKey(handle);
+      xfree(chars);
    }
 #endif
 }
@@ -214,7 +228,10 @@ static TCObject getAppSettingsTry(Context currentContext, uint32 crid, bool bin,
       if (!bin) // if not binary, create a string and set the chars to our created buffer
       {
          if ((target = createObject(currentContext, "java.lang.String")) != null)
+         {
             String_chars(target) = temp;
+            WRITE_BARRIER(target, temp);
+         }
          setObjectLock(temp, UNLOCKED);
       }
       RegCloseKey(handle);
@@ -251,7 +268,10 @@ static TCObject getAppSettings(Context currentContext, uint32 crid, bool bin, bo
       if (!bin) // if not binary, create a string and set the chars to our created buffer
       {
          if ((target = createObject(currentContext, "java.lang.String")) != null)
+         {
             String_chars(target) = temp;
+            WRITE_BARRIER(target, temp);
+         }
          setObjectLock(temp, UNLOCKED);
       }
       o = target;
@@ -12,7 +12,7 @@ LB_INCLUDEDIR := $(TC_SRCDIR)/src/litebase
 _TEST_SUITE ?= DISABLE
 
 ifeq ($(_TEST_SUITE),ENABLE)
-TEST_SUITE_FILES = $(TC_SRCDIR)/tests/tc_tests.c $(TC_SRCDIR)/tests/tc_testsuite.c
+TEST_SUITE_FILES = $(TC_SRCDIR)/tests/tc_tests.c $(TC_SRCDIR)/tests/tc_testsuite.c $(TC_SRCDIR)/tests/tc_benchmarks.c
 endif
 
 AXTLS_FILES =                                 \
@@ -46,6 +46,9 @@ VM_FILES =                                    \
 	$(TC_SRCDIR)/tcvm/tcfield.c                \
 	$(TC_SRCDIR)/tcvm/context.c                \
 	$(TC_SRCDIR)/tcvm/tcexception.c            \
+	$(TC_SRCDIR)/tcvm/snapshot.c               \
+	$(TC_SRCDIR)/tcvm/preload.c                \
+	$(TC_SRCDIR)/tcvm/profiler.c               \
 	$(TC_SRCDIR)/tcvm/tcvm.c
 
 INIT_FILES =                                  \
@@ -57,6 +60,7 @@ INIT_FILES =                                  \
 
 UTIL_FILES =                                  \
 	$(TC_SRCDIR)/util/jchar.c                  \
+	$(TC_SRCDIR)/util/jcharsimd.c              \
 	$(TC_SRCDIR)/util/datastructures.c         \
 	$(TC_SRCDIR)/util/debug.c                  \
 	$(TC_SRCDIR)/util/tcz.c                    \
@@ -160,6 +164,7 @@ NM_UI_FILES =                                 \
 	$(TC_SRCDIR)/nm/ui/media_Sound.c           \
 	$(TC_SRCDIR)/nm/ui/media_MediaClip.c       \
 	$(TC_SRCDIR)/nm/ui/media_Camera.c          \
+	$(TC_SRCDIR)/nm/ui/pixelsimd.c             \
 	$(TC_SRCDIR)/nm/ui/Window.c
 
 NM_UTIL_FILES =                               \
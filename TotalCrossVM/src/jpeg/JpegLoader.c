@@ -178,6 +178,7 @@ void jpegLoad(Context currentContext, TCObject imageObj, TCObject inputStreamObj
    Image_pixels(imageObj) = pixelsObj = createIntArray(currentContext, width*height);
    if (!pixelsObj)
       HEAP_ERROR(heap, 997);
+   WRITE_BARRIER(imageObj, pixelsObj);
    setObjectLock(pixelsObj, UNLOCKED);
    pixels = (Pixel*)ARRAYOBJ_START(pixelsObj);
 
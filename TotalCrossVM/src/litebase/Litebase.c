@@ -209,7 +209,8 @@ TCObject create(Context context, int32 crid, TCObject objParams)
           
       if (objParams)
       {
-         if (!TC_appendJCharP(context, logSBuffer, String_charsStart(objParams), String_charsLen(objParams)))
+         JCharP paramsChars = TC_widenString(context, objParams);
+         if (!paramsChars || !TC_appendJCharP(context, logSBuffer, paramsChars, String_charsLen(objParams)))
 	         goto error;
 	   }
 	   else if (!TC_appendCharP(context, logSBuffer, "null"))
@@ -236,7 +237,7 @@ error:
 
       // juliana@250_4: now getInstance() can receive only the parameter chars_type = ...
       // juliana@210_2: now Litebase supports tables with ascii strings.
-      TC_JCharP2CharPBuf(String_charsStart(objParams), String_charsLen(objParams), params);
+      TC_String2CharPBufLen(objParams, String_charsLen(objParams), params);
 		tempParams[0] = params;
       tempParams[1] = xstrchr(params, ';'); // Separates the parameters.
 		if (tempParams[1])
@@ -1742,8 +1743,8 @@ error:
                return;
             }
 
-            TC_JCharP2CharPBuf(String_charsStart(cridObj), String_charsLen(cridObj), cridStr);
-            TC_JCharP2TCHARPBuf(String_charsStart(pathObj), String_charsLen(pathObj), pathStr);
+            TC_String2CharPBufLen(cridObj, String_charsLen(cridObj), cridStr);
+            TC_String2TCHARPBufLen(pathObj, String_charsLen(pathObj), pathStr);
 
             if ((error = TC_listFiles(pathStr, -1, &list, &count, heap, 0))) // Lists all the files of the folder. 
             {
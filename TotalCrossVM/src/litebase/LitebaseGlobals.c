@@ -138,12 +138,16 @@ setObjectLockFunc TC_setObjectLock = { 0 };
 str2doubleFunc TC_str2double = { 0 };
 str2intFunc TC_str2int = { 0 };
 str2longFunc TC_str2long = { 0 };
+String2CharPBufLenFunc TC_String2CharPBufLen = { 0 };
+String2TCHARPBufLenFunc TC_String2TCHARPBufLen = { 0 };
 throwExceptionNamedFunc TC_throwExceptionNamed = { 0 };
 throwNullArgumentExceptionFunc TC_throwNullArgumentException = { 0 };
 tiF_create_siiFunc TC_tiF_create_sii = { 0 };
 toLowerFunc TC_toLower = { 0 };
 traceFunc TC_trace = { 0 };
 validatePathFunc TC_validatePath = { 0 }; // juliana@214_1
+widenStringFunc TC_widenString = { 0 };
+writeBarrierFunc TC_writeBarrier = { 0 };
 
 #ifdef ENABLE_MEMORY_TEST
 getCountToReturnNullFunc TC_getCountToReturnNull = { 0 };
@@ -120,12 +120,16 @@ extern setObjectLockFunc TC_setObjectLock;
 extern str2doubleFunc TC_str2double;
 extern str2intFunc TC_str2int;
 extern str2longFunc TC_str2long;
+extern String2CharPBufLenFunc TC_String2CharPBufLen;
+extern String2TCHARPBufLenFunc TC_String2TCHARPBufLen;
 extern throwExceptionNamedFunc TC_throwExceptionNamed;
 extern throwNullArgumentExceptionFunc TC_throwNullArgumentException;
 extern tiF_create_siiFunc TC_tiF_create_sii;
 extern toLowerFunc TC_toLower;
 extern traceFunc TC_trace;
 extern validatePathFunc TC_validatePath; // juliana@214_1
+extern widenStringFunc TC_widenString;
+extern writeBarrierFunc TC_writeBarrier;
 #ifdef ENABLE_MEMORY_TEST
 extern getCountToReturnNullFunc TC_getCountToReturnNull;
 extern setCountToReturnNullFunc TC_setCountToReturnNull;
@@ -463,7 +463,7 @@ LB_API void lLC_privateGetInstance_s(NMParams p)
       TC_throwExceptionNamed(p->currentContext, "litebase.DriverException",  getMessage(ERR_INVALID_CRID));
    else
    {
-      TC_JCharP2CharPBuf(String_charsStart(appCrid), 4, strAppId);
+      TC_String2CharPBufLen(appCrid, 4, strAppId);
 	   TC_setObjectLock(p->retO = create(p->currentContext, getAppCridInt(strAppId), null), UNLOCKED);
    }
 
@@ -511,7 +511,7 @@ LB_API void lLC_privateGetInstance_ss(NMParams p)
       TC_throwExceptionNamed(p->currentContext, "litebase.DriverException", getMessage(ERR_INVALID_CRID));
    else
    {
-      TC_JCharP2CharPBuf(String_charsStart(appCrid), 4, strAppId);
+      TC_String2CharPBufLen(appCrid, 4, strAppId);
 	   TC_setObjectLock(p->retO = create(p->currentContext, getAppCridInt(strAppId), params), UNLOCKED);
    }
 
@@ -572,6 +572,7 @@ LB_API void lLC_execute_s(NMParams p) // litebase/LitebaseConnection public nati
       TCObject driver = p->obj[0],
              sqlString = p->obj[1],
 	          logger = litebaseConnectionClass->objStaticValues[1];
+      JCharP sqlChars;
 
       if (logger)
 		{
@@ -581,7 +582,8 @@ LB_API void lLC_execute_s(NMParams p) // litebase/LitebaseConnection public nati
          if (context->thrownException)
             goto finish;
 		}
-      litebaseExecute(context, driver, String_charsStart(sqlString), String_charsLen(sqlString));
+      if ((sqlChars = TC_widenString(context, sqlString)) != null)
+         litebaseExecute(context, driver, sqlChars, String_charsLen(sqlString));
    }
 
 finish: ;
@@ -620,6 +622,7 @@ LB_API void lLC_executeUpdate_s(NMParams p) // litebase/LitebaseConnection publi
       TCObject driver = p->obj[0],
              sqlString = p->obj[1],
 	          logger = litebaseConnectionClass->objStaticValues[1];
+      JCharP sqlChars;
 
 		if (logger)
 		{
@@ -630,7 +633,8 @@ LB_API void lLC_executeUpdate_s(NMParams p) // litebase/LitebaseConnection publi
             goto finish;
 		}
       
-      p->retI = litebaseExecuteUpdate(context, driver, String_charsStart(sqlString), String_charsLen(sqlString));
+      if ((sqlChars = TC_widenString(context, sqlString)) != null)
+         p->retI = litebaseExecuteUpdate(context, driver, sqlChars, String_charsLen(sqlString));
    }
 
 finish: ;
@@ -666,6 +670,7 @@ LB_API void lLC_executeQuery_s(NMParams p) // litebase/LitebaseConnection public
       TCObject driver = p->obj[0],
              sqlString = p->obj[1],
 	          logger = litebaseConnectionClass->objStaticValues[1];
+      JCharP sqlChars;
 	          
       // juliana@253_18: now it is possible to log only changes during Litebase operation.
       if (logger && !litebaseConnectionClass->i32StaticValues[6])
@@ -677,7 +682,8 @@ LB_API void lLC_executeQuery_s(NMParams p) // litebase/LitebaseConnection public
             goto finish;
       }
 
-      TC_setObjectLock(p->retO = litebaseExecuteQuery(context, driver, String_charsStart(sqlString), String_charsLen(sqlString)), UNLOCKED);
+      if ((sqlChars = TC_widenString(context, sqlString)) != null)
+         TC_setObjectLock(p->retO = litebaseExecuteQuery(context, driver, sqlChars, String_charsLen(sqlString)), UNLOCKED);
    }
       
 finish: ;
@@ -713,8 +719,9 @@ LB_API void lLC_prepareStatement_s(NMParams p) // litebase/LitebaseConnection pu
       Heap heapParser = null;
       LitebaseParser* parse;
       Hashtable* htPS;
-	   JCharP sqlChars = String_charsStart(sqlObj),
-             sqlCharsAux;
+	   JCharP sqlChars = TC_widenString(context, sqlObj),
+             sqlCharsAux,
+             oldSqlChars;
       char command[MAX_RESERVED_SIZE];
 	   int32 sqlLength = String_charsLen(sqlObj),
             sqlLengthAux,
@@ -723,6 +730,9 @@ LB_API void lLC_prepareStatement_s(NMParams p) // litebase/LitebaseConnection pu
             hashCode;
       bool isSelect = false;
 
+      if (!sqlChars)
+         goto finish;
+
       // juliana@253_18: now it is possible to log only changes during Litebase operation.
       if (logger && !litebaseConnectionClass->i32StaticValues[6]) // juliana@230_30: reduced log files size.
 	   {
@@ -745,17 +755,22 @@ LB_API void lLC_prepareStatement_s(NMParams p) // litebase/LitebaseConnection pu
       htPS = getLitebaseHtPS(driver);
       if ((prepStmt = p->retO = p->obj[0] = TC_htGetPtr(htPS, hashCode = TC_JCharPHashCode(sqlChars, sqlLength))) 
        && !OBJ_PreparedStatementDontFinalize(prepStmt) && (oldSqlObj = OBJ_PreparedStatementSqlExpression(prepStmt))
-       && TC_JCharPEqualsJCharP(String_charsStart(oldSqlObj), sqlChars, String_charsLen(oldSqlObj), sqlLength))
+       && String_charsLen(oldSqlObj) == sqlLength && (oldSqlChars = TC_widenString(context, oldSqlObj))
+       && TC_JCharPEqualsJCharP(oldSqlChars, sqlChars, sqlLength, sqlLength))
       {
          lPS_clearParameters(p);
          goto finish;
       }
+      if (context->thrownException)
+         goto finish;
 
       // The prepared statement.
 	   if (!(prepStmt = p->retO = TC_createObject(context, "litebase.PreparedStatement")))
 		   goto finish;
 	   OBJ_PreparedStatementDriver(prepStmt) = driver;
 	   OBJ_PreparedStatementSqlExpression(prepStmt) = sqlObj;
+	   WRITE_BARRIER(prepStmt, driver);
+	   WRITE_BARRIER(prepStmt, sqlObj);
       
       // Only parses commands that create statements.
       sqlLengthAux = sqlLength;
@@ -947,6 +962,7 @@ free:
       // juliana@222_8: an array to hook the prepared statement object parameters.
       if (!(OBJ_PreparedStatementObjParams(prepStmt) = TC_createArrayObject(context, "[java.lang.Object", numParams)))
          goto finish;
+      WRITE_BARRIER(prepStmt, OBJ_PreparedStatementObjParams(prepStmt));
       TC_setObjectLock(OBJ_PreparedStatementObjParams(prepStmt), UNLOCKED);
       
       // If the statement is to be used as a prepared statement, it is possible to use log.
@@ -1037,7 +1053,7 @@ LB_API void lLC_getCurrentRowId_s(NMParams p)
          // Builds the logger StringBuffer contents.
          StringBuffer_count(logSBuffer) = 0;
          if (TC_appendCharP(context, logSBuffer, "getCurrentRowId ") 
-          && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))
+          && appendString(context, logSBuffer, tableName))
             TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
         
          UNLOCKVAR(log);
@@ -1089,7 +1105,7 @@ LB_API void lLC_getRowCount_s(NMParams p)
          // Builds the logger StringBuffer contents.
          StringBuffer_count(logSBuffer) = 0;
          if (TC_appendCharP(context, logSBuffer, "getRowCount ") 
-          && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))
+          && appendString(context, logSBuffer, tableName))
             TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
          
          UNLOCKVAR(log);         
@@ -1160,7 +1176,7 @@ LB_API void lLC_setRowInc_si(NMParams p)
          // Builds the logger StringBuffer contents.
          StringBuffer_count(logSBuffer) = 0;
          if (TC_appendCharP(context, logSBuffer, "setRowInc ")
-          && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName))
+          && appendString(context, logSBuffer, tableName)
           && TC_appendCharP(context, logSBuffer, " ") && TC_appendCharP(context, logSBuffer, TC_int2str(inc, intBuf)))
             
          TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
@@ -1249,7 +1265,7 @@ LB_API void lLC_exists_s(NMParams p) // litebase/LitebaseConnection public nativ
          }
          else
          {
-            TC_JCharP2CharPBuf(String_charsStart(tableNameObj), length, tableNameCharP);
+            TC_String2CharPBufLen(tableNameObj, length, tableNameCharP);
             getDiskTableName(p->currentContext, OBJ_LitebaseAppCrid(driver), tableNameCharP, bufName);
             xstrcat(bufName, DB_EXT);
             getFullFileName(bufName, sourcePath, fullName);
@@ -1365,7 +1381,7 @@ LB_API void lLC_purge_s(NMParams p)
          // Builds the logger StringBuffer contents.
          StringBuffer_count(logSBuffer) = 0;
          if (TC_appendCharP(context, logSBuffer, "purge ")
-          && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))   
+          && appendString(context, logSBuffer, tableName))   
             TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
          
          UNLOCKVAR(log);
@@ -1617,7 +1633,7 @@ LB_API void lLC_getRowCountDeleted_s(NMParams p) // litebase/LitebaseConnection
          // Builds the logger StringBuffer contents.
          StringBuffer_count(logSBuffer) = 0;
          if (TC_appendCharP(context, logSBuffer, "getRowCountDeleted ")
-          && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))  
+          && appendString(context, logSBuffer, tableName))  
             TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
          
          UNLOCKVAR(log);
@@ -1668,7 +1684,7 @@ LB_API void lLC_getRowIterator_s(NMParams p) // litebase/LitebaseConnection publ
          // Builds the logger StringBuffer contents.
          StringBuffer_count(logSBuffer) = 0;
          if (TC_appendCharP(context, logSBuffer, "getRowIterator ")
-          && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))
+          && appendString(context, logSBuffer, tableName))
             TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
          
          UNLOCKVAR(log);
@@ -1688,6 +1704,8 @@ LB_API void lLC_getRowIterator_s(NMParams p) // litebase/LitebaseConnection publ
             OBJ_RowIteratorRowNumber(rowIterator) = -1;
             OBJ_RowIteratorData(rowIterator) = TC_createArrayObject(context, BYTE_ARRAY, table->db.rowSize);
             OBJ_RowIteratorDriver(rowIterator) = driver;
+            WRITE_BARRIER(rowIterator, OBJ_RowIteratorData(rowIterator));
+            WRITE_BARRIER(rowIterator, driver);
             TC_setObjectLock(OBJ_RowIteratorData(rowIterator), UNLOCKED);
          }
 
@@ -1787,6 +1805,7 @@ LB_API void lLC_privateGetDefaultLogger(NMParams p)
          goto finish;                                                                                                                                
          
       FIELD_OBJ(p->obj[0] = file, OBJ_CLASS(file), 0) = p->obj[1] = nameStr; // path
+      WRITE_BARRIER(file, nameStr);
       FIELD_I32(file, 1) = p->i32[0] = CREATE_EMPTY; // mode 
       FIELD_I32(file, 2) = p->i32[1] = -1; // slot                                                                                                                                
 		TC_tiF_create_sii(p);
@@ -1816,7 +1835,7 @@ finish: ;
       if (exceptionMsg)
       {
          int32 length = String_charsLen(exceptionMsg);
-         TC_JCharP2CharPBuf(String_charsStart(exceptionMsg), length < 1024? length : 1023, msgError);
+         TC_String2CharPBufLen(exceptionMsg, length < 1024? length : 1023, msgError);
 	   }
 	   else
 	      xstrcpy(msgError, "null");
@@ -1825,7 +1844,10 @@ finish: ;
       TC_throwExceptionNamed(context, "litebase.DriverException", msgError);
 
       if (strEq(OBJ_CLASS(context->thrownException)->name, "litebase.DriverException"))
+      {
 		   OBJ_DriverExceptionCause(context->thrownException) = exception;
+		   WRITE_BARRIER(context->thrownException, exception);
+      }
    }
    UNLOCKVAR(log);                                                                                                                                   
 	MEMORY_TEST_END                                                                                                                                    
@@ -1877,7 +1899,7 @@ LB_API void lLC_privateDeleteLogFiles(NMParams p) // litebase/LitebaseConnection
       {
 		   nameObj = ((TCObject*)ARRAYOBJ_START(FIELD_OBJ(FIELD_OBJ(logger, loggerClass, 1), OBJ_CLASS(FIELD_OBJ(logger, loggerClass, 1)), 0)))[0];
 		   nameObj = FIELD_OBJ(nameObj, OBJ_CLASS(nameObj), 0);
-         TC_JCharP2CharPBuf(String_charsStart(nameObj), String_charsLen(nameObj), name);
+         TC_String2CharPBufLen(nameObj, String_charsLen(nameObj), name);
       }
    }
                                                                                                                                            
@@ -1968,8 +1990,11 @@ LB_API void lLC_privateProcessLogs_Ssb(NMParams p)
 			   TC_debug("running command # %d", (i + 1));
          string = sqlArray[i];
 
+         if (!(sqlStr = TC_widenString(context, string)))
+            break;
+
          // Gets a new Litebase Connection.
-         if (JCharPStartsWithCharP(sqlStr = String_charsStart(string), "new LitebaseConnection", sqlLen = String_charsLen(string), 22))
+         if (JCharPStartsWithCharP(sqlStr, "new LitebaseConnection", sqlLen = String_charsLen(string), 22))
 			   TC_setObjectLock(p->retO = driver = create(context, getAppCridInt(&sqlStr[23]), params), UNLOCKED);
 		   
          // Create command.
@@ -2008,7 +2033,7 @@ LB_API void lLC_privateProcessLogs_Ssb(NMParams p)
             if (exceptionMsg)
             {
                int32 length = String_charsLen(exceptionMsg);
-               TC_JCharP2CharPBuf(String_charsStart(exceptionMsg), length < 1024? length : 1023, msgError);
+               TC_String2CharPBufLen(exceptionMsg, length < 1024? length : 1023, msgError);
 			   }
 			   else
 			      xstrcpy(msgError, "null");
@@ -2024,7 +2049,10 @@ LB_API void lLC_privateProcessLogs_Ssb(NMParams p)
             TC_throwExceptionNamed(context, "litebase.DriverException", msgError);
 
             if (strEq(OBJ_CLASS(context->thrownException)->name, "litebase.DriverException"))
+            {
 				   OBJ_DriverExceptionCause(context->thrownException) = exception;
+				   WRITE_BARRIER(context->thrownException, exception);
+            }
 			   break;
 		   }
          else
@@ -2114,7 +2142,7 @@ LB_API void lLC_recoverTable_s(NMParams p)
             // Builds the logger StringBuffer contents.
             StringBuffer_count(logSBuffer) = 0;
             if (TC_appendCharP(context, logSBuffer, "recover table ")
-             && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))
+             && appendString(context, logSBuffer, tableName))
                TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
             
             UNLOCKVAR(log);
@@ -2129,7 +2157,7 @@ LB_API void lLC_recoverTable_s(NMParams p)
          }
          
          // Opens the table file.
-	      TC_JCharP2CharPBuf(String_charsStart(tableName), j, &name[5]);
+	      TC_String2CharPBufLen(tableName, j, &name[5]);
 	      TC_CharPToLower(&name[5]); // juliana@227_19: corrected a bug in convert() and recoverTable() which could not find the table .db file. 
          TC_int2CRID(crid, name);
          
@@ -2404,7 +2432,7 @@ LB_API void lLC_convert_s(NMParams p)
             // Builds the logger StringBuffer contents.
             StringBuffer_count(logSBuffer) = 0;
             if (TC_appendCharP(context, logSBuffer, "convert ")
-             && TC_appendJCharP(context, logSBuffer, String_charsStart(tableName), String_charsLen(tableName)))
+             && appendString(context, logSBuffer, tableName))
                TC_executeMethod(context, loggerLogInfo, logger, logSBuffer); // Logs the Litebase operation.  
             
             UNLOCKVAR(log);
@@ -2421,7 +2449,7 @@ LB_API void lLC_convert_s(NMParams p)
          }
     
          // Opens the .db table file.
-	      TC_JCharP2CharPBuf(String_charsStart(tableName), i, &name[5]);
+	      TC_String2CharPBufLen(tableName, i, &name[5]);
 	      TC_CharPToLower(&name[5]); // juliana@227_19: corrected a bug in convert() and recoverTable() which could not find the table .db file. 
          TC_int2CRID(crid, name);
       
@@ -2595,7 +2623,7 @@ LB_API void lLC_isOpen_s(NMParams p) // litebase/LitebaseConnection public nativ
          char nameCharP[DBNAME_SIZE];
 
          // Checks if the table name hash code is in the driver hash table.
-         TC_JCharP2CharPBuf(String_charsStart(tableName), length, nameCharP);
+         TC_String2CharPBufLen(tableName, length, nameCharP);
          TC_CharPToLower(nameCharP);
          p->retI = TC_htGetPtr(htTables, TC_hashCode(nameCharP)) != null;
       } 
@@ -2649,8 +2677,8 @@ error:
                goto finish;
             }
 
-            TC_JCharP2CharPBuf(String_charsStart(cridObj), 4, cridStr);
-            TC_JCharP2TCHARPBuf(String_charsStart(pathObj), String_charsLen(pathObj), fullPath);
+            TC_String2CharPBufLen(cridObj, 4, cridStr);
+            TC_String2TCHARPBufLen(pathObj, String_charsLen(pathObj), fullPath);
 
             if ((i = TC_listFiles(fullPath, -1, &list, &count, heap, 0))) // Lists all the files of the folder. 
             {
@@ -2733,7 +2761,7 @@ LB_API void lLC_isTableProperlyClosed_s(NMParams p)
                read;    
          
          // Opens the table file.
-	      TC_JCharP2CharPBuf(String_charsStart(tableName), String_charsLen(tableName), &name[5]);
+	      TC_String2CharPBufLen(tableName, String_charsLen(tableName), &name[5]);
 	      TC_CharPToLower(&name[5]); 
          TC_int2CRID(crid, name);
          
@@ -2860,6 +2888,7 @@ error:
          {
             if (!(*array = TC_createStringObjectFromTCHARP(context, list->value, -1)))
                goto error;
+            WRITE_BARRIER(p->retO, *array);
             TC_setObjectLock(*array++, UNLOCKED);
          }
          list = list->next;   
@@ -2930,6 +2959,7 @@ LB_API void lRS_getResultSetMetaData(NMParams p) // litebase/ResultSet public na
    {
       TC_setObjectLock(rsMetaData, UNLOCKED);
       OBJ_ResultSetMetaData_ResultSet(rsMetaData) = resultSet;	   
+      WRITE_BARRIER(rsMetaData, resultSet);
    }
    
    MEMORY_TEST_END
@@ -3922,7 +3952,8 @@ LB_API void lRS_rowToString(NMParams p)
          SQLResultSetField* field;
          TCObject strings[MAXIMUMS];
          TCObject result;
-         JCharP resultStr;
+         JCharP resultStr,
+                chars;
 
          // juliana@211_4: solved bugs with result set dealing.
          // juliana@211_3: the string matrix size can't take into consideration rows that are before the result set pointer.
@@ -3979,8 +4010,8 @@ LB_API void lRS_rowToString(NMParams p)
          i = -1;
          while (++i < cols)
          {
-            if (strings[i])
-               xmemmove(&resultStr[j], String_charsStart(strings[i]), (k = String_charsLen(strings[i])) << 1);
+            if (strings[i] && (chars = TC_widenString(context, strings[i])))
+               xmemmove(&resultStr[j], chars, (k = String_charsLen(strings[i])) << 1);
             else
                k = 0;
             if (i + 1 < cols)
@@ -4302,14 +4333,14 @@ LB_API void lRSMD_getColumnTableName_s(NMParams p)
    if (testRSClosed(p->currentContext, resultSet)) // The driver and the result set can't be closed.
    {
       TCObject columnNameStr = p->obj[1];
+      JCharP columnNameJCharP;
 
-      if (columnNameStr)
+      if (columnNameStr && (columnNameJCharP = TC_widenString(p->currentContext, columnNameStr)))
       {
          SQLSelectClause* clause = getResultSetBag(resultSet)->selectClause;
          SQLResultSetField** fields = clause->fieldList;
          int32 i = -1,
                length = clause->fieldsCount;
-         JCharP columnNameJCharP = String_charsStart(columnNameStr);
          int32 columnNameLength = String_charsLen(columnNameStr);
          CharP tableColName,
                tableName;
@@ -4335,7 +4366,7 @@ LB_API void lRSMD_getColumnTableName_s(NMParams p)
             xfree(tableColName);
          }
       }
-      else // The column name can't be null.
+      else if (!columnNameStr) // The column name can't be null.
          TC_throwNullArgumentException(p->currentContext, "columnName");
    }
    
@@ -4372,7 +4403,7 @@ LB_API void lRSMD_hasDefaultValue_i(NMParams p)
       char nameCharP[DBNAME_SIZE];
       
       // Gets the table column info.
-      TC_JCharP2CharPBuf(String_charsStart(nameObj), String_charsLen(nameObj), nameCharP);
+      TC_String2CharPBufLen(nameObj, String_charsLen(nameObj), nameCharP);
       if ((table = getTable(p->currentContext, rsBag->driver, nameCharP)))
       {
          SQLResultSetField* field = rsBag->selectClause->fieldList[p->i32[0] - 1];
@@ -4414,12 +4445,12 @@ LB_API void lRSMD_hasDefaultValue_s(NMParams p)
    {
       ResultSet* rsBag = getResultSetBag(resultSet);
       TCObject columnNameStr = p->obj[1];
+      JCharP columnNameJCharP;
 
-      if (columnNameStr)
+      if (columnNameStr && (columnNameJCharP = TC_widenString(p->currentContext, columnNameStr)))
       {
          SQLResultSetField** fields = rsBag->selectClause->fieldList; 
          SQLResultSetField* field; 
-         JCharP columnNameJCharP = String_charsStart(columnNameStr);
          int32 i = -1,
                length = rsBag->selectClause->fieldsCount,
                columnNameLength = String_charsLen(columnNameStr);
@@ -4455,7 +4486,7 @@ LB_API void lRSMD_hasDefaultValue_s(NMParams p)
             xfree(tableColName);
          }
       }
-      else // The column name can't be null.
+      else if (!columnNameStr) // The column name can't be null.
          TC_throwNullArgumentException(context, "columnName");
    }
  
@@ -4490,7 +4521,7 @@ LB_API void lRSMD_isNotNull_i(NMParams p) // litebase/ResultSetMetaData public n
       char nameCharP[DBNAME_SIZE];
       
       // Gets the table column info.
-      TC_JCharP2CharPBuf(String_charsStart(nameObj), String_charsLen(nameObj), nameCharP);
+      TC_String2CharPBufLen(nameObj, String_charsLen(nameObj), nameCharP);
       if ((table = getTable(context, rsBag->driver, nameCharP)))
       {
          SQLResultSetField* field = rsBag->selectClause->fieldList[p->i32[0] - 1];
@@ -4532,12 +4563,12 @@ LB_API void lRSMD_isNotNull_s(NMParams p)
    {
       ResultSet* rsBag = getResultSetBag(resultSet);
       TCObject columnNameStr = p->obj[1];
+      JCharP columnNameJCharP;
 
-      if (columnNameStr)
+      if (columnNameStr && (columnNameJCharP = TC_widenString(p->currentContext, columnNameStr)))
       {
          SQLResultSetField** fields = rsBag->selectClause->fieldList; 
          SQLResultSetField* field; 
-         JCharP columnNameJCharP = String_charsStart(columnNameStr);
          int32 i = -1,
                length = rsBag->selectClause->fieldsCount,
                columnNameLength = String_charsLen(columnNameStr);
@@ -4573,7 +4604,7 @@ LB_API void lRSMD_isNotNull_s(NMParams p)
             xfree(tableColName);
          }
       }
-      else // The column name can't be null.
+      else if (!columnNameStr) // The column name can't be null.
          TC_throwNullArgumentException(context, "columnName");
    }
    
@@ -4609,7 +4640,7 @@ LB_API void lRSMD_getPKColumnIndices_s(NMParams p)
          Table* table; 
          
          // Gets the table given its name in the result set.
-         TC_JCharP2CharPBuf(String_charsStart(tableNameStr), String_charsLen(tableNameStr), tableNameCharP); 
+         TC_String2CharPBufLen(tableNameStr, String_charsLen(tableNameStr), tableNameCharP); 
          TC_CharPToLower(tableNameCharP);
          if (!(table = getTableRS(context, rsBag, tableNameCharP))) 
             goto finish;
@@ -4667,7 +4698,7 @@ LB_API void lRSMD_getPKColumnNames_s(NMParams p)
          Table* table; 
          
          // Gets the table given its name in the result set.
-         TC_JCharP2CharPBuf(String_charsStart(tableNameStr), String_charsLen(tableNameStr), tableNameCharP); 
+         TC_String2CharPBufLen(tableNameStr, String_charsLen(tableNameStr), tableNameCharP); 
          TC_CharPToLower(tableNameCharP);
          if (!(table = getTableRS(context, rsBag, tableNameCharP))) 
             goto finish;
@@ -4683,6 +4714,7 @@ LB_API void lRSMD_getPKColumnNames_s(NMParams p)
             array = (TCObject*)ARRAYOBJ_START(p->retO);
             if (!(array[0] = TC_createStringObjectFromCharP(context, table->columnNames[table->primaryKeyCol], -1)))
                goto finish;
+            WRITE_BARRIER(p->retO, array[0]);
             TC_setObjectLock(array[0], UNLOCKED);            
          }
          else if (table->composedPK != NO_PRIMARY_KEY) // Composed primary key.
@@ -4701,6 +4733,7 @@ LB_API void lRSMD_getPKColumnNames_s(NMParams p)
             {
                if (!(array[i] = TC_createStringObjectFromCharP(context, columnNames[composedPKCols[i]], -1)))
                   goto finish;
+               WRITE_BARRIER(p->retO, array[i]);
                TC_setObjectLock(array[i], UNLOCKED);    
             }      
          }
@@ -4743,7 +4776,7 @@ LB_API void lRSMD_getDefaultValue_i(NMParams p)
       SQLResultSetField* field = rsBag->selectClause->fieldList[p->i32[0] - 1];
       
       // Gets the table column info.
-      TC_JCharP2CharPBuf(String_charsStart(nameObj), String_charsLen(nameObj), nameCharP);
+      TC_String2CharPBufLen(nameObj, String_charsLen(nameObj), nameCharP);
       
       // Returns the default value of the column or the parameter of a function.
       TC_setObjectLock(p->retO = getDefault(context, rsBag, nameCharP, field->parameter? field->parameter->tableColIndex : field->tableColIndex), UNLOCKED);
@@ -4776,12 +4809,12 @@ LB_API void lRSMD_getDefaultValue_s(NMParams p)
    {
       ResultSet* rsBag = getResultSetBag(resultSet);
       TCObject columnNameStr = p->obj[1];
+      JCharP columnNameJCharP;
 
-      if (columnNameStr)
+      if (columnNameStr && (columnNameJCharP = TC_widenString(p->currentContext, columnNameStr)))
       {
          SQLResultSetField** fields = rsBag->selectClause->fieldList; 
          SQLResultSetField* field; 
-         JCharP columnNameJCharP = String_charsStart(columnNameStr);
          int32 i = -1,
                length = rsBag->selectClause->fieldsCount,
                columnNameLength = String_charsLen(columnNameStr);
@@ -4810,7 +4843,7 @@ LB_API void lRSMD_getDefaultValue_s(NMParams p)
             xfree(tableColName);
          }
       }
-      else // The column name can't be null.
+      else if (!columnNameStr) // The column name can't be null.
          TC_throwNullArgumentException(context, "columnName");
    }
    
@@ -5000,15 +5033,20 @@ LB_API void lPS_executeUpdate(NMParams p) // litebase/PreparedStatement public n
             case CMD_CREATE_TABLE:
             {
                TCObject sqlExpression = OBJ_PreparedStatementSqlExpression(stmt);
+               JCharP sqlChars = TC_widenString(context, sqlExpression);
                
-               litebaseExecute(context, driver, String_charsStart(sqlExpression), String_charsLen(sqlExpression));
+               if (sqlChars)
+                  litebaseExecute(context, driver, sqlChars, String_charsLen(sqlExpression));
                p->retI = 0;
                break;
             }
             default: // alter table or drop
             {
                TCObject sqlExpression = OBJ_PreparedStatementSqlExpression(stmt);               
-               p->retI = litebaseExecuteUpdate(context, driver, String_charsStart(sqlExpression), String_charsLen(sqlExpression));
+               JCharP sqlChars = TC_widenString(context, sqlExpression);
+
+               if (sqlChars)
+                  p->retI = litebaseExecuteUpdate(context, driver, sqlChars, String_charsLen(sqlExpression));
             }
          }
       }
@@ -5128,14 +5166,34 @@ LB_API void lPS_setString_is(NMParams p) // litebase/PreparedStatement public na
       {
          TCObject string = p->obj[1];
          int32 index = p->i32[0];
+
+         if (string && String_isLatin1(string)) // The statement keeps a pointer to the chars, so a compact string is copied as UTF-16.
+         {
+            TCObject copy = TC_createStringObjectWithLen(p->currentContext, String_charsLen(string));
+            uint8* from = String_latin1Start(string);
+            JCharP to;
+            int32 length = String_charsLen(string);
+            
+            if (!copy)
+               goto finish;
+            TC_setObjectLock(copy, UNLOCKED);
+            to = String_charsStart(copy);
+            while (length-- > 0)
+               *to++ = *from++;
+            string = copy;
+         }
       
          // juliana@238_1: corrected the end quote not appearing in the log files after dates. 
          // juliana@222_8: stores the object so that it won't be collected.
          if (psSetStringParamValue(p->currentContext, stmt, string, index, string? String_charsLen(string) : 0)) // Sets the string parameter.
+         {
             ((TCObject*)ARRAYOBJ_START(OBJ_PreparedStatementObjParams(stmt)))[index] = string; 
+            WRITE_BARRIER(OBJ_PreparedStatementObjParams(stmt), string);
+         }
       }
    }
    
+finish: ;
    MEMORY_TEST_END
 }
 
@@ -5194,6 +5252,7 @@ LB_API void lPS_setBlob_iB(NMParams p) // litebase/PreparedStatement public nati
          }
 
          objParams[index] = p->obj[1]; // juliana@222_8: stores the object so that it won't be collected.
+         WRITE_BARRIER(OBJ_PreparedStatementObjParams(stmt), p->obj[1]);
 
          if (OBJ_PreparedStatementStoredParams(stmt)) // Only stores the parameter if there are parameters to be stored.
          {
@@ -5251,12 +5310,13 @@ LB_API void lPS_setDate_id(NMParams p)
          // juliana@238_1: corrected the end quote not appearing in the log files after dates. 
          if (date)
          {
-            if (!dateBufObj || String_charsLen(dateBufObj) < 10)
+            if (!dateBufObj || String_isLatin1(dateBufObj) || String_charsLen(dateBufObj) < 10) // the chars are written as UTF-16
             {
                if (!(dateBufObj = TC_createStringObjectWithLen(context, 10)))
 		            goto finish;
                TC_setObjectLock(dateBufObj, UNLOCKED);
                objParams[index] = dateBufObj; // juliana@222_8: stores the object so that it won't be collected.
+               WRITE_BARRIER(OBJ_PreparedStatementObjParams(stmt), dateBufObj);
             }
             else
                xmemzero(String_charsStart(dateBufObj), String_charsLen(dateBufObj) << 1);
@@ -5325,12 +5385,13 @@ LB_API void lPS_setDateTime_it(NMParams p)
          // juliana@238_1: corrected the end quote not appearing in the log files after dates. 
          if (time)
          {
-            if (!dateTimeBufObj || String_charsLen(dateTimeBufObj) < 23)
+            if (!dateTimeBufObj || String_isLatin1(dateTimeBufObj) || String_charsLen(dateTimeBufObj) < 23) // the chars are written as UTF-16
             {
                if (!(dateTimeBufObj = TC_createStringObjectWithLen(context, 23)))
 		            goto finish;
                TC_setObjectLock(dateTimeBufObj, UNLOCKED);
                objParams[index] = dateTimeBufObj; // juliana@222_8: stores the object so that it won't be collected.
+               WRITE_BARRIER(OBJ_PreparedStatementObjParams(stmt), dateTimeBufObj);
             }
             else
                xmemzero(String_charsStart(dateTimeBufObj), String_charsLen(dateTimeBufObj) << 1);
@@ -5466,7 +5527,7 @@ LB_API void lPS_toString(NMParams p) // litebase/PreparedStatement public native
       {
          TCObject string;
          int16* paramsPos = getPreparedStatementParamsPos(statement);
-		   JCharP sql = String_charsStart(OBJ_PreparedStatementSqlExpression(statement)),
+		   JCharP sql = TC_widenString(p->currentContext, OBJ_PreparedStatementSqlExpression(statement)),
 		          charsStart;
          JCharP* paramsAsStrs = getPreparedStatementParamsAsStrs(statement);
 
@@ -5476,6 +5537,9 @@ LB_API void lPS_toString(NMParams p) // litebase/PreparedStatement public native
                i = -1,
                length;
 
+         if (!sql)
+            goto finish;
+
 		   // juliana@202_15: Corrected a bug that would cause a gpf or a reset when logging a prepared statement with a null value.
          while (++i < storedParams)
 			   debugLen += TC_JCharPLen(paramsAsStrs[i]) + paramsPos[i + 1] - paramsPos[i] - 1;
@@ -5525,9 +5589,12 @@ LB_API void lPS_close(NMParams p) // litebase/PreparedStatement public native vo
       TCObject statement = p->obj[0];
       Hashtable* htPS = getLitebaseHtPS(OBJ_PreparedStatementDriver(statement));
       TCObject sqlExpression = OBJ_PreparedStatementSqlExpression(statement);
-      int32 hashCode = TC_JCharPHashCode(String_charsStart(sqlExpression), String_charsLen(sqlExpression));
-      TC_htRemove(htPS, hashCode);
-      freePreparedStatement(0, statement);
+      JCharP sqlChars = TC_widenString(p->currentContext, sqlExpression);
+      if (sqlChars)
+      {
+         TC_htRemove(htPS, TC_JCharPHashCode(sqlChars, String_charsLen(sqlExpression)));
+         freePreparedStatement(0, statement);
+      }
    }
    MEMORY_TEST_END
 }
@@ -224,7 +224,7 @@ bool psSetStringParamValue(Context context, TCObject stmt, TCObject string, int3
    SQLSelectStatement* statement = (SQLSelectStatement*)getPreparedStatementStatement(stmt);
    JCharP stringChars = null;
    
-   if (string)
+   if (string) // A compact string parameter was already copied as UTF-16 by setString().
       stringChars = String_charsStart(string);
 
    switch (statement->type) // Sets the parameter.
@@ -293,13 +293,13 @@ TCObject toStringBuffer(Context context, TCObject statement)
    if (OBJ_PreparedStatementStoredParams(statement)) // There are no parameters.
    {
       int16* paramsPos = getPreparedStatementParamsPos(statement);
-		JCharP sql = String_charsStart(OBJ_PreparedStatementSqlExpression(statement));
+		JCharP sql = TC_widenString(context, OBJ_PreparedStatementSqlExpression(statement));
       JCharP* paramsAsStrs = getPreparedStatementParamsAsStrs(statement);
       int32 storedParams = OBJ_PreparedStatementStoredParams(statement),
             i = -1;
       
       // PREP: + string before the first '?'.     
-      if (!TC_appendCharP(context, logSBuffer, "PREP: ") || !TC_appendJCharP(context, logSBuffer, sql, paramsPos[0]))
+      if (!sql || !TC_appendCharP(context, logSBuffer, "PREP: ") || !TC_appendJCharP(context, logSBuffer, sql, paramsPos[0]))
          return null;
       
       // Concatenates each string part with the next parameter.
@@ -312,7 +312,7 @@ TCObject toStringBuffer(Context context, TCObject statement)
    else
    {
       TCObject sql = OBJ_PreparedStatementSqlExpression(statement);
-      if (!TC_appendJCharP(context, logSBuffer, String_charsStart(sql), String_charsLen(sql)))
+      if (!appendString(context, logSBuffer, sql))
          return null;
    }
    
@@ -573,7 +573,7 @@ void getStrings(NMParams params, int32 count) // juliana@201_2: corrected a bug
          // juliana@230_14: removed temporary tables when there is no join, group by, order by, and aggregation.
          TCObject* strings; 
          TCObject* matrixEntry;
-         TCObject result;
+         TCObject result, row;
          int8* columnTypes = table->columnTypes;
          uint8* columnNulls0 = table->columnNulls;
          SQLValue value;
@@ -618,9 +618,10 @@ void getStrings(NMParams params, int32 count) // juliana@201_2: corrected a bug
                return;
             }
             TC_setObjectLock(*matrixEntry, UNLOCKED);
+            WRITE_BARRIER(result, *matrixEntry);
             
             // We will hold the found objects in the native stack to avoid them being collected.
-            strings = (TCObject*)ARRAYOBJ_START(*(matrixEntry++));
+            strings = (TCObject*)ARRAYOBJ_START(row = *(matrixEntry++));
             i = -1;
             while (++i < cols)
             {
@@ -660,6 +661,7 @@ void getStrings(NMParams params, int32 count) // juliana@201_2: corrected a bug
                }
                else
                   *strings++ = null;
+               WRITE_BARRIER(row, strings[-1]);
             }
 			   validRecords++; // juliana@211_4: solved bugs with result set dealing.
          }
@@ -674,6 +676,8 @@ void getStrings(NMParams params, int32 count) // juliana@201_2: corrected a bug
             if (!(matrix = TC_createArrayObject(context,"[[java.lang.String", validRecords)))
 				   return;
 			   xmemmove(ARRAYOBJ_START(matrix), matrixEntry, TSIZE * validRecords); 
+            for (i = 0; i < validRecords; i++)
+               WRITE_BARRIER(matrix, matrixEntry[i]);
 			   TC_setObjectLock(params->retO = matrix, UNLOCKED);
 		   }
       }
@@ -1130,11 +1134,15 @@ int32 identHashCode(TCObject stringObj)
 	TRACE("identHashCode")
    int32 hash = 0,
          value;
-   uint32 length = String_charsLen(stringObj);
-   JCharP chars = String_charsStart(stringObj);
-   while (length--)
+   uint32 length = String_charsLen(stringObj),
+          i = 0;
+   bool isLatin1 = String_isLatin1(stringObj);
+   JCharP chars = isLatin1? null : String_charsStart(stringObj);
+   uint8* bytes = isLatin1? String_latin1Start(stringObj) : null;
+   
+   for (; i < length; i++)
    {
-      value = (int32)*chars++;
+      value = isLatin1? (int32)bytes[i] : (int32)chars[i];
       if (value >= (int32)'A' && value <= (int32)'Z') // guich@104
          value += 32;
       hash = (hash << 5) - hash + value; // It was 31 * hash.
@@ -86,11 +86,15 @@ void initTCVMLib()
    TC_str2double = GETPROCADDRESS(str2double);
    TC_str2int = GETPROCADDRESS(str2int);
    TC_str2long = GETPROCADDRESS(str2long);
+   TC_String2CharPBufLen = GETPROCADDRESS(String2CharPBufLen);
+   TC_String2TCHARPBufLen = GETPROCADDRESS(String2TCHARPBufLen);
    TC_throwExceptionNamed = GETPROCADDRESS(throwExceptionNamed);
    TC_throwNullArgumentException = GETPROCADDRESS(throwNullArgumentException);
    TC_toLower = GETPROCADDRESS(toLower);
    TC_trace = GETPROCADDRESS(trace);
    TC_validatePath = GETPROCADDRESS(validatePath); // juliana@214_1
+   TC_widenString = GETPROCADDRESS(widenString);
+   TC_writeBarrier = GETPROCADDRESS(writeBarrier);
 #ifdef ENABLE_MEMORY_TEST
    TC_getCountToReturnNull = GETPROCADDRESS(getCountToReturnNull);
    TC_setCountToReturnNull = GETPROCADDRESS(setCountToReturnNull);
@@ -168,12 +172,16 @@ TESTCASE(initTCVMLib)
    ASSERT1_EQUALS(NotNull, TC_str2double);
    ASSERT1_EQUALS(NotNull, TC_str2int);
    ASSERT1_EQUALS(NotNull, TC_str2long);
+   ASSERT1_EQUALS(NotNull, TC_String2CharPBufLen);
+   ASSERT1_EQUALS(NotNull, TC_String2TCHARPBufLen);
    ASSERT1_EQUALS(NotNull, TC_throwExceptionNamed);
    ASSERT1_EQUALS(NotNull, TC_throwNullArgumentException);
    ASSERT1_EQUALS(NotNull, TC_tiF_create_sii);
    ASSERT1_EQUALS(NotNull, TC_toLower);
    ASSERT1_EQUALS(NotNull, TC_trace);
    ASSERT1_EQUALS(NotNull, TC_validatePath); // juliana@214_1
+   ASSERT1_EQUALS(NotNull, TC_widenString);
+   ASSERT1_EQUALS(NotNull, TC_writeBarrier);
 
 #ifdef ENABLE_MEMORY_TEST
    ASSERT1_EQUALS(NotNull, TC_getCountToReturnNull);
@@ -2933,6 +2933,7 @@ bool freeTable(Context context, Table* table, bool isDelete, bool updatePos)
       {
          Hashtable* htPS;
          TCObject sqlObj;
+         JCharP sqlChars;
          do
 		   {
             // juliana@226_16: prepared statement is now a singleton.
@@ -2940,7 +2941,8 @@ bool freeTable(Context context, Table* table, bool isDelete, bool updatePos)
             {
                htPS = getLitebaseHtPS(OBJ_PreparedStatementDriver(obj));
 				   sqlObj = OBJ_PreparedStatementSqlExpression(obj);
-               TC_htRemove(htPS, TC_JCharPHashCode(String_charsStart(sqlObj), String_charsLen(sqlObj)));
+               if ((sqlChars = TC_widenString(context, sqlObj)))
+                  TC_htRemove(htPS, TC_JCharPHashCode(sqlChars, String_charsLen(sqlObj)));
                freePreparedStatement(0, obj);
             }
 			   list = TC_TCObjectsRemove(list, obj);
@@ -3062,7 +3064,7 @@ Table* getTableFromName(Context context, TCObject driver, TCObject name)
       return null;
    }
 
-   TC_JCharP2CharPBuf(String_charsStart(name), length, tableName);
+   TC_String2CharPBufLen(name, length, tableName);
    TC_CharPToLower(tableName);
    return getTable(context, driver, tableName);
 }
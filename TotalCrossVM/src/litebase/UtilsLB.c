@@ -292,6 +292,21 @@ JCharP str16LeftTrim(JCharP string16Str, int32* string16Len)
    return string16Str;
 }
 
+/**
+ * Appends a string to a string buffer. A compact string is widened into a temporary array.
+ *
+ * @param context The thread context where the function is being executed.
+ * @param stringBuffer The string buffer.
+ * @param string The string to be appended.
+ * @return <code>false</code> if an <code>OutOfMemoryError</code> was thrown; <code>true</code>, otherwise.
+ */
+bool appendString(Context context, TCObject stringBuffer, TCObject string)
+{
+	TRACE("appendString")
+   JCharP chars = TC_widenString(context, string);
+   return chars && TC_appendJCharP(context, stringBuffer, chars, String_charsLen(string));
+}
+
 /**
  * Verifies if a string is a valid Date and transforms it into a correspondent int date. 
  *
@@ -170,6 +170,9 @@ TC_API void tugG_fillPolygonGradient_IIi(NMParams p);
 TC_API void tugG_getRGB_Iiiiii(NMParams p);
 TC_API void tugG_setRGB_Iiiiii(NMParams p);
 TC_API void tugG_fadeScreen_i(NMParams p);
+TC_API void tugG_startRecording_d(NMParams p);
+TC_API void tugG_stopRecording(NMParams p);
+TC_API void tugG_replay_d(NMParams p);
 TC_API void tugG_drawText_Ciiiibi(NMParams p);
 TC_API void tugG_drawText_siiiibi(NMParams p);
 TC_API void tugG_drawText_siiiiibi(NMParams p);
@@ -195,6 +198,7 @@ TC_API void tuW_pumpEvents(NMParams p);
 TC_API void tuW_setSIP_icb(NMParams p);
 TC_API void tuW_setDeviceTitle_s(NMParams p);
 TC_API void tuW_setOrientation_i(NMParams p);
+TC_API void tuW_getFrameStats_I(NMParams p);
 TC_API void tuW_isSipShown(NMParams p);
 TC_API void tsCC_bytes2chars_Bii(NMParams p);
 TC_API void tsCC_chars2bytes_Cii(NMParams p);
@@ -241,6 +245,7 @@ TC_API void tsT_update(NMParams p);
 TC_API void tsS_refresh(NMParams p);
 TC_API void tsV_arrayCopy_oioii(NMParams p);
 TC_API void tsV_preallocateArray_oi(NMParams p);
+TC_API void tsV_saveStartupSnapshot(NMParams p);
 TC_API void tsV_getTimeStamp(NMParams p);
 TC_API void tsV_setTime_t(NMParams p);
 TC_API void tsV_exitAndReboot(NMParams p);
@@ -362,6 +367,10 @@ TC_API void jlS_valueOf_l(NMParams p);
 TC_API void jlS_lastIndexOf_s(NMParams p);
 TC_API void jlS_lastIndexOf_si(NMParams p);
 TC_API void jlS_getBytes(NMParams p);
+TC_API void jlS_concat_s(NMParams p);
+TC_API void jlS_copyOf_Cii(NMParams p);
+TC_API void jlS_compact_C(NMParams p);
+TC_API void jlS_toUTF16_C(NMParams p);
 TC_API void jlSB_ensureCapacity_i(NMParams p);
 TC_API void jlSB_setLength_i(NMParams p);
 TC_API void jlSB_append_s(NMParams p);
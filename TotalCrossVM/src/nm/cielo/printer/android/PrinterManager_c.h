@@ -6,8 +6,8 @@
 static Err cieloPrintManagerPrintText (TCObject textToPrint, TCObject printerAttributes, TCObject printerListener) {
    JNIEnv* env = getJNIEnv();
    jmethodID cieloPrintManagerPrintTextMethod = (*env)->GetStaticMethodID(env, jCieloPrinterManager4A, "cieloPrintManagerPrintText", "(Ljava/lang/String;Ljava/lang/String;)V");
-   jstring jTextToPrint = (*env)->NewString(env, String_charsStart(textToPrint), String_charsLen(textToPrint));
-   jstring jPrinterAttributes = (printerAttributes != null) ? (*env)->NewString(env, String_charsStart(printerAttributes), String_charsLen(printerAttributes)) : null;
+   jstring jTextToPrint = String2jstring(env, textToPrint);
+   jstring jPrinterAttributes = String2jstring(env, printerAttributes);
    
    (*env)->CallStaticObjectMethod(env, jCieloPrinterManager4A, cieloPrintManagerPrintTextMethod, jTextToPrint, jPrinterAttributes);
    (*env)->DeleteLocalRef(env, jTextToPrint);
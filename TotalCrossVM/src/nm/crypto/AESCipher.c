@@ -20,6 +20,7 @@ TC_API void tccAESC_init(NMParams p) // totalcross/crypto/digest/AESCipher nativ
    if ((cipherObj = createByteArray(p->currentContext, sizeof(AES_CTX))) != null)
    {
       *Cipher_cipherRef(aesObj) = cipherObj; // guich@tc110_98: store in a byte array
+      WRITE_BARRIER(aesObj, cipherObj);
       setObjectLock(cipherObj, UNLOCKED);
    }
 }
@@ -44,6 +45,7 @@ TC_API void tccAESC_doReset(NMParams p) // totalcross/crypto/cipher/AESCipher na
       get_random_NZ(AES_BLOCKSIZE, ARRAYOBJ_START(iv));
       RNG_terminate();
       *Cipher_iv(aesObj) = iv;
+      WRITE_BARRIER(aesObj, iv);
       setObjectLock(iv, UNLOCKED);
    }
 
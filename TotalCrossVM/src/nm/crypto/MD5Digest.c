@@ -17,6 +17,7 @@ TC_API void tcdMD5D_init(NMParams p) // totalcross/crypto/digest/MD5Digest nativ
    if ((digestObj = createByteArray(p->currentContext, sizeof(MD5_CTX))) != null)
    {
       *Digest_digestRef(md5dObj) = digestObj;
+      WRITE_BARRIER(md5dObj, digestObj);
       setObjectLock(digestObj, UNLOCKED);
    }
 }
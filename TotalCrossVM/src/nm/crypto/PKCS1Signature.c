@@ -194,6 +194,7 @@ TC_API void tcsPKCS1S_init(NMParams p) // totalcross/crypto/signature/PKCS1Signa
    if ((signatureObj = createByteArray(p->currentContext, sizeof(RSA_CTX))) == null)
       goto cleanup;
    *Signature_signatureRef(pkcs1Obj) = signatureObj;
+   WRITE_BARRIER(pkcs1Obj, signatureObj);
 
 cleanup:
    if (signatureObj)
@@ -16,7 +16,10 @@ TC_API void tccRSAC_init(NMParams p) // totalcross/crypto/digest/RSACipher nativ
    TCObject cipherObj;
 
    if ((cipherObj = createByteArray(p->currentContext, sizeof(RSA_CTX))) != null)
+   {
       *Cipher_cipherRef(rsacObj) = cipherObj;
+      WRITE_BARRIER(rsacObj, cipherObj);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tccRSAC_finalize(NMParams p) // totalcross/crypto/digest/RSACipher native protected final void finalize();
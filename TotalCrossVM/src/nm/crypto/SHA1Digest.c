@@ -17,6 +17,7 @@ TC_API void tcdSHA1D_init(NMParams p) // totalcross/crypto/digest/SHA1Digest nat
    if ((digestObj = createByteArray(p->currentContext, sizeof(SHA1_CTX))) != null)
    {
       *Digest_digestRef(sha1dObj) = digestObj;
+      WRITE_BARRIER(sha1dObj, digestObj);
       setObjectLock(digestObj, UNLOCKED);
    }
 }
@@ -17,6 +17,7 @@ TC_API void tcdSHA256D_init(NMParams p) // totalcross/crypto/digest/SHA256Digest
    if ((digestObj = createByteArray(p->currentContext, sizeof(SHA256_CTX))) != null)
    {
       *Digest_digestRef(sha256dObj) = digestObj;
+      WRITE_BARRIER(sha256dObj, digestObj);
       setObjectLock(digestObj, UNLOCKED);
    }
 }
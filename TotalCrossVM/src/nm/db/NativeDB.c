@@ -139,24 +139,29 @@ TC_API void tdsNDB_enable_load_extension_b(NMParams p) // totalcross/db/sqlite/N
 
 static CharP newSafeString(TCObject strObj, int32 *outlen)
 {
-   JCharP js = String_charsStart(strObj);
+   JCharP js;
    int32 len = String_charsLen(strObj);
    CharP ret;
    
    if (OBJ_CLASS(*charConverterPtr) == UTF8CharacterConverter)
    {
-      int32 utflen = utf8len(js, len);
+      int32 utflen;
+      bool latin1 = String_isLatin1(strObj);
+      js = latin1 ? String2JCharP(strObj) : String_charsStart(strObj); // a compact string is widened into a copy
+      utflen = utf8len(js, len);
       if (outlen) *outlen = utflen;
       ret = (CharP)xmalloc(utflen+16); // put 8 bytes before and 8 after the string
       ret += 8;
       utf8chars2bytesBuf(js, len, ret);
+      if (latin1)
+         xfree(js);
    }
    else
    {
       if (outlen) *outlen = len;
       ret = (CharP)xmalloc(len+16); // put 8 bytes before and 8 after the string
       ret += 8;
-      JCharP2CharPBuf(js, len, ret);      
+      String2CharPBufLen(strObj, len, ret);
    }
    return ret;
 }
@@ -584,8 +589,8 @@ TC_API void tdsNDB_result_text_ls(NMParams p) // totalcross/db/sqlite/NativeDB n
     else
     {
        size = String_charsLen(value);
-       str = String_charsStart(value);
-       sqlite3_result_text16(toref(context), str, size, SQLITE_TRANSIENT);
+       if ((str = widenString(p->currentContext, value)) != null)
+          sqlite3_result_text16(toref(context), str, size, SQLITE_TRANSIENT);
     }
    UNLOCKDB
 }
@@ -685,6 +690,7 @@ TC_API void tdsNDB_column_metadata_l(NMParams p) // totalcross/db/sqlite/NativeD
         ab[2] = pAutoinc;
 
         *oa++ = colData;
+        WRITE_BARRIER(boolArray, colData);
         setObjectLock(colData, UNLOCKED);
     }
 
@@ -76,6 +76,8 @@ void JNICALL Java_totalcross_Launcher4A_nativeOnMessageReceived(JNIEnv *env, jcl
 	  		CharP value = (*env)->GetStringUTFChars(env, (jstring) (*env)->GetObjectArrayElement(env, values, i), 0);
 	  		*((TCObjectArray) ARRAYOBJ_START(keysArray) + i) = createStringObjectFromCharP(mainContext, key, -1);
 	  		*((TCObjectArray) ARRAYOBJ_START(valuesArray) + i) = createStringObjectFromCharP(mainContext, value, -1);  
+	  		WRITE_BARRIER(keysArray, *((TCObjectArray) ARRAYOBJ_START(keysArray) + i));
+	  		WRITE_BARRIER(valuesArray, *((TCObjectArray) ARRAYOBJ_START(valuesArray) + i));
 	  	}
 	}
 	
@@ -39,7 +39,12 @@
 // java.lang.String
 #define String_chars(o)             ((o)->asObj)  // String has a single field, "char[] chars", and since it is widely used, we'll do an optimization here, not using FIELD_OBJ
 #define String_charsLen(o)          (ARRAYOBJ_LEN(String_chars(o)))
-#define String_charsStart(o)        ((JCharP)(ARRAYOBJ_START(String_chars(o))))
+#define String_charsStart(o)        ((JCharP)(ARRAYOBJ_START(String_chars(o)))) // only for a string that is not compact, like the ones created by createStringObjectWithLen; the others are read with widenString or the String2* functions
+// compact strings: when the characters of a String all fit in Latin-1, "chars" may hold a byte array instead of a char array
+#define String_isLatin1(o)          (OBJ_CLASS(String_chars(o))->flags.bits2shift == 0)
+#define String_latin1Start(o)       ((uint8*)(ARRAYOBJ_START(String_chars(o))))
+#define String_hashCache(o)         FIELD_I64(o, OBJ_CLASS(o), 0) // the hash code is in the low 32 bits, once STRING_HASH_CACHED is set; a string with a cached hash must not have its chars changed
+#define STRING_HASH_CACHED          0x100000000LL
 
 // java.lang.StringBuffer
 #define StringBuffer_chars(o)       FIELD_OBJ(o, OBJ_CLASS(o), 0)
@@ -148,6 +153,15 @@
 #define Graphics_xPoints(o)         FIELD_OBJ(o, OBJ_CLASS(o), 2)
 #define Graphics_yPoints(o)         FIELD_OBJ(o, OBJ_CLASS(o), 3)
 #define Graphics_ints(o)            FIELD_OBJ(o, OBJ_CLASS(o), 4)
+#define Graphics_displayList(o)     FIELD_OBJ(o, OBJ_CLASS(o), 5)
+
+// totalcross.ui.gfx.DisplayList
+#define DisplayList_cmds(o)         FIELD_OBJ(o, OBJ_CLASS(o), 0)
+#define DisplayList_refs(o)         FIELD_OBJ(o, OBJ_CLASS(o), 1)
+#define DisplayList_count(o)        FIELD_I32(o, 0)
+#define DisplayList_refCount(o)     FIELD_I32(o, 1)
+#define DisplayList_valid(o)        FIELD_I32(o, 2)
+#define DisplayList_failed(o)       FIELD_I32(o, 3)
 
 // totalcross.ui.image.Image
 #define Image_width(o)              FIELD_I32(o, 1)
@@ -121,12 +121,13 @@ TC_API void tiF_create_sii(NMParams p) // totalcross/io/File native private void
 #ifdef ENABLE_TEST_SUITE
    File_slot(file) = slot;
    File_path(file) = path;
+   WRITE_BARRIER(file, path);
    File_mode(file) = mode;
 #endif
 
    if (mode != DONT_OPEN)
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (IS_DEBUG_CONSOLE(szPath))
          mode = READ_ONLY;
       if (!replacePath(p,szPath,true))
@@ -140,6 +141,7 @@ TC_API void tiF_create_sii(NMParams p) // totalcross/io/File native private void
       if ((fileRef = createByteArray(p->currentContext, sizeof(NATIVE_FILE))) != null) // created fileRef will be unlocked only in native close
       {
          File_fileRef(file) = fileRef;
+         WRITE_BARRIER(file, fileRef);
          natFile = (NATIVE_FILE*) ARRAYOBJ_START(fileRef);
          if ((err = fileCreate(natFile, szPath, mode, &File_slot(file))) != NO_ERROR)
          {
@@ -234,7 +236,7 @@ TC_API void tiF_createDir(NMParams p) // totalcross/io/File native public void c
    else
    {
       int stringSize = String_charsLen(path);
-      JCharP2TCHARPBuf(String_charsStart(path), stringSize, szPath);
+      String2TCHARPBufLen(path, stringSize, szPath);
       if (!replacePath(p,szPath,true))
          return;
       if (fileExists(szPath, slot))
@@ -266,7 +268,7 @@ TC_API void tiF_delete(NMParams p) // totalcross/io/File native public void dele
       throwException(p->currentContext, IOException, "Operation cannot be used in READ_ONLY mode");
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
       if (!fileExists(szPath, slot))
@@ -295,7 +297,7 @@ TC_API void tiF_exists(NMParams p) // totalcross/io/File native public boolean e
       throwException(p->currentContext, IOException, "Invalid file object.");
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,false))
          p->retI = false;
       else
@@ -320,7 +322,7 @@ TC_API void tiF_getSize(NMParams p) // totalcross/io/File native public int getS
    else
    {
       int32 len;
-      JCharP2TCHARPBuf(String_charsStart(path), len=String_charsLen(path), szPath);
+      String2TCHARPBufLen(path, len=String_charsLen(path), szPath);
       if (len > 0 && szPath[len-1] == '/')
       {
          if ((err = fileGetFreeSpace(szPath, &size, slot)) != NO_ERROR)
@@ -358,7 +360,7 @@ TC_API void tiF_isDir(NMParams p) // totalcross/io/File native public boolean is
       p->retI = false;
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
       if (fileExists(szPath, slot))
@@ -395,7 +397,7 @@ TC_API void tiF_listFiles(NMParams p) // totalcross/io/File native public String
       throwException(p->currentContext, IOException, "Operation can ONLY be used in mode DONT_OPEN.");
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
 #if defined(WIN32) && !defined(WINCE)
@@ -426,7 +428,10 @@ TC_API void tiF_listFiles(NMParams p) // totalcross/io/File native public String
             {
                *start = createStringObjectFromTCHAR(p->currentContext, list->value, -1);
                if (*start)
+               {
+                  WRITE_BARRIER(arrayObj, *start);
                   setObjectLock(*start, UNLOCKED);
+               }
                else
                   break;
             }
@@ -506,13 +511,13 @@ TC_API void tiF_rename_s(NMParams p) // totalcross/io/File native public boolean
          throwIllegalArgumentIOException(p->currentContext, "path", null);
       else
       {
-         JCharP2TCHARPBuf(String_charsStart(currPath), String_charsLen(currPath), szCurrPath);
+         String2TCHARPBuf(currPath, szCurrPath);
 
          if (!fileExists(szCurrPath, slot))
             throwFileNotFoundException(p->currentContext, szCurrPath);
          else
          {
-            JCharP2TCHARPBuf(String_charsStart(newPath), newPathLen, szNewPath);
+            String2TCHARPBufLen(newPath, newPathLen, szNewPath);
             c = szNewPath;
             while (*c != 0)
             {
@@ -555,7 +560,7 @@ TC_API void tiF_setPos_i(NMParams p) // totalcross/io/File native public void se
       throwException(p->currentContext, IOException, "Argument 'pos' cannot be negative");
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
       fref = (NATIVE_FILE*) ARRAYOBJ_START(fileRef);
@@ -639,7 +644,7 @@ TC_API void tiF_setAttributes_i(NMParams p) // totalcross/io/File native public
       throwIllegalArgumentIOException(p->currentContext, "attr", null);
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
 
@@ -667,7 +672,7 @@ TC_API void tiF_getAttributes(NMParams p) // totalcross/io/File native public in
       throwException(p->currentContext, IOException, "Operation cannot be used in DONT_OPEN mode");
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
 
@@ -707,7 +712,7 @@ TC_API void tiF_setTime_bt(NMParams p) // totalcross/io/File native public void
       throwIllegalArgumentIOException(p->currentContext, "whichTime", null);
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
 
@@ -739,7 +744,7 @@ TC_API void tiF_getTime_b(NMParams p) // totalcross/io/File native public totalc
       throwIllegalArgumentIOException(p->currentContext, "whichTime", null);
    else
    {
-      JCharP2TCHARPBuf(String_charsStart(path), String_charsLen(path), szPath);
+      String2TCHARPBuf(path, szPath);
       if (!replacePath(p,szPath,true))
          return;
 
@@ -857,7 +862,10 @@ TC_API void tiF_listRoots(NMParams p) // totalcross/io/File native public static
          {
             *start = createStringObjectFromTCHAR(p->currentContext, list->value, -1);
             if (*start)
+            {
+               WRITE_BARRIER(arrayObj, *start);
                setObjectLock(*start, UNLOCKED);
+            }
             else
                break;
          }
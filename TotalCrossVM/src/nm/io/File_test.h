@@ -700,7 +700,7 @@ TESTCASE(tiF_listFiles) // totalcross/io/File native public String []listFiles()
    found = false;
    while (--count >= 0 && !found)
    {
-      s = JCharP2TCHARP(String_charsStart(list[count]), String_charsLen(list[count]));
+      s = String2TCHARP(list[count]);
       if (tcscmp(s, TEXT("tiF_ListFiles.test")) == 0)
          found = true;
       xfree(s);
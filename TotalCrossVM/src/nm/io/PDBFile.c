@@ -171,10 +171,11 @@ TC_API void tiPDBF_create_sssi(NMParams p) // totalcross/io/PDBFile native priva
    dbId = dbP;
    PDBFile_dbId(pdbFile) = dbIdObj;
    PDBFile_openRef(pdbFile) = dbPObj;
+   WRITE_BARRIER(pdbFile, dbPObj);
 
-   JCharP2TCHARPBuf(String_charsStart(name), String_charsLen(name), szName);
-   JCharP2TCHARPBuf(String_charsStart(creator), String_charsLen(creator), szCreator);
-   JCharP2TCHARPBuf(String_charsStart(type), String_charsLen(type), szType);
+   String2TCHARPBuf(name, szName);
+   String2TCHARPBuf(creator, szCreator);
+   String2TCHARPBuf(type, szType);
    creatorId = chars2int(szCreator);
    typeId = chars2int(szType);
 
@@ -285,7 +286,7 @@ TC_API void tiPDBF_rename_s(NMParams p) // totalcross/io/PDBFile native public v
       else
       {
          char tbuf[256];
-         JCharP2TCHARPBuf(String_charsStart(newName), String_charsLen(newName), szNewPath);
+         String2TCHARPBuf(newName, szNewPath);
          if (!splitName(szNewPath, &szNewName, &szCreator, &szType)) // split full name into NAME, CREATOR and TYPE
             throwIllegalArgumentIOException(p->currentContext, "newName", TCHARP2CharPBuf(szNewPath, tbuf));
          else
@@ -462,6 +463,7 @@ TC_API void tiPDBF_listPDBs_ii(NMParams p) // totalcross/io/PDBFile native publi
             if (list->value != null)
             {
                *array = createStringObjectFromTCHAR(p->currentContext, list->value, -1);
+               WRITE_BARRIER(p->retO, *array);
                setObjectLock(*array, UNLOCKED);
                array++;
                next = list->next;
@@ -103,6 +103,7 @@ TC_API void tidbDA_nativeDiscoveryAgent(NMParams p) // totalcross/io/device/blue
       deviceSearchP->nativeFieldsObj = nativeFieldsObj;
       deviceSearchP->nativeFields = (NATIVE_FIELDS) ARRAYOBJ_START(nativeFieldsObj);
       DiscoveryAgent_inquiryNativeFields(discoveryAgent) = inquiryNativeFields;
+      WRITE_BARRIER(discoveryAgent, inquiryNativeFields);
       UNLOCKVAR(deviceSearchP->deviceInquiry);
       setObjectLock(nativeFieldsObj, UNLOCKED);
    }
@@ -257,6 +258,7 @@ TC_API void tidbDA_startInquiry_id(NMParams p) // totalcross/io/device/bluetooth
             {
                deviceSearchP->inquiryStatus = OPERATION_IN_PROGRESS; // inquiryStarted return true, set status to OPERATION_IN_PROGRESS.
                DiscoveryAgent_deviceInquiryListener(discoveryAgent) = listener;
+               WRITE_BARRIER(discoveryAgent, listener);
             }
          }
       }
@@ -43,7 +43,10 @@ TC_API void tidbSPC_createSerialPortClient_s(NMParams p) // totalcross/io/device
 #endif         
       }
       else
+      {
          SerialPortClient_nativeHandle(serialPortClientObj) = nativeHandleObj;
+         WRITE_BARRIER(serialPortClientObj, nativeHandleObj);
+      }
       setObjectLock(nativeHandleObj, UNLOCKED);
    }
 #else
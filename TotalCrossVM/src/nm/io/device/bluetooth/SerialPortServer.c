@@ -36,7 +36,10 @@ TC_API void tidbSPS_createSerialPortServer_s(NMParams p) // totalcross/io/device
       if ((err = btsppServerCreate(nativeHandle, guid)) != NO_ERROR)
          throwExceptionWithCode(p->currentContext, IOException, err);
       else
+      {
          SerialPortServer_nativeHandle(serialPortServerObj) = nativeHandleObj;
+         WRITE_BARRIER(serialPortServerObj, nativeHandleObj);
+      }
       setObjectLock(nativeHandleObj, UNLOCKED);
    }
 #else
@@ -69,6 +72,7 @@ TC_API void tidbSPS_accept(NMParams p) // totalcross/io/device/bluetooth/SerialP
       else
       {
          SerialPortClient_nativeHandle(serialPortClientObj) = clientHandleObj;
+         WRITE_BARRIER(serialPortClientObj, clientHandleObj);
          p->retO = serialPortClientObj;
       }
       setObjectLock(clientHandleObj, UNLOCKED); // it will be unlocked by the client's close.
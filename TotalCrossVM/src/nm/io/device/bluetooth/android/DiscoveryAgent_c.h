@@ -36,6 +36,9 @@ static TCObject nativeRetrieveDevices(Context currentContext, bool isPaired)
                {
                   RemoteDevice_friendlyName(*out) = name;
                   RemoteDevice_address(*out) = addr;
+                  WRITE_BARRIER(*out, name);
+                  WRITE_BARRIER(*out, addr);
+                  WRITE_BARRIER(outArray, *out);
                   setObjectLock(*out,UNLOCKED);
                }
             }
@@ -200,6 +200,7 @@ DWORD WINAPI ThreadStartInquiry(LPVOID lpParameter)
                      // Call RemoteDevice constructor and set the object's fields
                      executeMethod(deviceSearchP->currentContext, deviceSearchP->remoteDeviceConstructor, remoteDevice, address);
                      RemoteDevice_friendlyName(remoteDevice) = friendlyName;
+                     WRITE_BARRIER(remoteDevice, friendlyName);
                      setObjectLock(address, UNLOCKED);
 
                      // Call DeviceClass constructor
@@ -454,6 +455,7 @@ Err nativeSearchServices(Context currentContext, TCObject remoteDevice, ServiceS
                            result = executeMethod(serviceSearchP->currentContext, readSDP, serviceRecord, remoteDevice, byteArray, attrSet).asInt32;
             
                            *((TCObjectArray) ARRAYOBJ_START(serviceRecordArray) + i) = serviceRecord;
+                           WRITE_BARRIER(serviceRecordArray, serviceRecord);
                            setObjectLock(serviceRecord, UNLOCKED);
                        }
                     }
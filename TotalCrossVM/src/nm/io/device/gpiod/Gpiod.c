@@ -30,6 +30,7 @@ TC_API void tidgGC_open_i(NMParams p)
         throwExceptionWithCode(p->currentContext, IOException, -1);
     } else if ((handleObj = createByteArray(p->currentContext, sizeof(NATIVE_HANDLE))) != null) {
         GpiodChip_handle(gpiodChipObj) = handleObj;
+        WRITE_BARRIER(gpiodChipObj, handleObj);
         setObjectLock(handleObj, UNLOCKED);
         nativeHandle = (NATIVE_HANDLE*) ARRAYOBJ_START(handleObj);
         
@@ -58,6 +59,7 @@ TC_API void tidgGL_open_gi(NMParams p)
         throwExceptionWithCode(p->currentContext, IOException, -2);
     } else if ((handleObj = createByteArray(p->currentContext, sizeof(NATIVE_HANDLE))) != null) {
         GpiodLine_handle(gpiodLineObj) = handleObj;
+        WRITE_BARRIER(gpiodLineObj, handleObj);
         setObjectLock(handleObj, UNLOCKED);
         nativeHandle = (NATIVE_HANDLE*) ARRAYOBJ_START(handleObj);
         
@@ -28,7 +28,7 @@ TC_API void tidsS_readBarcode_s(NMParams p) // totalcross/io/device/scanner/Scan
    jmethodID method = (*env)->GetStaticMethodID(env, applicationClass, "requestCameraPermission", "()I");
    jint result = (*env)->CallStaticIntMethod(env, applicationClass, method);
    if (result > 0) {
-       jstring jmode = mode == null ? null : (*env)->NewString(env, (jchar*) String_charsStart(mode), String_charsLen(mode));
+       jstring jmode = String2jstring(env, mode);
        jstring result = (*env)->CallStaticObjectMethod(env, applicationClass, jzxing, jmode);
        (*env)->DeleteLocalRef(env, jmode);
        if (result != null)
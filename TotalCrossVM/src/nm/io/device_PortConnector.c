@@ -59,6 +59,8 @@ TC_API void tidPC_create_iiiii(NMParams p) // totalcross/io/device/PortConnector
    {
       PortConnector_portConnector(portConnector) = portConnectorRef;
       PortConnector_receiveBuffer(portConnector) = receiveBufferObj;
+      WRITE_BARRIER(portConnector, portConnectorRef);
+      WRITE_BARRIER(portConnector, receiveBufferObj);
       portConnectorHandle = (PortHandle*) ARRAYOBJ_START(portConnectorRef);
       receiveBuffer = (VoidP*) ARRAYOBJ_START(receiveBufferObj);
       if ((err = portConnectorCreate(portConnectorHandle, *receiveBuffer, number, baudRate, bits, parity, stopBits, timeout)) != NO_ERROR)
@@ -16,6 +16,14 @@ static TCClass getTargetClass(TCObject o)
 	  xmoveptr(&ret, ARRAYOBJ_START(Class_nativeStruct(o)));
    return ret;
 }
+static void trackElements(TCObject array) // the elements were stored through pointers by the functions below
+{
+   TCObject* oa = (TCObject*)ARRAYOBJ_START(array);
+   int32 n = ARRAYOBJ_LEN(array);
+   for (; n-- > 0; oa++)
+      WRITE_BARRIER(array, *oa);
+}
+
 void createClassObject(Context currentContext, CharP className, Type type, TCObject* ret, bool* isNew)
 {
    TCObject ptrObj=null;
@@ -60,10 +68,12 @@ void createClassObject(Context currentContext, CharP className, Type type, TCObj
       {
          xmoveptr(ARRAYOBJ_START(ptrObj), &c);
          setObjectLock(Class_targetName(*ret) = createStringObjectFromCharP(currentContext,className,-1),UNLOCKED);
+         WRITE_BARRIER(*ret, Class_targetName(*ret));
       }
       if (ptrObj != null)
       {
          setObjectLock(Class_nativeStruct(*ret) = ptrObj, UNLOCKED);
+         WRITE_BARRIER(*ret, ptrObj);
          if (*ret != null)
          {
             if (isNew) *isNew = true;
@@ -101,6 +111,10 @@ static void createFieldObject(Context currentContext, Field f, int32 idx, TCObje
       setObjectLock(Field_name(*ret) = createStringObjectFromCharP(currentContext,f->name,-1),UNLOCKED);
       createClassObject(currentContext, f->targetClassName, f->flags.type, &Field_type(*ret),null);
       createClassObject(currentContext, f->sourceClassName, Type_Null, &Field_declaringClass(*ret),null);
+      WRITE_BARRIER(*ret, Field_nativeStruct(*ret));
+      WRITE_BARRIER(*ret, Field_name(*ret));
+      WRITE_BARRIER(*ret, Field_type(*ret));
+      WRITE_BARRIER(*ret, Field_declaringClass(*ret));
       setObjectLock(*ret, UNLOCKED);
    }
 }
@@ -128,6 +142,9 @@ static void createMethodObject(Context currentContext, Method m, TCClass declari
       // name and declaring class
       setObjectLock(Method_name(*ret) = createStringObjectFromCharP(currentContext,isConstructor ? declaringClass->name : m->name,-1),UNLOCKED);
       createClassObject(currentContext, declaringClass->name, Type_Null, &Method_declaringClass(*ret),null);
+      WRITE_BARRIER(*ret, Method_nativeStruct(*ret));
+      WRITE_BARRIER(*ret, Method_name(*ret));
+      WRITE_BARRIER(*ret, Method_declaringClass(*ret));
       // parameters and exceptions
       Method_parameterTypes(*ret) = createArrayObject(currentContext, "[java.lang.Class", n = m->paramCount);
       if (Method_parameterTypes(*ret) && n > 0)
@@ -135,14 +152,18 @@ static void createMethodObject(Context currentContext, Method m, TCClass declari
          TCObject* oa = (TCObject*)ARRAYOBJ_START(Method_parameterTypes(*ret));
          for (i=0; i < n; i++)
             createClassObject(currentContext, declaringClass->cp->cls[m->cpParams[i]], m->cpParams[i] < Type_Object ? m->cpParams[i] : Type_Null, oa++, null);
+         trackElements(Method_parameterTypes(*ret));
       }
+      WRITE_BARRIER(*ret, Method_parameterTypes(*ret));
       Method_exceptionTypes(*ret) = createArrayObject(currentContext, "[java.lang.Class", n = 0); // thrown exceptions is not stored in TCClass!
       if (Method_exceptionTypes(*ret) && n > 0)
       {
          TCObject* oa = (TCObject*)ARRAYOBJ_START(Method_exceptionTypes(*ret));
          for (i=0; i < n; i++)
             createClassObject(currentContext, m->exceptionHandlers[i].className, Type_Null, oa++, null);
+         trackElements(Method_exceptionTypes(*ret));
       }
+      WRITE_BARRIER(*ret, Method_exceptionTypes(*ret));
 
       // return and type
       if (!isConstructor)
@@ -150,6 +171,8 @@ static void createMethodObject(Context currentContext, Method m, TCClass declari
          CharP nn = m->class_->cp->cls[m->cpReturn];
          createClassObject(currentContext, nn, m->cpReturn == Type_Null ? Type_Void : m->cpReturn < Type_Object ? m->cpReturn : Type_Null, &Method_returnType(*ret),null);
          createClassObject(currentContext, m->class_->name, Type_Null, &Method_type(*ret),null);
+         WRITE_BARRIER(*ret, Method_returnType(*ret));
+         WRITE_BARRIER(*ret, Method_type(*ret));
       }
       setObjectLock(*ret, UNLOCKED);
    }
@@ -303,6 +326,8 @@ static void getFields(NMParams p, bool onlyPublic)
          for (ff = o->v64StaticFields  , i=ARRAYLENV(ff), ff += i-1; --i >= 0; --ff) if ((onlyPublic && ff->flags.isPublic) || (!onlyPublic && !ff->flags.isInherited)) createFieldObject(p->currentContext, ff, i, oa++);
       }
    }
+   if (ret)
+      trackElements(ret);
    setObjectLock(p->retO = ret, UNLOCKED);
 }
 static void getMCarray(NMParams p, bool isConstructor, bool onlyPublic)
@@ -340,6 +365,8 @@ static void getMCarray(NMParams p, bool isConstructor, bool onlyPublic)
          if (isConstructor || !onlyPublic) break;
       }
    }
+   if (ret)
+      trackElements(ret);
    setObjectLock(p->retO = ret, UNLOCKED);
 }
 
@@ -512,6 +539,7 @@ TC_API void jlC_getInterfaces(NMParams p) // java/lang/Class public native java.
       TCObject* objs = (TCObject*)ARRAYOBJ_START(ret);
       for (i = 0; i < n; i++)
          createClassObject(p->currentContext, target->interfaces[i]->name, Type_Null, &objs[i],null);
+      trackElements(ret);
       setObjectLock(p->retO = ret, UNLOCKED);
    }
 }
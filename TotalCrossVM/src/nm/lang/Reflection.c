@@ -193,7 +193,11 @@ static void field(NMParams p, Type srcType, bool isGet, void* value)
                if (isGet) 
                   *ovalue = *field; 
                else 
+               {
                   *field = *ovalue;
+                  if (!isStatic) // the static fields are roots
+                     WRITE_BARRIER(o, *ovalue);
+               }
                break;
             }
             case Type_Long:
@@ -405,7 +409,10 @@ TC_API void jlrA_set_oio(NMParams p) // totalcross/lang/reflect/Array public sta
       if (c->name[1] != '&') // object array? - note: we assume that it is valid to set the object array with a null value
       {
          if (checkArrayRange(p->currentContext, array, 0, index))
+         {
             ((TCObject*)ARRAYOBJ_START(array))[index] = value;
+            WRITE_BARRIER(array, value);
+         }
       }
       else // primitive array
       if (value == null)
@@ -692,7 +699,7 @@ static void invoke(NMParams p, TCObject m, TCObject obj, TCObject args)
                CharP msg;
                TCObject original = p->currentContext->thrownException, omsg = *Throwable_msg(original);
                p->currentContext->thrownException = null;
-               msg = omsg ? JCharP2CharP(String_charsStart(omsg),String_charsLen(omsg)) : null;
+               msg = omsg ? String2CharP(omsg) : null;
                throwException(p->currentContext, InvocationTargetException, "Exception %s thrown: %s", OBJ_CLASS(original)->name, msg == null ? "" : msg);
                xfree(msg);
             }
@@ -100,6 +100,9 @@ TC_API void jlR_exec_SSs(NMParams p) {
     ProcessImpl_inputStream(process) = fileInputStream;
     ProcessImpl_outputStream(process) = fileOutputStream;
     ProcessImpl_errorStream(process) = fileErrInputStream;
+    WRITE_BARRIER(process, fileInputStream);
+    WRITE_BARRIER(process, fileOutputStream);
+    WRITE_BARRIER(process, fileErrInputStream);
     ProcessImpl_pid(process) = pid;
     p->retO = process;
 
@@ -142,6 +145,7 @@ TCObject createFileStream(Context context, const int streamType, int fd) {
     } else {
         FileInputStream_fileChannel(fileStream) = fileChannel;
     }
+    WRITE_BARRIER(fileStream, fileChannel);
 
     setObjectLock(fileChannel, UNLOCKED);
 
@@ -8,6 +8,106 @@
 #include "tcvm.h"
 #include "NativeMethods.h"
 
+// The chars of a String, that may be compact (Latin-1, stored in a byte array) or UTF-16. The natives below read
+// both kinds directly, so the compact strings are never widened by them.
+typedef struct
+{
+   uint8* latin1; // not null if the string is compact
+   JCharP utf16;
+   int32 len;
+} TStringChars;
+
+#define CHAR_AT(s, i) ((s).latin1 ? (JChar)(s).latin1[i] : (s).utf16[i])
+
+static void getStringChars(TCObject str, TStringChars* s)
+{
+   s->len = String_charsLen(str);
+   if (String_isLatin1(str))
+   {
+      s->latin1 = String_latin1Start(str);
+      s->utf16 = null;
+   }
+   else
+   {
+      s->latin1 = null;
+      s->utf16 = (JCharP)ARRAYOBJ_START(String_chars(str));
+   }
+}
+
+static bool regionEquals(TStringChars* me, int32 from, TStringChars* other, int32 len) // compares other[0..len) with me[from..from+len)
+{
+   int32 i;
+   if (me->latin1 && other->latin1)
+      return xmemcmp(me->latin1 + from, other->latin1, len) == 0;
+   for (i = 0; i < len; i++)
+      if (CHAR_AT(*me, from+i) != CHAR_AT(*other, i))
+         return false;
+   return true;
+}
+
+static bool startsWith(TStringChars* me, TStringChars* other, int32 from)
+{
+   return 0 <= from && from <= me->len - other->len && regionEquals(me, from, other, other->len);
+}
+
+static int32 indexOfChar(TStringChars* me, JChar c, int32 start)
+{
+   uint8* found;
+   if (me->utf16)
+      return JCharPIndexOfJChar(me->utf16, c, start, me->len);
+   if (start < 0)
+      start = 0;
+   if (c > 0xFF || start >= me->len || (found = (uint8*)memchr(me->latin1 + start, c, me->len - start)) == null)
+      return -1;
+   return (int32)(found - me->latin1);
+}
+
+static int32 indexOfString(TStringChars* me, TStringChars* other, int32 start)
+{
+   int32 last = me->len - other->len;
+   if (me->utf16 && other->utf16)
+      return JCharPIndexOfJCharP(me->utf16, other->utf16, start, me->len, other->len);
+   if (start < 0)
+      start = 0;
+   else
+   if (start >= me->len)
+      return -1;
+   if (other->len == 0)
+      return start;
+   for (; start <= last; start++)
+      if (CHAR_AT(*me, start) == CHAR_AT(*other, 0) && regionEquals(me, start, other, other->len))
+         return start;
+   return -1;
+}
+
+static int32 lastIndexOfChar(TStringChars* me, JChar c, int32 start)
+{
+   if (me->utf16)
+      return JCharPLastIndexOfJChar(me->utf16, me->len, c, start);
+   if (0 <= start && start < me->len && c <= 0xFF)
+      for (; start >= 0; start--)
+         if (me->latin1[start] == c)
+            return start;
+   return -1;
+}
+
+static int32 lastIndexOfString(TStringChars* me, TStringChars* other, int32 start)
+{
+   if (me->utf16 && other->utf16)
+      return JCharPLastIndexOfJCharP(me->utf16, other->utf16, start, me->len, other->len);
+   if (start < 0)
+      start = 0;
+   else
+   if (start > me->len)
+      return -1;
+   if (other->len == 0)
+      return start;
+   for (start = min32(start-1, me->len - other->len); start >= 0; start--)
+      if (CHAR_AT(*me, start) == CHAR_AT(*other, 0) && regionEquals(me, start, other, other->len))
+         return start;
+   return -1;
+}
+
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_valueOf_d(NMParams p) // java/lang/String native public static String valueOf(double d);
 {
@@ -47,14 +147,126 @@ TC_API void jlS_copyChars_CiCii(NMParams p) // java/lang/String native static bo
 
    if (checkArrayRange(p->currentContext, srcArray, srcStart, len) && checkArrayRange(p->currentContext, dstArray, dstStart, len))
    {
-      srcPtr = (JCharP)ARRAYOBJ_START(srcArray);
       dstPtr = (JCharP)ARRAYOBJ_START(dstArray);
-      xmemmove(dstPtr + dstStart, srcPtr + srcStart, len << 1);
+      if (OBJ_CLASS(srcArray)->flags.bits2shift == 0) // the chars of a compact string
+      {
+         uint8* src = ((uint8*)ARRAYOBJ_START(srcArray)) + srcStart;
+         for (dstPtr += dstStart; len-- > 0;)
+            *dstPtr++ = *src++;
+      }
+      else
+      {
+         srcPtr = (JCharP)ARRAYOBJ_START(srcArray);
+         xmemmove(dstPtr + dstStart, srcPtr + srcStart, len << 1);
+      }
       p->retI = true;
    }
    else p->retI = false;
 }
 //////////////////////////////////////////////////////////////////////////
+static bool fitsLatin1(JCharP chars, int32 len)
+{
+   for (; len-- > 0; chars++)
+      if (*chars > 0xFF)
+         return false;
+   return true;
+}
+
+static TCObject copyOf(Context currentContext, TCObject src, int32 start, int32 count, bool copy)
+{
+   TCObject dst;
+   if (OBJ_CLASS(src)->flags.bits2shift == 0) // already compact
+   {
+      if ((dst = createByteArray(currentContext, count)) != null)
+         xmemmove(ARRAYOBJ_START(dst), ((uint8*)ARRAYOBJ_START(src)) + start, count);
+   }
+   else
+   if (IS_VMTWEAK_ON(VMTWEAK_COMPACT_STRINGS) && fitsLatin1(((JCharP)ARRAYOBJ_START(src)) + start, count))
+   {
+      if ((dst = createByteArray(currentContext, count)) != null)
+      {
+         JCharP from = ((JCharP)ARRAYOBJ_START(src)) + start;
+         uint8* to = (uint8*)ARRAYOBJ_START(dst);
+         while (count-- > 0)
+            *to++ = (uint8)*from++;
+      }
+   }
+   else
+   if (!copy)
+      return src;
+   else
+   if ((dst = createCharArray(currentContext, count)) != null)
+      xmemmove(ARRAYOBJ_START(dst), ((JCharP)ARRAYOBJ_START(src)) + start, count << 1);
+   if (dst != null)
+      setObjectLock(dst, UNLOCKED);
+   return dst;
+}
+
+TC_API void jlS_copyOf_Cii(NMParams p) // java/lang/String native static char[] copyOf(char []src, int start, int count);
+{
+   TCObject src = p->obj[0];
+   int32 start = p->i32[0], count = p->i32[1];
+   if (checkArrayRange(p->currentContext, src, start, count))
+      p->retO = copyOf(p->currentContext, src, start, count, true);
+}
+//////////////////////////////////////////////////////////////////////////
+TC_API void jlS_compact_C(NMParams p) // java/lang/String native static char[] compact(char []chars);
+{
+   TCObject chars = p->obj[0];
+   p->retO = chars == null || !IS_VMTWEAK_ON(VMTWEAK_COMPACT_STRINGS) ? chars : copyOf(p->currentContext, chars, 0, ARRAYOBJ_LEN(chars), false);
+}
+//////////////////////////////////////////////////////////////////////////
+TC_API void jlS_toUTF16_C(NMParams p) // java/lang/String native static char[] toUTF16(char []chars);
+{
+   TCObject chars = p->obj[0], dst;
+   if (chars == null || OBJ_CLASS(chars)->flags.bits2shift != 0)
+      p->retO = chars;
+   else
+   if ((p->retO = dst = createCharArray(p->currentContext, ARRAYOBJ_LEN(chars))) != null)
+   {
+      uint8* from = (uint8*)ARRAYOBJ_START(chars);
+      JCharP to = (JCharP)ARRAYOBJ_START(dst);
+      int32 n = ARRAYOBJ_LEN(chars);
+      while (n-- > 0)
+         *to++ = *from++;
+      setObjectLock(dst, UNLOCKED);
+   }
+}
+//////////////////////////////////////////////////////////////////////////
+TC_API void jlS_concat_s(NMParams p) // java/lang/String native public String concat(String s);
+{
+   TCObject me = p->obj[0], other = p->obj[1], ret;
+   TStringChars a, b;
+   int32 i;
+
+   if (other == null || String_charsLen(other) == 0)
+   {
+      p->retO = me;
+      return;
+   }
+   getStringChars(me, &a);
+   getStringChars(other, &b);
+   if (a.latin1 && b.latin1)
+   {
+      if ((p->retO = ret = createLatin1StringObjectWithLen(p->currentContext, a.len + b.len)) != null)
+      {
+         xmemmove(String_latin1Start(ret), a.latin1, a.len);
+         xmemmove(String_latin1Start(ret) + a.len, b.latin1, b.len);
+      }
+   }
+   else
+   if ((p->retO = ret = createStringObjectWithLen(p->currentContext, a.len + b.len)) != null)
+   {
+      JCharP to = (JCharP)ARRAYOBJ_START(String_chars(ret));
+      for (i = 0; i < a.len; i++)
+         *to++ = CHAR_AT(a, i);
+      for (i = 0; i < b.len; i++)
+         *to++ = CHAR_AT(b, i);
+   }
+   if (p->retO)
+      setObjectLock(p->retO, UNLOCKED);
+}
+//////////////////////////////////////////////////////////////////////////
 TC_API void jlS_toUpperCase(NMParams p) // java/lang/String native public String toUpperCase();
 {
    TCObject fromObj, toObj;
@@ -62,16 +274,28 @@ TC_API void jlS_toUpperCase(NMParams p) // java/lang/String native public String
    int32 len;
 
    fromObj = p->obj[0];
-   from   = String_charsStart(fromObj);
    len    = String_charsLen(fromObj);
 
+   if (String_isLatin1(fromObj)) // the case conversion of a Latin-1 char is also Latin-1
+   {
+      uint8 *fromLatin1, *toLatin1;
+      p->retO = toObj = createLatin1StringObjectWithLen(p->currentContext, len);
+      if (toObj != null)
+      {
+         fromLatin1 = String_latin1Start(fromObj);
+         toLatin1 = String_latin1Start(toObj);
+         while (len--)
+            *toLatin1++ = (uint8)JCharToUpper(*fromLatin1++);
+         setObjectLock(p->retO, UNLOCKED);
+      }
+      return;
+   }
+   from   = String_charsStart(fromObj);
    p->retO = toObj = createStringObjectWithLen(p->currentContext, len);
    if (toObj != null)
    {
       to = String_charsStart(toObj);
-      // do the convertion
-      while (len--)
-         *to++ = JCharToUpper(*from++);
+      JCharPToUpper(to, from, len);
       setObjectLock(p->retO, UNLOCKED);
    }
 }
@@ -83,16 +307,28 @@ TC_API void jlS_toLowerCase(NMParams p) // java/lang/String native public String
    int32 len;
 
    fromObj = p->obj[0];
-   from   = String_charsStart(fromObj);
    len    = String_charsLen(fromObj);
 
+   if (String_isLatin1(fromObj)) // the case conversion of a Latin-1 char is also Latin-1
+   {
+      uint8 *fromLatin1, *toLatin1;
+      p->retO = toObj = createLatin1StringObjectWithLen(p->currentContext, len);
+      if (toObj != null)
+      {
+         fromLatin1 = String_latin1Start(fromObj);
+         toLatin1 = String_latin1Start(toObj);
+         while (len--)
+            *toLatin1++ = (uint8)JCharToLower(*fromLatin1++);
+         setObjectLock(p->retO, UNLOCKED);
+      }
+      return;
+   }
+   from   = String_charsStart(fromObj);
    p->retO = toObj = createStringObjectWithLen(p->currentContext, len);
    if (toObj != null)
    {
       to = String_charsStart(toObj);
-      // do the convertion
-      while (len--)
-         *to++ = JCharToLower(*from++);
+      JCharPToLower(to, from, len);
       setObjectLock(p->retO, UNLOCKED);
    }
 }
@@ -107,7 +343,12 @@ TC_API void jlS_equals_o(NMParams p) // java/lang/String native public boolean e
       p->retI = true;
    else
    if (other != null && OBJ_CLASS(me) == OBJ_CLASS(other))
-      p->retI = JCharPEqualsJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = a.len == b.len && regionEquals(&a, 0, &b, b.len);
+   }
    else
       p->retI = false;
 }
@@ -124,19 +365,35 @@ TC_API void jlS_compareTo_s(NMParams p) // java/lang/String native public int co
    if (me == other) // same object?
       p->retI = 0; // match
    else
-      p->retI = JCharPCompareToJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      int32 i, n;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      if (a.utf16 && b.utf16)
+         p->retI = JCharPCompareToJCharP(a.utf16, b.utf16, a.len, b.len);
+      else
+      {
+         for (i = 0, n = min32(a.len, b.len); i < n; i++)
+            if (CHAR_AT(a, i) != CHAR_AT(b, i))
+               break;
+         p->retI = i < n ? (int32)CHAR_AT(a, i) - (int32)CHAR_AT(b, i) : a.len - b.len;
+      }
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_indexOf_i(NMParams p) // java/lang/String native public int indexOf(int c);
 {
-   TCObject me = p->obj[0];
-   p->retI = JCharPIndexOfJChar(String_charsStart(me), (JChar)p->i32[0], 0, String_charsLen(me));
+   TStringChars me;
+   getStringChars(p->obj[0], &me);
+   p->retI = indexOfChar(&me, (JChar)p->i32[0], 0);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_indexOf_ii(NMParams p) // java/lang/String native public int indexOf(int c, int startIndex);
 {
-   TCObject me = p->obj[0];
-   p->retI = JCharPIndexOfJChar(String_charsStart(me), (JChar)p->i32[0], p->i32[1], String_charsLen(me));
+   TStringChars me;
+   getStringChars(p->obj[0], &me);
+   p->retI = indexOfChar(&me, (JChar)p->i32[0], p->i32[1]);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_indexOf_s(NMParams p) // java/lang/String native public int indexOf(String c);
@@ -147,7 +404,12 @@ TC_API void jlS_indexOf_s(NMParams p) // java/lang/String native public int inde
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPIndexOfJCharP(String_charsStart(me), String_charsStart(other), 0, String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = indexOfString(&a, &b, 0);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_indexOf_si(NMParams p) // java/lang/String native public int indexOf(String c, int startIndex);
@@ -158,13 +420,35 @@ TC_API void jlS_indexOf_si(NMParams p) // java/lang/String native public int ind
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPIndexOfJCharP(String_charsStart(me), String_charsStart(other), p->i32[0], String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = indexOfString(&a, &b, p->i32[0]);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_hashCode(NMParams p) // java/lang/String native public int hashCode();
 {
-   TCObject me = p->obj[0];
-   p->retI = JCharPHashCode(String_charsStart(me), String_charsLen(me));
+   TStringChars me;
+   int64 cache = String_hashCache(p->obj[0]);
+   if (cache & STRING_HASH_CACHED)
+   {
+      p->retI = (int32)cache;
+      return;
+   }
+   getStringChars(p->obj[0], &me);
+   if (me.utf16)
+      p->retI = JCharPHashCode(me.utf16, me.len);
+   else
+   {
+      int32 hash = 0; // same value of the UTF-16 string
+      uint8* c = me.latin1;
+      while (me.len-- > 0)
+         hash = (hash<<5) - hash + (int32)*c++;
+      p->retI = hash;
+   }
+   String_hashCache(p->obj[0]) = STRING_HASH_CACHED | (uint32)p->retI; // strings are immutable
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_startsWith_si(NMParams p) // java/lang/String native public boolean startsWith(String prefix, int from);
@@ -179,7 +463,12 @@ TC_API void jlS_startsWith_si(NMParams p) // java/lang/String native public bool
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPStartsWithJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(other), from);
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = startsWith(&a, &b, from);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_startsWith_s(NMParams p) // java/lang/String native public boolean startsWith(String prefix);
@@ -192,7 +481,12 @@ TC_API void jlS_startsWith_s(NMParams p) // java/lang/String native public boole
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPStartsWithJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(other), 0);
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = startsWith(&a, &b, 0);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_endsWith_s(NMParams p) // java/lang/String native public boolean endsWith(String suffix);
@@ -205,7 +499,12 @@ TC_API void jlS_endsWith_s(NMParams p) // java/lang/String native public boolean
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPEndsWithJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = startsWith(&a, &b, a.len - b.len);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_equalsIgnoreCase_s(NMParams p) // java/lang/String native public boolean equalsIgnoreCase(String s);
@@ -215,39 +514,60 @@ TC_API void jlS_equalsIgnoreCase_s(NMParams p) // java/lang/String native public
    me = p->obj[0];
    other = p->obj[1];
 
-   p->retI = other == null ? false : JCharPEqualsIgnoreCaseJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(other)); // guich@tc120_45: return false if null
+   if (other == null) // guich@tc120_45: return false if null
+      p->retI = false;
+   else
+   {
+      TStringChars a, b;
+      int32 i;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      if (a.utf16 && b.utf16)
+         p->retI = JCharPEqualsIgnoreCaseJCharP(a.utf16, b.utf16, a.len, b.len);
+      else
+      if (a.len != b.len)
+         p->retI = false;
+      else
+      {
+         for (i = 0; i < a.len; i++)
+            if (JCharToLower(CHAR_AT(a, i)) != JCharToLower(CHAR_AT(b, i)))
+               break;
+         p->retI = i == a.len;
+      }
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TCObject S_replace(Context currentContext, TCObject me, JChar oldChar, JChar newChar)
 {
    TCObject other, retO = null;
-   int32 n;
-   JCharP jme, jother;
-   bool found = false;
-                                     
+   int32 n, i;
+   TStringChars chars;
+
    // guich@tc115_55: search before replacing it
-   n = String_charsLen(me);
-   jme = String_charsStart(me);
-   while (--n >= 0)
-      if (*jme++ == oldChar)
-      {
-         found = true;
-         break;
-      }
-   if (!found) // if not found, return "this"
+   getStringChars(me, &chars);
+   if (indexOfChar(&chars, oldChar, 0) < 0) // if not found, return "this"
       retO = me;
    else
    {
-      n = String_charsLen(me);
-      retO = other = createStringObjectWithLen(currentContext, n);
-      if (other)
+      n = chars.len;
+      if (chars.latin1 && newChar <= 0xFF) // still compact
       {
-         jme = String_charsStart(me);
-         jother = String_charsStart(other);
-         for (; n-- > 0; jother++, jme++)
-            *jother = (*jme == oldChar) ? newChar : *jme;
-         setObjectLock(retO, UNLOCKED);
+         uint8* jother;
+         retO = other = createLatin1StringObjectWithLen(currentContext, n);
+         if (other)
+            for (jother = String_latin1Start(other), i = 0; i < n; i++)
+               *jother++ = (chars.latin1[i] == oldChar) ? (uint8)newChar : chars.latin1[i];
+      }
+      else
+      {
+         JCharP jother;
+         retO = other = createStringObjectWithLen(currentContext, n);
+         if (other)
+            for (jother = (JCharP)ARRAYOBJ_START(String_chars(other)), i = 0; i < n; i++, jother++)
+               *jother = (CHAR_AT(chars, i) == oldChar) ? newChar : CHAR_AT(chars, i);
       }
+      if (retO)
+         setObjectLock(retO, UNLOCKED);
    }
    return retO;
 }
@@ -259,42 +579,37 @@ TC_API void jlS_replace_cc(NMParams p) // java/lang/String native public String
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_lastIndexOf_ii(NMParams p) // java/lang/String native public int lastIndexOf(int c, int startIndex);
 {
-   TCObject me;
+   TStringChars me;
    int32 c,startIndex;
 
-   me = p->obj[0];
+   getStringChars(p->obj[0], &me);
    c = p->i32[0];
    startIndex = p->i32[1];
 
-   p->retI = JCharPLastIndexOfJChar(String_charsStart(me), String_charsLen(me), (JChar)c, startIndex);
+   p->retI = lastIndexOfChar(&me, (JChar)c, startIndex);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_lastIndexOf_i(NMParams p) // java/lang/String native public int lastIndexOf(int c);
 {
-   TCObject me;
-   int32 c,startIndex;
-
-   me = p->obj[0];
-   c = p->i32[0];
-   startIndex = p->i32[1];
-
-   p->retI = JCharPLastIndexOfJChar(String_charsStart(me), String_charsLen(me), (JChar)c, String_charsLen(me)-1);
+   TStringChars me;
+   getStringChars(p->obj[0], &me);
+   p->retI = lastIndexOfChar(&me, (JChar)p->i32[0], me.len-1);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_trim(NMParams p) // java/lang/String native public String trim();
 {
    TCObject me;
    int32 end,len,st=0;
-   JCharP chars;
+   TStringChars chars;
 
    me = p->obj[0];
-   len = String_charsLen(me);
+   getStringChars(me, &chars);
+   len = chars.len;
    end = len-1;
 
-   chars = String_charsStart(me);
-   while (st <= end && chars[st] <= ' ')
+   while (st <= end && CHAR_AT(chars, st) <= ' ')
       st++;
-   while (end >= 0 && chars[end] <= ' ')
+   while (end >= 0 && CHAR_AT(chars, end) <= ' ')
       end--;
 
    if (st <= 0 && end >= (len-1))
@@ -302,12 +617,19 @@ TC_API void jlS_trim(NMParams p) // java/lang/String native public String trim()
    else
    {
       if (st > end)
-         p->retO = createStringObjectWithLen(p->currentContext, 0);
+         p->retO = chars.latin1 ? createLatin1StringObjectWithLen(p->currentContext, 0) : createStringObjectWithLen(p->currentContext, 0);
+      else
+      if (chars.latin1)
+      {
+         p->retO = createLatin1StringObjectWithLen(p->currentContext, end-st+1);
+         if (p->retO)
+            xmemmove(String_latin1Start(p->retO), chars.latin1+st, end-st+1);
+      }
       else
       {
          p->retO = createStringObjectWithLen(p->currentContext, end-st+1);
          if (p->retO)
-            xmemmove(String_charsStart(p->retO), chars+st, (end-st+1)*2);
+            xmemmove(String_charsStart(p->retO), chars.utf16+st, (end-st+1)*2);
       }
       if (p->retO)
          setObjectLock(p->retO, UNLOCKED);
@@ -327,7 +649,12 @@ TC_API void jlS_lastIndexOf_s(NMParams p) // java/lang/String native public int
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPLastIndexOfJCharP(String_charsStart(me), String_charsStart(other), String_charsLen(me), String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = lastIndexOfString(&a, &b, a.len);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void jlS_lastIndexOf_si(NMParams p) // java/lang/String native public int lastIndexOf(String s, int startIndex);
@@ -338,7 +665,12 @@ TC_API void jlS_lastIndexOf_si(NMParams p) // java/lang/String native public int
    if (other == null)
       throwException(p->currentContext, NullPointerException,null);
    else
-      p->retI = JCharPLastIndexOfJCharP(String_charsStart(me), String_charsStart(other), p->i32[0], String_charsLen(me), String_charsLen(other));
+   {
+      TStringChars a, b;
+      getStringChars(me, &a);
+      getStringChars(other, &b);
+      p->retI = lastIndexOfString(&a, &b, p->i32[0]);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 
@@ -347,9 +679,19 @@ TCObject chars2bytes(Context currentContext, JCharP chars, int32 length); // Cha
 TC_API void jlS_getBytes(NMParams p) // java/lang/String native public byte []getBytes();
 {
    TCObject obj = p->obj[0];
-   JChar* chars = String_charsStart(obj);
+   JChar* chars;
    int32 length = String_charsLen(obj);
-   p->retO = chars2bytes(p->currentContext, chars, length);
+   if (String_isLatin1(obj) && OBJ_CLASS(*charConverterPtr) == ISO88591CharacterConverter) // the bytes are the chars
+   {
+      if ((p->retO = createByteArray(p->currentContext, length)) != null)
+      {
+         xmemmove(ARRAYOBJ_START(p->retO), String_latin1Start(obj), length);
+         setObjectLock(p->retO, UNLOCKED);
+      }
+      return;
+   }
+   if ((chars = widenString(p->currentContext, obj)) != null)
+      p->retO = chars2bytes(p->currentContext, chars, length);
 }
 
 #ifdef ENABLE_TEST_SUITE
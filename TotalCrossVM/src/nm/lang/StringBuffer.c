@@ -34,6 +34,7 @@ static bool ensureCapacity(Context currentContext, TCObject obj, int32 minimumCa
    srcPtr  = (JCharP)ARRAYOBJ_START(charArrayObjSrc);
    xmemmove(destPtr, srcPtr, len << 1);
    StringBuffer_chars(obj) = charArrayObjDest; // replace original one
+   WRITE_BARRIER(obj, charArrayObjDest);
    setObjectLock(charArrayObjDest, UNLOCKED);
    return true;
 }
@@ -56,13 +57,11 @@ TC_API TCObject appendJCharP(Context currentContext, TCObject obj, JCharP srcPtr
    return obj;
 }
 
-TC_API TCObject appendCharP(Context currentContext, TCObject obj, CharP srcPtr)
+static TCObject appendLatin1(Context currentContext, TCObject obj, uint8* srcPtr, int32 len)
 {
-   int32 count, bufferLen, len;
+   int32 count, bufferLen;
    JCharP destPtr;
-   unsigned char *usrcPtr = (unsigned char*)srcPtr; // get rid of the sign
 
-   len = xstrlen(srcPtr);
    count = StringBuffer_count(obj);
    bufferLen = ARRAYOBJ_LEN(StringBuffer_chars(obj));
 
@@ -73,10 +72,15 @@ TC_API TCObject appendCharP(Context currentContext, TCObject obj, CharP srcPtr)
    destPtr = ((JCharP)StringBuffer_charsStart(obj)) + count; // don't cache bc the array may change in ensureCapacity
    StringBuffer_count(obj) += len;
    while (--len >= 0)
-      *destPtr++ = *usrcPtr++;
+      *destPtr++ = *srcPtr++;
    return obj;
 }
 
+TC_API TCObject appendCharP(Context currentContext, TCObject obj, CharP srcPtr)
+{
+   return appendLatin1(currentContext, obj, (uint8*)srcPtr, xstrlen(srcPtr)); // get rid of the sign
+}
+
 void SB_delete(TCObject obj, int32 start, int32 end)
 {
    int32 count = StringBuffer_count(obj);
@@ -150,6 +154,9 @@ TC_API void jlSB_append_s(NMParams p) // java/lang/StringBuffer native public St
    TCObject str = p->obj[1];
    if (str == null)
       p->retO = appendCharP(p->currentContext, obj, "null");
+   else
+   if (String_isLatin1(str)) // compact strings are widened while copied
+      p->retO = appendLatin1(p->currentContext, obj, String_latin1Start(str), String_charsLen(str));
    else
       p->retO = appendJCharP(p->currentContext, obj, String_charsStart(str), String_charsLen(str));
 }
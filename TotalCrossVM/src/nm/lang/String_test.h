@@ -723,3 +723,90 @@ TESTCASE(jlS_trim) // java/lang/String native public String trim();
 
    finish: ;
 }
+TESTCASE(jlS_compactStrings) // Vm.TWEAK_COMPACT_STRINGS
+{
+   TNMParams p;
+   TCObject objs[2];
+   int32 oldTweaks = vmTweaks, i32[1], hash;
+   CharP res8 = null;
+   JChar buf[32];
+   JCharP jchars, jchars16 = null;
+   int32 widened;
+
+   tzero(p);
+   p.currentContext = currentContext;
+   p.obj = objs;
+   p.i32 = i32;
+
+   objs[1] = createStringObjectFromCharP(currentContext, "select name from person",-1); // UTF-16
+   vmTweaks |= 1 << (VMTWEAK_COMPACT_STRINGS-1);
+   objs[0] = createStringObjectFromCharP(currentContext, "select name from person",-1); // Latin-1
+   setObjectLock(objs[0], UNLOCKED);
+   setObjectLock(objs[1], UNLOCKED);
+   ASSERT1_EQUALS(NotNull, objs[0]);
+   ASSERT1_EQUALS(NotNull, objs[1]);
+   ASSERT1_EQUALS(True, String_isLatin1(objs[0]));
+   ASSERT1_EQUALS(False, String_isLatin1(objs[1]));
+   ASSERT2_EQUALS(I32, String_charsLen(objs[0]), 23);
+
+   jlS_equals_o(&p);
+   ASSERT2_EQUALS(I32, p.retI, 1);
+   jlS_compareTo_s(&p);
+   ASSERT2_EQUALS(I32, p.retI, 0);
+   jlS_hashCode(&p);
+   hash = p.retI;
+   objs[0] = objs[1];
+   jlS_hashCode(&p);
+   ASSERT2_EQUALS(I32, p.retI, hash);
+
+   objs[0] = createStringObjectFromCharP(currentContext, "select name from person",-1);
+   objs[1] = createStringObjectFromCharP(currentContext, "from",-1);
+   setObjectLock(objs[0], UNLOCKED);
+   setObjectLock(objs[1], UNLOCKED);
+   i32[0] = 0;
+   jlS_indexOf_si(&p);
+   ASSERT2_EQUALS(I32, p.retI, 12);
+   jlS_lastIndexOf_s(&p);
+   ASSERT2_EQUALS(I32, p.retI, 12);
+   i32[0] = 'n';
+   jlS_lastIndexOf_i(&p);
+   ASSERT2_EQUALS(I32, p.retI, 22);
+   i32[0] = 0x100; // doesn't fit in Latin-1
+   jlS_indexOf_i(&p);
+   ASSERT2_EQUALS(I32, p.retI, -1);
+
+   jlS_toUpperCase(&p);
+   ASSERT1_EQUALS(NotNull, p.retO);
+   ASSERT1_EQUALS(True, String_isLatin1(p.retO));
+   res8 = String2CharP(p.retO); // the bytes are copied as they are
+   ASSERT2_EQUALS(Sz, res8, "SELECT NAME FROM PERSON");
+   ASSERT1_EQUALS(True, String_isLatin1(p.retO));
+   jchars = String2JCharPBuf(currentContext, p.retO, buf, 32); // widened into the buffer
+   ASSERT2_EQUALS(Ptr, jchars, buf);
+   ASSERT2_EQUALS(I32, jchars[22], 'N');
+   ASSERT1_EQUALS(True, String_isLatin1(p.retO));
+   widened = currentContext->widenedCount;
+   jchars = String2JCharPBuf(currentContext, p.retO, buf, 8); // doesn't fit: widened into a temporary array
+   ASSERT1_EQUALS(NotNull, jchars);
+   ASSERT1_EQUALS(False, jchars == buf);
+   ASSERT2_EQUALS(I32, jchars[0], 'S');
+   ASSERT2_EQUALS(I32, jchars[22], 'N');
+   ASSERT1_EQUALS(True, String_isLatin1(p.retO)); // the string stays compact
+   ASSERT2_EQUALS(I32, currentContext->widenedCount, widened + 1);
+   ASSERT1_EQUALS(True, OBJ_ISLOCKED(currentContext->widened[widened]));
+   releaseWidenedStrings(currentContext, widened);
+   ASSERT2_EQUALS(I32, currentContext->widenedCount, widened);
+   objs[1] = createStringObjectWithLen(currentContext, 2);
+   ASSERT1_EQUALS(NotNull, objs[1]);
+   setObjectLock(objs[1], UNLOCKED);
+   ASSERT2_EQUALS(Ptr, widenString(currentContext, objs[1]), String_charsStart(objs[1])); // a UTF-16 string isn't copied
+   ASSERT2_EQUALS(I32, currentContext->widenedCount, widened);
+   jchars16 = String2JCharP(p.retO);
+   ASSERT1_EQUALS(NotNull, jchars16);
+   ASSERT2_EQUALS(I32, jchars16[0], 'S');
+   ASSERT2_EQUALS(I32, jchars16[23], 0);
+   finish:
+   vmTweaks = oldTweaks;
+   xfree(res8);
+   xfree(jchars16);
+}
@@ -26,15 +26,16 @@ TC_API void tmGM_showAddress_sb(NMParams p) // totalcross/map/GoogleMaps native
       return;
    }
 #ifdef WP8
-   p->retI = showMap(String_charsStart(addr), String_charsLen(addr), 0, 0);
+   JCharP chars = widenString(p->currentContext, addr);
+   p->retI = chars ? showMap(chars, String_charsLen(addr), 0, 0) : false;
 #elif defined ANDROID
    JNIEnv* env = getJNIEnv();         
-   jstring jaddr = (*env)->NewString(env, (jchar*) String_charsStart(addr), String_charsLen(addr));
+   jstring jaddr = String2jstring(env, addr);
    jboolean result = (*env)->CallStaticBooleanMethod(env, applicationClass, jshowGoogleMaps, jaddr, (jboolean) p->i32[0]);
    (*env)->DeleteLocalRef(env, jaddr);
    p->retI = result != 0;
 #elif defined darwin
-   CharP addrp = JCharP2CharP(String_charsStart(addr), String_charsLen(addr));
+   CharP addrp = String2CharP(addr);
    p->retI = addrp ? iphone_mapsShowAddress(addrp,p->i32[0]) : 0;
    xfree(addrp);
 #else
@@ -52,13 +53,14 @@ TC_API void tmGM_showRoute_sssi(NMParams p) // totalcross/map/GoogleMaps native
       return;
    }
 #ifdef WP8
-   p->retI = showMap(String_charsStart(addrI), String_charsLen(addrI), String_charsStart(addrF), String_charsLen(addrF));
+   JCharP charsI = widenString(p->currentContext, addrI), charsF = charsI ? widenString(p->currentContext, addrF) : null;
+   p->retI = charsF ? showMap(charsI, String_charsLen(addrI), charsF, String_charsLen(addrF)) : false;
 #elif defined ANDROID
    JNIEnv* env = getJNIEnv();         
    TCObject coord = p->obj[2];
-   jstring jaddrI = (*env)->NewString(env, (jchar*) String_charsStart(addrI), String_charsLen(addrI));
-   jstring jaddrF = addrF ? (*env)->NewString(env, (jchar*) String_charsStart(addrF), String_charsLen(addrF)) : 0;
-   jstring jcoord = !coord ? null : (*env)->NewString(env, (jchar*) String_charsStart(coord), String_charsLen(coord));
+   jstring jaddrI = String2jstring(env, addrI);
+   jstring jaddrF = String2jstring(env, addrF);
+   jstring jcoord = String2jstring(env, coord);
    jint result = (*env)->CallStaticIntMethod(env, applicationClass, jshowRoute, jaddrI, jaddrF, jcoord, p->i32[0]);
    (*env)->DeleteLocalRef(env, jaddrI);
    if (jaddrF) (*env)->DeleteLocalRef(env, jaddrF);
@@ -67,7 +69,7 @@ TC_API void tmGM_showRoute_sssi(NMParams p) // totalcross/map/GoogleMaps native
       throwException(p->currentContext, NotInstalledException, null);
    p->retI = result == 0;
 #elif defined darwin
-   CharP addrp = JCharP2CharP(String_charsStart(addrI), String_charsLen(addrI));
+   CharP addrp = String2CharP(addrI);
    p->retI = addrp ? iphone_mapsShowAddress(addrp,p->i32[0] | 2) : 0;
    xfree(addrp);
 #endif
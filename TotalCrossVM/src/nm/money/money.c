@@ -18,7 +18,7 @@ static int32 callAdsFunc(int32 func, int32 i, TCObject str)
 {                                                         
 #ifdef ANDROID
    JNIEnv* env = getJNIEnv();
-   jstring jstr = str == null ? null : (*env)->NewString(env, (jchar*) String_charsStart(str), String_charsLen(str));
+   jstring jstr = String2jstring(env, str);
    int32 ret = (*env)->CallStaticIntMethod(env, applicationClass, jadsFunc, func, i, jstr);
    if (jstr != null) (*env)->DeleteLocalRef(env, jstr);
    //int32 ii = debug("callAdsFunc(%d,%d,%X) -> %d", func, i, str, ret);
@@ -61,7 +61,7 @@ TC_API void tnCM_setDefaultConfiguration_is(NMParams p) // totalcross/net/Connec
 #elif defined (ANDROID)
    JNIEnv* env = getJNIEnv();
    jmethodID setDefaultConfMethod = (*env)->GetStaticMethodID(env, jConnectionManager4A, "setDefaultConfiguration", "(ILjava/lang/String;)V");
-   jstring szConnCfg = !connCfg ? null : (*env)->NewString(env, String_charsStart(connCfg), String_charsLen(connCfg));
+   jstring szConnCfg = String2jstring(env, connCfg);
    (*env)->CallStaticVoidMethod(env, jConnectionManager4A, setDefaultConfMethod, type, szConnCfg);
    (*env)->DeleteLocalRef(env, jConnectionManager4A);
    if (szConnCfg) (*env)->DeleteLocalRef(env, szConnCfg);
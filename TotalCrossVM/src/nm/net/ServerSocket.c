@@ -52,6 +52,7 @@ TC_API void tnSS_serversocketCreate_iiis(NMParams p) // totalcross/net/ServerSoc
    if ((serverSocketRef = createByteArray(p->currentContext, sizeof(SERVER_SOCKET))) != null)
    {
       ServerSocket_serverRef(serverSocket) = serverSocketRef;
+      WRITE_BARRIER(serverSocket, serverSocketRef);
       serverSocketHandle = (SERVER_SOCKET*) ARRAYOBJ_START(serverSocketRef);
       if ((err = serverSocketCreate(serverSocketHandle, port, backlog, szAddress)) != NO_ERROR)
       {
@@ -77,6 +78,7 @@ TC_API void tnSS_nativeAccept(NMParams p) // totalcross/net/ServerSocket native
    if (newSocket != null && (socketRef = createByteArray(p->currentContext, sizeof(SOCKET))) != null)
    {
       Socket_socketRef(newSocket) = socketRef;
+      WRITE_BARRIER(newSocket, socketRef);
       serverSocketHandle = (SERVER_SOCKET*) ARRAYOBJ_START(serverSocketRef);
       socketHandle = (SOCKET*) ARRAYOBJ_START(socketRef);
       *socketHandle = INVALID_SOCKET;
@@ -51,6 +51,7 @@ TC_API void tnS_socketCreate_siib(NMParams p) // totalcross/net/Socket native vo
    if ((socketRef = createByteArray(p->currentContext, sizeof(SOCKET))) != null)
    {
       Socket_socketRef(socket) = socketRef;
+      WRITE_BARRIER(socket, socketRef);
       setObjectLock(socketRef, UNLOCKED);
       socketHandle = (SOCKET*) ARRAYOBJ_START(socketRef);
       if ((err = socketCreate(socketHandle, szHost, port, timeout, noLinger, &isUnknownHost, &timedOut)) != NO_ERROR)
@@ -157,6 +157,7 @@ TC_API void tnsSSL_read_s(NMParams p) // totalcross/net/ssl/SSL native public in
       if ((byteArray = createByteArray(p->currentContext, size)) != null)
       {
          SSLReadHolder_buf(readHolder) = byteArray;
+         WRITE_BARRIER(readHolder, byteArray);
          xmemmove(ARRAYOBJ_START(byteArray), in_data, size);
          setObjectLock(byteArray, UNLOCKED);
       }
@@ -7,8 +7,8 @@ static Err NmNotify(TCObject title, TCObject text)
 {
    JNIEnv* env = getJNIEnv();
    jmethodID notifyMethod = (*env)->GetStaticMethodID(env, jNotificationManager4A, "notify", "(Ljava/lang/String;Ljava/lang/String;)V");
-   jstring jTitle = title == null ? null : (*env)->NewString(env, String_charsStart(title), String_charsLen(title));
-   jstring jText = text == null ? null : (*env)->NewString(env, String_charsStart(text), String_charsLen(text));
+   jstring jTitle = String2jstring(env, title);
+   jstring jText = String2jstring(env, text);
    (*env)->CallStaticObjectMethod(env, jNotificationManager4A, notifyMethod, jTitle, jText);
    
    (*env)->DeleteLocalRef(env, jTitle);
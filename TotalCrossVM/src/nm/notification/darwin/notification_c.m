@@ -13,16 +13,17 @@
 
 #include "tcvm.h"
 
+static NSString* newNSString(TCObject s)
+{
+   if (String_isLatin1(s)) // a compact string holds the Latin-1 bytes
+      return [[NSString alloc] initWithBytes:String_latin1Start(s) length:String_charsLen(s) encoding:NSISOLatin1StringEncoding];
+   return [[NSString alloc] initWithCharacters:String_charsStart(s) length:String_charsLen(s)];
+}
+
 Err NmNotify(TCObject title, TCObject text)
 {
-	NSString *nsTitle = [[[NSString alloc]
-							initWithCharacters:String_charsStart(title) 
-							length:String_charsLen(title)
-						] autorelease];
-	NSString *nsText = [[[NSString alloc]
-							initWithCharacters:String_charsStart(text) 
-							length:String_charsLen(text)
-						] autorelease];
+	NSString *nsTitle = [newNSString(title) autorelease];
+	NSString *nsText = [newNSString(text) autorelease];
     
     if (floor(NSFoundationVersionNumber) <= NSFoundationVersionNumber_iOS_7_1) {
         // iOS 7.1 or earlier. Disable the deprecation warnings.
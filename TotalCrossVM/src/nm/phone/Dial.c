@@ -87,11 +87,11 @@ TC_API void tpD_number_s(NMParams p) // totalcross/phone/Dial native public stat
       
 #if !defined WP8
       char number[100];
-      JCharP2CharPBuf(String_charsStart(numberObj), min32(String_charsLen(numberObj),sizeof(number)-1),number);
+      String2CharPBufLen(numberObj, min32(String_charsLen(numberObj),sizeof(number)-1), number);
       dialNumber(number); 
 #else
       JChar number[100];
-      JCharPDupBuf(String_charsStart(numberObj), min32(String_charsLen(numberObj), sizeof(number) - 1), number);
+      String2JCharPBufLen(numberObj, min32(String_charsLen(numberObj), sizeof(number) - 1), number);
       dialNumberCPP(number);
 #endif
    }
@@ -34,8 +34,8 @@ TC_API void tpSMS_send_ss(NMParams p) // totalcross/phone/SMS native public stat
       else
          SmsSend(p->currentContext, szMessage, szDestination);
 #elif defined (WP8)
-      JCharP szMessage = JCharPDup(String_charsStart(message), String_charsLen(message));
-      JCharP szDestination = JCharPDup(String_charsStart(destination), String_charsLen(destination));
+      JCharP szMessage = String2JCharP(message);
+      JCharP szDestination = String2JCharP(destination);
 
       if (!szMessage || !szDestination)
          throwException(p->currentContext, OutOfMemoryError, !szMessage ? "When allocating 'message'" : "'When allocating 'destination'");
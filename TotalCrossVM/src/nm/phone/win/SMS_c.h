@@ -248,6 +248,8 @@ static void SmsReceive(Context currentContext, TCObject* out)
                         TCObject* nm = (TCObject*)ARRAYOBJ_START(*out);
                         nm[0] = createStringObjectFromTCHARP(currentContext, smsaDestination.ptsAddress, -1);
                         nm[1] = createStringObjectFromCharP(currentContext, pMessage, dwSize);
+                        WRITE_BARRIER(*out, nm[0]);
+                        WRITE_BARRIER(*out, nm[1]);
                         setObjectLock(nm[0], UNLOCKED);
                         setObjectLock(nm[1], UNLOCKED);
                         setObjectLock(*out, UNLOCKED);
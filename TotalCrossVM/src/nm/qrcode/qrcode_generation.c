@@ -49,6 +49,7 @@ TC_API void tqQRC_nativeGetBytes_sii(NMParams p) {
                     }
                 }
             }
+            WRITE_BARRIER(byteMatrix, *out);
             setObjectLock(*out, UNLOCKED);
         }
     }
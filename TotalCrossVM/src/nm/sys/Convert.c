@@ -409,6 +409,7 @@ TC_API void tsC_fill_Oiio(NMParams p) // totalcross/sys/Convert native public st
       TCObject* a = (TCObject*)ARRAYOBJ_START(ao);
       for (a += from; from < to; from++)
          *a++ = value;
+      WRITE_BARRIER(ao, value);
    }
 }
 //////////////////////////////////////////////////////////////////////////
@@ -432,16 +433,19 @@ TC_API void tsC_replace_sss(NMParams p) // totalcross/sys/Convert native public
    else
    {
       int32 f = String_charsLen(from), t = String_charsLen(to), s = String_charsLen(source), last=0, tlast=0;
-      JCharP toc = String_charsStart(to);
-      JCharP fromc = String_charsStart(from);
+      JCharP toc, fromc;
+      if ((toc = widenString(p->currentContext, to)) == null || (fromc = widenString(p->currentContext, from)) == null)
+         return;
 
       // if user is trying to replace a single char, use a faster routine
       if (f == 1 && t == 1)
          p->retO = S_replace(p->currentContext, source, fromc[0], toc[0]);
       else
       {
-         JCharP sourcec = String_charsStart(source), targetc;
+         JCharP sourcec, targetc;
          int32 count = 0;
+         if ((sourcec = widenString(p->currentContext, source)) == null)
+            return;
          // count how many times the string appears
          while (last >= 0)
          {
@@ -508,7 +512,9 @@ TC_API void tsC_numberOf_sc(NMParams p) // totalcross/sys/Convert native public
       JChar c = (JChar)p->i32[0];
       int32 count = 0;
       int32 len = String_charsLen(s);
-      JCharP chars = String_charsStart(s);
+      JCharP chars = widenString(p->currentContext, s);
+      if (chars == null)
+         return;
       while (--len >= 0)
          if (*chars++ == c)
             count++;
@@ -528,9 +534,9 @@ TC_API void tsC_zeroPad_si(NMParams p) // totalcross/sys/Convert native public s
       int32 n = size - len;
       if (n > 0)
       {  
-         JCharP chars,source = String_charsStart(s);
-         TCObject target = createStringObjectWithLen(p->currentContext, size);
-         if (target == null)
+         JCharP chars,source;
+         TCObject target;
+         if ((source = widenString(p->currentContext, s)) == null || (target = createStringObjectWithLen(p->currentContext, size)) == null)
             return;
          chars = String_charsStart(target);
          while (--n >= 0)
@@ -579,9 +585,9 @@ TC_API void tsC_numberPad_si(NMParams p) // totalcross/sys/Convert native public
       int32 n = size - len;
       if (n > 0)
       {  
-         JCharP chars,source = String_charsStart(s);
-         TCObject target = createStringObjectWithLen(p->currentContext, size);
-         if (target == null)
+         JCharP chars,source;
+         TCObject target;
+         if ((source = widenString(p->currentContext, s)) == null || (target = createStringObjectWithLen(p->currentContext, size)) == null)
             return;
          chars = String_charsStart(target);
          while (--n >= 0)
@@ -650,9 +656,9 @@ TC_API void tsC_spacePad_sib(NMParams p) // totalcross/sys/Convert native public
       int32 n = size - len;
       if (n > 0)
       {  
-         JCharP chars,source = String_charsStart(s);
-         TCObject target = createStringObjectWithLen(p->currentContext, size);
-         if (target == null)
+         JCharP chars,source;
+         TCObject target;
+         if ((source = widenString(p->currentContext, s)) == null || (target = createStringObjectWithLen(p->currentContext, size)) == null)
             return;
          chars = String_charsStart(target);
          if (before)
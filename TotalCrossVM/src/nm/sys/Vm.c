@@ -79,12 +79,15 @@ TC_API void tsV_arrayCopy_oioii(NMParams p) // totalcross/sys/Vm native public s
          {
             TCObjectArray psrc = (TCObjectArray)src;
             TCObjectArray pdst = (TCObjectArray)dst;
+            int32 n = length;
             if (src == dst && srcStart < dstStart) // copy arrays overlap?
                for (psrc += srcStart + length - 1, pdst += dstStart + length - 1;  --length >= 0; ) // must go backwards to allow copy into overlapping array
                   *pdst-- = *psrc--;
             else
                for (psrc += srcStart, pdst += dstStart;  --length >= 0; )
                   *pdst++ = *psrc++;
+            for (pdst = (TCObjectArray)dst + dstStart; n-- > 0; pdst++)
+               WRITE_BARRIER(dstArray, *pdst);
          }
          else
          {
@@ -123,8 +126,9 @@ TC_API void tsV_exitAndReboot(NMParams p) // totalcross/sys/Vm native public sta
 {
    UNUSED(p);
    printf("tsV_exitAndReboot\n");
-   keepRunning = false; // stop event loop
    rebootOnExit = true;
+   keepRunning = false; // stop event loop
+   wakeUpEventLoop();
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tsV_exec_ssib(NMParams p) // totalcross/sys/Vm native public static int exec(String command, String args, int launchCode, boolean wait);
@@ -142,9 +146,9 @@ TC_API void tsV_exec_ssib(NMParams p) // totalcross/sys/Vm native public static
 #ifdef ANDROID
    p->retI = vmExec(command, args, launchCode, wait);
 #else        
-   if ((szCommand = JCharP2TCHARP(String_charsStart(command), String_charsLen(command))) != null)
+   if ((szCommand = String2TCHARP(command)) != null)
    {
-      if (!args || (szArgs = JCharP2TCHARP(String_charsStart(args), String_charsLen(args))) != null)
+      if (!args || (szArgs = String2TCHARP(args)) != null)
          p->retI = vmExec(szCommand, szArgs, launchCode, wait);
       else
          p->retI = -1;
@@ -238,9 +242,9 @@ TC_API void tsV_clipboardCopy_s(NMParams p) // totalcross/sys/Vm native public s
    {   
 #if defined(WIN32)
       CharP s;
-      int32 sLen;
+      int32 sLen = String_charsLen(string);
 
-      if ((s = JCharP2CharP(String_charsStart(string), (sLen = String_charsLen(string)))) == null)
+      if ((s = String2CharP(string)) == null)
          throwException(p->currentContext, OutOfMemoryError, null);
       else
       {
@@ -248,7 +252,9 @@ TC_API void tsV_clipboardCopy_s(NMParams p) // totalcross/sys/Vm native public s
          xfree(s);
       }
 #else // use unicode on other platforms
-      vmClipboardCopy(String_charsStart(string), String_charsLen(string));
+      JCharP chars = widenString(p->currentContext, string);
+      if (chars != null)
+         vmClipboardCopy(chars, String_charsLen(string));
 #endif
    }
 }
@@ -356,8 +362,35 @@ TC_API void tsV_tweak_ib(NMParams p) // totalcross/sys/Vm native public static v
    if (param == VMTWEAK_TRACE_METHODS)
       traceOn = on;
    else
-   if (param == VMTWEAK_DISABLE_GC && !on) // guich@tc114_18
-      gc(p->currentContext);
+   if ((param == VMTWEAK_DISABLE_GC || param == VMTWEAK_GENERATIONAL_GC || param == VMTWEAK_INCREMENTAL_GC) && !on) // guich@tc114_18
+      gc(p->currentContext); // when turning the generational mode off, the gc also gives back the nursery; an incremental cycle is finished
+   else
+   if (param == VMTWEAK_INLINE_CACHE_STATS)
+   {
+      if (!on)
+         debug("P Inline caches: %d hits, %d misses, %d megamorphic", icHits, icMisses, icMegamorphic);
+      icHits = icMisses = icMegamorphic = 0;
+      icStatsOn = on;
+   }
+   else
+   if (param == VMTWEAK_CPU_PROFILER)
+   {
+      if (on)
+         startCpuProfiler(0);
+      else
+         stopCpuProfiler();
+   }
+   else
+   if (param == VMTWEAK_ALLOC_PROFILER)
+   {
+      if (on)
+         startAllocProfiler(0);
+      else
+         stopAllocProfiler();
+   }
+   else
+   if (param == VMTWEAK_HEAP_HISTOGRAM && on)
+      gc(p->currentContext); // writes the first histogram now
    else
    if (param == VMTWEAK_MEM_PROFILER) // guich@tc111_4
    {
@@ -412,6 +445,11 @@ TC_API void tsV_preallocateArray_oi(NMParams p) // totalcross/sys/Vm native publ
    else
       preallocateArray(p->currentContext, t,len);
 }
+//////////////////////////////////////////////////////////////////////////
+TC_API void tsV_saveStartupSnapshot(NMParams p) // totalcross/sys/Vm native public static boolean saveStartupSnapshot();
+{
+   p->retI = saveSnapshot(p->currentContext) >= 0;
+}
 
 #ifdef ENABLE_TEST_SUITE
 #include "Vm_test.h"
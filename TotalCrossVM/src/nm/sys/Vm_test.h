@@ -167,7 +167,7 @@ TESTCASE(tsV_arrayCopy_oioii) // totalcross/sys/Vm native public static boolean
       int i;
 	   for (i = 0; i < 4; i++)
    	{
-      	char *sz = JCharP2CharP(String_charsStart(pStrings2[i]), String_charsLen(pStrings2[i]));
+      	char *sz = String2CharP(pStrings2[i]);
 	      ASSERT1_EQUALS(True, xstrcmp(sz, result[i]) == 0);
 	      xfree(sz);
 	   }
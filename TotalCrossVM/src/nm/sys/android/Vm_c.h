@@ -39,8 +39,8 @@ void rebootDevice()
 static int32 vmExec(TCObject command, TCObject args, int32 launchCode, bool wait)
 {                                                                                
    JNIEnv *env = getJNIEnv();                                      
-   jstring jcommand = (*env)->NewString(env, (jchar*) String_charsStart(command), String_charsLen(command));
-   jstring jargs = !args ? null : (*env)->NewString(env, (jchar*) String_charsStart(args), String_charsLen(args));
+   jstring jcommand = String2jstring(env, command);
+   jstring jargs = String2jstring(env, args);
    int32 ret = (*env)->CallStaticIntMethod(env, applicationClass, jvmExec, jcommand, jargs, launchCode, wait);
    (*env)->DeleteLocalRef(env, jcommand);
    if (jargs) (*env)->DeleteLocalRef(env, jargs);
@@ -165,6 +165,7 @@ static TCObject privateList(Context currentContext, int32 hk, TCHARP key)
             if (RegEnumKeyEx(handle, i, buf, &bufSize, 0, 0, 0, 0) == NO_ERROR)
             {
                *array = createStringObjectFromTCHAR(currentContext, buf, bufSize);
+               WRITE_BARRIER(arrayObj, *array);
                setObjectLock(*array, UNLOCKED);
                array++;
             }
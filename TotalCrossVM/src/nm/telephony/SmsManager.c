@@ -38,6 +38,7 @@ TC_API void ttSM_registerSmsReceiver_si(NMParams p) // totalcross/telephony/SmsM
    TCObject smsReceiver = p->obj[1];
    int32 port = p->i32[0];
    SmsManager_smsReceiver(smsManager) = smsReceiver;
+   WRITE_BARRIER(smsManager, smsReceiver);
    
 #if defined (ANDROID)   
    registerSmsReceiver(smsReceiver, port);
@@ -6,9 +6,9 @@
 static Err sendTextMessage (TCObject destinationAddress, TCObject scAddress, TCObject text) {
    JNIEnv* env = getJNIEnv();
    jmethodID sendTextMessageMethod = (*env)->GetStaticMethodID(env, jSmsManager4A, "sendTextMessage", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V");
-   jstring jDestinationAddress = (*env)->NewString(env, String_charsStart(destinationAddress), String_charsLen(destinationAddress));
-   jstring jScAddress = (scAddress != null) ? (*env)->NewString(env, String_charsStart(scAddress), String_charsLen(scAddress)) : null;
-   jstring jText = (*env)->NewString(env, String_charsStart(text), String_charsLen(text));
+   jstring jDestinationAddress = String2jstring(env, destinationAddress);
+   jstring jScAddress = String2jstring(env, scAddress);
+   jstring jText = String2jstring(env, text);
    
    (*env)->CallStaticObjectMethod(env, jSmsManager4A, sendTextMessageMethod, jDestinationAddress, jScAddress, jText);
    (*env)->DeleteLocalRef(env, jDestinationAddress);
@@ -57,6 +57,9 @@ void JNICALL Java_totalcross_Launcher4A_nativeSmsReceived(JNIEnv *env, jclass _c
                SmsMessage_displayOriginatingAddress(smsMessage) = displayOriginatingAddress;
                SmsMessage_displayMessageBody(smsMessage) = displayMessageBody;
                SmsMessage_userData(smsMessage) = userData;
+               WRITE_BARRIER(smsMessage, displayOriginatingAddress);
+               WRITE_BARRIER(smsMessage, displayMessageBody);
+               WRITE_BARRIER(smsMessage, userData);
                
                Method onReceiveMethod = getMethod(OBJ_CLASS(smsReceiver), true, "onReceive", 1, "totalcross.telephony.SmsMessage");
                if (onReceiveMethod != null) {
@@ -77,8 +80,8 @@ void JNICALL Java_totalcross_Launcher4A_nativeSmsReceived(JNIEnv *env, jclass _c
 static Err sendDataMessage (TCObject destinationAddress, TCObject scAddress, int32 port, TCObject data) {
    JNIEnv* env = getJNIEnv();
    jmethodID sendDataMessageMethod = (*env)->GetStaticMethodID(env, jSmsManager4A, "sendDataMessage", "(Ljava/lang/String;Ljava/lang/String;I[B)V");
-   jstring jDestinationAddress = (*env)->NewString(env, String_charsStart(destinationAddress), String_charsLen(destinationAddress));
-   jstring jScAddress = (scAddress != null) ? (*env)->NewString(env, String_charsStart(scAddress), String_charsLen(scAddress)) : null;
+   jstring jDestinationAddress = String2jstring(env, destinationAddress);
+   jstring jScAddress = String2jstring(env, scAddress);
    jbyteArray jData = null;
    jbyte* jbytes = null;
    
@@ -0,0 +1,441 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+/*
+ Retained display lists (totalcross.ui.gfx.DisplayList). While a Graphics is recording, each drawing native, after
+ drawing, appends its arguments to the list with the bounding box of what it drew; before it, the list gets a STATE
+ command if the colors, alpha, flags or font changed, and a CLIP one if the translation or the clip changed. The
+ coordinates are stored relative to the translation the recording started with, and the clip as "the one the list is
+ replayed with" when it's the one the recording started with, so the list can be replayed at another place and with
+ another clip.
+
+ The replay calls the same natives with the recorded arguments, skipping the ones whose box is out of the clip: so,
+ replaying with the clip set to a damaged area costs little more than walking the list.
+
+ cmds has a header (DL_*) followed by the commands: an int with the opcode in the low byte and the length of the
+ command (in ints, including this one) above it, then, for drawing commands, the bounding box (x1, y1, x2, y2, in the
+ coordinates of the arguments), the int arguments, the indexes in refs of the objects (-1 for null) and the doubles,
+ two ints each.
+*/
+
+#include "../NativeMethods.h"
+
+#define DL_ORIGIN_X   0 // the translation when the recording started
+#define DL_ORIGIN_Y   1
+#define DL_CLIP_X1    2 // the clip when the recording started, relative to the translation
+#define DL_CLIP_Y1    3
+#define DL_CLIP_X2    4
+#define DL_CLIP_Y2    5
+#define DL_LAST_STATE 6 // offset of the last STATE command, or -1
+#define DL_LAST_CLIP  7 // offset of the last CLIP command, or -1
+#define DL_HEADER     8
+
+#define DL_UNBOUNDED  0x3FFFFFFF
+
+typedef enum
+{
+   DL_STATE,   // fore, back, alpha, flags (useAA | isVerticalText << 1), font (index in refs)
+   DL_CLIP,    // transX, transY, base (if the clip is the one the recording started with), clipX1, clipY1, clipX2, clipY2
+   DL_DRAWELLIPSE, DL_FILLELLIPSE, DL_FILLELLIPSEGRADIENT,
+   DL_DRAWARC, DL_DRAWPIE, DL_FILLPIE, DL_FILLPIEGRADIENT,
+   DL_DRAWELLIPTICALARC, DL_DRAWELLIPTICALPIE, DL_FILLELLIPTICALPIE, DL_FILLELLIPTICALPIEGRADIENT,
+   DL_DRAWCIRCLE, DL_FILLCIRCLE, DL_FILLCIRCLEGRADIENT,
+   DL_SETPIXEL, DL_DRAWLINE, DL_DRAWLINEC, DL_DRAWDOTS, DL_DRAWRECT, DL_FILLRECT,
+   DL_FILLPOLYGON, DL_FILLPOLYGONGRADIENT, DL_DRAWPOLYGON, DL_DRAWPOLYLINE, DL_SETPIXELS,
+   DL_DRAWTEXT, DL_DRAWROUNDRECT, DL_FILLROUNDRECT, DL_DRAWROUNDGRADIENT,
+   DL_DRAWIMAGECLIP, DL_DRAWIMAGE, DL_COPYIMAGERECT, DL_SETRGB,
+   DL_UNREPLAYABLE // copyRect and dither, which read what was drawn before
+} DisplayListOp;
+
+typedef enum
+{
+   BOX_NONE,    // unbounded
+   BOX_RECT,    // x, y, w, h
+   BOX_CORNERS, // x1, y1, x2, y2
+   BOX_LINE,    // ax, ay, bx, by
+   BOX_CIRCLE,  // xc, yc, r
+   BOX_ELLIPSE, // xc, yc, rx, ry
+   BOX_POINT,   // x, y
+   BOX_POINTS,  // the two arrays of points, with the count in the first argument
+   BOX_TEXT,    // x, y, justifyWidth, with the string in the first object
+   BOX_IMAGE,   // x, y, with the image in the first object
+   BOX_SIZE     // w, h, drawn at 0,0
+} DisplayListBox;
+
+typedef struct
+{
+   NativeMethod f;
+   uint8 i32s, objs, dbls; // arguments, besides the Graphics
+   uint8 box, boxArg;      // how the bounding box is computed, and the index of the first int argument it uses
+   uint8 cloneArrays;      // if the objects are int arrays that must be copied
+} TDisplayListOp;
+
+static TDisplayListOp dlOps[] =
+{
+   {null},
+   {null},
+   {tugG_drawEllipse_iiii,              4, 0, 0, BOX_ELLIPSE, 0},
+   {tugG_fillEllipse_iiii,              4, 0, 0, BOX_ELLIPSE, 0},
+   {tugG_fillEllipseGradient_iiii,      4, 0, 0, BOX_ELLIPSE, 0},
+   {tugG_drawArc_iiidd,                 3, 0, 2, BOX_CIRCLE,  0},
+   {tugG_drawPie_iiidd,                 3, 0, 2, BOX_CIRCLE,  0},
+   {tugG_fillPie_iiidd,                 3, 0, 2, BOX_CIRCLE,  0},
+   {tugG_fillPieGradient_iiidd,         3, 0, 2, BOX_CIRCLE,  0},
+   {tugG_drawEllipticalArc_iiiidd,      4, 0, 2, BOX_ELLIPSE, 0},
+   {tugG_drawEllipticalPie_iiiidd,      4, 0, 2, BOX_ELLIPSE, 0},
+   {tugG_fillEllipticalPie_iiiidd,      4, 0, 2, BOX_ELLIPSE, 0},
+   {tugG_fillEllipticalPieGradient_i,   4, 0, 2, BOX_ELLIPSE, 0},
+   {tugG_drawCircle_iii,                3, 0, 0, BOX_CIRCLE,  0},
+   {tugG_fillCircle_iii,                3, 0, 0, BOX_CIRCLE,  0},
+   {tugG_fillCircleGradient_iii,        3, 0, 0, BOX_CIRCLE,  0},
+   {tugG_setPixel_ii,                   2, 0, 0, BOX_POINT,   0},
+   {tugG_drawLine_iiii,                 4, 0, 0, BOX_LINE,    0},
+   {tugG_drawLine_iiiii,                5, 0, 0, BOX_LINE,    0},
+   {tugG_drawDots_iiii,                 4, 0, 0, BOX_LINE,    0},
+   {tugG_drawRect_iiii,                 4, 0, 0, BOX_RECT,    0},
+   {tugG_fillRect_iiii,                 4, 0, 0, BOX_RECT,    0},
+   {tugG_fillPolygon_IIi,               1, 2, 0, BOX_POINTS,  0, true},
+   {tugG_fillPolygonGradient_IIi,       1, 2, 0, BOX_POINTS,  0, true},
+   {tugG_drawPolygon_IIi,               1, 2, 0, BOX_POINTS,  0, true},
+   {tugG_drawPolyline_IIi,              1, 2, 0, BOX_POINTS,  0, true},
+   {tugG_setPixels_IIi,                 1, 2, 0, BOX_POINTS,  0, true},
+   {tugG_drawText_siii,                 3, 1, 0, BOX_TEXT,    0},
+   {tugG_drawRoundRect_iiiii,           5, 0, 0, BOX_RECT,    0},
+   {tugG_fillRoundRect_iiiii,           5, 0, 0, BOX_RECT,    0},
+   {tugG_drawRoundGradient_iiiiiiiii,  11, 0, 0, BOX_CORNERS, 0},
+   {tugG_drawImage_iiib,                3, 1, 0, BOX_IMAGE,   0},
+   {tugG_drawImage_iii,                 2, 1, 0, BOX_IMAGE,   0},
+   {tugG_copyImageRect_iiiiib,          5, 1, 0, BOX_SIZE,    2},
+   {tugG_setRGB_Iiiiii,                 5, 1, 0, BOX_RECT,    1, true},
+};
+
+#define recordDrawing(p, op) do {if (Graphics_displayList(p->obj[0]) != null) recordCall(p, op);} while (0)
+
+// Makes room for n more ints in the commands, returning where they start, or null if there's no memory
+static int32* dlReserve(Context currentContext, TCObject dl, int32 n)
+{
+   TCObject cmds = DisplayList_cmds(dl), newCmds;
+   int32 count = DisplayList_count(dl);
+   if (cmds == null || count + n > (int32)ARRAYOBJ_LEN(cmds))
+   {
+      newCmds = createArrayObject(currentContext, INT_ARRAY, max32(256, (count + n) * 2));
+      if (newCmds == null)
+         return null;
+      if (cmds != null)
+         xmemmove(ARRAYOBJ_START(newCmds), ARRAYOBJ_START(cmds), count * 4);
+      DisplayList_cmds(dl) = cmds = newCmds;
+      WRITE_BARRIER(dl, newCmds);
+      setObjectLock(newCmds, UNLOCKED);
+   }
+   DisplayList_count(dl) = count + n;
+   return (int32*)ARRAYOBJ_START(cmds) + count;
+}
+
+// Stores the object in refs, returning its index, -1 if it's null, or -2 if there's no memory
+static int32 dlAddRef(Context currentContext, TCObject dl, TCObject o)
+{
+   TCObject refs = DisplayList_refs(dl), newRefs;
+   int32 n = DisplayList_refCount(dl);
+   if (o == null)
+      return -1;
+   if (refs == null || n == (int32)ARRAYOBJ_LEN(refs))
+   {
+      if ((newRefs = createArrayObject(currentContext, "[java.lang.Object", max32(16, n * 2))) == null)
+         return -2;
+      if (refs != null)
+         xmemmove(ARRAYOBJ_START(newRefs), ARRAYOBJ_START(refs), n * TSIZE);
+      DisplayList_refs(dl) = refs = newRefs;
+      WRITE_BARRIER(dl, newRefs);
+      setObjectLock(newRefs, UNLOCKED);
+   }
+   ((TCObject*)ARRAYOBJ_START(refs))[n] = o;
+   WRITE_BARRIER(refs, o);
+   DisplayList_refCount(dl) = n + 1;
+   return n;
+}
+
+static TCObject dlGetRef(TCObject dl, int32 index)
+{
+   return index < 0 ? null : ((TCObject*)ARRAYOBJ_START(DisplayList_refs(dl)))[index];
+}
+
+// Copies count ints of the array, from the given offset, to a new one, which is returned locked; returns null if it can't be done
+static TCObject dlCloneInts(Context currentContext, TCObject array, int32 offset, int32 count)
+{
+   TCObject copy;
+   if (array == null || offset < 0 || count < 0 || offset + count > (int32)ARRAYOBJ_LEN(array) || (copy = createArrayObject(currentContext, INT_ARRAY, count)) == null)
+      return null;
+   xmemmove(ARRAYOBJ_START(copy), (int32*)ARRAYOBJ_START(array) + offset, count * 4);
+   return copy;
+}
+
+// Replaces the arrays given to the call by copies, because they may be changed after it
+static bool dlCloneArrays(Context currentContext, DisplayListOp opcode, TCObject* objs, int32* i32s)
+{
+   if (opcode == DL_SETRGB)
+   {
+      objs[0] = dlCloneInts(currentContext, objs[0], i32s[0], i32s[3] * i32s[4]);
+      i32s[0] = 0; // the offset in the copy
+      return objs[0] != null;
+   }
+   if ((objs[0] = dlCloneInts(currentContext, objs[0], 0, i32s[0])) == null)
+      return false;
+   if ((objs[1] = dlCloneInts(currentContext, objs[1], 0, i32s[0])) == null)
+   {
+      setObjectLock(objs[0], UNLOCKED);
+      return false;
+   }
+   return true;
+}
+
+// Computes the box of the pixels the call may change, in the coordinates of its arguments; returns false if it's unknown
+static bool dlComputeBox(Context currentContext, TCObject g, TDisplayListOp* op, int32* a, TCObject* objs, int32* box)
+{
+   TCObject o, fm;
+   int32 *xp, *yp, n;
+   JChar buf[256];
+   JCharP chars;
+   a += op->boxArg;
+   switch (op->box)
+   {
+      case BOX_RECT:    box[0] = a[0];        box[1] = a[1];        box[2] = a[0] + a[2];     box[3] = a[1] + a[3];     break;
+      case BOX_CORNERS: box[0] = a[0];        box[1] = a[1];        box[2] = a[2] + 1;        box[3] = a[3] + 1;        break;
+      case BOX_CIRCLE:  box[0] = a[0] - a[2]; box[1] = a[1] - a[2]; box[2] = a[0] + a[2] + 1; box[3] = a[1] + a[2] + 1; break;
+      case BOX_ELLIPSE: box[0] = a[0] - a[2]; box[1] = a[1] - a[3]; box[2] = a[0] + a[2] + 1; box[3] = a[1] + a[3] + 1; break;
+      case BOX_POINT:   box[0] = a[0];        box[1] = a[1];        box[2] = a[0] + 1;        box[3] = a[1] + 1;        break;
+      case BOX_SIZE:    box[0] = 0;           box[1] = 0;           box[2] = a[0];            box[3] = a[1];            break;
+      case BOX_LINE:
+         box[0] = min32(a[0], a[2]);     box[1] = min32(a[1], a[3]);
+         box[2] = max32(a[0], a[2]) + 1; box[3] = max32(a[1], a[3]) + 1;
+         break;
+      case BOX_POINTS:
+         xp = (int32*)ARRAYOBJ_START(objs[0]);
+         yp = (int32*)ARRAYOBJ_START(objs[1]);
+         box[0] = box[1] = DL_UNBOUNDED;
+         box[2] = box[3] = -DL_UNBOUNDED;
+         for (n = a[0]; n-- > 0; xp++, yp++)
+         {
+            box[0] = min32(box[0], *xp); box[2] = max32(box[2], *xp + 1);
+            box[1] = min32(box[1], *yp); box[3] = max32(box[3], *yp + 1);
+         }
+         break;
+      case BOX_TEXT:
+         if ((o = objs[0]) == null || Graphics_isVerticalText(g))
+            return false;
+         fm = Font_fm(Graphics_font(g));
+         box[0] = a[0];
+         box[1] = a[1];
+         if (a[2] <= 0 && (chars = String2JCharPBuf(currentContext, o, buf, 256)) == null)
+            return false;
+         box[2] = a[0] + (a[2] > 0 ? a[2] : getJCharPWidth(currentContext, Graphics_font(g), chars, String_charsLen(o)));
+         box[3] = a[1] + FontMetrics_ascent(fm) + FontMetrics_descent(fm);
+         break;
+      case BOX_IMAGE:
+         if ((o = objs[0]) == null)
+            return false;
+         box[0] = a[0];
+         box[1] = a[1];
+         box[2] = a[0] + (int32)(Image_width(o) * Image_hwScaleW(o));
+         box[3] = a[1] + (int32)(Image_height(o) * Image_hwScaleH(o));
+         break;
+      default:
+         return false;
+   }
+   // one pixel more around, for the antialiased borders
+   box[0]--; box[1]--;
+   box[2]++; box[3]++;
+   return true;
+}
+
+// Emits STATE and CLIP commands if the state of the Graphics differs from the one of the last ones. Returns false if there's no memory
+static bool dlRecordState(Context currentContext, TCObject g, TCObject dl)
+{
+   int32 *c = (int32*)ARRAYOBJ_START(DisplayList_cmds(dl)), *s, fontIdx;
+   int32 flags = (Graphics_useAA(g) ? 1 : 0) | (Graphics_isVerticalText(g) ? 2 : 0);
+   int32 ox = c[DL_ORIGIN_X], oy = c[DL_ORIGIN_Y];
+   int32 tx = Graphics_transX(g) - ox, ty = Graphics_transY(g) - oy;
+   int32 x1 = Graphics_clipX1(g) - ox, y1 = Graphics_clipY1(g) - oy, x2 = Graphics_clipX2(g) - ox, y2 = Graphics_clipY2(g) - oy;
+   int32 base = x1 == c[DL_CLIP_X1] && y1 == c[DL_CLIP_Y1] && x2 == c[DL_CLIP_X2] && y2 == c[DL_CLIP_Y2];
+
+   s = c[DL_LAST_STATE] < 0 ? null : c + c[DL_LAST_STATE];
+   if (s == null || s[1] != Graphics_foreColor(g) || s[2] != Graphics_backColor(g) || s[3] != Graphics_alpha(g) || s[4] != flags || dlGetRef(dl, s[5]) != Graphics_font(g))
+   {
+      if (s != null && dlGetRef(dl, s[5]) == Graphics_font(g))
+         fontIdx = s[5];
+      else
+      if ((fontIdx = dlAddRef(currentContext, dl, Graphics_font(g))) == -2)
+         return false;
+      if ((s = dlReserve(currentContext, dl, 6)) == null)
+         return false;
+      c = (int32*)ARRAYOBJ_START(DisplayList_cmds(dl));
+      c[DL_LAST_STATE] = (int32)(s - c);
+      s[0] = DL_STATE | (6 << 8);
+      s[1] = Graphics_foreColor(g);
+      s[2] = Graphics_backColor(g);
+      s[3] = Graphics_alpha(g);
+      s[4] = flags;
+      s[5] = fontIdx;
+   }
+   s = c[DL_LAST_CLIP] < 0 ? null : c + c[DL_LAST_CLIP];
+   if (s == null ? (tx != 0 || ty != 0 || !base) : (s[1] != tx || s[2] != ty || s[3] != base || (!base && (s[4] != x1 || s[5] != y1 || s[6] != x2 || s[7] != y2))))
+   {
+      if ((s = dlReserve(currentContext, dl, 8)) == null)
+         return false;
+      c = (int32*)ARRAYOBJ_START(DisplayList_cmds(dl));
+      c[DL_LAST_CLIP] = (int32)(s - c);
+      s[0] = DL_CLIP | (8 << 8);
+      s[1] = tx;
+      s[2] = ty;
+      s[3] = base;
+      s[4] = x1; s[5] = y1; s[6] = x2; s[7] = y2;
+   }
+   return true;
+}
+
+// Appends the call to the list the Graphics is recording; any failure makes the list unreplayable
+static void recordCall(NMParams p, DisplayListOp opcode)
+{
+   Context currentContext = p->currentContext;
+   TCObject g = p->obj[0], dl = Graphics_displayList(g), objs[2] = {null, null};
+   TDisplayListOp* op;
+   int32 i32s[11], refs[2], box[4], *c, i, len;
+   bool ok = false;
+
+   if (DisplayList_failed(dl))
+      return;
+   if (opcode == DL_UNREPLAYABLE || currentContext->thrownException != null) // a failed call is not replayed
+   {
+      DisplayList_failed(dl) = true;
+      return;
+   }
+   op = &dlOps[opcode];
+   xmemmove(i32s, p->i32, op->i32s * 4);
+   for (i = 0; i < op->objs; i++)
+      objs[i] = p->obj[i+1];
+   if (op->cloneArrays && !dlCloneArrays(currentContext, opcode, objs, i32s))
+   {
+      DisplayList_failed(dl) = true;
+      return;
+   }
+   if (!dlComputeBox(currentContext, g, op, i32s, objs, box))
+   {
+      box[0] = box[1] = -DL_UNBOUNDED;
+      box[2] = box[3] = DL_UNBOUNDED;
+   }
+   if (dlRecordState(currentContext, g, dl))
+   {
+      for (i = 0; i < op->objs && (refs[i] = dlAddRef(currentContext, dl, objs[i])) != -2; i++)
+         ;
+      len = 1 + 4 + op->i32s + op->objs + op->dbls * 2;
+      if (i == op->objs && (c = dlReserve(currentContext, dl, len)) != null)
+      {
+         *c++ = opcode | (len << 8);
+         xmemmove(c, box, 4 * 4);
+         xmemmove(c + 4, i32s, op->i32s * 4);
+         c += 4 + op->i32s;
+         for (i = 0; i < op->objs; i++)
+            *c++ = refs[i];
+         if (op->dbls > 0)
+            xmemmove(c, p->dbl, op->dbls * 8);
+         ok = true;
+      }
+   }
+   if (op->cloneArrays) // now they're referenced by the list
+      for (i = 0; i < op->objs; i++)
+         setObjectLock(objs[i], UNLOCKED);
+   if (!ok)
+      DisplayList_failed(dl) = true;
+}
+
+static void dlStartRecording(Context currentContext, TCObject g, TCObject dl)
+{
+   int32 ox = Graphics_transX(g), oy = Graphics_transY(g), *c;
+   TCObject refs = DisplayList_refs(dl);
+
+   if (refs != null)
+      xmemzero(ARRAYOBJ_START(refs), DisplayList_refCount(dl) * TSIZE);
+   DisplayList_refCount(dl) = DisplayList_count(dl) = 0;
+   DisplayList_valid(dl) = false;
+   DisplayList_failed(dl) = (c = dlReserve(currentContext, dl, DL_HEADER)) == null;
+   if (c == null)
+      return;
+   c[DL_ORIGIN_X] = ox;
+   c[DL_ORIGIN_Y] = oy;
+   c[DL_CLIP_X1] = Graphics_clipX1(g) - ox;
+   c[DL_CLIP_Y1] = Graphics_clipY1(g) - oy;
+   c[DL_CLIP_X2] = Graphics_clipX2(g) - ox;
+   c[DL_CLIP_Y2] = Graphics_clipY2(g) - oy;
+   c[DL_LAST_STATE] = c[DL_LAST_CLIP] = -1;
+   Graphics_displayList(g) = dl;
+   WRITE_BARRIER(g, dl);
+}
+
+static void dlReplay(Context currentContext, TCObject g, TCObject dl)
+{
+   int32 *c = (int32*)ARRAYOBJ_START(DisplayList_cmds(dl)), *end = c + DisplayList_count(dl), *cmd;
+   int32 fore = Graphics_foreColor(g), back = Graphics_backColor(g), alpha = Graphics_alpha(g), useAA = Graphics_useAA(g), vertical = Graphics_isVerticalText(g);
+   int32 tx0 = Graphics_transX(g), ty0 = Graphics_transY(g);
+   int32 cx1 = Graphics_clipX1(g), cy1 = Graphics_clipY1(g), cx2 = Graphics_clipX2(g), cy2 = Graphics_clipY2(g);
+   TCObject font = Graphics_font(g), objs[3];
+   double dbls[2];
+   TNMParams params;
+   int32 opcode, i;
+   TDisplayListOp* op;
+
+   params.currentContext = currentContext;
+   params.obj = objs;
+   params.dbl = dbls;
+   objs[0] = g;
+   for (cmd = c + DL_HEADER; cmd < end && currentContext->thrownException == null; cmd += *cmd >> 8)
+      switch (opcode = *cmd & 0xFF)
+      {
+         case DL_STATE:
+            Graphics_foreColor(g) = cmd[1];
+            Graphics_backColor(g) = cmd[2];
+            Graphics_alpha(g) = cmd[3];
+            Graphics_useAA(g) = cmd[4] & 1;
+            Graphics_isVerticalText(g) = (cmd[4] >> 1) & 1;
+            Graphics_font(g) = dlGetRef(dl, cmd[5]);
+            WRITE_BARRIER(g, Graphics_font(g));
+            break;
+         case DL_CLIP:
+            Graphics_transX(g) = tx0 + cmd[1];
+            Graphics_transY(g) = ty0 + cmd[2];
+            if (cmd[3]) // the clip of the replay
+            {
+               Graphics_clipX1(g) = cx1; Graphics_clipY1(g) = cy1;
+               Graphics_clipX2(g) = cx2; Graphics_clipY2(g) = cy2;
+            }
+            else // the recorded one, inside the clip of the replay
+            {
+               Graphics_clipX1(g) = max32(cx1, tx0 + cmd[4]); Graphics_clipY1(g) = max32(cy1, ty0 + cmd[5]);
+               Graphics_clipX2(g) = min32(cx2, tx0 + cmd[6]); Graphics_clipY2(g) = min32(cy2, ty0 + cmd[7]);
+            }
+            break;
+         default:
+            op = &dlOps[opcode];
+            if (Graphics_transX(g) + cmd[3] <= Graphics_clipX1(g) || Graphics_transX(g) + cmd[1] >= Graphics_clipX2(g) ||
+                Graphics_transY(g) + cmd[4] <= Graphics_clipY1(g) || Graphics_transY(g) + cmd[2] >= Graphics_clipY2(g))
+               break; // out of the clip
+            params.i32 = cmd + 5;
+            for (i = 0; i < op->objs; i++)
+               objs[i+1] = dlGetRef(dl, cmd[5 + op->i32s + i]);
+            if (op->dbls > 0)
+               xmemmove(dbls, cmd + 5 + op->i32s + op->objs, op->dbls * 8);
+            op->f(&params);
+            break;
+      }
+   Graphics_foreColor(g) = fore;
+   Graphics_backColor(g) = back;
+   Graphics_alpha(g) = alpha;
+   Graphics_useAA(g) = useAA;
+   Graphics_isVerticalText(g) = vertical;
+   Graphics_font(g) = font;
+   WRITE_BARRIER(g, font);
+   Graphics_transX(g) = tx0;
+   Graphics_transY(g) = ty0;
+   Graphics_clipX1(g) = cx1; Graphics_clipY1(g) = cy1;
+   Graphics_clipX2(g) = cx2; Graphics_clipY2(g) = cy2;
+}
@@ -53,6 +53,14 @@ typedef enum
    SURF_CONTROL
 } SurfaceType;
 
+#define MAX_DIRTY_RECTS 8
+
+/// A rectangle of the screen that must be updated; x2 and y2 are exclusive
+typedef struct
+{
+   int32 x1, y1, x2, y2;
+} TDirtyRect;
+
 typedef struct TScreenSurface // represents a device-dependant surface, there's only ONE per application
 {
    uint8* pixels; // pixels in native format
@@ -6,6 +6,7 @@
 #include "tcvm.h"
 #include "PalmFont.h"
 #include "GraphicsPrimitives.h"
+#include "pixelsimd.h"
 #include "math.h"
 
 #if defined (WP8)
@@ -159,6 +160,43 @@ Pixel makePixelARGB(int32 rgb) // from Java's big endian to native format
    return p.pixel;
 }
 
+#define DIRTY_MERGE_WASTE (64*64) // two rectangles are merged if their union has at most these pixels more than them
+
+// Adds a rectangle, already clipped to the screen, to the damage list. It's merged with the one whose union with it
+// wastes less pixels, if these are few or if the list is full; the union is then added again, since it may now overlap
+// other ones. Must be called with the screen locked.
+static void addDirtyRect(Context currentContext, int32 x1, int32 y1, int32 x2, int32 y2)
+{
+   TDirtyRect* r = currentContext->dirtyRects;
+   int32 n = currentContext->dirtyCount, i, best, bestWaste = 0;
+   for (;;)
+   {
+      best = -1;
+      for (i = 0; i < n; i++)
+      {
+         int32 waste = (max32(r[i].x2, x2) - min32(r[i].x1, x1)) * (max32(r[i].y2, y2) - min32(r[i].y1, y1)) -
+                       (r[i].x2 - r[i].x1) * (r[i].y2 - r[i].y1) - (x2 - x1) * (y2 - y1); // negative if they overlap
+         if (best < 0 || waste < bestWaste)
+         {
+            best = i;
+            bestWaste = waste;
+         }
+      }
+      if (best < 0 || (bestWaste > DIRTY_MERGE_WASTE && n < MAX_DIRTY_RECTS))
+         break;
+      x1 = min32(r[best].x1, x1);
+      y1 = min32(r[best].y1, y1);
+      x2 = max32(r[best].x2, x2);
+      y2 = max32(r[best].y2, y2);
+      r[best] = r[--n];
+   }
+   r[n].x1 = x1;
+   r[n].y1 = y1;
+   r[n].x2 = x2;
+   r[n].y2 = y2;
+   currentContext->dirtyCount = n+1;
+}
+
 // Updates the dirty area (or extends the current one)
 // DO NOT LOCK THE SCREEN ON THIS METHOD. THE CALLER MUST DO THAT.
 static void markScreenDirty(Context currentContext, int32 x, int32 y, int32 w, int32 h)
@@ -174,6 +212,7 @@ static void markScreenDirty(Context currentContext, int32 x, int32 y, int32 w, i
       y2 = y+h;
       if (x2 > screen.screenW) x2 = screen.screenW;
       if (y2 > screen.screenH) y2 = screen.screenH;
+      addDirtyRect(currentContext, x, y, x2, y2);
 
       if (currentContext->dirtyX1 < x)
       {
@@ -210,14 +249,23 @@ static void markScreenDirty(Context currentContext, int32 x, int32 y, int32 w, i
 #define LOGD(...) debug(__VA_ARGS__)
 #endif
 
+#define DIRTY_MARGIN 2 // the antialiased edges and the 0-width lines drawn by skia may go beyond the given area
+
 void markDirty(Context currentContext, TCObject surface, int x, int y, int w, int h) {
     if (Graphics_isImageSurface(surface)) {
         Image_changed(Graphics_surface(surface)) = true;
     } else {
+        int32 x1 = max32(x - DIRTY_MARGIN, 0), y1 = max32(y - DIRTY_MARGIN, 0);
+        int32 x2 = min32(x + w + DIRTY_MARGIN, screen.screenW), y2 = min32(y + h + DIRTY_MARGIN, screen.screenH);
         currentContext->dirtyX1 = min32(currentContext->dirtyX1, x);
         currentContext->dirtyY1 = min32(currentContext->dirtyY1, y);
         currentContext->dirtyX2 = max32(currentContext->dirtyX2, x + w);
         currentContext->dirtyY2 = max32(currentContext->dirtyY2, y + h);
+        if (x1 < x2 && y1 < y2 && !currentContext->fullDirty) {
+            LOCKVAR(screen);
+            addDirtyRect(currentContext, x1, y1, x2, y2);
+            UNLOCKVAR(screen);
+        }
     }
 }
 
@@ -360,34 +408,10 @@ static void drawSurface(Context currentContext, TCObject dstSurf, TCObject srcSu
 #endif
    for (i=0; i < (uint32)height; i++) // in opengl, only case of image drawing on image
    {
-      PixelConv *ps = (PixelConv*)srcPixels;
-      PixelConv *pt = (PixelConv*)dstPixels;
-      uint32 count = width;
       if (isSrcScreen)
-         for (;count != 0; pt++,ps++, count--)
-         {
-            pt->pixel = ps->pixel;
-            pt->a = 0xFF;
-         }
+         pixelKernels.copyOpaque(dstPixels, srcPixels, width);
       else
-         for (;count != 0; pt++,ps++, count--)
-         {
-            int32 a = ps->a * alphaMask;
-            a = (a+1 + (a >> 8)) >> 8; // alphaMask * a / 255
-            if (a == 0xFF)
-               pt->pixel = ps->pixel;
-            else
-            if (a != 0)
-            {
-               int32 ma = 0xFF-a;
-               int32 r = (a * ps->r + ma * pt->r);
-               int32 g = (a * ps->g + ma * pt->g);
-               int32 b = (a * ps->b + ma * pt->b);
-               pt->r = (r+1 + (r >> 8)) >> 8; // fast way to divide by 255
-               pt->g = (g+1 + (g >> 8)) >> 8;
-               pt->b = (b+1 + (b >> 8)) >> 8;
-            }
-         }
+         pixelKernels.blend(dstPixels, srcPixels, width, alphaMask);
       srcPixels += srcPitch;
       dstPixels += Graphics_pitch(dstSurf);
    }
@@ -611,17 +635,7 @@ static void drawHLine(Context currentContext, TCObject g, int32 x, int32 y, int3
       {
          pTgt = getGraphicsPixels(g) + y * Graphics_pitch(g) + x;
          if (!currentContext->fullDirty && !Graphics_isImageSurface(g)) markScreenDirty(currentContext, x, y, width, 1);
-         if (pixel1 == pixel2) // same color?
-         {
-            while (width-- > 0)
-               *pTgt++ = pixel1;          // plot the pixel
-         }
-         else
-         {
-            int32 i=0;
-            while (width-- > 0)
-               *pTgt++ = (i++ & 1) ? pixel1 : pixel2;
-         }
+         pixelKernels.fill(pTgt, width, pixel2, pixel1); // a dotted line starts with pixel2
       }
    }
 }
@@ -1005,25 +1019,14 @@ static void fillRect(Context currentContext, TCObject g, int32 x, int32 y, int32
       else
 #endif
       {
-         uint32 count;
          int32 pitch = Graphics_pitch(g);
          Pixel* to = getGraphicsPixels(g) + y * pitch + x;
          if (!currentContext->fullDirty && !Graphics_isImageSurface(g)) markScreenDirty(currentContext, x, y, width, height);
          if (x == 0 && width == pitch) // filling with full width?
-         {
-            int32* t = (int32*)to;
-            int32 p2 = pixel;
-            count = width*height;
-            for (; count != 0; count--)
-               *t++ = p2;
-         }
+            pixelKernels.fill(to, width*height, pixel, pixel);
          else
-         {
-            uint32 i = width, j = height;
-            for (pitch -= width; j != 0;  to += pitch, i=width, j--)
-               for (; i != 0; i--)
-                  *to++ = pixel;
-         }
+            for (; height-- > 0; to += pitch)
+               pixelKernels.fill(to, width, pixel, pixel);
       }
    }
 }
@@ -1044,6 +1047,7 @@ static void fillRect(Context currentContext, TCObject g, int32 x, int32 y, int32
 // Darkens the screen
 static void fadeScreen(Context currentContext, int32 amount) {
     skia_fillRect(0, 0, 0, screen.screenW, screen.screenH,  amount << 24);
+    currentContext->fullDirty = true;
     currentContext->dirtyX1 = 0;
     currentContext->dirtyY1 = 0;
     currentContext->dirtyX2 = screen.screenW;
@@ -1433,7 +1437,7 @@ static void drawText(Context currentContext, TCObject g, JCharP text, int32 chrC
    skia_drawText(0, text, chrCount * sizeof(JChar), x, y + fontSize, foreColor | Graphics_alpha(g), justifyWidth, fontSize, typefaceIndex);
    skia_restoreClip();
 
-   markDirty(currentContext, g, x, y, skia_stringWidth(text, chrCount * sizeof(JChar), typefaceIndex, fontSize), fontSize);
+   markDirty(currentContext, g, x, y, skia_stringWidth(text, chrCount * sizeof(JChar), typefaceIndex, fontSize), fontSize * 3 / 2); // the baseline is at y + fontSize
 }
 #endif
 
@@ -1565,7 +1569,7 @@ static void ellipseDrawAndFill(Context currentContext, TCObject g, int32 xc, int
    skia_ellipseDrawAndFill(0, xc, yc, rx, ry, pc1 | Graphics_alpha(g), pc2 | Graphics_alpha(g), fill, gradient);
    skia_restoreClip();
 
-   markDirty(currentContext, g, xc - rx, yc + ry, rx * 2, ry * 2);
+   markDirty(currentContext, g, xc - rx, yc - ry, rx * 2, ry * 2);
 }
 #endif
 
@@ -1819,7 +1823,7 @@ static void arcPiePointDrawAndFill(Context currentContext, TCObject g, int32 xc,
    skia_arcPiePointDrawAndFill(0, xc, yc, rx, ry, startAngle, endAngle, c | Graphics_alpha(g), c2 | Graphics_alpha(g), fill, pie, gradient);
    skia_restoreClip();
 
-   markDirty(currentContext, g, xc - rx, yc + ry, rx * 2, ry * 2);
+   markDirty(currentContext, g, xc - rx, yc - ry, rx * 2, ry * 2);
 }
 #else
 static void arcPiePointDrawAndFill(Context currentContext, TCObject g, int32 xc, int32 yc, int32 rx, int32 ry, double startAngle, double endAngle, Pixel c, Pixel c2, bool fill, bool pie, bool gradient)
@@ -2905,6 +2909,8 @@ static int getsetRGB(Context currentContext, TCObject g, TCObject dataObj, int32
       int32 count = w * h;
 
       if (skia_getsetRGB(0, (void*) data, offset, x, y, w, h, isGet) == 1) {
+         if (!isGet)
+            markDirty(currentContext, g, x, y, w, h);
          return count;
       }
    }
@@ -2925,7 +2931,17 @@ static void setPixelA(Context currentContext, TCObject g, int32 x, int32 y, Pixe
    }
    else
 #endif
-      setPixel(currentContext, g, x,y,interpolate(color, getPixelConv(g, x,y), alpha));
+   {
+      // translates and clips once, instead of in getPixelConv and setPixel; this is called for each pixel of the anti-aliased curves
+      x += Graphics_transX(g);
+      y += Graphics_transY(g);
+      if (Graphics_clipX1(g) <= x && x < Graphics_clipX2(g) && Graphics_clipY1(g) <= y && y < Graphics_clipY2(g))
+      {
+         PixelConv* p = (PixelConv*)(getGraphicsPixels(g) + y * Graphics_pitch(g) + x);
+         p->pixel = interpolate(color, *p, alpha);
+         if (!currentContext->fullDirty && !Graphics_isImageSurface(g)) markScreenDirty(currentContext, x, y, 1, 1);
+      }
+   }
 }
 #endif
 
@@ -3112,6 +3128,7 @@ void updateScreen(Context currentContext)
       currentContext->dirtyX1 = screen.screenW;
       currentContext->dirtyY1 = screen.screenH;
       currentContext->dirtyX2 = currentContext->dirtyY2 = 0;
+      currentContext->dirtyCount = 0;
       currentContext->fullDirty = false;
    }
    UNLOCKVAR(screen);
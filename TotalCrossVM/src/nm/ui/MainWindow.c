@@ -38,11 +38,13 @@ TC_API void tuMW_exit_i(NMParams p) // totalcross/ui/MainWindow native public fi
    exitCode = p->i32[0];
    printf("tuMW_exit_i\n");    
    keepRunning = false;
+   wakeUpEventLoop();
 }
 //////////////////////////////////////////////////////////////////////////
 void setTimerInterval(int32 t)
 {
    nextTimerTick = getTimeStamp() + t;
+   wakeUpEventLoop(); // the main loop may be waiting for a deadline later than this one
 }
 
 TC_API void tuMW_setTimerInterval_i(NMParams p) // totalcross/ui/MainWindow native void setTimerInterval(int n);
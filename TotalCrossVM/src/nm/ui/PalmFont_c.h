@@ -29,7 +29,7 @@ bool fontInit(Context currentContext)
    if (!maxfs || !minfs || !normal || !tabSizeField || !defaultFontNameObj)
       return false;
 
-   JCharP2CharPBuf(String_charsStart(*defaultFontNameObj), String_charsLen(*defaultFontNameObj), defaultFontName);
+   String2CharPBuf(*defaultFontNameObj, defaultFontName);
    maxFontSize = *maxfs;
    minFontSize = *minfs;
    normalFontSize = *normal;
@@ -79,6 +79,19 @@ TC_API void tuW_setOrientation_i(NMParams p) // totalcross/ui/Window native publ
    windowSetOrientation(p->i32[0]);
 #endif
 }
+//////////////////////////////////////////////////////////////////////////
+TC_API void tuW_getFrameStats_I(NMParams p) // totalcross/ui/Window native public static int getFrameStats(int []stats);
+{
+   TCObject stats = p->obj[0];
+   if (stats == null)
+      throwNullArgumentException(p->currentContext, "stats");
+   else
+#if defined(linux) && !defined(darwin) && !defined(ANDROID)
+      p->retI = windowGetFrameStats((int32*)ARRAYOBJ_START(stats), (int32)ARRAYOBJ_LEN(stats));
+#else
+      p->retI = 0;
+#endif
+}
 
 #ifdef ENABLE_TEST_SUITE
 #include "Window_test.h"
@@ -23,7 +23,7 @@ TC_API void tumYP_play_scbii(NMParams p) {
     int32 end = p->i32[1];
     int32 start = p->i32[2];
     JNIEnv* env = getJNIEnv();
-    jstring jUrl = (*env)->NewString(env, (jchar*) String_charsStart(url), String_charsLen(url));
+    jstring jUrl = String2jstring(env, url);
     (*env)->CallStaticObjectMethod(env, applicationClass, jplayYoutube, jUrl, autoPlay == 1 ? JNI_TRUE : JNI_FALSE, start, end);
 #endif
 }
@@ -23,7 +23,7 @@ static void windowSetDeviceTitle(TCObject titleObj)
 {
    JNIEnv* env = getJNIEnv();
    jmethodID m = (*env)->GetStaticMethodID(env, applicationClass, "setDeviceTitle", "(Ljava/lang/String;)V");
-   jstring s = (*env)->NewString(env, String_charsStart(titleObj), String_charsLen(titleObj));
+   jstring s = String2jstring(env, titleObj);
    (*env)->CallStaticVoidMethod(env, applicationClass, m, s);
    (*env)->DeleteLocalRef(env, s);
 }
@@ -68,7 +68,7 @@ static void cameraClick(NMParams p)
          createTempFileName(fileName, isPhoto ? ".jpg" : ".3gp");
       else
       {
-         JCharP2CharPBuf(String_charsStart(defaultFN),String_charsLen(defaultFN),fileName);
+         String2CharPBuf(defaultFN, fileName);
          if (xstrchr(fileName,'/') == null && xstrchr(fileName,'\\') == null) // no path specified:
          {
             char temp[MAX_PATHNAME];
@@ -41,7 +41,7 @@ static void soundToText(NMParams p)
    JNIEnv* env = getJNIEnv();         
    TCObject o = null;
    TCObject params = p->obj[0];
-   jstring jparams = params == null ? null : (*env)->NewString(env, (jchar*) String_charsStart(params), String_charsLen(params));
+   jstring jparams = String2jstring(env, params);
    jstring result = (*env)->CallStaticObjectMethod(env, applicationClass, jsoundToText, jparams);
    if (jparams != null) (*env)->DeleteLocalRef(env, jparams);
    if (result != null)
@@ -59,7 +59,7 @@ static void soundFromText(NMParams p)
 {
    JNIEnv* env = getJNIEnv();         
    TCObject params = p->obj[0];
-   jstring jparams = params == null ? null : (*env)->NewString(env, (jchar*) String_charsStart(params), String_charsLen(params));
+   jstring jparams = String2jstring(env, params);
    (*env)->CallStaticVoidMethod(env, applicationClass, jsoundFromText, jparams);
    if (jparams != null) (*env)->DeleteLocalRef(env, jparams);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: LGPL-2.1-only
 
 #include "skia.h"
+#include "../pixelsimd.h"
 
 #if __APPLE__
 #ifdef darwin
@@ -154,10 +155,15 @@ void initSkia(int w, int h, void * pixels, int pitch, uint32_t pixelformat)
 }
 
 void flushSkia()
+{
+    flushSkiaRects(NULL, 0);
+}
+
+void flushSkiaRects(int32* rects, int32 count)
 {
     canvas->flush();
 #ifdef HEADLESS
-    TCSDL_UpdateTexture(bitmap.width(), bitmap.height(), bitmap.rowBytes(),bitmap.getPixels());
+    TCSDL_UpdateTexture(bitmap.width(), bitmap.height(), bitmap.rowBytes(), bitmap.getPixels(), rects, count);
 #endif
 }
 
@@ -215,10 +221,7 @@ int skia_makeBitmap(int32 id, void *data, int32 w, int32 h) {
 
     //TODO: reuse pixel data and avoid all this allocation, maybe using data directly with the correct color type
     int32 *converted = new int32[w * h];
-    for (int i = 0; i < w * h; i++) {
-        int32 pixel = ((Pixel*)data)[i];
-        converted[i] = (((pixel >> 24) & 0xFF)) | ((((pixel >> 16) & 0xFF) << 8) | (((pixel >> 8) & 0xFF) << 16) | ((pixel & 0xFF) << 24));
-    }
+    pixelKernels.swapBytes((Pixel*)converted, (Pixel*)data, w * h);
 
     if (id < 0) { // must create a new bitmap
         SkBitmap bitmap;
@@ -21,6 +21,9 @@ int32 colorType(uint32 pixelformat);
 #endif
 void initSkia(int w, int h, void * pixels, int pitch, uint32 pixelformat);
 void flushSkia();
+/// Like flushSkia, but only the given rectangles (count quadruples of x1, y1, x2, y2, with x2 and y2 exclusive) are
+/// copied to the screen, where that's done by the cpu.
+void flushSkiaRects(int32* rects, int32 count);
 
 int skia_makeTypeface(char* name, void *data, int32 size);
 int32 skia_getTypefaceIndex(char* name);
@@ -31,7 +31,9 @@ void windowSetSIP(Context currentContext, int32 sipOption, TCObject control, boo
      if (!m) return; // guich@tc115_15: the ideal would be to "paste" the text in the current event queue instead of assuming this is an Edit or MultiEdit.
 	  assert(sizeof(unichar) == sizeof(JChar));
      TValue ret = executeMethod(currentContext, m, control);
-	  str = [ [ NSString alloc ] initWithCharacters: String_charsStart(ret.asObj) length: String_charsLen(ret.asObj) ];
+     JCharP chars = widenString(currentContext, ret.asObj);
+     if (chars)
+	     str = [ [ NSString alloc ] initWithCharacters: chars length: String_charsLen(ret.asObj) ];
    }
    SipArguments *args = [ [ SipArguments alloc ] init: SipArgsMake(sipOption, (__bridge id)control, numeric, str) ];
    if (DEVICE_CTX && DEVICE_CTX->_mainview && allowMainThread)
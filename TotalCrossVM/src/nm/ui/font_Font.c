@@ -57,11 +57,13 @@ TC_API void tufF_fontCreate(NMParams p) // totalcross/ui/font/Font native void f
       ff = defaultFont;
       // replace the name so the user can know that the font was not found
       Font_name(obj) = createStringObjectFromCharP(p->currentContext, defaultFontName,6);
+      WRITE_BARRIER(obj, Font_name(obj));
       setObjectLock(Font_name(obj), UNLOCKED);
    }
    if (Font_hvUserFont(obj) == null) // alloc space for the pointer
    {
       Font_hvUserFont(obj) = createByteArray(p->currentContext, TSIZE);
+      WRITE_BARRIER(obj, Font_hvUserFont(obj));
       setObjectLock(Font_hvUserFont(obj), UNLOCKED);
    }
    if (Font_hvUserFont(obj) != null) // alloc space for the pointer
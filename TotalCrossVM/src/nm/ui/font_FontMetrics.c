@@ -28,10 +28,13 @@ TC_API void tufFM_charWidth_c(NMParams p) // totalcross/ui/font/FontMetrics nati
 TC_API void tufFM_stringWidth_s(NMParams p) // totalcross/ui/font/FontMetrics native public int stringWidth(String s);
 {
    TCObject s = p->obj[1];
+   JChar buf[256];
+   JCharP chars;
    if (s == null)
       throwNullArgumentException(p->currentContext, "s");
    else
-      p->retI = getJCharPWidth(p->currentContext, FontMetrics_font(p->obj[0]), String_charsStart(s), String_charsLen(s));
+   if ((chars = String2JCharPBuf(p->currentContext, s, buf, 256)) != null)
+      p->retI = getJCharPWidth(p->currentContext, FontMetrics_font(p->obj[0]), chars, String_charsLen(s));
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tufFM_stringWidth_Cii(NMParams p) // totalcross/ui/font/FontMetrics native public int stringWidth(char []chars, int start, int count);
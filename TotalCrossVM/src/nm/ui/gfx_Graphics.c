@@ -22,6 +22,7 @@
 #elif defined(linux) && !defined(darwin)
  #include "linux/gfx_Graphics_c.h"
 #endif
+#include "DisplayList_c.h"
 
 bool initGraphicsBeforeSettings(Context currentContext, int16 appTczAttr) // no thread are running at this point
 {
@@ -76,84 +77,98 @@ TC_API void tugG_drawEllipse_iiii(NMParams p) // totalcross/ui/gfx/Graphics nati
 {
    TCObject g = p->obj[0];
    ellipseDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_forePixel(g), Graphics_forePixel(g), false, false);
+   recordDrawing(p, DL_DRAWELLIPSE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillEllipse_iiii(NMParams p) // totalcross/ui/gfx/Graphics native public void fillEllipse(int xc, int yc, int rx, int ry);
 {
    TCObject g = p->obj[0];
    ellipseDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_backPixel(g), Graphics_backPixel(g), true, false);
+   recordDrawing(p, DL_FILLELLIPSE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillEllipseGradient_iiii(NMParams p) // totalcross/ui/gfx/Graphics native public void fillEllipseGradient(int xc, int yc, int rx, int ry);
 {
    TCObject g = p->obj[0];
    ellipseDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_forePixel(g), Graphics_backPixel(g), true, true);
+   recordDrawing(p, DL_FILLELLIPSEGRADIENT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawArc_iiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void drawArc(int xc, int yc, int r, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_forePixel(g), false, false, false);
+   recordDrawing(p, DL_DRAWARC);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawPie_iiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void drawPie(int xc, int yc, int r, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_forePixel(g), false, true, false);
+   recordDrawing(p, DL_DRAWPIE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillPie_iiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void fillPie(int xc, int yc, int r, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_backPixel(g), true, true, false);
+   recordDrawing(p, DL_FILLPIE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillPieGradient_iiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void fillPieGradient(int xc, int yc, int r, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_backPixel(g), true, true, true);
+   recordDrawing(p, DL_FILLPIEGRADIENT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawEllipticalArc_iiiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void drawEllipticalArc(int xc, int yc, int rx, int ry, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_forePixel(g), false, false, false);
+   recordDrawing(p, DL_DRAWELLIPTICALARC);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawEllipticalPie_iiiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void drawEllipticalPie(int xc, int yc, int rx, int ry, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_forePixel(g), false, true, false);
+   recordDrawing(p, DL_DRAWELLIPTICALPIE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillEllipticalPie_iiiidd(NMParams p) // totalcross/ui/gfx/Graphics native public void fillEllipticalPie(int xc, int yc, int rx, int ry, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_backPixel(g), true, true, false);
+   recordDrawing(p, DL_FILLELLIPTICALPIE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillEllipticalPieGradient_i(NMParams p) // totalcross/ui/gfx/Graphics native public void fillEllipticalPieGradient(int xc, int yc, int rx, int ry, double startAngle, double endAngle);
 {
    TCObject g = p->obj[0];
    arcPiePointDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], p->dbl[0], p->dbl[1], Graphics_forePixel(g), Graphics_backPixel(g), true, true, true);
+   recordDrawing(p, DL_FILLELLIPTICALPIEGRADIENT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawCircle_iii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawCircle(int xc, int yc, int r);
 {
    TCObject g = p->obj[0];
    ellipseDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], Graphics_forePixel(g), Graphics_forePixel(g), false, false);
+   recordDrawing(p, DL_DRAWCIRCLE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillCircle_iii(NMParams p) // totalcross/ui/gfx/Graphics native public void fillCircle(int xc, int yc, int r);
 {
    TCObject g = p->obj[0];
    ellipseDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], Graphics_backPixel(g), Graphics_backPixel(g), true, false);
+   recordDrawing(p, DL_FILLCIRCLE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillCircleGradient_iii(NMParams p) // totalcross/ui/gfx/Graphics native public void fillCircleGradient(int xc, int yc, int r);
 {
    TCObject g = p->obj[0];
    ellipseDrawAndFill(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[2], Graphics_foreColor(g), Graphics_backPixel(g), true, true);
+   recordDrawing(p, DL_FILLCIRCLEGRADIENT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_getPixel_ii(NMParams p) // totalcross/ui/gfx/Graphics native public int getPixel(int x, int y);
@@ -166,36 +181,42 @@ TC_API void tugG_setPixel_ii(NMParams p) // totalcross/ui/gfx/Graphics native pu
 {
    TCObject g = p->obj[0];
    setPixel(p->currentContext, g, p->i32[0], p->i32[1], Graphics_forePixel(g));
+   recordDrawing(p, DL_SETPIXEL);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawLine_iiii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawLine(int ax, int ay, int bx, int by);
 {
    TCObject g = p->obj[0];
    drawLine(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_forePixel(g));
+   recordDrawing(p, DL_DRAWLINE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawLine_iiiii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawLine(int ax, int ay, int bx, int by, int c);
 {
     TCObject g = p->obj[0];
     drawLine(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->i32[4]);
+   recordDrawing(p, DL_DRAWLINEC);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawDots_iiii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawDots(int ax, int ay, int bx, int by);
 {
    TCObject g = p->obj[0];
    drawDottedLine(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_forePixel(g), Graphics_backPixel(g));
+   recordDrawing(p, DL_DRAWDOTS);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawRect_iiii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawRect(int x, int y, int w, int h);
 {
    TCObject g = p->obj[0];
    drawRect(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_forePixel(g));
+   recordDrawing(p, DL_DRAWRECT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillRect_iiii(NMParams p) // totalcross/ui/gfx/Graphics native public void fillRect(int x, int y, int w, int h);
 {
    TCObject g = p->obj[0];
    fillRect(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], Graphics_backPixel(g));
+   recordDrawing(p, DL_FILLRECT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillPolygon_IIi(NMParams p) // totalcross/ui/gfx/Graphics native public void fillPolygon(int []xPoints, int []yPoints, int nPoints);
@@ -210,6 +231,7 @@ TC_API void tugG_fillPolygon_IIi(NMParams p) // totalcross/ui/gfx/Graphics nativ
 
    if (checkArrayRange(p->currentContext, xPoints, 0, nPoints) && checkArrayRange(p->currentContext, yPoints, 0, nPoints))
       fillPolygon(p->currentContext, g, xp, yp, nPoints, 0, 0, 0, 0, 0, Graphics_backPixel(g), Graphics_backPixel(g), false, false);
+   recordDrawing(p, DL_FILLPOLYGON);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillPolygonGradient_IIi(NMParams p) // totalcross/ui/gfx/Graphics native public void fillPolygonGradient(int []xPoints, int []yPoints, int nPoints);
@@ -224,6 +246,7 @@ TC_API void tugG_fillPolygonGradient_IIi(NMParams p) // totalcross/ui/gfx/Graphi
 
    if (checkArrayRange(p->currentContext, xPoints, 0, nPoints) && checkArrayRange(p->currentContext, yPoints, 0, nPoints))
       fillPolygon(p->currentContext, g, xp, yp, nPoints, 0, 0, 0, 0, 0, Graphics_forePixel(g), Graphics_backPixel(g), true, false);
+   recordDrawing(p, DL_FILLPOLYGONGRADIENT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawPolygon_IIi(NMParams p) // totalcross/ui/gfx/Graphics native public void drawPolygon(int []xPoints, int []yPoints, int nPoints);
@@ -241,6 +264,7 @@ TC_API void tugG_drawPolygon_IIi(NMParams p) // totalcross/ui/gfx/Graphics nativ
       drawPolygon(p->currentContext, g, xp, yp, nPoints, 0, 0, 0, 0, 0, Graphics_forePixel(g));
       drawLine(p->currentContext, g, xp[0],yp[0],xp[nPoints-1],yp[nPoints-1], Graphics_forePixel(g));
    }
+   recordDrawing(p, DL_DRAWPOLYGON);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawPolyline_IIi(NMParams p) // totalcross/ui/gfx/Graphics native public void drawPolyline(int []xPoints, int []yPoints, int nPoints);
@@ -255,26 +279,32 @@ TC_API void tugG_drawPolyline_IIi(NMParams p) // totalcross/ui/gfx/Graphics nati
 
    if (checkArrayRange(p->currentContext, xPoints, 0, nPoints) && checkArrayRange(p->currentContext, yPoints, 0, nPoints))
       drawPolygon(p->currentContext, g, xp, yp, nPoints, 0, 0, 0, 0, 0, Graphics_forePixel(g));
+   recordDrawing(p, DL_DRAWPOLYLINE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawText_siii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawText(String text, int x, int y, int justifyWidth);
 {
 	TCObject text;
 	TCObject g = p->obj[0];
-	if ((text = p->obj[1]) != null)
-		drawText(p->currentContext, g, String_charsStart(text), String_charsLen(text), p->i32[0], p->i32[1], Graphics_forePixel(g), p->i32[2]);
+	JChar buf[256]; // the text is usually short, and it's drawn many times; so a compact string is widened on the stack
+	JCharP chars;
+	if ((text = p->obj[1]) != null && (chars = String2JCharPBuf(p->currentContext, text, buf, 256)) != null)
+		drawText(p->currentContext, g, chars, String_charsLen(text), p->i32[0], p->i32[1], Graphics_forePixel(g), p->i32[2]);
+   recordDrawing(p, DL_DRAWTEXT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawRoundRect_iiiii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawRoundRect(int x, int y, int width, int height, int r);
 {
    TCObject g = p->obj[0];
    drawRoundRect(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->i32[4], Graphics_forePixel(g));
+   recordDrawing(p, DL_DRAWROUNDRECT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fillRoundRect_iiiii(NMParams p) // totalcross/ui/gfx/Graphics native public void fillRoundRect(int x, int y, int width, int height, int r);
 {
    TCObject g = p->obj[0];
    fillRoundRect(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->i32[4], Graphics_backPixel(g));
+   recordDrawing(p, DL_FILLROUNDRECT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_copyRect_giiiiii(NMParams p) // totalcross/ui/gfx/Graphics native public void copyRect(totalcross.ui.gfx.GfxSurface surface, int x, int y, int width, int height, int dstX, int dstY);
@@ -283,12 +313,14 @@ TC_API void tugG_copyRect_giiiiii(NMParams p) // totalcross/ui/gfx/Graphics nati
    TCObject hOrig = p->obj[1];
    if (hOrig)
       drawSurface(p->currentContext, hDest, hOrig, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->i32[4], p->i32[5], true);
+   recordDrawing(p, DL_UNREPLAYABLE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawRoundGradient_iiiiiiiii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawRoundGradient(int startX, int startY, int endX, int endY, int topLeftRadius, int topRightRadius, int bottomLeftRadius, int bottomRightRadius,int startColor, int endColor);
 {
    TCObject g = p->obj[0];
    drawRoundGradient(p->currentContext, g, p->i32[0],p->i32[1],p->i32[2],p->i32[3],p->i32[4],p->i32[5],p->i32[6],p->i32[7],p->i32[8],p->i32[9], p->i32[10]);
+   recordDrawing(p, DL_DRAWROUNDGRADIENT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawImage_iiib(NMParams p) // totalcross/ui/gfx/Graphics native public void drawImage(totalcross.ui.image.Image image, int x, int y, boolean doClip);
@@ -296,6 +328,7 @@ TC_API void tugG_drawImage_iiib(NMParams p) // totalcross/ui/gfx/Graphics native
    TCObject surfDest = p->obj[0];
    TCObject surfOrig = p->obj[1];
    if (surfOrig) drawSurface(p->currentContext, surfDest, surfOrig, 0, 0, (int32)(Image_width(surfOrig) * Image_hwScaleW(surfOrig)), (int32)(Image_height(surfOrig) * Image_hwScaleH(surfOrig)), p->i32[0], p->i32[1], (bool)p->i32[2]);
+   recordDrawing(p, DL_DRAWIMAGECLIP);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_copyImageRect_iiiiib(NMParams p) // totalcross/ui/gfx/Graphics native public void copyImageRect(totalcross.ui.image.Image image, int x, int y, int width, int height, boolean doClip);
@@ -303,6 +336,7 @@ TC_API void tugG_copyImageRect_iiiiib(NMParams p) // totalcross/ui/gfx/Graphics
    TCObject surfDest = p->obj[0];
    TCObject surfOrig = p->obj[1];
    if (surfOrig) drawSurface(p->currentContext, surfDest, surfOrig, p->i32[0], p->i32[1], p->i32[2], p->i32[3], 0,0, (bool)p->i32[4]);
+   recordDrawing(p, DL_COPYIMAGERECT);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_setPixels_IIi(NMParams p) // totalcross/ui/gfx/Graphics native public void setPixels(int []xPoints, int []yPoints, int nPoints);
@@ -320,6 +354,7 @@ TC_API void tugG_setPixels_IIi(NMParams p) // totalcross/ui/gfx/Graphics native
    if (checkArrayRange(p->currentContext, xPoints, 0, nPoints) && checkArrayRange(p->currentContext, yPoints, 0, nPoints))
       while (nPoints-- > 0)
          setPixel(p->currentContext, g, *xp++, *yp++, c);
+   recordDrawing(p, DL_SETPIXELS);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_refresh_iiiiiif(NMParams p) // totalcross/ui/gfx/Graphics native public void refresh(int sx, int sy, int sw, int sh, int tx, int ty, totalcross.ui.font.Font f);
@@ -343,7 +378,11 @@ TC_API void tugG_refresh_iiiiiif(NMParams p) // totalcross/ui/gfx/Graphics nativ
    Graphics_clipY2(g) = Graphics_maxY(g) = min32(p->i32[1]+p->i32[3],scrH);
    Graphics_transX(g) = p->i32[4];
    Graphics_transY(g) = p->i32[5];
-   if (p->obj[1]) Graphics_font(g) = p->obj[1];
+   if (p->obj[1])
+   {
+      Graphics_font(g) = p->obj[1];
+      WRITE_BARRIER(g, p->obj[1]);
+   }
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_drawImage_iii(NMParams p) // totalcross/ui/gfx/Graphics native public void drawImage(totalcross.ui.image.Image image, int x, int y);
@@ -352,6 +391,7 @@ TC_API void tugG_drawImage_iii(NMParams p) // totalcross/ui/gfx/Graphics native
    TCObject surfDest = p->obj[0];
    TCObject surfOrig = p->obj[1];
    if (surfOrig) drawSurface(p->currentContext, surfDest, surfOrig, 0,0, (int32)(Image_width(surfOrig) * Image_hwScaleW(surfOrig)), (int32)(Image_height(surfOrig) * Image_hwScaleH(surfOrig)), p->i32[0], p->i32[1], true);
+   recordDrawing(p, DL_DRAWIMAGE);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_getRGB_Iiiiii(NMParams p) // totalcross/ui/gfx/Graphics native public int getRGB(int []data, int offset, int x, int y, int w, int h);
@@ -366,6 +406,7 @@ TC_API void tugG_setRGB_Iiiiii(NMParams p) // totalcross/ui/gfx/Graphics native
    TCObject g = p->obj[0];
    TCObject data = p->obj[1];
    p->retI = getsetRGB(p->currentContext, g, data, p->i32[0], p->i32[1], p->i32[2], p->i32[3], p->i32[4],false);
+   recordDrawing(p, DL_SETRGB);
 }
 //////////////////////////////////////////////////////////////////////////
 TC_API void tugG_fadeScreen_i(NMParams p) // totalcross/ui/gfx/Graphics native public static void fadeScreen(int fadeValue);
@@ -397,6 +438,39 @@ TC_API void tugG_dither_iiii(NMParams p) // totalcross/ui/gfx/Graphics native pu
 {
    TCObject g = p->obj[0];
    dither(p->currentContext, g, p->i32[0], p->i32[1], p->i32[2], p->i32[3]);
+   recordDrawing(p, DL_UNREPLAYABLE);
+}
+//////////////////////////////////////////////////////////////////////////
+TC_API void tugG_startRecording_d(NMParams p) // totalcross/ui/gfx/Graphics native public void startRecording(totalcross.ui.gfx.DisplayList list);
+{
+   TCObject g = p->obj[0];
+   TCObject dl = p->obj[1];
+   if (dl == null)
+      throwNullArgumentException(p->currentContext, "list");
+   else
+      dlStartRecording(p->currentContext, g, dl);
+}
+//////////////////////////////////////////////////////////////////////////
+TC_API void tugG_stopRecording(NMParams p) // totalcross/ui/gfx/Graphics native public void stopRecording();
+{
+   TCObject g = p->obj[0];
+   TCObject dl = Graphics_displayList(g);
+   if (dl != null)
+   {
+      DisplayList_valid(dl) = !DisplayList_failed(dl);
+      Graphics_displayList(g) = null;
+   }
+}
+//////////////////////////////////////////////////////////////////////////
+TC_API void tugG_replay_d(NMParams p) // totalcross/ui/gfx/Graphics native public boolean replay(totalcross.ui.gfx.DisplayList list);
+{
+   TCObject g = p->obj[0];
+   TCObject dl = p->obj[1];
+   if (dl == null)
+      throwNullArgumentException(p->currentContext, "list");
+   else
+   if ((p->retI = DisplayList_valid(dl) && Graphics_displayList(g) != dl) != 0) // can't replay into itself
+      dlReplay(p->currentContext, g, dl);
 }
 
 #ifdef ENABLE_TEST_SUITE
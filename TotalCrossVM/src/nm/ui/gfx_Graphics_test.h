@@ -200,6 +200,102 @@ static void testText(Context currentContext, TCObject g)
    Graphics_clipX2(g) = screen.screenW;
 }
 
+// records a fill, then replays it over a blank screen, first with the clip over it and then away from it
+static void testDisplayList(struct TestSuite *tc, Context currentContext, TCObject g)
+{
+   TCObject dl, obj[2];
+   TNMParams p;
+   int32 i32[4] = {10, 10, 20, 20}, filled, blankPixel;
+
+   dl = createObjectWithoutCallingDefaultConstructor(currentContext, "totalcross.ui.gfx.DisplayList");
+   setObjectLock(dl, UNLOCKED);
+   ASSERT1_EQUALS(NotNull, dl);
+   blankPixel = getPixel(g, 15, 15);
+   p.currentContext = currentContext;
+   p.obj = obj;
+   p.i32 = i32;
+   obj[0] = g;
+   obj[1] = dl;
+   Graphics_backColor(g) = 0x0000FF;
+   tugG_startRecording_d(&p);
+   ASSERT2_EQUALS(Ptr, Graphics_displayList(g), dl);
+   tugG_fillRect_iiii(&p);
+   tugG_stopRecording(&p);
+   ASSERT1_EQUALS(Null, Graphics_displayList(g));
+   ASSERT1_EQUALS(True, DisplayList_valid(dl));
+   ASSERT2_EQUALS(I32, DisplayList_count(dl), DL_HEADER + 6 + 1 + 4 + 4); // the header, the state and the fill
+   filled = getPixel(g, 15, 15);
+
+   blank(currentContext, g);
+   tugG_replay_d(&p);
+   ASSERT1_EQUALS(True, p.retI);
+   ASSERT2_EQUALS(I32, getPixel(g, 15, 15), filled);
+
+   blank(currentContext, g);
+   Graphics_clipX1(g) = 40;
+   tugG_replay_d(&p);
+   Graphics_clipX1(g) = 0;
+   ASSERT2_EQUALS(I32, getPixel(g, 15, 15), blankPixel);
+   finish: ;
+}
+
+static int32 sumPixels(TCObject g, int32 x1, int32 y1, int32 x2, int32 y2)
+{
+   int32 x, y, sum = 0;
+   for (y = y1; y < y2; y++)
+      for (x = x1; x < x2; x++)
+         sum = sum * 31 + getPixel(g, x, y);
+   return sum;
+}
+
+// records a text in a list that the gc already promoted, runs the gc, and replays it: the young text and arrays that the
+// list received while recording must survive
+static void testDisplayListAfterGC(struct TestSuite *tc, Context currentContext, TCObject g)
+{
+   TCObject dl, text = null, obj[2];
+   TNMParams p;
+   int32 i32[3] = {10, 40, 0}, tweaks = vmTweaks, drawn;
+
+   dl = createObjectWithoutCallingDefaultConstructor(currentContext, "totalcross.ui.gfx.DisplayList"); // locked until the end
+   ASSERT1_EQUALS(NotNull, dl);
+   setObjectLock(g, LOCKED); // the gc would collect them
+   vmTweaks |= 1 << (VMTWEAK_GENERATIONAL_GC-1);
+   gc(currentContext);
+   ASSERT1_EQUALS(False, OBJ_ISYOUNG(dl));
+   text = createStringObjectFromCharP(currentContext, "DisplayList", -1);
+   ASSERT1_EQUALS(NotNull, text);
+   xmemzero(&p, sizeof(p));
+   p.currentContext = currentContext;
+   p.obj = obj;
+   p.i32 = i32;
+   obj[0] = g;
+   obj[1] = dl;
+   tugG_startRecording_d(&p);
+   obj[1] = text;
+   tugG_drawText_siii(&p);
+   tugG_stopRecording(&p);
+   ASSERT1_EQUALS(True, DisplayList_valid(dl));
+   drawn = sumPixels(g, 10, 40, 130, 70);
+   if (OBJ_ISYOUNG(DisplayList_refs(dl))) // stored in an old object: it must be remembered
+      ASSERT2_EQUALS(I32, OBJ_PROPERTIES(dl)->remembered, 1);
+   setObjectLock(text, UNLOCKED); // now only the list keeps it
+   gc(currentContext);
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(text));
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(DisplayList_cmds(dl)));
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(DisplayList_refs(dl)));
+
+   blank(currentContext, g);
+   obj[1] = dl;
+   tugG_replay_d(&p);
+   ASSERT1_EQUALS(True, p.retI);
+   ASSERT2_EQUALS(I32, sumPixels(g, 10, 40, 130, 70), drawn);
+   finish:
+   vmTweaks = tweaks;
+   setObjectLock(g, UNLOCKED);
+   if (dl != null)
+      setObjectLock(dl, UNLOCKED);
+}
+
 //#define DUMP_TIME
 
 static void debugTime(int32 n, int32 ini)
@@ -248,6 +344,78 @@ TESTCASE(Graphics) // #DEPENDS(tuiI_imageLoad_s)
    s = getTimeStamp();  testDrawCircle(currentContext, g);  debugTime(9, s);  blank(currentContext, g);
    s = getTimeStamp();  testDrawVline(currentContext, g);  debugTime(10, s);  blank(currentContext, g);
    s = getTimeStamp();  testDrawHline(currentContext, g);  debugTime(11, s);  blank(currentContext, g);
-   s = getTimeStamp();  testFillRect(currentContext, g);  debugTime(12, s);  Sleep(TEST_SLEEP); // no blank
+   s = getTimeStamp();  testFillRect(currentContext, g);  debugTime(12, s);  blank(currentContext, g);
+   s = getTimeStamp();  testDisplayList(tc, currentContext, g);  debugTime(13, s);  blank(currentContext, g);
+   s = getTimeStamp();  testDisplayListAfterGC(tc, currentContext, g);  debugTime(14, s);  Sleep(TEST_SLEEP); // no blank
    finish: ;
 }
+
+static bool dirtyRectCovered(Context c, int32 x1, int32 y1, int32 x2, int32 y2) // some rectangle of the damage list contains this one
+{
+   int32 i;
+   for (i = 0; i < c->dirtyCount; i++)
+      if (c->dirtyRects[i].x1 <= x1 && c->dirtyRects[i].y1 <= y1 && x2 <= c->dirtyRects[i].x2 && y2 <= c->dirtyRects[i].y2)
+         return true;
+   return false;
+}
+
+static bool dirtyRectIs(TDirtyRect* r, int32 x1, int32 y1, int32 x2, int32 y2)
+{
+   return r->x1 == x1 && r->y1 == y1 && r->x2 == x2 && r->y2 == y2;
+}
+
+TESTCASE(Graphics_dirtyRects)
+{
+   static struct TContext c; // a context of its own, so the real damage list is not changed
+   TDirtyRect* r = c.dirtyRects;
+   int32 i;
+   UNUSED(currentContext);
+
+   // containment: a rectangle inside another one adds nothing; one around it replaces it
+   addDirtyRect(&c, 10, 10, 100, 100);
+   addDirtyRect(&c, 20, 20, 50, 50);
+   ASSERT2_EQUALS(I32, 1, c.dirtyCount);
+   ASSERT1_EQUALS(True, dirtyRectIs(r, 10, 10, 100, 100));
+   addDirtyRect(&c, 0, 0, 200, 200);
+   ASSERT2_EQUALS(I32, 1, c.dirtyCount);
+   ASSERT1_EQUALS(True, dirtyRectIs(r, 0, 0, 200, 200));
+
+   // adjacent rectangles, below and beside, are merged since their union wastes nothing
+   c.dirtyCount = 0;
+   addDirtyRect(&c, 0, 0, 100, 10);
+   addDirtyRect(&c, 0, 10, 100, 20);
+   addDirtyRect(&c, 100, 0, 150, 20);
+   ASSERT2_EQUALS(I32, 1, c.dirtyCount);
+   ASSERT1_EQUALS(True, dirtyRectIs(r, 0, 0, 150, 20));
+
+   // distant rectangles are kept apart, until the list is full
+   c.dirtyCount = 0;
+   for (i = 0; i < MAX_DIRTY_RECTS; i++)
+      addDirtyRect(&c, i * 200, i * 200, i * 200 + 10, i * 200 + 10);
+   ASSERT2_EQUALS(I32, MAX_DIRTY_RECTS, c.dirtyCount);
+   for (i = 0; i < MAX_DIRTY_RECTS; i++)
+   {
+      ASSERT2_EQUALS(I32, 100, (r[i].x2 - r[i].x1) * (r[i].y2 - r[i].y1));
+      ASSERT1_EQUALS(True, dirtyRectCovered(&c, i * 200, i * 200, i * 200 + 10, i * 200 + 10));
+   }
+   // past MAX_DIRTY_RECTS, the new one is merged into the nearest one, and nothing is lost
+   addDirtyRect(&c, MAX_DIRTY_RECTS * 200, MAX_DIRTY_RECTS * 200, MAX_DIRTY_RECTS * 200 + 10, MAX_DIRTY_RECTS * 200 + 10);
+   ASSERT2_EQUALS(I32, MAX_DIRTY_RECTS, c.dirtyCount);
+   for (i = 0; i <= MAX_DIRTY_RECTS; i++)
+      ASSERT1_EQUALS(True, dirtyRectCovered(&c, i * 200, i * 200, i * 200 + 10, i * 200 + 10));
+   ASSERT1_EQUALS(True, dirtyRectCovered(&c, (MAX_DIRTY_RECTS-1) * 200, (MAX_DIRTY_RECTS-1) * 200, MAX_DIRTY_RECTS * 200 + 10, MAX_DIRTY_RECTS * 200 + 10));
+   for (i = 0; i < 100; i++) // many more: the list never grows, and still covers all of them
+   {
+      int32 x = (i * 7919) % 1500, y = (i * 104729) % 1500;
+      addDirtyRect(&c, x, y, x + 5 + i % 30, y + 5 + i % 20);
+      ASSERT1_EQUALS(True, c.dirtyCount <= MAX_DIRTY_RECTS);
+      ASSERT1_EQUALS(True, dirtyRectCovered(&c, x, y, x + 5 + i % 30, y + 5 + i % 20));
+   }
+   for (i = 0; i <= MAX_DIRTY_RECTS; i++)
+      ASSERT1_EQUALS(True, dirtyRectCovered(&c, i * 200, i * 200, i * 200 + 10, i * 200 + 10));
+   // a rectangle around all of them collapses the list into it
+   addDirtyRect(&c, 0, 0, MAX_DIRTY_RECTS * 200 + 10, MAX_DIRTY_RECTS * 200 + 10);
+   ASSERT2_EQUALS(I32, 1, c.dirtyCount);
+   ASSERT1_EQUALS(True, dirtyRectIs(r, 0, 0, MAX_DIRTY_RECTS * 200 + 10, MAX_DIRTY_RECTS * 200 + 10));
+finish: ;
+}
@@ -8,6 +8,7 @@
 #include "SDL2/SDL.h"
 #endif
 #include "../Window.h"
+#include "../../init/tcsdl.h"
 
 static int32 sip;
 static bool windowGetSIP()
@@ -30,3 +31,8 @@ static void windowSetDeviceTitle(TCObject titleObj)
 {
    UNUSED(titleObj)
 }
+
+static int32 windowGetFrameStats(int32* stats, int32 count)
+{
+   return TCSDL_GetFrameStats(stats, count);
+}
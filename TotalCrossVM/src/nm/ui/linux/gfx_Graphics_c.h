@@ -79,7 +79,10 @@ bool graphicsCreateScreenSurface(ScreenSurface screen)
 void graphicsUpdateScreen(Context currentContext, ScreenSurface screen) // screen's already locked
 {            
 #ifdef SKIA_H
-   flushSkia();
+   if (currentContext->fullDirty || currentContext->dirtyCount == 0)
+      flushSkia();
+   else
+      flushSkiaRects(&currentContext->dirtyRects[0].x1, currentContext->dirtyCount);
 #elif !defined HEADLESS
    DFBRegion bounds;
    bounds.x1 = currentContext->dirtyX1;
@@ -38,6 +38,7 @@ TC_API void tumMC_create(NMParams p) // totalcross/ui/media/MediaClip native pri
          media->mediaStream = mediaStream;
 
          MediaClip_mediaClipRef(mediaClip) = mediaClipRef;
+         WRITE_BARRIER(mediaClip, mediaClipRef);
    }
 #endif
 }
@@ -0,0 +1,306 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include "tcvm.h"
+#include "jcharsimd.h"
+#include "pixelsimd.h"
+
+//////////////////////////////////////////////////////////////////////////
+// portable kernels
+
+static void fillC(Pixel* dst, int32 n, Pixel even, Pixel odd)
+{
+   for (; n >= 2; n -= 2)
+   {
+      *dst++ = even;
+      *dst++ = odd;
+   }
+   if (n > 0)
+      *dst = even;
+}
+
+static void copyOpaqueC(Pixel* dst, Pixel* src, int32 n)
+{
+   while (n-- > 0)
+      *dst++ = *src++ | 0xFF;
+}
+
+static void blendC(Pixel* dst, Pixel* src, int32 n, int32 alphaMask)
+{
+   PixelConv *ps = (PixelConv*)src, *pt = (PixelConv*)dst;
+   for (; n > 0; pt++, ps++, n--)
+   {
+      int32 a = ps->a * alphaMask;
+      a = (a+1 + (a >> 8)) >> 8; // alphaMask * a / 255
+      if (a == 0xFF)
+         pt->pixel = ps->pixel;
+      else
+      if (a != 0)
+      {
+         int32 ma = 0xFF-a;
+         int32 r = (a * ps->r + ma * pt->r);
+         int32 g = (a * ps->g + ma * pt->g);
+         int32 b = (a * ps->b + ma * pt->b);
+         pt->r = (r+1 + (r >> 8)) >> 8; // fast way to divide by 255
+         pt->g = (g+1 + (g >> 8)) >> 8;
+         pt->b = (b+1 + (b >> 8)) >> 8;
+      }
+   }
+}
+
+static void swapBytesC(Pixel* dst, Pixel* src, int32 n)
+{
+   while (n-- > 0)
+   {
+      Pixel p = *src++;
+      *dst++ = (p >> 24) | ((p >> 8) & 0xFF00) | ((p << 8) & 0xFF0000) | (p << 24);
+   }
+}
+
+static TPixelKernels portableKernels = {"portable", fillC, copyOpaqueC, blendC, swapBytesC};
+TPixelKernels pixelKernels = {"portable", fillC, copyOpaqueC, blendC, swapBytesC};
+
+/*
+ The vectorized blends work on 16-bit lanes, one per channel, with the same divisions by 255 of blendC: so
+ a = alpha*alphaMask/255 and c = (a*src + (255-a)*dst)/255 for the 3 colors. This gives src when a is 255 and dst
+ when a is 0, so the vectors need no branches for them. The alpha of dst is kept, except when a is 255: then it's
+ copied from src, so it becomes 255; this is done by using 255 or 0 as the factor of the alpha lane.
+*/
+
+//////////////////////////////////////////////////////////////////////////
+// x86-64: SSE2 is always present; AVX2 is checked at runtime
+#if defined(__x86_64__) || defined(_M_X64)
+#define PIXEL_SIMD_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET(x)
+#else
+#define TARGET(x) __attribute__((target(x)))
+#endif
+
+#define LOAD128(p) _mm_loadu_si128((const __m128i*)(p))
+#define LOAD256(p) _mm256_loadu_si256((const __m256i*)(p))
+#define DIV255_128(x) _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8)
+#define DIV255_256(x) _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), 8)
+
+static void fillSSE2(Pixel* dst, int32 n, Pixel even, Pixel odd)
+{
+   __m128i v = _mm_setr_epi32((int)even, (int)odd, (int)even, (int)odd);
+   for (; n >= 4; n -= 4, dst += 4)
+      _mm_storeu_si128((__m128i*)dst, v);
+   fillC(dst, n, even, odd);
+}
+
+static void copyOpaqueSSE2(Pixel* dst, Pixel* src, int32 n)
+{
+   __m128i alpha = _mm_set1_epi32(0xFF);
+   for (; n >= 4; n -= 4, dst += 4, src += 4)
+      _mm_storeu_si128((__m128i*)dst, _mm_or_si128(LOAD128(src), alpha));
+   copyOpaqueC(dst, src, n);
+}
+
+// blends 2 pixels, one channel per lane
+static __m128i blend2SSE2(__m128i s, __m128i d, __m128i mask, __m128i alphaLanes)
+{
+   __m128i one = _mm_set1_epi16(1), v255 = _mm_set1_epi16(255);
+   __m128i a = _mm_mullo_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0), 0), mask), x;
+   a = DIV255_128(a);
+   a = _mm_or_si128(_mm_andnot_si128(alphaLanes, a), _mm_and_si128(alphaLanes, _mm_and_si128(_mm_cmpeq_epi16(a, v255), v255)));
+   x = _mm_add_epi16(_mm_mullo_epi16(a, s), _mm_mullo_epi16(_mm_sub_epi16(v255, a), d));
+   return DIV255_128(x);
+}
+
+static void blendSSE2(Pixel* dst, Pixel* src, int32 n, int32 alphaMask)
+{
+   __m128i zero = _mm_setzero_si128(), alpha = _mm_set1_epi32(0xFF), mask = _mm_set1_epi16((short)alphaMask);
+   __m128i alphaLanes = _mm_setr_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+   for (; n >= 4; n -= 4, dst += 4, src += 4)
+   {
+      __m128i s = LOAD128(src), sa = _mm_and_si128(s, alpha), d;
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, zero)) == 0xFFFF) // all transparent
+         continue;
+      if (alphaMask == 0xFF && _mm_movemask_epi8(_mm_cmpeq_epi32(sa, alpha)) == 0xFFFF) // all opaque
+         _mm_storeu_si128((__m128i*)dst, s);
+      else
+      {
+         d = LOAD128(dst);
+         _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(blend2SSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), mask, alphaLanes),
+                                                          blend2SSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), mask, alphaLanes)));
+      }
+   }
+   blendC(dst, src, n, alphaMask);
+}
+
+// without pshufb: swaps the bytes of each 16-bit half, then the halves
+static void swapBytesSSE2(Pixel* dst, Pixel* src, int32 n)
+{
+   for (; n >= 4; n -= 4, dst += 4, src += 4)
+   {
+      __m128i v = LOAD128(src);
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128((__m128i*)dst, _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1)));
+   }
+   swapBytesC(dst, src, n);
+}
+
+TARGET("avx2") static void fillAVX2(Pixel* dst, int32 n, Pixel even, Pixel odd)
+{
+   __m256i v = _mm256_setr_epi32((int)even, (int)odd, (int)even, (int)odd, (int)even, (int)odd, (int)even, (int)odd);
+   for (; n >= 8; n -= 8, dst += 8)
+      _mm256_storeu_si256((__m256i*)dst, v);
+   fillSSE2(dst, n, even, odd);
+}
+
+TARGET("avx2") static void copyOpaqueAVX2(Pixel* dst, Pixel* src, int32 n)
+{
+   __m256i alpha = _mm256_set1_epi32(0xFF);
+   for (; n >= 8; n -= 8, dst += 8, src += 8)
+      _mm256_storeu_si256((__m256i*)dst, _mm256_or_si256(LOAD256(src), alpha));
+   copyOpaqueSSE2(dst, src, n);
+}
+
+TARGET("avx2") static __m256i blend4AVX2(__m256i s, __m256i d, __m256i mask, __m256i alphaLanes)
+{
+   __m256i one = _mm256_set1_epi16(1), v255 = _mm256_set1_epi16(255);
+   __m256i a = _mm256_mullo_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0), 0), mask), x;
+   a = DIV255_256(a);
+   a = _mm256_or_si256(_mm256_andnot_si256(alphaLanes, a), _mm256_and_si256(alphaLanes, _mm256_and_si256(_mm256_cmpeq_epi16(a, v255), v255)));
+   x = _mm256_add_epi16(_mm256_mullo_epi16(a, s), _mm256_mullo_epi16(_mm256_sub_epi16(v255, a), d));
+   return DIV255_256(x);
+}
+
+// the unpacks and the pack work inside each 128-bit half, so the pixels stay in order
+TARGET("avx2") static void blendAVX2(Pixel* dst, Pixel* src, int32 n, int32 alphaMask)
+{
+   __m256i zero = _mm256_setzero_si256(), alpha = _mm256_set1_epi32(0xFF), mask = _mm256_set1_epi16((short)alphaMask);
+   __m256i alphaLanes = _mm256_setr_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+   for (; n >= 8; n -= 8, dst += 8, src += 8)
+   {
+      __m256i s = LOAD256(src), sa = _mm256_and_si256(s, alpha), d;
+      if ((uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, zero)) == 0xFFFFFFFF) // all transparent
+         continue;
+      if (alphaMask == 0xFF && (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, alpha)) == 0xFFFFFFFF) // all opaque
+         _mm256_storeu_si256((__m256i*)dst, s);
+      else
+      {
+         d = LOAD256(dst);
+         _mm256_storeu_si256((__m256i*)dst, _mm256_packus_epi16(blend4AVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), mask, alphaLanes),
+                                                                blend4AVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), mask, alphaLanes)));
+      }
+   }
+   blendSSE2(dst, src, n, alphaMask);
+}
+
+TARGET("avx2") static void swapBytesAVX2(Pixel* dst, Pixel* src, int32 n)
+{
+   __m256i order = _mm256_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12, 3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+   for (; n >= 8; n -= 8, dst += 8, src += 8)
+      _mm256_storeu_si256((__m256i*)dst, _mm256_shuffle_epi8(LOAD256(src), order));
+   swapBytesSSE2(dst, src, n);
+}
+
+static TPixelKernels sseKernels  = {"sse2", fillSSE2, copyOpaqueSSE2, blendSSE2, swapBytesSSE2};
+static TPixelKernels avx2Kernels = {"avx2", fillAVX2, copyOpaqueAVX2, blendAVX2, swapBytesAVX2};
+
+//////////////////////////////////////////////////////////////////////////
+// ARM: NEON, when the vm is built with it (always on AArch64)
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(_MSC_VER)
+#define PIXEL_SIMD_NEON
+#include <arm_neon.h>
+
+static bool allBytesAre(uint8x16_t v, uint8 b)
+{
+   uint64x2_t t = vreinterpretq_u64_u8(veorq_u8(v, vdupq_n_u8(b)));
+   return (vgetq_lane_u64(t, 0) | vgetq_lane_u64(t, 1)) == 0;
+}
+
+static void fillNEON(Pixel* dst, int32 n, Pixel even, Pixel odd)
+{
+   uint32 pair[4] = {even, odd, even, odd};
+   uint32x4_t v = vld1q_u32(pair);
+   for (; n >= 4; n -= 4, dst += 4)
+      vst1q_u32(dst, v);
+   fillC(dst, n, even, odd);
+}
+
+static void copyOpaqueNEON(Pixel* dst, Pixel* src, int32 n)
+{
+   uint32x4_t alpha = vdupq_n_u32(0xFF);
+   for (; n >= 4; n -= 4, dst += 4, src += 4)
+      vst1q_u32(dst, vorrq_u32(vld1q_u32(src), alpha));
+   copyOpaqueC(dst, src, n);
+}
+
+#define DIV255_NEON(x) vshrn_n_u16(vsraq_n_u16(vaddq_u16(x, one), x, 8), 8)
+
+static uint8x16_t blendChannelNEON(uint8x16_t s, uint8x16_t d, uint8x16_t a, uint8x16_t ma)
+{
+   uint16x8_t one = vdupq_n_u16(1);
+   uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), vget_low_u8(s)), vget_low_u8(ma), vget_low_u8(d));
+   uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), vget_high_u8(s)), vget_high_u8(ma), vget_high_u8(d));
+   return vcombine_u8(DIV255_NEON(lo), DIV255_NEON(hi));
+}
+
+// vld4 splits 16 pixels in one vector per channel: val[0] has the alphas
+static void blendNEON(Pixel* dst, Pixel* src, int32 n, int32 alphaMask)
+{
+   uint8x8_t mask = vdup_n_u8((uint8)alphaMask);
+   uint16x8_t one = vdupq_n_u16(1);
+   for (; n >= 16; n -= 16, dst += 16, src += 16)
+   {
+      uint8x16x4_t s = vld4q_u8((uint8*)src), d;
+      uint16x8_t lo, hi;
+      uint8x16_t a, ma;
+      if (allBytesAre(s.val[0], 0)) // all transparent
+         continue;
+      if (alphaMask == 0xFF && allBytesAre(s.val[0], 0xFF)) // all opaque
+      {
+         vst4q_u8((uint8*)dst, s);
+         continue;
+      }
+      d = vld4q_u8((uint8*)dst);
+      lo = vmull_u8(vget_low_u8(s.val[0]), mask);
+      hi = vmull_u8(vget_high_u8(s.val[0]), mask);
+      a = vcombine_u8(DIV255_NEON(lo), DIV255_NEON(hi));
+      ma = vmvnq_u8(a); // 255-a
+      d.val[1] = blendChannelNEON(s.val[1], d.val[1], a, ma);
+      d.val[2] = blendChannelNEON(s.val[2], d.val[2], a, ma);
+      d.val[3] = blendChannelNEON(s.val[3], d.val[3], a, ma);
+      d.val[0] = vorrq_u8(d.val[0], vceqq_u8(a, vdupq_n_u8(0xFF)));
+      vst4q_u8((uint8*)dst, d);
+   }
+   blendC(dst, src, n, alphaMask);
+}
+
+static void swapBytesNEON(Pixel* dst, Pixel* src, int32 n)
+{
+   for (; n >= 4; n -= 4, dst += 4, src += 4)
+      vst1q_u32(dst, vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(src)))));
+   swapBytesC(dst, src, n);
+}
+
+static TPixelKernels neonKernels = {"neon", fillNEON, copyOpaqueNEON, blendNEON, swapBytesNEON};
+#endif
+
+void initPixelKernels(bool simd)
+{
+   pixelKernels = portableKernels;
+   if (!simd)
+      return;
+#if defined(PIXEL_SIMD_X86)
+   {
+      bool sse42, avx2;
+      cpuFeatures(&sse42, &avx2);
+      pixelKernels = avx2 ? avx2Kernels : sseKernels;
+   }
+#elif defined(PIXEL_SIMD_NEON)
+   pixelKernels = neonKernels;
+#endif
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "pixelsimd_test.h"
+#endif
@@ -0,0 +1,39 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifndef PIXELSIMD_H
+#define PIXELSIMD_H
+
+/*
+ Vectorized kernels for the loops of the software renderer (GraphicsPrimitives_c.h) and for the conversion of the
+ images given to Skia. initPixelKernels selects, at runtime, AVX2 or SSE2 on x86-64, NEON on ARM when the vm is built
+ with it, and portable C everywhere else. The pixels are in the PixelConv layout (a in the low byte, then b, g, r);
+ the kernels handle any count, and give exactly the same results as the portable ones.
+*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct
+{
+   char* name;
+   void (*fill)(Pixel* dst, int32 n, Pixel even, Pixel odd);      // dst[i] = odd if i is odd, even otherwise
+   void (*copyOpaque)(Pixel* dst, Pixel* src, int32 n);           // dst[i] = src[i] with alpha 0xFF
+   void (*blend)(Pixel* dst, Pixel* src, int32 n, int32 alphaMask); // src over dst, with the alpha of src multiplied by alphaMask/255
+   void (*swapBytes)(Pixel* dst, Pixel* src, int32 n);            // reverses the bytes of each pixel; dst may be src
+} TPixelKernels;
+
+extern TPixelKernels pixelKernels;
+
+/// Selects the kernels for the running processor, or the portable ones if simd is false (used by the benchmarks)
+void initPixelKernels(bool simd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+// The vectorized kernels must give exactly the pixels of the portable ones. Each test runs every set that the
+// processor supports, with counts that leave tails of 1 to 7 pixels after the vectors and with unaligned starts.
+
+#define KERNEL_PIXELS 40 // 5 AVX2 vectors
+
+static int32 simdPixelKernels(TPixelKernels* sets) // the vectorized sets that can run here
+{
+   int32 n = 0;
+#if defined(PIXEL_SIMD_X86)
+   bool sse42, avx2;
+   cpuFeatures(&sse42, &avx2);
+   sets[n++] = sseKernels;
+   if (avx2)
+      sets[n++] = avx2Kernels;
+#elif defined(PIXEL_SIMD_NEON)
+   sets[n++] = neonKernels;
+#endif
+   UNUSED(sets);
+   return n;
+}
+
+static void fillPixels(Pixel* p, int32 n, uint32 seed)
+{
+   while (n-- > 0)
+   {
+      seed = seed * 1103515245 + 12345;
+      *p++ = seed ^ (seed >> 13);
+   }
+}
+
+TESTCASE(PixelKernels_fillCopy)
+{
+   TPixelKernels sets[2];
+   Pixel src[KERNEL_PIXELS+8], expected[KERNEL_PIXELS+8], got[KERNEL_PIXELS+8];
+   int32 k, count = simdPixelKernels(sets), off, n;
+   if (count == 0)
+      TEST_SKIP;
+   fillPixels(src, KERNEL_PIXELS+8, 1);
+   for (k = 0; k < count; k++)
+      for (off = 0; off < 8; off++)
+         for (n = 0; n <= KERNEL_PIXELS; n++)
+         {
+            xmemset(expected, 0xAB, sizeof(expected));
+            xmemset(got, 0xAB, sizeof(got));
+            fillC(expected + off, n, 0x11223344, 0x55667788);
+            sets[k].fill(got + off, n, 0x11223344, 0x55667788);
+            ASSERT3_EQUALS(Block, expected, got, sizeof(got)); // also checks that nothing is written outside
+            copyOpaqueC(expected + off, src + (7 - off), n);
+            sets[k].copyOpaque(got + off, src + (7 - off), n);
+            ASSERT3_EQUALS(Block, expected, got, sizeof(got));
+            swapBytesC(expected + off, src + (7 - off), n);
+            sets[k].swapBytes(got + off, src + (7 - off), n);
+            ASSERT3_EQUALS(Block, expected, got, sizeof(got));
+            sets[k].swapBytes(got + off, got + off, n); // dst may be src
+            swapBytesC(expected + off, expected + off, n);
+            ASSERT3_EQUALS(Block, expected, got, sizeof(got));
+         }
+finish: ;
+   UNUSED(currentContext);
+}
+
+TESTCASE(PixelKernels_blend)
+{
+   static int32 masks[] = {0, 1, 127, 128, 254, 255};
+   TPixelKernels sets[2];
+   Pixel src[KERNEL_PIXELS+8], dst[KERNEL_PIXELS+8], expected[KERNEL_PIXELS+8], got[KERNEL_PIXELS+8];
+   int32 k, count = simdPixelKernels(sets), off, n, m, i, kind;
+   if (count == 0)
+      TEST_SKIP;
+   fillPixels(dst, KERNEL_PIXELS+8, 2);
+   for (kind = 0; kind < 4; kind++) // random alphas, all transparent, all opaque, then opaque with some holes
+   {
+      fillPixels(src, KERNEL_PIXELS+8, 3 + kind);
+      for (i = 0; i < KERNEL_PIXELS+8; i++)
+         switch (kind)
+         {
+            case 0: if (i % 5 == 0) src[i] &= ~0xFF; else if (i % 5 == 1) src[i] |= 0xFF; break; // a in the low byte
+            case 1: src[i] &= ~0xFF; break;
+            case 2: src[i] |= 0xFF; break;
+            case 3: if (i % 9 == 4) src[i] = (src[i] & ~0xFF) | 0x80; else src[i] |= 0xFF; break;
+         }
+      for (k = 0; k < count; k++)
+         for (m = 0; m < (int32)(sizeof(masks) / sizeof(int32)); m++)
+            for (off = 0; off < 8; off++)
+               for (n = 0; n <= KERNEL_PIXELS; n++)
+               {
+                  xmemmove(expected, dst, sizeof(dst));
+                  xmemmove(got, dst, sizeof(dst));
+                  blendC(expected + off, src + (7 - off), n, masks[m]);
+                  sets[k].blend(got + off, src + (7 - off), n, masks[m]);
+                  ASSERT3_EQUALS(Block, expected, got, sizeof(got));
+               }
+   }
+finish: ;
+   UNUSED(currentContext);
+}
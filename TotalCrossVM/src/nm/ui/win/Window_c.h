@@ -187,6 +187,6 @@ static void windowSetSIP(int32 sipOption, bool numeric)
 static void windowSetDeviceTitle(TCObject titleObj)
 {
    TCHAR buf[30];
-   JCharP2TCHARPBuf(String_charsStart(titleObj), min32(String_charsLen(titleObj),29), buf); // guich@tc113_32: limit to buf's size (and reduced to 30 chars)
+   String2TCHARPBufLen(titleObj, min32(String_charsLen(titleObj),29), buf); // guich@tc113_32: limit to buf's size (and reduced to 30 chars)
    SetWindowText(mainHWnd, buf);
 }
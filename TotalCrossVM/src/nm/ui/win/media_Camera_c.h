@@ -54,7 +54,7 @@ HRESULT SHCameraCapture(PSHCAMERACAPTURE pshcc, bool useThread)
 
 static TCHAR* getString(TCHAR* buf, TCObject str)
 {
-   return str ? JCharP2TCHARPBuf(String_charsStart(str), String_charsLen(str), buf) : null;
+   return str ? String2TCHARPBuf(str, buf) : null;
 }
 
 /*[HKEY_LOCAL_MACHINE\Software\Microsoft\Pictures\Camera\OEM\PictureResolution] 
@@ -220,9 +220,11 @@ int nativeUpdateLocationCPP(Context context, TCObject gpsObject)
 
    messageReceived = cs->getMessageReceived();
    setObjectLock(GPS_messageReceived(gpsObject) = createStringObjectFromJCharP(context, (JCharP)messageReceived->Data(), messageReceived->Length()), UNLOCKED);
+   WRITE_BARRIER(gpsObject, GPS_messageReceived(gpsObject));
 
    lowSignalReason = cs->getLowSignalReason();
    setObjectLock(GPS_lowSignalReason(gpsObject) = createStringObjectFromJCharP(context, (JCharP)lowSignalReason->Data(), lowSignalReason->Length()), UNLOCKED);
+   WRITE_BARRIER(gpsObject, GPS_lowSignalReason(gpsObject));
 
    GPS_pdop(gpsObject) = cs->getPdop();
 
@@ -13,6 +13,7 @@ TC_API void tucL_create(NMParams p) // totalcross/util/concurrent/Lock native vo
    TCObject obj = p->obj[0];
    TCObject mutexObj;
    mutexObj = Lock_mutex(obj) = createByteArray(p->currentContext, sizeof(MUTEX_TYPE));
+   WRITE_BARRIER(obj, mutexObj);
    if (mutexObj != null)
    {
       MUTEX_TYPE *mo = (MUTEX_TYPE *)ARRAYOBJ_START(mutexObj);
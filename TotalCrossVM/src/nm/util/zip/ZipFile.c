@@ -70,6 +70,7 @@ TC_API void tuzZF_createZipFile_f(NMParams p) // totalcross/util/zip/ZipFile nat
             if (err == UNZ_OK)
             {
                ZipFile_nativeFile(zipFile) = zipNativeObj;
+               WRITE_BARRIER(zipFile, zipNativeObj);
                ZipFile_size(zipFile) = (int32)unzGlobalInfo.number_entry;
                setObjectLock(zipNativeObj, UNLOCKED);
 
@@ -147,9 +148,13 @@ TC_API void tuzZF_entries(NMParams p) // totalcross/util/zip/ZipFile native publ
             *start = createObject(p->currentContext, "totalcross.util.zip.ZipEntry");
 
             ZipEntry_name(*start) = name;
+            WRITE_BARRIER(*start, name);
             setObjectLock(name, UNLOCKED);
             if (*start)
+            {
+               WRITE_BARRIER(arrayObj, *start);
                setObjectLock(*start, UNLOCKED);
+            }
             else
                break;
          }
@@ -212,6 +217,7 @@ TC_API void tuzZS_createInflate_s(NMParams p) // totalcross/util/zip/ZipStream n
          if ((zipNativeP->zipFile = unzOpen2((char*) streamObj, &zipNativeP->zlib_def)) == null)
             throwException(p->currentContext, IOException, "Failed to start the zip file");
          *ZipStream_nativeZip(zipStream) = zipNativeObj;
+         WRITE_BARRIER(zipStream, zipNativeObj);
          p->retO = streamObj;
       }
       setObjectLock(zipNativeObj, UNLOCKED);
@@ -242,6 +248,7 @@ TC_API void tuzZS_createDeflate_si(NMParams p) // totalcross/util/zip/ZipStream
          if ((zipNativeP->zipFile = zipOpen2((char*) streamObj, APPEND_STATUS_CREATE, null, &zipNativeP->zlib_def)) == null)
             throwException(p->currentContext, IOException, "Failed to start the zip file");
          *ZipStream_nativeZip(zipStream) = zipNativeObj;
+         WRITE_BARRIER(zipStream, zipNativeObj);
          p->retO = streamObj;
       }
       setObjectLock(zipNativeObj, UNLOCKED);
@@ -313,10 +320,13 @@ TC_API void tuzZS_getNextEntry(NMParams p) // totalcross/util/zip/ZipStream nati
       {
          zipNativeP->isFirstFile = false;
          ZipEntry_name(zipEntryObj) = zipEntryNameObj;
+         WRITE_BARRIER(zipEntryObj, zipEntryNameObj);
          ZipEntry_time(zipEntryObj) = (int32)file_info.dosDate;
          ZipEntry_method(zipEntryObj) = (int32)file_info.compression_method;
          ZipEntry_comment(zipEntryObj) = zipEntryCommentObj;
          ZipEntry_extra(zipEntryObj) = zipEntryExtraObj;
+         WRITE_BARRIER(zipEntryObj, zipEntryCommentObj);
+         WRITE_BARRIER(zipEntryObj, zipEntryExtraObj);
          ZipEntry_crc(zipEntryObj) = (int64)file_info.crc;
          ZipEntry_size(zipEntryObj) = (int64)file_info.uncompressed_size;
          ZipEntry_csize(zipEntryObj) = (int64)file_info.compressed_size;
@@ -435,6 +445,7 @@ TC_API void tuzZS_putNextEntry_z(NMParams p) // totalcross/util/zip/ZipStream na
    {
       zipNativeP->method = method;
       *ZipStream_lastEntry(zipStream) = zipEntryObj;
+      WRITE_BARRIER(zipStream, zipEntryObj);
    }
    xfree(zipEntryCommentP);
 }
@@ -313,6 +313,7 @@ TC_API void txXT_nativeCreate(NMParams p) // totalcross/xml/XmlTokenizer native
       initialize();
    if ((XmlTokenizer_bag(xml) = createByteArray(p->currentContext, sizeof(TBoundMethods))) != null)
    {
+      WRITE_BARRIER(xml, XmlTokenizer_bag(xml));
       TCClass c = OBJ_CLASS(xml);
       BoundMethods b = getBoundMethods(xml);
       b->foundStartTagName = getMethod(c, true, "foundStartTagName", 3, BYTE_ARRAY, J_INT, J_INT);
@@ -361,6 +362,7 @@ TC_API void txXT_setCdataContents_Bii(NMParams p) // totalcross/xml/XmlTokenizer
 
    if ((XmlTokenizer_endTagToSkipTo(xml) = createByteArray(p->currentContext, count)) != null)
    {
+      WRITE_BARRIER(xml, XmlTokenizer_endTagToSkipTo(xml));
       input = (uint8*) ARRAYOBJ_START(inputObj);
       endTagToSkip = (uint8*) ARRAYOBJ_START(XmlTokenizer_endTagToSkipTo(xml));
       for (input += offset; count-- > 0; input++)
@@ -156,6 +156,7 @@ void pngLoad(Context currentContext, TCObject imageObj, TCObject inputStreamObj,
    if (info_ptr->text && strEq("Comment",info_ptr->text->key))
    {
       Image_comment(imageObj) = createStringObjectFromCharP(currentContext, info_ptr->text->text, (int)info_ptr->text->text_length);
+      WRITE_BARRIER(imageObj, Image_comment(imageObj));
       setObjectLock(Image_comment(imageObj), UNLOCKED);
    }
 
@@ -247,6 +248,7 @@ static void info_callback(png_structp png_ptr, png_infop info_ptr)
    Image_pixels(userData->imageObj) = userData->pixelsObj = createIntArray(userData->currentContext, (int32)(width*height));
    if (!userData->pixelsObj)
       HEAP_ERROR(userData->heap, 997);
+   WRITE_BARRIER(userData->imageObj, userData->pixelsObj);
    setObjectLock(Image_pixels(userData->imageObj), UNLOCKED);
    userData->pixels = (Pixel*)ARRAYOBJ_START(userData->pixelsObj);
 }
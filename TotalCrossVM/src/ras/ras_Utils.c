@@ -164,7 +164,7 @@ static int32 getDeviceHash(Context currentContext, CharP* deviceHash)
    if (currentContext->thrownException != null)
       return GDHERR_EXCEPTION;
 
-   *deviceHash = JCharP2CharP(String_charsStart(res), String_charsLen(res));
+   *deviceHash = String2CharP(res);
    return NO_ERROR;
 }
 
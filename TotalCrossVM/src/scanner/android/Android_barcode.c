@@ -102,8 +102,8 @@ TC_API void tidsS_setParam_ss(NMParams p) // totalcross/io/device/scanner/Scanne
    {
       JNIEnv* env = getJNIEnv();
       jclass applicationClass = androidFindClass(env, "totalcross/android/Scanner4A");
-      jstring jwhat  = (*env)->NewString(env, (jchar*) String_charsStart(owhat),  String_charsLen(owhat));
-      jstring jvalue = (*env)->NewString(env, (jchar*) String_charsStart(ovalue), String_charsLen(ovalue));
+      jstring jwhat  = String2jstring(env, owhat);
+      jstring jvalue = String2jstring(env, ovalue);
       if (jsetParam == null)
          jsetParam = (*env)->GetStaticMethodID(env, applicationClass, "setParam", "(Ljava/lang/String;Ljava/lang/String;)V");
       p->retI = (*env)->CallStaticBooleanMethod(env, applicationClass, jsetParam, jwhat, jvalue);
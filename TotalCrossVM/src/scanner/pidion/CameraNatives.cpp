@@ -70,16 +70,12 @@ void CameraLibClose()
 
 static TCHAR* getString(TCHAR* buf, TCObject str)
 {
-   JCharP c;
-   int32 len;
-   TCHAR* s = buf;
+   TCHAR* s;
    if (!str)
       return NULL;
-   c = String_charsStart(str);
-   len = String_charsLen(str);
-   for (; --len >= 0; c++)
-      *s++ = *c == '/' ? '\\' : *c;
-   *s = 0;
+   for (s = String2TCHARPBuf(str, buf); *s; s++)
+      if (*s == '/')
+         *s = '\\';
    return buf;
 }
 
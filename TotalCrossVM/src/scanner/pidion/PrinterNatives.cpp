@@ -95,16 +95,12 @@ void PrinterLibClose()
 
 static TCHAR* getString(TCHAR* buf, TCObject str)
 {
-   JCharP c;
-   int32 len;
-   TCHAR* s = buf;
+   TCHAR* s;
    if (!str)
       return NULL;
-   c = String_charsStart(str);
-   len = String_charsLen(str);
-   for (; --len >= 0; c++)
-      *s++ = *c == '/' ? '\\' : *c;
-   *s = 0;
+   for (s = String2TCHARPBuf(str, buf); *s; s++)
+      if (*s == '/')
+         *s = '\\';
    return buf;
 }
 
@@ -175,7 +171,6 @@ TCHAR buff[1024];
 SCAN_API void pP_print_si(NMParams p) // pidion/Printer native public static void print(String text, int options) throws PrinterException;
 {
    TCObject text = p->obj[0];
-   JCharP start = String_charsStart(text);
    int32 len = String_charsLen(text);
    TCHARP temp = buff;
 
@@ -186,8 +181,7 @@ SCAN_API void pP_print_si(NMParams p) // pidion/Printer native public static voi
          return;
    }
 
-   xmemmove(temp, start, len*2);
-   temp[len] = 0;
+   String2TCHARPBufLen(text, len, temp);
 
    if (!openPrinter()) return;
    check(p->currentContext,_BBPrinterPrint(handle, temp, p->i32[0]));
@@ -199,7 +193,6 @@ SCAN_API void pP_print_si(NMParams p) // pidion/Printer native public static voi
 SCAN_API void pP_printBarcode_siiii(NMParams p) // pidion/Printer native public static void printBarcode(String data, int width, int height, int type, int align) throws PrinterException;
 {
    TCObject text = p->obj[0];
-   JCharP start = String_charsStart(text);
    int32 len = String_charsLen(text);
    TCHARP temp = buff;
 
@@ -210,8 +203,7 @@ SCAN_API void pP_printBarcode_siiii(NMParams p) // pidion/Printer native public
          return;
    }
 
-   xmemmove(temp, start, len*2);
-   temp[len] = 0;
+   String2TCHARPBufLen(text, len, temp);
 
    if (!openPrinter()) return;
    check(p->currentContext,_BBPrinterPrintBarcode(handle, temp, p->i32[1], p->i32[0], p->i32[2], p->i32[3])); // width and height are inverted in the api call
@@ -816,13 +816,13 @@ SYNC_API void tisC_log_s(NMParams p) // totalcross/io/sync/Conduit native static
       if (syncTarget == TARGETING_PALMDESKTOP)
       {
          TCHAR szText[256];
-         JCharP2TCHARPBuf(String_charsStart(text), String_charsLen(text), szText);
+         String2TCHARPBufLen(text, String_charsLen(text), szText);
          procLogAddEntry(szText, slText, false);
       }
       else // syncTarget == TARGETING_ACTIVESYNC
       {
          char szText[256];
-         JCharP2CharPBuf(String_charsStart(text), String_charsLen(text), szText);
+         String2CharPBufLen(text, String_charsLen(text), szText);
          debug(szText);
       }
    }
@@ -854,8 +854,8 @@ SYNC_API void tisC_register_i(NMParams p) // totalcross/io/sync/Conduit native b
    {
       TCHAR szConduitNameT[MAX_PATH];
       char szCreatorA[5];
-      JCharP2TCHARPBuf(String_charsStart(conduitName), String_charsLen(conduitName), szConduitNameT);
-      JCharP2CharPBuf(String_charsStart(targetApplicationId), String_charsLen(targetApplicationId), szCreatorA);
+      String2TCHARPBufLen(conduitName, String_charsLen(conduitName), szConduitNameT);
+      String2CharPBufLen(targetApplicationId, String_charsLen(targetApplicationId), szCreatorA);
 
       ok = setEnviromentVariable(HKEY_LOCAL_MACHINE, "System\\CurrentControlSet\\Control\\Session Manager\\Environment");
       if (!ok)
@@ -891,8 +891,8 @@ SYNC_API void tisC_register_i(NMParams p) // totalcross/io/sync/Conduit native b
       char shortcutPath[MAX_PATHNAME], appPath[MAX_PATHNAME];
       char szConduitNameA[MAX_PATH];
       TCHAR szCreatorT[5];
-      JCharP2CharPBuf(String_charsStart(conduitName), String_charsLen(conduitName), szConduitNameA);
-      JCharP2TCHARPBuf(String_charsStart(targetApplicationId), String_charsLen(targetApplicationId), szCreatorT);
+      String2CharPBufLen(conduitName, String_charsLen(conduitName), szConduitNameA);
+      String2TCHARPBufLen(targetApplicationId, String_charsLen(targetApplicationId), szCreatorT);
 
       xstrprintf(shortcutPath, "%s/Run%s.lnk", appPathP, szConduitNameA);
       xstrprintf(appPath, "%s/%s.exe", appPathP, szConduitNameA);
@@ -918,7 +918,7 @@ SYNC_API void tisC_unregister(NMParams p) // totalcross/io/sync/Conduit native b
       if (loadHotSyncCfgLibraries())
       {
          char szCreatorA[5];
-         JCharP2CharPBuf(String_charsStart(targetApplicationId), String_charsLen(targetApplicationId), szCreatorA);
+         String2CharPBufLen(targetApplicationId, String_charsLen(targetApplicationId), szCreatorA);
          ret = procCmRemoveConduitByCreatorID(szCreatorA);
          procHsRefreshConduitInfo(); // just refresh, no restart is needed.
          unloadHotSyncCfgLibraries();
@@ -928,7 +928,7 @@ SYNC_API void tisC_unregister(NMParams p) // totalcross/io/sync/Conduit native b
    if (syncTarget & TARGETING_ACTIVESYNC)
    {
       TCHAR szCreatorT[5];
-      JCharP2TCHARPBuf(String_charsStart(targetApplicationId), String_charsLen(targetApplicationId), szCreatorT);
+      String2TCHARPBufLen(targetApplicationId, String_charsLen(targetApplicationId), szCreatorT);
       ret = (ret == 0) ? ret : deleteRegistry(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows CE Services\\AutoStartOnConnect", szCreatorT);
    }
 
@@ -950,7 +950,7 @@ SYNC_API void tisC_initSync(NMParams p) // totalcross/io/sync/Conduit native pri
    int32 targetAppPathLen = String_charsLen(targetAppPath);
    TRACE("tisC_initSync");
 
-   xmemmove(remoteAppPath, String_charsStart(targetAppPath), targetAppPathLen*sizeof(WCHAR));
+   String2JCharPBufLen(targetAppPath, targetAppPathLen, (JCharP)remoteAppPath);
    *(remoteAppPath + targetAppPathLen) = 0;
 
    conduitHandleObject = createByteArray(p->currentContext, sizeof(CONDHANDLE));
@@ -1007,6 +1007,8 @@ SYNC_API void tisC_initSync(NMParams p) // totalcross/io/sync/Conduit native pri
    ret = *conduitHandle != 0;
    *Conduit_conduitHandle(conduit) = conduitHandleObject;
    *Conduit_targetAppPath(conduit) = createStringObjectFromJCharP(p->currentContext, (JCharP) remoteAppPath, -1);
+   WRITE_BARRIER(conduit, conduitHandleObject);
+   WRITE_BARRIER(conduit, *Conduit_targetAppPath(conduit));
 
    p->retI = ret;
 }
@@ -1019,7 +1021,7 @@ SYNC_API void tisRPDBF_create(NMParams p) // totalcross/io/sync/RemotePDBFile na
    WCHAR remoteAppPath[MAX_PATH];
    int32 targetAppPathLen = String_charsLen(targetAppPath);
    TRACE("tisRPDBF_create");
-   xmemmove(remoteAppPath, String_charsStart(targetAppPath), targetAppPathLen*sizeof(WCHAR));
+   String2JCharPBufLen(targetAppPath, targetAppPathLen, (JCharP)remoteAppPath);
    *(remoteAppPath + targetAppPathLen) = 0;
 
    TCObject pdbFile = p->obj[0];
@@ -1029,8 +1031,8 @@ SYNC_API void tisRPDBF_create(NMParams p) // totalcross/io/sync/RemotePDBFile na
    int32 pdbNameLen = String_charsLen(pdbName);
    char szPdbNameA[42];
    TCHAR szPdbNameT[42];
-   JCharP2CharPBuf(String_charsStart(pdbName), pdbNameLen, szPdbNameA);
-   JCharP2TCHARPBuf(String_charsStart(pdbName), pdbNameLen, szPdbNameT);
+   String2CharPBufLen(pdbName, pdbNameLen, szPdbNameA);
+   String2TCHARPBufLen(pdbName, pdbNameLen, szPdbNameT);
    uint32 creator = ggetUInt32((uint8*) &szPdbNameA[pdbNameLen - 9]);
    uint32 type = ggetUInt32((uint8*) &szPdbNameA[pdbNameLen - 4]);
 
@@ -1042,6 +1044,7 @@ SYNC_API void tisRPDBF_create(NMParams p) // totalcross/io/sync/RemotePDBFile na
    if (!pdbHandleObject)
       return;
    RemotePDBFile_pdbHandle(pdbFile) = pdbHandleObject;
+   WRITE_BARRIER(pdbFile, pdbHandleObject);
    uint8* pdbHandle = ARRAYOBJ_START(pdbHandleObject);
 
    // if create, try to create it; if it already exists, open in read_write mode.
@@ -1210,7 +1213,7 @@ SYNC_API void tisRPDBF_delete(NMParams p) // totalcross/io/sync/RemotePDBFile na
                TCObject pdbName = RemotePDBFile_name(remotePDB);
                char szPdbName[42];
                char* dot;
-               JCharP2CharPBuf(String_charsStart(pdbName), String_charsLen(pdbName), szPdbName);
+               String2CharPBufLen(pdbName, String_charsLen(pdbName), szPdbName);
                dot = strchr(szPdbName, '.');
                if (dot) *dot = 0; // cut off the creator and type.
                procSyncDeleteDB(szPdbName, 0);
@@ -1466,7 +1469,7 @@ SYNC_API void tisRPDBF_listPDBs_ii(NMParams p) // totalcross/io/sync/RemotePDBFi
    WCHAR remoteAppPath[MAX_PATH];
    int32 targetAppPathLen = String_charsLen(targetAppPath);
    TRACE("tisRPDBF_listPDBs_ii");
-   xmemmove(remoteAppPath, String_charsStart(targetAppPath), targetAppPathLen*sizeof(WCHAR));
+   String2JCharPBufLen(targetAppPath, targetAppPathLen, (JCharP)remoteAppPath);
    *(remoteAppPath + targetAppPathLen) = 0;
 
    int32 crtr = p->i32[0];
@@ -1539,7 +1542,9 @@ SYNC_API void tisRPDBF_listPDBs_ii(NMParams p) // totalcross/io/sync/RemotePDBFi
             while (stringsCount-- > 0)
             {
                int32 len = (int32) xstrlen(stringsP);
-               *strings++ = createStringObjectFromCharP(p->currentContext, stringsP, len);
+               *strings = createStringObjectFromCharP(p->currentContext, stringsP, len);
+               WRITE_BARRIER(stringArray, *strings);
+               strings++;
                stringsP += len + 1;
             }
             setObjectLock(p->retO, UNLOCKED);
@@ -1565,7 +1570,7 @@ SYNC_API void tisRF_listFiles_s(NMParams p) // totalcross/io/sync/RemoteFile nat
    {
       dirLen = String_charsLen(dir);
       char szDirA[MAX_PATH];
-      JCharP2CharPBuf(String_charsStart(dir), dirLen, szDirA);
+      String2CharPBufLen(dir, dirLen, szDirA);
       replaceSlashes(szDirA);
       uint32 stringsCount;
 
@@ -1585,7 +1590,9 @@ SYNC_API void tisRF_listFiles_s(NMParams p) // totalcross/io/sync/RemoteFile nat
             while (stringsCount-- > 0)
             {
                int32 stringLen = (int32) xstrlen(string);
-               *strings++ = createStringObjectFromCharP(p->currentContext, string, stringLen);
+               *strings = createStringObjectFromCharP(p->currentContext, string, stringLen);
+               WRITE_BARRIER(stringArray, *strings);
+               strings++;
                string += stringLen + 1;
             }
             setObjectLock(p->retO, UNLOCKED);
@@ -1618,7 +1625,9 @@ SYNC_API void tisRF_listFiles_s(NMParams p) // totalcross/io/sync/RemoteFile nat
                   JCharP2TCHARPBuf((JCharP) fd[i].cFileName, lstrlenW(fd[i].cFileName), fileName);
                   if (fd[i].dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
                      tcscat(fileName, "/");
-                  *strings++ = createStringObjectFromTCHAR(p->currentContext, fileName, -1);
+                  *strings = createStringObjectFromTCHAR(p->currentContext, fileName, -1);
+                  WRITE_BARRIER(stringArray, *strings);
+                  strings++;
                }
                setObjectLock(p->retO, UNLOCKED);
             }
@@ -1651,8 +1660,8 @@ SYNC_API void tisRF_copyToRemote_ss(NMParams p) // totalcross/io/sync/RemoteFile
    {
       srcFileLen = String_charsLen(srcFile);
       dstFileLen = String_charsLen(dstFile);
-      JCharP2CharPBuf(String_charsStart(srcFile), srcFileLen, szSrcFile);
-      JCharP2CharPBuf(String_charsStart(dstFile), dstFileLen, szDstFile);
+      String2CharPBufLen(srcFile, srcFileLen, szSrcFile);
+      String2CharPBufLen(dstFile, dstFileLen, szDstFile);
       replaceSlashes(szSrcFile);
       replaceSlashes(szDstFile);
 
@@ -1789,8 +1798,8 @@ SYNC_API void tisRF_copyFromRemote_ss(NMParams p) // totalcross/io/sync/RemoteFi
       // Convert and normalize arguments
       srcFileLen = String_charsLen(srcFile);
       dstFileLen = String_charsLen(dstFile);
-      JCharP2CharPBuf(String_charsStart(srcFile), srcFileLen, szSrcFile);
-      JCharP2CharPBuf(String_charsStart(dstFile), dstFileLen, szDstFile);
+      String2CharPBufLen(srcFile, srcFileLen, szSrcFile);
+      String2CharPBufLen(dstFile, dstFileLen, szDstFile);
       replaceSlashes(szSrcFile);
       replaceSlashes(szDstFile);
 
@@ -1908,7 +1917,7 @@ SYNC_API void tisRF_delete_s(NMParams p) // totalcross/io/sync/RemoteFile native
    else
    {
       fileOrFolderLen = String_charsLen(fileOrFolder);
-      JCharP2CharPBuf(String_charsStart(fileOrFolder), fileOrFolderLen, szFileOrFolderA);
+      String2CharPBufLen(fileOrFolder, fileOrFolderLen, szFileOrFolderA);
       replaceSlashes(szFileOrFolderA);
 
       if (syncTarget == TARGETING_PALMDESKTOP)
@@ -1959,10 +1968,10 @@ SYNC_API void tisRF_exec_ssib(NMParams p) // totalcross/io/sync/RemoteFile nativ
    Err createProcessRet;
 
    xmemzero(applicationName, sizeof(applicationName));
-   xmemmove(applicationName, String_charsStart(command), String_charsLen(command) * sizeof(WCHAR));
+   String2JCharPBufLen(command, String_charsLen(command), (JCharP)applicationName);
 
    xmemzero(commandLine, sizeof(commandLine));
-   xmemmove(commandLine, String_charsStart(args), String_charsLen(args) * sizeof(WCHAR));
+   String2JCharPBufLen(args, String_charsLen(args), (JCharP)commandLine);
 
    initRet = procCeRapiInit();
    if (initRet == NO_ERROR || initRet == CERAPI_E_ALREADYINITIALIZED)
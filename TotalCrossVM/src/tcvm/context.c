@@ -31,6 +31,7 @@ void destroyContexts()
 Context newContext(ThreadHandle thread, TCObject threadObj, bool bigContextSizes)
 {
    volatile Heap heap;
+   static int32 slotGenerations[MAX_CONTEXTS];
    Context c;
    int32 i;
    int32 regIsize, regOsize, reg64size, stackSize;
@@ -58,6 +59,7 @@ Context newContext(ThreadHandle thread, TCObject threadObj, bool bigContextSizes
       if (contexts[i] == null)
       {
          contexts[i] = c;
+         c->id = (i+1) | ((++slotGenerations[i] & 0x1FF) << 7); // 16 bits: the monitor owner field
          break;
       }
    UNLOCKVAR(omm);
@@ -79,9 +81,12 @@ Context newContext(ThreadHandle thread, TCObject threadObj, bool bigContextSizes
    c->callStack    = c->callStackStart = newPtrArrayOf(VoidP, stackSize, c->heap);
    c->callStackEnd = c->callStackStart + stackSize;
    c->thread = thread;
+   c->profilerTick = profilerTick;
+   c->gcEpoch = gcEpoch;
    c->nmp.currentContext = c;
    SETUP_MUTEX;
    INIT_MUTEX(c->usageLock);
+   threadPermitInit(&c->permit);
       
    if (mainContext != null && c != null) // for the first context, it will be created later
       c->OutOfMemoryErrorObj = createObject(c, "java.lang.OutOfMemoryError"); // create the exception and prevent the exception from being collected. Note that there's no need to lock the msg and trace strings inside of it.
@@ -102,8 +107,11 @@ void deleteContext(Context c, bool destroyThread)
       }
    if (c->OutOfMemoryErrorObj != null) setObjectLock(c->OutOfMemoryErrorObj, UNLOCKED);
    UNLOCKVAR(omm);
+   releaseWidenedStrings(c, 0);
+   xfree(c->widened);
    xfree(c->litebasePtr); // free litebase pointer
    DESTROY_MUTEX(c->usageLock);
+   threadPermitDestroy(&c->permit);
    heapDestroy(c->heap);
 }
 
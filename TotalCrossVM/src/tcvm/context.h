@@ -10,6 +10,7 @@
 #define STARTING_REG64_SIZE 1000  // * 8 = 8k
 #define STARTING_REGO_SIZE  2000  // * 4 = 8k for a 32-bit architecture
 #define STARTING_STACK_SIZE 2000  // * 4 = 8k - each method call uses 2 positions
+#define CONTEXT_SLOT_MASK   0x7F  // the id bits holding the slot (MAX_CONTEXTS must be below it); the other ones change each time the slot is reused
 
 struct TContext
 {
@@ -66,6 +67,32 @@ struct TContext
    // reflection
    bool parametersInArray;
 
+   // monitors
+   int32 id; // index in the contexts array plus 1 (CONTEXT_SLOT_MASK), plus the slot's generation above it; owner of the thin monitors
+   TThreadPermit permit; // the thread parks on it while waiting for a monitor, or for a class that another thread is reading
+   TCObject waitingMonitor; // the monitor it's parked on, or null
+   Context nextMonitorWaiter;
+
+   // class loader
+   int32 waitingClass; // hash of the name of the class it's waiting for; guarded by classLoaderLock
+   Context nextClassWaiter;
+
+   // cpu profiler
+   int32 profilerTick; // the stack is sampled when it differs from the global one
+
+   // graphics: the damage list, used by the platforms that update the screen by parts; the others use the bounding box
+   int32 dirtyCount;
+   TDirtyRect dirtyRects[MAX_DIRTY_RECTS];
+
+   // incremental gc
+   volatile int32 gcEpoch; // the last gcEpoch seen at a safepoint
+   volatile bool inNative; // running a native method or blocked, so it's not between a store and its write barrier
+
+   // compact strings: the char arrays that widenString created for the running native methods; they stay locked until the native returns
+   TCObject* widened;
+   int32 widenedCount, widenedMax;
+
+
    // IMPORTANT: ALL IFDEFS MUST BE PLACED AT THE END, otherwise, other native libraries that 
    // use this header that do not define the same #defines, will have problems.
    #ifdef ENABLE_TEST_SUITE
@@ -75,9 +102,6 @@ struct TContext
    int32 ccon,depth;
    char spaces[200];
    #endif
-   #ifdef TRACK_USED_OPCODES
-   int8 usedOpcodes[256];
-   #endif
 };
 
 Context newContext(ThreadHandle thread, TCObject threadObj, bool bigContextSizes); // if bigContextSize is false, use STARTING_xxx_SIZE/10
@@ -0,0 +1,802 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include "tcvm.h"
+
+#ifdef ENABLE_JIT
+
+#include <sys/mman.h>
+#include <stddef.h>
+
+// The native code is a function that receives the frame, the address where it must start and the thread's context; it
+// returns the index of the instruction where the interpreter must continue. All registers are read from and written to
+// the frame on each instruction, so no state needs to be transfered when the execution goes back to the interpreter.
+// A backward branch first polls the gc epoch and the profiler tick of the context, like PROFILER_POINT does in the
+// interpreter; when one of them changed, it returns the branch target with JIT_POLL_EXIT set, so jitRun can reach the
+// safepoint and take the sample before entering the native code again.
+typedef int32 (*JitEntryFunc)(Int32Array regI, TCObjectArray regO, Value64Array reg64, uint8* entry, Context context);
+
+#define JIT_POLL_EXIT 0x40000000
+
+struct TJitCode
+{
+   uint8* mem; // executable memory; starts with the function that jumps to the entry
+   int32 memSize;
+   int32 count; // number of instructions of the method
+   uint8** entries; // native address of each instruction, or null if it was not compiled
+   int32 roots[JIT_MAX_ROOTS], rootCount; // instructions from where the compilation started
+   JitCode previous; // replaced versions, which may still be running in another thread
+};
+
+#define JIT_MAX_BYTES_PER_OP 64
+#define JIT_STUB_SIZE 16
+#define JIT_POLL_SIZE 96
+
+enum // conditions of the branches
+{
+   JC_EQ, JC_NE, JC_LT, JC_LE, JC_GT, JC_GE, JC_HS // HS = unsigned greater or equal
+};
+
+enum // integer operations
+{
+   JO_ADD, JO_SUB, JO_MUL, JO_AND, JO_OR, JO_XOR, JO_SHL, JO_SHR, JO_USHR
+};
+
+enum // conversions
+{
+   JX_BYTE, JX_CHAR, JX_SHORT
+};
+
+typedef struct
+{
+   int32 at; // offset of the instruction to patch
+   int32 target; // >= 0: index of the target instruction; < 0: one of the stubs below
+} TJitFixup;
+
+typedef struct
+{
+   uint8 *start, *p;
+   int32 *labels; // native offset of each instruction, or -1
+   int32 *stubs; // native offset of the exit stub of each instruction, or -1 if it does not need one
+   int32 *polls; // native offset of the poll of each backward branch, or -1
+   int32 *pollExits; // native offset of the exit of each poll, or -1
+   TJitFixup* fixups;
+   int32 fixupCount;
+   ConstantPool cp;
+} TJitBuf, *JitBuf;
+
+#define JIT_STUB_KIND 0x1000000 // more instructions than any method has
+#define STUB(i) (-(i)-1)                          // the exit of instruction i, which runs it again in the interpreter
+#define POLL(i) (STUB(i) - JIT_STUB_KIND)         // the poll of the backward branch i, which then jumps to the target
+#define POLL_EXIT(i) (STUB(i) - 2*JIT_STUB_KIND)  // the exit of that poll, to the target in the interpreter
+
+static int32* stubOffset(JitBuf b, int32 target)
+{
+   int32 i = -target-1;
+   return i < JIT_STUB_KIND ? &b->stubs[i] : i < 2*JIT_STUB_KIND ? &b->polls[i - JIT_STUB_KIND] : &b->pollExits[i - 2*JIT_STUB_KIND];
+}
+
+static void fixup(JitBuf b, int32 target)
+{
+   b->fixups[b->fixupCount].at = (int32)(b->p - b->start);
+   b->fixups[b->fixupCount++].target = target;
+   if (target < 0)
+      *stubOffset(b, target) = 0; // needs one
+}
+
+///////////////////////////////////////////////////////////////////////////
+//                                 x86-64                                //
+///////////////////////////////////////////////////////////////////////////
+#if defined(__x86_64__)
+// System V: rdi = regI, rsi = regO, rdx = reg64, rcx = entry, r8 = context, which is moved to r11
+#define RI 7
+#define RO 6
+#define R64 2
+#define CTX 11
+// temporaries: T1 must be ecx, because of the shifts
+#define T0 0
+#define T1 1
+#define T2 8
+#define A 9
+#define B 10
+
+#define MODE_REG 0
+#define MODE_MEM 1 // [base + disp32]
+#define MODE_SIB 2 // [base + index*scale + disp8]
+
+static void emit8(JitBuf b, int32 v)  {*b->p++ = (uint8)v;}
+static void emit32(JitBuf b, int32 v) {xmemmove(b->p, &v, 4); b->p += 4;}
+
+static void x86(JitBuf b, int32 prefix, bool w, int32 op, int32 reg, int32 mode, int32 base, int32 index, int32 scale, int32 disp)
+{
+   int32 rex = 0x40 | (w << 3) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+   if (prefix)
+      emit8(b, prefix);
+   if (rex != 0x40)
+      emit8(b, rex);
+   if (op > 0xFF)
+      emit8(b, op >> 8);
+   emit8(b, op);
+   switch (mode)
+   {
+      case MODE_REG: emit8(b, 0xC0 | ((reg & 7) << 3) | (base & 7)); break;
+      case MODE_MEM: emit8(b, 0x80 | ((reg & 7) << 3) | (base & 7)); emit32(b, disp); break;
+      case MODE_SIB: emit8(b, 0x44 | ((reg & 7) << 3)); emit8(b, (scale << 6) | ((index & 7) << 3) | (base & 7)); emit8(b, disp); break;
+   }
+}
+
+static void jitPrologue(JitBuf b)            {x86(b, 0, true, 0x89, 8, MODE_REG, CTX, 0, 0, 0); emit8(b, 0xFF); emit8(b, 0xE1);} // mov r11, r8; jmp rcx
+static void jitExit(JitBuf b, int32 idx)     {emit8(b, 0xB8); emit32(b, idx); emit8(b, 0xC3);} // mov eax, idx; ret
+static void ldI(JitBuf b, int32 t, int32 r)  {x86(b, 0, false, 0x8B, t, MODE_MEM, RI, 0, 0, r*4);}
+static void stI(JitBuf b, int32 r, int32 t)  {x86(b, 0, false, 0x89, t, MODE_MEM, RI, 0, 0, r*4);}
+static void ldO(JitBuf b, int32 a, int32 r)  {x86(b, 0, true,  0x8B, a, MODE_MEM, RO, 0, 0, r*TSIZE);}
+static void stO(JitBuf b, int32 r, int32 a)  {x86(b, 0, true,  0x89, a, MODE_MEM, RO, 0, 0, r*TSIZE);}
+static void ld64(JitBuf b, int32 a, int32 r) {x86(b, 0, true,  0x8B, a, MODE_MEM, R64, 0, 0, r*8);}
+static void st64(JitBuf b, int32 r, int32 a) {x86(b, 0, true,  0x89, a, MODE_MEM, R64, 0, 0, r*8);}
+static void stONull(JitBuf b, int32 r)       {x86(b, 0, true,  0xC7, 0, MODE_MEM, RO, 0, 0, r*TSIZE); emit32(b, 0);} // mov qword [rsi+r], 0
+static void ldLen(JitBuf b, int32 t, int32 a){x86(b, 0, false, 0x8B, t, MODE_MEM, a, 0, 0, 0);}
+static void ldField(JitBuf b, int32 t, int32 a, int32 idx) {x86(b, 0, false, 0x8B, t, MODE_MEM, a, 0, 0, idx*4);}
+static void stField(JitBuf b, int32 a, int32 idx, int32 t) {x86(b, 0, false, 0x89, t, MODE_MEM, a, 0, 0, idx*4);}
+static void ldCtx(JitBuf b, int32 t, int32 offset)         {x86(b, 0, false, 0x8B, t, MODE_MEM, CTX, 0, 0, offset);}
+
+static void ldGlobal(JitBuf b, int32 t, volatile int32* addr) // t = *addr; uses A
+{
+   uint64 a = (uint64)(size_t)addr;
+   emit8(b, 0x48 | (A >> 3)); emit8(b, 0xB8 | (A & 7)); // mov A, imm64
+   xmemmove(b->p, &a, 8);
+   b->p += 8;
+   x86(b, 0, false, 0x8B, t, MODE_MEM, A, 0, 0, 0);
+}
+
+static void movImm(JitBuf b, int32 t, int32 imm)
+{
+   if (t >> 3)
+      emit8(b, 0x41);
+   emit8(b, 0xB8 | (t & 7));
+   emit32(b, imm);
+}
+
+static void alu(JitBuf b, int32 op, int32 t0, int32 t1) // t0 = t0 op t1
+{
+   static int32 opcodes[] = {0x01, 0x29, 0, 0x21, 0x09, 0x31};
+   static int32 shifts[] = {4, 7, 5};
+   if (op == JO_MUL)
+      x86(b, 0, false, 0x0FAF, t0, MODE_REG, t1, 0, 0, 0); // imul t0, t1
+   else
+   if (op >= JO_SHL)
+      x86(b, 0, false, 0xD3, shifts[op - JO_SHL], MODE_REG, t0, 0, 0, 0); // shl/sar/shr t0, cl
+   else
+      x86(b, 0, false, opcodes[op], t1, MODE_REG, t0, 0, 0, 0);
+}
+
+static void ext(JitBuf b, int32 kind, int32 t)
+{
+   static int32 opcodes[] = {0x0FBE, 0x0FB7, 0x0FBF}; // movsx/movzx t, t8/t16
+   x86(b, 0, false, opcodes[kind], t, MODE_REG, t, 0, 0, 0);
+}
+
+static void jcc(JitBuf b, int32 cond, int32 target)
+{
+   static int32 cc[] = {0x84, 0x85, 0x8C, 0x8E, 0x8F, 0x8D, 0x83};
+   emit8(b, 0x0F); emit8(b, cc[cond]);
+   fixup(b, target);
+   emit32(b, 0);
+}
+
+static void cmpBr(JitBuf b, int32 cond, int32 t0, int32 t1, int32 target)
+{
+   x86(b, 0, false, 0x39, t1, MODE_REG, t0, 0, 0, 0); // cmp t0, t1
+   jcc(b, cond, target);
+}
+
+static void cmpOBr(JitBuf b, int32 cond, int32 a0, int32 a1, int32 target)
+{
+   x86(b, 0, true, 0x39, a1, MODE_REG, a0, 0, 0, 0);
+   jcc(b, cond, target);
+}
+
+static void nullBr(JitBuf b, int32 cond, int32 a, int32 target) // cond is JC_EQ (null) or JC_NE (not null)
+{
+   x86(b, 0, true, 0x85, a, MODE_REG, a, 0, 0, 0); // test a, a
+   jcc(b, cond, target);
+}
+
+static void jmp(JitBuf b, int32 target)
+{
+   emit8(b, 0xE9);
+   fixup(b, target);
+   emit32(b, 0);
+}
+
+static void ldElem(JitBuf b, int32 size, int32 t, int32 a, int32 ti)
+{
+   switch (size)
+   {
+      case 1: x86(b, 0, false, 0x0FBE, t, MODE_SIB, a, ti, 0, TSIZE); break; // movsx t, byte [a+ti+8]
+      case 2: x86(b, 0, false, 0x0FB7, t, MODE_SIB, a, ti, 1, TSIZE); break; // movzx t, word [a+ti*2+8]
+      default:x86(b, 0, false, 0x8B,   t, MODE_SIB, a, ti, 2, TSIZE); break;
+   }
+}
+
+static void stElem(JitBuf b, int32 size, int32 a, int32 ti, int32 t)
+{
+   switch (size)
+   {
+      case 1: x86(b, 0,    false, 0x88, t, MODE_SIB, a, ti, 0, TSIZE); break;
+      case 2: x86(b, 0x66, false, 0x89, t, MODE_SIB, a, ti, 1, TSIZE); break;
+      default:x86(b, 0,    false, 0x89, t, MODE_SIB, a, ti, 2, TSIZE); break;
+   }
+}
+
+static void patch(JitBuf b, int32 at, int32 dest)
+{
+   int32 rel = dest - (at + 4);
+   xmemmove(b->start + at, &rel, 4);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//                                AArch64                                //
+///////////////////////////////////////////////////////////////////////////
+#elif defined(__aarch64__)
+// AAPCS64: x0 = regI, x1 = regO, x2 = reg64, x3 = entry, x4 = context
+#define RI 0
+#define RO 1
+#define R64 2
+#define CTX 4
+#define T0 9
+#define T1 10
+#define T2 11
+#define A 12
+#define B 13
+#define SCRATCH 14
+#define ZR 31
+
+static void emit(JitBuf b, uint32 ins) {xmemmove(b->p, &ins, 4); b->p += 4;}
+
+static void jitPrologue(JitBuf b)            {emit(b, 0xD61F0060);} // br x3
+static void ldI(JitBuf b, int32 t, int32 r)  {emit(b, 0xB9400000 | (r << 10) | (RI << 5) | t);}   // ldr wt, [x0, #r*4]
+static void stI(JitBuf b, int32 r, int32 t)  {emit(b, 0xB9000000 | (r << 10) | (RI << 5) | t);}   // str wt, [x0, #r*4]
+static void ldO(JitBuf b, int32 a, int32 r)  {emit(b, 0xF9400000 | (r << 10) | (RO << 5) | a);}   // ldr xa, [x1, #r*8]
+static void stO(JitBuf b, int32 r, int32 a)  {emit(b, 0xF9000000 | (r << 10) | (RO << 5) | a);}   // str xa, [x1, #r*8]
+static void ld64(JitBuf b, int32 a, int32 r) {emit(b, 0xF9400000 | (r << 10) | (R64 << 5) | a);}  // ldr xa, [x2, #r*8]
+static void st64(JitBuf b, int32 r, int32 a) {emit(b, 0xF9000000 | (r << 10) | (R64 << 5) | a);}  // str xa, [x2, #r*8]
+static void stONull(JitBuf b, int32 r)       {stO(b, r, ZR);}
+static void ldLen(JitBuf b, int32 t, int32 a){emit(b, 0xB9400000 | (a << 5) | t);}                // ldr wt, [xa]
+static void ldField(JitBuf b, int32 t, int32 a, int32 idx) {emit(b, 0xB9400000 | (idx << 10) | (a << 5) | t);}
+static void stField(JitBuf b, int32 a, int32 idx, int32 t) {emit(b, 0xB9000000 | (idx << 10) | (a << 5) | t);}
+static void ldCtx(JitBuf b, int32 t, int32 offset)         {emit(b, 0xB9400000 | ((offset >> 2) << 10) | (CTX << 5) | t);}
+
+static void ldGlobal(JitBuf b, int32 t, volatile int32* addr) // t = *addr; uses A
+{
+   uint64 a = (uint64)(size_t)addr;
+   emit(b, 0xD2800000 | ((uint32)(a & 0xFFFF) << 5) | A); // movz xa, #a[0:15]
+   emit(b, 0xF2A00000 | ((uint32)((a >> 16) & 0xFFFF) << 5) | A); // movk xa, #a[16:31], lsl #16
+   emit(b, 0xF2C00000 | ((uint32)((a >> 32) & 0xFFFF) << 5) | A); // movk xa, #a[32:47], lsl #32
+   emit(b, 0xF2E00000 | ((uint32)((a >> 48) & 0xFFFF) << 5) | A); // movk xa, #a[48:63], lsl #48
+   emit(b, 0xB9400000 | (A << 5) | t); // ldr wt, [xa]
+}
+
+static void movImm(JitBuf b, int32 t, int32 imm)
+{
+   emit(b, 0x52800000 | ((imm & 0xFFFF) << 5) | t); // movz wt, #lo
+   if ((uint32)imm >> 16)
+      emit(b, 0x72A00000 | (((uint32)imm >> 16) << 5) | t); // movk wt, #hi, lsl #16
+}
+
+static void jitExit(JitBuf b, int32 idx)
+{
+   movImm(b, 0, idx);
+   emit(b, 0xD65F03C0); // ret
+}
+
+static void alu(JitBuf b, int32 op, int32 t0, int32 t1)
+{
+   static uint32 opcodes[] = {0x0B000000, 0x4B000000, 0x1B007C00, 0x0A000000, 0x2A000000, 0x4A000000, 0x1AC02000, 0x1AC02800, 0x1AC02400}; // add, sub, mul, and, orr, eor, lslv, asrv, lsrv
+   emit(b, opcodes[op] | (t1 << 16) | (t0 << 5) | t0);
+}
+
+static void ext(JitBuf b, int32 kind, int32 t)
+{
+   static uint32 opcodes[] = {0x13001C00, 0x53003C00, 0x13003C00}; // sxtb, uxth, sxth
+   emit(b, opcodes[kind] | (t << 5) | t);
+}
+
+static void bcond(JitBuf b, int32 cond, int32 target)
+{
+   static uint32 cc[] = {0, 1, 11, 13, 12, 10, 2};
+   fixup(b, target);
+   emit(b, 0x54000000 | cc[cond]);
+}
+
+static void cmpBr(JitBuf b, int32 cond, int32 t0, int32 t1, int32 target)
+{
+   emit(b, 0x6B00001F | (t1 << 16) | (t0 << 5)); // cmp wt0, wt1
+   bcond(b, cond, target);
+}
+
+static void cmpOBr(JitBuf b, int32 cond, int32 a0, int32 a1, int32 target)
+{
+   emit(b, 0xEB00001F | (a1 << 16) | (a0 << 5)); // cmp xa0, xa1
+   bcond(b, cond, target);
+}
+
+static void nullBr(JitBuf b, int32 cond, int32 a, int32 target)
+{
+   fixup(b, target);
+   emit(b, (cond == JC_EQ ? 0xB4000000 : 0xB5000000) | a); // cbz/cbnz xa
+}
+
+static void jmp(JitBuf b, int32 target)
+{
+   fixup(b, target);
+   emit(b, 0x14000000);
+}
+
+static void ldElem(JitBuf b, int32 size, int32 t, int32 a, int32 ti)
+{
+   static uint32 opcodes[] = {0, 0x38E06800, 0x78607800, 0, 0xB8607800}; // ldrsb, ldrh, ldr (register, lsl #size)
+   emit(b, 0x91000000 | (TSIZE << 10) | (a << 5) | SCRATCH); // add scratch, xa, #8
+   emit(b, opcodes[size] | (ti << 16) | (SCRATCH << 5) | t);
+}
+
+static void stElem(JitBuf b, int32 size, int32 a, int32 ti, int32 t)
+{
+   static uint32 opcodes[] = {0, 0x38206800, 0x78207800, 0, 0xB8207800}; // strb, strh, str
+   emit(b, 0x91000000 | (TSIZE << 10) | (a << 5) | SCRATCH);
+   emit(b, opcodes[size] | (ti << 16) | (SCRATCH << 5) | t);
+}
+
+static void patch(JitBuf b, int32 at, int32 dest)
+{
+   uint32 ins;
+   int32 rel = (dest - at) >> 2;
+   xmemmove(&ins, b->start + at, 4);
+   if ((ins & 0xFC000000) == 0x14000000) // b
+      ins |= rel & 0x3FFFFFF;
+   else // b.cond, cbz, cbnz
+      ins |= (rel & 0x7FFFF) << 5;
+   xmemmove(b->start + at, &ins, 4);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+//                               Templates                               //
+///////////////////////////////////////////////////////////////////////////
+
+static void arrayCheck(JitBuf b, int32 base, int32 idx, int32 i) // A = regO[base], T1 = regI[idx]; exits if null or out of bounds
+{
+   ldO(b, A, base);
+   nullBr(b, JC_EQ, A, STUB(i));
+   ldI(b, T1, idx);
+   ldLen(b, T2, A);
+   cmpBr(b, JC_HS, T1, T2, STUB(i)); // unsigned, so negative indexes are also caught
+}
+
+static void jitPoll(JitBuf b, int32 i, int32 target) // the poll of the backward branch i: exits if this thread must reach a safepoint or take a sample
+{
+   ldCtx(b, T0, (int32)offsetof(TContext, gcEpoch));
+   ldGlobal(b, T1, &gcEpoch);
+   cmpBr(b, JC_NE, T0, T1, POLL_EXIT(i));
+   ldCtx(b, T0, (int32)offsetof(TContext, profilerTick));
+   ldGlobal(b, T1, &profilerTick);
+   cmpBr(b, JC_NE, T0, T1, POLL_EXIT(i));
+   jmp(b, target);
+}
+
+static int32 fieldIndex(ConstantPool cp, TCode c) // index of an instance field, or -1 if not resolved yet
+{
+   switch (c.op.op)
+   {
+      case MOV_regI_field: case MOV_field_regI:
+         return cp->boundIField[c.field_reg.sym] < UNBOUND_ERROR && cp->boundIField[c.field_reg.sym] < 4096 ? cp->boundIField[c.field_reg.sym] : -1;
+      default:
+         return c.field_reg.sym; // quick versions
+   }
+}
+
+static int32 branchTarget(TCode c, int32 i) // target of a jump, or -1
+{
+   switch (c.op.op)
+   {
+      case JEQ_regO_regO: case JEQ_regO_null: case JEQ_regI_regI: case JNE_regO_regO: case JNE_regO_null: case JNE_regI_regI:
+      case JLT_regI_regI: case JLE_regI_regI: case JGT_regI_regI: case JGE_regI_regI:
+         return i + c.reg_reg_s12.s12;
+      case JEQ_regI_s6: case JNE_regI_s6: case JLT_regI_s6: case JLE_regI_s6: case JGT_regI_s6: case JGE_regI_s6:
+         return i + c.reg_s6_desloc.desloc;
+      case JEQ_regI_sym: case JNE_regI_sym:
+         return i + c.reg_sym_sdesloc.desloc;
+      case JGE_regI_arlen:
+         return i + c.reg_arl_s12.desloc;
+      case DECJGTZ_regI: case DECJGEZ_regI:
+         return i + c.reg_desloc.desloc;
+      case JUMP_s24:
+         return i + c.s24.desloc;
+   }
+   return -1;
+}
+
+static bool emitInstruction(JitBuf b, TCode c, int32 i) // returns false if the instruction is not supported
+{
+   ConstantPool cp = b->cp;
+   int32 op = c.op.op, target = branchTarget(c, i), aluOp = 0, cond = 0, size = 4;
+   if (0 <= target && target <= i) // a loop that runs only in native code must still reach the safepoints
+      target = POLL(i);
+   switch (op)
+   {
+      case MOV_regI_regI:  ldI(b, T0, c.reg_reg.reg1); stI(b, c.reg_reg.reg0, T0); break;
+      case MOV_regI_s18:   movImm(b, T0, c.s18_reg.s18); stI(b, c.s18_reg.reg, T0); break;
+      case MOV_regI_sym:   movImm(b, T0, cp->i32[c.reg_sym.sym]); stI(b, c.reg_sym.reg, T0); break;
+      case MOV_regO_regO:  ldO(b, A, c.reg_reg.reg1); stO(b, c.reg_reg.reg0, A); break;
+      case MOV_regO_null:  stONull(b, c.reg.reg); break;
+      case MOV_reg64_reg64:ld64(b, A, c.reg_reg.reg1); st64(b, c.reg_reg.reg0, A); break;
+      case MOV_regI_arlen:
+         ldO(b, A, c.reg_ar.base);
+         nullBr(b, JC_EQ, A, STUB(i));
+         ldLen(b, T0, A);
+         stI(b, c.reg_ar.reg, T0);
+         break;
+
+      case MOV_regIb_arc: case MOV_regIb_aru: size = 1; goto loadElem;
+      case MOV_reg16_arc: case MOV_reg16_aru: size = 2; goto loadElem;
+      case MOV_regI_arc: case MOV_regI_aru: case MOV_regI_arcQ: case MOV_regI_arc_INC_regI: // the INC is compiled with the next instruction
+loadElem:
+         arrayCheck(b, c.reg_ar.base, c.reg_ar.idx, i);
+         ldElem(b, size, T0, A, T1);
+         stI(b, c.reg_ar.reg, T0);
+         break;
+      case MOV_arc_regIb: case MOV_aru_regIb: size = 1; goto storeElem;
+      case MOV_arc_reg16: case MOV_aru_reg16: size = 2; goto storeElem;
+      case MOV_arc_regI: case MOV_aru_regI:
+storeElem:
+         arrayCheck(b, c.reg_ar.base, c.reg_ar.idx, i);
+         ldI(b, T0, c.reg_ar.reg);
+         stElem(b, size, A, T1, T0);
+         break;
+      case ADD_regI_arc_s6: case ADD_regI_aru_s6: aluOp = JO_ADD; goto elemOpS6;
+      case AND_regI_aru_s6: aluOp = JO_AND;
+elemOpS6:
+         arrayCheck(b, c.reg_s6_ar.base, c.reg_s6_ar.idx, i);
+         ldElem(b, 4, T0, A, T1);
+         movImm(b, T2, c.reg_s6_ar.s6);
+         alu(b, aluOp, T0, T2);
+         stI(b, c.reg_s6_ar.reg, T0);
+         break;
+
+      case MOV_regI_field: case MOV_regI_fieldQ:
+      case MOV_regI_fieldQ_JEQ_regI_s6: case MOV_regI_fieldQ_JNE_regI_s6: case MOV_regI_fieldQ_JLT_regI_regI: case MOV_regI_fieldQ_JGE_regI_regI: // the jump is compiled with the next instruction
+         if ((size = fieldIndex(cp, c)) < 0)
+            return false;
+         ldO(b, A, c.field_reg.this_);
+         nullBr(b, JC_EQ, A, STUB(i));
+         ldField(b, T0, A, size);
+         stI(b, c.field_reg.reg, T0);
+         break;
+      case MOV_field_regI: case MOV_fieldQ_regI:
+         if ((size = fieldIndex(cp, c)) < 0)
+            return false;
+         ldO(b, A, c.field_reg.this_);
+         nullBr(b, JC_EQ, A, STUB(i));
+         ldI(b, T0, c.field_reg.reg);
+         stField(b, A, size, T0);
+         break;
+
+      case ADD_regI_regI_regI:  aluOp = JO_ADD;  goto regRegReg;
+      case SUB_regI_regI_regI:  aluOp = JO_SUB;  goto regRegReg;
+      case MUL_regI_regI_regI:  aluOp = JO_MUL;  goto regRegReg;
+      case AND_regI_regI_regI:  aluOp = JO_AND;  goto regRegReg;
+      case OR_regI_regI_regI:   aluOp = JO_OR;   goto regRegReg;
+      case XOR_regI_regI_regI:  aluOp = JO_XOR;  goto regRegReg;
+      case SHL_regI_regI_regI:  aluOp = JO_SHL;  goto regRegReg;
+      case SHR_regI_regI_regI:  aluOp = JO_SHR;  goto regRegReg;
+      case USHR_regI_regI_regI: aluOp = JO_USHR;
+regRegReg:
+         ldI(b, T0, c.reg_reg_reg.reg1);
+         ldI(b, T1, c.reg_reg_reg.reg2);
+         alu(b, aluOp, T0, T1);
+         stI(b, c.reg_reg_reg.reg0, T0);
+         break;
+      case ADD_regI_s12_regI:  aluOp = JO_ADD;  goto regRegS12;
+      case MUL_regI_regI_s12:  aluOp = JO_MUL;  goto regRegS12;
+      case AND_regI_regI_s12:  aluOp = JO_AND;  goto regRegS12;
+      case OR_regI_regI_s12:   aluOp = JO_OR;   goto regRegS12;
+      case XOR_regI_regI_s12:  aluOp = JO_XOR;  goto regRegS12;
+      case SHL_regI_regI_s12:  aluOp = JO_SHL;  goto regRegS12;
+      case SHR_regI_regI_s12:  aluOp = JO_SHR;  goto regRegS12;
+      case USHR_regI_regI_s12: aluOp = JO_USHR;
+regRegS12:
+         ldI(b, T0, c.reg_reg_s12.reg1);
+         movImm(b, T1, c.reg_reg_s12.s12);
+         alu(b, aluOp, T0, T1);
+         stI(b, c.reg_reg_s12.reg0, T0);
+         break;
+      case SUB_regI_s12_regI: // reg0 = s12 - reg1
+         movImm(b, T0, c.reg_reg_s12.s12);
+         ldI(b, T1, c.reg_reg_s12.reg1);
+         alu(b, JO_SUB, T0, T1);
+         stI(b, c.reg_reg_s12.reg0, T0);
+         break;
+      case ADD_regI_regI_sym:
+         ldI(b, T0, c.reg_reg_sym.reg1);
+         movImm(b, T1, cp->i32[c.reg_reg_sym.sym]);
+         alu(b, JO_ADD, T0, T1);
+         stI(b, c.reg_reg_sym.reg0, T0);
+         break;
+      case INC_regI:
+         ldI(b, T0, c.inc.reg);
+         movImm(b, T1, c.inc.s16);
+         alu(b, JO_ADD, T0, T1);
+         stI(b, c.inc.reg, T0);
+         break;
+      case CONV_regIb_regI: aluOp = JX_BYTE;  goto conv;
+      case CONV_regIc_regI: aluOp = JX_CHAR;  goto conv;
+      case CONV_regIs_regI: aluOp = JX_SHORT;
+conv:
+         ldI(b, T0, c.reg_reg.reg1);
+         ext(b, aluOp, T0);
+         stI(b, c.reg_reg.reg0, T0);
+         break;
+
+      case JEQ_regI_regI: cond = JC_EQ; goto jRegReg;
+      case JNE_regI_regI: cond = JC_NE; goto jRegReg;
+      case JLT_regI_regI: cond = JC_LT; goto jRegReg;
+      case JLE_regI_regI: cond = JC_LE; goto jRegReg;
+      case JGT_regI_regI: cond = JC_GT; goto jRegReg;
+      case JGE_regI_regI: cond = JC_GE;
+jRegReg:
+         ldI(b, T0, c.reg_reg_s12.reg0);
+         ldI(b, T1, c.reg_reg_s12.reg1);
+         cmpBr(b, cond, T0, T1, target);
+         break;
+      case JEQ_regI_s6: cond = JC_EQ; goto jRegS6;
+      case JNE_regI_s6: cond = JC_NE; goto jRegS6;
+      case JLT_regI_s6: cond = JC_LT; goto jRegS6;
+      case JLE_regI_s6: cond = JC_LE; goto jRegS6;
+      case JGT_regI_s6: cond = JC_GT; goto jRegS6;
+      case JGE_regI_s6: cond = JC_GE;
+jRegS6:
+         ldI(b, T0, c.reg_s6_desloc.reg);
+         movImm(b, T1, c.reg_s6_desloc.s6);
+         cmpBr(b, cond, T0, T1, target);
+         break;
+      case JEQ_regI_sym: case JNE_regI_sym:
+         ldI(b, T0, c.reg_sym_sdesloc.reg);
+         movImm(b, T1, cp->i32[c.reg_sym_sdesloc.sym]);
+         cmpBr(b, op == JEQ_regI_sym ? JC_EQ : JC_NE, T0, T1, target);
+         break;
+      case JEQ_regO_regO: case JNE_regO_regO:
+         ldO(b, A, c.reg_reg_s12.reg0);
+         ldO(b, B, c.reg_reg_s12.reg1);
+         cmpOBr(b, op == JEQ_regO_regO ? JC_EQ : JC_NE, A, B, target);
+         break;
+      case JEQ_regO_null: case JNE_regO_null:
+         ldO(b, A, c.reg_reg_s12.reg0);
+         nullBr(b, op == JEQ_regO_null ? JC_EQ : JC_NE, A, target);
+         break;
+      case JGE_regI_arlen:
+         ldO(b, A, c.reg_arl_s12.base);
+         nullBr(b, JC_EQ, A, STUB(i));
+         ldLen(b, T1, A);
+         ldI(b, T0, c.reg_arl_s12.regI);
+         cmpBr(b, JC_GE, T0, T1, target);
+         break;
+      case DECJGTZ_regI: case DECJGEZ_regI:
+         ldI(b, T0, c.reg_desloc.reg);
+         movImm(b, T1, 1);
+         alu(b, JO_SUB, T0, T1);
+         stI(b, c.reg_desloc.reg, T0);
+         movImm(b, T1, 0);
+         cmpBr(b, op == DECJGTZ_regI ? JC_GT : JC_GE, T0, T1, target);
+         break;
+      case JUMP_s24:
+         jmp(b, target);
+         break;
+      default:
+         return false;
+   }
+   return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//                                Compiler                               //
+///////////////////////////////////////////////////////////////////////////
+
+static JitCode compile(Method m, int32* roots, int32 rootCount)
+{
+   int32 count = ARRAYLENV(m->code), i, k, top = 0, size, compiled = 0;
+   int32 *labels = null, *stubs = null, *polls = null, *pollExits = null, *stack = null;
+   TJitBuf buf, *b = &buf;
+   JitCode j = null;
+   uint8* mem = MAP_FAILED;
+
+   xmemzero(b, sizeof(buf));
+   size = count * (JIT_MAX_BYTES_PER_OP + 2 * JIT_STUB_SIZE + JIT_POLL_SIZE) + 64;
+   labels = (int32*)xmalloc(count * sizeof(int32));
+   stubs = (int32*)xmalloc(count * sizeof(int32));
+   polls = (int32*)xmalloc(count * sizeof(int32));
+   pollExits = (int32*)xmalloc(count * sizeof(int32));
+   stack = (int32*)xmalloc((count + JIT_MAX_ROOTS) * sizeof(int32));
+   b->fixups = (TJitFixup*)xmalloc(count * 6 * sizeof(TJitFixup));
+   j = (JitCode)xmalloc(sizeof(TJitCode));
+   if (!labels || !stubs || !polls || !pollExits || !stack || !b->fixups || !j || (j->entries = (uint8**)xmalloc(count * sizeof(uint8*))) == null ||
+       (mem = (uint8*)mmap(null, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+      goto error;
+
+   for (i = 0; i < count; i++)
+      labels[i] = stubs[i] = polls[i] = pollExits[i] = -1;
+   b->start = b->p = mem;
+   b->labels = labels;
+   b->stubs = stubs;
+   b->polls = polls;
+   b->pollExits = pollExits;
+   b->cp = m->class_->cp;
+   jitPrologue(b);
+   for (k = rootCount; --k >= 0;)
+      stack[top++] = roots[k];
+
+   // emits the instructions reachable from the roots, following the fall throughs so they are contiguous
+   while (top > 0)
+   {
+      i = stack[--top];
+      while (0 <= i && i < count && labels[i] < 0)
+      {
+         TCode c = m->code[i];
+         uint8* p = b->p;
+         int32 fixupCount = b->fixupCount, target = branchTarget(c, i);
+         labels[i] = (int32)(p - b->start);
+         if ((i == count-1 && c.op.op != JUMP_s24) || target < -1 || target >= count || !emitInstruction(b, c, i)) // valid code never falls through the last instruction
+         {
+            b->p = p;
+            b->fixupCount = fixupCount;
+            jitExit(b, i);
+            break;
+         }
+         j->entries[i] = b->start + labels[i];
+         compiled++;
+         if (target >= 0 && labels[target] < 0)
+            stack[top++] = target;
+         if (c.op.op == JUMP_s24)
+            break;
+         if (labels[i+1] >= 0) // already emitted somewhere else
+         {
+            jmp(b, i+1);
+            break;
+         }
+         i++;
+      }
+   }
+   for (i = 0; i < count; i++) // the exits of the instructions that may throw an exception
+      if (stubs[i] == 0)
+      {
+         stubs[i] = (int32)(b->p - b->start);
+         jitExit(b, i);
+      }
+   for (i = 0; i < count; i++) // the polls of the backward branches, and then their exits
+      if (polls[i] == 0)
+      {
+         polls[i] = (int32)(b->p - b->start);
+         jitPoll(b, i, branchTarget(m->code[i], i));
+      }
+   for (i = 0; i < count; i++)
+      if (pollExits[i] == 0)
+      {
+         pollExits[i] = (int32)(b->p - b->start);
+         jitExit(b, branchTarget(m->code[i], i) | JIT_POLL_EXIT);
+      }
+   for (k = 0; k < b->fixupCount; k++)
+   {
+      int32 target = b->fixups[k].target;
+      patch(b, b->fixups[k].at, target >= 0 ? labels[target] : *stubOffset(b, target));
+   }
+   if (mprotect(mem, size, PROT_READ|PROT_EXEC) != 0)
+      goto error;
+   __builtin___clear_cache((char*)mem, (char*)b->p);
+   if (compiled == 0) // nothing to run; keep the roots so they are not tried again
+   {
+      munmap(mem, size);
+      mem = null;
+      size = 0;
+      xfree(j->entries);
+   }
+   j->mem = mem;
+   j->memSize = size;
+   j->count = count;
+   xfree(labels);
+   xfree(stubs);
+   xfree(polls);
+   xfree(pollExits);
+   xfree(stack);
+   xfree(b->fixups);
+   return j;
+error:
+   if (mem != MAP_FAILED)
+      munmap(mem, size);
+   if (j)
+      xfree(j->entries);
+   xfree(j);
+   xfree(labels);
+   xfree(stubs);
+   xfree(polls);
+   xfree(pollExits);
+   xfree(stack);
+   xfree(b->fixups);
+   return null;
+}
+
+static bool hasRoot(JitCode j, int32 root)
+{
+   int32 i;
+   for (i = 0; i < j->rootCount; i++)
+      if (j->roots[i] == root)
+         return true;
+   return false;
+}
+
+void jitCompile(Method m, int32 root)
+{
+   JitCode old, j;
+   int32 roots[JIT_MAX_ROOTS], rootCount = 0;
+   LOCKVAR(jit);
+   old = m->jit;
+   if (old != null)
+   {
+      if (hasRoot(old, root) || old->rootCount == JIT_MAX_ROOTS)
+         goto finish;
+      xmemmove(roots, old->roots, old->rootCount * sizeof(int32));
+      rootCount = old->rootCount;
+   }
+   roots[rootCount++] = root;
+   if ((j = compile(m, roots, rootCount)) != null)
+   {
+      xmemmove(j->roots, roots, rootCount * sizeof(int32));
+      j->rootCount = rootCount;
+      j->previous = old;
+      MEMORY_BARRIER(); // publish the code only after it is complete
+      m->jit = j;
+   }
+finish:
+   UNLOCKVAR(jit);
+}
+
+Code jitRun(Context context, Method m, Int32Array regI, TCObjectArray regO, Value64Array reg64, Code code)
+{
+   JitCode j = m->jit;
+   int32 idx = (int32)(code - m->code);
+   if (j->entries == null || j->entries[idx] == null)
+   {
+      if (hasRoot(j, idx) || j->rootCount == JIT_MAX_ROOTS)
+         return code;
+      jitCompile(m, idx); // a new place to enter, usually after a method call
+      j = m->jit;
+      if (j->entries == null || j->entries[idx] == null)
+         return code;
+   }
+   while (((idx = ((JitEntryFunc)j->mem)(regI, regO, reg64, j->entries[idx], context)) & JIT_POLL_EXIT) != 0)
+   {
+      code = m->code + (idx &= ~JIT_POLL_EXIT); // a backward branch left at its target: do what PROFILER_POINT does there
+      if (context->profilerTick != profilerTick)
+         takeProfilerSample(context, m, code);
+      GC_SAFEPOINT(context)
+      j = m->jit; // may have been replaced by another thread
+      if (j->entries == null || j->entries[idx] == null)
+         return code;
+   }
+   return m->code + idx;
+}
+
+void jitFree(Method m)
+{
+   JitCode j = m->jit, previous;
+   for (; j != null; j = previous)
+   {
+      previous = j->previous;
+      if (j->mem)
+         munmap(j->mem, j->memSize);
+      xfree(j->entries);
+      xfree(j);
+   }
+   m->jit = null;
+}
+
+#endif
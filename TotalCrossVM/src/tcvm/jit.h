@@ -0,0 +1,41 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifndef JIT_H
+#define JIT_H
+
+/*
+ Baseline template JIT. Each supported instruction of a method is translated into a fixed sequence of
+ native instructions that uses the same regI/regO/reg64 frame of the interpreter, so the execution can
+ move between both at any instruction. The native code returns to the interpreter (giving back the index
+ of the instruction where it stopped) on everything it does not translate: method calls, returns,
+ allocations, floating point, and on any instruction that would throw an exception, which the interpreter
+ then executes again and throws as usual. When a called method returns, executeMethod enters the native
+ code again after the call. Backward branches poll the gc epoch and the profiler tick, so loops that run
+ only in native code still reach the safepoints and are sampled.
+
+ It is enabled with Vm.tweak(Vm.TWEAK_JIT, true); a method is compiled after JIT_THRESHOLD calls.
+*/
+
+#if (defined(__x86_64__) || defined(__aarch64__)) && defined(linux) && !defined(ANDROID)
+#define ENABLE_JIT
+#endif
+
+#ifdef ENABLE_JIT
+
+#define JIT_THRESHOLD 1000 // number of calls before a method is compiled
+#define JIT_MAX_ROOTS 8    // maximum number of instructions where the interpreter may enter a method's native code
+
+/// Compiles the given method, adding the given instruction index to the places where the native code can be entered
+void jitCompile(Method m, int32 root);
+/// Runs the native code of the method from the given instruction, returning the instruction where the interpreter must continue.
+/// The backward branches reach the gc safepoint and take the profiler samples of the given context, like the interpreter
+Code jitRun(Context context, Method m, Int32Array regI, TCObjectArray regO, Value64Array reg64, Code code);
+/// Frees the native code of the given method
+void jitFree(Method m);
+
+#endif
+
+#endif
@@ -9,109 +9,115 @@
 
 Handling allocation and disposal of objects
 
-   Definitions
-   ~~~~~~~~~~~
-
-There's an array of available blocks of data, ordered by size. Each block has two
-lists: free objects and used objects.
-
-+-------+
-|   8   |.freeList
-| bytes |.usedList
-+-------+
-|  12   |.freeList
-| bytes |.usedList
-+-------+
-|  16   |.freeList
-| bytes |.usedList
-+-------+
-    .
-    .
-    .
+   Slabs
+   ~~~~~
 
-   Memory allocation
-   ~~~~~~~~~~~~~~~~~
-
-When an Object is allocated, it is removed from the free list and put in the used list
-at the given array index (based on object's size).
-
-* Initial state:
-
-+-------+
-|  16   |.freeList --> obj1 --> obj2 --> obj3 --> 0
-| bytes |.usedList --> 0
-+-------+
-
-* Allocation of an object with 16 bytes:
-
-+-------+
-|  16   |.freeList --> obj2 --> obj3 --> 0
-| bytes |.usedList --> obj1 --> 0
-+-------+
-
-* Allocation of another object with 16 bytes:
+The memory is requested to the system in chunks, which are split in slabs of SLAB_SIZE
+bytes, aligned at SLAB_SIZE. Each slab serves a single size class, and is split in cells
+of that size. The size of an object is rounded up to the next size class: 8, 16, 24 ...
+128 bytes, then 4 classes per power of two (160, 192, 224, 256, 320 ... 2048).
 
-+-------+
-|  16   |.freeList --> obj3 --> 0
-| bytes |.usedList --> obj1 --> obj2 --> 0
-+-------+
++-------+--------------------+-------+-------+-------+-------+-----+
+| TSlab | live, marks, locks | cell0 | cell1 | cell2 | cell3 | ... |
++-------+--------------------+-------+-------+-------+-------+-----+
+^ aligned at SLAB_SIZE
 
+Besides the cells, a slab has three bitmaps, with one bit per cell:
+   - live: the cell holds an object;
+   - marks: the object was reached by the gc;
+   - locks: the object is locked (the lock bit in the object properties is kept too).
 
-   A single-pass Garbage Collector
-   ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Since the slabs are aligned, the slab of an object is found by clearing the lower bits of its
+address, and the index of its cell is computed multiplying the offset by the reciprocal of the
+cell size. So the object properties only keep the class, the size and a few flags: there are no
+links between the objects.
 
-First, the list of used objects is appended to the list of free objects, emptying the
-former.
 
-+-------+
-|  16   |.freeList --> obj3 --> obj1 --> obj2 --> 0
-| bytes |.usedList --> 0
-+-------+
-
-Secondly, all the reachable objects (all objects in the object registers and all the
-static class members) are removed from the free list and placed back in the used one.
-
-(Suppose obj1 is the only reachable)
-
-+-------+
-|  16   |.freeList --> obj3 --> obj2 --> 0
-| bytes |.usedList --> obj1 --> 0
-+-------+
-
-Once this pass finishes, only unreachable (and, so, freed) objects remain in the free
-list.
-
-Note: although not required, we implemented a chunk compactor, which joins adjacent
-objects, thus reducing memory fragmentation. This introduced a "clean free objects"
-stage into the GC, slowing down the GC in 25%.
+   Memory allocation
+   ~~~~~~~~~~~~~~~~~
 
+The free cells of a slab are chained through their first field. The slabs of a size class that
+have free cells are kept in a list; a slab that gets full leaves the list. When the list of a class
+is empty, an empty slab of any chunk is taken. If there's none, the gc runs and, if no slab becomes
+empty, a new chunk is created.
 
-  Marked Objects
-  ~~~~~~~~~~~~~~
+Objects bigger than SLAB_MAX_OBJECT_SIZE are allocated each one in its own block, prefixed by a
+TSlab with a single cell, and are kept in the large objects list.
 
-During the GC, we need a way to mark reached objects to avoid recursion. For simplicity,
-This space is grabbed from the lower bit in the class member of TObjectProperties. Since
-this is a memory dynamically allocated, we ensure that it starts in an address that never
-uses the lower bit (x&1 == 0), so we can safely use them to our purposes. The value that
-means "marked" is inverted after each gc to prevent unmarking all the objects after they
-are freed.
 
+   Garbage Collector
+   ~~~~~~~~~~~~~~~~~
 
-  Implementation
+First, all the reachable objects are marked, starting from the roots (the static fields of the
+loaded classes, the locked objects and the object registers of all contexts); the objects whose
+fields were not visited yet are kept in a stack, to avoid recursion.
+
+Then the bitmaps of each slab are swept, one word at a time: the bits that are set in live but
+not in marks are the garbage. Their finalizers run, then the cells are put back in the free lists
+and the marks are cleared for the next gc. Slabs that became empty can be used by any size class;
+the chunks that only have empty slabs and the blocks of the dead large objects are given back to
+the system.
+
+
+  Nursery (generational mode)
+  ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+When Vm.tweak(Vm.TWEAK_GENERATIONAL_GC,true) is set, small objects are not taken from the
+slabs: they are carved from a dedicated block, the nursery, by just bumping a pointer. These
+objects have the young bit set. The nursery is a slab whose objects have any size, so its
+bitmaps have one bit per TSIZE bytes.
+
+When the nursery gets exhausted, a minor collection runs. It only marks young objects,
+starting from:
+   - the static fields of the loaded classes;
+   - the locked objects;
+   - the context registers (old objects found there have their fields visited too);
+   - the remembered set: old objects that received a reference to a young object.
+The traversal stops at old objects. The remembered set is filled by the write barrier in the
+MOV_field_regO and MOV_aru_regO opcodes and after each native method returns (its object
+parameters are remembered, because natives store references directly). Static fields need
+no barrier, since they are always roots.
+
+The young objects that survive are promoted in place: the young bit is cleared and they
+are handled as any other object. Dead young objects are finalized and become holes in the
+nursery.
+
+               +--------+----+--------+---------+----+---------------+
+    nursery -> | hole   |old | hole   |  young  |old |  bump region  |
+               +--------+----+--------+---------+----+---------------+
+                                                          ^top         ^limit
+
+After each collection, the space between the live objects of the nursery becomes holes, which are
+chained through their first field. The allocator bumps through the current hole and moves to the
+next one when the object doesn't fit. A full gc promotes all young objects before marking, so it
+works as before.
+
+  Incremental gc
   ~~~~~~~~~~~~~~
 
-To easy the implementation, the array of available blocks of data is splitted into two
-arrays, one containing the used objects, and another containing the free objects, per
-size.
-
-The objects are stored as a doubly-linked list. A new element is always inserted right
-after the head. The last element in the list points to NULL. The previous element
-of the head points to the last element in the list. E.G. ( = pointer to prev, -
-pointer to next):
-
-    += H ----> obj3 ----> obj2 ----> 0
-    |  ^====<===+ ^===<===+ |
-    +==>===========>========+
+When Vm.tweak(Vm.TWEAK_INCREMENTAL_GC,true) is set, the event loop calls gcStep when it is idle.
+After enough memory is allocated, gcStep starts a cycle by setting incrementalMarking and changing
+gcEpoch. The other threads may be between a store and its write barrier, which read incrementalMarking
+before it was set, so the roots are only marked when each thread that runs bytecode acknowledged
+the new epoch at a safepoint (a jump, a call or an allocation), or is running a native method or
+blocked. Each call then visits the marked objects during Settings.gcSliceBudget microseconds. The objects created during the cycle
+are already marked, and the write barrier marks the objects stored in a field or array. When there
+are no more objects to visit, gc2 finishes the cycle: the roots and the locked objects are visited
+again (the registers and the stores done by native methods are not covered by the barrier), and the
+sweep runs as before.
+
+  Parallel gc
+  ~~~~~~~~~~~
+
+When Vm.tweak(Vm.TWEAK_PARALLEL_GC,true) is set and the heap has at least PARALLEL_GC_MIN_HEAP bytes,
+a full gc uses up to GC_MAX_WORKERS threads (one per processor, including the one running the gc).
+The roots are marked by the gc thread, which only pushes their fields; these are then shared among
+the workers. Each worker has a deque of fields to visit: it pushes and pops at the top, and when
+its deque gets empty, it steals the entries at the bottom of the others. Big arrays are split in
+two entries, so their elements can be visited by more than one worker. The mark bits are set with
+a compare-and-swap. The marking ends when all workers are idle at the same time.
+
+The finalizers run in the gc thread, then the chunks are shared among the workers to be swept.
 
 ****************************************************************************************/
 
@@ -129,12 +135,6 @@ pointer to next):
 #define _TRACE_OBJDESTRUCTION 0
 #endif
 
-#ifdef DEBUG_OMM_LIST
-#define _DEBUG_OMM_LIST 1
-#else
-#define _DEBUG_OMM_LIST 0
-#endif
-
 #if defined(ENABLE_TRACE) || defined (DEBUG_OMM_LIST)
 #define COMPUTETIME 1
 #else
@@ -146,21 +146,71 @@ void gc2(Context currentContext, bool lockOMM);
 void soundTone(int32 frequency, int32 duration);
 
 #if (defined(WIN32) && !defined(WINCE)) || defined(darwin) || defined(ANDROID)
-#define DEFAULT_CHUNK_SIZE (1024*1024-48)
+#define DEFAULT_CHUNK_SIZE (1024*1024)
 #else
-#define DEFAULT_CHUNK_SIZE (64*1024-64) 
+#define DEFAULT_CHUNK_SIZE (256*1024)
 #endif
 
-#define MIN_SPACE_LEFT 16
-#define OBJARRAY_MAX_INDEX 128 // 4,8,12,16....4*OBJARRAY_MAX_INDEX
+#define SLAB_SIZE (16*1024) // must be a power of 2
+#define CHUNK_SLABS (DEFAULT_CHUNK_SIZE/SLAB_SIZE)
+#define SLAB_CLASSES 32
+#define SLAB_MAX_OBJECT_SIZE 2048 // bigger objects are allocated in their own block
+#define MAX_OBJECT_SIZE ((1<<28)-1) // limited by TObjectProperties.size
+
+#define NURSERY_SIZE (512*1024)
+#define NURSERY_MAX_OBJECT_SIZE (NURSERY_SIZE/8) // bigger objects are allocated directly in the old space
+
+#define INCREMENTAL_GC_TRIGGER (1024*1024) // bytes allocated since the last gc that start a new incremental cycle
+#define DEFAULT_SLICE_BUDGET 2000 // microseconds
 
-static int32 size2idx(int32 size) // size must exclude sizeof(TObjectProperties) !
+enum
 {
-   int32 index;
-   size = ((size+3)>>2)<<2;
-   index = size>>2;
-   return (index >= OBJARRAY_MAX_INDEX) ? OBJARRAY_MAX_INDEX : index;
-}
+   SLAB_EMPTY,   // not used by any size class
+   SLAB_SMALL,   // cells of a single size class
+   SLAB_LARGE,   // a single object bigger than SLAB_MAX_OBJECT_SIZE
+   SLAB_NURSERY, // young objects of any size
+   SLAB_CHUNK,   // not a slab: the header of a chunk
+   SLAB_DEAD,    // a block that will be given back to the system
+};
+
+struct TSlab
+{
+   uint8 kind;           // must be the first member, see releaseDeadBlock
+   uint8 sizeClass;
+   Slab next;            // in the list of slabs with free cells of its size class, in the list of empty slabs or in the list of large objects
+   SlabChunk chunk;      // the chunk where this slab is; null for the large objects and the nursery
+   uint8* start;         // first cell
+   uint8* freeCells;     // free cells, chained through their first field
+   uint32 cellSize;      // includes the object properties; in the nursery, the size of each bit of the bitmaps
+   uint32 recip;         // 2^32/cellSize rounded up, used to get the index of a cell without a division
+   uint32 cellCount,usedCount;
+   uint32 words;         // number of 32-bit words of each bitmap
+   uint32 *live, *marks, *locks;
+   uint32 bits[3];       // bitmaps of a large object; the other slabs keep theirs right after the header
+};
+
+struct TSlabChunk
+{
+   uint8 kind;           // SLAB_CHUNK; must be the first member, see releaseDeadBlock
+   SlabChunk next;
+   uint8* slabs;         // first slab, aligned at SLAB_SIZE
+   int32 usedSlabs;      // slabs that are not empty
+};
+
+typedef struct
+{
+   uint8* next;
+   uint32 size;
+} THole; // free space in the nursery
+
+#define SLAB_AT(c, i) ((Slab)((c)->slabs + (i)*SLAB_SIZE))
+#define BIT_ISSET(bits, i) (((bits)[(i)>>5] >> ((i)&31)) & 1)
+#define BIT_SET(bits, i) (bits)[(i)>>5] |= 1u << ((i)&31)
+#define BIT_CLEAR(bits, i) (bits)[(i)>>5] &= ~(1u << ((i)&31))
+
+static const uint16 slabClassSizes[SLAB_CLASSES] = {8,16,24,32,40,48,56,64,72,80,88,96,104,112,120,128,160,192,224,256,320,384,448,512,640,768,896,1024,1280,1536,1792,2048};
+static uint8 sizeToClass[SLAB_MAX_OBJECT_SIZE/TSIZE+1];
+static uint32 classCells[SLAB_CLASSES], classStart[SLAB_CLASSES]; // number of cells of a slab of each size class, and the offset of its first cell
 
 typedef struct
 {
@@ -173,14 +223,9 @@ typedef struct
 #define CHUNK2OBJECT(c) (TCObject)(((uint8*)c)+sizeof(TObjectProperties))
 #define OBJECT2CHUNK(o) (Chunk)(((uint8*)o)-sizeof(TObjectProperties))
 
-#define OBJ_MARK(o)         OBJ_PROPERTIES(o)->mark
 #define OBJ_SETLOCKED(o)    OBJ_PROPERTIES(o)->lock = 1
 #define OBJ_SETUNLOCKED(o)  OBJ_PROPERTIES(o)->lock = 0
 
-#ifdef DEBUG_OMM_LIST
-static int32 countObjectsInList(TCObject o, bool dump, int32 mark, int32 *size);
-#endif
-
 #if defined(ENABLE_TEST_SUITE)
 #define CANTRAVERSE canTraverse
 #else
@@ -189,135 +234,463 @@ static int32 countObjectsInList(TCObject o, bool dump, int32 mark, int32 *size);
 
 static Hashtable htP1, htP2;
 
-#ifdef DEBUG_OMM_LIST
-static void dumpList(TCObject o, bool showSize)
+// incremental gc
+static uint32 allocatedSinceGC;
+static bool incrementalRootsMarked; // the cycle started and all threads passed through a safepoint
+static int32 gcTimeMicro; // fraction of gcTime, in microseconds, accumulated by the slices
+
+// large objects
+static uint32 largeAllocatedSinceGC; // bytes allocated in large objects since the last gc
+static uint32 largeObjectsSize; // bytes used by the large objects that survived the last gc
+
+// nursery of the generational mode
+static Slab nursery;                  // the slab that holds the young objects; null if the nursery was not created yet
+static uint8 *nurseryStart, *nurseryEnd; // the space of the nursery's objects
+static uint8 *nurseryTop, *nurseryLimit; // current hole being used by the bump allocator
+static uint8 *nurseryHoles;           // the other holes, in address order
+static TCObject* rememberedSet;       // old objects that may point to young objects
+static int32 rememberedCount, rememberedCapacity;
+static bool rememberedOverflow;       // the remembered set could not grow: the next collection must be a full one
+static int32 minorGCCount;
+
+// parallel gc
+#define GC_MAX_WORKERS 4
+#define PARALLEL_GC_MIN_HEAP (8*1024*1024) // smaller heaps are collected faster by a single thread
+#define MARK_DEQUE_SIZE 2048 // entries in the deque of each worker; must be a power of 2
+#define MARK_SPLIT 64        // arrays with more elements are split, so other workers can take a part
+
+typedef struct
 {
-   TCObject o0 = o;
-   o = OBJ_PROPERTIES(o)->next;
-   debug("G %X<-*%X->%X",OBJ_PROPERTIES(o0)->prev,o0,o);
-   if (o)
-      for (; o != null; o = OBJ_PROPERTIES(o)->next)
-      {
-         debug("G %X<-%X->%X",OBJ_PROPERTIES(o)->prev,o,OBJ_PROPERTIES(o)->next);
-         if (showSize) debug("G size: %d",OBJ_SIZE(o));
-      }
-   debug("G");
+   TObjectsToVisit items[MARK_DEQUE_SIZE];
+   volatile int32 top, bottom; // the owner pushes and pops at the top; the other workers steal from the bottom
+   volatile uint32 lock;
+   Stack overflow;             // entries that didn't fit in the deque; only used by the owner
+} TMarkDeque;
+
+static TMarkDeque* markDeques;  // GC_MAX_WORKERS deques, allocated in the first parallel gc
+static int32 gcWorkers;         // threads used in the current gc
+static bool markInParallel;     // the roots only push their fields, which are visited by the workers
+static volatile uint32 idleWorkers, activeWorkers;
+static volatile bool parallelMarkDone, parallelMarkFailed;
+static volatile uint32 sweepLock;
+static SlabChunk sweepNext;     // next chunk to be swept
+
+static void updatePauseTime(int64 iniT, bool addToGcTime)
+{
+   int32 pause = (int32)(getTimeStampMicro() - iniT);
+   if (tcSettings.gcLastPause)
+      *tcSettings.gcLastPause = pause;
+   if (tcSettings.gcMaxPause && pause > *tcSettings.gcMaxPause)
+      *tcSettings.gcMaxPause = pause;
+   if (addToGcTime) // gcTime is in milliseconds
+   {
+      gcTimeMicro += pause;
+      if (tcSettings.gcTime)
+         *tcSettings.gcTime += gcTimeMicro / 1000;
+      gcTimeMicro %= 1000;
+   }
+}
+
+static int32 bitIndex(uint32 bit) // index of a single bit set, using a de Bruijn sequence
+{
+   static const uint8 debruijn[32] = {0,1,28,2,29,14,24,3,30,22,20,15,25,17,4,8,31,27,13,23,21,19,16,7,26,12,18,6,11,5,10,9};
+   return debruijn[(uint32)(bit * 0x077CB531u) >> 27];
 }
-#endif
 
-static void removeNodeFromDblList(TCObject headObj, TCObject nodeObj)
+static uint32 reciprocal(uint32 cellSize)
 {
-   ObjectProperties node = OBJ_PROPERTIES(nodeObj);
-   ObjectProperties head = OBJ_PROPERTIES(headObj);
-   ObjectProperties nodePrev = OBJ_PROPERTIES(node->prev);
-   ObjectProperties nodeNext = OBJ_PROPERTIES(node->next);
+   return (uint32)((((uint64)1 << 32) + cellSize - 1) / cellSize);
+}
 
-#ifdef DEBUG_OMM_LIST
-   int32 nIni,nEnd;
-   nIni = countObjectsInList(headObj,false,-1,null);
-#endif
+static void initSizeClasses()
+{
+   int32 c,size,n,start,cell;
+   for (c = 0, size = TSIZE; size <= SLAB_MAX_OBJECT_SIZE; size += TSIZE)
+   {
+      while (slabClassSizes[c] < size)
+         c++;
+      sizeToClass[size/TSIZE] = (uint8)c;
+   }
+   for (c = 0; c < SLAB_CLASSES; c++)
+   {
+      cell = slabClassSizes[c] + sizeof(TObjectProperties);
+      for (n = (SLAB_SIZE - sizeof(TSlab)) / cell; ; n--) // the bitmaps also need space
+      {
+         start = (sizeof(TSlab) + 3 * 4 * ((n+31)/32) + TSIZE-1) & ~(TSIZE-1);
+         if (start + n * cell <= SLAB_SIZE)
+            break;
+      }
+      classCells[c] = n;
+      classStart[c] = start;
+   }
+}
 
-   nodePrev->next = node->next;
-   if (node->next) // not the last node?
-      nodeNext->prev = node->prev; // make next one point to our previous node
+/// Returns the slab of the object, and the index of the object's bit in the slab bitmaps
+static Slab getSlab(TCObject o, uint32* index)
+{
+   uint8* p = OBJECT2CHUNK(o);
+   Slab s;
+   if (p >= nurseryStart && p < nurseryEnd)
+      s = nursery;
+   else
+   if (OBJ_SIZE(o) > SLAB_MAX_OBJECT_SIZE)
+      s = ((Slab)p) - 1; // the large objects are right after their slab
    else
-      head->prev = node->prev == headObj ? null : node->prev; // if this is the last node being removed, we must set to null; otherwise, store the pre-last as last
-   node->prev = node->next = null;
+      s = (Slab)((size_t)p & ~(size_t)(SLAB_SIZE-1));
+   *index = (uint32)(((uint64)(uint32)(p - s->start) * s->recip) >> 32);
+   return s;
+}
 
-#ifdef DEBUG_OMM_LIST
-   nEnd = countObjectsInList(headObj,false,-1,null);
-   if (nEnd > 0 && nEnd != (nIni-1))
-      debug("M @@@@@@@ Error while removing node %X! Size should be %d, but is %d (idx = %d)", nodeObj, nIni-1, nEnd, size2idx(OBJ_SIZE(nodeObj)));
-#endif
+static bool isMarked(TCObject o)
+{
+   uint32 i;
+   Slab s = getSlab(o, &i);
+   return BIT_ISSET(s->marks, i);
+}
+
+static bool testAndMark(TCObject o) // marks the object, returning true if it was already marked
+{
+   uint32 i,*w,bit;
+   Slab s = getSlab(o, &i);
+   w = &s->marks[i>>5];
+   bit = 1u << (i & 31);
+   if (*w & bit)
+      return true;
+   *w |= bit;
+   return false;
 }
 
-static void insertNodeInDblList(TCObject headObj, TCObject nodeObj) // insert at the head
+// iteration over the slabs and their objects
+
+typedef struct
+{
+   SlabChunk chunk;
+   int32 index;      // of the next slab in the chunk
+   Slab large;       // next large object
+   bool nurseryDone;
+} TSlabIterator;
+
+enum
 {
-   ObjectProperties node = OBJ_PROPERTIES(nodeObj);
-   ObjectProperties head = OBJ_PROPERTIES(headObj);
+   ITERATE_LIVE,
+   ITERATE_LOCKED,
+   ITERATE_DEAD,     // live objects that were not marked
+   ITERATE_MARKED,   // live objects that were marked
+};
 
-#ifdef DEBUG_OMM_LIST
-   int32 nIni,nEnd;
-   nIni = countObjectsInList(headObj,false,-1,null);
-#endif
+typedef struct
+{
+   TSlabIterator slabs;
+   Slab slab;        // current slab
+   int32 which;      // ITERATE_LIVE, ITERATE_LOCKED, ITERATE_DEAD or ITERATE_MARKED
+   uint32 word,bits; // current word of the bitmap, and its bits that were not returned yet
+} TObjectIterator;
+
+static void iniSlabIterator(TSlabIterator* it)
+{
+   it->chunk = slabChunks;
+   it->index = 0;
+   it->large = largeObjects;
+   it->nurseryDone = false;
+}
 
-   node->next = head->next;
-   head->next = nodeObj;
-   node->prev = headObj;
-   if (!head->prev)
-      head->prev = nodeObj; // make the prev in head point to the last: since all nodes are inserted at the start, the last item is the first inserted
-   if (node->next) // not the first element? tell the element where the head was pointing to, that they now have to point to us
+static Slab nextSlab(TSlabIterator* it) // the slabs of the chunks, then the large objects, then the nursery
+{
+   Slab s;
+   for (; it->chunk != null; it->chunk = it->chunk->next, it->index = 0)
+      while (it->index < CHUNK_SLABS)
+         if ((s = SLAB_AT(it->chunk, it->index++))->kind == SLAB_SMALL)
+            return s;
+   if ((s = it->large) != null)
    {
-      ObjectProperties propsOld = OBJ_PROPERTIES(node->next);
-      propsOld->prev = nodeObj;
+      it->large = s->next;
+      return s;
    }
-
-#ifdef DEBUG_OMM_LIST
-   nEnd = countObjectsInList(headObj, false,-1,null);
-   if (nEnd != (nIni+1))
-      debug("M @@@@@@@ Error while inserting node %X! Size should be %d, but is %d", nodeObj, nIni+1, nEnd);
-#endif
+   if (!it->nurseryDone)
+   {
+      it->nurseryDone = true;
+      if (nursery != null)
+         return nursery;
+   }
+   return null;
 }
 
-static void moveDblList(TCObject srcList, TCObject dstList) // append the src list to the dst list
+static uint32 selectBits(Slab s, int32 which, uint32 word)
 {
-   ObjectProperties src = OBJ_PROPERTIES(srcList);
-   ObjectProperties dst = OBJ_PROPERTIES(dstList);
-   TCObject frstSrcObj = src->next;                       // first object of src list
-   TCObject lastSrcObj = src->prev;                       // last object of src list
-   TCObject lastDstObj = dst->prev ? dst->prev : dstList;  // last object of dst list
-   ObjectProperties frstSrc = OBJ_PROPERTIES(frstSrcObj);
-   ObjectProperties lastDst = OBJ_PROPERTIES(lastDstObj);
+   switch (which)
+   {
+      case ITERATE_LIVE:   return s->live[word];
+      case ITERATE_LOCKED: return s->locks[word];
+      case ITERATE_DEAD:   return s->live[word] & ~s->marks[word];
+      default:             return s->live[word] & s->marks[word];
+   }
+}
 
-#ifdef DEBUG_OMM_LIST
-   int32 b4src,b4dst,afsrc,afdst;
-   b4src = countObjectsInList(srcList,false,-1,null);
-   b4dst = countObjectsInList(dstList,false,-1,null);
-#endif
+static void iniObjectIterator(TObjectIterator* it, int32 which)
+{
+   iniSlabIterator(&it->slabs);
+   it->slab = null;
+   it->which = which;
+   it->word = it->bits = 0;
+}
 
-   frstSrc->prev = lastDstObj;
-   lastDst->next = frstSrcObj;
-   dst->prev     = lastSrcObj;
-   src->next = src->prev = null;
+static void iniSlabObjectIterator(TObjectIterator* it, Slab s, int32 which) // iterates only the objects of the given slab
+{
+   it->slabs.chunk = null;
+   it->slabs.large = null;
+   it->slabs.nurseryDone = true;
+   it->slab = s;
+   it->which = which;
+   it->word = 0;
+   it->bits = selectBits(s, which, 0);
+}
 
-#ifdef DEBUG_OMM_LIST
-   afsrc = countObjectsInList(srcList,false,-1,null);
-   afdst = countObjectsInList(dstList,false,-1,null);
-   if ((afsrc + afdst) != (b4src + b4dst))
+static TCObject nextObject(TObjectIterator* it)
+{
+   uint32 bit;
+   while (it->bits == 0)
    {
-      debug("M @@@@@@@ moveDblList failed! %d != %d",(afsrc+afdst) , (b4src+b4dst));
-      countObjectsInList(dstList,true,-1,null);
+      if (it->slab == null || ++it->word >= it->slab->words)
+      {
+         if ((it->slab = nextSlab(&it->slabs)) == null)
+            return null;
+         it->word = 0;
+      }
+      it->bits = selectBits(it->slab, it->which, it->word);
    }
-#endif
+   bit = it->bits & (~it->bits + 1); // lowest bit set
+   it->bits ^= bit;
+   return CHUNK2OBJECT(it->slab->start + ((it->word << 5) + bitIndex(bit)) * it->slab->cellSize);
 }
 
-static bool createChunk(uint32 size)
+static void clearMarks()
 {
-   Chunk chunk;
-   TCObject o;
+   TSlabIterator it;
+   Slab s;
+   iniSlabIterator(&it);
+   while ((s = nextSlab(&it)) != null)
+      xmemzero(s->marks, s->words * 4);
+}
+
+static bool createChunk()
+{
+   SlabChunk c;
+   Slab s;
+   int32 i;
    IF_HEAP_ERROR(chunksHeap)
       return false;
 
-   chunk = heapAlloc(chunksHeap, size+sizeof(TObjectProperties));
-   o = CHUNK2OBJECT(chunk);
-   xmemzero(OBJ_PROPERTIES(o),sizeof(TObjectProperties));
-   OBJ_SIZE(o) = size;
-   insertNodeInDblList(freeList[OBJARRAY_MAX_INDEX], o);
-   if (tcSettings.chunksCreated) 
+   c = (SlabChunk)heapAlloc(chunksHeap, sizeof(TSlabChunk) + (CHUNK_SLABS+1) * SLAB_SIZE); // one more slab to align them
+   xmemzero(c, sizeof(TSlabChunk));
+   c->kind = SLAB_CHUNK;
+   c->slabs = (uint8*)(((size_t)(c+1) + SLAB_SIZE-1) & ~(size_t)(SLAB_SIZE-1));
+   for (i = CHUNK_SLABS; --i >= 0;)
+   {
+      s = SLAB_AT(c, i);
+      xmemzero(s, sizeof(TSlab));
+      s->kind = SLAB_EMPTY;
+      s->chunk = c;
+      s->next = emptySlabs;
+      emptySlabs = s;
+   }
+   c->next = slabChunks;
+   slabChunks = c;
+   if (tcSettings.chunksCreated)
       (*tcSettings.chunksCreated)++; // caution: ++ has precedence over *
 
 #if defined(TRACE_OBJCREATION) || defined(DEBUG_OMM_LIST) || defined(ENABLE_TRACE)
-   debug("M +++ %2d Created chunk %X size %d, first obj: %X",tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1,chunk,size, o);
+   debug("M +++ %2d Created chunk %X with %d slabs",tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1,c,CHUNK_SLABS);
 #endif
    return true;
 }
 
+static void initSlab(Slab s, int32 sizeClass) // prepares an empty slab to serve the given size class
+{
+   uint32 i, cellSize = slabClassSizes[sizeClass] + sizeof(TObjectProperties);
+   uint8* cell;
+   s->kind = SLAB_SMALL;
+   s->sizeClass = (uint8)sizeClass;
+   s->next = null;
+   s->cellSize = cellSize;
+   s->recip = reciprocal(cellSize);
+   s->cellCount = classCells[sizeClass];
+   s->usedCount = 0;
+   s->words = (s->cellCount + 31) / 32;
+   s->live = (uint32*)(s+1);
+   s->marks = s->live + s->words;
+   s->locks = s->marks + s->words;
+   xmemzero(s->live, s->words * 3 * 4);
+   s->start = ((uint8*)s) + classStart[sizeClass];
+   s->freeCells = null;
+   for (i = s->cellCount, cell = s->start + (i-1) * cellSize; i-- > 0; cell -= cellSize) // chain the cells in address order
+   {
+      OBJ_CLASS(CHUNK2OBJECT(cell)) = null;
+      *(uint8**)CHUNK2OBJECT(cell) = s->freeCells;
+      s->freeCells = cell;
+   }
+   s->chunk->usedSlabs++;
+}
+
+static TCObject allocSmallObject(uint32 size) // returns null if there are no free cells of this size nor empty slabs
+{
+   int32 c = sizeToClass[size/TSIZE];
+   Slab s = partialSlabs[c];
+   uint8* cell;
+   TCObject o;
+   if (s == null)
+   {
+      if ((s = emptySlabs) == null)
+         return null;
+      emptySlabs = s->next;
+      initSlab(s, c);
+      partialSlabs[c] = s;
+   }
+   cell = s->freeCells;
+   o = CHUNK2OBJECT(cell);
+   s->freeCells = *(uint8**)o;
+   if (++s->usedCount == s->cellCount) // full? remove from the list
+      partialSlabs[c] = s->next;
+   xmemzero(cell, sizeof(TObjectProperties));
+   OBJ_SIZE(o) = slabClassSizes[c];
+   return o;
+}
+
+static TCObject allocLargeObject(uint32 size) // returns null if there's no memory
+{
+   Slab s;
+   TCObject o;
+   IF_HEAP_ERROR(chunksHeap)
+      return null;
+   s = (Slab)heapAlloc(chunksHeap, sizeof(TSlab) + sizeof(TObjectProperties) + size);
+   xmemzero(s, sizeof(TSlab) + sizeof(TObjectProperties));
+   s->kind = SLAB_LARGE;
+   s->start = (uint8*)(s+1);
+   s->cellSize = sizeof(TObjectProperties) + size;
+   s->cellCount = s->usedCount = s->words = 1;
+   s->live = &s->bits[0];
+   s->marks = &s->bits[1];
+   s->locks = &s->bits[2];
+   s->next = largeObjects;
+   largeObjects = s;
+   largeAllocatedSinceGC += size;
+   o = CHUNK2OBJECT(s->start);
+   OBJ_SIZE(o) = size;
+   return o;
+}
+
+static bool createNursery()
+{
+   Slab s;
+   uint32 words = NURSERY_SIZE/TSIZE/32, header = (sizeof(TSlab) + 3 * 4 * words + TSIZE-1) & ~(TSIZE-1);
+   IF_HEAP_ERROR(chunksHeap)
+      return false;
+
+   s = (Slab)heapAlloc(chunksHeap, header + NURSERY_SIZE);
+   xmemzero(s, header);
+   s->kind = SLAB_NURSERY;
+   s->start = ((uint8*)s) + header;
+   s->cellSize = TSIZE;
+   s->recip = reciprocal(TSIZE);
+   s->cellCount = NURSERY_SIZE/TSIZE;
+   s->words = words;
+   s->live = (uint32*)(s+1);
+   s->marks = s->live + words;
+   s->locks = s->marks + words;
+   nursery = s;
+   nurseryStart = nurseryTop = s->start;
+   nurseryEnd = nurseryLimit = s->start + NURSERY_SIZE;
+   nurseryHoles = null;
+   if (tcSettings.chunksCreated)
+      (*tcSettings.chunksCreated)++;
+   return true;
+}
+
+static bool minorGC(Context currentContext);
+
+static TCObject allocYoungObject(Context currentContext, uint32 size)
+{
+   uint32 total = size + sizeof(TObjectProperties);
+   bool collected = false;
+   if (nursery == null && !createNursery())
+      return null;
+   while (true)
+   {
+      if ((uint32)(nurseryLimit - nurseryTop) >= total)
+      {
+         TCObject o = CHUNK2OBJECT(nurseryTop);
+         uint32 remaining = (uint32)(nurseryLimit - nurseryTop) - total;
+         if (remaining < sizeof(TObjectProperties)+TSIZE) // not enough space to create another minimum object? absorb it
+            size += remaining;
+         nurseryTop += sizeof(TObjectProperties) + size;
+         xmemzero(OBJ_PROPERTIES(o),sizeof(TObjectProperties));
+         OBJ_SIZE(o) = size;
+         OBJ_PROPERTIES(o)->young = 1;
+         nursery->usedCount++;
+         return o;
+      }
+      if (nurseryHoles != null) // move to the next hole
+      {
+         THole* hole = (THole*)nurseryHoles;
+         nurseryTop = nurseryHoles;
+         nurseryLimit = nurseryHoles + hole->size;
+         nurseryHoles = hole->next;
+      }
+      else
+      if (collected || !minorGC(currentContext)) // nursery is full: allocate in the old space
+         return null;
+      else
+         collected = true;
+   }
+}
+
+TC_API void rememberObject(TCObject holder)
+{
+   LOCKVAR(omm);
+   if (!OBJ_PROPERTIES(holder)->remembered && !OBJ_ISYOUNG(holder) && !rememberedOverflow)
+   {
+      if (rememberedCount == rememberedCapacity)
+      {
+         int32 newCapacity = rememberedCapacity == 0 ? 256 : rememberedCapacity * 2;
+         TCObject* newSet = (TCObject*)xrealloc((uint8*)rememberedSet, newCapacity * sizeof(TCObject));
+         if (newSet == null)
+         {
+            rememberedOverflow = true;
+            goto end;
+         }
+         rememberedSet = newSet;
+         rememberedCapacity = newCapacity;
+      }
+      rememberedSet[rememberedCount++] = holder;
+      OBJ_PROPERTIES(holder)->remembered = 1;
+   }
+end:
+   UNLOCKVAR(omm);
+}
+
+static void clearRememberedSet()
+{
+   int32 i;
+   for (i = 0; i < rememberedCount; i++)
+      OBJ_PROPERTIES(rememberedSet[i])->remembered = 0;
+   rememberedCount = 0;
+   rememberedOverflow = false;
+}
+
+static void promoteYoungObjects() // makes all young objects old, without collecting them
+{
+   TObjectIterator it;
+   TCObject o;
+   if (nursery == null)
+      return;
+   iniSlabObjectIterator(&it, nursery, ITERATE_LIVE);
+   while ((o = nextObject(&it)) != null)
+      OBJ_PROPERTIES(o)->young = 0;
+}
+
 static Hashtable htObjsPerClass;
 
 bool initObjectMemoryManager()
 {
-   int32 i,skip = sizeof(TObjectProperties), size = skip+TSIZE, n = OBJARRAY_MAX_INDEX+1;
-   uint8 *f, *u, *l;
    ommHeap = heapCreate();
    chunksHeap = heapCreate();
    if (chunksHeap == null) return false;
@@ -326,65 +699,52 @@ bool initObjectMemoryManager()
       heapDestroy(ommHeap);
       return false;
    }
-
-   f = heapAlloc(ommHeap, size * n); // here we alloc the whole block of objects
-   u = heapAlloc(ommHeap, size * n);
-   l = heapAlloc(ommHeap, size * 1); // the locked list is a single array
-   f += skip;
-   u += skip;
-   l += skip;
-   freeList = newPtrArrayOf(TCObject,n,ommHeap);
-   usedList = newPtrArrayOf(TCObject,n,ommHeap);
-   lockList = newPtrArrayOf(TCObject,1,ommHeap);
-   lockList[0] = (TCObject)l;
-   for (i =0; i < n; i++) // and now we just assign the starting pointer of each block
-   {
-      freeList[i] = (TCObject)f; f += size;
-      usedList[i] = (TCObject)u; u += size;
-   }
-   markedAsUsed = 1;
+   initSizeClasses();
+   partialSlabs = (Slab*)heapAlloc(ommHeap, SLAB_CLASSES * sizeof(Slab));
+   slabChunks = null;
+   emptySlabs = largeObjects = null;
    objStack = newStack(2048, sizeof(TObjectsToVisit), null); // must be > 1k!
-   return objStack != null && createChunk(DEFAULT_CHUNK_SIZE); // create the first chunk
+   return objStack != null && createChunk(); // create the first chunk
 }
 
 void destroyObjectMemoryManager()
 {
    if (IS_VMTWEAK_ON(VMTWEAK_DUMP_MEMORY_STATS))
-      debug("M Times gc was called: %d. Total gc time: %d. Chunks created: %d. Max allocated: %d",tcSettings.gcCount ? *tcSettings.gcCount : 0, tcSettings.gcTime ? *tcSettings.gcTime : 0, tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1, maxAllocated);
+      debug("M Times gc was called: %d (minor: %d). Total gc time: %d. Max pause: %d us. Chunks created: %d. Max allocated: %d",tcSettings.gcCount ? *tcSettings.gcCount : 0, minorGCCount, tcSettings.gcTime ? *tcSettings.gcTime : 0, tcSettings.gcMaxPause ? *tcSettings.gcMaxPause : 0, tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1, maxAllocated);
    stackDestroy(objStack);
+   if (markDeques != null)
+   {
+      int32 i;
+      for (i = 0; i < GC_MAX_WORKERS; i++)
+         if (markDeques[i].overflow != null)
+            stackDestroy(markDeques[i].overflow);
+      markDeques = null; // allocated in the ommHeap
+   }
+   xfree(rememberedSet);
+   rememberedCount = rememberedCapacity = 0;
+   nursery = null;
+   nurseryStart = nurseryEnd = nurseryTop = nurseryLimit = nurseryHoles = null;
+   slabChunks = null;
+   emptySlabs = largeObjects = null;
+   partialSlabs = null;
+   largeAllocatedSinceGC = largeObjectsSize = 0;
    heapDestroy(chunksHeap);
    heapDestroy(ommHeap);
 }
 
-static TCObject allocObjWith(uint32 size)
-{
-   TCObject o=null;
-   uint32 idx = size2idx(size);
-   if (idx == OBJARRAY_MAX_INDEX || (o=OBJ_PROPERTIES(freeList[idx])->next) == null) // if this is the max index, or there's no free objects in the current index, try on the highest index
-   {
-      for (o = OBJ_PROPERTIES(freeList[OBJARRAY_MAX_INDEX])->next; o != null; o = OBJ_PROPERTIES(o)->next)
-         if (OBJ_SIZE(o) >= size)
-            return o;
-      o = null;
-      // check if there's someone at a higher index. This fragments memory, but avoids the allocation of one more chunk
-      while (++idx < OBJARRAY_MAX_INDEX)
-         if ((o = OBJ_PROPERTIES(freeList[idx])->next) != null)
-            return o;
-   }
-   return o;
-}
-
 extern bool iosLowMemory;
 static int32 consecutiveSkips;
+static int32 allocSampleCountdown; // bytes to be allocated until the allocation profiler takes the next sample
 
 static TCObject allocObject(Context currentContext, uint32 size, TCClass cls, int32 alen)
 {
    TCObject o = null;
    ObjectProperties op;
+   bool large, sampled = false;
 
 #ifdef darwin
    if (iosLowMemory/* && size > 1024*/)
-   {    
+   {
       iosLowMemory = false;
       debug("IOS low memory. Free: %d",getFreeMemory(0));
       //iosLowMemory = getFreeMemory(0) <= 10*1024*1024;
@@ -404,69 +764,62 @@ static TCObject allocObject(Context currentContext, uint32 size, TCClass cls, in
    if (size < TSIZE)
       size = TSIZE;
    size = ((size+TSIZE-1)>>TSHIFT)<<TSHIFT; // make power of SIZE_T
+   if (size > MAX_OBJECT_SIZE)
+   {
+      throwException(currentContext, OutOfMemoryError, "Object too big.");
+      return null;
+   }
+   large = size > SLAB_MAX_OBJECT_SIZE;
 
+   GC_SAFEPOINT(currentContext); // the thread may block here
    LOCKVAR(omm);
-   o = allocObjWith(size);
-   if (!o) // no more memory to create this object? Run the GC to free up memory
+   if (size <= NURSERY_MAX_OBJECT_SIZE && IS_VMTWEAK_ON(VMTWEAK_GENERATIONAL_GC) && !incrementalMarking)
+      o = allocYoungObject(currentContext, size);
+   if (!o)
    {
-      if (size < 1024*1024 || ++consecutiveSkips > 16)
+      if (!large)
+         o = allocSmallObject(size);
+      // no free cell for this object, or too much memory allocated in large objects? Run the GC to free up memory
+      if (!o && (!large || largeAllocatedSinceGC >= max32(DEFAULT_CHUNK_SIZE, largeObjectsSize)) && (size < 1024*1024 || ++consecutiveSkips > 16))
       {
          #ifndef ENABLE_TEST_SUITE // test suite requires that no gc is run in this case - just create the chunk directly
          gc2(currentContext,false);
-         o = allocObjWith(size);
+         if (!large)
+            o = allocSmallObject(size);
          #endif
       }
       if (!o)
       {
-         // still no memory? allocate a new chunk and place it at the OBJARRAY_MAX_INDEX
-         if (!createChunk(size > DEFAULT_CHUNK_SIZE ? size : DEFAULT_CHUNK_SIZE))
+         // still no memory? allocate a new chunk, or the block of the large object
+         if (large)
+            o = allocLargeObject(size);
+         else
+         if (createChunk())
+            o = allocSmallObject(size);
+         if (!o)
          {
             if (COMPUTETIME) alert("out of memory!");
             throwException(currentContext, OutOfMemoryError, null);
             goto end; // no more memory at all, quit.
          }
-         o = allocObjWith(size);
       }
    }
-   // found a free object?
    if (o)
    {
-      uint32 oSize, oldIdx;
-      int32 objectBytesRemaining; // may be < 0 !
+      uint32 idx;
+      Slab s = getSlab(o, &idx);
+      size = OBJ_SIZE(o); // the size class or the end of a hole may be bigger than the requested size
       op = OBJ_PROPERTIES(o);
-      oSize = OBJ_SIZE(o);
-      oldIdx = size2idx(oSize);
-
+      op->monitor = 0;
       objCreated++;
-      //debug("G alloc obj size %d : %X (idx %d -> %d)",size, o, oldIdx,newIdx);
-      // set as not marked
-      OBJ_MARK(o) = !markedAsUsed;
-      if (_TRACE_OBJCREATION) debug("G %X setting mark to %d at allocObject", o, OBJ_MARK(o));
-      // remove the Object from the free list
-      removeNodeFromDblList(freeList[oldIdx], o);
-
-      if (oSize > size)
-      {
-         objectBytesRemaining = (int32)oSize - (int32)size - sizeof(TObjectProperties);
-         if (objectBytesRemaining >= MIN_SPACE_LEFT) // is there enough space to create another minimum object?
-         {
-            // make the rest of this object a free object
-            Chunk startOfNextChunk = ((uint8*)o) + size;
-            TCObject oremain = CHUNK2OBJECT(startOfNextChunk);
-            uint32 ridx = size2idx(objectBytesRemaining);
-            xmemzero(OBJ_PROPERTIES(oremain),sizeof(TObjectProperties));
-            OBJ_SIZE(oremain) = objectBytesRemaining;
-            insertNodeInDblList(freeList[ridx], oremain);
-            if (_TRACE_OBJCREATION) debug("G Allocd: %5d. Remaining object: %X with size %d at index %d. lock: %d. context: %X",size,oremain,objectBytesRemaining,ridx,OBJ_ISLOCKED(oremain),currentContext);
-            // and put it in the used list
-         }
-         else size = oSize; // not enough memory remains in the object, so keep the old size
-      }
-      OBJ_SIZE(o) = size;
+      allocatedSinceGC += size;
+      BIT_SET(s->live, idx);
+      if (incrementalMarking) // the objects created during an incremental cycle are already marked
+         BIT_SET(s->marks, idx);
 
       // objects are always locked
       OBJ_SETLOCKED(o);
-      insertNodeInDblList(lockList[0], o);
+      BIT_SET(s->locks, idx);
       objLocked++;
 
       if (_TRACE_OBJCREATION) debug("G Object %X locked",o);
@@ -474,9 +827,16 @@ static TCObject allocObject(Context currentContext, uint32 size, TCClass cls, in
       xmemzero(o, size);
       if (alen >= 0) ARRAYOBJ_LEN(o) = alen;
       OBJ_CLASS(o) = cls;
+      if (allocSampleInterval != 0 && (allocSampleCountdown -= (int32)size) <= 0)
+      {
+         allocSampleCountdown = allocSampleInterval;
+         sampled = true;
+      }
    }
 end:
    UNLOCKVAR(omm);
+   if (sampled)
+      takeAllocationSample(currentContext, cls, size);
    return o;
 }
 
@@ -500,7 +860,7 @@ static TCObject privateCreateObject(Context currentContext, CharP className, boo
       htInc(&htObjsPerClass, (int32)c, 1);
    }
 
-   if (_TRACE_OBJCREATION) debug("G %X obj created %s of size %d at %d. lock: %d. mark: %d. context: %X", o, className, objectSize, size2idx(objectSize), OBJ_ISLOCKED(o), markedAsUsed, currentContext);
+   if (_TRACE_OBJCREATION) debug("G %X obj created %s of size %d. lock: %d. context: %X", o, className, objectSize, OBJ_ISLOCKED(o), currentContext);
 
    if (callDefaultConstructor)
    {
@@ -545,7 +905,7 @@ TCObject createArrayObject(Context currentContext, CharP type, int32 len)
       if (!htObjsPerClass.items) htObjsPerClass = htNew(511, null);
       htInc(&htObjsPerClass, (int32)c, 1);
    }
-   if (_TRACE_OBJCREATION) debug("G %X array obj created %s len %d, size = %d at %d. lock: %d", o, c->name,len, objectSize, size2idx(objectSize), OBJ_ISLOCKED(o));
+   if (_TRACE_OBJCREATION) debug("G %X array obj created %s len %d, size = %d. lock: %d", o, c->name,len, objectSize, OBJ_ISLOCKED(o));
 end:
    return o;
 }
@@ -573,7 +933,10 @@ TCObject createArrayObjectMulti(Context currentContext, CharP type, int32 count,
          if ((*oa = createArrayObjectMulti(currentContext, type+1, count-1, dims == null ? null : dims+1, dims == null ? regI+1 : regI)) == null)
             return null;
          else
+         {
+            WRITE_BARRIER(o, *oa);
             setObjectLock(*oa, UNLOCKED);
+         }
    }
    return o;
 }
@@ -585,16 +948,82 @@ TCObject createStringObjectWithLen(Context currentContext, int32 len)
    if (str)
    {
       String_chars(str) = createCharArray(currentContext, len);
+      WRITE_BARRIER(str, String_chars(str));
+      if (String_chars(str) != null)
+         setObjectLock(String_chars(str), UNLOCKED);
+   }
+   return (str && String_chars(str)) ? str : null;
+}
+
+TCObject createLatin1StringObjectWithLen(Context currentContext, int32 len)
+{
+   TCObject str;
+   str = createObjectWithoutCallingDefaultConstructor(currentContext, "java.lang.String");
+   if (str)
+   {
+      String_chars(str) = createByteArray(currentContext, len);
+      WRITE_BARRIER(str, String_chars(str));
       if (String_chars(str) != null)
          setObjectLock(String_chars(str), UNLOCKED);
    }
    return (str && String_chars(str)) ? str : null;
 }
 
+TC_API JCharP widenString(Context currentContext, TCObject str)
+{
+   TCObject chars;
+   uint8* src;
+   JCharP start, dst;
+   int32 len;
+   if (!String_isLatin1(str))
+      return String_charsStart(str);
+   if (currentContext->widenedCount == currentContext->widenedMax)
+   {
+      int32 max = currentContext->widenedMax == 0 ? 8 : currentContext->widenedMax * 2;
+      TCObject* widened = (TCObject*)xrealloc((uint8*)currentContext->widened, max * TSIZE);
+      if (widened == null)
+      {
+         throwException(currentContext, OutOfMemoryError, null);
+         return null;
+      }
+      currentContext->widened = widened;
+      currentContext->widenedMax = max;
+   }
+   len = String_charsLen(str);
+   if ((chars = createCharArray(currentContext, len)) == null) // the OutOfMemoryError was already thrown
+      return null;
+   currentContext->widened[currentContext->widenedCount++] = chars; // kept locked until the native returns
+   for (src = String_latin1Start(str), start = dst = (JCharP)ARRAYOBJ_START(chars); len-- > 0;)
+      *dst++ = *src++;
+   return start;
+}
+
+void releaseWidenedStrings(Context currentContext, int32 count)
+{
+   while (currentContext->widenedCount > count)
+      setObjectLock(currentContext->widened[--currentContext->widenedCount], UNLOCKED);
+}
+
+static bool fitsLatin1(JCharP chars, int32 len)
+{
+   for (; len-- > 0; chars++)
+      if (*chars > 0xFF)
+         return false;
+   return true;
+}
+
 TCObject createStringObjectFromJCharP(Context currentContext, JCharP srcChars, int32 len)
 {
    TCObject str;
    if (len < 0) len = JCharPLen(srcChars);
+   if (IS_VMTWEAK_ON(VMTWEAK_COMPACT_STRINGS) && fitsLatin1(srcChars, len))
+   {
+      uint8* dst;
+      if ((str = createLatin1StringObjectWithLen(currentContext, len)) != null)
+         for (dst = String_latin1Start(str); len-- > 0;)
+            *dst++ = (uint8)*srcChars++;
+      return str;
+   }
    str = createStringObjectWithLen(currentContext, len);
    if (str)
       xmemmove(ARRAYOBJ_START(String_chars(str)), srcChars, len<<1);
@@ -603,22 +1032,12 @@ TCObject createStringObjectFromJCharP(Context currentContext, JCharP srcChars, i
 
 TCObject createStringObjectFromTCHARP(Context currentContext, TCHARP srcChars, int32 len)
 {
-#if !defined (WINCE)
-   JCharP dst;
-#endif
-   TCObject str;
-   if (len < 0) len = tcslen(srcChars);
-   if ((str = createStringObjectWithLen(currentContext, len)) != null)
-   {
 #if defined (WINCE)
-      xmemmove(ARRAYOBJ_START(String_chars(str)), srcChars, len<<1);
+   if (len < 0) len = tcslen(srcChars);
+   return createStringObjectFromJCharP(currentContext, (JCharP)srcChars, len);
 #else
-      dst = (JCharP)ARRAYOBJ_START(String_chars(str));
-      while (len-- > 0)
-         *dst++ = (JChar)(*srcChars++ & 0xFF);
+   return createStringObjectFromCharP(currentContext, srcChars, len);
 #endif
-   }
-   return str;
 }
 
 TCObject createStringObjectFromCharP(Context currentContext, CharP srcChars, int32 len)
@@ -626,6 +1045,12 @@ TCObject createStringObjectFromCharP(Context currentContext, CharP srcChars, int
    JCharP dst;
    TCObject str;
    if (len < 0) len = xstrlen(srcChars);
+   if (IS_VMTWEAK_ON(VMTWEAK_COMPACT_STRINGS)) // the chars are always Latin-1
+   {
+      if ((str = createLatin1StringObjectWithLen(currentContext, len)) != null)
+         xmemmove(String_latin1Start(str), srcChars, len);
+      return str;
+   }
    str = createStringObjectWithLen(currentContext, len);
    if (str == null)
       return null;
@@ -635,96 +1060,111 @@ TCObject createStringObjectFromCharP(Context currentContext, CharP srcChars, int
    return str;
 }
 
-TC_API void setObjectLock(TCObject o, LockState lock)
+static bool getObjectFields(TCObject o, TObjectsToVisit* objs) // gets the object fields (or array elements) to be visited; returns false if there are none
 {
-   int32 size,idx;
-   if (o == null) return;
-   LOCKVAR(omm);
-   size = OBJ_SIZE(o);
-   idx = size2idx(size);
-   if (lock == LOCKED)
+   TCClass c = OBJ_CLASS(o);
+   if (c == null)
+      return false;
+   if (c->flags.isObjectArray)
    {
-      if (OBJ_ISLOCKED(o))
-         alert("FATAL ERROR: OBJECT %X (%s) IS BEING LOCKED BUT IT IS ALREADY LOCKED!", o, OBJ_CLASS(o)->name);
-      OBJ_SETLOCKED(o);
-      // remove from the used list
-      removeNodeFromDblList(usedList[idx], o);
-      insertNodeInDblList(lockList[0], o);
-      objLocked++;
+      objs->start = (TCObjectArray)ARRAYOBJ_START(o);
+      objs->n = ARRAYOBJ_LEN(o);
    }
    else
+   if (c->objInstanceFields != null)
    {
-      if (!OBJ_ISLOCKED(o))
-         alert("FATAL ERROR: OBJECT %X (%s) IS BEING UNLOCKED BUT IT IS ALREADY UNLOCKED!", o, OBJ_CLASS(o)->name);
-      OBJ_SETUNLOCKED(o);
-      // add it back to the used list
-      removeNodeFromDblList(lockList[0], o);
-      insertNodeInDblList(usedList[idx], o);
-      objLocked--;
+      objs->start = (TCObjectArray)FIELD_OBJ_OFFSET(o,c);
+      objs->n = (int32)((TCObjectArray)FIELD_V64_OFFSET(o,c) - objs->start);
    }
-   OBJ_MARK(o) = !markedAsUsed;
-   //if (_TRACE_OBJCREATION) debug("G %s object %X class %s. mark: %d",lock == LOCKED ? "locking" : "unlocking", o, OBJ_CLASS(o)->name, OBJ_MARK(o));
-   UNLOCKVAR(omm);
+   else
+      return false;
+   return objs->n > 0;
 }
 
-CharP getSpaces(Context currentContext, int32 n);
-static void markSingleObject(TCObject o, bool dump) // NEVER call this directly, unless the Object has no instance fields nor is an array
+static void pushObjectFields(TCObject o) // pushes the object fields (or array elements) to be visited
 {
-   TCClass c;
    TObjectsToVisit objs;
-   if (OBJ_PROPERTIES(o) == null)
-   {
-      debug("****** props is null: %X",o);
-      return;
-   }
+   if (getObjectFields(o, &objs))
+      stackPush(objStack, &objs);
+}
 
-   c = OBJ_CLASS(o);
-   if (c == null)
-   {
-      debug("****** class is null: %X",o);
+
+static void abortIncrementalGC() // leaves all objects alive; they will be collected by the next gc
+{
+   TObjectsToVisit objs;
+   while (stackPop(objStack, &objs)) {}
+   clearMarks();
+   incrementalMarking = false;
+}
+
+static void regreyObject(TCObject o) // pushes the fields of an object changed without a write barrier during an incremental cycle
+{
+   IF_HEAP_ERROR(objStack->heap)
+   {
+      abortIncrementalGC();
       return;
    }
-   if (OBJ_MARK(o) == markedAsUsed) // don't remove! this test is important
-      return;
-   // mark as used to avoid infinite recursion
-   OBJ_MARK(o) = markedAsUsed;
-   //if (_TRACE_OBJCREATION) debug("G %X setting mark to %d at markSingleObject", o, OBJ_MARK(o));
-   if (!OBJ_ISLOCKED(o)) // locked objects can't be revived, since they are not in the used/free lists
-   {
-      // "revive" the object
-      int32 size,idx;
-//      if (dump) //strEq(c->name,"totalcross.db.sqlite.RS")) 
-//         debug("!!! %s marking %X: %s",getSpaces(mainContext,dump),o,OBJ_CLASS(o)->name);
-      size = OBJ_SIZE(o);
-      idx = size2idx(size);
-      // remove from the free list
-      removeNodeFromDblList(freeList[idx], o);
-      // and put it in the used list
-      insertNodeInDblList(usedList[idx], o);
-      if (_TRACE_OBJCREATION) debug("G Object revived: %X (%s). mark: %d",o, OBJ_CLASS(o)->name, OBJ_MARK(o));
-   }
-   // if this object is an array, and the elements are objects (or arrays), then push them to be marked later
-   if (c->flags.isObjectArray) // array of objects or array of arrays?
-   {
-      objs.start = (TCObjectArray)ARRAYOBJ_START(o);
-      if (objs.start != null && (objs.n = ARRAYOBJ_LEN(o)) > 0)
-         stackPush(objStack, &objs);
+   pushObjectFields(o);
+}
+
+TC_API void setObjectLock(TCObject o, LockState lock)
+{
+   uint32 idx;
+   Slab s;
+   if (o == null) return;
+   LOCKVAR(omm);
+   s = getSlab(o, &idx);
+   if (lock == LOCKED)
+   {
+      if (OBJ_ISLOCKED(o))
+         alert("FATAL ERROR: OBJECT %X (%s) IS BEING LOCKED BUT IT IS ALREADY LOCKED!", o, OBJ_CLASS(o)->name);
+      OBJ_SETLOCKED(o);
+      BIT_SET(s->locks, idx);
+      objLocked++;
    }
-   else // else, mark the instance fields of this object (note that arrays have no object instance fields)
-   if (c->objInstanceFields != null)
+   else
    {
-      objs.start = (TCObjectArray)FIELD_OBJ_OFFSET(o,c);
-      objs.n = (int32)((TCObjectArray)FIELD_V64_OFFSET(o,c) - objs.start); // the object fields ends where the 64-bit ones start.
-      stackPush(objStack, &objs);
+      if (!OBJ_ISLOCKED(o))
+         alert("FATAL ERROR: OBJECT %X (%s) IS BEING UNLOCKED BUT IT IS ALREADY UNLOCKED!", o, OBJ_CLASS(o)->name);
+      OBJ_SETUNLOCKED(o);
+      BIT_CLEAR(s->locks, idx);
+      // native methods fill the objects they create while locked, so this one may point to young objects
+      if (nursery != null && !OBJ_ISYOUNG(o) && !OBJ_PROPERTIES(o)->remembered && (OBJ_CLASS(o)->flags.isObjectArray || OBJ_CLASS(o)->objInstanceFields != null))
+         rememberObject(o);
+      objLocked--;
+   }
+   if (incrementalMarking) // the object is marked now, but its fields may have been changed without a write barrier
+   {
+      BIT_SET(s->marks, idx);
+      regreyObject(o);
    }
+   //if (_TRACE_OBJCREATION) debug("G %s object %X class %s",lock == LOCKED ? "locking" : "unlocking", o, OBJ_CLASS(o)->name);
+   UNLOCKVAR(omm);
 }
 
-static void markObjects(TCObject o, bool dump)
+CharP getSpaces(Context currentContext, int32 n);
+static void markSingleObject(TCObject o, bool dump) // NEVER call this directly, unless the Object has no instance fields nor is an array
 {
-   TObjectsToVisit objs;
+   TCClass c = OBJ_CLASS(o);
+   if (c == null)
+   {
+      debug("****** class is null: %X",o);
+      return;
+   }
+   if (testAndMark(o)) // don't remove! this test is important: marking avoids infinite recursion
+      return;
+//   if (dump) //strEq(c->name,"totalcross.db.sqlite.RS"))
+//      debug("!!! %s marking %X: %s",getSpaces(mainContext,dump),o,OBJ_CLASS(o)->name);
+   // if this object is an array, and the elements are objects (or arrays), then push them to be marked later.
+   // else, mark the instance fields of this object (note that arrays have no object instance fields)
+   pushObjectFields(o);
+}
 
-   if (!o) return; // can occurr if concorrent threads are accessing the structure where this object is
-   markSingleObject(o,dump);
+static bool visitMarkStack(bool dump, int64 deadline) // deadline is in microseconds, or 0 to visit all objects. Returns true if there are no more objects to visit
+{
+   TObjectsToVisit objs;
+   TCObject o;
+   int32 n = 0;
 
    // Here we will mark recursively all objects inside this one.
    // First we go through all fields and array values (if applicable),
@@ -740,7 +1180,55 @@ static void markObjects(TCObject o, bool dump)
          stackPush(objStack, &objs);
       if (o != null)
          markSingleObject(o,dump);
+      if (deadline != 0 && (++n & 63) == 0 && getTimeStampMicro() >= deadline)
+         return false;
    }
+   return true;
+}
+
+static void markObjects(TCObject o, bool dump)
+{
+   if (!o) return; // can occurr if concorrent threads are accessing the structure where this object is
+   markSingleObject(o,dump);
+   if (!incrementalMarking && !markInParallel) // otherwise, the fields are visited by the next slices or by the gc workers
+      visitMarkStack(dump, 0);
+}
+
+void rememberNativeParams(TCObjectArray regO, int32 count)
+{
+   if (incrementalMarking)
+   {
+      LOCKVAR(omm);
+      for (; count-- > 0 && incrementalMarking; regO++)
+         if (*regO != null && isMarked(*regO)) // the unmarked ones will have their fields visited
+            regreyObject(*regO);
+      UNLOCKVAR(omm);
+   }
+   else
+   for (; count-- > 0; regO++)
+      if (*regO != null && !OBJ_ISYOUNG(*regO) && !OBJ_PROPERTIES(*regO)->remembered)
+         rememberObject(*regO);
+}
+
+TC_API void writeBarrier(TCObject holder, TCObject value)
+{
+   WRITE_BARRIER(holder, value);
+}
+
+TC_API void shadeObject(TCObject o)
+{
+   LOCKVAR(omm);
+   if (incrementalMarking && !isMarked(o))
+   {
+      IF_HEAP_ERROR(objStack->heap)
+      {
+         abortIncrementalGC();
+         goto end;
+      }
+      markSingleObject(o, false);
+   }
+end:
+   UNLOCKVAR(omm);
 }
 
 static void markClass(int32 i32, VoidP ptr)
@@ -754,132 +1242,48 @@ static void markClass(int32 i32, VoidP ptr)
 
    // mark all static fields
    for (i = 0, n = ARRAYLENV(f); i < n; f++, i++)
-      if (*f && OBJ_MARK(*f) != markedAsUsed) // we must also mark the objects inside a locked object
+      if (*f && !isMarked(*f)) // we must also mark the objects inside a locked object
       {
          markObjects(*f,dump);
       }
 }
 
-static int32 countObjectsInList(TCObject o, bool dump, int32 mark, int32* size, Hashtable *htOut)
+static int32 countObjects(int32 which, Hashtable *htOut) // counts the live or dead objects, optionally per class
 {
+   TObjectIterator it;
+   TCObject o;
    int32 n = 0;
-   if (size) *size = 0;
-   for (o=OBJ_PROPERTIES(o)->next; o != null; o = OBJ_PROPERTIES(o)->next)
+   iniObjectIterator(&it, which);
+   while ((o = nextObject(&it)) != null)
    {
-      ObjectProperties op = OBJ_PROPERTIES(o);
-      if (htOut) 
+      if (htOut)
          htInc(htOut, (int)OBJ_CLASS(o),1);
-      if (size)
-         *size += op->size;
-      if (_TRACE_OBJCREATION && dump) debug("G %X",o);
-      if (_TRACE_OBJCREATION && o == OBJ_PROPERTIES(o)->next)
-         alert("Infinite recursion detected. Probable cause:\nsetObjectLock called for object %x (size %d)\nwhile it was already in the desired state.",o,op->size);
-#ifndef ENABLE_TEST_SUITE
-      if (mark >= 0)
-         if ((int32)op->mark != mark)
-         {
-            debug("G %X: mark is %d but should be %d (%s)",o,(int)op->mark, (int)mark, OBJ_CLASS(o) ? OBJ_CLASS(o)->name : "null class");
-            alert("G %X: mark is %d but should be %d (%s)",o,(int)op->mark, (int)mark, OBJ_CLASS(o) ? OBJ_CLASS(o)->name : "null class");
-         }
-#endif
       n++;
    }
    return n;
 }
-static int32 countObjectsIn(TCObjectArray oa, bool dumpCount, bool dumpObj, int32 mark, Hashtable *htOut)
-{
-   int32 n = 0,i,j;
-   int32 partial=0,total=0;
-   for (i = 0; i <= OBJARRAY_MAX_INDEX; i++, oa++)
-   {
-      j = countObjectsInList(*oa,dumpObj,mark, &partial, htOut);
-      n += j;
-      if (dumpCount && j > 0) debug("G %5d free of size %4d (%6d)",j,i<<2,partial);
-      total += partial;
-   }
-   if (dumpCount && total > 0) debug("G                   Total: %6d", total);
-   return n;
-}
 
-static bool joinAdjacentObjects(uint8* block, uint32 size)
+static int32 countFreeCells()
 {
-   uint8* block00 = block;
-   uint8* block0 = block;
-   uint8* blockEnd = block + size;
-   ObjectProperties op=null,op0;
-   uint32 newSize;
-   int32 usedCount=0,usedSize=0;
-   if (size < DEFAULT_CHUNK_SIZE)
-      return false;
-   while (block < blockEnd)
-   {
-      op = (ObjectProperties)block;
-      if (/*op->next == null || */op->class_ != null) // not empty object? skip  - guich@tc113_19: commented first part. since the blocks are added FIFO, retaining that block is not good. the idea here was to keep the first memory block created, but since the block was created for the constant pool strings, and these are locked, this comparison is uneeded.
-      {
-         usedCount++;
-         if (COMPUTETIME) usedSize += op->size+sizeof(TObjectProperties);
-         if (op->lock) // if its locked, this chunk is probably used for constant pools, so we just ignore the whole chunk to improve performance.
-            return false;
-         block += sizeof(TObjectProperties) + op->size;
-      }
-      else
-      {
-         // this object is free. check if the next object is also free and merge the blocks
-         block0 = block;
-         op0 = op;
-         newSize = op0->size;
-         while (true)
-         {
-            block += sizeof(TObjectProperties) + op->size; // move to next chunk
-            if (block >= blockEnd)
-               break;
-            op = (ObjectProperties)block;
-            if (op->class_ != null) // if next is not free, stop
-            {
-               usedCount++;
-               if (COMPUTETIME) usedSize += op->size+sizeof(TObjectProperties);
-               break;
-            }
-            // next is free, remove it from the list of free ones and inc the first object's size
-            removeNodeFromDblList(freeList[size2idx(op->size)], CHUNK2OBJECT(block));
-            newSize += sizeof(TObjectProperties) + op->size;
-         }
-         if (newSize != op0->size) // chunks were merged?
-         {
-            int32 oldIdx = size2idx(op0->size);
-            int32 newIdx = size2idx(newSize);
-            TCObject o = CHUNK2OBJECT(block0);
-            if (_DEBUG_OMM_LIST) debug("G %X merged: %4d -> %4d (%3d->%3d)", o, op0->size, newSize,oldIdx,newIdx);
-            op0->size = newSize;
-            if (oldIdx != newIdx)
-            {
-               removeNodeFromDblList(freeList[oldIdx], o);
-               insertNodeInDblList(freeList[newIdx], o);
-            }
-         }
-         // already positioned in next chunk
-      }
-   }
-   if (usedCount == 0)
-   {
-      // remove, from the list of free chunks, the chunk that will be deleted
-      if (COMPUTETIME) debug("G --- Removed chunk %X size %d",block00, size-sizeof(TObjectProperties));
-      removeNodeFromDblList(freeList[size2idx(((ObjectProperties)block00)->size)], CHUNK2OBJECT(block00));
-      if (tcSettings.chunksCreated) (*tcSettings.chunksCreated)--;
-      return true;
-   }
-
-   if (COMPUTETIME) {int32 tt = size-sizeof(TObjectProperties), uu = usedSize > 0 ? (usedSize-sizeof(TObjectProperties)) : 0; debug("G Chunk %X size %d has %d used objects with %d bytes (%d%%)",block0, tt, usedCount, uu, uu * 100 / tt);}
-   return false;
+   TSlabIterator it;
+   Slab s;
+   int32 n = 0;
+   iniSlabIterator(&it);
+   while ((s = nextSlab(&it)) != null)
+      if (s->kind == SLAB_SMALL)
+         n += s->cellCount - s->usedCount;
+   for (s = emptySlabs; s != null; s = s->next)
+      n++;
+   return n;
 }
 
 static void markContexts()
-{                         
-   int32 i;         
+{
+   int32 i;
    Context c;
    Context copy[MAX_CONTEXTS];
    xmemmove(copy,contexts,MAX_CONTEXTS*sizeof(Context));  // warning: only pointers are copied
-   
+
    for (i = 0; i < MAX_CONTEXTS; i++)
       if ((c=copy[i]) != null)
       {
@@ -892,12 +1296,8 @@ static void markContexts()
          for (oa = c->regOStart; oa < c->regO; oa++)
          {
             TCObject obj = *oa;
-            if (obj)
-            {
-               ObjectProperties op = OBJ_PROPERTIES(obj);
-               if (op && op->mark != markedAsUsed) // we must also mark the objects inside a locked object
-                  markObjects(obj, false);
-            }
+            if (obj && !isMarked(obj)) // we must also mark the objects inside a locked object
+               markObjects(obj, false);
          }
          if (c->thrownException != null)
             markObjects(c->thrownException,false);
@@ -907,23 +1307,15 @@ static void markContexts()
 static void finalizeObject(TCObject o, TCClass c)
 {
    TCClass c0 = c;
-   while (c != null) 
+   if (OBJ_PROPERTIES(o)->monitor != 0)
+      monitorFree(o);
+   while (c != null)
    {
-      MUTEX_TYPE* mutex;
-
-      mutex = htGetPtr(&htMutexes, (int32)o);
-      if (mutex)
-      {
-         DESTROY_MUTEX_VAR(*mutex);
-         xfree(mutex);
-         htRemove(&htMutexes, (int32)o);         
-      }
-
-      if (c->finalizeMethod == null) 
+      if (c->finalizeMethod == null)
          c = c->superClass;
-      else 
+      else
       {
-         if (c->dontFinalizeFieldIndex == 0 || FIELD_I32(o,(c->dontFinalizeFieldIndex-1)) == false) 
+         if (c->dontFinalizeFieldIndex == 0 || FIELD_I32(o,(c->dontFinalizeFieldIndex-1)) == false)
          {
             if (_TRACE_OBJDESTRUCTION) debug("G object being finalized: %X (%X)", o, OBJ_CLASS(o));
             executeMethod(gcContext, c->finalizeMethod, o);
@@ -934,65 +1326,503 @@ static void finalizeObject(TCObject o, TCClass c)
    }
 }
 
-static void markAllImages() // visits all images
+static void sweepSlab(Slab s, bool traceCreatedClassObjs) // frees the objects that are live but not marked, and clears the marks
+{
+   uint32 w,dead,bit;
+   uint8* cell;
+   TCObject o;
+   for (w = 0; w < s->words; w++)
+   {
+      dead = s->live[w] & ~s->marks[w];
+      s->live[w] ^= dead;
+      s->marks[w] = 0;
+      while (dead != 0)
+      {
+         bit = dead & (~dead + 1);
+         dead ^= bit;
+         cell = s->start + ((w << 5) + bitIndex(bit)) * s->cellSize;
+         o = CHUNK2OBJECT(cell);
+         if (_TRACE_OBJCREATION) debug("G object being freed: %X (%s)",o, OBJ_CLASS(o)->name);
+         if (traceCreatedClassObjs) htInc(&htObjsPerClass, (int32)OBJ_CLASS(o),-1);
+         OBJ_CLASS(o) = null; // set the object "free"
+         s->usedCount--;
+         if (s->kind == SLAB_SMALL)
+         {
+            *(uint8**)o = s->freeCells;
+            s->freeCells = cell;
+         }
+      }
+   }
+}
+
+static void spinLock(volatile uint32* lock)
+{
+   while (!ATOMIC_CAS32(lock, 0, 1))
+      THREAD_YIELD();
+}
+
+static void spinUnlock(volatile uint32* lock)
+{
+   MEMORY_BARRIER(); // the writes done while holding the lock must be seen before it is released
+   *lock = 0;
+}
+
+static void atomicAdd(volatile uint32* p, int32 v)
+{
+   uint32 old;
+   do
+      old = *p;
+   while (!ATOMIC_CAS32(p, old, old + v));
+}
+
+static bool testAndMarkAtomic(TCObject o) // testAndMark for the gc workers, which may be marking objects of the same slab
+{
+   uint32 i,old,bit;
+   volatile uint32* w;
+   Slab s = getSlab(o, &i);
+   w = &s->marks[i>>5];
+   bit = 1u << (i & 31);
+   do
+   {
+      old = *w;
+      if (old & bit)
+         return true;
+   } while (!ATOMIC_CAS32(w, old, old | bit));
+   return false;
+}
+
+static void dequePush(TMarkDeque* d, TObjectsToVisit* objs) // must be called under IF_HEAP_ERROR(d->overflow->heap)
+{
+   bool pushed = false;
+   spinLock(&d->lock);
+   if (d->top - d->bottom < MARK_DEQUE_SIZE)
+   {
+      d->items[d->top++ & (MARK_DEQUE_SIZE-1)] = *objs;
+      pushed = true;
+   }
+   spinUnlock(&d->lock);
+   if (!pushed)
+      stackPush(d->overflow, objs);
+}
+
+static bool dequePop(TMarkDeque* d, TObjectsToVisit* objs)
+{
+   bool popped = false;
+   spinLock(&d->lock);
+   if (d->top > d->bottom)
+   {
+      *objs = d->items[--d->top & (MARK_DEQUE_SIZE-1)];
+      popped = true;
+   }
+   else
+      d->top = d->bottom = 0;
+   spinUnlock(&d->lock);
+   return popped || stackPop(d->overflow, objs);
+}
+
+static bool dequeSteal(TMarkDeque* d, TObjectsToVisit* objs)
+{
+   bool stolen = false;
+   if (d->top == d->bottom) // don't take the lock of an empty deque
+      return false;
+   spinLock(&d->lock);
+   if (d->top > d->bottom)
+   {
+      *objs = d->items[d->bottom++ & (MARK_DEQUE_SIZE-1)];
+      stolen = true;
+   }
+   spinUnlock(&d->lock);
+   return stolen;
+}
+
+static bool othersHaveWork(int32 index)
+{
+   int32 i;
+   for (i = 0; i < gcWorkers; i++)
+      if (i != index && markDeques[i].top != markDeques[i].bottom)
+         return true;
+   return false;
+}
+
+static bool stealWork(int32 index, TObjectsToVisit* objs)
+{
+   int32 i;
+   for (i = 1; i < gcWorkers; i++)
+      if (dequeSteal(&markDeques[(index + i) % gcWorkers], objs))
+         return true;
+   return false;
+}
+
+static void markWorker(int32 index, VoidP arg)
+{
+   TMarkDeque* d = &markDeques[index];
+   TObjectsToVisit objs, fields;
+   TCObject o;
+   UNUSED(arg)
+   atomicAdd(&activeWorkers, 1);
+   IF_HEAP_ERROR(d->overflow->heap)
+   {
+      parallelMarkFailed = true;
+      return;
+   }
+   while (!parallelMarkDone && !parallelMarkFailed)
+   {
+      if (!dequePop(d, &objs) && !stealWork(index, &objs))
+      {
+         // out of work: wait until another worker pushes some, or all workers are idle
+         atomicAdd(&idleWorkers, 1);
+         while (!parallelMarkDone && !parallelMarkFailed && !othersHaveWork(index))
+            if (idleWorkers == activeWorkers)
+               parallelMarkDone = true;
+            else
+               THREAD_YIELD();
+         atomicAdd(&idleWorkers, -1);
+         continue;
+      }
+      if (objs.n > MARK_SPLIT) // let the other workers take half of a big array
+      {
+         fields.start = objs.start + objs.n / 2;
+         fields.n = objs.n - objs.n / 2;
+         objs.n /= 2;
+         dequePush(d, &fields);
+      }
+      for (; objs.n > 0; objs.n--)
+         if ((o = *objs.start++) != null && !testAndMarkAtomic(o) && getObjectFields(o, &fields))
+            dequePush(d, &fields);
+   }
+}
+
+static int32 countGCWorkers() // the number of threads that will be used by the full gc
+{
+   SlabChunk c;
+   uint32 heapSize = largeObjectsSize;
+   int32 n;
+   if (!IS_VMTWEAK_ON(VMTWEAK_PARALLEL_GC) || (n = threadGetProcessorCount()) < 2)
+      return 1;
+   for (c = slabChunks; c != null && heapSize < PARALLEL_GC_MIN_HEAP; c = c->next)
+      heapSize += DEFAULT_CHUNK_SIZE;
+   return heapSize < PARALLEL_GC_MIN_HEAP ? 1 : min32(n, GC_MAX_WORKERS);
+}
+
+static bool initMarkDeques() // returns false if there's no memory for the deques; the objects are then marked by a single thread
+{
+   int32 i;
+   if (markDeques == null)
+   {
+      IF_HEAP_ERROR(ommHeap)
+         return false;
+      markDeques = (TMarkDeque*)heapAlloc(ommHeap, GC_MAX_WORKERS * sizeof(TMarkDeque));
+   }
+   for (i = 0; i < gcWorkers; i++)
+   {
+      TMarkDeque* d = &markDeques[i];
+      if (d->overflow == null && (d->overflow = newStack(256, sizeof(TObjectsToVisit), null)) == null)
+         return false;
+      d->top = d->bottom = 0;
+      d->lock = 0;
+   }
+   return true;
+}
+
+static bool parallelMark() // visits the fields pushed by the roots using all workers; returns false if there's no memory
+{
+   TObjectsToVisit objs;
+   int32 i;
+   for (i = 0; i < gcWorkers; i++)
+      IF_HEAP_ERROR(markDeques[i].overflow->heap)
+         return false;
+   for (i = 0; stackPop(objStack, &objs); i++) // share the roots' fields among the workers
+      dequePush(&markDeques[i % gcWorkers], &objs);
+   parallelMarkDone = parallelMarkFailed = false;
+   idleWorkers = activeWorkers = 0;
+   threadRunParallel(gcWorkers, markWorker, null);
+   return !parallelMarkFailed;
+}
+
+static void sweepWorker(int32 index, VoidP arg) // sweeps the chunks that were not taken by the other workers
+{
+   SlabChunk c;
+   Slab s;
+   int32 i;
+   UNUSED(index)
+   UNUSED(arg)
+   while (true)
+   {
+      spinLock(&sweepLock);
+      if ((c = sweepNext) != null)
+         sweepNext = c->next;
+      spinUnlock(&sweepLock);
+      if (c == null)
+         break;
+      for (i = 0; i < CHUNK_SLABS; i++)
+         if ((s = SLAB_AT(c, i))->kind == SLAB_SMALL)
+            sweepSlab(s, false);
+   }
+}
+
+static void addNurseryHole(uint8* start, uint8* end, THole** last)
+{
+   THole* hole = (THole*)start;
+   if (nurseryTop == null) // the first hole is used by the bump allocator
+   {
+      nurseryTop = start;
+      nurseryLimit = end;
+      return;
+   }
+   hole->next = null;
+   hole->size = (uint32)(end - start);
+   if (*last == null)
+      nurseryHoles = start;
+   else
+      (*last)->next = start;
+   *last = hole;
+}
+
+static void rebuildNursery() // the space between the live objects of the nursery becomes holes
+{
+   TObjectIterator it;
+   TCObject o;
+   THole* last = null;
+   uint8* pos = nurseryStart, *p;
+
+   nurseryTop = nurseryLimit = nurseryHoles = null;
+   iniSlabObjectIterator(&it, nursery, ITERATE_LIVE);
+   do
+   {
+      o = nextObject(&it);
+      p = o != null ? OBJECT2CHUNK(o) : nurseryEnd;
+      if (p > pos)
+         addNurseryHole(pos, p, &last);
+      if (o != null)
+         pos = p + sizeof(TObjectProperties) + OBJ_SIZE(o);
+   } while (o != null);
+}
+
+static void releaseNursery() // called when the generational mode is turned off: the nursery is given back when no object remains there
+{
+   uint32 w;
+   nurseryTop = nurseryLimit = nurseryHoles = null; // no more allocations there
+   for (w = 0; w < nursery->words; w++)
+      if (nursery->live[w] != 0)
+         return;
+   nursery->kind = SLAB_DEAD;
+   nursery = null;
+   nurseryStart = nurseryEnd = null;
+   if (tcSettings.chunksCreated) (*tcSettings.chunksCreated)--;
+}
+
+static bool releaseDeadBlock(uint8* block, uint32 size)
 {
-   TCObjectArray freeL;
-   TCObject o,next=null;  
-   int32 i = 0;
+   UNUSED(size)
+   return *block == SLAB_DEAD; // the kind is the first member of TSlab and TSlabChunk
+}
 
-   for (freeL = freeList; i <= OBJARRAY_MAX_INDEX; i++, freeL++)
-      if (*freeL)
-         for (o=OBJ_PROPERTIES(*freeL)->next; o != null;)
+static void rebuildSlabLists() // returns the empty slabs to the empty list and rebuilds the lists of slabs with free cells; gives back the memory that is not used anymore
+{
+   SlabChunk c, *pc;
+   Slab s, *ps;
+   int32 i, chunks = 0;
+   for (c = slabChunks; c != null; c = c->next)
+      chunks++;
+   xmemzero(partialSlabs, SLAB_CLASSES * sizeof(Slab));
+   emptySlabs = null;
+   for (pc = &slabChunks; (c = *pc) != null;)
+   {
+      for (i = 0; i < CHUNK_SLABS; i++)
+         if ((s = SLAB_AT(c, i))->kind == SLAB_SMALL && s->usedCount == 0)
          {
-            next = OBJ_PROPERTIES(o)->next; // the markObjects below may break the loop
-            if (OBJ_CLASS(o) == imageClass && OBJ_MARK(o) != markedAsUsed)
-               markObjects(o, false);
-            o = next;
+            s->kind = SLAB_EMPTY;
+            c->usedSlabs--;
          }
+      if (c->usedSlabs == 0 && chunks > 1) // keep at least one chunk
+      {
+         if (COMPUTETIME) debug("G --- Removed chunk %X", c);
+         *pc = c->next;
+         c->kind = SLAB_DEAD;
+         chunks--;
+         if (tcSettings.chunksCreated) (*tcSettings.chunksCreated)--;
+         continue;
+      }
+      for (i = CHUNK_SLABS; --i >= 0;) // in address order
+      {
+         s = SLAB_AT(c, i);
+         if (s->kind == SLAB_EMPTY)
+         {
+            s->next = emptySlabs;
+            emptySlabs = s;
+         }
+         else
+         if (s->usedCount < s->cellCount)
+         {
+            s->next = partialSlabs[s->sizeClass];
+            partialSlabs[s->sizeClass] = s;
+         }
+      }
+      pc = &c->next;
+   }
+   // remove the dead large objects
+   largeObjectsSize = 0;
+   for (ps = &largeObjects; (s = *ps) != null;)
+      if (s->usedCount == 0)
+      {
+         *ps = s->next;
+         s->kind = SLAB_DEAD;
+      }
+      else
+      {
+         largeObjectsSize += s->cellSize;
+         ps = &s->next;
+      }
+   largeAllocatedSinceGC = 0;
+   heapFreeAsking(chunksHeap, releaseDeadBlock);
 }
 
-static TCObject retNext(TCObject o)
-{  
-   ObjectProperties p;
-   if (o == null) return null;
-   p = OBJ_PROPERTIES(o);
-   if (p == null) return null;
-   return p->next;
+static void markYoungObjects() // marks the young objects reachable from the pushed fields. Old objects are not traversed: the ones that point to young objects are in the remembered set
+{
+   TObjectsToVisit objs;
+   TCObject o;
+   while (stackPop(objStack, &objs))
+   {
+      o = *objs.start++;
+      if (--objs.n > 0)
+         stackPush(objStack, &objs);
+      if (o != null && OBJ_ISYOUNG(o) && !testAndMark(o))
+         pushObjectFields(o);
+   }
+}
+
+static void markYoungRoot(TCObject o)
+{
+   if (o == null)
+      return;
+   if (!OBJ_ISYOUNG(o))
+      pushObjectFields(o); // old roots are not marked, but their fields are visited
+   else
+   if (!testAndMark(o))
+      pushObjectFields(o);
+   markYoungObjects();
+}
+
+static void markClassYoung(int32 i32, VoidP ptr)
+{
+   TCClass c = (TCClass)ptr;
+   int32 i,n;
+   TCObject* f = c->objStaticValues;
+   UNUSED(i32)
+   // static fields are always roots, so storing in them needs no write barrier
+   for (i = 0, n = ARRAYLENV(f); i < n; f++, i++)
+      if (*f && OBJ_ISYOUNG(*f))
+         markYoungRoot(*f);
+}
+
+static bool minorGC(Context currentContext) // must be called with the omm locked
+{
+   int32 i;
+   int64 iniT;
+   TCObject o;
+   TObjectIterator it;
+   if (disableGC || destroyingApplication || runningGC || incrementalMarking || IS_VMTWEAK_ON(VMTWEAK_DISABLE_GC))
+      return false;
+   if (rememberedOverflow) // some old objects were not remembered
+   {
+      gc2(currentContext, false);
+      return true;
+   }
+   iniT = getTimeStampMicro();
+   IF_HEAP_ERROR(objStack->heap)
+   {
+      TObjectsToVisit objs;
+      while (stackPop(objStack, &objs)) {}
+      xmemzero(nursery->marks, nursery->words * 4);
+      runningGC = false;
+      return false; // allocate in the old space, whose gc will handle the lack of memory
+   }
+   runningGC = true;
+   minorGCCount++;
+
+   // 1. mark the young objects reachable from the roots
+   khTraverse(&htLoadedClasses, markClassYoung);
+   iniObjectIterator(&it, ITERATE_LOCKED); // natives may store young objects in the locked ones they're filling
+   while ((o = nextObject(&it)) != null)
+      markYoungRoot(o);
+   for (i = 0; i < rememberedCount; i++)
+      markYoungRoot(rememberedSet[i]);
+   {
+      Context c;
+      Context copy[MAX_CONTEXTS];
+      TCObjectArray oa;
+      xmemmove(copy,contexts,MAX_CONTEXTS*sizeof(Context));
+      for (i = 0; i < MAX_CONTEXTS; i++)
+         if ((c=copy[i]) != null)
+         {
+            markYoungRoot(c->threadObj);
+            markYoungRoot(c->nmp.retO);
+            for (oa = c->regOStart; oa < c->regO; oa++) // old objects here may be parameters of a running native method
+               markYoungRoot(*oa);
+            markYoungRoot(c->thrownException);
+         }
+   }
+   clearRememberedSet();
+
+   // 2. promote the survivors; the old objects of the nursery are not marked, so they must not be taken as garbage
+   iniSlabObjectIterator(&it, nursery, ITERATE_LIVE);
+   while ((o = nextObject(&it)) != null)
+      if (!OBJ_ISYOUNG(o) || isMarked(o))
+      {
+         OBJ_PROPERTIES(o)->young = 0;
+         testAndMark(o);
+      }
+
+   // 3. finalize the dead ones and turn them into holes
+   runningFinalizer = true;
+   gcContext->litebasePtr = currentContext->litebasePtr;
+   iniSlabObjectIterator(&it, nursery, ITERATE_DEAD);
+   while ((o = nextObject(&it)) != null)
+      finalizeObject(o, OBJ_CLASS(o));
+   sweepSlab(nursery, false);
+   currentContext->litebasePtr = gcContext->litebasePtr;
+   runningFinalizer = false;
+
+   rebuildNursery();
+   updatePauseTime(iniT, true);
+   if (COMPUTETIME) debug("G minor gc %d: %d us", minorGCCount, (int32)(getTimeStampMicro() - iniT));
+   runningGC = false;
+   return true;
+}
+
+static void markAllImages() // visits all images
+{
+   TObjectIterator it;
+   TCObject o;
+   iniObjectIterator(&it, ITERATE_LIVE);
+   while ((o = nextObject(&it)) != null)
+      if (OBJ_CLASS(o) == imageClass && !isMarked(o))
+         markObjects(o, false);
 }
 
 void visitImages(VisitElementFunc onImage, int32 param) // visits all images
 {
-   TCObjectArray usedL;
+   TObjectIterator it;
    TCObject o;
-   int32 i;                    
-   if (destroyingApplication) return;
+   if (destroyingApplication || partialSlabs == null) return;
 
    LOCKVAR(omm);
-   for (i = 0, usedL = usedList; i <= OBJARRAY_MAX_INDEX; i++, usedL++)
-      if (*usedL)
-         for (o=retNext(*usedL); o != null; o = retNext(o))
-            if (OBJ_PROPERTIES(o) != null && OBJ_CLASS(o) == imageClass)
-               onImage(param,o);
-   if (lockList)
-      for (o=retNext(*lockList); o != null; o = retNext(o))
-         if (OBJ_PROPERTIES(o) != null && OBJ_CLASS(o) == imageClass)
-            onImage(param,o);
+   iniObjectIterator(&it, ITERATE_LIVE);
+   while ((o = nextObject(&it)) != null)
+      if (OBJ_CLASS(o) == imageClass)
+         onImage(param,o);
    UNLOCKVAR(omm);
 }
 
 void runFinalizers() // calls finalize of all objects in use
 {
-   TCObjectArray usedL;
+   TObjectIterator it;
    TCObject o;
-   int32 i;
    TCClass c;
    gcContext->litebasePtr = mainContext->litebasePtr;  // let litebase destroy the ptr if he wants so
-   for (i = 0, usedL = usedList; i <= OBJARRAY_MAX_INDEX; i++, usedL++)
-      if (*usedL)
-         for (o=OBJ_PROPERTIES(*usedL)->next; o != null; o = OBJ_PROPERTIES(o)->next)
-            if ((c = OBJ_CLASS(o)) != null && c->finalizeMethod != null && (c->dontFinalizeFieldIndex == 0 || FIELD_I32(o,(c->dontFinalizeFieldIndex-1)) == false)) // if user defined a dontFinalize field and set it to true, don't call finalize
-               finalizeObject(o, OBJ_CLASS(o));
-   for (o=OBJ_PROPERTIES(*lockList)->next; o != null; o = OBJ_PROPERTIES(o)->next)
+   promoteYoungObjects();
+   iniObjectIterator(&it, ITERATE_LIVE);
+   while ((o = nextObject(&it)) != null)
       if ((c = OBJ_CLASS(o)) != null && c->finalizeMethod != null && (c->dontFinalizeFieldIndex == 0 || FIELD_I32(o,(c->dontFinalizeFieldIndex-1)) == false)) // if user defined a dontFinalize field and set it to true, don't call finalize
          finalizeObject(o, OBJ_CLASS(o));
    mainContext->litebasePtr = gcContext->litebasePtr; // update the ptr
@@ -1014,9 +1844,13 @@ void preallocateArray(Context currentContext, TCObject sample, int32 length)
    int32 size = OBJ_SIZE(sample);
    int32 totSize = size * length;
    int32 totChunks = (totSize+DEFAULT_CHUNK_SIZE-1) / DEFAULT_CHUNK_SIZE;
-   if (totSize >= DEFAULT_CHUNK_SIZE)
+   if (totSize >= DEFAULT_CHUNK_SIZE && size <= SLAB_MAX_OBJECT_SIZE) // the large objects have their own blocks
+   {
+      LOCKVAR(omm);
       while (totChunks-- > 0)
-         createChunk(DEFAULT_CHUNK_SIZE);
+         createChunk();
+      UNLOCKVAR(omm);
+   }
 }
 
 static void dumpCount(HTKey key, int32 i32, VoidP ptr)
@@ -1036,20 +1870,336 @@ static void dumpDif(HTKey key, int32 i32, VoidP ptr)
 }
 void vmVibrate(int32 ms);
 
+static void markRoots(Context currentContext, bool remark) // remark: finishing an incremental cycle
+{
+   Hashtable htCount;
+   TObjectIterator it;
+   TCObject o;
+   bool traceLockedObjs = IS_VMTWEAK_ON(VMTWEAK_TRACE_LOCKED_OBJS);
+   int lockCount=0;
+   if (traceLockedObjs) htCount = htNew(511,null); else htCount.items = 0;
+   // 1. go through all the reachable objects and mark them
+   // 1a. static fields of loaded classes
+   if (CANTRAVERSE)
+      khTraverse(&htLoadedClasses, markClass);
+#ifdef __gl2_h_
+   if (currentContext != mainContext) // in opengl, an image can only be freed in the main context, otherwise the texture will not be released
+   {
+      callGConMainThread = true; // set to run the gc on main thread so that the images can be collected
+      wakeUpEventLoop(); // the main loop may be blocked waiting for events
+      markAllImages(); // marking all images
+   }
+#endif
+   // 1b. mark the locked objects
+   if (_TRACE_OBJCREATION) debug("G marking locked objs start");
+   iniObjectIterator(&it, ITERATE_LOCKED);
+   while ((o = nextObject(&it)) != null)
+   {
+      if (traceLockedObjs)
+      {
+         if (strEq(OBJ_CLASS(o)->name,BYTE_ARRAY))
+            debug("locked ba: %X",o);
+         htInc(&htCount, (int32)OBJ_CLASS(o), 1);
+         lockCount++;
+      }
+      //if (_TRACE_OBJCREATION) debug("G marking locked obj %X",o);
+      if (remark) // the locked objects are changed by native methods without a write barrier, so their fields must be visited again
+      {
+         testAndMark(o);
+         pushObjectFields(o);
+         visitMarkStack(false, 0);
+      }
+      else
+      if (OBJ_CLASS(o)->flags.isString) // 99% of the locked objects, due to the constant pool
+      {
+         testAndMark(o);
+         if (String_chars(o)) markSingleObject(String_chars(o),false);
+      }
+      else
+         markObjects(o,false);
+   }
+   if (traceLockedObjs)
+   {
+      htTraverseWithKey(&htCount, dumpCount);
+      debug("locked: %d",lockCount);
+   }
+   if (_TRACE_OBJCREATION) debug("G marking locked objs end");
+   // 1c. used objects in the object registers of all available contexts
+   markContexts();
+}
+
+// Makes the marked strings with the same chars share a single array. Only the strings whose hash is cached are checked:
+// they were probably used as keys, and the hash avoids comparing the chars of most of the different strings. Only the
+// first array seen for each hash is shared; the ones that were replaced are freed by the next gc, since they're already
+// marked. The locked strings can give their chars, but don't receive others: a native method may be using them.
+static void deduplicateStrings()
+{
+   TObjectIterator it;
+   TCObject o, chars, same;
+   int64 hash;
+   int32 count = 0, saved = 0;
+   Hashtable ht = htNew(1023, null);
+   if (!ht.items)
+      return;
+   iniObjectIterator(&it, ITERATE_MARKED);
+   while ((o = nextObject(&it)) != null)
+      if (OBJ_CLASS(o)->flags.isString && ((hash = String_hashCache(o)) & STRING_HASH_CACHED) && (chars = String_chars(o)) != null)
+      {
+         if ((same = (TCObject)htGetPtr(&ht, (uint32)hash)) == null)
+            htPutPtr(&ht, (uint32)hash, chars);
+         else
+         if (same != chars && !OBJ_ISLOCKED(o) && OBJ_CLASS(same) == OBJ_CLASS(chars) && ARRAYOBJ_LEN(same) == ARRAYOBJ_LEN(chars) &&
+             xmemcmp(ARRAYOBJ_START(same), ARRAYOBJ_START(chars), TC_ARRAYSIZE(OBJ_CLASS(chars), ARRAYOBJ_LEN(chars))) == 0)
+         {
+            String_chars(o) = same; // all objects are old now, so no write barrier is needed
+            saved += TC_ARRAYSIZE(OBJ_CLASS(chars), ARRAYOBJ_LEN(chars));
+            count++;
+         }
+      }
+   htFree(&ht, null);
+   if (COMPUTETIME) debug("G deduplicated %d strings, %d bytes", count, saved);
+}
+
+typedef struct TClassHistogram
+{
+   struct TClassHistogram* next;
+   TCClass cls;
+   int32 count;
+   int64 shallow, retained;
+} TClassHistogram, *ClassHistogram;
+
+static int compareObjects(const void* a, const void* b)
+{
+   TCObject o1 = *(TCObject*)a, o2 = *(TCObject*)b;
+   return o1 < o2 ? -1 : o1 > o2;
+}
+
+static int compareClassHistograms(const void* a, const void* b)
+{
+   return xstrcmp((*(ClassHistogram*)a)->cls->name, (*(ClassHistogram*)b)->cls->name);
+}
+
+static int32 findObject(TCObject* objs, int32 n, TCObject o) // the objects are sorted by address
+{
+   int32 low = 0, high = n-1, mid;
+   while (low <= high)
+   {
+      mid = (low + high) >> 1;
+      if (objs[mid] == o)
+         return mid;
+      if (objs[mid] < o)
+         low = mid + 1;
+      else
+         high = mid - 1;
+   }
+   return -1;
+}
+
+static void writeClassHistograms(ClassHistogram list, int32 count, int32 objects)
+{
+   static int32 histogramCount;
+   char path[MAX_PATHNAME], suffix[32];
+   ClassHistogram* sorted;
+   FILE* f;
+   int32 i;
+
+   xstrprintf(suffix, ".heap%d.csv", ++histogramCount);
+   if ((sorted = (ClassHistogram*)xmalloc((count+1) * sizeof(ClassHistogram))) == null || (f = createProfilerFile(suffix, path)) == null)
+   {
+      xfree(sorted);
+      return;
+   }
+   for (i = 0; list != null; list = list->next)
+      sorted[i++] = list;
+   qsort(sorted, count, sizeof(ClassHistogram), compareClassHistograms);
+   fputs("class,instances,shallow_bytes,retained_bytes\n", f);
+   for (i = 0; i < count; i++)
+      fprintf(f, "%s,%d,%.0f,%.0f\n", sorted[i]->cls->name, sorted[i]->count, (double)sorted[i]->shallow, (double)sorted[i]->retained);
+   xfree(sorted);
+   if (fclose(f) == 0)
+      debug("P Heap histogram of %d objects written to %s", objects, path);
+}
+
+// Writes the number of live objects of each class, their size (shallow) and the size of the objects they own
+// (retained). An object owns the ones that are referenced only by it, and the ones that these own: the dominator tree
+// restricted to the chains of single references, which gives a lower bound of the real retained size and needs no
+// more than a few arrays. The references from the roots are not counted, and an object owned by another one of its
+// class is counted only in the owner. Called by gc2 after the marking, when all objects are old.
+static void dumpHeapHistogram()
+{
+   TObjectIterator it;
+   TObjectsToVisit fields;
+   TCObject o, *objs;
+   int32 n = countObjects(ITERATE_MARKED, null), i, j, k, head, tail, classCount = 0;
+   int32 *owner, *pending, *queue;
+   uint32* retained;
+   ClassHistogram h, list = null;
+   Hashtable byClass = htNew(511, null);
+
+   objs = (TCObject*)xmalloc(n * sizeof(TCObject) + 1);
+   owner = (int32*)xmalloc(n * 4 + 1); // the index of the owner; -1 if not referenced, -2 if referenced by more than one object
+   pending = (int32*)xmalloc(n * 4 + 1); // the owned objects whose retained size was not added yet
+   queue = (int32*)xmalloc(n * 4 + 1);
+   retained = (uint32*)xmalloc(n * 4 + 1);
+   if (!objs || !owner || !pending || !queue || !retained || !byClass.items)
+   {
+      debug("P Not enough memory for the heap histogram");
+      goto end;
+   }
+   iniObjectIterator(&it, ITERATE_MARKED);
+   for (i = 0; i < n && (o = nextObject(&it)) != null; i++)
+   {
+      objs[i] = o;
+      owner[i] = -1;
+      retained[i] = OBJ_SIZE(o);
+   }
+   n = i;
+   qsort(objs, n, sizeof(TCObject), compareObjects);
+   for (i = 0; i < n; i++)
+      if (getObjectFields(objs[i], &fields))
+         for (k = 0; k < fields.n; k++)
+            if (fields.start[k] != null && (j = findObject(objs, n, fields.start[k])) >= 0 && j != i && owner[j] != i)
+               owner[j] = owner[j] == -1 ? i : -2;
+   // add the retained size of each owned object to its owner, starting from the ones that own nothing
+   for (i = 0; i < n; i++)
+      if (owner[i] >= 0)
+         pending[owner[i]]++;
+   for (i = tail = 0; i < n; i++)
+      if (owner[i] >= 0 && pending[i] == 0)
+         queue[tail++] = i;
+   for (head = 0; head < tail;)
+   {
+      i = queue[head++];
+      j = owner[i];
+      retained[j] += retained[i];
+      if (--pending[j] == 0 && owner[j] >= 0)
+         queue[tail++] = j;
+   }
+   for (i = 0; i < n; i++)
+   {
+      TCClass c = OBJ_CLASS(objs[i]);
+      if ((h = (ClassHistogram)htGetPtr(&byClass, (HTKey)c)) == null)
+      {
+         if ((h = newX(ClassHistogram)) == null || !htPutPtr(&byClass, (HTKey)c, h))
+         {
+            xfree(h);
+            debug("P Not enough memory for the heap histogram");
+            goto end;
+         }
+         h->cls = c;
+         h->next = list;
+         list = h;
+         classCount++;
+      }
+      h->count++;
+      h->shallow += OBJ_SIZE(objs[i]);
+      if (owner[i] < 0 || OBJ_CLASS(objs[owner[i]]) != c)
+         h->retained += retained[i];
+   }
+   writeClassHistograms(list, classCount, n);
+end:
+   for (; list != null; list = h)
+   {
+      h = list->next;
+      xfree(list);
+   }
+   htFree(&byClass, null);
+   xfree(objs);
+   xfree(owner);
+   xfree(pending);
+   xfree(queue);
+   xfree(retained);
+}
+
+void gcSafepoint(Context c)
+{
+   MEMORY_BARRIER(); // the previous stores and their write barriers are done
+   c->gcEpoch = gcEpoch;
+   MEMORY_BARRIER(); // the next write barriers see incrementalMarking
+}
+
+static bool threadsAtSafepoint(Context currentContext) // returns true if all the other threads that run bytecode saw the current gcEpoch
+{
+   int32 i;
+   Context c;
+   MEMORY_BARRIER();
+   for (i = 0; i < MAX_CONTEXTS; i++)
+      if ((c = contexts[i]) != null && c != currentContext && c != gcContext && c->usageCount > 0 && !c->inNative && c->gcEpoch != gcEpoch)
+         return false;
+   MEMORY_BARRIER(); // the stores they did before the safepoint are seen when marking
+   return true;
+}
+
+static void startIncrementalGC(Context currentContext)
+{
+   if (nursery != null)
+   {
+      promoteYoungObjects();
+      clearRememberedSet();
+   }
+   if (tcSettings.gcCount) (*tcSettings.gcCount)++;
+   if (COMPUTETIME) debug("G ====  INCREMENTAL GC INI : %d", tcSettings.gcCount ? *tcSettings.gcCount : 0);
+   // the objects created from now on are born marked, and the write barriers shade the stored objects. The roots are marked
+   // by the next slices, once the other threads saw this
+   incrementalMarking = true;
+   incrementalRootsMarked = false;
+   MEMORY_BARRIER();
+   gcEpoch++;
+   currentContext->gcEpoch = gcEpoch;
+}
+
+void gcStep(Context currentContext)
+{
+   int64 iniT;
+   int32 budget;
+   bool finished;
+   if (!IS_VMTWEAK_ON(VMTWEAK_INCREMENTAL_GC) || disableGC || destroyingApplication || runningGC || IS_VMTWEAK_ON(VMTWEAK_DISABLE_GC) || (!incrementalMarking && allocatedSinceGC < INCREMENTAL_GC_TRIGGER))
+      return;
+   budget = tcSettings.gcSliceBudget && *tcSettings.gcSliceBudget > 0 ? *tcSettings.gcSliceBudget : DEFAULT_SLICE_BUDGET;
+   LOCKVAR(omm);
+   iniT = getTimeStampMicro();
+   IF_HEAP_ERROR(objStack->heap)
+   {
+      abortIncrementalGC();
+      UNLOCKVAR(omm);
+      return;
+   }
+   if (!incrementalMarking)
+      startIncrementalGC(currentContext);
+   if (!incrementalRootsMarked)
+   {
+      if (!threadsAtSafepoint(currentContext)) // try again in the next slice
+      {
+         updatePauseTime(iniT, true);
+         UNLOCKVAR(omm);
+         return;
+      }
+      incrementalRootsMarked = true;
+      markRoots(currentContext, false); // their fields are visited by this and the next slices
+   }
+   finished = visitMarkStack(false, iniT + budget);
+   updatePauseTime(iniT, true);
+   UNLOCKVAR(omm);
+   if (finished) // all objects were visited: finish the cycle in a single pause
+      gc2(currentContext, true);
+}
+
 void gc(Context currentContext)
 {
    gc2(currentContext, true);
 }
 void gc2(Context currentContext, bool lockOMM)
 {
-   int32 i;
-   TCClass c;
-   TCObjectArray freeL, usedL;
+   TSlabIterator slabs;
+   TObjectIterator it;
+   Slab s;
    TCObject o;
    int32 iniT,endT;
    int32 nfree,nused,compIni,freemem;
    bool traceCreatedClassObjs;
    bool traceObjsCreatedBetween2GCs = IS_VMTWEAK_ON(VMTWEAK_TRACE_OBJECTS_LEFT_BETWEEN_2_GCS);
+   bool remark; // finishing an incremental cycle
+   int64 pauseIni = getTimeStampMicro();
    int32 total0 = totalAllocated/1024/1024, free0 = getFreeMemory(USE_MAX_BLOCK)/1024/1024, chunks0 = tcSettings.chunksCreated?*tcSettings.chunksCreated : 0;
    if (lockOMM) LOCKVAR(omm); // guich@tc120: another fix for concurrent threads
    iniT = getTimeStamp();
@@ -1062,7 +2212,7 @@ void gc2(Context currentContext, bool lockOMM)
    if (disableGC || (IS_VMTWEAK_ON(VMTWEAK_DISABLE_GC) && freemem > CRITICAL_SIZE)) // use an agressive gc if memory is under 2MB - guich@tc114_18: let user control gc runs
    {
       skippedGC++;
-      if (COMPUTETIME) 
+      if (COMPUTETIME)
          debug("G ====  GC SKIPPED");
       if (lockOMM) UNLOCKVAR(omm);
       return;
@@ -1077,21 +2227,30 @@ void gc2(Context currentContext, bool lockOMM)
    }
 
    runningGC = true;
+   if (incrementalMarking && !incrementalRootsMarked) // the roots of the incremental cycle were not marked yet: do a full gc instead
+      abortIncrementalGC();
+   remark = incrementalMarking;
+   if (nursery != null) // the young objects are collected as old ones
+   {
+      promoteYoungObjects();
+      clearRememberedSet();
+   }
 
    traceCreatedClassObjs = IS_VMTWEAK_ON(VMTWEAK_TRACE_CREATED_CLASSOBJS) && htObjsPerClass.items;
+   gcWorkers = countGCWorkers();
    if (IS_VMTWEAK_ON(VMTWEAK_AUDIBLE_GC))
       soundTone(1000,10);
 
    if (COMPUTETIME)
    {
-      debug("G checking free at start"); nfree = countObjectsIn(freeList,false,false,-1,0);
-      debug("G checking used at start"); nused = countObjectsIn(usedList,false,false,!markedAsUsed,0);
-      debug("G ====  GC INI : %d (skipped: %d) free: %d, used: %d, mark: %d, chunks: %d, objs created: %d (%d ms ago), locked objs: %d, context: %X, free mem: %d (max: %d). context: %X", tcSettings.gcCount ? *tcSettings.gcCount : 0, skippedGC, nfree, nused, markedAsUsed, tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1, objCreated, iniT - lastGC, objLocked, currentContext, getFreeMemory(false), getFreeMemory(true), currentContext);
+      nfree = countFreeCells();
+      nused = countObjects(ITERATE_LIVE, null);
+      debug("G ====  GC INI : %d (skipped: %d) free: %d, used: %d, chunks: %d, objs created: %d (%d ms ago), locked objs: %d, context: %X, free mem: %d (max: %d). context: %X", tcSettings.gcCount ? *tcSettings.gcCount : 0, skippedGC, nfree, nused, tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1, objCreated, iniT - lastGC, objLocked, currentContext, getFreeMemory(false), getFreeMemory(true), currentContext);
       iniT = getTimeStamp(); // discount the time used to compute these
    }
 
    skippedGC = objCreated = 0;
-   if (tcSettings.gcCount) (*tcSettings.gcCount)++;
+   if (tcSettings.gcCount && !remark) (*tcSettings.gcCount)++; // the incremental cycle was counted when it started
    IF_HEAP_ERROR(objStack->heap)
    {
       goto heaperror;
@@ -1100,84 +2259,64 @@ void gc2(Context currentContext, bool lockOMM)
    {
 heaperror:
       if (COMPUTETIME) alert("out of memory!");
+      markInParallel = false;
+      abortIncrementalGC(); // nothing is collected
       throwException(currentContext, OutOfMemoryError, "During object.mark stage");
       goto end;
    }
 
-   // 1. move the list of used objects to the free list
-   for (freeL=freeList, usedL=usedList, i=0; i <= OBJARRAY_MAX_INDEX; i++, freeL++,usedL++)
-      if (OBJ_PROPERTIES(*usedL)->next != null)
-         moveDblList(*usedL, *freeL);
+   // 1. mark all reachable objects
+   if (remark) // the objects were already marked by the incremental slices; just visit again what the write barrier doesn't cover
+   {
+      incrementalMarking = false;
+      visitMarkStack(false, 0);
+      markRoots(currentContext, true);
+   }
+   else
    if (!destroyingApplication) // if this is the last gc, just collect all objects
    {
-      Hashtable htCount;
-      bool traceLockedObjs = IS_VMTWEAK_ON(VMTWEAK_TRACE_LOCKED_OBJS);
-      int lockCount=0;
-      if (traceLockedObjs) htCount = htNew(511,null); else htCount.items = 0;
-      // 2. go through all the reachable objects and move them back to the used list
-      // 2a. static fields of loaded classes  
-      if (CANTRAVERSE)
-         htTraverse(&htLoadedClasses, markClass);                                
-#ifdef __gl2_h_
-      if (currentContext != mainContext) // in opengl, an image can only be freed in the main context, otherwise the texture will not be released
-      {                                                                                       
-         callGConMainThread = true; // set to run the gc on main thread so that the images can be collected
-         markAllImages(); // marking all images
-      }
-#endif                                         
-      // 2b. mark the locked objects
-      if (_TRACE_OBJCREATION) debug("G marking locked objs start");
-      for (o=OBJ_PROPERTIES(*lockList)->next; o != null; o = OBJ_PROPERTIES(o)->next)
-      {
-         if (traceLockedObjs)
-         {
-            if (strEq(OBJ_CLASS(o)->name,BYTE_ARRAY))
-               debug("locked ba: %X",o);
-            htInc(&htCount, (int32)OBJ_CLASS(o), 1);
-            lockCount++;
-         }
-         //if (_TRACE_OBJCREATION) debug("G marking locked obj %X",o);
-         if (OBJ_CLASS(o)->flags.isString) // 99% of the locked objects, due to the constant pool
-         {
-            OBJ_MARK(o) = markedAsUsed;
-            if (String_chars(o)) markSingleObject(String_chars(o),false);
-         }
-         else 
-            markObjects(o,false);
-      }
-      if (traceLockedObjs) 
+      markInParallel = gcWorkers > 1 && initMarkDeques();
+      markRoots(currentContext, false);
+      if (markInParallel)
       {
-         htTraverseWithKey(&htCount, dumpCount);
-         debug("locked: %d",lockCount);
+         markInParallel = false;
+         if (!parallelMark())
+            goto heaperror;
+         if (COMPUTETIME) debug("G marked with %d workers", gcWorkers);
       }
-      if (_TRACE_OBJCREATION) debug("G marking locked objs end");
-      // 2c. used objects in the object registers of all available contexts
-      markContexts();
    }
-   // now all reachable objects are moved to the still-alive list.
    /*if (COMPUTETIME) */compIni = getTimeStamp();
-   // 3. mark the free chunks as empty, so the compact can work correctly, and run the finalize methods if any
-   markedAsUsed = !markedAsUsed; // otherwise, objects allocated in this executeMethod will have problems when being collected
+   // 2. run the finalize methods of the objects that were not marked
    runningFinalizer = true;
    if (COMPUTETIME) debug("G finalizing objects");
    gcContext->litebasePtr = currentContext->litebasePtr;  // let litebase destroy the ptr if he wants so
    // bruno@tc134: split the finalize method call and the free object stages
-   for (i = 0, freeL = freeList; i <= OBJARRAY_MAX_INDEX; i++, freeL++)
-      if (*freeL)
-         for (o=OBJ_PROPERTIES(*freeL)->next; o != null; o = OBJ_PROPERTIES(o)->next)
-            finalizeObject(o, OBJ_CLASS(o));
-   for (i = 0, freeL = freeList; i <= OBJARRAY_MAX_INDEX; i++, freeL++)
-      if (*freeL)
-         for (o=OBJ_PROPERTIES(*freeL)->next; o != null; o = OBJ_PROPERTIES(o)->next)
-            if ((c = OBJ_CLASS(o)) != null)
-            {
-               if (_TRACE_OBJCREATION) debug("G object being freed: %X (%s)",o, OBJ_CLASS(o)->name);
-               if (traceCreatedClassObjs) htInc(&htObjsPerClass, (int32)OBJ_CLASS(o),-1);
-               OBJ_CLASS(o) = null; // set the object "free"
-            }
+   iniObjectIterator(&it, ITERATE_DEAD);
+   while ((o = nextObject(&it)) != null)
+      finalizeObject(o, OBJ_CLASS(o));
+   if (IS_VMTWEAK_ON(VMTWEAK_STRING_DEDUP) && !destroyingApplication)
+      deduplicateStrings();
+   if (IS_VMTWEAK_ON(VMTWEAK_HEAP_HISTOGRAM) && !destroyingApplication)
+      dumpHeapHistogram();
+   // 3. sweep: free the cells of the objects that were not marked, and clear the marks
+   if (gcWorkers > 1 && !traceCreatedClassObjs) // the chunks are shared among the workers; the large objects and the nursery are swept here
+   {
+      sweepNext = slabChunks;
+      threadRunParallel(gcWorkers, sweepWorker, null);
+      for (s = largeObjects; s != null; s = s->next)
+         sweepSlab(s, false);
+      if (nursery != null)
+         sweepSlab(nursery, false);
+   }
+   else
+   {
+      iniSlabIterator(&slabs);
+      while ((s = nextSlab(&slabs)) != null)
+         sweepSlab(s, traceCreatedClassObjs);
+   }
    currentContext->litebasePtr = gcContext->litebasePtr; // update the ptr
    if (COMPUTETIME) debug("G finished finalizers");
-   
+
    if (traceCreatedClassObjs)
    {
       debug("objects that were not destroyed");
@@ -1187,17 +2326,23 @@ heaperror:
    }
 
    runningFinalizer = false;
-   markedAsUsed = !markedAsUsed;
-   // 4. Join all adjacent free objects and free the chunk if only one object remains
-#ifndef ENABLE_TEST_SUITE // this scrambles the test
-   if (COMPUTETIME) debug("G joining chunks...");
-   heapFreeAsking(chunksHeap, joinAdjacentObjects);
-#endif
+   if (nursery != null)
+   {
+      if (IS_VMTWEAK_ON(VMTWEAK_GENERATIONAL_GC))
+         rebuildNursery();
+      else
+         releaseNursery();
+   }
+   // 4. give the empty slabs back to the size classes and the unused memory back to the system
+   if (COMPUTETIME) debug("G releasing memory...");
+   rebuildSlabLists();
 end:
    endT = getTimeStamp();
    //if (endT != iniT) debug("G GC elapsed: %d",endT-iniT);
-   if (tcSettings.gcTime) 
+   if (tcSettings.gcTime)
       *tcSettings.gcTime += endT - iniT;
+   updatePauseTime(pauseIni, false);
+   allocatedSinceGC = 0;
 
    //debug("gc %d - chunks %d",tcSettings.gcCount ? *tcSettings.gcCount : 0,tcSettings.chunksCreated ? *tcSettings.chunksCreated : 0);
 
@@ -1206,12 +2351,12 @@ end:
       int rdif;
       if (traceObjsCreatedBetween2GCs && !htP1.items)
       {
-         htP1 = htNew(511, null); 
+         htP1 = htNew(511, null);
          htP2 = htNew(511, null);
       }
-      nfree = countObjectsIn(freeList,false,false,-1,0);
+      nfree = countFreeCells();
       countp++;
-      nused = countObjectsIn(usedList,false,false,markedAsUsed, !traceObjsCreatedBetween2GCs ? null : countp == 1 ? &htP1 : &htP2);
+      nused = countObjects(ITERATE_LIVE, !traceObjsCreatedBetween2GCs ? null : countp == 1 ? &htP1 : &htP2);
       rdif = nused-lastUsed;
       if (traceObjsCreatedBetween2GCs && htP1.size > 0 && htP2.size > 0)
       {
@@ -1221,22 +2366,19 @@ end:
          htP1 = htP2;
          htP2 = htNew(511,null);
       }
-      debug("GC %d : free: %d, used: %d (dif: %d), chunks: %d, elapsed: %4d (compact: %3d)", tcSettings.gcCount ? *tcSettings.gcCount : 0,nfree, nused, rdif, tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1, endT-iniT, endT - compIni);
+      debug("GC %d : free: %d, used: %d (dif: %d), chunks: %d, elapsed: %4d (sweep: %3d)", tcSettings.gcCount ? *tcSettings.gcCount : 0,nfree, nused, rdif, tcSettings.chunksCreated ? *tcSettings.chunksCreated : 1, endT-iniT, endT - compIni);
       lastUsed = nused;
    }
-   // and now INVERT THE MARK BIT
-   markedAsUsed = !markedAsUsed;
 
    if (IS_VMTWEAK_ON(VMTWEAK_AUDIBLE_GC))
    {
 #ifdef WIN32
       soundTone(1100,10);
-#else      
+#else
       vmVibrate(50);
 #endif
    }
 
-   //debug("G Freed objects (including allocated chunks)"); countObjectsIn(freeList,false);
    lastGC = getTimeStamp(); // guich@tc210: moving to begining will make only one thread using the gc and the others will just allocate the needed memory. this fixes a crash in LaudoMovel loading jpegs in threads. guich@tc330: moving to the end fixes 2 threads being able to call gc one after the other, thus spending time in the 2nd call
    runningGC = false;
    if (lockOMM) UNLOCKVAR(omm);
@@ -41,6 +41,15 @@ typedef TCObject (*createStringObjectFromTCHARPFunc)(Context currentContext, TCH
 /// if len<0, len is computed from srcChars length
 TC_API TCObject createStringObjectFromCharP(Context currentContext, CharP srcChars, int32 len);
 typedef TCObject (*createStringObjectFromCharPFunc)(Context currentContext, CharP srcChars, int32 len);
+/// Creates a compact string, whose chars are stored in a byte array of the given length that must be filled by the caller
+TCObject createLatin1StringObjectWithLen(Context currentContext, int32 len);
+/// Returns the UTF-16 chars of a string. A compact (Latin-1) string is widened into a temporary char array and stays compact;
+/// the array is kept until the native method running in the context returns. If there's no memory, throws OutOfMemoryError and returns null.
+/// The natives that understand the compact strings use String_isLatin1 and String_latin1Start instead.
+TC_API JCharP widenString(Context currentContext, TCObject str);
+typedef JCharP (*widenStringFunc)(Context currentContext, TCObject str);
+/// Unlocks the arrays created by widenString after the first count ones. Called when a native method returns.
+void releaseWidenedStrings(Context currentContext, int32 count);
 /// if len<0, len is computed from srcChars length, use when creating code for both WinCE and Win32
 #if defined(UNICODE)
 #define createStringObjectFromTCHAR createStringObjectFromJCharP
@@ -67,8 +76,8 @@ void runFinalizers();
 void visitImages(VisitElementFunc onImage, int32 param);
 
 /// Changes the object lock state, in a NON-RECURSIVE way.
-/// Locking an object: The object will be removed from the used list and will never be garbage collected.
-/// Unlocking an object: The object will be placed back in the used list and will be eligible to be garbage collected
+/// Locking an object: The object's bit is set in the lock bitmap of its slab, and it will never be garbage collected.
+/// Unlocking an object: The bit is cleared and the object will be eligible to be garbage collected
 /// If you lock an object, all objects inside of it are still visited during a GC, so you have to lock only the root of
 /// an object tree to keep all them in memory.
 TC_API void setObjectLock(TCObject o, LockState lock);
@@ -77,32 +86,64 @@ typedef void (*setObjectLockFunc)(TCObject o, LockState lock);
 /// Returns a pointer to the Object properties given an Object
 #define OBJ_PROPERTIES(o) ((ObjectProperties)(((uint8*)(o))-sizeof(TObjectProperties)))
 #define OBJ_ISLOCKED(o)     (OBJ_PROPERTIES(o)->lock  == 1)
+#define OBJ_ISYOUNG(o)      (OBJ_PROPERTIES(o)->young == 1)
+
+/// Adds an old object to the remembered set, so the next minor collection visits its fields. Use the WRITE_BARRIER macro instead.
+TC_API void rememberObject(TCObject holder);
+typedef void (*rememberObjectFunc)(TCObject holder);
+/// Marks an object that was not visited yet by the incremental gc and is being stored somewhere. Use the WRITE_BARRIER macro instead.
+TC_API void shadeObject(TCObject o);
+typedef void (*shadeObjectFunc)(TCObject o);
+/// Tracks a reference that was stored into a field or array element of holder. Use the WRITE_BARRIER macro instead.
+TC_API void writeBarrier(TCObject holder, TCObject value);
+typedef void (*writeBarrierFunc)(TCObject holder, TCObject value);
+/// Must be called after storing the reference value into a field or array element of holder, including the stores done by
+/// native methods. The VM also tracks the parameters of a native method when it returns, but any other object it changes,
+/// like one reached through a parameter or a new object it fills, is only seen by the gc through this barrier.
+#if defined(TC_EXPORTS) || defined(DONT_PREFIX_WITH_TC_FOR_LIBRARIES)
+#define WRITE_BARRIER(holder, value) do {if ((value) != null) {if (incrementalMarking) shadeObject(value); else if (OBJ_ISYOUNG(value) && !OBJ_ISYOUNG(holder) && !OBJ_PROPERTIES(holder)->remembered) rememberObject(holder);}} while (0)
+#else
+#define WRITE_BARRIER(holder, value) TC_writeBarrier(holder, value)
+#endif
+/// Acknowledges a new gcEpoch: the next write barriers of this thread see incrementalMarking set. Use the GC_SAFEPOINT macro instead.
+void gcSafepoint(Context c);
+/// Called by the interpreter where the thread is not between a store and its write barrier: the jumps, the calls and
+/// before blocking. The incremental gc only marks the roots after all threads that run bytecode passed through one.
+#define GC_SAFEPOINT(c) if ((c)->gcEpoch != gcEpoch) gcSafepoint(c);
+/// Tracks the objects in the given registers; called after a native method returns, for the natives of older libraries that store into their parameters without a write barrier
+void rememberNativeParams(TCObjectArray regO, int32 count);
+/// Runs a slice of the incremental gc, if Vm.TWEAK_INCREMENTAL_GC is on: starts a new cycle if enough memory was allocated since the last one
+/// and marks objects during Settings.gcSliceBudget microseconds. When all objects were visited, the cycle is finished.
+void gcStep(Context currentContext);
 
 /** A Java Object is a Class instance.
  *
  * The instance field values are stored here, while all the other members
  * (including the static fields and the instance field definitions) are stored
  * in the Class member.
- * The next,prev and temp fields are used by the memory manager.
+ * The mark bits are kept in a side bitmap of the slab where the object is;
+ * see objectmemorymanager.c.
  *
  * An Object is composed by its ObjectProperties, followed by a Value array.
  */
 struct TObjectProperties
 {
    TCClass class_;
-   TCObject next,prev;
    struct
    {
-      uint32 size: 30; // object's size
+      uint32 size: 28; // object's size
       uint32 lock: 1;  // lock the object, preventing it from being gc'd. The initial purpose of locking an object was to lock all constant pool strings and speedup the garbage collector process.
-      uint32 mark: 1;  // mark the object during a garbage collect.
-#if TBITS==64
-      uint32 dumb;
-#endif
+      uint32 young: 1; // object was allocated in the nursery and did not survive a collection yet
+      uint32 remembered: 1; // old object that is in the remembered set, because it may point to young objects
    };
+   volatile uint32 monitor; // thin lock used by the synchronized statement; see monitorEnter in tcthread.c
 };
 
 typedef uint8* Chunk;
+typedef struct TSlab TSlab;
+typedef TSlab* Slab; // a block of objects of the same size class; see objectmemorymanager.c
+typedef struct TSlabChunk TSlabChunk;
+typedef TSlabChunk* SlabChunk;
 
 /// Returns the Class of a given Object
 #define OBJ_CLASS(o) OBJ_PROPERTIES(o)->class_ // get class from an object
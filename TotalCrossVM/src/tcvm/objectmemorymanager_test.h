@@ -5,14 +5,21 @@
 
 static bool saveRestoreOMM(bool save)
 {
+   // the state that is private to objectmemorymanager.c
+   static uint32 allocatedSinceGC2, largeAllocatedSinceGC2, largeObjectsSize2;
+   static Slab nursery2;
+   static uint8 *nurseryStart2, *nurseryEnd2, *nurseryTop2, *nurseryLimit2, *nurseryHoles2;
+   static TCObject* rememberedSet2;
+   static int32 rememberedCount2, rememberedCapacity2;
+   static TMarkDeque* markDeques2;
    if (save)
    {
       CANTRAVERSE = false;
       // save
-      freeList2 = freeList;             freeList = null;
-      usedList2 = usedList;             usedList = null;
-      lockList2 = lockList;             lockList = null;
-      markedAsUsed2 = markedAsUsed;     markedAsUsed = 0;
+      partialSlabs2 = partialSlabs;     partialSlabs = null;
+      emptySlabs2 = emptySlabs;         emptySlabs = null;
+      largeObjects2 = largeObjects;     largeObjects = null;
+      slabChunks2 = slabChunks;         slabChunks = null;
       gcCount2 = *tcSettings.gcCount;   *tcSettings.gcCount = 0;
       ommHeap2 = ommHeap;               ommHeap = null;
       chunksHeap2 = chunksHeap;         chunksHeap = null;
@@ -20,6 +27,19 @@ static bool saveRestoreOMM(bool save)
       skippedGC2 = skippedGC;           skippedGC = 0;
       objLocked2 = objLocked;           objLocked = 0;
       objStack2 = objStack;             objStack = null;
+      allocatedSinceGC2 = allocatedSinceGC;           allocatedSinceGC = 0;
+      largeAllocatedSinceGC2 = largeAllocatedSinceGC; largeAllocatedSinceGC = 0;
+      largeObjectsSize2 = largeObjectsSize;           largeObjectsSize = 0;
+      nursery2 = nursery;               nursery = null;
+      nurseryStart2 = nurseryStart;     nurseryStart = null;
+      nurseryEnd2 = nurseryEnd;         nurseryEnd = null;
+      nurseryTop2 = nurseryTop;         nurseryTop = null;
+      nurseryLimit2 = nurseryLimit;     nurseryLimit = null;
+      nurseryHoles2 = nurseryHoles;     nurseryHoles = null;
+      rememberedSet2 = rememberedSet;   rememberedSet = null;
+      rememberedCount2 = rememberedCount;       rememberedCount = 0;
+      rememberedCapacity2 = rememberedCapacity; rememberedCapacity = 0;
+      markDeques2 = markDeques;         markDeques = null;
 
       return initObjectMemoryManager();
    }
@@ -27,10 +47,10 @@ static bool saveRestoreOMM(bool save)
    {
       destroyObjectMemoryManager(); // destroy currently allocated objects
 
-      freeList = freeList2;
-      usedList = usedList2;
-      lockList = lockList2;
-      markedAsUsed = markedAsUsed2;
+      partialSlabs = partialSlabs2;
+      emptySlabs = emptySlabs2;
+      largeObjects = largeObjects2;
+      slabChunks = slabChunks2;
       *tcSettings.gcCount = gcCount2;
       ommHeap = ommHeap2;
       chunksHeap = chunksHeap2;
@@ -38,13 +58,26 @@ static bool saveRestoreOMM(bool save)
       skippedGC = skippedGC2;
       objLocked = objLocked2;
       objStack = objStack2;
+      allocatedSinceGC = allocatedSinceGC2;
+      largeAllocatedSinceGC = largeAllocatedSinceGC2;
+      largeObjectsSize = largeObjectsSize2;
+      nursery = nursery2;
+      nurseryStart = nurseryStart2;
+      nurseryEnd = nurseryEnd2;
+      nurseryTop = nurseryTop2;
+      nurseryLimit = nurseryLimit2;
+      nurseryHoles = nurseryHoles2;
+      rememberedSet = rememberedSet2;
+      rememberedCount = rememberedCount2;
+      rememberedCapacity = rememberedCapacity2;
+      markDeques = markDeques2;
 
       CANTRAVERSE = true;
       return true;
    }
 }
 
-TESTCASE(StringObject) // #DEPENDS(DblList)
+TESTCASE(StringObject) // #DEPENDS(SlabAllocator)
 {
    JChar buf[9];
    JCharP s = CharP2JCharPBuf("Michelle",8, buf, true);
@@ -64,10 +97,36 @@ TESTCASE(StringObject) // #DEPENDS(DblList)
    finish: ;
 }
 
-static TCObject _newObj()
+TESTCASE(StringDeduplication) // #DEPENDS(StringObject)
 {
-   Chunk c = xmalloc(4+sizeof(TObjectProperties));
-   return (TCObject)(c+sizeof(TObjectProperties));
+   JChar buf[9];
+   JCharP s = CharP2JCharPBuf("Michelle",8, buf, true);
+   TCObjectArray regO = currentContext->regO;
+   int32 tweaks = vmTweaks, i;
+   TCObject o[4];
+   for (i = 0; i < 4; i++)
+   {
+      buf[7] = i == 3 ? 'a' : 'e';
+      o[i] = currentContext->regO[i] = createStringObjectFromJCharP(currentContext, s, 8);
+      setObjectLock(o[i], UNLOCKED);
+   }
+   currentContext->regO += 4; // keep them alive
+   buf[7] = 'e';
+   String_hashCache(o[0]) = String_hashCache(o[1]) = STRING_HASH_CACHED | (uint32)JCharPHashCode(s, 8);
+   // o[2] has no cached hash, so it is not checked
+   vmTweaks |= 1 << (VMTWEAK_STRING_DEDUP-1);
+   gc(currentContext);
+   ASSERT2_EQUALS(Ptr, String_chars(o[0]), String_chars(o[1]));
+   ASSERT1_EQUALS(True, String_chars(o[2]) != String_chars(o[0]));
+   String_hashCache(o[3]) = String_hashCache(o[0]); // same hash, different chars
+   gc(currentContext);
+   ASSERT2_EQUALS(Ptr, String_chars(o[0]), String_chars(o[1]));
+   ASSERT1_EQUALS(True, String_chars(o[3]) != String_chars(o[0]));
+   ASSERT2_EQUALS(I32, String_charsLen(o[3]), 8);
+   ASSERT3_EQUALS(Block, String_charsStart(o[1]), s, 16);
+   finish:
+   vmTweaks = tweaks;
+   currentContext->regO = regO;
 }
 
 TESTCASE(Stack) // #3
@@ -160,75 +219,99 @@ finish:
    stackDestroy(s);
 }
 
-TESTCASE(DblList) // #4
+static int32 countEmptySlabs()
 {
-   TCObject o1,o2,o3,o4,o5,head;
-   ObjectProperties p1,p2,p3,p4,p5,ph;
-   o1 = _newObj();
-   o2 = _newObj();
-   o3 = _newObj();
-   o4 = _newObj();
-   o5 = _newObj();
-   head = _newObj();
-   p1 = OBJ_PROPERTIES(o1);
-   p2 = OBJ_PROPERTIES(o2);
-   p3 = OBJ_PROPERTIES(o3);
-   p4 = OBJ_PROPERTIES(o4);
-   p5 = OBJ_PROPERTIES(o5);
-   ph = OBJ_PROPERTIES(head);
-
-   insertNodeInDblList(head, o1);
-   ASSERT2_EQUALS(Ptr,ph->next,o1);
-   ASSERT2_EQUALS(Ptr,p1->prev,head);
-   insertNodeInDblList(head, o2);
-   ASSERT2_EQUALS(Ptr,ph->next,o2);
-   ASSERT2_EQUALS(Ptr,p1->prev,o2);
-   ASSERT2_EQUALS(Ptr,p2->next,o1);
-   ASSERT2_EQUALS(Ptr,p2->prev,head);
-   insertNodeInDblList(head, o3);
-   ASSERT2_EQUALS(Ptr,ph->next,o3);
-   ASSERT2_EQUALS(Ptr,p2->prev,o3);
-   ASSERT2_EQUALS(Ptr,p3->next,o2);
-   ASSERT2_EQUALS(Ptr,p3->prev,head);
-   insertNodeInDblList(head, o4);
-   ASSERT2_EQUALS(Ptr,ph->next,o4);
-   ASSERT2_EQUALS(Ptr,p3->prev,o4);
-   ASSERT2_EQUALS(Ptr,p4->next,o3);
-   ASSERT2_EQUALS(Ptr,p4->prev,head);
-   insertNodeInDblList(head, o5);
-   ASSERT2_EQUALS(Ptr,ph->next,o5);
-   ASSERT2_EQUALS(Ptr,p4->prev,o5);
-   ASSERT2_EQUALS(Ptr,p5->next,o4);
-   ASSERT2_EQUALS(Ptr,p5->prev,head);
-   ASSERT2_EQUALS(Ptr,ph->prev,o1); // last
-
-   removeNodeFromDblList(head,o1);
-   ASSERT2_EQUALS(Ptr,p2->next,null);
-   ASSERT2_EQUALS(Ptr,ph->prev,o2); // last
-   removeNodeFromDblList(head,o2);
-   ASSERT2_EQUALS(Ptr,p3->next,null);
-   ASSERT2_EQUALS(Ptr,ph->prev,o3); // last
-   removeNodeFromDblList(head,o4);
-   ASSERT2_EQUALS(Ptr,p5->next,o3);
-   ASSERT2_EQUALS(Ptr,p5->prev,head);
-   ASSERT2_EQUALS(Ptr,p3->prev,o5);
-   ASSERT2_EQUALS(Ptr,ph->prev,o3); // last
-   removeNodeFromDblList(head,o5);
-   ASSERT2_EQUALS(Ptr,ph->next,o3);
-   ASSERT2_EQUALS(Ptr,p3->next,null);
-   ASSERT2_EQUALS(Ptr,p3->prev,head);
-   ASSERT2_EQUALS(Ptr,ph->prev,o3); // last
-   removeNodeFromDblList(head,o3);
-   ASSERT2_EQUALS(Ptr,ph->next,null);
-   ASSERT2_EQUALS(Ptr,ph->prev,null); // last
+   Slab s;
+   int32 n = 0;
+   for (s = emptySlabs; s != null; s = s->next)
+      n++;
+   return n;
+}
 
-finish:
-   xfree(p1);
-   xfree(p2);
-   xfree(p3);
-   xfree(p4);
-   xfree(p5);
-   xfree(ph);
+TESTCASE(SlabAllocator) // #4
+{
+   int32 c,size,i;
+   uint32 idx,idx2;
+   Slab s;
+   TCObject o1 = null, o2 = null, big = null;
+
+   if (!saveRestoreOMM(true))
+   {
+      alert("Not enough memory to\nrun SlabAllocator\ntest case.\nAborting tests!");
+      TEST_ABORT;
+   }
+   // 1. each size goes to the smallest class that fits it
+   for (size = TSIZE; size <= SLAB_MAX_OBJECT_SIZE; size += TSIZE)
+   {
+      c = sizeToClass[size/TSIZE];
+      ASSERT1_EQUALS(True, slabClassSizes[c] >= size);
+      ASSERT1_EQUALS(True, c == 0 || slabClassSizes[c-1] < size);
+   }
+   // 2. the cells and the bitmaps of each class fit in a slab
+   for (c = 0; c < SLAB_CLASSES; c++)
+   {
+      ASSERT1_EQUALS(True, classCells[c] > 0);
+      ASSERT1_EQUALS(True, classStart[c] >= sizeof(TSlab) + 3*4*((classCells[c]+31)/32));
+      ASSERT1_EQUALS(True, classStart[c] + classCells[c] * (slabClassSizes[c] + sizeof(TObjectProperties)) <= SLAB_SIZE);
+   }
+   // 3. the first chunk has only empty slabs
+   ASSERT1_EQUALS(NotNull, slabChunks);
+   ASSERT1_EQUALS(Null, slabChunks->next);
+   ASSERT2_EQUALS(I32, countEmptySlabs(), CHUNK_SLABS);
+   // 4. small objects: the slab is found by masking the address, and the object's bit is set in the bitmaps
+   o1 = createByteArray(currentContext, 4);
+   o2 = createByteArray(currentContext, 4);
+   ASSERT1_EQUALS(NotNull, o1);
+   ASSERT1_EQUALS(NotNull, o2);
+   s = getSlab(o1, &idx);
+   ASSERT2_EQUALS(I32, s->kind, SLAB_SMALL);
+   ASSERT2_EQUALS(I32, (int32)((size_t)s & (SLAB_SIZE-1)), 0);
+   ASSERT2_EQUALS(Ptr, s->chunk, slabChunks);
+   ASSERT2_EQUALS(Ptr, s->start + idx * s->cellSize, OBJECT2CHUNK(o1));
+   ASSERT1_EQUALS(True, BIT_ISSET(s->live, idx));
+   ASSERT1_EQUALS(True, BIT_ISSET(s->locks, idx));
+   ASSERT1_EQUALS(False, BIT_ISSET(s->marks, idx));
+   ASSERT2_EQUALS(Ptr, getSlab(o2, &idx2), s); // same size class, same slab, next cell
+   ASSERT2_EQUALS(I32, idx2, idx+1);
+   ASSERT2_EQUALS(I32, s->usedCount, 2);
+   ASSERT2_EQUALS(I32, countEmptySlabs(), CHUNK_SLABS-1);
+   setObjectLock(o1, UNLOCKED);
+   ASSERT1_EQUALS(False, BIT_ISSET(s->locks, idx));
+   ASSERT1_EQUALS(False, OBJ_ISLOCKED(o1));
+   ASSERT1_EQUALS(True, BIT_ISSET(s->live, idx));
+   ASSERT2_EQUALS(I32, countObjects(ITERATE_LIVE, null), 2);
+   ASSERT2_EQUALS(I32, countObjects(ITERATE_LOCKED, null), 1);
+   // 5. the other classes get their own slabs
+   for (i = 0, size = 16; size <= 1024; size *= 2, i++)
+   {
+      o1 = createByteArray(currentContext, size);
+      ASSERT1_EQUALS(NotNull, o1);
+      ASSERT1_EQUALS(True, getSlab(o1, &idx) != s);
+      setObjectLock(o1, UNLOCKED);
+   }
+   // 6. large objects have their own block
+   big = createByteArray(currentContext, SLAB_MAX_OBJECT_SIZE * 4);
+   ASSERT1_EQUALS(NotNull, big);
+   s = getSlab(big, &idx);
+   ASSERT2_EQUALS(I32, s->kind, SLAB_LARGE);
+   ASSERT2_EQUALS(Ptr, s, largeObjects);
+   ASSERT2_EQUALS(I32, idx, 0);
+   ASSERT2_EQUALS(I32, s->live[0], 1);
+   ASSERT2_EQUALS(I32, s->locks[0], 1);
+   setObjectLock(big, UNLOCKED);
+   setObjectLock(o2, UNLOCKED);
+   ASSERT2_EQUALS(I32, countObjects(ITERATE_LOCKED, null), 0);
+   // 7. nothing is held: everything is collected and the slabs become empty again
+   currentContext->regO = currentContext->regOStart;
+   gc(currentContext);
+   ASSERT2_EQUALS(I32, countObjects(ITERATE_LIVE, null), 0);
+   ASSERT1_EQUALS(Null, largeObjects);
+   ASSERT2_EQUALS(I32, countEmptySlabs(), CHUNK_SLABS);
+   for (c = 0; c < SLAB_CLASSES; c++)
+      ASSERT1_EQUALS(Null, partialSlabs[c]);
+
+   finish:
+   saveRestoreOMM(false);
 }
 
 static TCObject allocAndFillObj(Context currentContext, uint32 size, uint8 fillWith)
@@ -239,16 +322,14 @@ static TCObject allocAndFillObj(Context currentContext, uint32 size, uint8 fillW
       xmemset(ARRAYOBJ_START(o), fillWith, size);
    return o;
 }
-// This test will implement the explanation in the top of the file objectmemorytest.c
 // MUST COME RIGHT AFTER ArrayFileCreation TEST CASE !!!
 TESTCASE(GarbageCollector) // #5
 {
-   int32 nfree,nused;
+   int32 i,n;
    TCObjectArray held = currentContext->regOStart; // objects that will be held (in use) after the GC
    TCObjectArray held0 = held;
-   TCObject rel1,rel2,rel3,rel4,rel5,rel13,rel14;         // objects that will be released (ready to be reused later)
-   TCObject rel6,rel7,rel8,rel9,rel10,rel11,rel12;        // objects that will be released (ready to be reused later)
-   TCObject free1,free2;                                  // objects that will be freed (returned to the system)
+   TCObject rel1,rel2,rel3,rel4,rel5,locked,o; // objects that will be released (ready to be reused later)
+   TCObject free1,free2;                        // large objects that will be freed (returned to the system)
 
    if (!saveRestoreOMM(true))
    {
@@ -256,15 +337,12 @@ TESTCASE(GarbageCollector) // #5
       TEST_ABORT;
    }
 
-   // 0. make sure all the lists are empty
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 1, nfree); // only the first chunk exist.
-   ASSERT2_EQUALS(I32, 0, nused);
+   // 0. make sure there are no objects
+   ASSERT2_EQUALS(I32, 0, countObjects(ITERATE_LIVE, null));
    // 1. alloc some objects, pushing some objects to the object's stack
-   rel1    = allocAndFillObj(currentContext,DEFAULT_CHUNK_SIZE-4-8-sizeof(TObjectProperties),1); // big object 1 - compute the size to let allocate held[0] below
-   free1   = allocAndFillObj(currentContext,DEFAULT_CHUNK_SIZE-4,  2); // big object 2 - will have exactly DEFAULT_CHUNK_SIZE bytes. * WILL BE COLLECTED
-   *held++ = allocAndFillObj(currentContext,4,3); // this will be allocated in the remaining block of huge object 1
+   rel1    = allocAndFillObj(currentContext,1500,1);
+   free1   = allocAndFillObj(currentContext,DEFAULT_CHUNK_SIZE-4,  2); // large object 1 - * WILL BE COLLECTED
+   *held++ = allocAndFillObj(currentContext,4,3);
    *held++ = allocAndFillObj(currentContext,4,4);
    rel2    = allocAndFillObj(currentContext,4,5);
    *held++ = allocAndFillObj(currentContext,14,6);
@@ -274,7 +352,8 @@ TESTCASE(GarbageCollector) // #5
    rel3    = allocAndFillObj(currentContext,24,10);
    rel4    = allocAndFillObj(currentContext,24,11);
    rel5    = allocAndFillObj(currentContext,24,12);
-   free2   = allocAndFillObj(currentContext,DEFAULT_CHUNK_SIZE+10,13); // huge object 1 - * WILL BE COLLECTED
+   free2   = allocAndFillObj(currentContext,DEFAULT_CHUNK_SIZE+10,13); // large object 2 - * WILL BE COLLECTED
+   locked  = createByteArray(currentContext, 40); // not held, but locked
    // 1b. check if the objects were created correctly
    ASSERT3_EQUALS(Filled, ARRAYOBJ_START(    rel1), ARRAYOBJ_LEN(rel1)    , 1);
    ASSERT3_EQUALS(Filled, ARRAYOBJ_START(   free1), ARRAYOBJ_LEN(free1)   , 2);
@@ -289,103 +368,307 @@ TESTCASE(GarbageCollector) // #5
    ASSERT3_EQUALS(Filled, ARRAYOBJ_START(    rel4), ARRAYOBJ_LEN(rel4)    , 11);
    ASSERT3_EQUALS(Filled, ARRAYOBJ_START(    rel5), ARRAYOBJ_LEN(rel5)    , 12);
    ASSERT3_EQUALS(Filled, ARRAYOBJ_START(   free2), ARRAYOBJ_LEN(free2)   , 13);
-   // 1b. mark the end of pushed objects - the method should do this too.
+   // 1c. mark the end of pushed objects - the method should do this too.
    currentContext->regO/*Protected */= held;
-   // 1c. check if the objects were created in the right places
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 1, nfree); // first chunk still exists
-   ASSERT2_EQUALS(I32, 13, nused);
+   ASSERT2_EQUALS(I32, 14, countObjects(ITERATE_LIVE, null));
+   ASSERT2_EQUALS(I32, 1, countObjects(ITERATE_LOCKED, null));
+   ASSERT1_EQUALS(NotNull, largeObjects);
    // 2. run the GC
    gc(currentContext);
-   // 2b. check if only the held objects are alive
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 8, nfree); // rel1-rel5 + first chunk - two objects were freed
-   ASSERT2_EQUALS(I32, 6, nused); // held objects
-   // 3. allocate 12 objects
-   held = currentContext->regO/*Protected*/ - 2; // simulate the release of a two held objects. note that these are in the longlive list, so they won't be freed in the next gc
-   *held++ = allocAndFillObj(currentContext,34,13);
-   *held++ = allocAndFillObj(currentContext,34,14);
-   rel6    = allocAndFillObj(currentContext,34,15);
-   rel7    = allocAndFillObj(currentContext,34,16);
-   *held++ = allocAndFillObj(currentContext,4,17); // take space of rel2
-   *held++ = allocAndFillObj(currentContext,4,18);
-   rel8    = allocAndFillObj(currentContext,4,19);
-   rel9    = allocAndFillObj(currentContext,4,20);
-   *held++ = allocAndFillObj(currentContext,16,21);
-   *held++ = allocAndFillObj(currentContext,16,22);
-   *held++ = allocAndFillObj(currentContext,16,23);
-   rel10   = allocAndFillObj(currentContext,16,24);
-   // 3b. mark the end of pushed objects
-   currentContext->regO/*Protected*/ = held;
-   // 3c. check if the objects were created in the right places
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 7, nfree);
-   ASSERT2_EQUALS(I32, 6+12, nused); // all objects allocated since the last gc
-   // 4. run the GC
+   // 2b. check if only the held and the locked objects are alive, and the large ones were given back
+   ASSERT2_EQUALS(I32, 6+1, countObjects(ITERATE_LIVE, null));
+   ASSERT1_EQUALS(Null, largeObjects);
+   ASSERT2_EQUALS(I32, 0, countObjects(ITERATE_DEAD, null)); // marks are cleared after the sweep
+   for (i = 0; i < 6; i++)
+      ASSERT3_EQUALS(Filled, ARRAYOBJ_START(held0[i]), ARRAYOBJ_LEN(held0[i]), i < 2 ? 3+i : 4+i);
+   ASSERT1_EQUALS(Null, OBJ_CLASS(rel2)); // freed cells have no class
+   // 3. a freed cell is the first one to be reused by its size class
+   o = allocAndFillObj(currentContext,4,14);
+   ASSERT2_EQUALS(Ptr, o, rel2);
+   o = allocAndFillObj(currentContext,24,15);
+   ASSERT1_EQUALS(True, o == rel3 || o == rel4 || o == rel5);
+   *held++ = o;
+   currentContext->regO = held;
+   // 4. unlocking the locked object makes it collectable
+   setObjectLock(locked, UNLOCKED);
    gc(currentContext);
-   // 4b. check if only the held objects are alive
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 5-1+5+2+1+2, nfree);
-   ASSERT2_EQUALS(I32, 7+6-2, nused);
-   // 5. allocate another bunch of objects
-   held    = currentContext->regO/*Protected*/ - 1; // simulate the release of 1 held object.
-   *held++ = allocAndFillObj(currentContext,34,25); // take space of rel7
-   rel11   = allocAndFillObj(currentContext,4,26);  // take place of rel9
-   rel12   = allocAndFillObj(currentContext,16,27);
-   // 5b. mark the end of pushed objects
-   currentContext->regO/*Protected */= held;
-   // 5c. check if the objects were created in the right places
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 12-1, nfree);
-   ASSERT2_EQUALS(I32, 11+3, nused);
-   // 5d. run the GC
-   gc(currentContext);
-   // 5e. check if only the held objects are alive
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 12+2, nfree);
-   ASSERT2_EQUALS(I32, 11, nused);
-   // 6. allocate another bunch of objects
-   held    = currentContext->regO/*Protected */- 3; // simulate the release of 3 held objects.
-   *held++ = allocAndFillObj(currentContext,34,28); // take place of rel6
-   rel13   = allocAndFillObj(currentContext,4,29);  // take place of rel8
-   rel14   = allocAndFillObj(currentContext,16,30);
-   // 6b. mark the end of pushed objects
-   currentContext->regO/*Protected */= held;
-   // 6c. check if the objects were created in the right places
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 14-3, nfree);
-   ASSERT2_EQUALS(I32, 11+3, nused);
-   // 6d. run the GC
+   ASSERT2_EQUALS(I32, 7, countObjects(ITERATE_LIVE, null));
+   ASSERT3_EQUALS(Filled, ARRAYOBJ_START(held0[6]), ARRAYOBJ_LEN(held0[6]), 15);
+   // 5. fill more than a chunk: a new chunk is created
+   n = DEFAULT_CHUNK_SIZE / 1024 + 16;
+   for (i = 0; i < n; i++)
+      allocAndFillObj(currentContext,1000,16);
+   ASSERT1_EQUALS(NotNull, slabChunks->next);
+   ASSERT2_EQUALS(I32, 7+n, countObjects(ITERATE_LIVE, null));
+   // 6. after they are collected, the empty chunk is given back
    gc(currentContext);
-   // 6e. check if only the held objects are alive
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 14+2, nfree);
-   ASSERT2_EQUALS(I32, 14-3-2, nused);
-   // 7a. run the GC again, just to make sure nothing else will be collected
+   ASSERT2_EQUALS(I32, 7, countObjects(ITERATE_LIVE, null));
+   ASSERT1_EQUALS(Null, slabChunks->next);
+   // 7. run the GC again, just to make sure nothing else will be collected
    gc(currentContext);
-   // 7b. check if only the held objects are alive
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 16, nfree);
-   ASSERT2_EQUALS(I32, 9, nused);
+   ASSERT2_EQUALS(I32, 7, countObjects(ITERATE_LIVE, null));
    // 8. release everyone
    currentContext->regO/*Protected*/ = currentContext->regOStart;
-   // 8a. run the GC
    gc(currentContext);
-   // 8b. check if only the held objects are alive
-   nfree = countObjectsIn(freeList,false,false,markedAsUsed);
-   nused = countObjectsIn(usedList,false,false,markedAsUsed);
-   ASSERT2_EQUALS(I32, 25, nfree);
-   ASSERT2_EQUALS(I32, 0, nused);
+   ASSERT2_EQUALS(I32, 0, countObjects(ITERATE_LIVE, null));
+   ASSERT2_EQUALS(I32, CHUNK_SLABS, countEmptySlabs());
+
+   finish:
+   saveRestoreOMM(false);
+}
+
+#define OBJARRAY_AT(a, i) ((TCObjectArray)ARRAYOBJ_START(a))[i]
+
+TESTCASE(GenerationalGC) // #DEPENDS(GarbageCollector)
+{
+   int32 tweaks = vmTweaks;
+   uint32 idx;
+   bool collected;
+   TCObjectArray held = currentContext->regOStart;
+   TCObject outer, holder, filled, young, dead, survivor, child, o;
+
+   if (!saveRestoreOMM(true))
+   {
+      alert("Not enough memory to\nrun GenerationalGC\ntest case.\nAborting tests!");
+      TEST_ABORT;
+   }
+   // 1. old objects: created before the generational mode is turned on. The holders are only reached through outer
+   vmTweaks &= ~(1 << (VMTWEAK_GENERATIONAL_GC-1));
+   outer  = createArrayObject(currentContext, "[java.lang.Object", 2);
+   holder = createArrayObject(currentContext, "[java.lang.Object", 1);
+   filled = createArrayObject(currentContext, "[java.lang.Object", 1); // stays locked, as if a native method were filling it
+   ASSERT1_EQUALS(NotNull, filled);
+   setObjectLock(outer, UNLOCKED);
+   setObjectLock(holder, UNLOCKED);
+   OBJARRAY_AT(outer, 0) = holder;
+   OBJARRAY_AT(outer, 1) = filled;
+   *held++ = outer;
+   ASSERT1_EQUALS(False, OBJ_ISYOUNG(outer));
+   ASSERT1_EQUALS(False, OBJ_ISYOUNG(filled));
+   // 2. young objects are bumped in the nursery
+   vmTweaks |= 1 << (VMTWEAK_GENERATIONAL_GC-1);
+   young = allocAndFillObj(currentContext, 16, 1);
+   dead = allocAndFillObj(currentContext, 16, 2);
+   survivor = allocAndFillObj(currentContext, 16, 3);
+   child = allocAndFillObj(currentContext, 16, 4);
+   ASSERT1_EQUALS(NotNull, child);
+   ASSERT1_EQUALS(True, OBJ_ISYOUNG(young));
+   ASSERT2_EQUALS(Ptr, getSlab(young, &idx), nursery);
+   ASSERT2_EQUALS(Ptr, (uint8*)OBJECT2CHUNK(dead), (uint8*)young + OBJ_SIZE(young));
+   *held++ = young;
+   currentContext->regO = held;
+   // 3. an old object that receives a young one through the write barrier is remembered
+   OBJARRAY_AT(holder, 0) = survivor;
+   WRITE_BARRIER(holder, survivor);
+   ASSERT2_EQUALS(I32, OBJ_PROPERTIES(holder)->remembered, 1);
+   // 4. natives store without a barrier: the object is remembered when it is unlocked
+   OBJARRAY_AT(filled, 0) = child;
+   ASSERT2_EQUALS(I32, OBJ_PROPERTIES(filled)->remembered, 0);
+   setObjectLock(filled, UNLOCKED);
+   ASSERT2_EQUALS(I32, OBJ_PROPERTIES(filled)->remembered, 1);
+   ASSERT2_EQUALS(I32, rememberedCount, 2);
+   // 5. the minor gc promotes the reachable young objects in place and frees the others
+   LOCKVAR(omm);
+   collected = minorGC(currentContext);
+   UNLOCKVAR(omm);
+   ASSERT1_EQUALS(True, collected);
+   ASSERT1_EQUALS(False, OBJ_ISYOUNG(young));
+   ASSERT1_EQUALS(False, OBJ_ISYOUNG(survivor));
+   ASSERT1_EQUALS(False, OBJ_ISYOUNG(child));
+   ASSERT3_EQUALS(Filled, ARRAYOBJ_START(young), ARRAYOBJ_LEN(young), 1);
+   ASSERT3_EQUALS(Filled, ARRAYOBJ_START(survivor), ARRAYOBJ_LEN(survivor), 3);
+   ASSERT3_EQUALS(Filled, ARRAYOBJ_START(child), ARRAYOBJ_LEN(child), 4);
+   ASSERT2_EQUALS(Ptr, OBJARRAY_AT(holder, 0), survivor);
+   ASSERT1_EQUALS(Null, OBJ_CLASS(dead));
+   // 6. the remembered set is emptied, and the dead object became the hole where the next one is bumped
+   ASSERT2_EQUALS(I32, rememberedCount, 0);
+   ASSERT2_EQUALS(I32, OBJ_PROPERTIES(holder)->remembered, 0);
+   o = allocAndFillObj(currentContext, 16, 5);
+   ASSERT2_EQUALS(Ptr, o, dead);
+   ASSERT1_EQUALS(True, OBJ_ISYOUNG(o));
+   // 7. a promoted object is not collected by the next minor gc, even if nothing points to it anymore
+   OBJARRAY_AT(holder, 0) = null;
+   LOCKVAR(omm);
+   minorGC(currentContext);
+   UNLOCKVAR(omm);
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(survivor));
+   ASSERT1_EQUALS(Null, OBJ_CLASS(o));
+   // 8. but the full gc does
+   gc(currentContext);
+   ASSERT1_EQUALS(Null, OBJ_CLASS(survivor));
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(child));
+
+   finish:
+   vmTweaks = tweaks;
+   currentContext->regO = currentContext->regOStart;
+   saveRestoreOMM(false);
+}
+
+TESTCASE(IncrementalGC) // #DEPENDS(GenerationalGC)
+{
+   int32 tweaks = vmTweaks, epoch;
+   TCObjectArray held = currentContext->regOStart;
+   TCObject outer, inner, stored, garbage, born;
+
+   if (!saveRestoreOMM(true))
+   {
+      alert("Not enough memory to\nrun IncrementalGC\ntest case.\nAborting tests!");
+      TEST_ABORT;
+   }
+   vmTweaks &= ~(1 << (VMTWEAK_GENERATIONAL_GC-1));
+   outer = createArrayObject(currentContext, "[java.lang.Object", 1);
+   inner = createArrayObject(currentContext, "[java.lang.Object", 1);
+   ASSERT1_EQUALS(NotNull, inner);
+   setObjectLock(outer, UNLOCKED);
+   setObjectLock(inner, UNLOCKED);
+   OBJARRAY_AT(outer, 0) = inner;
+   *held++ = outer;
+   currentContext->regO = held;
+   stored = allocAndFillObj(currentContext, 16, 1);  // not reachable when the cycle starts
+   garbage = allocAndFillObj(currentContext, 16, 2);
+   // 1. starting a cycle changes the epoch, but the roots are not marked yet
+   epoch = gcEpoch;
+   startIncrementalGC(currentContext);
+   ASSERT1_EQUALS(True, incrementalMarking);
+   ASSERT1_EQUALS(False, incrementalRootsMarked);
+   ASSERT2_EQUALS(I32, gcEpoch, epoch+1);
+   ASSERT1_EQUALS(False, isMarked(outer));
+   // 2. a thread that runs bytecode must pass through a safepoint, unless it's in a native method
+   currentContext->gcEpoch = epoch;
+   currentContext->usageCount++;
+   ASSERT1_EQUALS(False, threadsAtSafepoint(null));
+   currentContext->inNative = true;
+   ASSERT1_EQUALS(True, threadsAtSafepoint(null));
+   currentContext->inNative = false;
+   GC_SAFEPOINT(currentContext);
+   ASSERT2_EQUALS(I32, currentContext->gcEpoch, gcEpoch);
+   ASSERT1_EQUALS(True, threadsAtSafepoint(null));
+   currentContext->usageCount--;
+   // 3. the objects created during the cycle are born marked
+   born = allocAndFillObj(currentContext, 16, 3);
+   ASSERT1_EQUALS(True, isMarked(born));
+   // 4. mark the roots and visit everything reachable
+   incrementalRootsMarked = true;
+   markRoots(currentContext, false);
+   ASSERT1_EQUALS(True, visitMarkStack(false, 0));
+   ASSERT1_EQUALS(True, isMarked(outer));
+   ASSERT1_EQUALS(True, isMarked(inner));
+   ASSERT1_EQUALS(False, isMarked(stored));
+   // 5. an object stored in a visited one is shaded by the write barrier
+   OBJARRAY_AT(inner, 0) = stored;
+   WRITE_BARRIER(inner, stored);
+   ASSERT1_EQUALS(True, isMarked(stored));
+   ASSERT1_EQUALS(False, isMarked(garbage));
+   // 6. finishing the cycle frees the unmarked objects; the ones born in it are collected by the next gc
+   gc(currentContext);
+   ASSERT1_EQUALS(False, incrementalMarking);
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(stored));
+   ASSERT3_EQUALS(Filled, ARRAYOBJ_START(stored), ARRAYOBJ_LEN(stored), 1);
+   ASSERT1_EQUALS(Null, OBJ_CLASS(garbage));
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(born));
+   gc(currentContext);
+   ASSERT1_EQUALS(Null, OBJ_CLASS(born));
+   // 7. a full gc before the roots of a cycle are marked drops the cycle and collects everything unreachable
+   born = allocAndFillObj(currentContext, 16, 4);
+   startIncrementalGC(currentContext);
+   garbage = allocAndFillObj(currentContext, 16, 5);
+   gc(currentContext);
+   ASSERT1_EQUALS(False, incrementalMarking);
+   ASSERT1_EQUALS(Null, OBJ_CLASS(born));
+   ASSERT1_EQUALS(Null, OBJ_CLASS(garbage));
+   ASSERT1_EQUALS(NotNull, OBJ_CLASS(stored));
 
    finish:
+   if (incrementalMarking)
+   {
+      LOCKVAR(omm);
+      abortIncrementalGC();
+      UNLOCKVAR(omm);
+   }
+   vmTweaks = tweaks;
+   currentContext->regO = currentContext->regOStart;
+   saveRestoreOMM(false);
+}
+
+#define PM_WIDE 1000   // chains hanging from the root, which is split among the workers
+#define PM_DEPTH 16    // length of each chain
+#define PM_DEEP 3000   // length of the last chain
+#define PM_GARBAGE 200 // unreachable objects, which point to reachable ones
+
+static TCObject pmNode(Context currentContext, TCObject next, TCObject shared)
+{
+   TCObject o = createArrayObject(currentContext, "[java.lang.Object", 2);
+   if (o != null)
+   {
+      setObjectLock(o, UNLOCKED);
+      OBJARRAY_AT(o, 0) = next;
+      OBJARRAY_AT(o, 1) = shared;
+   }
+   return o;
+}
+
+TESTCASE(ParallelMark) // #DEPENDS(IncrementalGC)
+{
+   int32 tweaks = vmTweaks, i, j, n = 0, len, unmarked = 0, marked = 0;
+   TCObject root, leaf, o, *live = null, *garbage = null;
+
+   if (!saveRestoreOMM(true))
+   {
+      alert("Not enough memory to\nrun ParallelMark\ntest case.\nAborting tests!");
+      TEST_ABORT;
+   }
+   vmTweaks &= ~(1 << (VMTWEAK_GENERATIONAL_GC-1));
+   live = (TCObject*)xmalloc((PM_WIDE * PM_DEPTH + PM_DEEP + 2) * sizeof(TCObject));
+   garbage = (TCObject*)xmalloc(PM_GARBAGE * sizeof(TCObject));
+   root = createArrayObject(currentContext, "[java.lang.Object", PM_WIDE);
+   leaf = createByteArray(currentContext, 16); // shared by all chains, so the workers race to mark it
+   if (!live || !garbage || !root || !leaf) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   setObjectLock(root, UNLOCKED);
+   setObjectLock(leaf, UNLOCKED);
+   live[n++] = root;
+   live[n++] = leaf;
+   // 1. a wide root whose elements are chains; the last one is deep
+   for (i = 0; i < PM_WIDE; i++)
+   {
+      o = null;
+      for (j = 0, len = i == PM_WIDE-1 ? PM_DEEP : PM_DEPTH; j < len; j++)
+      {
+         if ((o = pmNode(currentContext, o, (j & 3) == 0 ? leaf : null)) == null) {TEST_OUTPUT_SOURCELINE; goto finish;}
+         live[n++] = o;
+      }
+      OBJARRAY_AT(root, i) = o;
+   }
+   // 2. unreachable objects that point to the reachable ones and to each other
+   for (i = 0; i < PM_GARBAGE; i++)
+      if ((garbage[i] = pmNode(currentContext, live[(i * 97) % n], i > 0 ? garbage[i-1] : null)) == null) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   // 3. the root only pushes its fields, which are visited by the workers
+   clearMarks();
+   gcWorkers = GC_MAX_WORKERS;
+   ASSERT1_EQUALS(True, initMarkDeques());
+   IF_HEAP_ERROR(objStack->heap)
+   {
+      markInParallel = false;
+      TEST_OUTPUT_SOURCELINE;
+      goto finish;
+   }
+   markInParallel = true;
+   markObjects(root, false);
+   markInParallel = false;
+   ASSERT1_EQUALS(True, parallelMark());
+   // 4. everything reachable is marked, and nothing else
+   for (i = 0; i < n; i++)
+      if (!isMarked(live[i]))
+         unmarked++;
+   for (i = 0; i < PM_GARBAGE; i++)
+      if (isMarked(garbage[i]))
+         marked++;
+   ASSERT2_EQUALS(I32, unmarked, 0);
+   ASSERT2_EQUALS(I32, marked, 0);
+   clearMarks();
+finish:
+   gcWorkers = 1;
+   xfree(live);
+   xfree(garbage);
+   vmTweaks = tweaks;
    saveRestoreOMM(false);
 }
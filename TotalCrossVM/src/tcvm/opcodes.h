@@ -166,6 +166,30 @@
 #define MONITOR_Exit         157
 #define MONITOR_Enter2       158
 #define MONITOR_Exit2        159
-#define OPCODE_LENGTH        160 // last opcode + 1
+#define SWITCH_table         160
+// The opcodes below are never emitted by the converter: the interpreter rewrites the instructions
+// in place once they are resolved (quickening). The instance field ones store the field's index in the sym.
+#define MOV_regI_fieldQ      161
+#define MOV_regO_fieldQ      162
+#define MOV_reg64_fieldQ     163
+#define MOV_fieldQ_regI      164
+#define MOV_fieldQ_regO      165
+#define MOV_fieldQ_reg64     166
+#define MOV_regI_arcQ        167
+// Superinstructions: execute the instruction and the next one, which is kept intact because it may be a jump target
+#define MOV_regI_fieldQ_JEQ_regI_s6   168
+#define MOV_regI_fieldQ_JNE_regI_s6   169
+#define MOV_regI_fieldQ_JLT_regI_regI 170
+#define MOV_regI_fieldQ_JGE_regI_regI 171
+#define MOV_regI_arc_INC_regI         172
+// The static field ones run only once the field is bound, so they don't check it; the call one runs the method bound in boundNormal
+#define MOV_regI_staticQ     173
+#define MOV_regO_staticQ     174
+#define MOV_reg64_staticQ    175
+#define MOV_staticQ_regI     176
+#define MOV_staticQ_regO     177
+#define MOV_staticQ_reg64    178
+#define CALL_normalQ         179
+#define OPCODE_LENGTH        180 // last opcode + 1
 
 #endif
@@ -4,6 +4,9 @@
 // SPDX-License-Identifier: LGPL-2.1-only
 
 #include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
 
 #define CONVERT_PRIORITY(p,v) sched_get_priority_min(p)+(sched_get_priority_max(p)-sched_get_priority_min(p))*(v-1)/9; // java 1=min, 10=max
 
@@ -83,3 +86,69 @@ static VoidP privateThreadFunc(VoidP argP)
    pthread_cond_destroy(&targs->state_cv);
    pthread_exit((VoidP)0);
 }
+
+static VoidP privateParallelThreadFunc(VoidP argP)
+{
+   TParallelArgs* args = (TParallelArgs*)argP;
+   args->f(args->index, args->arg);
+   return null;
+}
+
+static bool privateParallelThreadCreate(ThreadHandle* h, TParallelArgs* args)
+{
+   return pthread_create(h, NULL, privateParallelThreadFunc, args) == 0;
+}
+
+static void privateParallelThreadJoin(ThreadHandle h)
+{
+   pthread_join(h, NULL);
+}
+
+static int32 privateGetProcessorCount()
+{
+   long n = sysconf(_SC_NPROCESSORS_ONLN);
+   return n > 0 ? (int32)n : 1;
+}
+
+static void privateThreadPermitInit(TThreadPermit* p)
+{
+   pthread_mutex_init(&p->mutex, NULL);
+   pthread_cond_init(&p->cv, NULL);
+   p->set = false;
+}
+
+static void privateThreadPermitDestroy(TThreadPermit* p)
+{
+   pthread_cond_destroy(&p->cv);
+   pthread_mutex_destroy(&p->mutex);
+}
+
+static bool privateThreadPermitPark(TThreadPermit* p, int32 millis)
+{
+   struct timespec ts;
+   bool given;
+   clock_gettime(CLOCK_REALTIME, &ts);
+   ts.tv_sec += millis / 1000;
+   ts.tv_nsec += (millis % 1000) * 1000000L;
+   if (ts.tv_nsec >= 1000000000L)
+   {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+   }
+   pthread_mutex_lock(&p->mutex);
+   while (!p->set)
+      if (pthread_cond_timedwait(&p->cv, &p->mutex, &ts) == ETIMEDOUT)
+         break;
+   given = p->set;
+   p->set = false;
+   pthread_mutex_unlock(&p->mutex);
+   return given;
+}
+
+static void privateThreadPermitUnpark(TThreadPermit* p)
+{
+   pthread_mutex_lock(&p->mutex);
+   p->set = true;
+   pthread_cond_signal(&p->cv);
+   pthread_mutex_unlock(&p->mutex);
+}
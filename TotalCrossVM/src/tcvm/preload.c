@@ -0,0 +1,225 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include "tcvm.h"
+
+/*
+ File format, in the byte order of the device:
+ . magic, version
+ . number of tczs and, for each one, its size and the crc32 of its contents table (the names, offsets and uncompressed sizes
+   of the entries), which changes when any class is changed
+ . number of classes; for each one, in the order they were initialized: the length of its name (including the trailing 0) and the chars
+*/
+
+#define PROFILE_MAGIC   0x504C4354 // "TCLP"; a device with another byte order will not recognize the file
+#define PROFILE_VERSION 2
+
+#define PROFILE_RECORD_TIME 10000 // the classes initialized after this time (in ms) are not recorded, since they're not needed at startup
+#define MAX_PRELOAD_THREADS 4
+
+static uint8* profile;          // the load profile read from the file
+static CharP* preloadNames;     // the classes to preload, pointing into the profile
+static int32 preloadCount;
+static volatile int32 preloadNext;
+static volatile bool stopPreload;
+static TParallelThreads preloadThreads;
+
+static TCClass* recorded;       // the classes initialized so far, in order
+static int32 recordedCount, recordedCapacity, recordEnd;
+static volatile int32 recording; // set to 0 by the thread that writes the profile
+static int32 profileTCZCount;
+
+static CharP getProfilePath(CharP path)
+{
+   xstrprintf(path, "%s/%s.tcp", appPath, mainClassName);
+   return path;
+}
+
+static bool readProfile()
+{
+   char path[MAX_PATHNAME];
+   VoidPs* list;
+   FILE* f;
+   int32 size, i, *p;
+   uint8 *buf = null, *end;
+
+   if ((f = fopen(getProfilePath(path), "rb")) == null)
+      return false;
+   fseek(f, 0, SEEK_END);
+   size = (int32)ftell(f);
+   fseek(f, 0, SEEK_SET);
+   if (size > (3 + profileTCZCount * 2) * 4 && (buf = (uint8*)xmalloc(size)) != null && (int32)fread(buf, 1, size, f) != size)
+      xfree(buf);
+   fclose(f);
+   if (buf == null)
+      return false;
+
+   end = buf + size;
+   p = (int32*)buf;
+   if (*p++ != PROFILE_MAGIC || *p++ != PROFILE_VERSION || *p++ != profileTCZCount)
+      goto outdated;
+   for (i = 0, list = openTCZs; i < profileTCZCount; i++, list = list->next, p += 2)
+      if (p[0] != getTCZSize((TCZFile)list->value) || p[1] != getTCZHash((TCZFile)list->value))
+         goto outdated;
+   preloadCount = *p++;
+   if (preloadCount < 0 || preloadCount > (end - (uint8*)p) / 4 || (preloadNames = (CharP*)xmalloc(preloadCount * sizeof(CharP) + 1)) == null) // each name takes at least 4 bytes
+      goto outdated;
+   for (i = 0; i < preloadCount; i++)
+   {
+      int32 len;
+      if ((uint8*)p + 4 > end || (len = *p) <= 0 || len > end - (uint8*)p - 4 || ((CharP)(p+1))[len-1] != 0)
+         goto outdated;
+      preloadNames[i] = (CharP)(p+1);
+      p = (int32*)((uint8*)(p+1) + ((len + 3) & ~3)); // the names are aligned to 4 bytes
+   }
+   if ((uint8*)p != end)
+      goto outdated;
+   profile = buf;
+   return true;
+outdated:
+   debug("Ignoring the load profile %s: it doesn't match the application", path);
+   xfree(buf);
+   xfree(preloadNames);
+   preloadCount = 0;
+   return false;
+}
+
+static void writeProfile()
+{
+   char path[MAX_PATHNAME];
+   VoidPs* list;
+   FILE* f;
+   int32 i, n, zero = 0;
+
+   if ((f = fopen(getProfilePath(path), "wb")) == null)
+      return;
+   n = PROFILE_MAGIC;    fwrite(&n, 4, 1, f);
+   n = PROFILE_VERSION;  fwrite(&n, 4, 1, f);
+   fwrite(&profileTCZCount, 4, 1, f);
+   for (i = 0, list = openTCZs; i < profileTCZCount; i++, list = list->next)
+   {
+      n = getTCZSize((TCZFile)list->value);
+      fwrite(&n, 4, 1, f);
+      n = getTCZHash((TCZFile)list->value);
+      fwrite(&n, 4, 1, f);
+   }
+   fwrite(&recordedCount, 4, 1, f);
+   for (i = 0; i < recordedCount; i++)
+   {
+      CharP name = recorded[i]->name;
+      n = xstrlen(name) + 1;
+      fwrite(&n, 4, 1, f);
+      fwrite(name, 1, n, f);
+      if (n & 3)
+         fwrite(&zero, 1, 4 - (n & 3), f);
+   }
+   if (fclose(f) != 0)
+      remove(path); // a truncated file would be ignored anyway
+}
+
+static void finishRecording()
+{
+   if (recording && ATOMIC_CAS32(&recording, 1, 0)) // only one thread writes it
+   {
+      LOCKVAR(classLoaderLock); // wait for the threads that are recording a class
+      writeProfile();
+      xfree(recorded);
+      recordedCount = recordedCapacity = 0;
+      UNLOCKVAR(classLoaderLock);
+   }
+}
+
+void recordClassLoad(TCClass c)
+{
+   if (!recording || *c->name == '[') // arrays are not read from the tczs
+      return;
+   if (getTimeStamp() > recordEnd)
+   {
+      finishRecording();
+      return;
+   }
+   LOCKVAR(classLoaderLock);
+   if (recording)
+   {
+      if (recordedCount == recordedCapacity)
+      {
+         int32 capacity = recordedCapacity == 0 ? 256 : recordedCapacity * 2;
+         TCClass* items = (TCClass*)xrealloc((uint8*)recorded, capacity * sizeof(TCClass));
+         if (items != null)
+         {
+            recorded = items;
+            recordedCapacity = capacity;
+         }
+      }
+      if (recordedCount < recordedCapacity)
+         recorded[recordedCount++] = c;
+   }
+   UNLOCKVAR(classLoaderLock);
+}
+
+static void preloadWorker(int32 index, VoidP arg)
+{
+   Context c;
+   int32 i;
+   UNUSED(index);
+   UNUSED(arg);
+#ifdef ANDROID
+   {JNIEnv* env; (*androidJVM)->AttachCurrentThreadAsDaemon(androidJVM, &env, NULL);} // the tczs are read through the apk
+#endif
+   if ((c = newContext(null, null, false)) != null)
+   {
+      while (!stopPreload)
+      {
+         do i = preloadNext; while (i < preloadCount && !ATOMIC_CAS32(&preloadNext, i, i+1)); // the classes are shared among the threads
+         if (i >= preloadCount)
+            break;
+         preloadClass(c, preloadNames[i]);
+         c->thrownException = null; // a class that was removed from the application is just skipped
+      }
+      deleteContext(c, false);
+   }
+#ifdef ANDROID
+   (*androidJVM)->DetachCurrentThread(androidJVM);
+#endif
+}
+
+void startClassPreload(Context currentContext)
+{
+   VoidPs* list;
+   UNUSED(currentContext);
+   profileTCZCount = 0;
+   if ((list = openTCZs) != null)
+      do
+      {
+         profileTCZCount++;
+         list = list->next;
+      } while (list != openTCZs);
+   stopPreload = false;
+   preloadNext = 0;
+   if (readProfile())
+   {
+      int32 n = min32(max32(threadGetProcessorCount() - 1, 1), MAX_PRELOAD_THREADS);
+      threadStartParallel(&preloadThreads, n + 1, preloadWorker, null); // index 0 is this thread, which runs the application
+   }
+   else
+   {
+      recordEnd = getTimeStamp() + PROFILE_RECORD_TIME;
+      recording = 1;
+   }
+}
+
+void stopClassPreload()
+{
+   stopPreload = true;
+   threadJoinParallel(&preloadThreads);
+   finishRecording();
+   xfree(profile);
+   xfree(preloadNames);
+   preloadCount = 0;
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "preload_test.h"
+#endif
@@ -0,0 +1,27 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifndef PRELOAD_H
+#define PRELOAD_H
+
+/*
+ Class preloading. In the first launch, the vm records the order in which the application initializes its classes
+ during its first seconds, and writes it to the load profile, <appPath>/<main class>.tcp. In the next launches, the
+ classes of the profile are loaded by background threads while the main thread runs, without running their static
+ initializers, which run as usual when the classes are first used. A class being read by a thread is waited by the
+ other ones that need it; different classes are read in parallel.
+
+ The profile is ignored and recorded again if the application's tczs changed: each one is checked by its size and by a
+ crc32 of its contents table.
+*/
+
+/// Starts preloading the classes of the load profile, or starts recording it if there's no valid one; called just before the main class is loaded.
+void startClassPreload(Context currentContext);
+/// Stops the preloading threads and writes the load profile, if it was being recorded; called when the vm exits.
+void stopClassPreload();
+/// Records a class in the load profile; called when the class is initialized.
+void recordClassLoad(TCClass c);
+
+#endif
@@ -0,0 +1,123 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+static bool rewriteProfile(CharP path, int32 pos, int32 value, int32 size) // changes an int at pos and truncates the file to size, if size >= 0
+{
+   FILE* f = fopen(path, "rb");
+   uint8* buf = null;
+   int32 n = 0;
+   if (f == null)
+      return false;
+   fseek(f, 0, SEEK_END);
+   n = (int32)ftell(f);
+   fseek(f, 0, SEEK_SET);
+   if ((buf = (uint8*)xmalloc(n)) != null && (int32)fread(buf, 1, n, f) != n)
+      xfree(buf);
+   fclose(f);
+   if (buf == null || pos + 4 > n || (f = fopen(path, "wb")) == null)
+   {
+      xfree(buf);
+      return false;
+   }
+   xmemmove(buf + pos, &value, 4);
+   fwrite(buf, 1, size >= 0 ? size : n, f);
+   fclose(f);
+   xfree(buf);
+   return true;
+}
+
+static void freeProfile()
+{
+   xfree(profile);
+   xfree(preloadNames);
+   preloadCount = 0;
+}
+
+TESTCASE(Preload_Profile)
+{
+   char path[MAX_PATHNAME], backup[MAX_PATHNAME];
+   TCClass classes[3], c, arrayClass = null;
+   VoidPs* list;
+   int32 i, n = 0, hashPos, tczCount = profileTCZCount;
+   bool backedUp, inUse = recording || preloadCount > 0; // the application's profile
+
+   if (inUse)
+      TEST_CANNOT_RUN;
+   getProfilePath(path);
+   xstrprintf(backup, "%s.bak", path);
+   backedUp = rename(path, backup) == 0;
+   profileTCZCount = 0;
+   if ((list = openTCZs) != null)
+      do
+      {
+         profileTCZCount++;
+         list = list->next;
+      } while (list != openTCZs);
+   for (i = 0; i <= (int32)htLoadedClasses.table->mask; i++)
+      if ((c = (TCClass)htLoadedClasses.table->items[i].value) != null)
+      {
+         if (*c->name == '[')
+            arrayClass = c;
+         else
+         if (n < 3)
+            classes[n++] = c;
+      }
+   if (profileTCZCount == 0 || n < 3)
+      TEST_CANNOT_RUN;
+
+   // 1. the classes are recorded in the order they're initialized, without the arrays, and read back
+   recordEnd = getTimeStamp() + PROFILE_RECORD_TIME;
+   recording = 1;
+   recordClassLoad(classes[2]);
+   if (arrayClass != null)
+      recordClassLoad(arrayClass);
+   recordClassLoad(classes[0]);
+   recordClassLoad(classes[1]);
+   ASSERT2_EQUALS(I32, recordedCount, 3);
+   finishRecording();
+   ASSERT2_EQUALS(I32, recording, 0);
+   ASSERT2_EQUALS(I32, recordedCount, 0);
+   recordClassLoad(classes[0]); // no longer recording
+   ASSERT2_EQUALS(I32, recordedCount, 0);
+   ASSERT1_EQUALS(True, readProfile());
+   ASSERT2_EQUALS(I32, preloadCount, 3);
+   ASSERT2_EQUALS(Sz, preloadNames[0], classes[2]->name);
+   ASSERT2_EQUALS(Sz, preloadNames[1], classes[0]->name);
+   ASSERT2_EQUALS(Sz, preloadNames[2], classes[1]->name);
+
+   // 2. the threads share the classes, and skip the ones that were removed from the application
+   preloadNames[1] = "tc.test.NotAClass";
+   preloadNext = 0;
+   stopPreload = false;
+   threadRunParallel(3, preloadWorker, null);
+   ASSERT2_EQUALS(I32, preloadNext, 3);
+   ASSERT1_EQUALS(Null, khGet(&htLoadedClasses, preloadNames[1], hashCodeSlash2Dot(preloadNames[1])));
+   preloadNext = 0;
+   stopPreload = true; // and they stop when the vm exits
+   threadRunParallel(3, preloadWorker, null);
+   ASSERT2_EQUALS(I32, preloadNext, 0);
+   freeProfile();
+
+   // 3. a profile of other tczs is ignored: a tcz with the same size but other contents, or a truncated file
+   hashPos = 4 * 4; // magic, version, number of tczs and the size of the first one
+   ASSERT1_EQUALS(True, rewriteProfile(path, hashPos, getTCZHash((TCZFile)openTCZs->value) ^ 1, -1));
+   ASSERT1_EQUALS(False, readProfile());
+   ASSERT2_EQUALS(I32, preloadCount, 0);
+   ASSERT1_EQUALS(True, rewriteProfile(path, hashPos, getTCZHash((TCZFile)openTCZs->value), -1));
+   ASSERT1_EQUALS(True, readProfile());
+   freeProfile();
+   ASSERT1_EQUALS(True, rewriteProfile(path, 0, PROFILE_MAGIC, hashPos + 4));
+   ASSERT1_EQUALS(False, readProfile());
+finish:
+   if (inUse)
+      return;
+   freeProfile();
+   recording = 0;
+   stopPreload = false;
+   remove(path);
+   if (backedUp)
+      rename(backup, path);
+   profileTCZCount = tczCount;
+}
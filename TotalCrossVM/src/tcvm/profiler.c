@@ -0,0 +1,369 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include "tcvm.h"
+
+#define DEFAULT_SAMPLE_INTERVAL 10  // in ms
+#define DEFAULT_ALLOC_INTERVAL  (512*1024)
+#define MAX_SAMPLE_DEPTH        128 // the outer frames of deeper stacks are replaced by a "[truncated]" one
+
+typedef struct
+{
+   Method m; // null in the frame that replaces the truncated ones
+   int32 line;
+} TProfilerFrame;
+
+typedef struct TProfilerStack
+{
+   struct TProfilerStack *next;    // the next one with the same hash
+   struct TProfilerStack *nextAll; // the next one recorded
+   int32 count, depth;
+   TProfilerFrame frames[1];       // from the innermost one
+} TProfilerStack, *ProfilerStack;
+
+static volatile bool profilerOn, stopSampler;
+static int32 sampleInterval;
+static TParallelThreads samplerThread;
+static Hashtable stacksByHash;   // hash -> the first stack with it
+static ProfilerStack allStacks;
+static int32 sampleCount;
+
+static void samplerLoop(int32 index, VoidP arg)
+{
+   UNUSED(index);
+   UNUSED(arg);
+   while (!stopSampler)
+   {
+      Sleep(sampleInterval);
+      profilerTick++; // only this thread changes it
+   }
+}
+
+void startCpuProfiler(int32 intervalMs)
+{
+   LOCKVAR(profiler);
+   if (!profilerOn)
+   {
+      stacksByHash = htNew(1023, null);
+      if (stacksByHash.items != null)
+      {
+         allStacks = null;
+         sampleCount = 0;
+         sampleInterval = intervalMs > 0 ? intervalMs : DEFAULT_SAMPLE_INTERVAL;
+         stopSampler = false;
+         profilerOn = true;
+         threadStartParallel(&samplerThread, 2, samplerLoop, null); // index 0 would be this thread
+      }
+   }
+   UNLOCKVAR(profiler);
+}
+
+void initProfilers()
+{
+#if !defined(WINCE) && !defined(WP8)
+   CharP value;
+   if ((value = getenv("TC_CPU_PROFILE")) != null)
+      startCpuProfiler(atoi(value));
+   if ((value = getenv("TC_ALLOC_PROFILE")) != null)
+      startAllocProfiler(atoi(value));
+#endif
+}
+
+FILE* createProfilerFile(CharP suffix, CharP path)
+{
+   FILE* f;
+   xstrprintf(path, "%s/%s%s", appPath, mainClassName, suffix);
+   if ((f = fopen(path, "w")) == null)
+      debug("P Could not create the file %s", path);
+   return f;
+}
+
+static void writeFrame(FILE* f, TProfilerFrame* frame)
+{
+   if (frame->m == null)
+      fputs("[truncated]", f);
+   else
+   if (frame->line >= 0)
+      fprintf(f, "%s.%s:%d", frame->m->class_->name, frame->m->name, frame->line);
+   else
+      fprintf(f, "%s.%s", frame->m->class_->name, frame->m->name);
+}
+
+static void writeStacks()
+{
+   char path[MAX_PATHNAME];
+   ProfilerStack s;
+   FILE* f;
+   int32 i;
+
+   if ((f = createProfilerFile(".folded", path)) == null)
+      return;
+   for (s = allStacks; s != null; s = s->nextAll)
+   {
+      for (i = s->depth; --i >= 0;)
+      {
+         writeFrame(f, &s->frames[i]);
+         fputc(i == 0 ? ' ' : ';', f);
+      }
+      fprintf(f, "%d\n", s->count);
+   }
+   if (fclose(f) == 0)
+      debug("P Cpu profile with %d samples written to %s", sampleCount, path);
+}
+
+void stopCpuProfiler()
+{
+   ProfilerStack s, next;
+   stopSampler = true;
+   threadJoinParallel(&samplerThread);
+   LOCKVAR(profiler);
+   if (profilerOn)
+   {
+      profilerOn = false;
+      writeStacks();
+      for (s = allStacks; s != null; s = next)
+      {
+         next = s->nextAll;
+         xfree(s);
+      }
+      allStacks = null;
+      htFree(&stacksByHash, null);
+   }
+   UNLOCKVAR(profiler);
+}
+
+static bool sameFrames(ProfilerStack s, TProfilerFrame* frames, int32 depth)
+{
+   int32 i;
+   if (s->depth != depth)
+      return false;
+   for (i = 0; i < depth; i++)
+      if (s->frames[i].m != frames[i].m || s->frames[i].line != frames[i].line)
+         return false;
+   return true;
+}
+
+static void addSample(TProfilerFrame* frames, int32 depth)
+{
+   ProfilerStack first, s;
+   uint32 hash = (uint32)depth;
+   int32 i;
+
+   for (i = 0; i < depth; i++)
+      hash = hash * 31 + (uint32)(size_t)frames[i].m * 17 + (uint32)frames[i].line;
+   first = (ProfilerStack)htGetPtr(&stacksByHash, hash);
+   for (s = first; s != null; s = s->next)
+      if (sameFrames(s, frames, depth))
+      {
+         s->count++;
+         sampleCount++;
+         return;
+      }
+   if ((s = (ProfilerStack)xmalloc(sizeof(TProfilerStack) + (depth-1) * sizeof(TProfilerFrame))) == null)
+      return; // the sample is lost
+   xmemmove(s->frames, frames, depth * sizeof(TProfilerFrame));
+   s->depth = depth;
+   s->count = 1;
+   if (!htPutPtr(&stacksByHash, hash, s))
+   {
+      xfree(s);
+      return;
+   }
+   s->next = first;
+   s->nextAll = allStacks;
+   allStacks = s;
+   sampleCount++;
+}
+
+static int32 getFrameLine(Method m, Code pc)
+{
+   return m->flags.isNative || m->lineNumberLine == null || pc == null ? -1 : locateLine(m, (int32)(pc - m->code));
+}
+
+void takeProfilerSample(Context c, Method m, Code pc)
+{
+   TProfilerFrame frames[MAX_SAMPLE_DEPTH];
+   VoidPArray callStack = c->callStack - 2; // the frame of m; its pc is only in the interpreter
+   int32 depth = 0;
+
+   c->profilerTick = profilerTick;
+   if (!profilerOn)
+      return;
+   frames[depth].m = m;
+   frames[depth++].line = getFrameLine(m, pc);
+   while ((callStack -= 2) >= c->callStackStart && depth < MAX_SAMPLE_DEPTH-1)
+   {
+      Method caller = (Method)callStack[0];
+      if (caller != null)
+      {
+         frames[depth].m = caller;
+         frames[depth++].line = getFrameLine(caller, (Code)callStack[1]); // the pc of the call
+      }
+   }
+   if (callStack >= c->callStackStart)
+   {
+      frames[depth].m = null;
+      frames[depth++].line = -1;
+   }
+   LOCKVAR(profiler);
+   if (profilerOn) // may have stopped while the stack was being read
+      addSample(frames, depth);
+   UNLOCKVAR(profiler);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//                          Allocation profiler                          //
+///////////////////////////////////////////////////////////////////////////
+
+typedef struct TAllocSite
+{
+   struct TAllocSite *next;    // the next one with the same hash
+   struct TAllocSite *nextAll; // the next one recorded
+   TCClass cls;
+   Method m;                   // null if the object was created by the vm itself
+   int32 line;
+   int32 samples;
+   int64 bytes;
+} TAllocSite, *AllocSite;
+
+static Hashtable sitesByHash;  // hash -> the first site with it
+static AllocSite allSites;
+static int32 siteCount, allocSampleCount;
+
+void startAllocProfiler(int32 intervalBytes)
+{
+   LOCKVAR(profiler);
+   if (allocSampleInterval == 0)
+   {
+      sitesByHash = htNew(1023, null);
+      if (sitesByHash.items != null)
+      {
+         allSites = null;
+         siteCount = allocSampleCount = 0;
+         allocSampleInterval = intervalBytes > 0 ? intervalBytes : DEFAULT_ALLOC_INTERVAL;
+      }
+   }
+   UNLOCKVAR(profiler);
+}
+
+static CharP getMethodName(Method m, CharP buf)
+{
+   if (m == null)
+      xstrcpy(buf, "<vm>");
+   else
+      xstrprintf(buf, "%s.%s", m->class_->name, m->name);
+   return buf;
+}
+
+static int compareSites(const void* a, const void* b)
+{
+   AllocSite s1 = *(AllocSite*)a, s2 = *(AllocSite*)b;
+   char n1[512], n2[512];
+   int32 dif = xstrcmp(getMethodName(s1->m, n1), getMethodName(s2->m, n2));
+   if (dif == 0 && (dif = s1->line - s2->line) == 0)
+      dif = xstrcmp(s1->cls->name, s2->cls->name);
+   return dif;
+}
+
+static void writeSites()
+{
+   char path[MAX_PATHNAME], name[512];
+   AllocSite s, *sorted;
+   FILE* f;
+   int32 i;
+
+   if ((sorted = (AllocSite*)xmalloc((siteCount+1) * sizeof(AllocSite))) == null || (f = createProfilerFile(".allocs.csv", path)) == null)
+   {
+      xfree(sorted);
+      return;
+   }
+   for (i = 0, s = allSites; s != null; s = s->nextAll)
+      sorted[i++] = s;
+   qsort(sorted, siteCount, sizeof(AllocSite), compareSites);
+   fputs("method,line,class,samples,bytes\n", f);
+   for (i = 0; i < siteCount; i++)
+   {
+      s = sorted[i];
+      fprintf(f, "%s,%d,%s,%d,%.0f\n", getMethodName(s->m, name), s->line, s->cls->name, s->samples, (double)s->bytes);
+   }
+   xfree(sorted);
+   if (fclose(f) == 0)
+      debug("P Allocation profile with %d samples written to %s", allocSampleCount, path);
+}
+
+void stopAllocProfiler()
+{
+   AllocSite s, next;
+   LOCKVAR(profiler);
+   if (allocSampleInterval != 0)
+   {
+      allocSampleInterval = 0;
+      writeSites();
+      for (s = allSites; s != null; s = next)
+      {
+         next = s->nextAll;
+         xfree(s);
+      }
+      allSites = null;
+      htFree(&sitesByHash, null);
+   }
+   UNLOCKVAR(profiler);
+}
+
+void takeAllocationSample(Context c, TCClass cls, uint32 size)
+{
+   VoidPArray callStack = c->callStack;
+   Method m = null;
+   AllocSite first, s;
+   int32 line = -1;
+   uint32 hash;
+
+   while ((callStack -= 2) >= c->callStackStart) // the slot after the method has the pc of its last call or allocation
+      if ((m = (Method)callStack[0]) != null && !m->flags.isNative)
+      {
+         line = getFrameLine(m, (Code)callStack[1]);
+         break;
+      }
+   if (callStack < c->callStackStart)
+      m = null;
+   hash = (uint32)(size_t)cls * 31 + (uint32)(size_t)m * 17 + (uint32)line;
+   LOCKVAR(profiler);
+   if (allocSampleInterval != 0) // may have stopped meanwhile
+   {
+      first = (AllocSite)htGetPtr(&sitesByHash, hash);
+      for (s = first; s != null; s = s->next)
+         if (s->cls == cls && s->m == m && s->line == line)
+            break;
+      if (s == null && (s = newX(AllocSite)) != null)
+      {
+         if (!htPutPtr(&sitesByHash, hash, s))
+         {
+            xfree(s);
+            s = null;
+         }
+         else
+         {
+            s->cls = cls;
+            s->m = m;
+            s->line = line;
+            s->next = first;
+            s->nextAll = allSites;
+            allSites = s;
+            siteCount++;
+         }
+      }
+      if (s != null)
+      {
+         s->samples++;
+         s->bytes += max32((int32)size, allocSampleInterval);
+         allocSampleCount++;
+      }
+   }
+   UNLOCKVAR(profiler);
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "profiler_test.h"
+#endif
@@ -0,0 +1,52 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+ Sampling cpu profiler. A sampler thread increments profilerTick at each interval; the interpreter compares it with the
+ one of its context at each taken jump and method call and, when it changed, records its call stack, with the line of
+ each frame taken from the line number tables. So each thread records its own stack, which needs no locks, and the
+ threads that are blocked are not sampled. The time spent in a native method is not counted.
+
+ The equal stacks are counted together and, when the profiler stops, they're written in the collapsed format
+ (root;...;leaf count, one per line) read by the flame graph tools to <appPath>/<main class>.folded.
+
+ The profiler is started by Vm.tweak(Vm.TWEAK_CPU_PROFILER, true), or at startup if the TC_CPU_PROFILE environment
+ variable is set (its value is the sampling interval in ms; 0 or an invalid one uses the default, 10 ms).
+*/
+
+/// Starts the cpu and allocation profilers if the TC_CPU_PROFILE and TC_ALLOC_PROFILE environment variables are set;
+/// called just before the main class is loaded.
+void initProfilers();
+/// Starts sampling the threads each intervalMs milliseconds; does nothing if the profiler is already running.
+void startCpuProfiler(int32 intervalMs);
+/// Stops the sampler thread and writes the collected stacks; called by Vm.tweak and when the vm exits.
+void stopCpuProfiler();
+/// Records the call stack of the context, whose current method is m, at the given pc. Called by the interpreter.
+void takeProfilerSample(Context c, Method m, Code pc);
+
+/*
+ Allocation profiler. While allocSampleInterval is not 0, allocObject samples an object each allocSampleInterval
+ bytes, recording its class and the method and line that created it: the first frame of the call stack that is not
+ of a native method. Each sample stands for allocSampleInterval bytes, or for its size if it's bigger. When the
+ profiler stops, the sites are written to <appPath>/<main class>.allocs.csv, sorted by site, so the files of two
+ builds can be diffed.
+
+ The profiler is started by Vm.tweak(Vm.TWEAK_ALLOC_PROFILER, true), or at startup if the TC_ALLOC_PROFILE
+ environment variable is set (its value is the sampling interval in bytes; 0 or an invalid one uses 512 KB).
+*/
+
+/// Starts sampling the allocations each intervalBytes bytes; does nothing if the profiler is already running.
+void startAllocProfiler(int32 intervalBytes);
+/// Stops the allocation profiler and writes the sampled sites; called by Vm.tweak and when the vm exits.
+void stopAllocProfiler();
+/// Records an allocation of the given class and size made by the context. Called by allocObject.
+void takeAllocationSample(Context c, TCClass cls, uint32 size);
+/// Creates the file <appPath>/<main class><suffix>, storing its name in path; returns null if it can't be created.
+FILE* createProfilerFile(CharP suffix, CharP path);
+
+#endif
@@ -0,0 +1,281 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+static TTCClass profTestClasses[2];
+static TMethod profTestMethods[3]; // a, b and c
+static TCode profTestCode[8];
+
+static void initProfilerTest()
+{
+   static CharP names[] = {"a", "b", "c"};
+   int32 i;
+   xmemzero(profTestClasses, sizeof(profTestClasses));
+   xmemzero(profTestMethods, sizeof(profTestMethods));
+   profTestClasses[0].name = "tc.test.Prof";
+   profTestClasses[1].name = "tc.test.Prof2";
+   for (i = 0; i < 3; i++)
+   {
+      profTestMethods[i].class_ = &profTestClasses[0];
+      profTestMethods[i].name = names[i];
+      profTestMethods[i].flags.isNative = true; // no line numbers
+   }
+}
+
+static void setProfilerFrame(TProfilerFrame* f, int32 method, int32 line)
+{
+   f->m = method < 0 ? null : &profTestMethods[method];
+   f->line = line;
+}
+
+static ProfilerStack findStack(TProfilerFrame* frames, int32 depth)
+{
+   ProfilerStack s;
+   for (s = allStacks; s != null; s = s->nextAll)
+      if (sameFrames(s, frames, depth))
+         return s;
+   return null;
+}
+
+static int32 countStacks()
+{
+   ProfilerStack s;
+   int32 n = 0;
+   for (s = allStacks; s != null; s = s->nextAll)
+      n++;
+   return n;
+}
+
+static AllocSite findSite(TCClass cls, Method m, int32 line)
+{
+   AllocSite s;
+   for (s = allSites; s != null; s = s->nextAll)
+      if (s->cls == cls && s->m == m && s->line == line)
+         return s;
+   return null;
+}
+
+static int32 stackCount(TProfilerFrame* frames, int32 depth)
+{
+   ProfilerStack s = findStack(frames, depth);
+   return s == null ? -1 : s->count;
+}
+
+static int32 siteSamples(TCClass cls, Method m, int32 line)
+{
+   AllocSite s = findSite(cls, m, line);
+   return s == null ? -1 : s->samples;
+}
+
+static bool profileContains(CharP path, CharP text)
+{
+   FILE* f = fopen(path, "rb");
+   char buf[8192];
+   int32 n;
+   if (f == null)
+      return false;
+   n = (int32)fread(buf, 1, sizeof(buf)-1, f);
+   fclose(f);
+   buf[n] = 0;
+   return xstrstr(buf, text) != null;
+}
+
+TESTCASE(Profiler_CpuSamples)
+{
+   TProfilerFrame ab[2], ab2[2], abc[3], x[2], y[2], sampled[3];
+   char path[MAX_PATHNAME];
+   ProfilerStack s, next;
+   VoidPArray cs;
+   Context c = null;
+   int32 i, maxDepth = 0;
+   bool inUse = profilerOn, truncated = false;
+
+   if (inUse)
+      TEST_CANNOT_RUN;
+   xstrprintf(path, "%s/%s.folded", appPath, mainClassName);
+   initProfilerTest();
+   stacksByHash = htNew(1023, null);
+   allStacks = null;
+   sampleCount = 0;
+   ASSERT1_EQUALS(NotNull, stacksByHash.items);
+
+   // 1. equal stacks are counted together; a stack and its prefix, or stacks that differ only by a line, are not
+   setProfilerFrame(&ab[0], 0, 10); setProfilerFrame(&ab[1], 1, 20);
+   setProfilerFrame(&ab2[0], 0, 11); setProfilerFrame(&ab2[1], 1, 20);
+   setProfilerFrame(&abc[0], 0, 10); setProfilerFrame(&abc[1], 1, 20); setProfilerFrame(&abc[2], 2, 30);
+   addSample(ab, 2);
+   addSample(ab, 2);
+   addSample(ab2, 2);
+   addSample(abc, 3);
+   addSample(ab, 1);
+   ASSERT2_EQUALS(I32, countStacks(), 4);
+   ASSERT2_EQUALS(I32, sampleCount, 5);
+   ASSERT2_EQUALS(I32, stackCount(ab, 2), 2);
+   ASSERT2_EQUALS(I32, stackCount(ab2, 2), 1);
+   ASSERT2_EQUALS(I32, stackCount(abc, 3), 1);
+   ASSERT2_EQUALS(I32, stackCount(ab, 1), 1);
+
+   // 2. stacks with the same hash are kept apart: ((2*31 + a*17 + 0)*31 + b*17 + 31) == ((2*31 + a*17 + 1)*31 + b*17 + 0)
+   setProfilerFrame(&x[0], 0, 0); setProfilerFrame(&x[1], 1, 31);
+   setProfilerFrame(&y[0], 0, 1); setProfilerFrame(&y[1], 1, 0);
+   addSample(x, 2);
+   addSample(y, 2);
+   addSample(y, 2);
+   ASSERT2_EQUALS(I32, countStacks(), 6);
+   ASSERT2_EQUALS(I32, stackCount(x, 2), 1);
+   ASSERT2_EQUALS(I32, stackCount(y, 2), 2);
+
+   // 3. the interpreter's stack is read from the current method to the outermost one, and truncated when too deep
+   c = newContext(null, null, false);
+   ASSERT1_EQUALS(NotNull, c);
+   cs = c->callStackStart;
+   cs[0] = &profTestMethods[0]; cs[1] = null;
+   cs[2] = &profTestMethods[1]; cs[3] = null;
+   cs[4] = &profTestMethods[2]; cs[5] = null;
+   c->callStack = cs + 6;
+   profilerOn = true;
+   takeProfilerSample(c, &profTestMethods[2], null);
+   ASSERT2_EQUALS(I32, c->profilerTick, profilerTick);
+   setProfilerFrame(&sampled[0], 2, -1); setProfilerFrame(&sampled[1], 1, -1); setProfilerFrame(&sampled[2], 0, -1);
+   ASSERT1_EQUALS(NotNull, findStack(sampled, 3));
+   for (i = 0; i < MAX_SAMPLE_DEPTH + 10; i++, cs += 2)
+   {
+      cs[0] = &profTestMethods[1];
+      cs[1] = null;
+   }
+   c->callStack = cs;
+   takeProfilerSample(c, &profTestMethods[1], null);
+   profilerOn = false;
+   for (s = allStacks; s != null; s = s->nextAll)
+      if (s->depth > maxDepth)
+      {
+         maxDepth = s->depth;
+         truncated = s->frames[s->depth-1].m == null;
+      }
+   ASSERT2_EQUALS(I32, maxDepth, MAX_SAMPLE_DEPTH);
+   ASSERT1_EQUALS(True, truncated);
+
+   // 4. the collapsed stacks go from the root to the leaf, with the lines when they're known
+   writeStacks();
+   ASSERT1_EQUALS(True, profileContains(path, "tc.test.Prof.b:20;tc.test.Prof.a:10 2\n"));
+   ASSERT1_EQUALS(True, profileContains(path, "tc.test.Prof.c:30;tc.test.Prof.b:20;tc.test.Prof.a:10 1\n"));
+   ASSERT1_EQUALS(True, profileContains(path, "tc.test.Prof.a;tc.test.Prof.b;tc.test.Prof.c 1\n"));
+   ASSERT1_EQUALS(True, profileContains(path, "[truncated];tc.test.Prof.b;"));
+finish:
+   if (inUse)
+      return;
+   profilerOn = false;
+   for (s = allStacks; s != null; s = next)
+   {
+      next = s->nextAll;
+      xfree(s);
+   }
+   allStacks = null;
+   htFree(&stacksByHash, null);
+   if (c != null)
+      deleteContext(c, false);
+   remove(path);
+}
+
+TESTCASE(Profiler_AllocSites)
+{
+   char path[MAX_PATHNAME], expected[256];
+   TCClass cls = &profTestClasses[0], cls2 = &profTestClasses[1];
+   Method ma = &profTestMethods[0], mb = &profTestMethods[1], native = &profTestMethods[2];
+   int32 farLine = 100 + 17 * (int32)sizeof(TMethod);
+   AllocSite s, next;
+   VoidPArray cs;
+   Context c = null;
+   bool inUse = allocSampleInterval != 0;
+
+   if (inUse)
+      TEST_CANNOT_RUN;
+   xstrprintf(path, "%s/%s.allocs.csv", appPath, mainClassName);
+   initProfilerTest();
+   // ma: lines 100 (pc 0) and farLine (pc 4); mb: line 100
+   ma->flags.isNative = mb->flags.isNative = false;
+   ma->code = mb->code = profTestCode;
+   ma->lineNumberStartPC = newPtrArrayOf(UInt16, 2, null);
+   ma->lineNumberLine = newPtrArrayOf(UInt16, 2, null);
+   mb->lineNumberStartPC = newPtrArrayOf(UInt16, 1, null);
+   mb->lineNumberLine = newPtrArrayOf(UInt16, 1, null);
+   ASSERT1_EQUALS(NotNull, ma->lineNumberStartPC);
+   ASSERT1_EQUALS(NotNull, ma->lineNumberLine);
+   ASSERT1_EQUALS(NotNull, mb->lineNumberStartPC);
+   ASSERT1_EQUALS(NotNull, mb->lineNumberLine);
+   ma->lineNumberStartPC[0] = 0; ma->lineNumberLine[0] = 100;
+   ma->lineNumberStartPC[1] = 4; ma->lineNumberLine[1] = (uint16)farLine;
+   mb->lineNumberStartPC[0] = 0; mb->lineNumberLine[0] = 100;
+   c = newContext(null, null, false);
+   ASSERT1_EQUALS(NotNull, c);
+   cs = c->callStackStart;
+   sitesByHash = htNew(1023, null);
+   allSites = null;
+   siteCount = allocSampleCount = 0;
+   ASSERT1_EQUALS(NotNull, sitesByHash.items);
+   allocSampleInterval = 1024;
+
+   // 1. the site is the first frame that isn't of a native method, at the line of its last call
+   cs[0] = ma; cs[1] = &profTestCode[5];
+   cs[2] = native; cs[3] = null;
+   c->callStack = cs + 4;
+   takeAllocationSample(c, cls, 16);
+   takeAllocationSample(c, cls, 16);
+   takeAllocationSample(c, cls, 4096); // bigger than the interval: counts its size
+   ASSERT2_EQUALS(I32, siteCount, 1);
+   ASSERT1_EQUALS(NotNull, s = findSite(cls, ma, farLine));
+   ASSERT2_EQUALS(I32, s->samples, 3);
+   ASSERT2_EQUALS(I32, (int32)s->bytes, 1024 + 1024 + 4096);
+
+   // 2. the class and the line are part of the site
+   takeAllocationSample(c, cls2, 16);
+   cs[1] = &profTestCode[1];
+   takeAllocationSample(c, cls, 16);
+   ASSERT2_EQUALS(I32, siteCount, 3);
+   ASSERT2_EQUALS(I32, siteSamples(cls2, ma, farLine), 1);
+   ASSERT2_EQUALS(I32, siteSamples(cls, ma, 100), 1);
+
+   // 3. sites with the same hash are kept apart: cls*31 + ma*17 + farLine == cls*31 + mb*17 + 100, since mb == ma+1
+   cs[0] = mb;
+   takeAllocationSample(c, cls, 16);
+   cs[0] = ma; cs[1] = &profTestCode[5];
+   takeAllocationSample(c, cls, 16);
+   ASSERT2_EQUALS(I32, siteCount, 4);
+   ASSERT2_EQUALS(I32, siteSamples(cls, mb, 100), 1);
+   ASSERT2_EQUALS(I32, siteSamples(cls, ma, farLine), 4);
+
+   // 4. an object created by the vm itself, with only native frames or none
+   c->callStack = cs;
+   takeAllocationSample(c, cls, 16);
+   cs[0] = native;
+   c->callStack = cs + 2;
+   takeAllocationSample(c, cls, 16);
+   ASSERT2_EQUALS(I32, siteCount, 5);
+   ASSERT2_EQUALS(I32, siteSamples(cls, null, -1), 2);
+   ASSERT2_EQUALS(I32, allocSampleCount, 9);
+
+   // 5. the sites are written sorted by method, line and class
+   writeSites();
+   ASSERT1_EQUALS(True, profileContains(path, "method,line,class,samples,bytes\n<vm>,-1,tc.test.Prof,2,2048\ntc.test.Prof.a,100,tc.test.Prof,1,1024\n"));
+   xstrprintf(expected, "tc.test.Prof.a,%d,tc.test.Prof,4,7168\ntc.test.Prof.a,%d,tc.test.Prof2,1,1024\ntc.test.Prof.b,100,tc.test.Prof,1,1024\n", farLine, farLine);
+   ASSERT1_EQUALS(True, profileContains(path, expected));
+finish:
+   if (inUse)
+      return;
+   allocSampleInterval = 0;
+   for (s = allSites; s != null; s = next)
+   {
+      next = s->nextAll;
+      xfree(s);
+   }
+   allSites = null;
+   htFree(&sitesByHash, null);
+   freeArray(ma->lineNumberStartPC);
+   freeArray(ma->lineNumberLine);
+   freeArray(mb->lineNumberStartPC);
+   freeArray(mb->lineNumberLine);
+   if (c != null)
+      deleteContext(c, false);
+   remove(path);
+}
@@ -0,0 +1,671 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include "tcvm.h"
+
+/*
+ File format, in the byte order of the device:
+ . magic, version
+ . number of tczs and, for each one, its size and the crc32 of its contents table, as in the load profile
+ . number of names; for each one: its length (including the trailing 0) and the chars
+ . number of classes and number of objects
+ . for each class, in load order: name index, number of int, object and long/double static fields, the int values,
+   the long/double values and the ids of the objects
+ . for each object: name index of its class, the array length (-1 if not an array), the size of its primitive data
+   and the data (the array items, objRec the int fields followed by the long/double fields), the number of references and
+   the ids of the referenced objects
+
+ The objects are numbered from 1 in the order they are reached from the static fields; 0 is null.
+*/
+
+#define SNAPSHOT_MAGIC   0x4E534354 // "TCSN"; a device with another byte order will not recognize the file
+#define SNAPSHOT_VERSION 2
+
+#define OBJ_KEY(o) ((HTKey)(o) >> TSHIFT) // objects are at least TSIZE bytes apart
+
+typedef struct
+{
+   VoidP* items;
+   int32 count, capacity;
+} TPointers;
+
+typedef struct
+{
+   TCClass* classes; // the loaded classes, indexed by their load order
+   int32 classCount;
+   int32* group;     // union-find of the classes that reach the same objects
+   bool* notSaved;   // classes that can't be saved; after the traversal, checked at the group's root
+   Hashtable owners; // object -> 1 + index of the first class that reached it
+   Hashtable kinds;  // class -> 1 if its instances can be saved, 2 if not
+   Hashtable ids;    // object -> id in the file
+   Hashtable names;  // class -> 1 + index in nameClasses
+   Hashtable literals; // string literal -> index of its tcz << 16 | index in the constant pool
+   TPointers pending, objects, nameClasses;
+   bool ok;
+} TSnapshotWriter, *SnapshotWriter;
+
+typedef struct
+{
+   uint8 *p, *end;
+   bool ok;
+} TSnapshotReader, *SnapshotReader;
+
+/// The sections of a snapshot file that passed parseSnapshot
+typedef struct
+{
+   CharP* names;
+   int32 nameCount, classCount, objectCount, literalCount;
+   uint8 *classesStart, *objectsStart, *literalsStart;
+} TSnapshotIndex;
+
+typedef struct
+{
+   int32 name, i32Count, objCount, v64Count;
+   uint8 *i32Values, *v64Values, *objIds;
+} TClassRecord;
+
+typedef struct
+{
+   int32 name, len, byteCount, refCount;
+   uint8 *bytes, *refIds;
+} TObjectRecord;
+
+static CharP getSnapshotPath(CharP path)
+{
+   xstrprintf(path, "%s/%s.tcs", appPath, mainClassName);
+   return path;
+}
+
+static ConstantPool getTCZConstantPool(int32 index) // index < snapshotTCZCount
+{
+   VoidPs* list = openTCZs;
+   while (index-- > 0)
+      list = list->next;
+   return ((TCZFile)list->value)->header->cp;
+}
+
+static bool addPointer(TPointers* v, VoidP p)
+{
+   if (v->count == v->capacity)
+   {
+      int32 capacity = v->capacity == 0 ? 256 : v->capacity * 2;
+      VoidP* items = (VoidP*)xrealloc((uint8*)v->items, capacity * sizeof(VoidP));
+      if (items == null)
+         return false;
+      v->items = items;
+      v->capacity = capacity;
+   }
+   v->items[v->count++] = p;
+   return true;
+}
+
+/// Returns the object references of the given object, or 0 if it has none.
+static int32 getReferences(TCObject o, TCObject** refs)
+{
+   TCClass c = OBJ_CLASS(o);
+   if (*c->name == '[')
+   {
+      if (!c->flags.isObjectArray)
+         return 0;
+      *refs = (TCObject*)ARRAYOBJ_START(o);
+      return ARRAYOBJ_LEN(o);
+   }
+   *refs = (TCObject*)FIELD_OBJ_OFFSET(o, c);
+   return (c->v64Ofs - c->objOfs) / TSIZE;
+}
+
+/// Returns true if the object can be rebuilt from its fields, i.e., it is not kept by a native method.
+static bool canSaveObject(SnapshotWriter w, TCObject o)
+{
+   TCClass c = OBJ_CLASS(o), k;
+   int32 kind, i;
+   if (c->flags.isString) // string literals are locked, but can be rebuilt from their chars
+      return true;
+   if (OBJ_ISLOCKED(o))
+      return false;
+   if ((kind = htGet32(&w->kinds, (HTKey)c)) == 0)
+   {
+      kind = 1;
+      if (*c->name != '[')
+         for (k = c; k->superClass != null && kind == 1; k = k->superClass) // java.lang.Object's native methods don't keep state in the object
+            if (!strEq(k->name, "java.lang.StringBuffer"))
+               for (i = ARRAYLENV(k->methods)-1; i >= 0; i--)
+                  if (k->methods[i].flags.isNative && !k->methods[i].flags.isStatic)
+                  {
+                     kind = 2;
+                     break;
+                  }
+      w->ok &= htPut32(&w->kinds, (HTKey)c, kind);
+   }
+   return kind == 1;
+}
+
+static int32 findGroup(SnapshotWriter w, int32 i)
+{
+   while (w->group[i] != i)
+      i = w->group[i] = w->group[w->group[i]];
+   return i;
+}
+
+static void joinGroups(SnapshotWriter w, int32 a, int32 b)
+{
+   a = findGroup(w, a);
+   b = findGroup(w, b);
+   if (a != b)
+      w->group[b] = a;
+}
+
+/// Visits the objects reachable from the static fields of the given class, joining it with the classes that reach the same objects.
+static void visitStatics(SnapshotWriter w, int32 idx)
+{
+   TCClass c = w->classes[idx];
+   TCObject o, *refs;
+   int32 i, owner;
+
+   for (i = ARRAYLENV(c->objStaticValues)-1; i >= 0; i--)
+      if (c->objStaticValues[i] != null)
+         w->ok &= addPointer(&w->pending, c->objStaticValues[i]);
+   while (w->pending.count > 0 && w->ok)
+   {
+      o = (TCObject)w->pending.items[--w->pending.count];
+      if ((owner = htGet32(&w->owners, OBJ_KEY(o))) != 0)
+      {
+         joinGroups(w, owner-1, idx);
+         continue;
+      }
+      w->ok &= htPut32(&w->owners, OBJ_KEY(o), idx+1);
+      if (!canSaveObject(w, o))
+         w->notSaved[idx] = true;
+      for (i = getReferences(o, &refs); --i >= 0;)
+         if (refs[i] != null)
+            w->ok &= addPointer(&w->pending, refs[i]);
+   }
+}
+
+static int32 getObjectId(SnapshotWriter w, TCObject o)
+{
+   int32 id;
+   if (o == null)
+      return 0;
+   if ((id = htGet32(&w->ids, OBJ_KEY(o))) == 0 && (w->ok &= addPointer(&w->objects, o)) != 0)
+      w->ok &= htPut32(&w->ids, OBJ_KEY(o), id = w->objects.count);
+   return id;
+}
+
+static int32 getNameIndex(SnapshotWriter w, TCClass c)
+{
+   int32 idx = htGet32(&w->names, (HTKey)c);
+   if (idx == 0 && (w->ok &= addPointer(&w->nameClasses, c)) != 0)
+      w->ok &= htPut32(&w->names, (HTKey)c, idx = w->nameClasses.count);
+   return idx-1;
+}
+
+static void write32(FILE* f, int32 v)
+{
+   fwrite(&v, 4, 1, f);
+}
+
+static void writeBytes(FILE* f, VoidP p, int32 n)
+{
+   if (n > 0)
+      fwrite(p, 1, n, f);
+}
+
+static void writeObject(SnapshotWriter w, FILE* f, TCObject o)
+{
+   TCClass c = OBJ_CLASS(o);
+   TCObject* refs;
+   int32 i, n = getReferences(o, &refs);
+   write32(f, getNameIndex(w, c));
+   if (*c->name == '[')
+   {
+      write32(f, ARRAYOBJ_LEN(o));
+      write32(f, c->flags.isObjectArray ? 0 : TC_ARRAYSIZE(c, ARRAYOBJ_LEN(o)));
+      if (!c->flags.isObjectArray)
+         writeBytes(f, ARRAYOBJ_START(o), TC_ARRAYSIZE(c, ARRAYOBJ_LEN(o)));
+   }
+   else
+   {
+      write32(f, -1);
+      write32(f, c->objOfs + c->objSize - c->v64Ofs);
+      writeBytes(f, o, c->objOfs);
+      writeBytes(f, FIELD_V64_OFFSET(o, c), c->objSize - c->v64Ofs);
+   }
+   write32(f, n);
+   for (i = 0; i < n; i++)
+      write32(f, htGet32(&w->ids, OBJ_KEY(refs[i]))); // 0 if null
+}
+
+int32 saveSnapshot(Context currentContext)
+{
+   TSnapshotWriter w;
+   TCClass c;
+   TCObject* refs;
+   VoidPs* list;
+   FILE* f = null;
+   char path[MAX_PATHNAME];
+   int32 i, j, n, saved = 0;
+   int32 mainHash = hashCodeSlash2Dot(mainClassName);
+
+   UNUSED(currentContext);
+   if (snapshotFirstClass < 0)
+      return -1;
+   xmemzero(&w, sizeof(w));
+   LOCKVAR(classLoaderLock);
+   LOCKVAR(omm); // the objects can't be collected nor changed by the gc while they're visited
+   w.ok = true;
+   w.classCount = loadedClassesCount;
+   w.classes = (TCClass*)xmalloc(w.classCount * sizeof(TCClass));
+   w.group = (int32*)xmalloc(w.classCount * sizeof(int32));
+   w.notSaved = (bool*)xmalloc(w.classCount * sizeof(bool));
+   w.owners = htNew(1023, null);
+   w.kinds = htNew(255, null);
+   w.ids = htNew(1023, null);
+   w.names = htNew(255, null);
+   w.literals = htNew(1023, null);
+   if (!w.classes || !w.group || !w.notSaved || !w.owners.items || !w.kinds.items || !w.ids.items || !w.names.items || !w.literals.items)
+      goto error;
+   for (i = 0; i < snapshotTCZCount; i++)
+   {
+      ConstantPool cp = getTCZConstantPool(i);
+      if (cp != null)
+         for (j = 1; j < cp->strCount; j++)
+            w.ok &= htPut32(&w.literals, OBJ_KEY(cp->str[j]), i << 16 | j);
+   }
+
+   // 1. find the classes that can be saved: the ones whose objects can be rebuilt and are not shared with the ones that can't
+   for (i = 0; i <= (int32)htLoadedClasses.table->mask; i++) // the classes are placed in load order
+      if ((c = (TCClass)htLoadedClasses.table->items[i].value) != null && c->index < (uint32)w.classCount)
+         w.classes[c->index] = c;
+   for (i = 0; i < w.classCount; i++)
+      w.group[i] = i;
+   for (i = 0; i < w.classCount && w.ok; i++)
+      if ((c = w.classes[i]) != null)
+      {
+         w.notSaved[i] = i < snapshotFirstClass || *c->name == '[' || c->hash == mainHash; // the main class' static initializer may change Settings, so it must always run
+         visitStatics(&w, i);
+      }
+   for (i = 0; i < w.classCount; i++)
+      if (w.classes[i] == null || w.notSaved[i])
+         w.notSaved[findGroup(&w, i)] = true;
+
+   // 2. number the objects reachable from the classes being saved
+   for (i = 0; i < w.classCount && w.ok; i++)
+      if ((c = w.classes[i]) != null && !w.notSaved[findGroup(&w, i)])
+      {
+         saved++;
+         getNameIndex(&w, c);
+         for (j = 0, n = ARRAYLENV(c->objStaticValues); j < n; j++)
+            getObjectId(&w, c->objStaticValues[j]);
+      }
+   for (i = 0; i < w.objects.count && w.ok; i++)
+   {
+      TCObject o = (TCObject)w.objects.items[i];
+      getNameIndex(&w, OBJ_CLASS(o));
+      for (j = 0, n = getReferences(o, &refs); j < n; j++)
+         getObjectId(&w, refs[j]);
+   }
+   if (!w.ok || (f = fopen(getSnapshotPath(path), "wb")) == null)
+      goto error;
+
+   // 3. write the file
+   write32(f, SNAPSHOT_MAGIC);
+   write32(f, SNAPSHOT_VERSION);
+   write32(f, snapshotTCZCount);
+   for (i = 0, list = openTCZs; i < snapshotTCZCount; i++, list = list->next)
+   {
+      write32(f, getTCZSize((TCZFile)list->value));
+      write32(f, getTCZHash((TCZFile)list->value)); // a class may change without changing the size
+   }
+   write32(f, w.nameClasses.count);
+   for (i = 0; i < w.nameClasses.count; i++)
+   {
+      CharP name = ((TCClass)w.nameClasses.items[i])->name;
+      write32(f, n = xstrlen(name)+1);
+      writeBytes(f, name, n);
+   }
+   write32(f, saved);
+   write32(f, w.objects.count);
+   for (i = 0; i < w.classCount; i++)
+      if ((c = w.classes[i]) != null && !w.notSaved[findGroup(&w, i)])
+      {
+         int32 i32Count = ARRAYLENV(c->i32StaticValues), objCount = ARRAYLENV(c->objStaticValues), v64Count = ARRAYLENV(c->v64StaticValues);
+         write32(f, getNameIndex(&w, c));
+         write32(f, i32Count);
+         write32(f, objCount);
+         write32(f, v64Count);
+         writeBytes(f, c->i32StaticValues, i32Count * 4);
+         writeBytes(f, c->v64StaticValues, v64Count * 8);
+         for (j = 0; j < objCount; j++)
+            write32(f, getObjectId(&w, c->objStaticValues[j]));
+      }
+   for (i = 0; i < w.objects.count; i++)
+      writeObject(&w, f, (TCObject)w.objects.items[i]);
+   for (i = n = 0; i < w.objects.count; i++)
+      if (htGet32(&w.literals, OBJ_KEY(w.objects.items[i])) != 0)
+         n++;
+   write32(f, n);
+   for (i = 0; i < w.objects.count; i++)
+      if ((j = htGet32(&w.literals, OBJ_KEY(w.objects.items[i]))) != 0)
+      {
+         write32(f, i+1);
+         write32(f, j >> 16);
+         write32(f, j & 0xFFFF);
+      }
+   w.ok = !ferror(f);
+   fclose(f);
+   if (!w.ok)
+      remove(path); // don't leave a truncated snapshot behind
+error:
+   UNLOCKVAR(omm);
+   UNLOCKVAR(classLoaderLock);
+   htFree(&w.owners, null);
+   htFree(&w.kinds, null);
+   htFree(&w.ids, null);
+   htFree(&w.names, null);
+   htFree(&w.literals, null);
+   xfree(w.pending.items);
+   xfree(w.objects.items);
+   xfree(w.nameClasses.items);
+   xfree(w.classes);
+   xfree(w.group);
+   xfree(w.notSaved);
+   return w.ok && f != null ? saved : -1;
+}
+
+static int32 read32(SnapshotReader r)
+{
+   int32 v = 0;
+   if (r->end - r->p < 4)
+      r->ok = false;
+   else
+   {
+      xmemmove(&v, r->p, 4);
+      r->p += 4;
+   }
+   return v;
+}
+
+/// Skips count items of the given size, returning where they start; the count was read from the file, so it is checked against the remaining bytes.
+static uint8* readItems(SnapshotReader r, int32 count, int32 size)
+{
+   uint8* p = r->p;
+   if (count < 0 || count > (r->end - r->p) / size)
+   {
+      r->ok = false;
+      return null;
+   }
+   r->p += count * size;
+   return p;
+}
+
+static int32 getId(uint8* ids, int32 i)
+{
+   int32 id;
+   xmemmove(&id, ids + i * 4, 4);
+   return id;
+}
+
+static bool validIds(uint8* ids, int32 count, int32 objectCount)
+{
+   int32 i, id;
+   for (i = 0; i < count; i++)
+      if ((id = getId(ids, i)) < 0 || id > objectCount)
+         return false;
+   return true;
+}
+
+static void readClassRecord(SnapshotReader r, TClassRecord* clsRec, int32 nameCount, int32 objectCount)
+{
+   clsRec->name = read32(r);
+   clsRec->i32Count = read32(r);
+   clsRec->objCount = read32(r);
+   clsRec->v64Count = read32(r);
+   clsRec->i32Values = readItems(r, clsRec->i32Count, 4);
+   clsRec->v64Values = readItems(r, clsRec->v64Count, 8);
+   clsRec->objIds = readItems(r, clsRec->objCount, 4);
+   if (clsRec->name < 0 || clsRec->name >= nameCount || (r->ok && !validIds(clsRec->objIds, clsRec->objCount, objectCount)))
+      r->ok = false;
+}
+
+static void readObjectRecord(SnapshotReader r, TObjectRecord* objRec, int32 nameCount, int32 objectCount)
+{
+   objRec->name = read32(r);
+   objRec->len = read32(r);
+   objRec->byteCount = read32(r);
+   objRec->bytes = readItems(r, objRec->byteCount, 1);
+   objRec->refCount = read32(r);
+   objRec->refIds = readItems(r, objRec->refCount, 4);
+   if (objRec->name < 0 || objRec->name >= nameCount || (r->ok && !validIds(objRec->refIds, objRec->refCount, objectCount)))
+      r->ok = false;
+}
+
+/// Returns true if the object created for the record has the layout of the saved one.
+static bool sameLayout(TCObject o, TObjectRecord* objRec)
+{
+   TCClass c = OBJ_CLASS(o);
+   if (*c->name != '[')
+      return objRec->len == -1 && objRec->byteCount == (int32)(c->objOfs + c->objSize - c->v64Ofs) && objRec->refCount == (c->v64Ofs - c->objOfs) / TSIZE;
+   if (c->flags.isObjectArray)
+      return objRec->byteCount == 0 && objRec->refCount == objRec->len;
+   return objRec->byteCount == (int32)TC_ARRAYSIZE(c, objRec->len) && objRec->refCount == 0;
+}
+
+static void readLiteral(SnapshotReader r, int32* id, ConstantPool* cp, int32* strIdx, int32 objectCount)
+{
+   int32 tcz;
+   *id = read32(r);
+   tcz = read32(r);
+   *strIdx = read32(r);
+   *cp = r->ok && tcz >= 0 && tcz < snapshotTCZCount ? getTCZConstantPool(tcz) : null;
+   if (*id <= 0 || *id > objectCount || *cp == null || *strIdx <= 0 || *strIdx >= (*cp)->strCount)
+      r->ok = false;
+}
+
+/// Checks the whole file before anything is changed, filling the index. Returns false if it's truncated, corrupted or doesn't match the application's tczs.
+static bool parseSnapshot(uint8* buf, int32 size, TSnapshotIndex* idx)
+{
+   TSnapshotReader r;
+   TClassRecord clsRec;
+   TObjectRecord objRec;
+   VoidPs* list;
+   ConstantPool cp;
+   int32 i, id, strIdx;
+
+   xmemzero(idx, sizeof(TSnapshotIndex));
+   r.p = buf;
+   r.end = buf + size;
+   r.ok = read32(&r) == SNAPSHOT_MAGIC && read32(&r) == SNAPSHOT_VERSION && read32(&r) == snapshotTCZCount;
+   for (i = 0, list = openTCZs; i < snapshotTCZCount && r.ok; i++, list = list->next)
+      r.ok = read32(&r) == getTCZSize((TCZFile)list->value) && read32(&r) == getTCZHash((TCZFile)list->value);
+   idx->nameCount = read32(&r);
+   if (!r.ok || idx->nameCount < 0 || idx->nameCount > (r.end - r.p) / 4 || (idx->names = (CharP*)xmalloc(idx->nameCount * sizeof(CharP) + 1)) == null) // each name takes at least 4 bytes
+      return false;
+   for (i = 0; i < idx->nameCount && r.ok; i++)
+   {
+      int32 len = read32(&r);
+      CharP name = idx->names[i] = (CharP)readItems(&r, len, 1);
+      if (name == null || len == 0 || name[len-1] != 0)
+         r.ok = false;
+   }
+   idx->classCount = read32(&r);
+   idx->objectCount = read32(&r);
+   idx->classesStart = r.p;
+   for (i = 0; i < idx->classCount && r.ok; i++)
+      readClassRecord(&r, &clsRec, idx->nameCount, idx->objectCount);
+   idx->objectsStart = r.p;
+   for (i = 0; i < idx->objectCount && r.ok; i++)
+      readObjectRecord(&r, &objRec, idx->nameCount, idx->objectCount);
+   idx->literalCount = read32(&r);
+   idx->literalsStart = r.p;
+   for (i = 0; i < idx->literalCount && r.ok; i++)
+      readLiteral(&r, &id, &cp, &strIdx, idx->objectCount);
+   return r.ok && r.p == r.end && idx->classCount >= 0 && idx->objectCount >= 0 && idx->literalCount >= 0;
+}
+
+/// Creates and fills the objects of the snapshot; objects[id] gets each one, and literal[id] tells the literals, which are not created.
+/// The created objects are locked; they're unlocked by the caller. Returns false if an object could not be created or its class changed.
+static bool rebuildObjects(Context currentContext, TSnapshotIndex* idx, TCObject* objects, bool* literal, int32* created)
+{
+   TSnapshotReader r;
+   TObjectRecord objRec;
+   ConstantPool cp;
+   int32 i, j, id, strIdx;
+
+   r.end = idx->literalsStart + idx->literalCount * 12;
+   for (r.p = idx->literalsStart, r.ok = true, i = 0; i < idx->literalCount; i++)
+   {
+      readLiteral(&r, &id, &cp, &strIdx, idx->objectCount);
+      objects[id] = cp->str[strIdx];
+      literal[id] = true;
+   }
+   for (r.p = idx->objectsStart, r.end = idx->literalsStart, i = 1; i <= idx->objectCount; i++)
+   {
+      TCObject o;
+      readObjectRecord(&r, &objRec, idx->nameCount, idx->objectCount);
+      if (literal[i])
+         continue;
+      o = *idx->names[objRec.name] == '[' ? createArrayObject(currentContext, idx->names[objRec.name], objRec.len) : createObjectWithoutCallingDefaultConstructor(currentContext, idx->names[objRec.name]);
+      if (o == null)
+         return false;
+      objects[i] = o;
+      (*created)++;
+      if (!sameLayout(o, &objRec))
+         return false;
+   }
+   for (r.p = idx->objectsStart, i = 1; i <= idx->objectCount; i++)
+   {
+      TCObject o = objects[i], *refs;
+      TCClass c = OBJ_CLASS(o);
+      readObjectRecord(&r, &objRec, idx->nameCount, idx->objectCount);
+      if (literal[i])
+         continue;
+      if (*c->name == '[')
+         xmemmove(ARRAYOBJ_START(o), objRec.bytes, objRec.byteCount);
+      else
+      {
+         xmemmove(o, objRec.bytes, c->objOfs);
+         xmemmove(FIELD_V64_OFFSET(o, c), objRec.bytes + c->objOfs, c->objSize - c->v64Ofs);
+         if (c->flags.isString)
+            String_hashCache(o) = 0; // computed again from the restored chars when needed
+      }
+      for (j = 0, getReferences(o, &refs); j < objRec.refCount; j++)
+      {
+         refs[j] = objects[getId(objRec.refIds, j)];
+         WRITE_BARRIER(o, refs[j]);
+      }
+   }
+   return true;
+}
+
+void restoreSnapshot(Context currentContext)
+{
+   TSnapshotReader r;
+   TSnapshotIndex idx;
+   TClassRecord clsRec;
+   VoidPs* list;
+   FILE* f;
+   char path[MAX_PATHNAME];
+   uint8 *buf = null;
+   TCClass* classes = null;
+   TCObject* objects = null;
+   bool* literal = null;
+   int32 size, i, j, loaded = 0, created = 0;
+   bool restored = false;
+
+   xmemzero(&idx, sizeof(idx));
+   snapshotFirstClass = loadedClassesCount;
+   snapshotTCZCount = 0;
+   if ((list = openTCZs) != null)
+      do
+      {
+         snapshotTCZCount++;
+         list = list->next;
+      } while (list != openTCZs);
+   if ((f = fopen(getSnapshotPath(path), "rb")) == null)
+      return;
+   fseek(f, 0, SEEK_END);
+   size = (int32)ftell(f);
+   fseek(f, 0, SEEK_SET);
+   if (size > 0 && (buf = (uint8*)xmalloc(size)) != null && (int32)fread(buf, 1, size, f) != size)
+      xfree(buf);
+   fclose(f);
+   if (buf == null)
+      return;
+
+   // 1. check the whole file before changing anything
+   if (!parseSnapshot(buf, size, &idx))
+      goto outdated;
+   r.end = idx.objectsStart;
+   for (r.p = idx.classesStart, r.ok = true, i = 0; i < idx.classCount; i++)
+   {
+      readClassRecord(&r, &clsRec, idx.nameCount, idx.objectCount);
+      if (khGet(&htLoadedClasses, idx.names[clsRec.name], hashCodeSlash2Dot(idx.names[clsRec.name])) != null) // its static initializer already ran
+         goto outdated;
+   }
+   if ((classes = (TCClass*)xmalloc(idx.classCount * sizeof(TCClass) + 1)) == null || (objects = (TCObject*)xmalloc((idx.objectCount+1) * sizeof(TCObject))) == null ||
+      (literal = (bool*)xmalloc(idx.objectCount+1)) == null)
+      goto outdated;
+
+   // 2. load the classes without running their static initializers. The superclasses come first, since they're loaded before
+   for (r.p = idx.classesStart; loaded < idx.classCount; loaded++)
+   {
+      TCClass c;
+      readClassRecord(&r, &clsRec, idx.nameCount, idx.objectCount);
+      if (khGet(&htLoadedClasses, idx.names[clsRec.name], hashCodeSlash2Dot(idx.names[clsRec.name])) != null || // loaded by the static initializer of a class that is not in the snapshot
+         (c = loadClassWithoutStaticInitializer(currentContext, idx.names[clsRec.name])) == null)
+         goto error;
+      classes[loaded] = c;
+      if (ARRAYLENV(c->i32StaticValues) != clsRec.i32Count || ARRAYLENV(c->objStaticValues) != clsRec.objCount || ARRAYLENV(c->v64StaticValues) != clsRec.v64Count)
+      {
+         loaded++;
+         goto error;
+      }
+   }
+
+   // 3. create and fill the objects; they stay locked until the static fields are filled
+   if (!rebuildObjects(currentContext, &idx, objects, literal, &created))
+      goto error;
+
+   // 4. fill the static fields
+   for (r.p = idx.classesStart, i = 0; i < idx.classCount; i++)
+   {
+      TCClass c = classes[i];
+      readClassRecord(&r, &clsRec, idx.nameCount, idx.objectCount);
+      if (clsRec.i32Count > 0) xmemmove(c->i32StaticValues, clsRec.i32Values, clsRec.i32Count * 4);
+      if (clsRec.v64Count > 0) xmemmove(c->v64StaticValues, clsRec.v64Values, clsRec.v64Count * 8);
+      for (j = 0; j < clsRec.objCount; j++)
+         c->objStaticValues[j] = objects[getId(clsRec.objIds, j)];
+   }
+   restored = true;
+error:
+   for (i = 1; i <= idx.objectCount; i++)
+      if (objects[i] != null && !literal[i]) // the literals stay locked
+         setObjectLock(objects[i], UNLOCKED);
+   if (!restored)
+   {
+      debug("Could not restore the startup snapshot %s; running the static initializers", path);
+      currentContext->thrownException = null;
+      for (i = 0; i < loaded; i++)
+      {
+         Method staticInitializer = getMethod(classes[i], false, STATIC_INIT_NAME, 0);
+         if (staticInitializer != null)
+            executeMethod(currentContext, staticInitializer);
+      }
+   }
+   goto finish;
+outdated:
+   debug("Ignoring the startup snapshot %s: it doesn't match the application", path);
+finish:
+   xfree(buf);
+   xfree(idx.names);
+   xfree(classes);
+   xfree(objects);
+   xfree(literal);
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "snapshot_test.h"
+#endif
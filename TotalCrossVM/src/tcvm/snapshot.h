@@ -0,0 +1,31 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/*
+ Startup snapshot. When the application calls Vm.saveStartupSnapshot, the static fields of the application classes
+ loaded so far and the objects reachable from them are written to <appPath>/<main class>.tcs. In the next launches, the
+ snapshot is read before the main class is loaded: its classes are loaded without running their static initializers,
+ and their static fields and objects are rebuilt from the file. String literals are not rebuilt: the fields point again
+ to the literals loaded with the classes, so comparing them with == still works.
+
+ A class is saved only if the objects it reaches can be rebuilt from their fields alone: objects locked by native code,
+ or whose class (or superclass) has non-static native methods (Class, Thread, Image, File...), are not saved, along with
+ every class that shares an object with such a class or with a class that is not saved, like the main class (which
+ must always run its static initializer because it may change Settings) and the classes loaded when the vm started.
+ The classes that are not saved run their static initializers as usual.
+
+ The snapshot is ignored if the application's tczs changed. If anything fails while restoring it, the static
+ initializers of the classes loaded from it are run, as if there was no snapshot.
+*/
+
+/// Restores the startup snapshot, if there's one; called just before the main class is loaded.
+void restoreSnapshot(Context currentContext);
+/// Saves the startup snapshot. Returns the number of classes saved, or -1 if the file could not be written.
+int32 saveSnapshot(Context currentContext);
+
+#endif
@@ -0,0 +1,150 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+static uint8* readSnapshotFile(CharP path, int32* size)
+{
+   FILE* f = fopen(path, "rb");
+   uint8* buf = null;
+   if (f == null)
+      return null;
+   fseek(f, 0, SEEK_END);
+   *size = (int32)ftell(f);
+   fseek(f, 0, SEEK_SET);
+   if (*size > 0 && (buf = (uint8*)xmalloc(*size + 4)) != null && (int32)fread(buf, 1, *size, f) != *size) // 4 more bytes, for the test with an extra byte
+      xfree(buf);
+   fclose(f);
+   return buf;
+}
+
+static bool checkSnapshot(uint8* buf, int32 size)
+{
+   TSnapshotIndex idx;
+   bool ok = parseSnapshot(buf, size, &idx);
+   xfree(idx.names);
+   return ok;
+}
+
+static bool sameChars(TCObject s1, TCObject s2)
+{
+   return String_charsLen(s1) == String_charsLen(s2) && xmemcmp(String_charsStart(s1), String_charsStart(s2), String_charsLen(s1) * 2) == 0;
+}
+
+TESTCASE(Snapshot_RoundTrip)
+{
+   int32 firstClass = snapshotFirstClass, tczCount = snapshotTCZCount, size = 0, i, j, pos, badId;
+   char path[MAX_PATHNAME];
+   TCClass c = null;
+   TCObject literal = null, plain = null, array = null, saved = null;
+   TCObject *objects = null, *restored;
+   bool* isLiteral = null;
+   uint8 *buf = null, *copy = null;
+   TSnapshotIndex idx;
+   TSnapshotReader r;
+   TClassRecord clsRec;
+   VoidPs* list;
+   ConstantPool cp;
+
+   xmemzero(&idx, sizeof(idx));
+   getSnapshotPath(path);
+   snapshotFirstClass = 0;
+   snapshotTCZCount = 0;
+   if ((list = openTCZs) != null)
+      do
+      {
+         snapshotTCZCount++;
+         list = list->next;
+      } while (list != openTCZs);
+   for (i = 0; i < snapshotTCZCount && literal == null; i++)
+      if ((cp = getTCZConstantPool(i)) != null && cp->strCount > 1)
+         literal = cp->str[1];
+   // a class whose static fields are all null will hold a literal and another string, with a wrong hash cache
+   for (i = 0; i <= (int32)htLoadedClasses.table->mask && c == null; i++)
+      if ((c = (TCClass)htLoadedClasses.table->items[i].value) != null)
+         if (*c->name == '[' || c->hash == hashCodeSlash2Dot(mainClassName) || ARRAYLENV(c->objStaticValues) == 0 || c->objStaticValues[0] != null)
+            c = null;
+   if (literal == null || c == null)
+      TEST_CANNOT_RUN;
+   plain = createStringObjectFromCharP(currentContext, "snapshot", 8);
+   array = createStringArray(currentContext, 2);
+   ASSERT1_EQUALS(NotNull, array);
+   ((TCObject*)ARRAYOBJ_START(array))[0] = literal;
+   ((TCObject*)ARRAYOBJ_START(array))[1] = plain;
+   String_hashCache(plain) = STRING_HASH_CACHED | 123;
+   c->objStaticValues[0] = array; // the static field keeps them alive until the end
+   setObjectLock(plain, UNLOCKED);
+   setObjectLock(array, UNLOCKED); // a locked array would keep the class out of the snapshot
+
+   // 1. save and read it back: the literal keeps its identity, the other objects are rebuilt
+   ASSERT_ABOVE(I32, saveSnapshot(currentContext), 0);
+   buf = readSnapshotFile(path, &size);
+   ASSERT1_EQUALS(NotNull, buf);
+   ASSERT1_EQUALS(True, parseSnapshot(buf, size, &idx));
+   ASSERT_ABOVE(I32, idx.literalCount, 0);
+   objects = (TCObject*)xmalloc((idx.objectCount+1) * sizeof(TCObject));
+   isLiteral = (bool*)xmalloc(idx.objectCount+1);
+   ASSERT1_EQUALS(NotNull, isLiteral);
+   ASSERT1_EQUALS(True, rebuildObjects(currentContext, &idx, objects, isLiteral, &i));
+   r.end = idx.objectsStart;
+   for (r.p = idx.classesStart, r.ok = true, i = 0; i < idx.classCount && saved == null; i++)
+   {
+      readClassRecord(&r, &clsRec, idx.nameCount, idx.objectCount);
+      if (strEq(idx.names[clsRec.name], c->name))
+         saved = objects[getId(clsRec.objIds, 0)];
+   }
+   ASSERT1_EQUALS(NotNull, saved);
+   ASSERT1_EQUALS(False, saved == array);
+   restored = (TCObject*)ARRAYOBJ_START(saved);
+   ASSERT2_EQUALS(Ptr, restored[0], literal);
+   ASSERT1_EQUALS(NotNull, restored[1]);
+   ASSERT1_EQUALS(False, restored[1] == plain);
+   ASSERT1_EQUALS(True, sameChars(restored[1], plain));
+   ASSERT2_EQUALS(I32, (int32)(String_hashCache(restored[1]) >> 32), 0);
+
+   // 2. a truncated file is rejected
+   ASSERT1_EQUALS(True, checkSnapshot(buf, size));
+   ASSERT1_EQUALS(False, checkSnapshot(buf, size-1));
+   ASSERT1_EQUALS(False, checkSnapshot(buf, size-4));
+   ASSERT1_EQUALS(False, checkSnapshot(buf, size/2));
+   ASSERT1_EQUALS(False, checkSnapshot(buf, 8));
+   ASSERT1_EQUALS(False, checkSnapshot(buf, 0));
+   buf[size] = 0;
+   ASSERT1_EQUALS(False, checkSnapshot(buf, size+1)); // and so is one with garbage at the end
+
+   // 3. so is a corrupted one: the header, the counts and the ids are checked
+   copy = (uint8*)xmalloc(size);
+   ASSERT1_EQUALS(NotNull, copy);
+   for (pos = 0; pos < 12 + snapshotTCZCount * 8 + 4; pos += 4) // magic, version, tczs and their sizes and hashes, number of names
+   {
+      xmemmove(copy, buf, size);
+      copy[pos+1] ^= 0x5A;
+      ASSERT1_EQUALS(False, checkSnapshot(copy, size));
+   }
+   xmemmove(copy, buf, size);
+   badId = idx.objectCount + 1;
+   xmemmove(copy + size - 12, &badId, 4); // the last literal's object id
+   ASSERT1_EQUALS(False, checkSnapshot(copy, size));
+   for (j = size / 97 + 1, pos = 0; pos < size; pos += j) // any other byte may be changed, but the file is never read out of its bounds
+   {
+      xmemmove(copy, buf, size);
+      copy[pos] ^= 0xFF;
+      checkSnapshot(copy, size);
+   }
+finish:
+   if (c != null)
+      c->objStaticValues[0] = null;
+   if (objects != null && isLiteral != null)
+      for (i = 1; i <= idx.objectCount; i++)
+         if (objects[i] != null && !isLiteral[i])
+            setObjectLock(objects[i], UNLOCKED);
+   currentContext->thrownException = null;
+   remove(path);
+   xfree(idx.names);
+   xfree(objects);
+   xfree(isLiteral);
+   xfree(buf);
+   xfree(copy);
+   snapshotFirstClass = firstClass;
+   snapshotTCZCount = tczCount;
+}
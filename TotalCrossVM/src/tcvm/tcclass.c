@@ -10,6 +10,12 @@
 #endif
 
 DECLARE_MUTEX(classLoaderLock);
+static KeyHashtable htLoadingClasses; // name of the classes being read -> context of the thread that is reading it
+static Context classWaiters; // threads waiting for a class that another thread is reading, linked by nextClassWaiter
+
+#define CLASS_WAIT_MILLIS 100 // the waiting threads check again after this time, in case a wake up is missed
+
+static TCClass privateLoadClass(Context currentContext, CharP className, bool throwClassNotFound, bool runStaticInitializer);
 
 /* These are the structures for Class, Method and Field that are persisted to disk.
  * The structures that will be kept into memory are available at tcvm.h.
@@ -117,18 +123,12 @@ void methodHashCode(CharP name, uint16* cpParams, int32 n, ConstantPool cp, int3
       *hashParam += hashCode(cp->cls[*cpParams]);
 }
 
-void readConstantPool(Context currentContext, ConstantPool t, TCZFile tcz, Heap heap)
+static void readSymbols(ConstantPool t, TCZFile tcz, Heap heap)
 {
    int32 len,i,partSize;
-   CharPArray sa; TCObjectArray oa;
+   CharPArray sa;
    uint16* u;
-   char chars[256];
-   uint8 mark;
 
-   tcz->tempHeap = heap;
-   tczRead(tcz, &t->i32Count, 18);
-
-   // read the symbol arrays
    if (t->i32Count > 0)
    {
       t->i32 = newPtrArrayOf(Int32,t->i32Count, heap);
@@ -182,7 +182,6 @@ void readConstantPool(Context currentContext, ConstantPool t, TCZFile tcz, Heap
          }
       }
       t->boundNormal = (MethodPtrArray)newArray(sizeof(Method), t->mtdCount, heap);
-      t->boundVirtualMethod = (MethodAndClassPtrArray)newArray(TSIZE, t->mtdCount, heap);
    }
 
    partSize = tczRead32(tcz);
@@ -206,6 +205,8 @@ void readConstantPool(Context currentContext, ConstantPool t, TCZFile tcz, Heap
       uint8* bunch = heapAlloc(heap, partSize+1);
       tczRead(tcz, bunch, partSize);
       sa = t->cls = newPtrArrayOf(CharP, t->clsCount, heap);
+      t->boundClass = newPtrArrayOf(TCClass, t->clsCount, heap);
+      t->instanceOfCache = newPtrArrayOf(TCClass, t->clsCount, heap);
       for (sa++, i = t->clsCount; --i > 0; sa++)
       {
          len = *bunch;
@@ -214,6 +215,125 @@ void readConstantPool(Context currentContext, ConstantPool t, TCZFile tcz, Heap
          bunch += len+1;
       }
    }
+}
+
+static VoidP mapArray(TCZFile tcz, int32 count, int32 elemSize, Heap heap) // in a prelinked tcz, the array is preceded by its length, so it can be used in place
+{
+   uint8* p;
+   int32 len[2];
+   tczAlign(tcz, 8);
+   if ((p = tczMap(tcz, 8 + count * elemSize)) != null)
+   {
+      if (((int32*)p)[0] != count || ((int32*)p)[1] != count) // the length is stored twice, so it is the same for 32 and 64-bit size_t
+         HEAP_ERROR(heap, HEAP_ZIP_ERROR);
+      return p + 8;
+   }
+   tczRead(tcz, len, 8);
+   if (len[0] != count || len[1] != count)
+      HEAP_ERROR(heap, HEAP_ZIP_ERROR);
+   p = newArray(elemSize, count, heap);
+   tczRead(tcz, p, count * elemSize);
+   return p;
+}
+
+static VoidP mapPart(TCZFile tcz, Heap heap, int32* size)
+{
+   int32 partSize;
+   uint8* p;
+   tczAlign(tcz, 4);
+   *size = partSize = tczRead32(tcz);
+   if (partSize < 0 || partSize > tcz->remaining)
+      HEAP_ERROR(heap, HEAP_ZIP_ERROR);
+   if ((p = tczMap(tcz, partSize)) == null)
+   {
+      p = heapAlloc(heap, partSize+1);
+      tczRead(tcz, p, partSize);
+   }
+   return p;
+}
+
+static CharPArray mapNames(TCZFile tcz, int32 count, Heap heap) // the names are already zero terminated
+{
+   int32 i, size;
+   uint8* bunch = mapPart(tcz, heap, &size), *end = bunch + size;
+   CharPArray sa0 = null, sa;
+   if (count > 0)
+      for (sa = sa0 = newPtrArrayOf(CharP, count, heap), sa++, i = count; --i > 0; sa++)
+      {
+         if (bunch >= end || bunch + *bunch + 2 > end || bunch[*bunch + 1] != 0) // a name must not go past the part
+            HEAP_ERROR(heap, HEAP_ZIP_ERROR);
+         *sa = (CharP)(bunch+1);
+         bunch += *bunch + 2;
+      }
+   return sa0;
+}
+
+static void mapSymbols(ConstantPool t, TCZFile tcz, Heap heap) // same as readSymbols, for the prelinked layout
+{
+   int32 i;
+   if (t->i32Count > 0)
+      t->i32 = mapArray(tcz, t->i32Count, 4, heap);
+   if (t->i64Count > 0)
+      t->i64 = mapArray(tcz, t->i64Count, 8, heap);
+   if (t->dblCount > 0)
+      t->dbl = mapArray(tcz, t->dblCount, 8, heap);
+   if (t->sfieldCount > 0)
+   {
+      t->sfieldField = mapArray(tcz, t->sfieldCount, 2, heap);
+      t->sfieldClass = mapArray(tcz, t->sfieldCount, 2, heap);
+      t->boundSField = newPtrArrayOf(VoidP, t->sfieldCount, heap);
+   }
+   if (t->ifieldCount > 0)
+   {
+      t->ifieldField = mapArray(tcz, t->ifieldCount, 2, heap);
+      t->ifieldClass = mapArray(tcz, t->ifieldCount, 2, heap);
+      t->boundIField = newPtrArrayOf(UInt16, t->ifieldCount, heap);
+      xmemset(t->boundIField,255, t->ifieldCount<<1);
+   }
+   if (t->mtdCount > 0)
+   {
+      uint8* lens;
+      uint16* bunch;
+      UInt16Array *ua = t->mtd = (UInt16Matrix)newArray(sizeof(UInt16Array), t->mtdCount, heap); // caution! this is not an uint16 array, but an uint16 matrix!
+      lens = t->mtdLens = mapArray(tcz, t->mtdCount, 1, heap);
+      if (t->mtdCount > 1)
+      {
+         int32 size;
+         uint16* end;
+         for (bunch = mapPart(tcz, heap, &size), end = bunch + size/2, lens++,ua++, i = t->mtdCount; --i > 0; ua++)
+         {
+            if (bunch + *lens + 2 > end) // a method reference must not go past the part
+               HEAP_ERROR(heap, HEAP_ZIP_ERROR);
+            *ua = bunch;
+            bunch += *lens++ + 2;
+         }
+      }
+      t->boundNormal = (MethodPtrArray)newArray(sizeof(Method), t->mtdCount, heap);
+   }
+   t->mtdfld = mapNames(tcz, t->mtdfldCount, heap);
+   t->cls = mapNames(tcz, t->clsCount, heap);
+   if (t->clsCount > 0)
+   {
+      t->boundClass = newPtrArrayOf(TCClass, t->clsCount, heap);
+      t->instanceOfCache = newPtrArrayOf(TCClass, t->clsCount, heap);
+   }
+}
+
+void readConstantPool(Context currentContext, ConstantPool t, TCZFile tcz, Heap heap)
+{
+   int32 len,i;
+   TCObjectArray oa;
+   char chars[256];
+   uint8 mark;
+
+   tcz->tempHeap = heap;
+   tczRead(tcz, &t->i32Count, 18);
+
+   // read the symbol arrays; in a prelinked tcz, they are used in place
+   if (tcz->stored)
+      mapSymbols(t, tcz, heap);
+   else
+      readSymbols(t, tcz, heap);
    if (t->strCount > 0) // String constants must be the last loaded one!
    {
 #ifdef DEBUG_OMM_LIST
@@ -233,8 +353,16 @@ void readConstantPool(Context currentContext, ConstantPool t, TCZFile tcz, Heap
          else
          {
             len = tczRead16(tcz) & 0xFFFF;
+            if (mark == 254 && IS_VMTWEAK_ON(VMTWEAK_COMPACT_STRINGS)) // the chars are read directly into the compact string
+            {
+               if ((*oa = createLatin1StringObjectWithLen(currentContext, len)) == null)
+                  HEAP_ERROR(heap, HEAP_MEMORY_ERROR);
+               tczRead(tcz, String_latin1Start(*oa), len);
+            }
+            else
             if ((*oa = createStringObjectWithLen(currentContext, len)) == null)
                HEAP_ERROR(heap, HEAP_MEMORY_ERROR);
+            else
             if (mark == 254) // can && l > 255
             {
                JCharP jc = String_charsStart(*oa);
@@ -369,43 +497,27 @@ static CharP createMethodSignature(Method m, Heap h)
 
 #define ALL_1 255
 
-static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
+static void readMethodBody(ConstantPool cp, TCZFile tcz, Method m, TMethodInfoHeader* ti, Heap heap)
 {
-   TMethodInfoHeader ti;
    int32 i;
    ExceptionArray ex; TExceptionInfo exi;
 
-   tczRead(tcz, &ti, 16);
-
-   m->flags = ti.flags;
-   m->iCount  = ti.iCount;
-   m->oCount  = ti.oCount;
-   m->v64Count = ti.v64Count;
-   m->paramCount = ti.paramCount;
-   m->name = cp->mtdfld[ti.cpName];
-   m->cpReturn = ti.cpReturn;
-
-   m->class_ = c;
-
-   // read the method signature
-   if (m->paramCount > 0)
-   {
-      m->cpParams = newPtrArrayOf(UInt16, m->paramCount, tcz->tempHeap);
-      tczRead(tcz, m->cpParams, 2*m->paramCount);
-      m->paramRegs = genParamRegs(cp, m->cpParams, tcz->tempHeap);
-   }
-   methodHashCode(m->name, m->cpParams, m->paramCount, c->cp, &m->hashName, &m->hashParams);
    // read the opcodes
-   if (ti.opcodeCount > 0)
+   if (ti->opcodeCount > 0)
    {
-      m->code = newArrayOf(Code, ti.opcodeCount, tcz->tempHeap);
-      tczRead(tcz, m->code, 4*ti.opcodeCount);
+      if (tcz->stored)
+         m->code = mapArray(tcz, ti->opcodeCount, sizeof(TCode), heap);
+      else
+      {
+         m->code = newArrayOf(Code, ti->opcodeCount, heap);
+         tczRead(tcz, m->code, 4*ti->opcodeCount);
+      }
    }
    // read the Exception handlers
-   if (ti.exceptionHandlersCount > 0)
+   if (ti->exceptionHandlersCount > 0)
    {
-      m->exceptionHandlers = newArrayOf(Exception, ti.exceptionHandlersCount, tcz->tempHeap);
-      for (i = ti.exceptionHandlersCount, ex = m->exceptionHandlers; i-- > 0; ex++)
+      m->exceptionHandlers = newArrayOf(Exception, ti->exceptionHandlersCount, heap);
+      for (i = ti->exceptionHandlersCount, ex = m->exceptionHandlers; i-- > 0; ex++)
       {
          tczRead(tcz, &exi, 10);
          ex->startPC = m->code + exi.startPC;
@@ -416,15 +528,15 @@ static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
       }
    }
    // read the line number debug info
-   if (ti.lineNumberInfoCount > 0)
+   if (ti->lineNumberInfoCount > 0)
    {
       uint8 first;
       uint16 *p, *pend;
       uint8 *t;
-      m->lineNumberStartPC = newPtrArrayOf(UInt16, ti.lineNumberInfoCount, tcz->tempHeap); // guich@tc110_69: now the line number is placed in two uint16 arrays.
-      m->lineNumberLine    = newPtrArrayOf(UInt16, ti.lineNumberInfoCount, tcz->tempHeap);
+      m->lineNumberStartPC = newPtrArrayOf(UInt16, ti->lineNumberInfoCount, heap); // guich@tc110_69: now the line number is placed in two uint16 arrays.
+      m->lineNumberLine    = newPtrArrayOf(UInt16, ti->lineNumberInfoCount, heap);
       tczRead(tcz, &first, 1);
-      if (ti.lineNumberInfoCount == 1)
+      if (ti->lineNumberInfoCount == 1)
       {
          uint8 second;
          tczRead(tcz, &second, 1);
@@ -433,19 +545,19 @@ static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
       else
       {
          p = m->lineNumberStartPC;
-         pend = p + ti.lineNumberInfoCount;
+         pend = p + ti->lineNumberInfoCount;
          // read pc
          if (first == ALL_1) // all1 means pcs = 0,1,2,3,4,... p[0] is already 0
-            for (i=1; i < ti.lineNumberInfoCount; i++)
+            for (i=1; i < ti->lineNumberInfoCount; i++)
                *++p = i;
          else
          {
             *++p = first; // p[0] is always 0, so we skip it; put in p[1] the first that was already read
-            if (ti.lineNumberInfoCount > 2)
+            if (ti->lineNumberInfoCount > 2)
             {
                t = (uint8*)p;
-               tczRead(tcz, t+1, ti.lineNumberInfoCount-2); // read the byte array into the short array
-               for (i = ti.lineNumberInfoCount-2; i >= 1; i--) // transform the byte array into a short array. p[0] and p[1] are already filled - guich@tc114_83: correct is -2, not -1
+               tczRead(tcz, t+1, ti->lineNumberInfoCount-2); // read the byte array into the short array
+               for (i = ti->lineNumberInfoCount-2; i >= 1; i--) // transform the byte array into a short array. p[0] and p[1] are already filled - guich@tc114_83: correct is -2, not -1
                {
                   p[i] = t[i];
                   t[i] = 0;
@@ -456,19 +568,19 @@ static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
          }
          // line numbers - read the first, then all differences
          p = m->lineNumberLine;
-         pend = p + ti.lineNumberInfoCount;
+         pend = p + ti->lineNumberInfoCount;
          t = (uint8*)p;
          tczRead(tcz, t, 3); // read the starting line number and the first
          if (t[2] == ALL_1)
-            for (i=1,p++; i < ti.lineNumberInfoCount; i++,p++)
+            for (i=1,p++; i < ti->lineNumberInfoCount; i++,p++)
                *p = m->lineNumberLine[0] + i;
          else
          {
             // now we have: p[0] = line[0], and first at the nibble 1 of p[1]
-            if (ti.lineNumberInfoCount > 2)
+            if (ti->lineNumberInfoCount > 2)
             {
-               tczRead(tcz, t+3, ti.lineNumberInfoCount-2); // read the byte array into the short array
-               for (i = ti.lineNumberInfoCount-1; i >= 2; i--) // transform the byte array into a short array. p[0] and p[1] are already filled
+               tczRead(tcz, t+3, ti->lineNumberInfoCount-2); // read the byte array into the short array
+               for (i = ti->lineNumberInfoCount-1; i >= 2; i--) // transform the byte array into a short array. p[0] and p[1] are already filled
                {
                   p[i] = t[i+1];
                   t[i+1] = 0;
@@ -479,6 +591,43 @@ static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
          }
       }
    }
+}
+
+static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
+{
+   TMethodInfoHeader ti;
+   uint8* start = tcz->stored && tcz->header->map != null ? tcz->header->map + tcz->expectedFilePos : null;
+
+   tczRead(tcz, &ti, 16);
+
+   m->flags = ti.flags;
+   m->iCount  = ti.iCount;
+   m->oCount  = ti.oCount;
+   m->v64Count = ti.v64Count;
+   m->paramCount = ti.paramCount;
+   m->name = cp->mtdfld[ti.cpName];
+   m->cpReturn = ti.cpReturn;
+
+   m->class_ = c;
+
+   // read the method signature
+   if (m->paramCount > 0)
+   {
+      m->cpParams = newPtrArrayOf(UInt16, m->paramCount, tcz->tempHeap);
+      tczRead(tcz, m->cpParams, 2*m->paramCount);
+      m->paramRegs = genParamRegs(cp, m->cpParams, tcz->tempHeap);
+   }
+   methodHashCode(m->name, m->cpParams, m->paramCount, c->cp, &m->hashName, &m->hashParams);
+   if (!tcz->stored)
+      readMethodBody(cp, tcz, m, &ti, tcz->tempHeap);
+   else
+   {
+      int32 bodySize = tczRead32(tcz); // a prelinked tcz stores the size, so the body can be skipped
+      if (start != null && ti.opcodeCount > 0 && tczMap(tcz, bodySize) != null) // most methods are never called: read the rest when it happens
+         m->body = start;
+      else
+         readMethodBody(cp, tcz, m, &ti, tcz->tempHeap);
+   }
    if (m->paramCount > 0)
       m->paramSkip = (uint8)((3 + m->paramCount - (m->cpReturn == 0)) >> 2);
    if (m->flags.isNative)
@@ -487,6 +636,54 @@ static void readMethod(ConstantPool cp, TCZFile tcz, Method m, TCClass c)
       m->returnReg = getRegType(cp, m->cpReturn);
 }
 
+bool loadMethodBody(Method m)
+{
+   TTCZFileHeader header;
+   TMethodInfoHeader ti;
+   TMethod t;
+   TCZFile tcz;
+   Heap heap = m->class_->heap;
+
+   LOCKVAR(metAndCls); // the class heap is shared with dispatchInsert
+   if (m->code != null) // another thread already read it
+   {
+      UNLOCKVAR(metAndCls);
+      return true;
+   }
+   if ((tcz = newX(TCZFile)) == null)
+   {
+      UNLOCKVAR(metAndCls);
+      return false;
+   }
+   IF_HEAP_ERROR(heap)
+   {
+      xfree(tcz);
+      UNLOCKVAR(metAndCls);
+      return false;
+   }
+   // read from the mapped file, as the stored chunk would be read. The file is mapped at a page boundary, so the
+   // position of the body inside an 8-byte aligned map keeps the alignment of the code
+   xmemzero(&header, sizeof(header));
+   header.map = (uint8*)((size_t)m->body & ~(size_t)7);
+   tcz->header = &header;
+   tcz->expectedFilePos = (int32)(m->body - header.map);
+   tcz->remaining = 0x7FFFFFFF;
+   tcz->stored = true;
+   tcz->tempHeap = heap;
+   tczRead(tcz, &ti, 16);
+   tczMap(tcz, 2 * ti.paramCount + 4); // skip the parameters and the body size
+   xmemzero(&t, sizeof(t));
+   readMethodBody(m->class_->cp, tcz, &t, &ti, heap);
+   xfree(tcz);
+   m->exceptionHandlers = t.exceptionHandlers;
+   m->lineNumberLine = t.lineNumberLine;
+   m->lineNumberStartPC = t.lineNumberStartPC;
+   MEMORY_BARRIER(); // other threads only check the code
+   m->code = t.code;
+   UNLOCKVAR(metAndCls);
+   return true;
+}
+
 static FieldArray readFields(ConstantPool cp, int32 len, TCZFile tcz, FieldArray super, CharP sourceClass) // sourceClass: numeric fields must pass the source class, object fields must pass null
 {
    TFieldInfo ci;
@@ -515,6 +712,52 @@ static FieldArray readFields(ConstantPool cp, int32 len, TCZFile tcz, FieldArray
    return f0;
 }
 
+static volatile int32 interfaceCount;
+
+static void addInterface(TCClass c, TCClass i)
+{
+   int32 j;
+   for (j = c->allInterfacesCount; --j >= 0;)
+      if (c->allInterfaces[j] == i)
+         return;
+   c->allInterfaces[c->allInterfacesCount++] = i;
+   c->interfacesMask |= i->interfaceBit;
+}
+
+static void buildSupertypeDisplay(TCClass c, Heap heap) // computes the structures used by isSubtypeOf
+{
+   TCClass s = c->superClass;
+   int32 i, j, n = s ? s->allInterfacesCount : 0;
+
+   if (c->flags.isInterface)
+   {
+      int32 n;
+      do n = interfaceCount; while (!ATOMIC_CAS32(&interfaceCount, n, n+1)); // classes are read by many threads
+      c->interfaceBit = 1 << (n & 31);
+   }
+   c->depth = s ? s->depth + 1 : 0;
+   c->display = newPtrArrayOf(TCClass, c->depth + 1, heap);
+   if (s)
+      xmemmove(c->display, s->display, c->depth * TSIZE);
+   c->display[c->depth] = c;
+
+   for (i = ARRAYLENV(c->interfaces); --i >= 0;)
+      n += c->interfaces[i]->allInterfacesCount + 1;
+   if (n > 0)
+   {
+      c->allInterfaces = newPtrArrayOf(TCClass, n, heap);
+      for (j = s ? s->allInterfacesCount : 0; --j >= 0;)
+         addInterface(c, s->allInterfaces[j]);
+      for (i = ARRAYLENV(c->interfaces); --i >= 0;)
+      {
+         TCClass t = c->interfaces[i];
+         addInterface(c, t);
+         for (j = t->allInterfacesCount; --j >= 0;)
+            addInterface(c, t->allInterfaces[j]);
+      }
+   }
+}
+
 static TCClass readClass(Context currentContext, ConstantPool cp, TCZFile tcz)
 {
    int32 i, j, superI32, superObj, superV64, totalI32, totalObj, totalV64;
@@ -530,12 +773,9 @@ static TCClass readClass(Context currentContext, ConstantPool cp, TCZFile tcz)
       return !heap || heap->ex.errorCode == HEAP_MEMORY_ERROR ? CLASS_OUT_OF_MEMORY : null;
    }
    heap->greedyAlloc = true;
-
-   IF_HEAP_ERROR(tcz->header->hheap)
-   {
-      heapDestroy(heap);
-      return !heap || heap->ex.errorCode == HEAP_MEMORY_ERROR ? CLASS_OUT_OF_MEMORY : null;
-   }
+   // there's no jump buffer on tcz->header->hheap: it's shared by the threads that read the classes of this tcz in parallel, and
+   // nothing here allocates from it. The header and the constant pool were read by tczOpen, zlib allocates with xmalloc and the
+   // read errors go to tcz->tempHeap, which is the class heap
 
    tczRead(tcz, &ci, 22);
 
@@ -545,21 +785,21 @@ static TCClass readClass(Context currentContext, ConstantPool cp, TCZFile tcz)
    c->name = cp->cls[ci.cpIdxClassName];
    c->flags = ci.flags;
 
-   // read the Interface indexes
+   // read the Interface indexes. The static initializers of the supertypes run when this class is initialized
    if (ci.interfacesCount > 0)
    {
       c->interfaces = newPtrArrayOf(TCClass, ci.interfacesCount, heap);
       for (i = 0; i < ci.interfacesCount; i++)
       {
          u16 = (uint16)tczRead16(tcz);
-         if ((c->interfaces[i] = loadClass(currentContext, cp->cls[u16], true)) == null)
+         if ((c->interfaces[i] = privateLoadClass(currentContext, cp->cls[u16], true, false)) == null)
             HEAP_ERROR(heap, 11);
       }
    }
 
    if (ci.cpIdxSuperClass) // java.lang.Object does not have a superclass
    {
-      c->superClass = loadClass(currentContext, cp->cls[ci.cpIdxSuperClass], true);
+      c->superClass = privateLoadClass(currentContext, cp->cls[ci.cpIdxSuperClass], true, false);
       if (c->superClass == null)
       {
          alert("readClass - Superclass not found: %s",cp->cls[ci.cpIdxSuperClass]); // TODO throw an exception
@@ -636,21 +876,37 @@ static TCClass readClass(Context currentContext, ConstantPool cp, TCZFile tcz)
    if (c->finalizeMethod == null && c->superClass != null) // if no finalize methods are defined in this class, inherit it from the super class
       c->finalizeMethod = c->superClass->finalizeMethod;
    //if (c->dontFinalize == null && c->superClass != null) c->dontFinalize = c->superClass->dontFinalize;
+   buildSupertypeDisplay(c, heap);
    return c;
 }
 
+static bool classNameEquals(VoidP key1, VoidP key2) // the names may use / instead of .
+{
+   CharP a = (CharP)key1, b = (CharP)key2;
+   for (; *a == *b || ((*a == '.' || *a == '/' || *a == '\\') && (*b == '.' || *b == '/' || *b == '\\')); a++, b++)
+      if (*a == 0)
+         return true;
+   return false;
+}
+
 bool initClassInfo()
 {
    SETUP_MUTEX;
    INIT_MUTEX(classLoaderLock);
-   htLoadedClasses = htNew(0xFF,null);
-   htMutexes = htNew(10, null);
-   return true;
+   htLoadedClasses = khNew(0x200, classNameEquals, true); // searched without the lock
+   htLoadingClasses = khNew(0x10, classNameEquals, false);
+   loadedClassesCount = 0;
+   return htLoadedClasses.table != null && htLoadingClasses.table != null;
 }
 
 static void freeClass(int32 i32, VoidP ptr)
 {
    TCClass c = (TCClass)ptr;
+#ifdef ENABLE_JIT
+   int32 i;
+   for (i = ARRAYLENV(c->methods); --i >= 0;)
+      jitFree(&c->methods[i]);
+#endif
    UNUSED(i32);
 #ifdef TRACE_OBJCREATION
    debug("Destroying class %s, alloc count: %d, alloc total: %d, avail: %d, block count: %d",c->name, c->heap->numAlloc, c->heap->totalAlloc, c->heap->totalAvail, c->heap->blocksAlloc);
@@ -661,8 +917,9 @@ static void freeClass(int32 i32, VoidP ptr)
 void destroyClassInfo()
 {
    DESTROY_MUTEX(classLoaderLock);
-   htFree(&htLoadedClasses, freeClass);
-   htFree(&htMutexes, freeMutex);
+   khFree(&htLoadedClasses, freeClass);
+   khFree(&htLoadingClasses, null);
+   destroyMonitors();
 }
 
 static int32 getArrayElementSize(CharP type)
@@ -684,49 +941,24 @@ static int32 getArrayElementSize(CharP type)
    return 2;
 }
 
-TCClass loadClass(Context currentContext, CharP className, bool throwClassNotFound) // do NOT throw error messages from here
+static TCClass readClassFile(Context currentContext, CharP className, int32 hc)
 {
-   volatile TCClass ret;
-   int32 hc;
-   Method staticInitializer = null;
-   // check if we already have loaded it
-   LOCKVAR(classLoaderLock);
-   hc = hashCodeSlash2Dot(className);
-   ret = (TCClass)htGetPtr(&htLoadedClasses, hc);
-   if (ret == null)
+   TCClass ret = null;
+   TCZFile tcz;
+   bool isArray = *className == '[';  // if we're "loading" an array, then load the java.lang.Array instead
+   CharP realClassName = isArray ? "java.lang.Array" : className;
+   tcz = tczGetFile(realClassName, true);
+   if (tcz != null)
    {
-      bool isArray;
-      TCZFile tcz;
-      CharP realClassName = className;
-      // check if we're loading an array and load the correct class instead.
-      isArray = *className == '[';  // if we're "loading" an array, then load the java.lang.Array instead
-      if (isArray)
-         realClassName = "java.lang.Array";
-      tcz = tczGetFile(realClassName, true);
-      if (tcz != null)
-      {
 #ifdef TRACE_OBJCREATION
-         int32 fr = getFreeMemory(false);
-         debug("**** READING CLASS %s", realClassName);
+      int32 fr = getFreeMemory(false);
+      debug("**** READING CLASS %s", realClassName);
 #endif
-         ret = readClass(currentContext, tcz->header->cp, tcz);
-         tczClose(tcz);
+      ret = readClass(currentContext, tcz->header->cp, tcz);
+      tczClose(tcz);
 #ifdef TRACE_OBJCREATION
-         debug("**** putting class %s in hashtable. Consumed: %d ****", realClassName, getFreeMemory(false)-fr);
+      debug("**** putting class %s in hashtable. Consumed: %d ****", realClassName, getFreeMemory(false)-fr);
 #endif
-         // call static initializer
-         if (ret != null && ret != CLASS_OUT_OF_MEMORY)
-         {
-            TCClass ret2 = (TCClass)htGetPtr(&htLoadedClasses, hc); // guich@tc110_92: the class may have a reference to itself, which was loaded in the readClass above. So we double-check for it and use the previous version
-            if (ret2 != null || !htPutPtr(&htLoadedClasses, hc, ret)) // class must be placed in the loaded classes before any method runs because the GC can be triggered and this class' objects may be collected
-            {
-               freeClass(0, ret);
-               ret = ret2;
-            }
-            else
-               staticInitializer = getMethod(ret, false, STATIC_INIT_NAME, 0);
-         }
-      }
       // if was an array, replace the real java file by the given one
       if (ret != null && ret != CLASS_OUT_OF_MEMORY)
       {
@@ -739,18 +971,141 @@ TCClass loadClass(Context currentContext, CharP className, bool throwClassNotFou
          ret->hash = hc;
       }
    }
+   return ret;
+}
+
+static void initializeClass(Context currentContext, TCClass c)
+{
+   if (!c->initialized && ATOMIC_CAS32(&c->initialized, 0, 1)) // only one thread runs it; the others use the class meanwhile, as when it was run at load
+   {
+      Method staticInitializer;
+      int32 i;
+      for (i = 0; i < ARRAYLENV(c->interfaces); i++)
+         initializeClass(currentContext, c->interfaces[i]);
+      if (c->superClass != null)
+         initializeClass(currentContext, c->superClass);
+      recordClassLoad(c);
+      if ((staticInitializer = getMethod(c, false, STATIC_INIT_NAME, 0)) != null)
+         executeMethod(currentContext, staticInitializer);
+   }
+}
+
+static void waitClassRead(Context currentContext, int32 hc) // classLoaderLock must be locked; it's released while waiting
+{
+   Context* prev;
+   bool wasInNative;
+   currentContext->waitingClass = hc;
+   currentContext->nextClassWaiter = classWaiters;
+   classWaiters = currentContext;
+   UNLOCKVAR(classLoaderLock);
+   wasInNative = currentContext->inNative;
+   currentContext->inNative = true; // blocked threads don't hold back an incremental gc cycle
+   threadPermitPark(&currentContext->permit, CLASS_WAIT_MILLIS);
+   currentContext->inNative = wasInNative;
+   MEMORY_BARRIER();
+   LOCKVAR(classLoaderLock);
+   for (prev = &classWaiters; *prev != null; prev = &(*prev)->nextClassWaiter) // timed out: leave the list
+      if (*prev == currentContext)
+      {
+         *prev = currentContext->nextClassWaiter;
+         break;
+      }
+}
+
+static void wakeClassWaiters(int32 hc) // classLoaderLock must be locked
+{
+   Context* prev = &classWaiters;
+   Context c;
+   while ((c = *prev) != null)
+      if (c->waitingClass == hc) // a name with the same hash just checks again
+      {
+         *prev = c->nextClassWaiter;
+         threadPermitUnpark(&c->permit);
+      }
+      else
+         prev = &c->nextClassWaiter;
+}
+
+static TCClass privateLoadClass(Context currentContext, CharP className, bool throwClassNotFound, bool runStaticInitializer) // do NOT throw error messages from here
+{
+   volatile TCClass ret;
+   Context reader = null;
+   bool reading = false;
+   int32 hc = hashCodeSlash2Dot(className);
+   // check if we already have loaded it, without the lock. If it's not there, check again holding it. If another thread is reading it, park until it finishes
+   if ((ret = (TCClass)khGet(&htLoadedClasses, className, hc)) != null)
+      goto loaded;
+   LOCKVAR(classLoaderLock);
+   while ((ret = (TCClass)khGet(&htLoadedClasses, className, hc)) == null && (reader = (Context)khGet(&htLoadingClasses, className, hc)) != null && reader != currentContext)
+      waitClassRead(currentContext, hc);
+   if (ret == null)
+   {
+      // the class is read without holding the lock, so other threads can read other classes meanwhile.
+      // If this thread is already reading it, the class has a reference to itself, which is read again
+      if (reader == null && !(reading = khPut(&htLoadingClasses, className, hc, currentContext)))
+         ret = CLASS_OUT_OF_MEMORY;
+      UNLOCKVAR(classLoaderLock);
+      if (ret == null)
+         ret = readClassFile(currentContext, className, hc);
+      LOCKVAR(classLoaderLock);
+      if (ret != null && ret != CLASS_OUT_OF_MEMORY)
+      {
+         TCClass ret2 = (TCClass)khGet(&htLoadedClasses, className, hc); // guich@tc110_92: the class may have a reference to itself, which was loaded in the readClass above. So we double-check for it and use the previous version
+         bool added;
+         LOCKVAR(omm); // the gc traverses the loaded classes
+         added = ret2 == null && khPut(&htLoadedClasses, ret->name, hc, ret); // class must be placed in the loaded classes before any method runs because the GC can be triggered and this class' objects may be collected
+         UNLOCKVAR(omm);
+         if (!added)
+         {
+            freeClass(0, ret);
+            ret = ret2;
+         }
+         else
+            ret->index = loadedClassesCount++;
+      }
+      if (reading)
+      {
+         khRemove(&htLoadingClasses, className, hc);
+         wakeClassWaiters(hc);
+      }
+   }
    UNLOCKVAR(classLoaderLock);
+loaded:
 
    if (ret == CLASS_OUT_OF_MEMORY)
 	   throwException(currentContext, OutOfMemoryError, className);
    else
    if (ret == null && throwClassNotFound)
       throwException(currentContext, ClassNotFoundException, className);
-   else if (staticInitializer)
-      executeMethod(currentContext, staticInitializer);
+   else if (ret != null && runStaticInitializer)
+      initializeClass(currentContext, ret);
    return ret == CLASS_OUT_OF_MEMORY ? null : ret;
 }
 
+TCClass loadClass(Context currentContext, CharP className, bool throwClassNotFound)
+{
+   return privateLoadClass(currentContext, className, throwClassNotFound, true);
+}
+
+TCClass loadClassWithoutStaticInitializer(Context currentContext, CharP className)
+{
+   TCClass c = privateLoadClass(currentContext, className, false, false);
+   int32 i;
+   if (c != null && ATOMIC_CAS32(&c->initialized, 0, 1)) // the caller runs it
+   {
+      for (i = 0; i < ARRAYLENV(c->interfaces); i++)
+         initializeClass(currentContext, c->interfaces[i]);
+      if (c->superClass != null)
+         initializeClass(currentContext, c->superClass);
+   }
+   return c;
+}
+
+TCClass preloadClass(Context currentContext, CharP className)
+{
+   return privateLoadClass(currentContext, className, false, false);
+}
+
 Type type2javaType(CharP type)
 {
    if (*type == '[')
@@ -787,6 +1142,47 @@ bool isSuperClass(TCClass s, TCClass t) // s instanceof t
    return false;
 }
 
+bool isSubtypeOf(TCClass s, TCClass t) // s instanceof t
+{
+   int32 i;
+   if (!t->flags.isInterface)
+      return t->depth <= s->depth && s->display[t->depth] == t;
+   if (s == t)
+      return true;
+   if ((s->interfacesMask & t->interfaceBit) != 0)
+      for (i = s->allInterfacesCount; --i >= 0;)
+         if (s->allInterfaces[i] == t)
+            return true;
+   return false;
+}
+
+CompatibilityResult isInstanceOf(Context currentContext, TCClass s, ConstantPool cp, int32 sym)
+{
+   CharP ident = cp->cls[sym];
+   TCClass t = cp->boundClass[sym];
+   CompatibilityResult result;
+
+   if (t != null && *s->name != '[')
+   {
+      if (isSubtypeOf(s, t))
+         result = COMPATIBLE;
+      else
+      if (s->flags.isString) // a String is also compatible with Class; let the full check handle it
+         result = areClassesCompatible(currentContext, s, ident);
+      else
+         result = NOT_COMPATIBLE;
+   }
+   else
+   {
+      result = areClassesCompatible(currentContext, s, ident);
+      if (result != TARGET_CLASS_NOT_FOUND && t == null && *ident != '[' && *ident != '&') // bind the class, so the next checks use the display
+         cp->boundClass[sym] = loadClass(currentContext, ident, false);
+   }
+   if (result == COMPATIBLE)
+      cp->instanceOfCache[sym] = s;
+   return result;
+}
+
 CompatibilityResult areClassesCompatible(Context currentContext, TCClass s, CharP ident)  // S instanceof idenT ?
 {
    TCClass t=null;
@@ -896,3 +1292,108 @@ tryAgain:
    }
    return result;
 }
+
+#define DISPATCH_HASH(cp, sym, mask) ((((uint32)(size_t)(cp) >> 4) ^ ((uint32)(sym) * 0x9E3779B1)) & (mask))
+
+Method dispatchLookup(TCClass c, ConstantPool cp, int32 sym)
+{
+   DispatchTable dt = c->dispatch;
+   DispatchEntry e;
+   uint32 i;
+   if (dt == null)
+      return null;
+   for (i = DISPATCH_HASH(cp, sym, dt->mask); (e = dt->entries[i]) != null; i = (i+1) & dt->mask)
+      if (e->cp == cp && e->sym == sym)
+         return e->m;
+   return null;
+}
+
+static bool dispatchInsert(TCClass c, ConstantPool cp, int32 sym, Method m) // metAndCls must be locked
+{
+   DispatchTable dt = c->dispatch, ndt;
+   DispatchEntry e;
+   uint32 i;
+   if (dispatchLookup(c, cp, sym) != null) // another thread already bound it
+      return true;
+   IF_HEAP_ERROR(c->heap)
+      return false;
+   if (dt == null || (dt->count+1)*2 > dt->mask+1) // create or grow the table
+   {
+      uint32 size = dt == null ? 16 : (dt->mask+1)*2, j;
+      ndt = (DispatchTable)heapAlloc(c->heap, sizeof(TDispatchTable) + (size-1) * TSIZE);
+      ndt->mask = size-1;
+      if (dt != null)
+         for (j = 0; j <= dt->mask; j++)
+            if ((e = dt->entries[j]) != null)
+            {
+               for (i = DISPATCH_HASH(e->cp, e->sym, ndt->mask); ndt->entries[i] != null; i = (i+1) & ndt->mask) {}
+               ndt->entries[i] = e;
+               ndt->count++;
+            }
+      MEMORY_BARRIER();
+      c->dispatch = dt = ndt;
+   }
+   e = newXH(DispatchEntry, c->heap);
+   e->cp = cp;
+   e->sym = sym;
+   e->m = m;
+   dt->count++;
+   for (i = DISPATCH_HASH(cp, sym, dt->mask); dt->entries[i] != null; i = (i+1) & dt->mask) {}
+   MEMORY_BARRIER();
+   dt->entries[i] = e;
+   return true;
+}
+
+bool bindVirtualMethod(Method caller, Code call, TCClass c, Method m)
+{
+   ConstantPool cp = caller->class_->cp;
+   InlineCachePtrArray callSites;
+   InlineCache ic;
+   MethodAndClass mac;
+   int32 sym = call->mtd.sym, site = (int32)(call - caller->code);
+   bool ret = true;
+   int32 i;
+
+   LOCKVAR(metAndCls);
+   IF_HEAP_ERROR(cp->heap)
+   {
+      ret = false;
+      goto end;
+   }
+   if ((callSites = caller->callSites) == null) // one entry per instruction, but only the calls use theirs
+   {
+      callSites = (InlineCachePtrArray)newArray(TSIZE, ARRAYLENV(caller->code), cp->heap);
+      MEMORY_BARRIER();
+      caller->callSites = callSites;
+   }
+   if ((ic = callSites[site]) == null)
+   {
+      ic = newXH(InlineCache, cp->heap);
+      MEMORY_BARRIER();
+      callSites[site] = ic;
+   }
+   if (!ic->megamorphic)
+   {
+      for (i = 0; i < INLINE_CACHE_SIZE && ic->entries[i] != null; i++)
+         if (ic->entries[i]->c == c) // another thread already bound it
+            goto end;
+      if (i < INLINE_CACHE_SIZE)
+      {
+         mac = newXH(MethodAndClass, cp->heap);
+         mac->c = c;
+         mac->m = m;
+         MEMORY_BARRIER();
+         ic->entries[i] = mac;
+         goto end;
+      }
+      ic->megamorphic = true;
+   }
+   ret = dispatchInsert(c, cp, sym, m);
+end:
+   UNLOCKVAR(metAndCls);
+   return ret;
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "tcclass_test.h"
+#endif
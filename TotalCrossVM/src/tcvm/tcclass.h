@@ -130,6 +130,9 @@ typedef TTCClass* TCClass;
 typedef TCClass* TCClassArray;
 typedef TCClass* TCClassPtrArray;
 
+typedef struct TJitCode TJitCode;
+typedef TJitCode* JitCode;
+
 typedef struct TException TException;
 typedef TException* Exception;
 typedef TException* ExceptionArray;
@@ -378,14 +381,48 @@ typedef struct
 /// Definition of a NativeMethod: returns void and receives a NMParams structure.
 typedef void (*NativeMethod) (NMParams p);
 
-/** Used to find the method reference on a virtual method call. */
-typedef struct METHOD_AND_CLASS // guich@tc110_67: create a linked list of bound methods
+/** Used to find the method reference on a virtual method call. Never changed after being published in a cache. */
+typedef struct METHOD_AND_CLASS // guich@tc110_67
 {
    TCClass c; // in
    Method m; // out
-   struct METHOD_AND_CLASS* next;
 } TMethodAndClass, *MethodAndClass;
-typedef MethodAndClass** MethodAndClassPtrArray;
+
+#define INLINE_CACHE_SIZE 4
+
+/** Inline cache of a virtual (or interface) call site: the classes of the instances seen
+ * by that instruction, and the methods bound to each one. Call sites that share a symbol
+ * have caches of their own, so they don't evict each other's classes. The entries are filled
+ * in order and published after a memory barrier, so the interpreter reads them without locks.
+ * When more classes than the cache holds are seen, the call site becomes megamorphic and the
+ * new classes are dispatched through their dispatch table.
+ */
+typedef struct
+{
+   MethodAndClass entries[INLINE_CACHE_SIZE];
+   bool megamorphic;
+} TInlineCache, *InlineCache;
+typedef InlineCache* InlineCachePtrArray;
+
+/** An entry of a class' dispatch table: the method that a symbol of a constant pool is bound to. */
+typedef struct
+{
+   ConstantPool cp;
+   int32 sym;
+   Method m;
+} TDispatchEntry, *DispatchEntry;
+
+/** The dispatch table of a class, used by megamorphic and interface calls. Methods are bound by
+ * name, so instead of indexes it is an open addressing hash keyed by the calling symbol. When
+ * half full, a copy with twice the size replaces it; the old copy is kept in the class' heap,
+ * because another thread may be reading it.
+ */
+typedef struct
+{
+   uint32 mask;
+   uint32 count;
+   DispatchEntry entries[1];
+} TDispatchTable, *DispatchTable;
 
 /** This is the constant pool (CP) loaded from a file. A CP may be related
  * to a single file or to a set of files.
@@ -408,7 +445,8 @@ struct TConstantPool
    UInt16Array boundIField;
    VoidPArray boundSField;  // will store a pointer directly to the static field inside the class
    MethodPtrArray boundNormal;
-   MethodAndClassPtrArray boundVirtualMethod;
+   TCClassPtrArray boundClass; // the classes of cls, bound by instanceof/checkcast (arrays are never bound)
+   TCClassPtrArray instanceOfCache; // the last class found compatible with each cls in instanceof/checkcast
 
    uint16 i32Count;
    uint16 i64Count;
@@ -501,11 +539,23 @@ struct TTCClass
    Method finalizeMethod;
    // If present and true, don't call finalize
    uint16 dontFinalizeFieldIndex;
-   // Index in the vLoadedClasses array
+   // The order in which the class was loaded; see loadedClassesCount
    uint32 index;
    uint32 hash;
    // Used in reflection
    TCObject classObj;
+   // Methods bound by megamorphic and interface calls
+   DispatchTable dispatch;
+   // The supertype display, used in instanceof/checkcast: display[depth] is this class and display[i] is its superclass with depth i
+   TCClassArray display;
+   uint16 depth;
+   // All interfaces implemented by this class, its superclasses and their superinterfaces
+   uint16 allInterfacesCount;
+   TCClassArray allInterfaces;
+   // A bit that identifies this interface, and the bits of all interfaces above, to quickly reject an interface that is not implemented
+   uint32 interfaceBit, interfacesMask;
+   // Set by the thread that runs the static initializer; a class preloaded in background is loaded but not yet initialized
+   volatile int32 initialized;
 };
 
 /** Structure representing a method of a class. */
@@ -538,6 +588,12 @@ struct TMethod
    CharP nativeSignature; // 0x3C
    NativeMethod boundNM; // 0x40
    uint32 ref; // library reference
+   JitCode jit; // native code generated by the jit, if any
+   int32 hotness; // number of calls, until it reaches JIT_THRESHOLD
+   // In a prelinked tcz, where the method starts inside the mapped file while its code, exception handlers and line numbers were not read yet
+   uint8* body;
+   // The inline caches of the virtual and interface calls, indexed by the instruction; created when the first call is bound
+   InlineCachePtrArray callSites;
 };
 
 /** This structure represents a Java int, double, long and TCObject class field. */
@@ -612,6 +668,17 @@ int32 getIndexInCP(ConstantPool cp, CharP s);
 /// Loads the given class name, throwing a ClassNotFoundException if desired.
 TC_API TCClass loadClass(Context currentContext, CharP className, bool throwClassNotFound);
 typedef TCClass (*loadClassFunc)(Context currentContext, CharP className, bool throwClassNotFound);
+/// Loads the given class without running its static initializer, which must then be run by the caller, if needed.
+/// The superclass and the interfaces are loaded as usual. Used when restoring the startup snapshot.
+TCClass loadClassWithoutStaticInitializer(Context currentContext, CharP className);
+/// Loads the given class, its superclass and interfaces without running any static initializer; they are run when the
+/// class is loaded again by loadClass. Used by the threads that preload the classes of the load profile.
+TCClass preloadClass(Context currentContext, CharP className);
+
+/// Reads the code, exception handlers and line numbers of a method of a prelinked tcz, which are read only when the method is
+/// called for the first time. Returns false if there's no memory. Like every allocation in a class heap after the class is loaded,
+/// the body is read with metAndCls locked.
+bool loadMethodBody(Method m);
 
 bool initClassInfo();
 void destroyClassInfo();
@@ -625,8 +692,17 @@ typedef CompatibilityResult (*areClassesCompatibleFunc)(Context currentContext,
 /// Checks if the methods have the same parameters
 bool paramsEq(ConstantPool cp1, UInt16Array params1, int32 n1, ConstantPool cp2, UInt16Array params2);
 
+/// Binds the method called by the virtual or interface call instruction of caller when the instance is of class c. Returns false if there's no memory
+bool bindVirtualMethod(Method caller, Code call, TCClass c, Method m);
+/// Returns the method bound to the given symbol in the dispatch table of class c, or null. Does not lock
+Method dispatchLookup(TCClass c, ConstantPool cp, int32 sym);
+
 Type type2javaType(CharP type);
 bool isSuperClass(TCClass s, TCClass t);
+/// Returns true if s is t, a subclass of t or implements t, using the supertype display. The classes must not be arrays
+bool isSubtypeOf(TCClass s, TCClass t);
+/// Checks if an instance of class s is compatible with the class of the given cls symbol, binding it to the constant pool on the first call
+CompatibilityResult isInstanceOf(Context currentContext, TCClass s, ConstantPool cp, int32 sym);
 
 #define CLASS_OUT_OF_MEMORY ((TCClass)-1)
 
@@ -0,0 +1,435 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#define LAZY_TEST_THREADS 4
+#define LAZY_TEST_METHODS 32
+#define LAZY_TEST_SYMS 256
+
+static TConstantPool lazyTestCP; // only a key of the dispatch entries
+
+typedef struct
+{
+   TCClass c;
+   Method methods[LAZY_TEST_METHODS];
+   Code seen[LAZY_TEST_THREADS][LAZY_TEST_METHODS];
+   int32 count;
+   volatile int32 failed;
+} TLazyBodyTest;
+
+static void lazyTestRun(int32 index, VoidP arg) // reads the bodies while the dispatch table of the same class grows
+{
+   TLazyBodyTest* t = (TLazyBodyTest*)arg;
+   int32 i;
+   if (index == 0 || (index & 1) == 0)
+      for (i = 0; i < t->count; i++)
+      {
+         if (loadMethodBody(t->methods[i]))
+            t->seen[index][i] = t->methods[i]->code;
+         else
+            t->failed = 1;
+      }
+   if (index == 0 || (index & 1) == 1)
+      for (i = 1; i <= LAZY_TEST_SYMS; i++)
+      {
+         LOCKVAR(metAndCls);
+         if (!dispatchInsert(t->c, &lazyTestCP, i, t->methods[i % t->count]))
+            t->failed = 1;
+         UNLOCKVAR(metAndCls);
+      }
+}
+
+TESTCASE(Class_LazyMethodBody)
+{
+   static TLazyBodyTest t;
+   DispatchTable dispatch;
+   Method m;
+   int32 i, j, n;
+
+   xmemzero(&t, sizeof(t));
+   // a class of a prelinked tcz with several methods whose bodies were not read yet
+   for (i = 0; i <= (int32)htLoadedClasses.table->mask && t.count < 2; i++)
+      if ((t.c = (TCClass)htLoadedClasses.table->items[i].value) != null)
+         for (t.count = 0, j = 0, n = ARRAYLENV(t.c->methods); j < n && t.count < LAZY_TEST_METHODS; j++)
+            if ((m = &t.c->methods[j])->body != null && m->code == null)
+               t.methods[t.count++] = m;
+   if (t.count < 2)
+      TEST_CANNOT_RUN;
+   dispatch = t.c->dispatch;
+
+   threadRunParallel(LAZY_TEST_THREADS, lazyTestRun, &t);
+   ASSERT2_EQUALS(I32, t.failed, 0);
+   for (i = 0; i < t.count; i++)
+   {
+      ASSERT1_EQUALS(NotNull, t.methods[i]->code);
+      for (j = 0; j < LAZY_TEST_THREADS; j++)
+         if (t.seen[j][i] != null) // the body is read once, and all threads see the same code
+            ASSERT2_EQUALS(Ptr, t.seen[j][i], t.methods[i]->code);
+      // a loaded body is not read again
+      ASSERT1_EQUALS(True, loadMethodBody(t.methods[i]));
+      ASSERT2_EQUALS(Ptr, t.seen[0][i], t.methods[i]->code);
+   }
+   // and the class heap was not corrupted by the dispatch table growing at the same time
+   for (i = 1; i <= LAZY_TEST_SYMS; i++)
+      ASSERT2_EQUALS(Ptr, dispatchLookup(t.c, &lazyTestCP, i), t.methods[i % t.count]);
+finish:
+   if (t.c != null && t.count >= 2)
+      t.c->dispatch = dispatch; // the test entries are left in the heap, but are no longer reachable
+}
+
+#define LOADING_TEST_CLASS "tc.test.NotAClass"
+
+typedef struct
+{
+   Context reader, waiter;
+   volatile TCClass loaded;
+   volatile int32 done;
+} TLoadingTest;
+
+static void loadingTestWait(int32 index, VoidP arg)
+{
+   TLoadingTest* t = (TLoadingTest*)arg;
+   if (index == 1)
+   {
+      t->loaded = loadClass(t->waiter, LOADING_TEST_CLASS, false);
+      t->done = 1;
+   }
+}
+
+static bool isClassWaiter(Context c)
+{
+   Context w;
+   bool found = false;
+   LOCKVAR(classLoaderLock);
+   for (w = classWaiters; w != null && !found; w = w->nextClassWaiter)
+      found = w == c;
+   UNLOCKVAR(classLoaderLock);
+   return found;
+}
+
+TESTCASE(Class_LoadingStates)
+{
+   TLoadingTest t;
+   TParallelThreads threads;
+   TTCClass copy;
+   int32 hc = hashCodeSlash2Dot(LOADING_TEST_CLASS), i, doneEarly;
+   bool parked = false, marked = false;
+
+   xmemzero(&t, sizeof(t));
+   t.reader = newContext(null, null, false);
+   t.waiter = newContext(null, null, false);
+   ASSERT1_EQUALS(NotNull, t.reader);
+   ASSERT1_EQUALS(NotNull, t.waiter);
+   // 1. a thread that needs a class being read by another one parks until the reader finishes
+   LOCKVAR(classLoaderLock);
+   marked = khPut(&htLoadingClasses, LOADING_TEST_CLASS, hc, t.reader);
+   UNLOCKVAR(classLoaderLock);
+   ASSERT1_EQUALS(True, marked);
+   threadStartParallel(&threads, 2, loadingTestWait, &t);
+   if (!threads.created[1])
+   {
+      threadJoinParallel(&threads);
+      TEST_CANNOT_RUN;
+   }
+   for (i = 0; i < 5000 && !(parked = isClassWaiter(t.waiter)); i++)
+      Sleep(1);
+   Sleep(CLASS_WAIT_MILLIS * 2); // it checks again after each timeout, but keeps waiting
+   doneEarly = t.done;
+   LOCKVAR(classLoaderLock); // the reader finishes without finding it
+   khRemove(&htLoadingClasses, LOADING_TEST_CLASS, hc);
+   wakeClassWaiters(hc);
+   marked = false;
+   UNLOCKVAR(classLoaderLock);
+   threadJoinParallel(&threads);
+   ASSERT1_EQUALS(True, parked);
+   ASSERT2_EQUALS(I32, doneEarly, 0);
+   ASSERT2_EQUALS(I32, t.done, 1);
+   ASSERT1_EQUALS(Null, t.loaded); // then it looks for the class itself
+   ASSERT1_EQUALS(False, isClassWaiter(t.waiter));
+   ASSERT1_EQUALS(Null, khGet(&htLoadingClasses, LOADING_TEST_CLASS, hc));
+   ASSERT1_EQUALS(Null, khGet(&htLoadedClasses, LOADING_TEST_CLASS, hc));
+   t.waiter->thrownException = null;
+
+   // 2. a loaded class is initialized only once, after its supertypes
+   copy = *OBJ_CLASS(currentContext->OutOfMemoryErrorObj);
+   copy.name = "[tc.test.Copy"; // keeps it out of the load profile
+   copy.methods = null;
+   copy.interfaces = null;
+   copy.initialized = 0;
+   initializeClass(currentContext, &copy);
+   ASSERT2_EQUALS(I32, copy.initialized, 1);
+   ASSERT2_EQUALS(I32, copy.superClass->initialized, 1);
+   initializeClass(currentContext, &copy);
+   ASSERT2_EQUALS(I32, copy.initialized, 1);
+finish:
+   if (marked)
+   {
+      LOCKVAR(classLoaderLock);
+      khRemove(&htLoadingClasses, LOADING_TEST_CLASS, hc);
+      UNLOCKVAR(classLoaderLock);
+   }
+   if (t.reader != null)
+      deleteContext(t.reader, false);
+   if (t.waiter != null)
+      deleteContext(t.waiter, false);
+}
+
+// a constant pool written in the compressed and in the prelinked layouts
+#define CP_TEST_FILE "tc_prelinked_test.tcz"
+
+typedef struct
+{
+   uint8 buf[512];
+   int32 pos;
+} TCPTestBuf;
+
+static void cpTestPut(TCPTestBuf* b, const void* v, int32 n)
+{
+   xmemmove(b->buf + b->pos, v, n);
+   b->pos += n;
+}
+
+static void cpTestPut32(TCPTestBuf* b, int32 v) {cpTestPut(b, &v, 4);}
+static void cpTestPut16(TCPTestBuf* b, int32 v) {uint16 s = (uint16)v; cpTestPut(b, &s, 2);}
+static void cpTestAlign(TCPTestBuf* b, int32 n) {while (b->pos & (n-1)) b->buf[b->pos++] = 0;}
+static void cpTestLength(TCPTestBuf* b, int32 count) {cpTestAlign(b, 8); cpTestPut32(b, count); cpTestPut32(b, count);}
+
+static int32 cpTestI32[] = {0, 12345, -7};
+static int64 cpTestI64[] = {0, 0x123456789ABLL};
+static double cpTestDbl[] = {0, 3.5};
+static uint16 cpTestSField[] = {0, 1, 2}, cpTestSClass[] = {0, 2, 1};
+static uint16 cpTestIField[] = {0, 2}, cpTestIClass[] = {0, 2};
+static uint16 cpTestMtd1[] = {1, 1}, cpTestMtd2[] = {2, 2, 1}; // class, name, parameters
+static CharP cpTestMtdFld[] = {"", "foo", "bar"};
+static CharP cpTestCls[] = {"", "java.lang.Object", "tc.test.Prelinked"};
+
+static void cpTestNames(TCPTestBuf* b, CharP* names, int32 count, bool prelinked)
+{
+   int32 i, size = 0;
+   for (i = 1; i < count; i++)
+      size += xstrlen(names[i]) + (prelinked ? 2 : 1);
+   if (prelinked)
+      cpTestAlign(b, 4);
+   cpTestPut32(b, size);
+   for (i = 1; i < count; i++)
+   {
+      b->buf[b->pos++] = (uint8)xstrlen(names[i]);
+      cpTestPut(b, names[i], xstrlen(names[i]));
+      if (prelinked)
+         b->buf[b->pos++] = 0;
+   }
+}
+
+static void cpTestWrite(TCPTestBuf* b, bool prelinked)
+{
+   int32 i;
+   uint8 lens[] = {0, 0, 1};
+   b->pos = 0;
+   cpTestPut16(b, 3); cpTestPut16(b, 2); cpTestPut16(b, 2); cpTestPut16(b, 3); cpTestPut16(b, 3); // i32, i64, dbl, cls, sfield
+   cpTestPut16(b, 2); cpTestPut16(b, 3); cpTestPut16(b, 3); cpTestPut16(b, 0);                     // ifield, mtd, mtdfld, str
+   if (prelinked) // the arrays are aligned and preceded by their length, and include the first element
+   {
+      cpTestLength(b, 3); cpTestPut(b, cpTestI32, sizeof(cpTestI32));
+      cpTestLength(b, 2); cpTestPut(b, cpTestI64, sizeof(cpTestI64));
+      cpTestLength(b, 2); cpTestPut(b, cpTestDbl, sizeof(cpTestDbl));
+      cpTestLength(b, 3); cpTestPut(b, cpTestSField, sizeof(cpTestSField));
+      cpTestLength(b, 3); cpTestPut(b, cpTestSClass, sizeof(cpTestSClass));
+      cpTestLength(b, 2); cpTestPut(b, cpTestIField, sizeof(cpTestIField));
+      cpTestLength(b, 2); cpTestPut(b, cpTestIClass, sizeof(cpTestIClass));
+      cpTestLength(b, 3); cpTestPut(b, lens, 3);
+      cpTestAlign(b, 4);
+   }
+   else // the first element is not written, and the fields are delta encoded
+   {
+      cpTestPut(b, cpTestI32+1, sizeof(cpTestI32)-4);
+      cpTestPut(b, cpTestI64+1, sizeof(cpTestI64)-8);
+      cpTestPut(b, cpTestDbl+1, sizeof(cpTestDbl)-8);
+      for (i = 1; i < 3; i++) cpTestPut16(b, cpTestSField[i] - cpTestSField[i-1]);
+      cpTestPut(b, cpTestSClass+1, 4);
+      cpTestPut16(b, cpTestIField[1]);
+      cpTestPut(b, cpTestIClass+1, 2);
+      cpTestPut(b, lens+1, 2);
+   }
+   cpTestPut32(b, sizeof(cpTestMtd1) + sizeof(cpTestMtd2));
+   cpTestPut(b, cpTestMtd1, sizeof(cpTestMtd1));
+   cpTestPut(b, cpTestMtd2, sizeof(cpTestMtd2));
+   cpTestNames(b, cpTestMtdFld, 3, prelinked);
+   cpTestNames(b, cpTestCls, 3, prelinked);
+}
+
+static bool cpTestWriteTCZ(CharP path, TCPTestBuf* cp, bool prelinked, int32 sizeDelta, int32 truncate) // sizeDelta changes the stored uncompressed size; truncate removes bytes from the end
+{
+   uint8 header[64], packed[600], zeros[8] = {0};
+   uLongf headerLen = sizeof(header), chunkLen = sizeof(packed);
+   TCPTestBuf h;
+   int32 baseOffset, chunkEnd;
+   int16 version = TCZ_VERSION, attr = prelinked ? ATTR_PRELINKED : 0;
+   FILE* f;
+   if (prelinked)
+      xmemmove(packed, cp->buf, chunkLen = cp->pos);
+   else
+   if (compress(packed, &chunkLen, cp->buf, cp->pos) != Z_OK)
+      return false;
+   chunkEnd = prelinked ? ((int32)chunkLen + 7) & ~7 : (int32)chunkLen;
+   h.pos = 0;
+   cpTestPut32(&h, 1);                  // names
+   cpTestPut32(&h, 0);                  // offsets
+   cpTestPut32(&h, chunkEnd);
+   cpTestPut32(&h, cp->pos + sizeDelta); // uncompressed sizes
+   h.buf[h.pos++] = 12;
+   cpTestPut(&h, "ConstantPool", 12);
+   if (compress(header, &headerLen, h.buf, h.pos) != Z_OK || (f = fopen(path, "wb")) == null)
+      return false;
+   baseOffset = 8 + (int32)headerLen;
+   if (prelinked)
+      baseOffset = (baseOffset + 7) & ~7;
+   fwrite(&version, 1, 2, f);
+   fwrite(&attr, 1, 2, f);
+   fwrite(&baseOffset, 1, 4, f);
+   fwrite(header, 1, headerLen, f);
+   fwrite(zeros, 1, baseOffset - 8 - headerLen, f);
+   fwrite(packed, 1, chunkLen - truncate, f);
+   if (truncate == 0)
+      fwrite(zeros, 1, chunkEnd - chunkLen, f);
+   fclose(f);
+   return true;
+}
+
+static TCZFile cpTestOpen(CharP path)
+{
+   FILE* f = fopen(path, "rb");
+   return f == null ? null : tczOpen(f, null); // the file is closed with the tcz
+}
+
+static int32 cpTestRead(Context currentContext, TCZFile t, ConstantPool cp) // returns the heap error, or 0 if the constant pool was read
+{
+   volatile TCZFile t2 = tczFindName(t, "ConstantPool");
+   volatile Heap heap = heapCreate();
+   int32 err;
+   xmemzero(cp, sizeof(TConstantPool));
+   if (t2 == null || heap == null)
+   {
+      tczClose(t2);
+      heapDestroy(heap);
+      return -1;
+   }
+   IF_HEAP_ERROR(heap)
+   {
+      err = heap->ex.errorCode;
+      heapDestroy(heap);
+      tczClose(t2);
+      return err;
+   }
+   readConstantPool(currentContext, cp, t2, heap);
+   tczClose(t2);
+   return 0;
+}
+
+static bool cpTestEquals(ConstantPool a, ConstantPool b)
+{
+   int32 i;
+   if (a->i32Count != b->i32Count || a->mtdCount != b->mtdCount || a->clsCount != b->clsCount || a->mtdfldCount != b->mtdfldCount ||
+       ARRAYLEN(a->i32) != ARRAYLEN(b->i32) || ARRAYLEN(a->mtd) != ARRAYLEN(b->mtd) || ARRAYLEN(a->cls) != ARRAYLEN(b->cls) ||
+       xmemcmp(a->i32+1, b->i32+1, 4 * (a->i32Count-1)) != 0 || xmemcmp(a->i64+1, b->i64+1, 8 * (a->i64Count-1)) != 0 ||
+       xmemcmp(a->dbl+1, b->dbl+1, 8 * (a->dblCount-1)) != 0 ||
+       xmemcmp(a->sfieldField+1, b->sfieldField+1, 2 * (a->sfieldCount-1)) != 0 || xmemcmp(a->sfieldClass+1, b->sfieldClass+1, 2 * (a->sfieldCount-1)) != 0 ||
+       xmemcmp(a->ifieldField+1, b->ifieldField+1, 2 * (a->ifieldCount-1)) != 0 || xmemcmp(a->ifieldClass+1, b->ifieldClass+1, 2 * (a->ifieldCount-1)) != 0 ||
+       xmemcmp(a->mtdLens+1, b->mtdLens+1, a->mtdCount-1) != 0 ||
+       xmemcmp(a->hashNames+1, b->hashNames+1, 4 * (a->mtdCount-1)) != 0 || xmemcmp(a->hashParams+1, b->hashParams+1, 4 * (a->mtdCount-1)) != 0)
+      return false;
+   for (i = 1; i < a->mtdCount; i++)
+      if (xmemcmp(a->mtd[i], b->mtd[i], 2 * (a->mtdLens[i] + 2)) != 0)
+         return false;
+   for (i = 1; i < a->mtdfldCount; i++)
+      if (!strEq(a->mtdfld[i], b->mtdfld[i]))
+         return false;
+   for (i = 1; i < a->clsCount; i++)
+      if (!strEq(a->cls[i], b->cls[i]))
+         return false;
+   return true;
+}
+
+TESTCASE(Class_PrelinkedTCZ)
+{
+   char path[MAX_PATHNAME];
+   TCPTestBuf legacy, prelinked;
+   TConstantPool read, mapped, copied;
+   TCZFile t = null;
+   uint8* map;
+   bool hasRead = false, hasMapped = false, hasCopied = false;
+
+   xstrprintf(path, "%s/%s", appPath, CP_TEST_FILE);
+   cpTestWrite(&legacy, false);
+   cpTestWrite(&prelinked, true);
+   // 1. the compressed layout is read as usual
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &legacy, false, 0, 0));
+   ASSERT1_EQUALS(NotNull, t = cpTestOpen(path));
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &read), 0);
+   hasRead = true;
+   ASSERT2_EQUALS(I32, read.i32[1], 12345);
+   ASSERT2_EQUALS(I32, read.sfieldField[2], 2);
+   ASSERT1_EQUALS(True, strEq(read.cls[2], "tc.test.Prelinked"));
+   tczClose(t);
+   t = null;
+   // 2. the prelinked layout is used in place from the mapping, with the same contents
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &prelinked, true, 0, 0));
+   ASSERT1_EQUALS(NotNull, t = cpTestOpen(path));
+   if ((map = t->header->map) == null)
+      TEST_CANNOT_RUN;
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &mapped), 0);
+   hasMapped = true;
+   ASSERT1_EQUALS(True, cpTestEquals(&read, &mapped));
+   ASSERT1_EQUALS(True, (uint8*)mapped.i32 > map && (uint8*)mapped.i32 < map + t->header->mapSize);
+   ASSERT1_EQUALS(True, (uint8*)mapped.cls[1] > map && (uint8*)mapped.cls[1] < map + t->header->mapSize);
+   // 3. and copied when the file is not mapped
+   t->header->map = null;
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &copied), 0);
+   hasCopied = true;
+   t->header->map = map;
+   ASSERT1_EQUALS(True, cpTestEquals(&read, &copied));
+   ASSERT1_EQUALS(True, (uint8*)copied.i32 < map || (uint8*)copied.i32 >= map + t->header->mapSize);
+   heapDestroy(mapped.heap);
+   heapDestroy(copied.heap);
+   hasMapped = hasCopied = false;
+   tczClose(t);
+   t = null;
+   // 4. a truncated file is rejected
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &prelinked, true, 0, 5));
+   ASSERT1_EQUALS(Null, t = cpTestOpen(path));
+   // 5. so is a chunk that doesn't fit before the next one
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &prelinked, true, 8, 0));
+   ASSERT1_EQUALS(Null, t = cpTestOpen(path));
+   // 6. a chunk shorter than its contents is rejected by the constant pool, mapped or not
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &prelinked, true, -4, 0));
+   ASSERT1_EQUALS(NotNull, t = cpTestOpen(path));
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &mapped), HEAP_ZIP_ERROR);
+   map = t->header->map;
+   t->header->map = null;
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &copied), HEAP_ZIP_ERROR);
+   t->header->map = map;
+   tczClose(t);
+   t = null;
+   // 7. so is an array whose length doesn't match the count
+   prelinked.buf[28]++; // the second copy of the length of the i32 array
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &prelinked, true, 0, 0));
+   ASSERT1_EQUALS(NotNull, t = cpTestOpen(path));
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &mapped), HEAP_ZIP_ERROR);
+   tczClose(t);
+   t = null;
+   // 8. and a name that is not terminated inside its part
+   prelinked.buf[28]--;
+   prelinked.buf[prelinked.pos-1] = 'x';
+   ASSERT1_EQUALS(True, cpTestWriteTCZ(path, &prelinked, true, 0, 0));
+   ASSERT1_EQUALS(NotNull, t = cpTestOpen(path));
+   ASSERT2_EQUALS(I32, cpTestRead(currentContext, t, &mapped), HEAP_ZIP_ERROR);
+finish:
+   if (hasMapped)
+      heapDestroy(mapped.heap);
+   if (hasCopied)
+      heapDestroy(copied.heap);
+   if (hasRead)
+      heapDestroy(read.heap);
+   tczClose(t);
+   remove(path);
+}
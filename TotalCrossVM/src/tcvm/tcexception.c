@@ -37,6 +37,7 @@ TC_API void throwException(Context currentContext, Throwable t, CharP message, .
       vsprintf(currentContext->exmsg, message, args);
       va_end(args);
       *Throwable_msg(exception) = createStringObjectFromCharP(currentContext, currentContext->exmsg,-1);
+      WRITE_BARRIER(exception, *Throwable_msg(exception));
       setObjectLock(*Throwable_msg(exception), UNLOCKED);
    }
    fillStackTrace(currentContext, exception, -1, currentContext->callStack);
@@ -74,6 +75,7 @@ TC_API TCObject createException(Context currentContext, Throwable t, bool fillSt
       vsprintf(currentContext->exmsg, message, args);
       va_end(args);
       *Throwable_msg(exception) = createStringObjectFromCharP(currentContext, currentContext->exmsg,-1);
+      WRITE_BARRIER(exception, *Throwable_msg(exception));
       setObjectLock(*Throwable_msg(exception), UNLOCKED);
    }
    if (fillStack) fillStackTrace(currentContext, exception, -1, currentContext->callStack);
@@ -109,6 +111,7 @@ TC_API void throwExceptionNamed(Context currentContext, CharP exceptionClassName
       vsprintf(currentContext->exmsg, message, args);
       va_end(args);
       *Throwable_msg(exception) = createStringObjectFromCharP(currentContext, currentContext->exmsg,-1);
+      WRITE_BARRIER(exception, *Throwable_msg(exception));
       setObjectLock(*Throwable_msg(exception), UNLOCKED);
    }
    fillStackTrace(currentContext, exception, -1, currentContext->callStack);
@@ -274,7 +277,7 @@ void showUnhandledException(Context context, bool useAlert)
    o = *Throwable_msg(thrownException);
    if (o) msg = String2CharP(o);
    o = *Throwable_trace(thrownException);
-   if (o && String_charsStart(o))
+   if (o)
       throwableTrace = String2CharP(o);
 #ifndef ANDROID // this is already done in Android
    printf("Unhandled exception:\n%s:\n %s\n\nStack trace:\n%s\nAborting %s.", OBJ_CLASS(thrownException)->name, msg==null?"":msg, throwableTrace==null?"":throwableTrace,useAlert?"program":"thread"); // always dump to the console
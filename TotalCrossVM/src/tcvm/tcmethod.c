@@ -32,7 +32,7 @@ TC_API Method getMethod(TCClass c, bool searchSuperclasses, CharP methodName, in
                }
             }
             va_end(params);
-            if (found && (mm->code || mm->flags.isNative)) // not an abstract class?
+            if (found && (mm->code || mm->body || mm->flags.isNative)) // not an abstract class?
                return mm;
          }
       }
@@ -53,6 +53,7 @@ void threadCreateJava(Context currentContext, TCObject this_)
    TCObject a;
    setObjectLock(this_,LOCKED); // prevent the java.lang.Thread object from being collected, because another thread may collect it before the thread is started
    a = Thread_taskID(this_) = createByteArray(currentContext, sizeof(TThreadArgs));
+   WRITE_BARRIER(this_, a);
    if (a != null)
    {
       ThreadHandle h;
@@ -69,6 +70,66 @@ void threadDestroy(ThreadHandle h, bool threadDestroyingItself)
    privateThreadDestroy(h,threadDestroyingItself);
 }
 
+void threadPermitInit(TThreadPermit* p)
+{
+   privateThreadPermitInit(p);
+}
+
+void threadPermitDestroy(TThreadPermit* p)
+{
+   privateThreadPermitDestroy(p);
+}
+
+bool threadPermitPark(TThreadPermit* p, int32 millis)
+{
+   return privateThreadPermitPark(p, millis);
+}
+
+void threadPermitUnpark(TThreadPermit* p)
+{
+   privateThreadPermitUnpark(p);
+}
+
+void threadStartParallel(TParallelThreads* t, int32 n, ParallelFunc f, VoidP arg)
+{
+   int32 i;
+   if (n > MAX_PARALLEL_THREADS)
+      n = MAX_PARALLEL_THREADS;
+   t->count = n;
+   for (i = 1; i < n; i++)
+   {
+      t->args[i].f = f;
+      t->args[i].arg = arg;
+      t->args[i].index = i;
+      t->created[i] = privateParallelThreadCreate(&t->h[i], &t->args[i]);
+   }
+}
+
+void threadJoinParallel(TParallelThreads* t)
+{
+   int32 i;
+   for (i = 1; i < t->count; i++)
+      if (t->created[i])
+         privateParallelThreadJoin(t->h[i]);
+   t->count = 0;
+}
+
+void threadRunParallel(int32 n, ParallelFunc f, VoidP arg)
+{
+   TParallelThreads t;
+   threadStartParallel(&t, n, f, arg);
+   f(0, arg);
+   threadJoinParallel(&t);
+}
+
+int32 threadGetProcessorCount()
+{
+   static int32 count;
+   if (count == 0)
+      count = privateGetProcessorCount();
+   return count;
+}
+
 void threadDestroyAll()
 {     
    Context c;              
@@ -81,42 +142,264 @@ void threadDestroyAll()
       }
 }
 
-void freeMutex(int32 hash, VoidP pmutex)
+/*
+ * Object monitors
+ *
+ * Each object has a monitor word in its properties. While only one thread uses the
+ * synchronized statement on an object, the word holds the owner's context id and the
+ * recursion count (a thin lock), and entering/exiting costs a single compare-and-swap.
+ * When a second thread finds the monitor owned by someone else, it spins (yielding) for
+ * a while and then parks: it sets the contended bit and puts itself in the waiter list,
+ * both under the mutexes lock. The owner's last exit sees the bit and inflates the monitor,
+ * handing it to a recursive mutex taken from the monitor table (the word is never thinned
+ * again), and wakes the waiters, which then block on that mutex. The table is made of
+ * fixed segments, so the mutexes never move; the free indexes are recycled when the object
+ * is collected.
+ *
+ * Context ids carry a generation (see newContext), so a thread that reuses the slot of
+ * a dead owner isn't taken as the owner; the waiters steal the monitors of dead owners.
+ */
+
+#define MONITOR_OWNER_MASK 0x0000FFFF
+#define MONITOR_COUNT_ONE  0x00010000
+#define MONITOR_COUNT_MASK 0x3FFF0000
+#define MONITOR_CONTENDED  0x40000000
+#define MONITOR_INFLATED   0x80000000
+#define MONITOR_SEGMENT_BITS 8
+#define MONITOR_SEGMENT_SIZE (1 << MONITOR_SEGMENT_BITS)
+#define MONITOR_MAX_SEGMENTS 1024
+#define MONITOR_SPINS 64
+#define MONITOR_PARK_MILLIS 100 // the owner is checked for death after this
+
+static MUTEX_TYPE* monitorSegments[MONITOR_MAX_SEGMENTS];
+static int32 monitorSegmentCount;
+static int32* freeMonitors;
+static int32 freeMonitorsCount, freeMonitorsCapacity;
+static Context monitorWaiters; // the threads parked on thin monitors, guarded by the mutexes lock
+
+#define MONITOR_MUTEX(idx) (&monitorSegments[(idx) >> MONITOR_SEGMENT_BITS][(idx) & (MONITOR_SEGMENT_SIZE-1)])
+
+static int32 allocMonitor() // returns the index of a free mutex, or -1 if there's no memory
+{
+   int32 idx = -1;
+   LOCKVAR(mutexes);
+   if (freeMonitorsCount == 0 && monitorSegmentCount < MONITOR_MAX_SEGMENTS)
+   {
+      MUTEX_TYPE* segment = (MUTEX_TYPE*)xmalloc(sizeof(MUTEX_TYPE) * MONITOR_SEGMENT_SIZE);
+      int32* newFree = freeMonitorsCapacity >= (monitorSegmentCount+1) * MONITOR_SEGMENT_SIZE ? freeMonitors : (int32*)xrealloc((uint8*)freeMonitors, sizeof(int32) * (monitorSegmentCount+1) * MONITOR_SEGMENT_SIZE);
+      if (segment != null && newFree != null)
+      {
+         int32 i, base = monitorSegmentCount * MONITOR_SEGMENT_SIZE;
+         SETUP_MUTEX;
+         for (i = 0; i < MONITOR_SEGMENT_SIZE; i++)
+            INIT_MUTEX_VAR(segment[i]);
+         freeMonitors = newFree;
+         freeMonitorsCapacity = (monitorSegmentCount+1) * MONITOR_SEGMENT_SIZE;
+         for (i = MONITOR_SEGMENT_SIZE-1; i >= 0; i--)
+            freeMonitors[freeMonitorsCount++] = base + i;
+         monitorSegments[monitorSegmentCount++] = segment;
+      }
+      else
+      {
+         xfree(segment);
+         if (newFree != null)
+         {
+            freeMonitors = newFree;
+            freeMonitorsCapacity = (monitorSegmentCount+1) * MONITOR_SEGMENT_SIZE;
+         }
+      }
+   }
+   if (freeMonitorsCount > 0)
+      idx = freeMonitors[--freeMonitorsCount];
+   UNLOCKVAR(mutexes);
+   return idx;
+}
+
+static void releaseMonitor(int32 idx)
 {
-   MUTEX_TYPE* mutex = (MUTEX_TYPE*)pmutex;
-   UNUSED(hash);
-   DESTROY_MUTEX_VAR(*mutex);
-   xfree(mutex);
+   LOCKVAR(mutexes);
+   freeMonitors[freeMonitorsCount++] = idx;
+   UNLOCKVAR(mutexes);
 }
 
-bool lockMutex(size_t address)
+static bool isOwnerAlive(uint32 owner)
 {
-   MUTEX_TYPE* mutex;
+   Context c;
+   bool alive;
+   LOCKVAR(omm); // deleteContext removes the context under it, before freeing it
+   c = contexts[(owner & CONTEXT_SLOT_MASK) - 1];
+   alive = c != null && (uint32)c->id == owner;
+   UNLOCKVAR(omm);
+   return alive;
+}
 
+static void wakeMonitorWaiters(TCObject o) // must be called with the mutexes lock held
+{
+   Context* prev = &monitorWaiters;
+   Context c;
+   while ((c = *prev) != null)
+      if (c->waitingMonitor == o)
+      {
+         *prev = c->nextMonitorWaiter;
+         c->waitingMonitor = null;
+         threadPermitUnpark(&c->permit);
+      }
+      else prev = &c->nextMonitorWaiter;
+}
+
+static void parkOnMonitor(Context currentContext, TCObject o, uint32 m)
+{
+   volatile uint32* word = &OBJ_PROPERTIES(o)->monitor;
+   bool queued = false, wasInNative;
+   LOCKVAR(mutexes);
+   if (*word == m && ((m & MONITOR_CONTENDED) || ATOMIC_CAS32(word, m, m | MONITOR_CONTENDED))) // the owner will wake us in its last exit
+   {
+      currentContext->waitingMonitor = o;
+      currentContext->nextMonitorWaiter = monitorWaiters;
+      monitorWaiters = currentContext;
+      queued = true;
+   }
+   UNLOCKVAR(mutexes);
+   if (!queued) // the word changed: try again
+      return;
+   wasInNative = currentContext->inNative;
+   currentContext->inNative = true; // blocked threads don't hold back an incremental gc cycle
+   threadPermitPark(&currentContext->permit, MONITOR_PARK_MILLIS);
+   currentContext->inNative = wasInNative;
+   MEMORY_BARRIER();
    LOCKVAR(mutexes);
-   if (!(mutex = htGetPtr(&htMutexes, address)))
+   if (currentContext->waitingMonitor != null) // timed out: leave the list
+   {
+      Context* prev = &monitorWaiters;
+      while (*prev != currentContext)
+         prev = &(*prev)->nextMonitorWaiter;
+      *prev = currentContext->nextMonitorWaiter;
+      currentContext->waitingMonitor = null;
+   }
+   UNLOCKVAR(mutexes);
+}
+
+static void lockMonitorMutex(Context currentContext, int32 idx)
+{
+   MUTEX_TYPE* mutex = MONITOR_MUTEX(idx);
+   bool wasInNative = currentContext->inNative;
+   currentContext->inNative = true;
+   RESERVE_MUTEX_VAR(*mutex);
+   currentContext->inNative = wasInNative;
+   MEMORY_BARRIER();
+}
+
+bool monitorEnter(Context currentContext, TCObject o)
+{
+   volatile uint32* word = &OBJ_PROPERTIES(o)->monitor;
+   uint32 id = (uint32)currentContext->id;
+   int32 spins = 0;
+   while (true)
    {
-      if (!(mutex = (MUTEX_TYPE*)xmalloc(sizeof(MUTEX_TYPE))))
+      uint32 m = *word;
+      if (m == 0)
       {
-         UNLOCKVAR(mutexes);
-         return false;
+         if (ATOMIC_CAS32(word, 0, id)) // fast path: nobody owns it
+            return true;
       }
-      SETUP_MUTEX;
-      INIT_MUTEX_VAR(*mutex);
-      if (!htPutPtr(&htMutexes, address, mutex))
-      {                  
-         DESTROY_MUTEX_VAR(*mutex);
-         UNLOCKVAR(mutexes);
-         return false;
+      else
+      if (m & MONITOR_INFLATED)
+      {
+         lockMonitorMutex(currentContext, (int32)(m & ~MONITOR_INFLATED));
+         return true;
+      }
+      else
+      if ((m & MONITOR_OWNER_MASK) == id) // recursive enter; the waiters may set the contended bit meanwhile
+      {
+         if ((m & MONITOR_COUNT_MASK) != MONITOR_COUNT_MASK)
+         {
+            if (ATOMIC_CAS32(word, m, m + MONITOR_COUNT_ONE))
+               return true;
+         }
+         else // count overflow: move the ownership to a mutex
+         {
+            int32 idx = allocMonitor(), n;
+            if (idx < 0)
+               return false;
+            for (n = ((m & MONITOR_COUNT_MASK) / MONITOR_COUNT_ONE) + 2; n > 0; n--)
+               RESERVE_MUTEX_VAR(*MONITOR_MUTEX(idx));
+            LOCKVAR(mutexes);
+            while (!ATOMIC_CAS32(word, m, MONITOR_INFLATED | (uint32)idx))
+               m = *word;
+            if (m & MONITOR_CONTENDED)
+               wakeMonitorWaiters(o);
+            UNLOCKVAR(mutexes);
+            return true;
+         }
       }
+      else // owned by another thread
+      if (++spins < MONITOR_SPINS)
+         THREAD_YIELD();
+      else
+      if (!isOwnerAlive(m & MONITOR_OWNER_MASK)) // the owner died inside the synchronized block: take the monitor over, keeping the contended bit
+      {
+         if (ATOMIC_CAS32(word, m, id | (m & MONITOR_CONTENDED)))
+            return true;
+      }
+      else parkOnMonitor(currentContext, o, m);
    }
-   UNLOCKVAR(mutexes);
-   RESERVE_MUTEX_VAR(*mutex); 
-   return true;
 }
 
-void unlockMutex(size_t address)
+void monitorExit(Context currentContext, TCObject o)
+{
+   volatile uint32* word = &OBJ_PROPERTIES(o)->monitor;
+   uint32 m = *word;
+   if (m & MONITOR_INFLATED)
+      RELEASE_MUTEX_VAR(*MONITOR_MUTEX(m & ~MONITOR_INFLATED));
+   else
+   if ((m & MONITOR_OWNER_MASK) == (uint32)currentContext->id)
+      while (true) // only the contended bit can change under us
+      {
+         if (m & MONITOR_COUNT_MASK)
+         {
+            if (ATOMIC_CAS32(word, m, m - MONITOR_COUNT_ONE))
+               break;
+         }
+         else
+         if (!(m & MONITOR_CONTENDED))
+         {
+            if (ATOMIC_CAS32(word, m, 0)) // full barrier: the writes done inside the synchronized block are visible to the next owner
+               break;
+         }
+         else // hand the monitor to an unlocked mutex and wake the waiters; without memory, just release it and let them race again
+         {
+            int32 idx = allocMonitor();
+            LOCKVAR(mutexes);
+            ATOMIC_CAS32(word, m, idx < 0 ? 0 : MONITOR_INFLATED | (uint32)idx); // the waiters only touch the word under this lock
+            wakeMonitorWaiters(o);
+            UNLOCKVAR(mutexes);
+            break;
+         }
+         m = *word;
+      }
+}
+
+void monitorFree(TCObject o)
+{
+   uint32 m = OBJ_PROPERTIES(o)->monitor;
+   OBJ_PROPERTIES(o)->monitor = 0;
+   if (m & MONITOR_INFLATED)
+      releaseMonitor((int32)(m & ~MONITOR_INFLATED));
+}
+
+void destroyMonitors()
 {
-   MUTEX_TYPE* mutex = htGetPtr(&htMutexes, address);
-   RELEASE_MUTEX_VAR(*mutex);
-}
\ No newline at end of file
+   int32 i, j;
+   for (i = 0; i < monitorSegmentCount; i++)
+   {
+      for (j = 0; j < MONITOR_SEGMENT_SIZE; j++)
+         DESTROY_MUTEX_VAR(monitorSegments[i][j]);
+      xfree(monitorSegments[i]);
+   }
+   monitorSegmentCount = freeMonitorsCount = freeMonitorsCapacity = 0;
+   xfree(freeMonitors);
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "tcthread_test.h"
+#endif
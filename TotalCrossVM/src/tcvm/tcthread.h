@@ -93,6 +93,19 @@ Pthreads on Posix (iPhone, Linux, ...)
  #error "Mutexes are not implemented"
 #endif
 
+/// Atomically sets *ptr to newValue if it is equal to oldValue; returns true if the value was set. Also acts as a full memory barrier.
+/// MEMORY_BARRIER makes the writes done before it visible to other threads before the ones done after it (used to publish structures read without locks).
+#if defined(WIN32)
+ #define ATOMIC_CAS32(ptr, oldValue, newValue) (InterlockedCompareExchange((volatile LONG*)(ptr), (LONG)(newValue), (LONG)(oldValue)) == (LONG)(oldValue))
+ #define MEMORY_BARRIER() MemoryBarrier()
+ #define THREAD_YIELD() SwitchToThread()
+#else
+ #include <sched.h>
+ #define ATOMIC_CAS32(ptr, oldValue, newValue) __sync_bool_compare_and_swap((ptr), (oldValue), (newValue))
+ #define MEMORY_BARRIER() __sync_synchronize()
+ #define THREAD_YIELD() sched_yield()
+#endif
+
 #define INIT_MUTEX(x)    INIT_MUTEX_VAR(MUTEX_VAR(x))
 #define RESERVE_MUTEX(x) RESERVE_MUTEX_VAR(MUTEX_VAR(x))
 #define RELEASE_MUTEX(x) RELEASE_MUTEX_VAR(MUTEX_VAR(x))
@@ -105,13 +118,16 @@ Pthreads on Posix (iPhone, Linux, ...)
 
 extern DECLARE_MUTEX(omm);
 extern DECLARE_MUTEX(tcz);
-extern DECLARE_MUTEX(metAndCls);
+extern DECLARE_MUTEX(metAndCls); // the inline caches, and the class heaps after the classes are loaded
 extern DECLARE_MUTEX(screen);
 extern DECLARE_MUTEX(htSSL);
 extern DECLARE_MUTEX(createdHeaps);
 extern DECLARE_MUTEX(alloc);
+extern DECLARE_MUTEX(classLoaderLock);
 extern DECLARE_MUTEX(fonts);
 extern DECLARE_MUTEX(mutexes);
+extern DECLARE_MUTEX(jit);
+extern DECLARE_MUTEX(profiler);
 
 #if defined(WIN32)
 
@@ -123,6 +139,7 @@ extern DECLARE_MUTEX(mutexes);
     TCObject threadObject;
     ThreadHandle h;
  } *ThreadArgs, TThreadArgs;
+ typedef HANDLE TThreadPermit; // auto-reset event
 
 #elif defined(POSIX) || defined(ANDROID)
 
@@ -138,6 +155,12 @@ extern DECLARE_MUTEX(mutexes);
     bool start;
     ThreadHandle h;
  } *ThreadArgs, TThreadArgs;
+ typedef struct
+ {
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    bool set;
+ } TThreadPermit;
 
 #endif
 
@@ -147,9 +170,52 @@ void threadCreateJava(Context currentContext, TCObject this_);
 void threadDestroy(ThreadHandle h, bool threadDestroyingItself); // must be used when exiting the application or the thread itself
 void threadDestroyAll(); // destroy all threads
 
-void freeMutex(int32 hash, VoidP mutex);
-bool lockMutex(size_t address);
-void unlockMutex(size_t address);
+/// A permit lets a thread park until another one gives it. A permit given while nobody is parked is kept for the next park
+void threadPermitInit(TThreadPermit* p);
+void threadPermitDestroy(TThreadPermit* p);
+/// Waits until the permit is given or the timeout (in milliseconds) elapses, then takes it. Returns false on timeout
+bool threadPermitPark(TThreadPermit* p, int32 millis);
+void threadPermitUnpark(TThreadPermit* p);
+
+/// A function run by threadRunParallel; index goes from 0 to the number of threads - 1
+typedef void (*ParallelFunc)(int32 index, VoidP arg);
+
+#define MAX_PARALLEL_THREADS 16
+
+typedef struct
+{
+   ParallelFunc f;
+   VoidP arg;
+   int32 index;
+} TParallelArgs;
+
+/// The helper threads started by threadStartParallel
+typedef struct
+{
+   int32 count;
+   TParallelArgs args[MAX_PARALLEL_THREADS];
+   ThreadHandle h[MAX_PARALLEL_THREADS];
+   bool created[MAX_PARALLEL_THREADS];
+} TParallelThreads;
+
+/// Runs f(1,arg) ... f(n-1,arg) in helper threads and returns at once; threadJoinParallel must be called to wait for them.
+void threadStartParallel(TParallelThreads* t, int32 n, ParallelFunc f, VoidP arg);
+/// Waits until the helper threads started by threadStartParallel finish
+void threadJoinParallel(TParallelThreads* t);
+/// Runs f(0,arg) in the current thread and f(1,arg) ... f(n-1,arg) in helper threads, returning when all of them finish.
+/// The indexes whose thread could not be created are not run, so the work must be shared dynamically among the ones that run.
+void threadRunParallel(int32 n, ParallelFunc f, VoidP arg);
+/// Returns the number of processors that are online
+int32 threadGetProcessorCount();
+
+/// Enters the monitor of the given object (synchronized statement). Returns false if there's no memory to inflate the monitor
+bool monitorEnter(Context currentContext, TCObject o);
+/// Exits the monitor of the given object
+void monitorExit(Context currentContext, TCObject o);
+/// Releases the mutex of an inflated monitor; called when the object is collected
+void monitorFree(TCObject o);
+/// Releases all inflated monitors
+void destroyMonitors();
 
 #define ThreadArgsFromObject(o) ((ThreadArgs)ARRAYOBJ_START(Thread_taskID(o)))
 #define ThreadHandleFromObject(o) ThreadArgsFromObject(o)->h
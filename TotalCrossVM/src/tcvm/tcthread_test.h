@@ -0,0 +1,176 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#define MONITOR_TEST_THREADS 4
+#define MONITOR_TEST_ROUNDS 2000
+
+typedef struct
+{
+   TCObject o;
+   Context contexts[MONITOR_TEST_THREADS];
+   volatile int32 counter, entered;
+} TMonitorTest;
+
+static void monitorTestIncrement(int32 index, VoidP arg)
+{
+   TMonitorTest* t = (TMonitorTest*)arg;
+   int32 i;
+   for (i = 0; i < MONITOR_TEST_ROUNDS; i++)
+   {
+      monitorEnter(t->contexts[index], t->o);
+      t->counter++; // not atomic: only the monitor keeps the updates from being lost
+      monitorExit(t->contexts[index], t->o);
+   }
+}
+
+static void monitorTestEnter(int32 index, VoidP arg)
+{
+   TMonitorTest* t = (TMonitorTest*)arg;
+   if (index == 1)
+   {
+      monitorEnter(t->contexts[1], t->o);
+      t->entered = 1;
+      monitorExit(t->contexts[1], t->o);
+   }
+}
+
+static bool waitMonitorWord(TCObject o, uint32 bits) // waits up to 5 seconds for one of the bits to be set
+{
+   int32 i;
+   for (i = 0; i < 5000 && (OBJ_PROPERTIES(o)->monitor & bits) == 0; i++)
+      Sleep(1);
+   return (OBJ_PROPERTIES(o)->monitor & bits) != 0;
+}
+
+TESTCASE(Monitors_Recursion)
+{
+   TCObject o = createObject(currentContext, "java.lang.Object");
+   volatile uint32* word;
+   uint32 id = (uint32)currentContext->id;
+   int32 i;
+   ASSERT1_EQUALS(NotNull, o);
+   word = &OBJ_PROPERTIES(o)->monitor;
+   // thin: the owner and the count of the extra enters
+   ASSERT1_EQUALS(True, monitorEnter(currentContext, o));
+   ASSERT2_EQUALS(I32, *word, id);
+   ASSERT1_EQUALS(True, monitorEnter(currentContext, o));
+   ASSERT1_EQUALS(True, monitorEnter(currentContext, o));
+   ASSERT2_EQUALS(I32, *word, id | (2 * MONITOR_COUNT_ONE));
+   monitorExit(currentContext, o);
+   monitorExit(currentContext, o);
+   ASSERT2_EQUALS(I32, *word, id);
+   monitorExit(currentContext, o);
+   ASSERT2_EQUALS(I32, *word, 0);
+   monitorExit(currentContext, o); // not owned: ignored
+   ASSERT2_EQUALS(I32, *word, 0);
+   // count overflow: the ownership moves to a mutex that is held once per enter
+   *word = id | MONITOR_COUNT_MASK;
+   ASSERT1_EQUALS(True, monitorEnter(currentContext, o));
+   ASSERT1_EQUALS(True, (*word & MONITOR_INFLATED) != 0);
+   for (i = (MONITOR_COUNT_MASK / MONITOR_COUNT_ONE) + 2; i > 0; i--)
+      monitorExit(currentContext, o);
+   ASSERT1_EQUALS(True, (*word & MONITOR_INFLATED) != 0);
+   ASSERT1_EQUALS(True, monitorEnter(currentContext, o)); // inflated monitors stay recursive
+   ASSERT1_EQUALS(True, monitorEnter(currentContext, o));
+   monitorExit(currentContext, o);
+   monitorExit(currentContext, o);
+finish:
+   if (o != null)
+   {
+      monitorFree(o);
+      setObjectLock(o, UNLOCKED);
+   }
+}
+
+TESTCASE(Monitors_Contention) // #DEPENDS(Monitors_Recursion)
+{
+   TMonitorTest t;
+   TParallelThreads threads;
+   volatile uint32* word;
+   uint32 owner;
+   int32 i, n = 0, enteredEarly;
+   bool contended;
+   xmemzero(&t, sizeof(t));
+   t.o = createObject(currentContext, "java.lang.Object");
+   ASSERT1_EQUALS(NotNull, t.o);
+   word = &OBJ_PROPERTIES(t.o)->monitor;
+   for (i = 0; i < MONITOR_TEST_THREADS; i++)
+   {
+      t.contexts[i] = newContext(null, null, false);
+      ASSERT1_EQUALS(NotNull, t.contexts[i]);
+   }
+   // 1. a thread that finds the monitor owned parks, and the owner's exit hands the monitor to a mutex and wakes it
+   ASSERT1_EQUALS(True, monitorEnter(t.contexts[0], t.o));
+   threadStartParallel(&threads, 2, monitorTestEnter, &t);
+   if (!threads.created[1])
+   {
+      monitorExit(t.contexts[0], t.o);
+      threadJoinParallel(&threads);
+      TEST_CANNOT_RUN;
+   }
+   contended = waitMonitorWord(t.o, MONITOR_CONTENDED);
+   enteredEarly = t.entered;
+   owner = *word & MONITOR_OWNER_MASK;
+   monitorExit(t.contexts[0], t.o); // releases the helper thread before checking anything
+   threadJoinParallel(&threads);
+   ASSERT1_EQUALS(True, contended);
+   ASSERT2_EQUALS(I32, enteredEarly, 0);
+   ASSERT2_EQUALS(I32, owner, t.contexts[0]->id);
+   ASSERT2_EQUALS(I32, t.entered, 1);
+   ASSERT1_EQUALS(True, (*word & MONITOR_INFLATED) != 0);
+   ASSERT1_EQUALS(Null, t.contexts[1]->waitingMonitor);
+   ASSERT1_EQUALS(Null, monitorWaiters);
+   monitorFree(t.o);
+   // 2. mutual exclusion among several threads
+   threadStartParallel(&threads, MONITOR_TEST_THREADS, monitorTestIncrement, &t);
+   monitorTestIncrement(0, &t);
+   for (i = 0; i < threads.count; i++)
+      if (i == 0 || threads.created[i])
+         n++;
+   threadJoinParallel(&threads);
+   ASSERT2_EQUALS(I32, t.counter, n * MONITOR_TEST_ROUNDS);
+   ASSERT1_EQUALS(Null, monitorWaiters);
+finish:
+   for (i = 0; i < MONITOR_TEST_THREADS; i++)
+      if (t.contexts[i] != null)
+         deleteContext(t.contexts[i], false);
+   if (t.o != null)
+   {
+      monitorFree(t.o);
+      setObjectLock(t.o, UNLOCKED);
+   }
+}
+
+TESTCASE(Monitors_StaleOwner) // #DEPENDS(Monitors_Recursion)
+{
+   TCObject o = createObject(currentContext, "java.lang.Object");
+   Context dead, reused = null;
+   volatile uint32* word;
+   uint32 deadId;
+   ASSERT1_EQUALS(NotNull, o);
+   word = &OBJ_PROPERTIES(o)->monitor;
+   dead = newContext(null, null, false);
+   ASSERT1_EQUALS(NotNull, dead);
+   deadId = (uint32)dead->id;
+   ASSERT1_EQUALS(True, monitorEnter(dead, o));
+   deleteContext(dead, false); // the thread dies inside the synchronized block
+   reused = newContext(null, null, false);
+   ASSERT1_EQUALS(NotNull, reused);
+   // the slot is reused with another generation, so the new thread isn't taken as the owner
+   ASSERT2_EQUALS(I32, reused->id & CONTEXT_SLOT_MASK, deadId & CONTEXT_SLOT_MASK);
+   ASSERT1_EQUALS(True, (uint32)reused->id != deadId);
+   monitorExit(reused, o);
+   ASSERT2_EQUALS(I32, *word, deadId);
+   // but it takes the abandoned monitor over
+   ASSERT1_EQUALS(True, monitorEnter(reused, o));
+   ASSERT2_EQUALS(I32, *word, reused->id);
+   monitorExit(reused, o);
+   ASSERT2_EQUALS(I32, *word, 0);
+finish:
+   if (reused != null)
+      deleteContext(reused, false);
+   if (o != null)
+      setObjectLock(o, UNLOCKED);
+}
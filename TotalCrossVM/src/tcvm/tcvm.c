@@ -10,12 +10,16 @@
 #endif
 
 #define TRACE if (traceOn) debug
+// the jumps and calls are where the cpu profiler samples the stack of the thread, and the safepoints of the incremental gc
+#define PROFILER_POINT if (context->profilerTick != profilerTick) takeProfilerSample(context, method, code); GC_SAFEPOINT(context)
+// the allocation profiler takes the site of the objects from the slot of the pc in the frame of the method
+#define SAVE_PC context->callStack[-1] = code;
 #define DUMP_BYTECODE(s) //TRACE("%s",s); //TRACE("T %08d %X %X %05d - %4d: %s", getTimeStamp(), thread, context, ++context->ccon, (int32)(code-method->code), s);
 
 #ifdef DIRECT_JUMP // use a direct jump if supported
  #define OPCODE(x) _##x: DUMP_BYTECODE(#x)
  #define NEXT_OP goto *address[(++code)->s24.op];
- #define NEXT_OP0 goto *address[code->s24.op];
+ #define NEXT_OP0 PROFILER_POINT goto *address[code->s24.op];
  #define FIRST_OP NEXT_OP0
  #define OPADDR(x) _address[x] = &&_##x;
 
@@ -24,7 +28,7 @@
 #else
  #define OPCODE(x) case x: DUMP_BYTECODE(#x)
  #define NEXT_OP  code++; goto mainLoop;
- #define NEXT_OP0 goto mainLoop;
+ #define NEXT_OP0 PROFILER_POINT goto mainLoop;
  #define FIRST_OP switch (code->s24.op)
 
  #define XOPTION(pref,x) case x
@@ -65,6 +69,7 @@ static void tcvmCreateException(Context currentContext, Throwable t, int32 pc, i
          if (message)
          {
             *Throwable_msg(currentContext->thrownException) = createStringObjectFromCharP(currentContext, str,-1);
+            WRITE_BARRIER(currentContext->thrownException, *Throwable_msg(currentContext->thrownException));
             setObjectLock(*Throwable_msg(currentContext->thrownException), UNLOCKED);
             if (*Throwable_msg(currentContext->thrownException) == null)
                debug("out of memory error reason: %s",str);
@@ -119,7 +124,9 @@ bool checkArrayRange(Context currentContext, TCObject obj, int32 start, int32 co
          else                                                                      \
             goto throwNoSuchFieldError;                                            \
       }                                                                            \
-   }
+   }                                                                               \
+   if (!disableQuickening)                                                         \
+      quickenStatic(code);
 
 #define GET_INSTANCE_FIELD(type)                                              \
    o = regO[code->field_reg.this_];                                            \
@@ -138,9 +145,92 @@ bool checkArrayRange(Context currentContext, TCObject obj, int32 start, int32 co
                goto throwNoSuchFieldError;                                    \
          }                                                                    \
       }                                                                       \
+      if (retv < (1 << SYM12) && !disableQuickening)                          \
+         quickenField(code, retv);                                            \
    }                                                                          \
    else {exceptionMsg = "Getting instance field"; goto throwNullPointerException;}
 
+#define GET_INSTANCE_FIELD_QUICK                                              \
+   o = regO[code->field_reg.this_];                                            \
+   if (o == null) {exceptionMsg = "Getting instance field"; goto throwNullPointerException;} \
+   retv = code->field_reg.sym;
+
+#ifdef ENABLE_JIT
+#define JIT_ENTER                                                                          \
+   if (method->jit != null)                                                                \
+      code = jitRun(context, method, regI, regO, reg64, code);                             \
+   else                                                                                    \
+   if (IS_VMTWEAK_ON(VMTWEAK_JIT) && method->hotness < JIT_THRESHOLD && ++method->hotness == JIT_THRESHOLD) \
+   {                                                                                       \
+      jitCompile(method, 0);                                                               \
+      if (method->jit != null)                                                             \
+         code = jitRun(context, method, regI, regO, reg64, code);                          \
+   }
+#else
+#define JIT_ENTER
+#endif
+
+#ifdef TRACK_USED_OPCODES
+int32 usedOpcodes[OPCODE_LENGTH];
+int32 usedOpcodePairs[OPCODE_LENGTH][OPCODE_LENGTH];
+#endif
+
+static void quickenField(Code code, uint16 idx) // replaces the symbol of a resolved instance field by its index, and the opcode by the quick version
+{
+   TCode q = *code;
+   q.field_reg.sym = idx;
+   switch (q.op.op)
+   {
+      case MOV_regI_field:
+         switch (code[1].op.op) // if the loaded field is tested next, fuse both
+         {
+            case JEQ_regI_s6:   q.op.op = MOV_regI_fieldQ_JEQ_regI_s6;   break;
+            case JNE_regI_s6:   q.op.op = MOV_regI_fieldQ_JNE_regI_s6;   break;
+            case JLT_regI_regI: q.op.op = MOV_regI_fieldQ_JLT_regI_regI; break;
+            case JGE_regI_regI: q.op.op = MOV_regI_fieldQ_JGE_regI_regI; break;
+            default:            q.op.op = MOV_regI_fieldQ;
+         }
+         break;
+      case MOV_regO_field:  q.op.op = MOV_regO_fieldQ;  break;
+      case MOV_reg64_field: q.op.op = MOV_reg64_fieldQ; break;
+      case MOV_field_regI:  q.op.op = MOV_fieldQ_regI;  break;
+      case MOV_field_regO:  q.op.op = MOV_fieldQ_regO;  break;
+      case MOV_field_reg64: q.op.op = MOV_fieldQ_reg64; break;
+      default: return;
+   }
+   code->u32.u32 = q.u32.u32; // a single store, so another thread running this code sees either the old or the new instruction
+}
+
+static void quickenArray(Code code) // fuses the array load with the next increment, common in loops
+{
+   TCode q = *code;
+   q.op.op = code[1].op.op == INC_regI ? MOV_regI_arc_INC_regI : MOV_regI_arcQ;
+   code->u32.u32 = q.u32.u32;
+}
+
+static void quickenStatic(Code code) // the static field is bound and never unbound, so the quick version skips the check
+{
+   TCode q = *code;
+   switch (q.op.op)
+   {
+      case MOV_regI_static:  q.op.op = MOV_regI_staticQ;  break;
+      case MOV_regO_static:  q.op.op = MOV_regO_staticQ;  break;
+      case MOV_reg64_static: q.op.op = MOV_reg64_staticQ; break;
+      case MOV_static_regI:  q.op.op = MOV_staticQ_regI;  break;
+      case MOV_static_regO:  q.op.op = MOV_staticQ_regO;  break;
+      case MOV_static_reg64: q.op.op = MOV_staticQ_reg64; break;
+      default: return;
+   }
+   code->u32.u32 = q.u32.u32;
+}
+
+static void quickenCall(Code code) // the method is bound in boundNormal, which is never unbound
+{
+   TCode q = *code;
+   q.op.op = CALL_normalQ;
+   code->u32.u32 = q.u32.u32;
+}
+
 #ifdef DIRECT_JUMP // use a direct jump if supported
 uint32 *_address[OPCODE_LENGTH];
 uint32 *_addrMtdParam[4];
@@ -166,18 +256,17 @@ TC_API TValue executeMethod(Context context, Method method, ...)
    uint32 nparam=0;
    NMParams nmp = &context->nmp;
    CharP className, methodName, fieldName;
-   int32 i,len;
+   int32 i,len,widened;
    UInt16Array sym;
-   bool originalClassIsInterface,directNativeCall=false;
+   bool originalClassIsInterface,directNativeCall=false,wasInNative;
    CharP exceptionMsg = null;
    TCObject o=null;
    Method newMethod=null;
    uint16 retv;
    VoidP sf;
    TValue returnedValue;
-   MethodAndClass mac,last;
-   MethodAndClass* macArray;
-   MethodAndClass* boundHead=null;
+   MethodAndClass mac;
+   InlineCache ic;
    int32 hashName,hashParams;
    ThreadHandle thread;
 
@@ -201,7 +290,10 @@ TC_API TValue executeMethod(Context context, Method method, ...)
       OPADDR(MOV_arc_reg64)       OPADDR(MOV_aru_regI)        OPADDR(MOV_aru_regO)        OPADDR(MOV_aru_reg64)       OPADDR(MOV_arc_regIb)      OPADDR(MOV_arc_reg16)       OPADDR(MOV_aru_regIb)       OPADDR(MOV_aru_reg16)       OPADDR(MOV_regIb_arc)      OPADDR(MOV_reg16_arc)       OPADDR(MOV_regIb_aru)       OPADDR(MOV_reg16_aru)       OPADDR(MOV_regO_null)      OPADDR(INC_regI)            OPADDR(ADD_regI_regI_regI)  OPADDR(ADD_regI_s12_regI)   OPADDR(ADD_regI_arc_s6)      OPADDR(ADD_regI_aru_s6)     OPADDR(ADD_regI_regI_sym)   OPADDR(ADD_regD_regD_regD)  OPADDR(ADD_regL_regL_regL) OPADDR(ADD_aru_regI_s6)     OPADDR(SUB_regI_s12_regI)   OPADDR(SUB_regI_regI_regI)  OPADDR(SUB_regD_regD_regD) OPADDR(SUB_regL_regL_regL)  OPADDR(MUL_regI_regI_s12)   OPADDR(MUL_regI_regI_regI)  OPADDR(MUL_regD_regD_regD) OPADDR(MUL_regL_regL_regL)  OPADDR(DIV_regI_regI_s12)   OPADDR(DIV_regI_regI_regI)
       OPADDR(DIV_regD_regD_regD)  OPADDR(DIV_regL_regL_regL)  OPADDR(MOD_regI_regI_s12)   OPADDR(MOD_regI_regI_regI)  OPADDR(MOD_regD_regD_regD) OPADDR(MOD_regL_regL_regL)  OPADDR(SHR_regI_regI_s12)   OPADDR(SHR_regI_regI_regI)  OPADDR(SHR_regL_regL_regL) OPADDR(SHL_regI_regI_s12)   OPADDR(SHL_regI_regI_regI)  OPADDR(SHL_regL_regL_regL)  OPADDR(USHR_regI_regI_s12) OPADDR(USHR_regI_regI_regI) OPADDR(USHR_regL_regL_regL) OPADDR(AND_regI_regI_s12)   OPADDR(AND_regI_aru_s6)      OPADDR(AND_regI_regI_regI)  OPADDR(AND_regL_regL_regL)  OPADDR(OR_regI_regI_s12)    OPADDR(OR_regI_regI_regI)  OPADDR(OR_regL_regL_regL)   OPADDR(XOR_regI_regI_s12)   OPADDR(XOR_regI_regI_regI)  OPADDR(XOR_regL_regL_regL) OPADDR(JEQ_regO_regO)       OPADDR(JEQ_regO_null)       OPADDR(JEQ_regI_regI)       OPADDR(JEQ_regL_regL)      OPADDR(JEQ_regD_regD)       OPADDR(JEQ_regI_s6)         OPADDR(JEQ_regI_sym)
       OPADDR(JNE_regO_regO)       OPADDR(JNE_regO_null)       OPADDR(JNE_regI_regI)       OPADDR(JNE_regL_regL)       OPADDR(JNE_regD_regD)      OPADDR(JNE_regI_s6)         OPADDR(JNE_regI_sym)        OPADDR(JLT_regI_regI)       OPADDR(JLT_regL_regL)      OPADDR(JLT_regD_regD)       OPADDR(JLT_regI_s6)         OPADDR(JLE_regI_regI)       OPADDR(JLE_regL_regL)      OPADDR(JLE_regD_regD)       OPADDR(JLE_regI_s6)         OPADDR(JGT_regI_regI)       OPADDR(JGT_regL_regL)        OPADDR(JGT_regD_regD)       OPADDR(JGT_regI_s6)         OPADDR(JGE_regI_regI)       OPADDR(JGE_regL_regL)      OPADDR(JGE_regD_regD)       OPADDR(JGE_regI_s6)         OPADDR(JGE_regI_arlen)      OPADDR(DECJGTZ_regI)       OPADDR(DECJGEZ_regI)        OPADDR(TEST_regO)           OPADDR(JUMP_s24)            OPADDR(CONV_regI_regL)     OPADDR(CONV_regI_regD)      OPADDR(CONV_regIb_regI)     OPADDR(CONV_regIc_regI)
-      OPADDR(CONV_regIs_regI)     OPADDR(CONV_regL_regI)      OPADDR(CONV_regL_regD)      OPADDR(CONV_regD_regI)      OPADDR(CONV_regD_regL)     OPADDR(RETURN_regI)         OPADDR(RETURN_regO)         OPADDR(RETURN_reg64)        OPADDR(RETURN_void)        OPADDR(RETURN_s24I)         OPADDR(RETURN_null)         OPADDR(RETURN_s24D)         OPADDR(RETURN_s24L)        OPADDR(RETURN_symI)         OPADDR(RETURN_symO)         OPADDR(RETURN_symD)         OPADDR(RETURN_symL)          OPADDR(SWITCH)              OPADDR(NEWARRAY_len)        OPADDR(NEWARRAY_regI)       OPADDR(NEWARRAY_multi)     OPADDR(NEWOBJ)              OPADDR(THROW)               OPADDR(INSTANCEOF)          OPADDR(CHECKCAST)          OPADDR(CALL_normal)         OPADDR(CALL_virtual)        OPADDR(JUMP_regI)           OPADDR(MONITOR_Enter)      OPADDR(MONITOR_Enter2)      OPADDR(MONITOR_Exit)        OPADDR(MONITOR_Exit2)
+      OPADDR(CONV_regIs_regI)     OPADDR(CONV_regL_regI)      OPADDR(CONV_regL_regD)      OPADDR(CONV_regD_regI)      OPADDR(CONV_regD_regL)     OPADDR(RETURN_regI)         OPADDR(RETURN_regO)         OPADDR(RETURN_reg64)        OPADDR(RETURN_void)        OPADDR(RETURN_s24I)         OPADDR(RETURN_null)         OPADDR(RETURN_s24D)         OPADDR(RETURN_s24L)        OPADDR(RETURN_symI)         OPADDR(RETURN_symO)         OPADDR(RETURN_symD)         OPADDR(RETURN_symL)          OPADDR(SWITCH)              OPADDR(NEWARRAY_len)        OPADDR(NEWARRAY_regI)       OPADDR(NEWARRAY_multi)     OPADDR(NEWOBJ)              OPADDR(THROW)               OPADDR(INSTANCEOF)          OPADDR(CHECKCAST)          OPADDR(CALL_normal)         OPADDR(CALL_virtual)        OPADDR(JUMP_regI)           OPADDR(MONITOR_Enter)      OPADDR(MONITOR_Enter2)      OPADDR(MONITOR_Exit)        OPADDR(MONITOR_Exit2)       OPADDR(SWITCH_table)
+      OPADDR(MOV_regI_fieldQ)     OPADDR(MOV_regO_fieldQ)     OPADDR(MOV_reg64_fieldQ)    OPADDR(MOV_fieldQ_regI)     OPADDR(MOV_fieldQ_regO)    OPADDR(MOV_fieldQ_reg64)    OPADDR(MOV_regI_arcQ)
+      OPADDR(MOV_regI_fieldQ_JEQ_regI_s6) OPADDR(MOV_regI_fieldQ_JNE_regI_s6) OPADDR(MOV_regI_fieldQ_JLT_regI_regI) OPADDR(MOV_regI_fieldQ_JGE_regI_regI) OPADDR(MOV_regI_arc_INC_regI)
+      OPADDR(MOV_regI_staticQ)    OPADDR(MOV_regO_staticQ)    OPADDR(MOV_reg64_staticQ)   OPADDR(MOV_staticQ_regI)    OPADDR(MOV_staticQ_regO)   OPADDR(MOV_staticQ_reg64)   OPADDR(CALL_normalQ)
    }
    address = _address;
    addrMtdParam = _addrMtdParam;
@@ -242,6 +334,12 @@ TC_API TValue executeMethod(Context context, Method method, ...)
    TRACE("T %08d %X %X %05d - Context acquired; usageCount=%d", getTimeStamp(), thread, context, ++context->ccon, context->usageCount);
 #endif
    UNLOCKVAR(context->usageLock);
+   wasInNative = context->inNative; // called by a native method: the bytecode run here must be waited for by the incremental gc
+   if (wasInNative)
+   {
+      context->inNative = false;
+      MEMORY_BARRIER();
+   }
 
    // push the method being called so a stack trace can take that method into consideration
 
@@ -252,6 +350,16 @@ TC_API TValue executeMethod(Context context, Method method, ...)
 
    returnedValue.asInt32 = (int32)0xFFFFFFFF;
 
+   if (code == null && method->body != null) // a method of a prelinked tcz: its body is read in the first call
+   {
+      if (!loadMethodBody(method))
+      {
+         exceptionMsg = "When reading the method's body";
+         goto throwOutOfMemoryError;
+      }
+      code = method->code;
+   }
+
    // check if the register arrays have enough space to store the new method
    if (((context->regI  + method->iCount)   >= context->regIEnd      && !contextIncreaseRegI(context, &regI))   ||
        ((context->regO  + method->oCount)   >= context->regOEnd      && !contextIncreaseRegO(context, &regO))   ||
@@ -271,6 +379,7 @@ TC_API TValue executeMethod(Context context, Method method, ...)
    context->regO  += method->oCount;
    context->reg64 += method->v64Count;
    context->callStack[0] = method;
+   context->callStack[1] = null; // no call nor allocation yet
    context->callStack += 2;
 #ifdef ENABLE_TEST_SUITE
    if (context->callStackForced == null)
@@ -343,12 +452,14 @@ TC_API TValue executeMethod(Context context, Method method, ...)
       directNativeCall = true;
       goto nativeMethodCall;
    }
+   JIT_ENTER
 
 #ifndef DIRECT_JUMP // use a direct jump if supported
 mainLoop:
 #endif
 #ifdef TRACK_USED_OPCODES
-   usedOpcodes[(code+1)->op.op] = 1;
+   usedOpcodes[code->op.op]++;
+   usedOpcodePairs[code->op.op][code[1].op.op]++; // a profile to choose the superinstructions
 #endif
    FIRST_OP
    {
@@ -359,7 +470,7 @@ mainLoop:
          NEXT_OP  // NOP instruction
          #endif
       OPCODE(MOV_regI_regI)       regI[code->reg_reg.reg0] = regI[code->reg_reg.reg1]; NEXT_OP
-      OPCODE(MOV_regI_arc)        ARRAYCHECK(code->reg) // all array checks must fall throught!
+      OPCODE(MOV_regI_arc)        if (!disableQuickening) quickenArray(code); ARRAYCHECK(code->reg) // all array checks must fall throught!
       OPCODE(MOV_regI_aru)        regI[code->reg_ar.reg]  = ((int32*)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]]; NEXT_OP
       OPCODE(MOV_regI_sym)        regI[code->reg_sym.reg] = cp->i32[code->reg_sym.sym]; NEXT_OP
       OPCODE(MOV_regI_s18)        regI[code->s18_reg.reg] = (int32)code->s18_reg.s18; NEXT_OP
@@ -379,7 +490,7 @@ mainLoop:
       OPCODE(MOV_arc_regI)        ARRAYCHECK(code->reg)
       OPCODE(MOV_aru_regI)        ((int32 *)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]] = regI[code->reg_ar.reg]; NEXT_OP
       OPCODE(MOV_arc_regO)        ARRAYCHECK(code->reg)
-      OPCODE(MOV_aru_regO)        ((TCObject*)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]] = regO[code->reg_ar.reg]; NEXT_OP
+      OPCODE(MOV_aru_regO)        ((TCObject*)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]] = regO[code->reg_ar.reg]; WRITE_BARRIER(regO[code->reg_ar.base], regO[code->reg_ar.reg]); NEXT_OP
       OPCODE(MOV_arc_reg64)       ARRAYCHECK(code->reg)
       OPCODE(MOV_aru_reg64)       ((Value64)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]] = reg64[code->reg_ar.reg]; NEXT_OP
       OPCODE(MOV_arc_regIb)       ARRAYCHECK(code->reg)
@@ -391,17 +502,35 @@ mainLoop:
       OPCODE(MOV_reg16_arc)       ARRAYCHECK(code->reg)
       OPCODE(MOV_reg16_aru)       regI[code->reg_ar.reg] = ((uint16*)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]]; NEXT_OP
       OPCODE(MOV_field_regI)      GET_INSTANCE_FIELD(RegI) FIELD_I32(o,               retv) = regI[code->field_reg.reg]; NEXT_OP
-      OPCODE(MOV_field_regO)      GET_INSTANCE_FIELD(RegO) FIELD_OBJ(o, OBJ_CLASS(o), retv) = regO[code->field_reg.reg]; NEXT_OP
+      OPCODE(MOV_field_regO)      GET_INSTANCE_FIELD(RegO) FIELD_OBJ(o, OBJ_CLASS(o), retv) = regO[code->field_reg.reg]; WRITE_BARRIER(o, regO[code->field_reg.reg]); NEXT_OP
       OPCODE(MOV_field_reg64)     GET_INSTANCE_FIELD(RegD) FIELD_DBL(o, OBJ_CLASS(o), retv) = REGD(reg64)[code->field_reg.reg];NEXT_OP
       OPCODE(MOV_regI_field)      GET_INSTANCE_FIELD(RegI) regI[code->field_reg.reg] = FIELD_I32(o,               retv); NEXT_OP
       OPCODE(MOV_regO_field)      GET_INSTANCE_FIELD(RegO) regO[code->field_reg.reg] = FIELD_OBJ(o, OBJ_CLASS(o), retv); NEXT_OP
       OPCODE(MOV_reg64_field)     GET_INSTANCE_FIELD(RegD) REGD(reg64)[code->field_reg.reg] = FIELD_DBL(o, OBJ_CLASS(o), retv); NEXT_OP
+      OPCODE(MOV_fieldQ_regI)     GET_INSTANCE_FIELD_QUICK FIELD_I32(o,               retv) = regI[code->field_reg.reg]; NEXT_OP
+      OPCODE(MOV_fieldQ_regO)     GET_INSTANCE_FIELD_QUICK FIELD_OBJ(o, OBJ_CLASS(o), retv) = regO[code->field_reg.reg]; WRITE_BARRIER(o, regO[code->field_reg.reg]); NEXT_OP
+      OPCODE(MOV_fieldQ_reg64)    GET_INSTANCE_FIELD_QUICK FIELD_DBL(o, OBJ_CLASS(o), retv) = REGD(reg64)[code->field_reg.reg];NEXT_OP
+      OPCODE(MOV_regI_fieldQ)     GET_INSTANCE_FIELD_QUICK regI[code->field_reg.reg] = FIELD_I32(o,               retv); NEXT_OP
+      OPCODE(MOV_regO_fieldQ)     GET_INSTANCE_FIELD_QUICK regO[code->field_reg.reg] = FIELD_OBJ(o, OBJ_CLASS(o), retv); NEXT_OP
+      OPCODE(MOV_reg64_fieldQ)    GET_INSTANCE_FIELD_QUICK REGD(reg64)[code->field_reg.reg] = FIELD_DBL(o, OBJ_CLASS(o), retv); NEXT_OP
+      OPCODE(MOV_regI_fieldQ_JEQ_regI_s6)   GET_INSTANCE_FIELD_QUICK regI[code->field_reg.reg] = FIELD_I32(o, retv); code++; if (regI[code->reg_s6_desloc.reg] == (int32)code->reg_s6_desloc.s6) {code += (int32)code->reg_s6_desloc.desloc; NEXT_OP0} NEXT_OP
+      OPCODE(MOV_regI_fieldQ_JNE_regI_s6)   GET_INSTANCE_FIELD_QUICK regI[code->field_reg.reg] = FIELD_I32(o, retv); code++; if (regI[code->reg_s6_desloc.reg] != (int32)code->reg_s6_desloc.s6) {code += (int32)code->reg_s6_desloc.desloc; NEXT_OP0} NEXT_OP
+      OPCODE(MOV_regI_fieldQ_JLT_regI_regI) GET_INSTANCE_FIELD_QUICK regI[code->field_reg.reg] = FIELD_I32(o, retv); code++; if (regI[code->reg_reg_s12.reg0] <  regI[code->reg_reg_s12.reg1]) {code += (int32)code->reg_reg_s12.s12; NEXT_OP0} NEXT_OP
+      OPCODE(MOV_regI_fieldQ_JGE_regI_regI) GET_INSTANCE_FIELD_QUICK regI[code->field_reg.reg] = FIELD_I32(o, retv); code++; if (regI[code->reg_reg_s12.reg0] >= regI[code->reg_reg_s12.reg1]) {code += (int32)code->reg_reg_s12.s12; NEXT_OP0} NEXT_OP
+      OPCODE(MOV_regI_arcQ)       ARRAYCHECK(code->reg) regI[code->reg_ar.reg] = ((int32*)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]]; NEXT_OP
+      OPCODE(MOV_regI_arc_INC_regI) ARRAYCHECK(code->reg) regI[code->reg_ar.reg] = ((int32*)ARRAYOBJ_START(regO[code->reg_ar.base]))[regI[code->reg_ar.idx]]; code++; regI[code->inc.reg] += (int32)code->inc.s16; NEXT_OP
       OPCODE(MOV_static_regI)     GET_STATIC_FIELD(RegI) ((int32*) sf)[0] = regI[code->static_reg.reg]; NEXT_OP
       OPCODE(MOV_static_regO)     GET_STATIC_FIELD(RegO) ((TCObject*)sf)[0] = regO[code->static_reg.reg]; NEXT_OP
       OPCODE(MOV_static_reg64)    GET_STATIC_FIELD(RegD) ((double*)sf)[0] = REGD(reg64)[code->static_reg.reg]; NEXT_OP
       OPCODE(MOV_regI_static)     GET_STATIC_FIELD(RegI) regI[code->static_reg.reg] = ((int32*) sf)[0]; NEXT_OP
       OPCODE(MOV_regO_static)     GET_STATIC_FIELD(RegO) regO[code->static_reg.reg] = ((TCObject*)sf)[0]; NEXT_OP
       OPCODE(MOV_reg64_static)    GET_STATIC_FIELD(RegD) REGD(reg64)[code->static_reg.reg] = ((double*)sf)[0]; NEXT_OP
+      OPCODE(MOV_staticQ_regI)    ((int32*)   cp->boundSField[code->static_reg.sym])[0] = regI[code->static_reg.reg]; NEXT_OP
+      OPCODE(MOV_staticQ_regO)    ((TCObject*)cp->boundSField[code->static_reg.sym])[0] = regO[code->static_reg.reg]; NEXT_OP
+      OPCODE(MOV_staticQ_reg64)   ((double*)  cp->boundSField[code->static_reg.sym])[0] = REGD(reg64)[code->static_reg.reg]; NEXT_OP
+      OPCODE(MOV_regI_staticQ)    regI[code->static_reg.reg] = ((int32*)   cp->boundSField[code->static_reg.sym])[0]; NEXT_OP
+      OPCODE(MOV_regO_staticQ)    regO[code->static_reg.reg] = ((TCObject*)cp->boundSField[code->static_reg.sym])[0]; NEXT_OP
+      OPCODE(MOV_reg64_staticQ)   REGD(reg64)[code->static_reg.reg] = ((double*)  cp->boundSField[code->static_reg.sym])[0]; NEXT_OP
       OPCODE(ADD_regI_regI_regI)  regI[code->reg_reg_reg.reg0] = regI[code->reg_reg_reg.reg1] + regI[code->reg_reg_reg.reg2]; NEXT_OP
       OPCODE(ADD_regI_s12_regI)   regI[code->reg_reg_s12.reg0] = regI[code->reg_reg_s12.reg1] + (int32)code->reg_reg_s12.s12; NEXT_OP
       OPCODE(ADD_regD_regD_regD)  REGD(reg64)[code->reg_reg_reg.reg0] = REGD(reg64)[code->reg_reg_reg.reg1] + REGD(reg64)[code->reg_reg_reg.reg2]; NEXT_OP
@@ -478,12 +607,23 @@ mainLoop:
       OPCODE(JGE_regI_arlen)      if (regI[code->reg_arl_s12.regI]        >= (int32)ARRAYOBJ_LEN(regO[code->reg_arl_s12.base])) {code += (int32)code->reg_arl_s12.desloc; NEXT_OP0} NEXT_OP
       OPCODE(DECJGTZ_regI)        if (--regI[code->reg_desloc.reg]        >  0)                                                 {code += (int32)code->reg_desloc.desloc; NEXT_OP0} NEXT_OP
       OPCODE(DECJGEZ_regI)        if (--regI[code->reg_desloc.reg]        >= 0)                                                 {code += (int32)code->reg_desloc.desloc; NEXT_OP0} NEXT_OP
+      OPCODE(CALL_normalQ)
+         newMethod = cp->boundNormal[code->mtd.sym];
+         goto contCall;
       OPCODE(CALL_normal) // 33% of the calls
-         if ((newMethod = cp->boundNormal[code->mtd.sym]) != null) // note: there's no need to check here if this class is an interface because interface methods are never bound
+         if ((newMethod = cp->boundNormal[code->mtd.sym]) != null) // note: interface methods are never bound here
+         {
+            if (!disableQuickening)
+               quickenCall(code);
             goto contCall;
+         }
+         else
+         if (method->callSites != null && method->callSites[code - method->code] != null) // an interface call: it's bound in the inline cache of this call site, like a virtual one
+            goto interfaceCall;
          else
             goto notYetLinked;
       OPCODE(CALL_virtual) // 66% of the calls
+interfaceCall:
          if (regO[code->mtd.this_] == null)
          {     
             exceptionMsg = "On 'this' when calling a method";
@@ -496,11 +636,11 @@ mainLoop:
           debug("NULL CLASS OBJECT: %X", regO[code->mtd.this_]);
 			 goto throwNullPointerException;
 		 }
-         if ((macArray = cp->boundVirtualMethod[code->mtd.sym]) != null && // was the method ever linked?
-            (mac = macArray[thisClass->hash&15]) != null &&                // map to the hash position
-            mac->c == thisClass) // 90% of the cases
+         if ((ic = method->callSites ? method->callSites[code - method->code] : null) != null && // was this call site ever linked?
+            (mac = ic->entries[0]) != null && mac->c == thisClass) // monomorphic call: 90% of the cases
          {
             newMethod = mac->m;
+            if (icStatsOn) icHits++;
 contCall:
             regI  = context->regI; // same of regI += method->iCount
             regO  = context->regO;
@@ -629,6 +769,7 @@ noMoreParams:
                cp = class_->cp;
                method = newMethod;
                code = method->code;
+               JIT_ENTER
                NEXT_OP0
             }
             // no else here!
@@ -645,7 +786,19 @@ nativeMethodCall:
                nmp->obj = regO;
                nmp->i64 = reg64;
                nmp->retO = null;
+               if (IS_VMTWEAK_ON(VMTWEAK_INCREMENTAL_GC)) // the incremental gc doesn't wait for a thread that is running a native method
+                  context->inNative = true;
+               widened = context->widenedCount;
                newMethod->boundNM(nmp); // call the method
+               if (context->widenedCount != widened) // release the compact strings that the native widened
+                  releaseWidenedStrings(context, widened);
+               if (context->inNative)
+               {
+                  context->inNative = false;
+                  MEMORY_BARRIER(); // a cycle may have started: the next barriers must see it
+               }
+               if (incrementalMarking || IS_VMTWEAK_ON(VMTWEAK_GENERATIONAL_GC)) // the natives of older libraries store into their parameters without write barriers
+                  rememberNativeParams(nmp->obj, newMethod->oCount);
 popStackFrame:
                // There's no "return" instruction for native methods, so we must pop the frame here
                context->regI  -= newMethod->iCount;
@@ -713,33 +866,22 @@ popStackFrame:
          }
          else
          {
-            if (macArray == null) // have to create the array?
+            if (ic != null) // no locks here: the cache entries are only published after being filled
             {
-               IF_HEAP_ERROR(cp->heap)
-               {                            
-                  exceptionMsg = "When expanding MAC array";
-                  goto throwOutOfMemoryError;
-               }
-               macArray = cp->boundVirtualMethod[code->mtd.sym] = (MethodAndClass*)heapAlloc(cp->heap, TSIZE*16);
-               boundHead = &macArray[thisClass->hash&15];
-               goto notYetLinked;
-            }
-            LOCKVAR(metAndCls);
-            boundHead = &macArray[thisClass->hash&15];
-            for (last=mac, mac = mac ? mac->next : null; mac != null; last = mac, mac = mac->next)
-               if (mac->c == thisClass)
+               for (i = 1; i < INLINE_CACHE_SIZE && (mac = ic->entries[i]) != null; i++) // polymorphic call
+                  if (mac->c == thisClass)
+                  {
+                     newMethod = mac->m;
+                     if (icStatsOn) icHits++;
+                     goto contCall;
+                  }
+               if (ic->megamorphic && (newMethod = dispatchLookup(thisClass, cp, code->mtd.sym)) != null)
                {
-                  // move to front. increases first hit by 50%
-                  if (last)
-                     last->next = mac->next;
-                  mac->next = *boundHead;
-                  *boundHead = mac;
-                  // get the method's address and execute it.
-                  newMethod = mac->m;
-                  UNLOCKVAR(metAndCls);
+                  if (icStatsOn) icMegamorphic++;
                   goto contCall;
                }
-            UNLOCKVAR(metAndCls);
+            }
+            if (icStatsOn) icMisses++;
 notYetLinked:
             originalClassIsInterface = false;
             sym = cp->mtd[ code->mtd.sym ]; // virtual methods are directly referenced: mtd.sym is the index to an array that will point to the mtd table
@@ -791,15 +933,20 @@ notYetLinked:
                for (newMethod = c->methods, i = ARRAYLENV(c->methods); i-- > 0; newMethod++)
                   if (newMethod->hashName == hashName && newMethod->hashParams == hashParams && strEq(newMethod->name, methodName) && paramsEq(cp, sym, len, c->cp, newMethod->cpParams)) // guich@tc110_21: after the hashcode match, we must ensure that the names also match.
                   {
-                     if (!originalClassIsInterface && !newMethod->flags.isAbstract) // if the class is not an interface nor the method abstract, bind it
+                     if (!newMethod->flags.isAbstract) // if the method is not abstract, bind it
                      {
-                        if (code->op.op == CALL_virtual)
+                        if (newMethod->code == null && newMethod->body != null && !loadMethodBody(newMethod)) // all calls go through here before the method is bound
                         {
-                           MethodAndClass newMac = newXH(MethodAndClass, cp->heap);
-                           newMac->m = newMethod;
-                           newMac->c = OBJ_CLASS(regO[code->mtd.this_]);
-                           newMac->next = *boundHead;
-                           *boundHead = newMac;
+                           exceptionMsg = "When reading the method's body";
+                           goto throwOutOfMemoryError;
+                        }
+                        if (code->op.op == CALL_virtual || originalClassIsInterface) // interface methods depend on the instance's class too
+                        {
+                           if (!bindVirtualMethod(method, code, OBJ_CLASS(regO[code->mtd.this_]), newMethod))
+                           {
+                              exceptionMsg = "When binding a virtual method";
+                              goto throwOutOfMemoryError;
+                           }
                         }
                         else
                            cp->boundNormal[code->mtd.sym] = newMethod;
@@ -867,6 +1014,13 @@ resumePreviousMethod:
             cp = class_->cp;
             if (context->thrownException != null)
                goto handleException;
+#ifdef ENABLE_JIT
+            if (method->jit != null) // continue in the native code after the call
+            {
+               code = jitRun(context, method, regI, regO, reg64, code+1);
+               NEXT_OP0
+            }
+#endif
             NEXT_OP
          }
          goto finishMethod;
@@ -910,10 +1064,20 @@ resumePreviousMethod:
          }
          NEXT_OP0
       }
-      OPCODE(NEWARRAY_len)   if ((regO[code->newarray.regO] = createArrayObject(context, cp->cls[code->newarray.sym], code->newarray.lenOrRegIOrDims)) == null) {exceptionMsg = "When creating array with length"; goto throwOutOfMemoryError;} setObjectLock(regO[code->newarray.regO], UNLOCKED); NEXT_OP
-      OPCODE(NEWARRAY_regI)  if ((regO[code->newarray.regO] = createArrayObject(context, cp->cls[code->newarray.sym], regI[code->newarray.lenOrRegIOrDims])) == null) {exceptionMsg = "When creating array with register"; goto throwOutOfMemoryError;} setObjectLock(regO[code->newarray.regO], UNLOCKED); NEXT_OP
-      OPCODE(NEWARRAY_multi) if ((regO[code->newarray.regO] = createArrayObjectMulti(context, cp->cls[code->newarray.sym], code->newarray.lenOrRegIOrDims, (uint8*)(code+1), regI)) == null) {exceptionMsg = "When creating multiple arrays"; goto throwOutOfMemoryError;} setObjectLock(regO[code->newarray.regO], UNLOCKED); code += (code->newarray.lenOrRegIOrDims+3)>>2; NEXT_OP
-      OPCODE(NEWOBJ)         if ((regO[code->reg_sym.reg]   = createObjectWithoutCallingDefaultConstructor(context, cp->cls[code->reg_sym.sym])) == null) {exceptionMsg = "When creating object"; goto throwOutOfMemoryError;} setObjectLock(regO[code->reg_sym.reg], UNLOCKED); NEXT_OP // do not call default constructor
+      OPCODE(SWITCH_table) // switch (regI) with dense keys (from a tableswitch)
+      {
+         // same format of SWITCH, but the keys are consecutive: the first one is the minimum and the n-th is the maximum,
+         // so the address is taken directly from the value-array
+         int32 n = code->switch_reg.n;
+         uint32 idx = (uint32)(regI[code->switch_reg.key] - code[2].i32.i32); // keys below the minimum become big unsigned numbers
+         uint16* addrTable = (uint16*)(code+2+n);
+         code += idx < (uint32)n ? (int32)addrTable[idx] : (int32)code[1].two16.v1;
+         NEXT_OP0
+      }
+      OPCODE(NEWARRAY_len)   SAVE_PC if ((regO[code->newarray.regO] = createArrayObject(context, cp->cls[code->newarray.sym], code->newarray.lenOrRegIOrDims)) == null) {exceptionMsg = "When creating array with length"; goto throwOutOfMemoryError;} setObjectLock(regO[code->newarray.regO], UNLOCKED); NEXT_OP
+      OPCODE(NEWARRAY_regI)  SAVE_PC if ((regO[code->newarray.regO] = createArrayObject(context, cp->cls[code->newarray.sym], regI[code->newarray.lenOrRegIOrDims])) == null) {exceptionMsg = "When creating array with register"; goto throwOutOfMemoryError;} setObjectLock(regO[code->newarray.regO], UNLOCKED); NEXT_OP
+      OPCODE(NEWARRAY_multi) SAVE_PC if ((regO[code->newarray.regO] = createArrayObjectMulti(context, cp->cls[code->newarray.sym], code->newarray.lenOrRegIOrDims, (uint8*)(code+1), regI)) == null) {exceptionMsg = "When creating multiple arrays"; goto throwOutOfMemoryError;} setObjectLock(regO[code->newarray.regO], UNLOCKED); code += (code->newarray.lenOrRegIOrDims+3)>>2; NEXT_OP
+      OPCODE(NEWOBJ)         SAVE_PC if ((regO[code->reg_sym.reg]   = createObjectWithoutCallingDefaultConstructor(context, cp->cls[code->reg_sym.sym])) == null) {exceptionMsg = "When creating object"; goto throwOutOfMemoryError;} setObjectLock(regO[code->reg_sym.reg], UNLOCKED); NEXT_OP // do not call default constructor
       OPCODE(THROW)
          context->thrownException = regO[code->reg_reg.reg0];
 #ifdef ENABLE_TRACE
@@ -955,7 +1119,7 @@ handleException:
          o = regO[code->instanceof.regO];
          if (o != null) // if the object being compared is not null...
          {
-            result = OBJ_CLASS(o)->name == cp->cls[code->instanceof.sym] ? COMPATIBLE : areClassesCompatible(context, OBJ_CLASS(o),cp->cls[code->instanceof.sym]); // quick check - will work almost all the times
+            result = (OBJ_CLASS(o)->name == cp->cls[code->instanceof.sym] || OBJ_CLASS(o) == cp->instanceOfCache[code->instanceof.sym]) ? COMPATIBLE : isInstanceOf(context, OBJ_CLASS(o), cp, code->instanceof.sym); // quick check - will work almost all the times
             if (result == TARGET_CLASS_NOT_FOUND)
             {
                className = cp->cls[code->instanceof.sym];
@@ -985,9 +1149,9 @@ handleException:
          if (o == null) {exceptionMsg = "On synchronized object's enter"; goto throwNullPointerException;}
          if (OBJ_CLASS(o) != lockClass) // check for totalcross.util.concurrent.Lock
          {            
-            if (!lockMutex((size_t)o))
+            if (!monitorEnter(context, o))
             {
-               exceptionMsg = "When locking mutex";
+               exceptionMsg = "When inflating monitor";
                goto throwOutOfMemoryError;         
             }     
          }
@@ -1009,7 +1173,7 @@ handleException:
             o = cp->str[code->reg_reg.reg0];
          if (o == null) {exceptionMsg = "On synchronized object's exit"; goto throwNullPointerException;}
          if (OBJ_CLASS(o) != lockClass) // check for totalcross.util.concurrent.Lock
-            unlockMutex((size_t)o);
+            monitorExit(context, o);
          else
          {   
             TCObject mutex = Lock_mutex(o);
@@ -1109,6 +1273,7 @@ finishMethod:
    }
 #endif
 
+   context->inNative = wasInNative;
    // We are finished with this context, so decrement usage count (and release it, if we are not using it anymore)
    LOCKVAR(context->usageLock);
    if (--context->usageCount == 0)
@@ -136,6 +136,10 @@
 #include "utils.h"
 #include "debug.h"
 #include "objectmemorymanager.h"
+#include "jit.h"
+#include "snapshot.h"
+#include "preload.h"
+#include "profiler.h"
 #include "tcclass.h"
 #include "../tests/tc_testsuite.h"
 #include "../nm/instancefields.h"
@@ -292,15 +292,17 @@ static TMethod testMethod;
 
 static Method initMethod(Context currentContext, int op)
 {
-   static TCode code[30];
+   static Code code; // an array, like the loaded ones, since the inline caches are sized by its length
    if (!testTypesInstance)
    {
       testTypesInstance = newTestTypesInstance(currentContext);
       if (testTypesInstance == null)
          return null;
    }
+   if (code == null && (code = newArrayOf(Code, 30, null)) == null)
+      return null;
 
-   xmemzero(code, sizeof(code)); // fill code with BREAKs (0)
+   xmemzero(code, 30*sizeof(TCode)); // fill code with BREAKs (0)
    xmemzero(currentContext->regIStart, STARTING_REGI_SIZE*sizeof(currentContext->regI[0]));
    xmemzero(currentContext->reg64Start,STARTING_REG64_SIZE*sizeof(currentContext->reg64[0]));
    xmemzero(currentContext->regOStart, STARTING_REGO_SIZE*sizeof(currentContext->regO[0]));
@@ -311,6 +313,7 @@ static Method initMethod(Context currentContext, int op)
    testMethod.flags.isStatic = true;
    testMethod.class_ = testTypesClass;
    testMethod.code = code;
+   testMethod.callSites = null; // each test binds its own calls at the same instructions
    return &testMethod;
 }
 
@@ -756,6 +759,12 @@ TESTCASE(VM_MOV_regI_field) // #DEPENDS(VM_MOV_field_regI)
    executeMethod(currentContext, m);
    ASSERT1_EQUALS(Null, currentContext->thrownException);
    ASSERT2_EQUALS(I32, currentContext->regI[0], INT32_TEST_VALUE);
+   // the resolved instruction must have been quickened, and give the same result
+   ASSERT2_EQUALS(I32, m->code[0].op.op, MOV_regI_fieldQ);
+   currentContext->regI[0] = 0;
+   executeMethod(currentContext, m);
+   ASSERT1_EQUALS(Null, currentContext->thrownException);
+   ASSERT2_EQUALS(I32, currentContext->regI[0], INT32_TEST_VALUE);
 finish: ;
 }
 TESTCASE(VM_MOV_regO_field) // #DEPENDS(VM_MOV_field_regO)
@@ -780,6 +789,7 @@ TESTCASE(VM_MOV_reg64_field) // #DEPENDS(VM_MOV_field_reg64)
    ASSERT2_EQUALS(Dbl, REGD(currentContext->reg64)[0], DOUBLE_TEST_VALUE);
 
    // long
+   m = initMethod(currentContext,MOV_reg64_field); // the first execution quickened the instruction
    ext = initExtTest(currentContext, tc,m,RegL,false);
    if (!ext) {TEST_OUTPUT_SOURCELINE; goto finish;}
    executeMethod(currentContext, m);
@@ -840,6 +850,12 @@ TESTCASE(VM_MOV_regI_static)
    executeMethod(currentContext, m);
    ASSERT1_EQUALS(Null, currentContext->thrownException);
    ASSERT2_EQUALS(I32, currentContext->regI[0], INT32_TEST_VALUE);
+   // the bound instruction must have been quickened, and give the same result
+   ASSERT2_EQUALS(I32, m->code[0].op.op, MOV_regI_staticQ);
+   currentContext->regI[0] = 0;
+   executeMethod(currentContext, m);
+   ASSERT1_EQUALS(Null, currentContext->thrownException);
+   ASSERT2_EQUALS(I32, currentContext->regI[0], INT32_TEST_VALUE);
 finish: ;
 }
 TESTCASE(VM_MOV_regO_static) // #DEPENDS(VM_MOV_static_regO)
@@ -2599,7 +2615,7 @@ TC_API void TT_print_s(NMParams p)
    if (str && String_charsLen(str) == 7) // Barbara
    {
       char text[8];
-      JCharP2CharPBuf(String_charsStart(str), 7, text);
+      String2CharPBuf(str, text);
       p->retI = strEq(text,"Barbara");
    }
    else ttprintRes = String2CharP(str);
@@ -2664,6 +2680,167 @@ finish:
    m->iCount = m->oCount = 0;
 #endif
 }
+// The inline cache tests use a constant pool of their own, so the symbols bound here don't leak to the test classes
+#define IC_TEST_CLASSES 6
+#define IC_TEST_SUPER (IC_TEST_CLASSES)
+static TMethod icTestMethods[IC_TEST_CLASSES+1];
+static TConstantPool icTestCP;
+static TTCClass icTestClass;
+static TMethod icTestCaller; // keeps its inline caches between the calls, unlike the method of initMethod
+
+static void icTestNative(NMParams p) // returns the index of the method being run
+{
+   p->retI = (int32)((Method)p->currentContext->callStack[-2] - icTestMethods);
+}
+
+#define IC_TEST_CODE_LEN 8
+
+static bool icTestBind(int32 site, int32 sym, TCClass c, Method m)
+{
+   icTestCaller.code[site].mtd.sym = sym;
+   return bindVirtualMethod(&icTestCaller, &icTestCaller.code[site], c, m);
+}
+
+static int32 icTestCall(Context currentContext, int32 site, int32 op, int32 sym, TCObject instance) // calls the symbol from the instruction at site, an odd index
+{
+   Code code = icTestCaller.code;
+   initMethod(currentContext, BREAK); // clears the registers
+   xmemzero(code, IC_TEST_CODE_LEN*sizeof(TCode));
+   code[0].s24.op = JUMP_s24;
+   code[0].s24.desloc = site;
+   code[site].mtd.op = op;
+   code[site].mtd.sym = sym;
+   code[site].mtd.this_ = 2; // the called methods use regO[0], so "this" can't be there
+   code[site].mtd.retOr1stParam = 1; // return in regI[1]
+   currentContext->regO[2] = instance;
+   currentContext->regI[1] = -1;
+   executeMethod(currentContext, &icTestCaller);
+   return currentContext->thrownException != null ? -2 : currentContext->regI[1];
+}
+
+TESTCASE(VM_z7_CALL_inlineCache)
+{
+   static CharP classNames[IC_TEST_CLASSES] = {"java.lang.Object", "java.lang.StringBuffer", "java.lang.Throwable", "totalcross.util.Vector", "totalcross.util.Hashtable", "totalcross.sys.Time"};
+   static CharP cls[2] = {null, "java.lang.Object"};
+   static CharP mtdfld[2] = {null, "nativeHashCode"};
+   static uint16 superSym[2] = {1, 1};
+   static UInt16Array mtd[4] = {null, null, null, superSym};
+   static uint8 mtdLens[4];
+   static int32 hashNames[4], hashParams[4];
+   static Method boundNormal[4];
+   TCObject instances[IC_TEST_CLASSES];
+   TCClass classes[IC_TEST_CLASSES];
+   Method nativeHashCode;
+   InlineCache ic;
+   int32 i, hits = icHits, misses = icMisses;
+   bool stats = icStatsOn;
+
+   xmemzero(instances, sizeof(instances));
+   icStatsOn = true;
+   tzero(icTestCP);
+   icTestClass = *testTypesClass;
+   icTestClass.cp = &icTestCP;
+   icTestCP.mtdCount = 4;
+   icTestCP.cls = cls;
+   icTestCP.mtdfld = mtdfld;
+   icTestCP.mtd = mtd;
+   icTestCP.mtdLens = mtdLens;
+   icTestCP.hashNames = hashNames;
+   icTestCP.hashParams = hashParams;
+   icTestCP.boundNormal = boundNormal;
+   xmemzero(boundNormal, sizeof(boundNormal));
+   icTestCP.heap = heapCreate();
+   IF_HEAP_ERROR(icTestCP.heap)
+   {
+      heapDestroy(icTestCP.heap);
+      icTestCP.heap = null;
+      TEST_CANNOT_RUN;
+   }
+   tzero(icTestCaller);
+   icTestCaller.flags.isStatic = true;
+   icTestCaller.class_ = &icTestClass;
+   icTestCaller.code = newArrayOf(Code, IC_TEST_CODE_LEN, icTestCP.heap);
+   for (i = 0; i < IC_TEST_CLASSES; i++)
+   {
+      instances[i] = createObject(currentContext, classNames[i]);
+      ASSERT1_EQUALS(NotNull, instances[i]);
+      classes[i] = OBJ_CLASS(instances[i]);
+   }
+   for (i = 0; i <= IC_TEST_CLASSES; i++)
+   {
+      tzero(icTestMethods[i]);
+      icTestMethods[i].name = "icTest";
+      icTestMethods[i].flags.isNative = true;
+      icTestMethods[i].boundNM = icTestNative;
+      icTestMethods[i].cpReturn = 1;
+      icTestMethods[i].returnReg = RegI;
+      icTestMethods[i].oCount = 1;
+      icTestMethods[i].class_ = classes[i < IC_TEST_CLASSES ? i : 1];
+   }
+
+   ASSERT1_EQUALS(NotNull, icTestCaller.code);
+   // 1. monomorphic: the first entry of the inline cache
+   ASSERT1_EQUALS(True, icTestBind(1, 1, classes[0], &icTestMethods[0]));
+   ASSERT2_EQUALS(I32, icTestCall(currentContext, 1, CALL_virtual, 1, instances[0]), 0);
+   ASSERT2_EQUALS(I32, icHits, hits+1);
+   // 2. polymorphic: the other entries, up to INLINE_CACHE_SIZE classes
+   for (i = 1; i < INLINE_CACHE_SIZE; i++)
+      ASSERT1_EQUALS(True, icTestBind(1, 1, classes[i], &icTestMethods[i]));
+   ic = icTestCaller.callSites[1];
+   ASSERT1_EQUALS(False, ic->megamorphic);
+   for (i = 0; i < INLINE_CACHE_SIZE; i++)
+      ASSERT2_EQUALS(I32, icTestCall(currentContext, 1, CALL_virtual, 1, instances[i]), i);
+   // 3. megamorphic: the classes that don't fit in the cache go to their dispatch tables
+   for (i = INLINE_CACHE_SIZE; i < IC_TEST_CLASSES; i++)
+   {
+      ASSERT1_EQUALS(True, icTestBind(1, 1, classes[i], &icTestMethods[i]));
+      ASSERT2_EQUALS(Ptr, dispatchLookup(classes[i], &icTestCP, 1), &icTestMethods[i]);
+   }
+   ASSERT1_EQUALS(True, ic->megamorphic);
+   ASSERT1_EQUALS(Null, dispatchLookup(classes[0], &icTestCP, 1)); // still in the cache
+   for (i = 0; i < IC_TEST_CLASSES; i++)
+      ASSERT2_EQUALS(I32, icTestCall(currentContext, 1, CALL_virtual, 1, instances[i]), i);
+   ASSERT2_EQUALS(I32, icMisses, misses);
+   // 4. another call site of the same symbol has a cache of its own, so the classes of the first one don't evict its class
+   ASSERT1_EQUALS(Null, icTestCaller.callSites[3]);
+   ASSERT1_EQUALS(True, icTestBind(3, 1, classes[IC_TEST_CLASSES-1], &icTestMethods[IC_TEST_CLASSES-1]));
+   ASSERT1_EQUALS(False, icTestCaller.callSites[3]->megamorphic);
+   ASSERT2_EQUALS(Ptr, icTestCaller.callSites[3]->entries[0]->c, classes[IC_TEST_CLASSES-1]);
+   hits = icHits;
+   ASSERT2_EQUALS(I32, icTestCall(currentContext, 3, CALL_virtual, 1, instances[IC_TEST_CLASSES-1]), IC_TEST_CLASSES-1);
+   ASSERT2_EQUALS(I32, icHits, hits+1); // a hit in the first entry, while the first call site is megamorphic
+   // 5. an interface call site: CALL_normal dispatches it by the instance's class
+   ASSERT1_EQUALS(True, icTestBind(5, 2, classes[0], &icTestMethods[0]));
+   ASSERT1_EQUALS(True, icTestBind(5, 2, classes[1], &icTestMethods[1]));
+   ASSERT2_EQUALS(I32, icTestCall(currentContext, 5, CALL_normal, 2, instances[1]), 1);
+   ASSERT2_EQUALS(I32, icTestCall(currentContext, 5, CALL_normal, 2, instances[0]), 0);
+   // 6. a super call on a symbol that a virtual call already bound must not be dispatched by the instance's class
+   nativeHashCode = getMethod(classes[0], false, "nativeHashCode", 0);
+   ASSERT1_EQUALS(NotNull, nativeHashCode);
+   hashNames[3] = nativeHashCode->hashName;
+   hashParams[3] = nativeHashCode->hashParams;
+   ASSERT1_EQUALS(True, icTestBind(3, 3, classes[1], &icTestMethods[IC_TEST_SUPER])); // the override in StringBuffer
+   ASSERT2_EQUALS(I32, icTestCall(currentContext, 3, CALL_virtual, 3, instances[1]), IC_TEST_SUPER);
+   i = icTestCall(currentContext, 7, CALL_normal, 3, instances[1]); // super.nativeHashCode()
+   ASSERT2_EQUALS(Ptr, boundNormal[3], nativeHashCode);
+   ASSERT1_EQUALS(True, i != IC_TEST_SUPER && i != -2);
+   // 7. once bound, the CALL_normal is quickened and calls the same method
+   ASSERT2_EQUALS(I32, icTestCall(currentContext, 7, CALL_normal, 3, instances[1]), i);
+   ASSERT2_EQUALS(I32, icTestCaller.code[7].op.op, CALL_normalQ);
+   currentContext->regI[1] = -1;
+   executeMethod(currentContext, &icTestCaller);
+   ASSERT2_EQUALS(I32, currentContext->regI[1], i);
+finish:
+   icStatsOn = stats;
+   currentContext->thrownException = null;
+   for (i = 0; i < IC_TEST_CLASSES; i++)
+      if (instances[i] != null)
+         setObjectLock(instances[i], UNLOCKED);
+   if (icTestCP.heap != null)
+      heapDestroy(icTestCP.heap);
+   icTestCP.heap = null;
+   tzero(icTestCaller); // its code and caches were in the heap
+}
 TESTCASE(VM_NEWARRAY_len)
 {
    Method m = initMethod(currentContext,NEWARRAY_len);
@@ -2840,6 +3017,17 @@ TESTCASE(VM_INSTANCEOF) // if (other instanceof Rect) -> mov regI, regO instance
    executeMethod(currentContext, m);
    ASSERT1_EQUALS(Null, currentContext->thrownException);
    ASSERT2_EQUALS(I32, currentContext->regI[0], 0);
+   // ordinary object: the target class is bound at the first check and the next ones use the supertype display
+   currentContext->regO[1] = testTypesInstance;
+   m->code[0].instanceof.sym = getIndexInCP(testTypesClass->cp, "java.lang.Object");
+   testTypesClass->cp->instanceOfCache[m->code[0].instanceof.sym] = null;
+   executeMethod(currentContext, m);
+   ASSERT1_EQUALS(Null, currentContext->thrownException);
+   ASSERT2_EQUALS(I32, currentContext->regI[0], 1);
+   ASSERT1_EQUALS(NotNull, testTypesClass->cp->boundClass[m->code[0].instanceof.sym]);
+   ASSERT2_EQUALS(Ptr, testTypesClass->cp->instanceOfCache[m->code[0].instanceof.sym], testTypesClass);
+   ASSERT1_EQUALS(True, isSubtypeOf(testTypesClass, testTypesClass->cp->boundClass[m->code[0].instanceof.sym]));
+   ASSERT1_EQUALS(False, isSubtypeOf(testTypesClass->cp->boundClass[m->code[0].instanceof.sym], testTypesClass));
 finish: ;
 }
 TESTCASE(VM_CHECKCAST) // PenEvent pe = (PenEvent)event; -> checkcast event, PenEvent; mov pe, event;
@@ -2926,7 +3114,7 @@ TESTCASE(VM_SWITCH)
    21: goto finish;
    22: (finish) - next opcode
    */
-   int32 base = 1, exit = 22;
+   int32 base = 1, exit = 22, i;
    Method m = initMethod(currentContext,SWITCH);
    m->code[0].s18_reg.op = MOV_regI_s18;
    m->code[0].s18_reg.reg = 0;
@@ -3008,6 +3196,24 @@ TESTCASE(VM_SWITCH)
    executeMethod(currentContext, m);
    ASSERT2_EQUALS(I32, currentContext->regI[0], -1);
 
+   // the keys are dense, so the same table can be used by the jump-table version
+   m->code[1].switch_reg.op = SWITCH_table;
+   for (i = 1; i <= 5; i++)
+   {
+      currentContext->regI[1] = i;
+      executeMethod(currentContext, m);
+      ASSERT2_EQUALS(I32, currentContext->regI[0], i);
+   }
+   currentContext->regI[1] = 0;
+   executeMethod(currentContext, m);
+   ASSERT2_EQUALS(I32, currentContext->regI[0], -1);
+   currentContext->regI[1] = 6;
+   executeMethod(currentContext, m);
+   ASSERT2_EQUALS(I32, currentContext->regI[0], -1);
+   currentContext->regI[1] = 0x80000000; // the difference to the minimum overflows
+   executeMethod(currentContext, m);
+   ASSERT2_EQUALS(I32, currentContext->regI[0], -1);
+
 finish: ;
 }
 TESTCASE(VM_TEST_regO)
@@ -3073,3 +3279,55 @@ TESTCASE(VM_DECJGEZ_regI) // if (--x >= 0) goto ....
    ASSERT2_EQUALS(Ptr, m->code+1, currentContext->code);
 finish: ;
 }
+TESTCASE(VM_z9_JIT) // #DEPENDS(VM_LoadTestTCZ)
+{
+#ifdef ENABLE_JIT
+   TMethod m;
+   Code code = newArrayOf(Code, 8, null);
+   TCObject arr = createArrayObject(currentContext, INT_ARRAY, 100);
+   int32 i, *a;
+   xmemzero(&m, sizeof(m));
+   if (!code || !arr) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   m.class_ = testTypesClass;
+   m.code = code;
+   m.flags.isStatic = true;
+   a = (int32*)ARRAYOBJ_START(arr);
+   for (i = 0; i < 100; i++)
+      a[i] = i*3 - 7;
+   // sum = 0; for (i = 0; i < array.length; i++) sum += array[i];
+   code[0].s18_reg.op = MOV_regI_s18;       code[0].s18_reg.reg = 1; code[0].s18_reg.s18 = 0;
+   code[1].s18_reg.op = MOV_regI_s18;       code[1].s18_reg.reg = 0; code[1].s18_reg.s18 = 0;
+   code[2].reg_arl_s12.op = JGE_regI_arlen; code[2].reg_arl_s12.regI = 0; code[2].reg_arl_s12.base = 0; code[2].reg_arl_s12.desloc = 5;
+   code[3].reg_ar.op = MOV_regI_arc;        code[3].reg_ar.reg = 2; code[3].reg_ar.base = 0; code[3].reg_ar.idx = 0;
+   code[4].reg_reg_reg.op = ADD_regI_regI_regI; code[4].reg_reg_reg.reg0 = 1; code[4].reg_reg_reg.reg1 = 1; code[4].reg_reg_reg.reg2 = 2;
+   code[5].inc.op = INC_regI;               code[5].inc.reg = 0; code[5].inc.s16 = 1;
+   code[6].s24.op = JUMP_s24;               code[6].s24.desloc = -4;
+   code[7].op.op = BREAK; // not compiled: the native code returns to the interpreter here
+   jitCompile(&m, 0);
+   ASSERT1_EQUALS(NotNull, m.jit);
+   currentContext->regO[0] = arr;
+   ASSERT2_EQUALS(Ptr, code+7, jitRun(currentContext, &m, currentContext->regI, currentContext->regO, currentContext->reg64, code));
+   ASSERT2_EQUALS(I32, currentContext->regI[1], 3*4950 - 7*100);
+   // the back-edge must reach the safepoint and the profiler, and then continue the loop in the native code
+   currentContext->gcEpoch = gcEpoch - 1;
+   currentContext->profilerTick = profilerTick - 1;
+   ASSERT2_EQUALS(Ptr, code+7, jitRun(currentContext, &m, currentContext->regI, currentContext->regO, currentContext->reg64, code));
+   ASSERT2_EQUALS(I32, currentContext->regI[1], 3*4950 - 7*100);
+   ASSERT2_EQUALS(I32, currentContext->gcEpoch, gcEpoch);
+   ASSERT2_EQUALS(I32, currentContext->profilerTick, profilerTick);
+   // the native code must give the instruction back to the interpreter when it throws an exception
+   currentContext->regO[0] = null;
+   ASSERT2_EQUALS(Ptr, code+2, jitRun(currentContext, &m, currentContext->regI, currentContext->regO, currentContext->reg64, code));
+   currentContext->regO[0] = arr;
+   code[2].reg_arl_s12.desloc = 1; // force an index out of bounds
+   jitFree(&m);
+   jitCompile(&m, 0);
+   currentContext->regI[0] = 100;
+   ASSERT2_EQUALS(Ptr, code+3, jitRun(currentContext, &m, currentContext->regI, currentContext->regO, currentContext->reg64, code+3));
+finish:
+   jitFree(&m);
+   freeArray(code);
+   if (arr)
+      setObjectLock(arr, UNLOCKED);
+#endif
+}
@@ -44,3 +44,57 @@ DWORD WINAPI privateThreadFunc(VoidP argP)
    executeThreadRun(targs->context, targs->threadObject);
    return (DWORD)0;
 }
+
+static DWORD WINAPI privateParallelThreadFunc(VoidP argP)
+{
+   TParallelArgs* args = (TParallelArgs*)argP;
+   args->f(args->index, args->arg);
+   return (DWORD)0;
+}
+
+static bool privateParallelThreadCreate(ThreadHandle* h, TParallelArgs* args)
+{
+   *h = CreateThread(NULL, 0, privateParallelThreadFunc, args, 0, NULL);
+   return *h != null;
+}
+
+static void privateParallelThreadJoin(ThreadHandle h)
+{
+   WaitForSingleObject(h, INFINITE);
+   CloseHandle(h);
+}
+
+static int32 privateGetProcessorCount()
+{
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwNumberOfProcessors > 0 ? (int32)info.dwNumberOfProcessors : 1;
+}
+
+static void privateThreadPermitInit(TThreadPermit* p)
+{
+#ifdef WP8
+   *p = CreateEventEx(NULL, NULL, 0, EVENT_ALL_ACCESS);
+#else
+   *p = CreateEvent(NULL, FALSE, FALSE, NULL);
+#endif
+}
+
+static void privateThreadPermitDestroy(TThreadPermit* p)
+{
+   CloseHandle(*p);
+}
+
+static bool privateThreadPermitPark(TThreadPermit* p, int32 millis)
+{
+#ifdef WP8
+   return WaitForSingleObjectEx(*p, millis, FALSE) == WAIT_OBJECT_0;
+#else
+   return WaitForSingleObject(*p, millis) == WAIT_OBJECT_0;
+#endif
+}
+
+static void privateThreadPermitUnpark(TThreadPermit* p)
+{
+   SetEvent(*p);
+}
@@ -0,0 +1,345 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+
+
+// Interpreter microbenchmarks. Each one runs a small loop of hand-made instructions twice:
+// first with the quickening disabled (so every execution goes through the generic, symbol-based
+// path), and then with it enabled (the instructions are rewritten into the quick versions and
+// superinstructions). Must run after VM_LoadTestTCZ, since they use the TestExt class.
+// The string benchmarks run the JCharP functions with the portable kernels and then with the
+// vectorized ones selected for this processor, for strings from 8 bytes to 64 KB. The hashtable
+// benchmarks compare the chained Hashtable, keyed by the hash alone, with the KeyHashtable.
+// The pixel benchmark renders frames of a scrolling list to an offscreen buffer with the portable
+// and the vectorized pixel kernels, which works in the headless builds, where Skia does the drawing.
+
+#include "tcvm.h"
+#include "jcharsimd.h"
+#include "../nm/ui/pixelsimd.h"
+
+#ifdef ENABLE_TEST_SUITE
+
+#define BENCH_LOOPS 2000000
+#define BENCH_INT_FIELD 1 // cp symbol of TestExt.i in the test class
+
+extern TCClass testTypesClass; // tcvm/tcvm_test.h
+
+static TMethod benchMethod;
+static TCode benchCode[8];
+
+static Method initBenchMethod(Context currentContext)
+{
+   xmemzero(benchCode, sizeof(benchCode)); // fill code with BREAKs (0)
+   xmemzero(&benchMethod, sizeof(benchMethod));
+   benchMethod.flags.isStatic = true;
+   benchMethod.class_ = testTypesClass;
+   benchMethod.code = benchCode;
+   currentContext->thrownException = null;
+   return &benchMethod;
+}
+
+static int32 runBench(Context currentContext, Method m, TCObject o, bool optimized) // returns the elapsed time in microseconds
+{
+   TCode original[8];
+   int64 ini;
+   xmemmove(original, m->code, sizeof(original)); // the quickening changes the code, so restore it at the end
+   disableQuickening = !optimized;
+   currentContext->regO[1] = o;
+   currentContext->regO[2] = o;
+   currentContext->regI[0] = BENCH_LOOPS;
+   currentContext->regI[2] = 0;
+   ini = getTimeStampMicro();
+   executeMethod(currentContext, m);
+   ini = getTimeStampMicro() - ini;
+   disableQuickening = false;
+   xmemmove(m->code, original, sizeof(original));
+   return (int32)ini;
+}
+
+#define RUN_BENCH(name, o)                                                                          \
+   {                                                                                               \
+      int32 unoptimized = runBench(currentContext, m, o, false);                                   \
+      int32 optimized = runBench(currentContext, m, o, true);                                      \
+      ASSERT1_EQUALS(Null, currentContext->thrownException);                                       \
+      TEST_OUTPUT(tc, "B %s: %d us unoptimized, %d us optimized\n", name, (int)unoptimized, (int)optimized); \
+   }
+
+TESTCASE(VM_z8_Bench_field) // #DEPENDS(VM_LoadTestTCZ)
+{
+   Method m = initBenchMethod(currentContext);
+   TCObject ext = createObject(currentContext, "TestExt");
+   if (!ext) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   FIELD_I32(ext, 0) = 1;
+   // loop: regI[1] = regO[2].i; if (--regI[0] > 0) goto loop
+   m->code[0].field_reg.op = MOV_regI_field;
+   m->code[0].field_reg.sym = BENCH_INT_FIELD;
+   m->code[0].field_reg.this_ = 2;
+   m->code[0].field_reg.reg = 1;
+   m->code[1].reg_desloc.op = DECJGTZ_regI;
+   m->code[1].reg_desloc.reg = 0;
+   m->code[1].reg_desloc.desloc = -1;
+   RUN_BENCH("field load", ext)
+   setObjectLock(ext, UNLOCKED);
+finish: ;
+}
+TESTCASE(VM_z8_Bench_field_branch) // #DEPENDS(VM_LoadTestTCZ)
+{
+   Method m = initBenchMethod(currentContext);
+   TCObject ext = createObject(currentContext, "TestExt");
+   if (!ext) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   FIELD_I32(ext, 0) = 1;
+   // loop: regI[1] = regO[2].i; if (regI[1] == 0) break; if (--regI[0] > 0) goto loop
+   m->code[0].field_reg.op = MOV_regI_field;
+   m->code[0].field_reg.sym = BENCH_INT_FIELD;
+   m->code[0].field_reg.this_ = 2;
+   m->code[0].field_reg.reg = 1;
+   m->code[1].reg_s6_desloc.op = JEQ_regI_s6;
+   m->code[1].reg_s6_desloc.reg = 1;
+   m->code[1].reg_s6_desloc.s6 = 0;
+   m->code[1].reg_s6_desloc.desloc = 2;
+   m->code[2].reg_desloc.op = DECJGTZ_regI;
+   m->code[2].reg_desloc.reg = 0;
+   m->code[2].reg_desloc.desloc = -2;
+   RUN_BENCH("field load + branch", ext)
+   setObjectLock(ext, UNLOCKED);
+finish: ;
+}
+TESTCASE(VM_z8_Bench_array_inc) // #DEPENDS(VM_LoadTestTCZ)
+{
+   Method m = initBenchMethod(currentContext);
+   TCObject arr = createArrayObject(currentContext, INT_ARRAY, 4);
+   if (!arr) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   // loop: regI[1] = regO[1][regI[2]]; regI[3]++; if (--regI[0] > 0) goto loop
+   m->code[0].reg_ar.op = MOV_regI_arc;
+   m->code[0].reg_ar.base = 1;
+   m->code[0].reg_ar.idx = 2;
+   m->code[0].reg_ar.reg = 1;
+   m->code[1].inc.op = INC_regI;
+   m->code[1].inc.reg = 3;
+   m->code[1].inc.s16 = 1;
+   m->code[2].reg_desloc.op = DECJGTZ_regI;
+   m->code[2].reg_desloc.reg = 0;
+   m->code[2].reg_desloc.desloc = -2;
+   RUN_BENCH("array load + increment", arr)
+   setObjectLock(arr, UNLOCKED);
+finish: ;
+}
+
+#define STRING_BENCH_BYTES (1024*1024) // each operation processes about this amount of chars per run
+
+typedef int32 (*StringBenchFunc)(JCharP a, JCharP b, int32 len);
+
+static int32 benchEquals(JCharP a, JCharP b, int32 len)   {return JCharPEqualsJCharP(a, b, len, len);}
+static int32 benchCompare(JCharP a, JCharP b, int32 len)  {return JCharPCompareToJCharP(a, b, len, len);}
+static int32 benchIndexOf(JCharP a, JCharP b, int32 len)  {UNUSED(b); return JCharPIndexOfJChar(a, '#', 0, len);}
+static int32 benchFind(JCharP a, JCharP b, int32 len)     {return JCharPIndexOfJCharP(a, b + len - 4, 0, len, 4);}
+static int32 benchHash(JCharP a, JCharP b, int32 len)     {UNUSED(b); return JCharPHashCode(a, len);}
+static int32 benchToUpper(JCharP a, JCharP b, int32 len)  {JCharPToUpper(b, a, len); return b[len-1];}
+
+static int32 runStringBench(StringBenchFunc f, JCharP a, JCharP b, int32 len, int32* result) // returns the elapsed time in microseconds
+{
+   int32 loops = STRING_BENCH_BYTES / (len * 2), r = 0;
+   int64 ini = getTimeStampMicro();
+   while (loops-- > 0)
+      r += f(a, b, len);
+   *result = r;
+   return (int32)(getTimeStampMicro() - ini);
+}
+
+TESTCASE(VM_z8_Bench_strings)
+{
+   static struct {CharP name; StringBenchFunc f;} ops[] =
+   {
+      {"equals", benchEquals}, {"compareTo", benchCompare}, {"indexOf char", benchIndexOf},
+      {"indexOf string", benchFind}, {"hashCode", benchHash}, {"toUpperCase", benchToUpper}
+   };
+   static int32 sizes[] = {8, 64, 512, 4096, 65536}; // in bytes
+   int32 len, i, op, size;
+   JCharP a = (JCharP)xmalloc(65536), b = (JCharP)xmalloc(65536);
+   if (!a || !b) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   for (size = 0; size < (int32)(sizeof(sizes)/sizeof(sizes[0])); size++)
+   {
+      len = sizes[size] / 2;
+      for (i = 0; i < len; i++)
+         a[i] = (JChar)('a' + (i * 7) % 23); // '#' is never found and the last 4 chars only occur at the end
+      a[len-4] = 'Z'; a[len-3] = 'Y'; a[len-2] = 'X'; a[len-1] = 'W';
+      for (op = 0; op < (int32)(sizeof(ops)/sizeof(ops[0])); op++)
+      {
+         int32 portable, simd, r1, r2;
+         xmemmove(b, a, len * 2);
+         initJCharKernels(false);
+         portable = runStringBench(ops[op].f, a, b, len, &r1);
+         xmemmove(b, a, len * 2);
+         initJCharKernels(true);
+         simd = runStringBench(ops[op].f, a, b, len, &r2);
+         ASSERT2_EQUALS(I32, r1, r2);
+         TEST_OUTPUT(tc, "B strings %s %d bytes: %d us portable, %d us %s\n", ops[op].name, (int)(len * 2), (int)portable, (int)simd, jcharKernels.name);
+      }
+   }
+finish:
+   initJCharKernels(true);
+   xfree(a);
+   xfree(b);
+}
+
+#define PIXEL_BENCH_W 480
+#define PIXEL_BENCH_H 800
+#define PIXEL_BENCH_ICON 48
+#define PIXEL_BENCH_ROW 64    // height of each item of the list
+#define PIXEL_BENCH_FRAMES 30
+
+// each frame scrolls the list by 8 pixels: copies the screen up, fills the items and the separators and blends an
+// icon with transparent corners in each item; then converts the frame to the byte order of Skia
+static int32 runPixelBench(Pixel* frame, Pixel* icon, Pixel* converted, int32 times[4])
+{
+   int32 f, y, n = PIXEL_BENCH_W * PIXEL_BENCH_H;
+   int64 ini;
+   xmemzero(times, 4 * sizeof(int32));
+   for (f = 0; f < PIXEL_BENCH_FRAMES; f++)
+   {
+      int32 scroll = (f * 8) % PIXEL_BENCH_ROW;
+      ini = getTimeStampMicro();
+      for (y = 0; y < PIXEL_BENCH_H - 8; y++)
+         pixelKernels.copyOpaque(frame + y * PIXEL_BENCH_W, frame + (y + 8) * PIXEL_BENCH_W, PIXEL_BENCH_W);
+      times[0] += (int32)(getTimeStampMicro() - ini);
+      ini = getTimeStampMicro();
+      for (y = 0; y < PIXEL_BENCH_H; y++)
+         if ((y + scroll) % PIXEL_BENCH_ROW == 0)
+            pixelKernels.fill(frame + y * PIXEL_BENCH_W, PIXEL_BENCH_W, 0x808080FF, 0xC0C0C0FF); // dotted separator
+         else
+            pixelKernels.fill(frame + y * PIXEL_BENCH_W + 8, PIXEL_BENCH_W - 16, (Pixel)(0xF0F0F0FF - f), (Pixel)(0xF0F0F0FF - f));
+      times[1] += (int32)(getTimeStampMicro() - ini);
+      ini = getTimeStampMicro();
+      for (y = 0; y < PIXEL_BENCH_H - PIXEL_BENCH_ICON; y++)
+      {
+         int32 row = (y + scroll) % PIXEL_BENCH_ROW - 8;
+         if (0 <= row && row < PIXEL_BENCH_ICON)
+         {
+            Pixel* to = frame + y * PIXEL_BENCH_W;
+            pixelKernels.blend(to + 8, icon + row * PIXEL_BENCH_ICON, PIXEL_BENCH_ICON, 0xFF);
+            pixelKernels.blend(to + PIXEL_BENCH_W - PIXEL_BENCH_ICON - 8, icon + row * PIXEL_BENCH_ICON, PIXEL_BENCH_ICON, 0x80); // a faded one
+         }
+      }
+      times[2] += (int32)(getTimeStampMicro() - ini);
+      ini = getTimeStampMicro();
+      pixelKernels.swapBytes(converted, frame, n);
+      times[3] += (int32)(getTimeStampMicro() - ini);
+   }
+   return times[0] + times[1] + times[2] + times[3];
+}
+
+TESTCASE(VM_z8_Bench_pixels)
+{
+   int32 n = PIXEL_BENCH_W * PIXEL_BENCH_H, i, x, y, portable, simd, tp[4], ts[4];
+   Pixel *frame1 = (Pixel*)xmalloc(n * sizeof(Pixel)), *frame2 = (Pixel*)xmalloc(n * sizeof(Pixel));
+   Pixel *converted1 = (Pixel*)xmalloc(n * sizeof(Pixel)), *converted2 = (Pixel*)xmalloc(n * sizeof(Pixel));
+   Pixel *icon = (Pixel*)xmalloc(PIXEL_BENCH_ICON * PIXEL_BENCH_ICON * sizeof(Pixel));
+   if (!frame1 || !frame2 || !converted1 || !converted2 || !icon) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   for (y = 0; y < PIXEL_BENCH_ICON; y++)
+      for (x = 0; x < PIXEL_BENCH_ICON; x++)
+      {
+         int32 dx = x * 2 - PIXEL_BENCH_ICON, dy = y * 2 - PIXEL_BENCH_ICON, d = dx*dx + dy*dy, r = PIXEL_BENCH_ICON * PIXEL_BENCH_ICON;
+         int32 a = d >= r ? 0 : d >= r * 3 / 4 ? 0xFF * (r - d) / (r / 4) : 0xFF; // a circle with soft borders
+         icon[y * PIXEL_BENCH_ICON + x] = ((Pixel)(x * 5) << 24) | ((Pixel)(y * 5) << 16) | 0x4000 | (Pixel)a;
+      }
+   for (i = 0; i < n; i++)
+      frame1[i] = frame2[i] = 0xFFFFFFFF;
+   initPixelKernels(false);
+   portable = runPixelBench(frame1, icon, converted1, tp);
+   initPixelKernels(true);
+   simd = runPixelBench(frame2, icon, converted2, ts);
+   ASSERT1_EQUALS(True, xmemcmp(frame1, frame2, n * sizeof(Pixel)) == 0);
+   ASSERT1_EQUALS(True, xmemcmp(converted1, converted2, n * sizeof(Pixel)) == 0);
+   TEST_OUTPUT(tc, "B pixels %d frames of %dx%d: %d us portable (copy %d, fill %d, blend %d, convert %d), %d us %s (copy %d, fill %d, blend %d, convert %d)\n",
+      PIXEL_BENCH_FRAMES, PIXEL_BENCH_W, PIXEL_BENCH_H, (int)portable, (int)tp[0], (int)tp[1], (int)tp[2], (int)tp[3], (int)simd, pixelKernels.name, (int)ts[0], (int)ts[1], (int)ts[2], (int)ts[3]);
+finish:
+   initPixelKernels(true);
+   xfree(frame1);
+   xfree(frame2);
+   xfree(converted1);
+   xfree(converted2);
+   xfree(icon);
+}
+
+#define HT_BENCH_KEYS 2000
+#define HT_BENCH_LOOPS 200
+
+static int32 benchVisited;
+
+static bool benchNameEquals(VoidP key1, VoidP key2)
+{
+   return strEq((CharP)key1, (CharP)key2);
+}
+
+static void benchVisit(int32 i32, VoidP ptr)
+{
+   UNUSED(i32);
+   benchVisited += ptr != null;
+}
+
+TESTCASE(VM_z8_Bench_hashtable)
+{
+   static char names[HT_BENCH_KEYS][40];
+   static int32 hashes[HT_BENCH_KEYS];
+   Hashtable ht = htNew(0xFF, null);
+   KeyHashtable kh = khNew(0x100, benchNameEquals, false), khc = khNew(0x100, benchNameEquals, true);
+   int32 i, j, t0, t1, t2, found0 = 0, found1 = 0, found2 = 0;
+   int64 ini;
+   if (!ht.items || !kh.table || !khc.table) {TEST_OUTPUT_SOURCELINE; goto finish;}
+   for (i = 0; i < HT_BENCH_KEYS; i++)
+   {
+      xstrprintf(names[i], "totalcross.ui.Class%d", i); // like the names of the loaded classes
+      hashes[i] = hashCodeSlash2Dot(names[i]);
+   }
+   ini = getTimeStampMicro();
+   for (i = 0; i < HT_BENCH_KEYS; i++)
+      htPutPtr(&ht, hashes[i], names[i]);
+   t0 = (int32)(getTimeStampMicro() - ini);
+   ini = getTimeStampMicro();
+   for (i = 0; i < HT_BENCH_KEYS; i++)
+   {
+      khPut(&kh, names[i], hashes[i], names[i]);
+      khPut(&khc, names[i], hashes[i], names[i]);
+   }
+   t1 = (int32)(getTimeStampMicro() - ini) / 2;
+   TEST_OUTPUT(tc, "B hashtable put %d keys: %d us chained, %d us open addressing\n", HT_BENCH_KEYS, (int)t0, (int)t1);
+   // the even indexes are hits; the odd ones use another hash, as if searching for names that were not added
+   ini = getTimeStampMicro();
+   for (j = 0; j < HT_BENCH_LOOPS; j++)
+      for (i = 0; i < HT_BENCH_KEYS; i++)
+         found0 += htGetPtr(&ht, (i & 1) ? hashes[i] ^ 0x5A5A0000 : hashes[i]) != null;
+   t0 = (int32)(getTimeStampMicro() - ini);
+   ini = getTimeStampMicro();
+   for (j = 0; j < HT_BENCH_LOOPS; j++)
+      for (i = 0; i < HT_BENCH_KEYS; i++)
+         found1 += khGet(&kh, names[i], (i & 1) ? hashes[i] ^ 0x5A5A0000 : hashes[i]) != null;
+   t1 = (int32)(getTimeStampMicro() - ini);
+   ini = getTimeStampMicro();
+   for (j = 0; j < HT_BENCH_LOOPS; j++)
+      for (i = 0; i < HT_BENCH_KEYS; i++)
+         found2 += khGet(&khc, names[i], (i & 1) ? hashes[i] ^ 0x5A5A0000 : hashes[i]) != null;
+   t2 = (int32)(getTimeStampMicro() - ini);
+   ASSERT2_EQUALS(I32, found1, found2);
+   ASSERT2_EQUALS(I32, HT_BENCH_KEYS / 2 * HT_BENCH_LOOPS, found1);
+   TEST_OUTPUT(tc, "B hashtable get %d keys: %d us chained (%d found), %d us open addressing, %d us lock-free (%d found)\n", HT_BENCH_KEYS * HT_BENCH_LOOPS, (int)t0, (int)found0, (int)t1, (int)t2, (int)found1);
+   // the loaded classes are traversed by the gc at each collection
+   benchVisited = 0;
+   ini = getTimeStampMicro();
+   for (j = 0; j < HT_BENCH_LOOPS; j++)
+      htTraverse(&ht, benchVisit);
+   t0 = (int32)(getTimeStampMicro() - ini);
+   ini = getTimeStampMicro();
+   for (j = 0; j < HT_BENCH_LOOPS; j++)
+      khTraverse(&kh, benchVisit);
+   t1 = (int32)(getTimeStampMicro() - ini);
+   ASSERT2_EQUALS(I32, HT_BENCH_KEYS * HT_BENCH_LOOPS * 2, benchVisited);
+   TEST_OUTPUT(tc, "B hashtable traverse %d keys: %d us chained, %d us open addressing\n", HT_BENCH_KEYS * HT_BENCH_LOOPS, (int)t0, (int)t1);
+finish:
+   htFree(&ht, null);
+   khFree(&kh, null);
+   khFree(&khc, null);
+}
+
+#endif // ENABLE_TEST_SUITE
@@ -268,6 +268,189 @@ void htTraverseWithKey(Hashtable *iht, VisitElementKeyFunc visitElement)
          visitElement(e->key, e->i32, e->ptr);
 }
 
+///////////////////////////////////////////////////////////////////////////
+//                                KeyHashtable                           //
+///////////////////////////////////////////////////////////////////////////
+
+#define KH_HASH(h) ((h) == 0 ? 1 : (h)) // 0 marks the empty slots
+#define KH_DISTANCE(t, h, i) (((i) - (h)) & (t)->mask) // how far the entry at slot i is from its home slot
+
+static KeyEntries khAlloc(uint32 capacity)
+{
+   KeyEntries t = (KeyEntries)xmalloc(sizeof(TKeyEntries) + (capacity-1) * sizeof(TKeyEntry)); // zeroed by xmalloc
+   if (t)
+      t->mask = capacity-1;
+   return t;
+}
+
+KeyHashtable khNew(int32 count, KeyEqualsFunc equals, bool concurrent)
+{
+   KeyHashtable kh;
+   uint32 capacity = 8;
+   while ((int32)capacity < count) // always a power of 2
+      capacity <<= 1;
+   kh.table = khAlloc(capacity);
+   kh.size = 0;
+   kh.equals = equals;
+   kh.concurrent = concurrent;
+   return kh;
+}
+
+static TKeyEntry* khFind(KeyHashtable *kh, KeyEntries t, VoidP key, uint32 hash)
+{
+   uint32 i, d, h;
+   for (i = hash & t->mask, d = 0; (h = t->items[i].hash) != 0; i = (i+1) & t->mask, d++)
+   {
+      if (!kh->concurrent && KH_DISTANCE(t, h, i) < d) // the key would have taken the place of this entry
+         break;
+      if (h == hash)
+      {
+         if (kh->concurrent)
+            MEMORY_BARRIER(); // don't read the key before the hash
+         if (kh->equals(t->items[i].key, key))
+            return &t->items[i];
+      }
+   }
+   return null;
+}
+
+VoidP khGet(KeyHashtable *kh, VoidP key, uint32 hash)
+{
+   KeyEntries t = kh->table; // read once: a writer may replace it
+   TKeyEntry* e = t ? khFind(kh, t, key, KH_HASH(hash)) : null;
+   return e ? e->value : null;
+}
+
+static void khInsert(KeyHashtable *kh, KeyEntries t, VoidP key, uint32 hash, VoidP value) // the key must not be in the table
+{
+   TKeyEntry e, *p;
+   uint32 i, d;
+   e.hash = hash;
+   e.key = key;
+   e.value = value;
+   for (i = hash & t->mask, d = 0;; i = (i+1) & t->mask, d++)
+   {
+      p = &t->items[i];
+      if (p->hash == 0)
+      {
+         if (kh->concurrent)
+         {
+            p->key = e.key;
+            p->value = e.value;
+            MEMORY_BARRIER(); // the readers find the entry by its hash, so it must be written last
+            p->hash = e.hash;
+         }
+         else
+            *p = e;
+         return;
+      }
+      if (!kh->concurrent && KH_DISTANCE(t, p->hash, i) < d) // Robin Hood: the entry that is closer to its home slot gives its place
+      {
+         TKeyEntry tmp = *p;
+         *p = e;
+         e = tmp;
+         d = KH_DISTANCE(t, e.hash, i);
+      }
+   }
+}
+
+static bool khGrow(KeyHashtable *kh)
+{
+   KeyEntries old = kh->table, t = khAlloc((old->mask+1) << 1);
+   uint32 i;
+   if (!t)
+      return false;
+   kh->size = 0;
+   for (i = 0; i <= old->mask; i++)
+      if (old->items[i].hash != 0 && old->items[i].value != null) // the removed keys of a concurrent table are dropped
+      {
+         khInsert(kh, t, old->items[i].key, old->items[i].hash, old->items[i].value);
+         kh->size++;
+      }
+   if (kh->concurrent)
+   {
+      t->retired = old; // a reader may still be searching it
+      MEMORY_BARRIER();
+      kh->table = t;
+   }
+   else
+   {
+      kh->table = t;
+      xfree(old);
+   }
+   return true;
+}
+
+bool khPut(KeyHashtable *kh, VoidP key, uint32 hash, VoidP value)
+{
+   TKeyEntry* e;
+   if (kh->table == null)
+      return false;
+   hash = KH_HASH(hash);
+   if ((e = khFind(kh, kh->table, key, hash)) != null)
+   {
+      e->value = value;
+      return true;
+   }
+   if ((kh->size+1) * 4 > (int32)(kh->table->mask+1) * 3 && !khGrow(kh)) // keep the load under 75%
+      return false;
+   khInsert(kh, kh->table, key, hash, value);
+   kh->size++;
+   return true;
+}
+
+void khRemove(KeyHashtable *kh, VoidP key, uint32 hash)
+{
+   KeyEntries t = kh->table;
+   TKeyEntry* e = t ? khFind(kh, t, key, KH_HASH(hash)) : null;
+   uint32 i, j;
+   if (e == null)
+      return;
+   if (kh->concurrent) // the slot is kept, since a reader may be probing past it
+   {
+      e->value = null;
+      return;
+   }
+   for (i = (uint32)(e - t->items); ; i = j) // shift back the entries that follow it, until one that is at its home slot
+   {
+      j = (i+1) & t->mask;
+      if (t->items[j].hash == 0 || KH_DISTANCE(t, t->items[j].hash, j) == 0)
+         break;
+      t->items[i] = t->items[j];
+   }
+   xmemzero(&t->items[i], sizeof(TKeyEntry));
+   kh->size--;
+}
+
+void khFree(KeyHashtable *kh, VisitElementFunc freeElement)
+{
+   KeyEntries t = kh->table, next;
+   uint32 i;
+   if (t == null)
+      return;
+   if (freeElement)
+      for (i = 0; i <= t->mask; i++)
+         if (t->items[i].hash != 0 && t->items[i].value != null)
+            freeElement(0, t->items[i].value);
+   for (; t != null; t = next)
+   {
+      next = t->retired;
+      xfree(t);
+   }
+   kh->table = null;
+   kh->size = 0;
+}
+
+void khTraverse(KeyHashtable *kh, VisitElementFunc visitElement)
+{
+   KeyEntries t = kh->table;
+   uint32 i;
+   if (t != null)
+      for (i = 0; i <= t->mask; i++)
+         if (t->items[i].hash != 0 && t->items[i].value != null)
+            visitElement(0, t->items[i].value);
+}
+
 ///////////////////////////////////////////////////////////////////////////
 //                                Stack                                  //
 ///////////////////////////////////////////////////////////////////////////
@@ -383,3 +566,7 @@ VoidP list2array(VoidP li, int32 sizeofElem, int32 extra)
    }
    return l;
 }
+
+#ifdef ENABLE_TEST_SUITE
+#include "datastructures_test.h"
+#endif
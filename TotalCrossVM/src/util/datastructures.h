@@ -72,6 +72,49 @@ TC_API  bool    htInc             (Hashtable *iht, HTKey key, int32 incValue);
 typedef bool  (*htIncFunc)        (Hashtable *iht, HTKey key, int32 incValue);
 void htTraverse(Hashtable *iht, VisitElementFunc visitElement);
 void htTraverseWithKey(Hashtable *iht, VisitElementKeyFunc visitElement);
+
+/////////////////////////////////////////////////////////////////////////
+// KeyHashtable
+// An open-addressing hashtable that keeps the full keys, so two keys with the same hash are told apart by the equals
+// function. The entries are stored in a single array with linear probing and Robin Hood insertion, which keeps each
+// entry close to its home slot and stops the search for a missing key early. The hash is computed by the caller, and
+// the keys are not copied: each one must live as long as its entry. The values must not be null.
+//
+// A concurrent table can be read without a lock while a single thread at a time changes it. Its entries are never
+// moved: an entry is published after its key and value are written, a removed key only has its value cleared, and a
+// bigger array replaces the old one, which is kept until the table is freed. A reader may miss the keys that are being
+// added while it searches, so a null result must be checked again under the writers' lock.
+
+typedef bool (*KeyEqualsFunc)(VoidP key1, VoidP key2);
+
+typedef struct
+{
+   uint32 hash;               // 0 marks an empty slot
+   VoidP key;
+   VoidP value;
+} TKeyEntry;
+
+typedef struct TKeyEntriesType
+{
+   uint32 mask;               // the number of slots minus 1
+   struct TKeyEntriesType *retired; // the arrays replaced in a concurrent table
+   TKeyEntry items[1];
+} TKeyEntries, *KeyEntries;
+
+typedef struct
+{
+   KeyEntries volatile table;
+   int32 size;                // used slots, including the removed keys of a concurrent table
+   KeyEqualsFunc equals;
+   bool concurrent;
+} KeyHashtable;
+
+KeyHashtable khNew(int32 count, KeyEqualsFunc equals, bool concurrent);
+VoidP khGet(KeyHashtable *kh, VoidP key, uint32 hash); // returns null if the key was not found
+bool khPut(KeyHashtable *kh, VoidP key, uint32 hash, VoidP value); // replaces the value if the key exists
+void khRemove(KeyHashtable *kh, VoidP key, uint32 hash);
+void khFree(KeyHashtable *kh, VisitElementFunc freeElement);
+void khTraverse(KeyHashtable *kh, VisitElementFunc visitElement);
 ///////////////////////////////////////////////////////////////////////////
 // Linked list
 // Defines a template for a circular list that will be used for many types.
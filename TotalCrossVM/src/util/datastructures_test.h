@@ -0,0 +1,53 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+///////////////////////////////////////////////////////////////////////////
+//                                KeyHashtable                           //
+///////////////////////////////////////////////////////////////////////////
+
+static bool keyStrEq(VoidP key1, VoidP key2)
+{
+   return strEq((CharP)key1, (CharP)key2);
+}
+
+static void testKeyHashtable(struct TestSuite *tc, bool concurrent)
+{
+   static char names[200][8];
+   KeyHashtable kh = khNew(4, keyStrEq, concurrent);
+   int32 i;
+   ASSERT1_EQUALS(NotNull, kh.table);
+   for (i = 0; i < 200; i++)
+   {
+      xstrprintf(names[i], "k%d", i);
+      ASSERT1_EQUALS(True, khPut(&kh, names[i], i & 7, names[i])); // only 8 hashes: most keys collide
+   }
+   ASSERT2_EQUALS(I32, 200, kh.size);
+   for (i = 0; i < 200; i++)
+      ASSERT2_EQUALS(Ptr, names[i], khGet(&kh, names[i], i & 7));
+   ASSERT1_EQUALS(Null, khGet(&kh, "k0", 2)); // same key, but another hash
+   ASSERT1_EQUALS(Null, khGet(&kh, "k200", 0));
+   // replace and remove
+   ASSERT1_EQUALS(True, khPut(&kh, names[1], 1, names[0]));
+   ASSERT2_EQUALS(Ptr, names[0], khGet(&kh, names[1], 1));
+   for (i = 0; i < 200; i += 2)
+      khRemove(&kh, names[i], i & 7);
+   for (i = 0; i < 200; i++)
+   {
+      VoidP value = khGet(&kh, names[i], i & 7);
+      ASSERT2_EQUALS(I32, i & 1, value != null);
+   }
+   ASSERT2_EQUALS(I32, concurrent ? 200 : 100, kh.size); // a concurrent table keeps the slots of the removed keys
+   ASSERT1_EQUALS(True, khPut(&kh, names[0], 0, names[0]));
+   ASSERT2_EQUALS(Ptr, names[0], khGet(&kh, names[0], 0));
+finish:
+   khFree(&kh, null);
+}
+
+TESTCASE(KeyHashtable)
+{
+   testKeyHashtable(tc, false);
+   testKeyHashtable(tc, true);
+   UNUSED(currentContext);
+}
@@ -33,12 +33,27 @@ bool initDebug()
 void destroyDebug()
 {
 #ifdef TRACK_USED_OPCODES
-   int i;
-   int8* usedOpcodes = usedOpcodes;
+   int i,j,k;
    debug("===========\nUsed opcodes:");
-   for (i =0; i <=255 ; i++)
+   for (i = 0; i < OPCODE_LENGTH; i++)
       if (usedOpcodes[i] > 0)
-         debug("%3d",i);
+         debug("%3d: %d",i,usedOpcodes[i]);
+   debug("===========\nMost frequent opcode pairs:"); // candidates for new superinstructions
+   for (k = 0; k < 20; k++)
+   {
+      int32 max = 0, maxI = 0, maxJ = 0;
+      for (i = 0; i < OPCODE_LENGTH; i++)
+         for (j = 0; j < OPCODE_LENGTH; j++)
+            if (usedOpcodePairs[i][j] > max)
+            {
+               max = usedOpcodePairs[i][j];
+               maxI = i; maxJ = j;
+            }
+      if (max == 0)
+         break;
+      debug("%3d %3d: %d",maxI,maxJ,max);
+      usedOpcodePairs[maxI][maxJ] = 0;
+   }
 #endif
    privateDestroyDebug();
    free(debugstr);
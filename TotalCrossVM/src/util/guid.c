@@ -67,14 +67,16 @@ TC_API bool String2GUID(TCObject string, GUID* guid)
 {
    int32 stringLen = String_charsLen(string);
    TCHAR szGuid[MAX_GUID_STRING_LEN] = GuidZero;
+   JChar chars[33];
 
    if (stringLen == 32)
    {
-      JCharP2TCHARPBuf(String_charsStart(string)      ,  8, szGuid +  1);
-      JCharP2TCHARPBuf(String_charsStart(string) + 8  ,  4, szGuid + 10);
-      JCharP2TCHARPBuf(String_charsStart(string) + 12 ,  4, szGuid + 15);
-      JCharP2TCHARPBuf(String_charsStart(string) + 16 ,  4, szGuid + 20);
-      JCharP2TCHARPBuf(String_charsStart(string) + 20 , 12, szGuid + 25);
+      String2JCharPBufLen(string, 32, chars);
+      JCharP2TCHARPBuf(chars      ,  8, szGuid +  1);
+      JCharP2TCHARPBuf(chars + 8  ,  4, szGuid + 10);
+      JCharP2TCHARPBuf(chars + 12 ,  4, szGuid + 15);
+      JCharP2TCHARPBuf(chars + 16 ,  4, szGuid + 20);
+      JCharP2TCHARPBuf(chars + 20 , 12, szGuid + 25);
       *(szGuid+9) = *(szGuid+14) = *(szGuid+19) = *(szGuid+24) = '-';
       *(szGuid+37) = '}';
    }
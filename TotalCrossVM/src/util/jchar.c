@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: LGPL-2.1-only
 
 #include "tcvm.h"
+#include "jcharsimd.h"
 
 // guich@421_43: new upper/lower convertions, and made int2hex native - guich@421_74: moved to here and fixed and optimized the routines
 static char* LOWER3 = "1313BC10110310510710910B10D10F11111311511711911B11D11F12112312512712912B12D12F06913313513713A13C13E14014214414614814B14D14F15115315515715915B15D15F16116316516716916B16D16F1711731751770FF17A17C17E07325318318525418825625718C1DD25925B19226026326926819926F2722751A11A31A52801A82831AD2881B028A28B1B41B62921B91BD1C61C61C91C91CC1CC1CE1D01D21D41D61D81DA1DC1DF1E11E31E51E71E91EB1ED1EF1F31F31F51951BF1F91FB1FD1FF20120320520720920B20D20F21121321521721921B21D21F19E22322522722922B22D22F2312333B93AC3AD3AE3AF3CC3CD3CE3B13B23B33B43B53B63B73B83B93BA3BB3BC3BD3BE3BF3C03C13C33C43C53C63C73C83C93CA3CB3C33B23B83C63C03D93DB3DD3DF3E13E33E53E73E93EB3ED3EF3BA3C13B83B53F83F23FB45045145245345445545645745845945A45B45C45D45E45F43043143243343443543643743843943A43B43C43D43E43F44044144244344444544644744844944A44B44C44D44E44F46146346546746946B46D46F47147347547747947B47D47F48148B48D48F49149349549749949B49D49F4A14A34A54A74A94AB4AD4AF4B14B34B54B74B94BB4BD4BF4C24C44C64C84CA4CC4CE4D14D34D54D74D94DB4DD4DF4E14E34E54E74E94EB4ED4EF4F14F34F54F950150350550750950B50D50F56156256356456556656756856956A56B56C56D56E56F57057157257357457557657757857957A57B57C57D57E57F580581582583584585586";
@@ -164,13 +165,9 @@ TC_API JChar JCharToUpper(JChar c)
 
 TC_API int32 JCharPIndexOfJCharP(JCharP me, JCharP other, int32 start, int32 meLen, int32 otherLen) // guich@320_6
 {
-   JChar c;
    int32 count = meLen >= 0 ? meLen : JCharPLen(me);
    int32 scount = otherLen >= 0 ? otherLen : JCharPLen(other);
-   int32 j = (count - scount);
-   int32 len;
-   JCharP s;
-   JCharP s1;
+   int32 i;
    if (start < 0)
       start = 0;
    else
@@ -178,41 +175,12 @@ TC_API int32 JCharPIndexOfJCharP(JCharP me, JCharP other, int32 start, int32 meL
       return -1;
    if (scount == 0)
       return start;
-   if (otherLen == 1)
-      return JCharPIndexOfJChar(me, *other, start, meLen);
-
-   me += start; // guich@557_4: fixes error when the given start was < 0.
-   c = *other++;
-   scount--;
-
-notFound:
-   while (1)
-   {
-      // search for the next ocurrence of the first char of other in me
-      while (start <= j && *me != c)
-      {
-         start++;
-         me++;
-      }
-
-      // passed end of string?
-      if (start > j)
-         return -1;
-
-      // now search the other strings
-      len = scount;
-      s = me+1;
-      s1 = other;
-      while (len--)
-         if (*s++ != *s1++)
-         {
-            start++;
-            me++; // guich@321_3
-            goto notFound;
-         }
-
-      return start;
-   }
+   if (scount == 1)
+      return JCharPIndexOfJChar(me, *other, start, count);
+   if (scount > count - start)
+      return -1;
+   i = jcharKernels.find(me + start, count - start, other, scount);
+   return i < 0 ? -1 : start + i;
 }
 
 TC_API int32 JCharPLastIndexOfJCharP(JCharP me, JCharP other, int32 start, int32 meLen, int32 otherLen)
@@ -277,10 +245,8 @@ TC_API int32 JCharPIndexOfJChar(JCharP me, JChar what, int32 start, int32 meLen)
    if (start >= n)
       return -1;
 
-   for (me += start; start < n; start++)
-      if (*me++ == what)
-         return start;
-   return -1;
+   n = jcharKernels.indexOf(me + start, n - start, what);
+   return n < 0 ? -1 : start + n;
 }
 
 TC_API bool JCharPEqualsJCharP(JCharP me, JCharP other, int32 meLen, int32 otherLen)
@@ -292,34 +258,35 @@ TC_API bool JCharPEqualsJCharP(JCharP me, JCharP other, int32 meLen, int32 other
    {
       if (meLen < 0) meLen = JCharPLen(me);
       if (otherLen < 0) otherLen = JCharPLen(other);
-      if (meLen != otherLen)
-         return false;
-      while (meLen-- > 0)
-         if (*me++ != *other++)
-            return false;
-      return true;
+      return meLen == otherLen && jcharKernels.mismatch(me, other, meLen) == meLen;
    }
    return false;
 }
 
 TC_API int32 JCharPCompareToJCharP(JCharP me, JCharP other, int32 meLen, int32 otherLen)
 {
-   int32 n,ml,ol;
+   int32 n,i,ml,ol;
    ml = meLen >= 0 ? meLen : JCharPLen(me);
    ol = otherLen >= 0 ? otherLen : JCharPLen(other);
-   for (n = min32(ml, ol); n--; me++, other++)
-      if (*me != *other)
-         return (int32)*me - (int32)*other;
-   return ml - ol;
+   n = min32(ml, ol);
+   i = jcharKernels.mismatch(me, other, n);
+   return i < n ? (int32)me[i] - (int32)other[i] : ml - ol;
 }
 
 TC_API int32 JCharPHashCode(JCharP s, int32 len)
 {
-   int32 hash=0;
    if (len < 0) len = JCharPLen(s);
-   while (len-- > 0)
-      hash = (hash<<5) - hash + (int32)*s++; // was 31*hash
-   return hash;
+   return (int32)jcharKernels.hash(s, len, 0); // 31*hash + c
+}
+
+TC_API void JCharPToLower(JCharP dst, JCharP src, int32 len)
+{
+   jcharKernels.toLower(dst, src, len);
+}
+
+TC_API void JCharPToUpper(JCharP dst, JCharP src, int32 len)
+{
+   jcharKernels.toUpper(dst, src, len);
 }
 
 TC_API TCHARP JCharP2TCHARP(JCharP from, int32 len)
@@ -354,13 +321,7 @@ TC_API JCharP TCHARP2JCharP(TCHARP from, JCharP to, int32 len)
 
 TC_API bool JCharPStartsWithJCharP(JCharP me, JCharP other, int32 meLen, int32 otherLen, int32 from)
 {
-   if (from < 0 || from > (meLen-otherLen))
-      return false;
-   else
-      for (me += from; otherLen-- > 0;)
-         if (*me++ != *other++)
-            return false;
-   return true;
+   return 0 <= from && from <= (meLen-otherLen) && jcharKernels.mismatch(me + from, other, otherLen) == otherLen;
 }
 
 TC_API bool JCharPEndsWithJCharP(JCharP me, JCharP other, int32 meLen, int32 otherLen)
@@ -46,6 +46,12 @@ TC_API int32 JCharPCompareToJCharP(JCharP me, JCharP other, int32 meLen, int32 o
 typedef int32 (*JCharPCompareToJCharPFunc)(JCharP me, JCharP other, int32 meLen, int32 otherLen);
 TC_API int32 JCharPHashCode(JCharP s, int32 len);
 typedef int32 (*JCharPHashCodeFunc)(JCharP s, int32 len);
+/// Converts len chars of src to lower case, storing them in dst, which may be src itself
+TC_API void JCharPToLower(JCharP dst, JCharP src, int32 len);
+typedef void (*JCharPToLowerFunc)(JCharP dst, JCharP src, int32 len);
+/// Converts len chars of src to upper case, storing them in dst, which may be src itself
+TC_API void JCharPToUpper(JCharP dst, JCharP src, int32 len);
+typedef void (*JCharPToUpperFunc)(JCharP dst, JCharP src, int32 len);
 TC_API bool JCharPStartsWithJCharP(JCharP me, JCharP other, int32 meLen, int32 otherLen, int32 from);
 typedef bool (*JCharPStartsWithJCharPFunc)(JCharP me, JCharP other, int32 meLen, int32 otherLen, int32 from);
 TC_API bool JCharPEndsWithJCharP(JCharP me, JCharP other, int32 meLen, int32 otherLen);
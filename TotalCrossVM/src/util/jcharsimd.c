@@ -0,0 +1,469 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include "tcvm.h"
+#include "jcharsimd.h"
+
+// powers of 31, modulo 2^32, used to hash several chars at once
+#define P31_1   31u
+#define P31_2   961u
+#define P31_3   29791u
+#define P31_4   923521u
+#define P31_5   28629151u
+#define P31_6   887503681u
+#define P31_7   1742810335u
+#define P31_8   2487512833u
+#define P31_9   4098453791u
+#define P31_10  2498015937u
+#define P31_11  129082719u
+#define P31_12  4001564289u
+#define P31_13  3789408671u
+#define P31_14  1507551809u
+#define P31_15  3784433119u
+#define P31_16  1353309697u
+
+//////////////////////////////////////////////////////////////////////////
+// portable kernels
+
+static int32 mismatchC(JCharP a, JCharP b, int32 n)
+{
+   int32 i;
+   for (i = 0; i < n && a[i] == b[i]; i++)
+      ;
+   return i;
+}
+
+static int32 indexOfC(JCharP s, int32 n, JChar c)
+{
+   int32 i;
+   for (i = 0; i < n; i++)
+      if (s[i] == c)
+         return i;
+   return -1;
+}
+
+static int32 findC(JCharP s, int32 n, JCharP w, int32 m)
+{
+   int32 i, last = n - m;
+   for (i = 0; i <= last; i++)
+      if (s[i] == w[0] && s[i+m-1] == w[m-1] && mismatchC(s+i+1, w+1, m-2) == m-2)
+         return i;
+   return -1;
+}
+
+static uint32 hashC(JCharP s, int32 n, uint32 h)
+{
+   while (n-- > 0)
+      h = (h<<5) - h + *s++; // 31*h
+   return h;
+}
+
+static void toLowerC(JCharP dst, JCharP src, int32 n)
+{
+   while (n-- > 0)
+      *dst++ = JCharToLower(*src++);
+}
+
+static void toUpperC(JCharP dst, JCharP src, int32 n)
+{
+   while (n-- > 0)
+      *dst++ = JCharToUpper(*src++);
+}
+
+static TJCharKernels portableKernels = {"portable", mismatchC, indexOfC, findC, hashC, toLowerC, toUpperC};
+TJCharKernels jcharKernels = {"portable", mismatchC, indexOfC, findC, hashC, toLowerC, toUpperC};
+
+//////////////////////////////////////////////////////////////////////////
+// x86-64: SSE2 is always present; SSE4.2 and AVX2 are checked at runtime
+#if defined(__x86_64__) || defined(_M_X64)
+#define JCHAR_SIMD_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET(x)
+static int32 ctz32(uint32 x)
+{
+   unsigned long i;
+   _BitScanForward(&i, x);
+   return (int32)i;
+}
+#else
+#define TARGET(x) __attribute__((target(x)))
+#define ctz32(x) __builtin_ctz(x)
+#endif
+
+#define LOAD128(p) _mm_loadu_si128((const __m128i*)(p))
+#define LOAD256(p) _mm256_loadu_si256((const __m256i*)(p))
+
+static int32 mismatchSSE2(JCharP a, JCharP b, int32 n)
+{
+   int32 i;
+   for (i = 0; i + 8 <= n; i += 8)
+   {
+      uint32 diff = (uint32)_mm_movemask_epi8(_mm_cmpeq_epi16(LOAD128(a+i), LOAD128(b+i))) ^ 0xFFFF;
+      if (diff != 0)
+         return i + (ctz32(diff) >> 1); // 2 bits per char
+   }
+   return i + mismatchC(a+i, b+i, n-i);
+}
+
+static int32 indexOfSSE2(JCharP s, int32 n, JChar c)
+{
+   __m128i vc = _mm_set1_epi16((short)c);
+   int32 i, r;
+   for (i = 0; i + 8 <= n; i += 8)
+   {
+      uint32 found = (uint32)_mm_movemask_epi8(_mm_cmpeq_epi16(LOAD128(s+i), vc));
+      if (found != 0)
+         return i + (ctz32(found) >> 1);
+   }
+   r = indexOfC(s+i, n-i, c);
+   return r < 0 ? -1 : i + r;
+}
+
+// the positions where both the first and the last chars of w match are checked in full
+static int32 findSSE2(JCharP s, int32 n, JCharP w, int32 m)
+{
+   __m128i first = _mm_set1_epi16((short)w[0]), last = _mm_set1_epi16((short)w[m-1]);
+   int32 i, r;
+   for (i = 0; i + 8 <= n - m + 1; i += 8)
+   {
+      uint32 found = (uint32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(LOAD128(s+i), first), _mm_cmpeq_epi16(LOAD128(s+i+m-1), last)));
+      for (; found != 0; found &= found - 1, found &= found - 1)
+      {
+         int32 j = i + (ctz32(found) >> 1);
+         if (mismatchSSE2(s+j+1, w+1, m-2) == m-2)
+            return j;
+      }
+   }
+   r = findC(s+i, n-i, w, m);
+   return r < 0 ? -1 : i + r;
+}
+
+#define IN_RANGE128(v, lo, hi) _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16((lo)-1)), _mm_cmplt_epi16(v, _mm_set1_epi16((hi)+1)))
+
+static void toLowerSSE2(JCharP dst, JCharP src, int32 n)
+{
+   __m128i high = _mm_set1_epi16((short)0xFF00), zero = _mm_setzero_si128(), delta = _mm_set1_epi16(32);
+   for (; n >= 8; n -= 8, src += 8, dst += 8)
+   {
+      __m128i v = LOAD128(src);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)) != 0xFFFF) // some char is not Latin-1
+         toLowerC(dst, src, 8);
+      else
+      {
+         __m128i upper = _mm_or_si128(IN_RANGE128(v, 'A', 'Z'), _mm_andnot_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0xD7)), IN_RANGE128(v, 0xC0, 0xDD)));
+         _mm_storeu_si128((__m128i*)dst, _mm_add_epi16(v, _mm_and_si128(upper, delta)));
+      }
+   }
+   toLowerC(dst, src, n);
+}
+
+static void toUpperSSE2(JCharP dst, JCharP src, int32 n)
+{
+   __m128i high = _mm_set1_epi16((short)0xFF00), zero = _mm_setzero_si128(), delta = _mm_set1_epi16(32);
+   for (; n >= 8; n -= 8, src += 8, dst += 8)
+   {
+      __m128i v = LOAD128(src);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)) != 0xFFFF)
+         toUpperC(dst, src, 8);
+      else
+      {
+         __m128i lower = _mm_or_si128(IN_RANGE128(v, 'a', 'z'), _mm_andnot_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0xF7)), IN_RANGE128(v, 0xE0, 0xFD)));
+         _mm_storeu_si128((__m128i*)dst, _mm_sub_epi16(v, _mm_and_si128(lower, delta)));
+      }
+   }
+   toUpperC(dst, src, n);
+}
+
+// lane j of a0 has the chars 8k+j, and of a1 the chars 8k+4+j, each one multiplied by 31^(8*(blocks after it))
+TARGET("sse4.2") static uint32 hashSSE42(JCharP s, int32 n, uint32 h)
+{
+   if (n >= 8)
+   {
+      __m128i p8 = _mm_set1_epi32((int)P31_8), a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128(), sum;
+      for (; n >= 8; n -= 8, s += 8)
+      {
+         __m128i v = LOAD128(s);
+         a0 = _mm_add_epi32(_mm_mullo_epi32(a0, p8), _mm_cvtepu16_epi32(v));
+         a1 = _mm_add_epi32(_mm_mullo_epi32(a1, p8), _mm_cvtepu16_epi32(_mm_srli_si128(v, 8)));
+         h *= P31_8;
+      }
+      sum = _mm_add_epi32(_mm_mullo_epi32(a0, _mm_setr_epi32((int)P31_7, (int)P31_6, (int)P31_5, (int)P31_4)),
+                          _mm_mullo_epi32(a1, _mm_setr_epi32((int)P31_3, (int)P31_2, (int)P31_1, 1)));
+      sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1,0,3,2)));
+      sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2,3,0,1)));
+      h += (uint32)_mm_cvtsi128_si32(sum);
+   }
+   return hashC(s, n, h);
+}
+
+TARGET("avx2") static int32 mismatchAVX2(JCharP a, JCharP b, int32 n)
+{
+   int32 i;
+   for (i = 0; i + 16 <= n; i += 16)
+   {
+      uint32 diff = ~(uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi16(LOAD256(a+i), LOAD256(b+i)));
+      if (diff != 0)
+         return i + (ctz32(diff) >> 1);
+   }
+   return i + mismatchSSE2(a+i, b+i, n-i);
+}
+
+TARGET("avx2") static int32 indexOfAVX2(JCharP s, int32 n, JChar c)
+{
+   __m256i vc = _mm256_set1_epi16((short)c);
+   int32 i, r;
+   for (i = 0; i + 16 <= n; i += 16)
+   {
+      uint32 found = (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi16(LOAD256(s+i), vc));
+      if (found != 0)
+         return i + (ctz32(found) >> 1);
+   }
+   r = indexOfSSE2(s+i, n-i, c);
+   return r < 0 ? -1 : i + r;
+}
+
+TARGET("avx2") static int32 findAVX2(JCharP s, int32 n, JCharP w, int32 m)
+{
+   __m256i first = _mm256_set1_epi16((short)w[0]), last = _mm256_set1_epi16((short)w[m-1]);
+   int32 i, r;
+   for (i = 0; i + 16 <= n - m + 1; i += 16)
+   {
+      uint32 found = (uint32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi16(LOAD256(s+i), first), _mm256_cmpeq_epi16(LOAD256(s+i+m-1), last)));
+      for (; found != 0; found &= found - 1, found &= found - 1)
+      {
+         int32 j = i + (ctz32(found) >> 1);
+         if (mismatchAVX2(s+j+1, w+1, m-2) == m-2)
+            return j;
+      }
+   }
+   r = findSSE2(s+i, n-i, w, m);
+   return r < 0 ? -1 : i + r;
+}
+
+#define IN_RANGE256(v, lo, hi) _mm256_and_si256(_mm256_cmpgt_epi16(v, _mm256_set1_epi16((lo)-1)), _mm256_cmpgt_epi16(_mm256_set1_epi16((hi)+1), v))
+
+TARGET("avx2") static void toLowerAVX2(JCharP dst, JCharP src, int32 n)
+{
+   __m256i high = _mm256_set1_epi16((short)0xFF00), delta = _mm256_set1_epi16(32);
+   for (; n >= 16; n -= 16, src += 16, dst += 16)
+   {
+      __m256i v = LOAD256(src);
+      if (!_mm256_testz_si256(v, high)) // some char is not Latin-1
+         toLowerC(dst, src, 16);
+      else
+      {
+         __m256i upper = _mm256_or_si256(IN_RANGE256(v, 'A', 'Z'), _mm256_andnot_si256(_mm256_cmpeq_epi16(v, _mm256_set1_epi16(0xD7)), IN_RANGE256(v, 0xC0, 0xDD)));
+         _mm256_storeu_si256((__m256i*)dst, _mm256_add_epi16(v, _mm256_and_si256(upper, delta)));
+      }
+   }
+   toLowerSSE2(dst, src, n);
+}
+
+TARGET("avx2") static void toUpperAVX2(JCharP dst, JCharP src, int32 n)
+{
+   __m256i high = _mm256_set1_epi16((short)0xFF00), delta = _mm256_set1_epi16(32);
+   for (; n >= 16; n -= 16, src += 16, dst += 16)
+   {
+      __m256i v = LOAD256(src);
+      if (!_mm256_testz_si256(v, high))
+         toUpperC(dst, src, 16);
+      else
+      {
+         __m256i lower = _mm256_or_si256(IN_RANGE256(v, 'a', 'z'), _mm256_andnot_si256(_mm256_cmpeq_epi16(v, _mm256_set1_epi16(0xF7)), IN_RANGE256(v, 0xE0, 0xFD)));
+         _mm256_storeu_si256((__m256i*)dst, _mm256_sub_epi16(v, _mm256_and_si256(lower, delta)));
+      }
+   }
+   toUpperSSE2(dst, src, n);
+}
+
+TARGET("avx2") static uint32 hashAVX2(JCharP s, int32 n, uint32 h)
+{
+   if (n >= 16)
+   {
+      __m256i p16 = _mm256_set1_epi32((int)P31_16), a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256(), sum256;
+      __m128i sum;
+      for (; n >= 16; n -= 16, s += 16)
+      {
+         a0 = _mm256_add_epi32(_mm256_mullo_epi32(a0, p16), _mm256_cvtepu16_epi32(LOAD128(s)));
+         a1 = _mm256_add_epi32(_mm256_mullo_epi32(a1, p16), _mm256_cvtepu16_epi32(LOAD128(s+8)));
+         h *= P31_16;
+      }
+      sum256 = _mm256_add_epi32(_mm256_mullo_epi32(a0, _mm256_setr_epi32((int)P31_15, (int)P31_14, (int)P31_13, (int)P31_12, (int)P31_11, (int)P31_10, (int)P31_9, (int)P31_8)),
+                                _mm256_mullo_epi32(a1, _mm256_setr_epi32((int)P31_7, (int)P31_6, (int)P31_5, (int)P31_4, (int)P31_3, (int)P31_2, (int)P31_1, 1)));
+      sum = _mm_add_epi32(_mm256_castsi256_si128(sum256), _mm256_extracti128_si256(sum256, 1));
+      sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1,0,3,2)));
+      sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2,3,0,1)));
+      h += (uint32)_mm_cvtsi128_si32(sum);
+   }
+   return hashC(s, n, h);
+}
+
+static TJCharKernels sseKernels  = {"sse2", mismatchSSE2, indexOfSSE2, findSSE2, hashC, toLowerSSE2, toUpperSSE2};
+static TJCharKernels avx2Kernels = {"avx2", mismatchAVX2, indexOfAVX2, findAVX2, hashAVX2, toLowerAVX2, toUpperAVX2};
+
+void cpuFeatures(bool* sse42, bool* avx2)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+   int info[4];
+   __cpuid(info, 1);
+   *sse42 = (info[2] & (1 << 20)) != 0;
+   *avx2 = false;
+   if ((info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6) // the os saves the ymm registers
+   {
+      __cpuidex(info, 7, 0);
+      *avx2 = (info[1] & (1 << 5)) != 0;
+   }
+#else
+   __builtin_cpu_init();
+   *sse42 = __builtin_cpu_supports("sse4.2") != 0;
+   *avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// ARM: NEON, when the vm is built with it (always on AArch64)
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(_MSC_VER)
+#define JCHAR_SIMD_NEON
+#include <arm_neon.h>
+
+#define LANES(eq) vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(eq)), 0) // one byte per char
+#define LANE_OF(bits) (__builtin_ctzll(bits) >> 3)
+
+static int32 mismatchNEON(JCharP a, JCharP b, int32 n)
+{
+   int32 i;
+   for (i = 0; i + 8 <= n; i += 8)
+   {
+      uint64 diff = ~LANES(vceqq_u16(vld1q_u16(a+i), vld1q_u16(b+i)));
+      if (diff != 0)
+         return i + LANE_OF(diff);
+   }
+   return i + mismatchC(a+i, b+i, n-i);
+}
+
+static int32 indexOfNEON(JCharP s, int32 n, JChar c)
+{
+   uint16x8_t vc = vdupq_n_u16(c);
+   int32 i, r;
+   for (i = 0; i + 8 <= n; i += 8)
+   {
+      uint64 found = LANES(vceqq_u16(vld1q_u16(s+i), vc));
+      if (found != 0)
+         return i + LANE_OF(found);
+   }
+   r = indexOfC(s+i, n-i, c);
+   return r < 0 ? -1 : i + r;
+}
+
+static int32 findNEON(JCharP s, int32 n, JCharP w, int32 m)
+{
+   uint16x8_t first = vdupq_n_u16(w[0]), last = vdupq_n_u16(w[m-1]);
+   int32 i, r;
+   for (i = 0; i + 8 <= n - m + 1; i += 8)
+   {
+      uint64 found = LANES(vandq_u16(vceqq_u16(vld1q_u16(s+i), first), vceqq_u16(vld1q_u16(s+i+m-1), last)));
+      for (; found != 0; found &= ~((uint64)0xFF << (LANE_OF(found) << 3)))
+      {
+         int32 j = i + LANE_OF(found);
+         if (mismatchNEON(s+j+1, w+1, m-2) == m-2)
+            return j;
+      }
+   }
+   r = findC(s+i, n-i, w, m);
+   return r < 0 ? -1 : i + r;
+}
+
+#define IN_RANGE(v, lo, hi) vandq_u16(vcgeq_u16(v, vdupq_n_u16(lo)), vcleq_u16(v, vdupq_n_u16(hi)))
+
+static void toLowerNEON(JCharP dst, JCharP src, int32 n)
+{
+   uint16x8_t latin1 = vdupq_n_u16(0xFF), delta = vdupq_n_u16(32);
+   for (; n >= 8; n -= 8, src += 8, dst += 8)
+   {
+      uint16x8_t v = vld1q_u16(src);
+      if (LANES(vcgtq_u16(v, latin1)) != 0) // some char is not Latin-1
+         toLowerC(dst, src, 8);
+      else
+      {
+         uint16x8_t upper = vorrq_u16(IN_RANGE(v, 'A', 'Z'), vbicq_u16(IN_RANGE(v, 0xC0, 0xDD), vceqq_u16(v, vdupq_n_u16(0xD7))));
+         vst1q_u16(dst, vaddq_u16(v, vandq_u16(upper, delta)));
+      }
+   }
+   toLowerC(dst, src, n);
+}
+
+static void toUpperNEON(JCharP dst, JCharP src, int32 n)
+{
+   uint16x8_t latin1 = vdupq_n_u16(0xFF), delta = vdupq_n_u16(32);
+   for (; n >= 8; n -= 8, src += 8, dst += 8)
+   {
+      uint16x8_t v = vld1q_u16(src);
+      if (LANES(vcgtq_u16(v, latin1)) != 0)
+         toUpperC(dst, src, 8);
+      else
+      {
+         uint16x8_t lower = vorrq_u16(IN_RANGE(v, 'a', 'z'), vbicq_u16(IN_RANGE(v, 0xE0, 0xFD), vceqq_u16(v, vdupq_n_u16(0xF7))));
+         vst1q_u16(dst, vsubq_u16(v, vandq_u16(lower, delta)));
+      }
+   }
+   toUpperC(dst, src, n);
+}
+
+static uint32 hashNEON(JCharP s, int32 n, uint32 h)
+{
+   if (n >= 8)
+   {
+      static const uint32 w0[4] = {P31_7, P31_6, P31_5, P31_4}, w1[4] = {P31_3, P31_2, P31_1, 1};
+      uint32x4_t p8 = vdupq_n_u32(P31_8), a0 = vdupq_n_u32(0), a1 = vdupq_n_u32(0), sum;
+      uint32x2_t pair;
+      for (; n >= 8; n -= 8, s += 8)
+      {
+         uint16x8_t v = vld1q_u16(s);
+         a0 = vmlaq_u32(vmovl_u16(vget_low_u16(v)), a0, p8);
+         a1 = vmlaq_u32(vmovl_u16(vget_high_u16(v)), a1, p8);
+         h *= P31_8;
+      }
+      sum = vmlaq_u32(vmulq_u32(a0, vld1q_u32(w0)), a1, vld1q_u32(w1));
+      pair = vadd_u32(vget_low_u32(sum), vget_high_u32(sum));
+      h += vget_lane_u32(vpadd_u32(pair, pair), 0);
+   }
+   return hashC(s, n, h);
+}
+
+static TJCharKernels neonKernels = {"neon", mismatchNEON, indexOfNEON, findNEON, hashNEON, toLowerNEON, toUpperNEON};
+#endif
+
+void initJCharKernels(bool simd)
+{
+   jcharKernels = portableKernels;
+   if (!simd)
+      return;
+#if defined(JCHAR_SIMD_X86)
+   {
+      bool sse42, avx2;
+      cpuFeatures(&sse42, &avx2);
+      if (avx2)
+         jcharKernels = avx2Kernels;
+      else
+      {
+         jcharKernels = sseKernels;
+         if (sse42)
+         {
+            jcharKernels.name = "sse4.2";
+            jcharKernels.hash = hashSSE42;
+         }
+      }
+   }
+#elif defined(JCHAR_SIMD_NEON)
+   jcharKernels = neonKernels;
+#endif
+}
+
+#ifdef ENABLE_TEST_SUITE
+#include "jcharsimd_test.h"
+#endif
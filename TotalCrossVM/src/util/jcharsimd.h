@@ -0,0 +1,37 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#ifndef JCHARSIMD_H
+#define JCHARSIMD_H
+
+/*
+ Vectorized kernels used by the JCharP functions of jchar.c. initJCharKernels selects, at runtime, the best set
+ for the processor: AVX2 or SSE (SSE2, plus SSE4.2 for the hash) on x86-64, NEON on ARM when the vm is built with
+ it, and portable C everywhere else. The kernels handle any length: the chars that don't fill a vector are done by
+ the portable code.
+*/
+
+typedef struct
+{
+   CharP name;
+   int32 (*mismatch)(JCharP a, JCharP b, int32 n);      // index of the first different char, or n if they're equal
+   int32 (*indexOf)(JCharP s, int32 n, JChar c);        // index of the first c, or -1
+   int32 (*find)(JCharP s, int32 n, JCharP w, int32 m); // index of the first w in s (2 <= m), or -1
+   uint32 (*hash)(JCharP s, int32 n, uint32 h);         // continues the hash h (31*h + c) with the chars of s
+   void (*toLower)(JCharP dst, JCharP src, int32 n);
+   void (*toUpper)(JCharP dst, JCharP src, int32 n);
+} TJCharKernels;
+
+extern TJCharKernels jcharKernels;
+
+/// Selects the kernels for the running processor, or the portable ones if simd is false (used by the benchmarks)
+void initJCharKernels(bool simd);
+
+#if defined(__x86_64__) || defined(_M_X64)
+/// Tells if the processor supports SSE4.2 and AVX2 (and if the os saves the AVX registers); also used by pixelsimd.c
+void cpuFeatures(bool* sse42, bool* avx2);
+#endif
+
+#endif
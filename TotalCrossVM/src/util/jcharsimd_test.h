@@ -0,0 +1,220 @@
+// Copyright (C) 2000-2013 SuperWaba Ltda.
+// Copyright (C) 2014-2020 TotalCross Global Mobile Platform Ltda.
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+// The vectorized kernels must give exactly the results of the portable ones. Each test runs every set that the
+// processor supports, with lengths that leave tails of 1 to 7 chars after the vectors and with starts that are not
+// aligned to them.
+
+#define KERNEL_CHARS 80 // 4 AVX2 vectors plus a tail
+
+static int32 simdJCharKernels(TJCharKernels* sets) // the vectorized sets that can run here
+{
+   int32 n = 0;
+#if defined(JCHAR_SIMD_X86)
+   bool sse42, avx2;
+   cpuFeatures(&sse42, &avx2);
+   sets[n++] = sseKernels;
+   if (sse42)
+   {
+      sets[n] = sseKernels;
+      sets[n].name = "sse4.2";
+      sets[n++].hash = hashSSE42;
+   }
+   if (avx2)
+      sets[n++] = avx2Kernels;
+#elif defined(JCHAR_SIMD_NEON)
+   sets[n++] = neonKernels;
+#endif
+   UNUSED(sets);
+   return n;
+}
+
+static void fillJChars(JCharP s, int32 n, uint32 seed) // chars with both bytes set, so a kernel that compares only one byte fails
+{
+   while (n-- > 0)
+   {
+      seed = seed * 1103515245 + 12345;
+      *s++ = (JChar)(0x0101 + ((seed >> 16) % 0x7EFE));
+   }
+}
+
+TESTCASE(JCharKernels_mismatch)
+{
+   TJCharKernels sets[3];
+   JChar a[KERNEL_CHARS+8], b[KERNEL_CHARS+8];
+   int32 k, count = simdJCharKernels(sets), off, n, p;
+   if (count == 0)
+      TEST_SKIP;
+   for (k = 0; k < count; k++)
+      for (off = 0; off < 8; off++)
+         for (n = 0; n <= KERNEL_CHARS; n++)
+         {
+            fillJChars(a, n + off, n);
+            xmemmove(b, a, (n + off) * 2);
+            ASSERT2_EQUALS(I32, n, sets[k].mismatch(a + off, b + off, n));
+            for (p = 0; p < n; p++) // a mismatch at each lane, in the low and in the high byte
+            {
+               b[off+p] ^= 0x0001;
+               ASSERT2_EQUALS(I32, p, sets[k].mismatch(a + off, b + off, n));
+               b[off+p] ^= 0x0101;
+               ASSERT2_EQUALS(I32, p, sets[k].mismatch(a + off, b + off, n));
+               b[off+p] ^= 0x0100;
+            }
+         }
+finish: ;
+   UNUSED(currentContext);
+}
+
+TESTCASE(JCharKernels_indexOf)
+{
+   TJCharKernels sets[3];
+   JChar s[KERNEL_CHARS+8], c = 0x2041; // its low byte is 'A', which is in the string
+   int32 k, count = simdJCharKernels(sets), off, n, p, i;
+   if (count == 0)
+      TEST_SKIP;
+   for (k = 0; k < count; k++)
+      for (off = 0; off < 8; off++)
+         for (n = 0; n <= KERNEL_CHARS; n++)
+         {
+            for (i = 0; i < n + off; i++)
+               s[i] = (JChar)('A' + i % 26);
+            ASSERT2_EQUALS(I32, -1, sets[k].indexOf(s + off, n, c));
+            for (p = 0; p < n; p++)
+            {
+               s[off+p] = c;
+               if (p + 1 < n)
+                  s[off+n-1] = c; // only the first one counts
+               ASSERT2_EQUALS(I32, p, sets[k].indexOf(s + off, n, c));
+               s[off+p] = (JChar)('A' + (off+p) % 26);
+               s[off+n-1] = (JChar)('A' + (off+n-1) % 26);
+            }
+         }
+finish: ;
+   UNUSED(currentContext);
+}
+
+TESTCASE(JCharKernels_find)
+{
+   TJCharKernels sets[3];
+   JChar s[KERNEL_CHARS+8], w[9];
+   int32 k, count = simdJCharKernels(sets), off, n, m, p, i;
+   if (count == 0)
+      TEST_SKIP;
+   for (m = 0; m < 9; m++)
+      w[m] = (JChar)(0x3000 + m);
+   for (k = 0; k < count; k++)
+      for (m = 2; m <= 9; m++)
+         for (off = 0; off < 8; off++)
+            for (n = m; n <= KERNEL_CHARS; n++)
+            {
+               for (p = 0; p + m <= n; p++)
+               {
+                  for (i = 0; i < n + off; i++)
+                     s[i] = 'x';
+                  if (p >= m && m > 2) // a candidate before the needle, with only its first and last chars
+                  {
+                     s[off+p-m] = w[0];
+                     s[off+p-1] = w[m-1];
+                  }
+                  xmemmove(s + off + p, w, m * 2);
+                  ASSERT2_EQUALS(I32, p, sets[k].find(s + off, n, w, m));
+                  s[off+p+m-1] = 'x'; // now the needle is incomplete
+                  ASSERT2_EQUALS(I32, findC(s + off, n, w, m), sets[k].find(s + off, n, w, m));
+               }
+               for (i = 0; i < n; i++) // the first and the last chars are everywhere, but the needle is nowhere
+                  s[off+i] = i & 1 ? w[m-1] : w[0];
+               ASSERT2_EQUALS(I32, m == 2 ? 0 : -1, sets[k].find(s + off, n, w, m));
+            }
+finish: ;
+   UNUSED(currentContext);
+}
+
+TESTCASE(JCharKernels_hash)
+{
+   TJCharKernels sets[3];
+   JChar s[KERNEL_CHARS+8];
+   int32 k, count = simdJCharKernels(sets), off, n;
+   if (count == 0)
+      TEST_SKIP;
+   fillJChars(s, KERNEL_CHARS+8, 7);
+   s[3] = 0xFFFF;
+   for (k = 0; k < count; k++)
+      for (off = 0; off < 8; off++)
+         for (n = 0; n <= KERNEL_CHARS; n++)
+         {
+            ASSERT2_EQUALS(I32, (int32)hashC(s + off, n, 0), (int32)sets[k].hash(s + off, n, 0));
+            ASSERT2_EQUALS(I32, (int32)hashC(s + off, n, 0x9E3779B9), (int32)sets[k].hash(s + off, n, 0x9E3779B9));
+         }
+finish: ;
+   UNUSED(currentContext);
+}
+
+TESTCASE(JCharKernels_case)
+{
+   // the Latin-1 ranges that change case, with their borders: A-Z, a-z, 0xC0-0xDE and 0xE0-0xFE except 0xD7 and 0xF7,
+   // 0xB5 and 0xFF (whose upper case are outside Latin-1), 0xDF (that has no single char upper case), and a few chars
+   // outside Latin-1 that must go through the tables
+   static JChar special[] = {'@','A','Z','[','`','a','z','{',0xB5,0xBF,0xC0,0xD6,0xD7,0xD8,0xDE,0xDF,0xE0,0xF6,0xF7,0xF8,
+                             0xFE,0xFF,0x100,0x101,0x178,0x39C,0x3A3,0x3C3,0x410,0x430,0xFF21,0xFF41};
+   TJCharKernels sets[3];
+   JChar src[0x200+8], expected[0x200+8], got[0x200+8];
+   int32 k, count = simdJCharKernels(sets), off, n, i, nspecial = sizeof(special) / sizeof(JChar);
+   if (count == 0)
+      TEST_SKIP;
+   for (i = 0; i < 0x200+8; i++) // all the Latin-1 chars, then chars mixed with the special ones
+      src[i] = i < 0x100 ? (JChar)i : special[i % nspecial];
+   for (k = 0; k < count; k++)
+      for (off = 0; off < 8; off++)
+         for (n = 0; n <= 0x200; n += n < KERNEL_CHARS ? 1 : 61)
+         {
+            xmemset(got, 0xAB, sizeof(got));
+            toLowerC(expected, src + off, n);
+            sets[k].toLower(got, src + off, n);
+            ASSERT3_EQUALS(Block, expected, got, n * 2);
+            ASSERT2_EQUALS(I32, 0xABAB, got[n]); // nothing is written after the end
+            toUpperC(expected, src + off, n);
+            sets[k].toUpper(got, src + off, n);
+            ASSERT3_EQUALS(Block, expected, got, n * 2);
+            ASSERT2_EQUALS(I32, 0xABAB, got[n]);
+         }
+finish: ;
+   UNUSED(currentContext);
+}
+
+TESTCASE(JCharKernels_equalsCompareTo) // the JCharP functions, with the strings differing at each position
+{
+   TJCharKernels sets[3], saved = jcharKernels;
+   JChar a[KERNEL_CHARS+8], b[KERNEL_CHARS+8];
+   int32 k, count = simdJCharKernels(sets), off, n, p, d;
+   if (count == 0)
+      TEST_SKIP;
+   for (k = 0; k < count; k++)
+   {
+      jcharKernels = sets[k];
+      for (off = 0; off < 8; off++)
+         for (n = 1; n <= KERNEL_CHARS; n++)
+         {
+            fillJChars(a, n + off, n + 100);
+            xmemmove(b, a, (n + off) * 2);
+            ASSERT1_EQUALS(True, JCharPEqualsJCharP(a + off, b + off, n, n));
+            ASSERT2_EQUALS(I32, 0, JCharPCompareToJCharP(a + off, b + off, n, n));
+            ASSERT1_EQUALS(False, JCharPEqualsJCharP(a + off, b + off, n, n - 1));
+            ASSERT2_EQUALS(I32, 1, JCharPCompareToJCharP(a + off, b + off, n, n - 1)); // a prefix is smaller
+            ASSERT1_EQUALS(True, JCharPStartsWithJCharP(a + off, b + off, n, n - 1, 0));
+            for (p = 0; p < n; p++)
+               for (d = -1; d <= 1; d += 2) // b[p] smaller, then greater than a[p]
+               {
+                  b[off+p] = (JChar)(a[off+p] + (d < 0 ? -0x0100 : 0x0100));
+                  ASSERT1_EQUALS(False, JCharPEqualsJCharP(a + off, b + off, n, n));
+                  ASSERT2_EQUALS(I32, -d * 0x0100, JCharPCompareToJCharP(a + off, b + off, n, n));
+                  ASSERT2_EQUALS(I32, p == n - 1, JCharPStartsWithJCharP(a + off, b + off, n, n - 1, 0));
+                  b[off+p] = a[off+p];
+               }
+         }
+   }
+finish:
+   jcharKernels = saved;
+   UNUSED(currentContext);
+}
@@ -148,6 +148,13 @@ static int32 privateGetTimeStamp()
    return (int32)(now.tv_sec * 1000 + now.tv_usec / 1000);
 }
 
+static int64 privateGetTimeStampMicro()
+{
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   return (int64)now.tv_sec * 1000000 + now.tv_usec;
+}
+
 static bool pfileIsDir(TCHARP dir, TCHARP file)
 {
 #ifdef darwin
@@ -5,6 +5,11 @@
 
 #include "tcvm.h"
 #include "tcz.h"
+#if (defined POSIX || defined darwin) && !defined ANDROID
+#include <sys/mman.h>
+#elif defined WIN32 && !defined WINCE
+#include <io.h>
+#endif
 
 #ifdef ANDROID // in Android, we use Java methods to read directly from the apk
 int32 callFindTCZ(CharP name)
@@ -50,6 +55,13 @@ static int32 callReadTCZ(int32 apkIdx, uint8* buf, int32 offset, int32 length)
     . compressed data chunks
 
     The first record is the class that implements totalcross.MainClass.
+
+    In a prelinked tcz (ATTR_PRELINKED), the header is still compressed, but the data chunks are
+    stored as is, starting at multiples of 8. Where possible, the file is mapped in memory, and the
+    reads are plain copies from the mapping, with no lock; the constant pool and the method code are
+    also laid out so they can be used directly from the mapping (see readConstantPool). The mapping
+    is private and writable, because the quickening rewrites the code in place: the pages are shared
+    with other processes, and stay clean, until written.
 */
 
 void destroyTCZ() // no threads are running at this point
@@ -82,10 +94,53 @@ static bool tczReadMore(TCZFile f)
    return ret;
 }
 
+static void storedChunkError(TCZFile f, int32 missing) // the chunk ended before the data that was expected: the file is truncated or corrupt
+{
+   if (f->tempHeap != null)
+      HEAP_ERROR(f->tempHeap, HEAP_ZIP_ERROR);
+   else
+      debug("Error on stored tcz (in a heapless tcz). Remain %d bytes", (int)missing);
+}
+
+static int32 tczReadStored(TCZFile f, uint8* out, int32 count)
+{
+   z_stream *zs = &f->zs;
+   int32 n, ret;
+   if (count > f->remaining)
+   {
+      storedChunkError(f, count - f->remaining);
+      count = f->remaining;
+   }
+   f->remaining -= ret = count;
+   if (f->header->map != null)
+   {
+      xmemmove(out, f->header->map + f->expectedFilePos, count);
+      f->expectedFilePos += count;
+   }
+   else
+   while (count > 0)
+   {
+      if (zs->avail_in == 0 && !tczReadMore(f))
+      {
+         storedChunkError(f, count);
+         return ret - count;
+      }
+      n = min32(count, (int32)zs->avail_in);
+      xmemmove(out, zs->next_in, n);
+      zs->next_in += n;
+      zs->avail_in -= n;
+      out += n;
+      count -= n;
+   }
+   return ret;
+}
+
 int32 tczRead(TCZFile f, void* outBuf, int32 count)
 {
    int32 err=0;
    z_stream *zs = &f->zs;
+   if (f->stored)
+      return tczReadStored(f, (uint8*)outBuf, count);
    zs->avail_out = count;
    zs->next_out = outBuf;
    if (count == 0)
@@ -153,11 +208,67 @@ int8 tczRead8(TCZFile f)
    return i;
 }
 
+void tczAlign(TCZFile f, int32 n)
+{
+   uint8 pad[8];
+   int32 skip = (n - ((f->expectedFilePos - (int32)f->zs.avail_in) & (n-1))) & (n-1); // the chunks start aligned in the file, so the file position can be used
+   if (skip > 0)
+      tczRead(f, pad, skip);
+}
+
+VoidP tczMap(TCZFile f, int32 count)
+{
+   uint8* p;
+   if (!f->stored || f->header->map == null || count > f->remaining)
+      return null;
+   p = f->header->map + f->expectedFilePos;
+   f->expectedFilePos += count;
+   f->remaining -= count;
+   return p;
+}
+
 #ifndef ANDROID
+static uint8* mapFile(FILE* fin, int32 size)
+{
+#if defined POSIX || defined darwin
+   uint8* map = (uint8*)mmap(null, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fileno(fin), 0);
+   return map == MAP_FAILED ? null : map;
+#elif defined WIN32 && !defined WINCE
+   uint8* map = null;
+   HANDLE h = CreateFileMapping((HANDLE)_get_osfhandle(_fileno(fin)), null, PAGE_WRITECOPY, 0, 0, null);
+   if (h != null)
+   {
+      map = (uint8*)MapViewOfFile(h, FILE_MAP_COPY, 0, 0, 0);
+      CloseHandle(h); // the view keeps the mapping alive
+   }
+   return map;
+#else
+   UNUSED(fin);
+   UNUSED(size);
+   return null;
+#endif
+}
+
+static void unmapFile(uint8* map, int32 size)
+{
+#if defined POSIX || defined darwin
+   munmap(map, size);
+#elif defined WIN32 && !defined WINCE
+   UNUSED(size);
+   UnmapViewOfFile(map);
+#else
+   UNUSED(map);
+   UNUSED(size);
+#endif
+}
+
 static void tczFinalizer(Heap heap, void* bag)
 {
    TCZFileHeader header = (TCZFileHeader)bag;
    UNUSED(heap);
+   if (header->map != null)
+      unmapFile(header->map, header->mapSize);
+   header->map = null;
    fclose(header->fin);
    header->fin = null;
 }
@@ -189,9 +300,9 @@ static TCZFile tczNewInstance(TCZFile parent)
 #endif      
    }
    //debug("tczNewInstance tcz %d from header %d - %d",(int32)ntcz, (int32)ntcz->header, ntcz->header->instanceCount);
+   ntcz->stored = parent != null && (ntcz->header->attr & ATTR_PRELINKED) != 0; // the header itself is always compressed
    ntcz->zs.opaque = ntcz->header->hheap;
-   err = inflateInit(&ntcz->zs);
-   if (err != Z_OK)
+   if (!ntcz->stored && (err = inflateInit(&ntcz->zs)) != Z_OK)
       goto error;
    ntcz->header->instanceCount++;
    return ntcz;
@@ -206,8 +317,10 @@ void tczClose(TCZFile tcz)
    if (tcz)
    {
       //debug("closing tcz %d from header %d - %d",(int32)tcz, (int32)tcz->header, tcz->header->instanceCount);
-      inflateEnd(&tcz->zs);
+      if (!tcz->stored)
+         inflateEnd(&tcz->zs);
       // remove the tcz from the list. Note that the first tcz added is usually the last one deleted; the exception to this is when we get an error while loading the constant pool.
+      LOCKVAR(tcz); // classes are read by many threads
       openTCZs = VoidPsRemove(openTCZs, tcz, null);
       if (--tcz->header->instanceCount == 0) // if there are no more instances, destroy the heap
       {
@@ -216,6 +329,7 @@ void tczClose(TCZFile tcz)
             heapDestroy(tcz->header->cp->heap);
          heapDestroy(tcz->header->hheap);
       }
+      UNLOCKVAR(tcz);
       xfree(tcz);
    }
 }
@@ -243,6 +357,23 @@ static int32 findNamePosition(TCZFile tcz, CharP name)
    }
 }
 
+int32 getTCZSize(TCZFile tcz)
+{
+   Int32Array offsets = tcz->header->offsets;
+   return offsets[ARRAYLEN(offsets)-1]; // the last offset is the end of the file
+}
+
+int32 getTCZHash(TCZFile tcz) // reading the whole file would delay the startup
+{
+   TCZFileHeader h = tcz->header;
+   uint32 n = ARRAYLENV(h->names), i, crc = crc32(0, Z_NULL, 0);
+   crc = crc32(crc, (uint8*)h->offsets, (n+1) * 4);
+   crc = crc32(crc, (uint8*)h->uncompressedSizes, n * 4);
+   for (i = 0; i < n; i++)
+      crc = crc32(crc, (uint8*)h->names[i], xstrlen(h->names[i]) + 1);
+   return (int32)crc;
+}
+
 TCZFile tczFindName(TCZFile tcz, CharP name) // locates the name and also positions the stream at the place to start reading it
 {
    TCZFile ntcz = null;
@@ -254,11 +385,15 @@ TCZFile tczFindName(TCZFile tcz, CharP name) // locates the name and also positi
    ntcz = tczNewInstance(tcz);
    if (!ntcz)
       goto end;
-   ntcz->header->realFilePos = ntcz->expectedFilePos = ntcz->header->offsets[pos];
+   ntcz->expectedFilePos = ntcz->header->offsets[pos];
+   if (ntcz->header->map == null) // a mapped file is never read
+   {
+      ntcz->header->realFilePos = ntcz->expectedFilePos;
 #ifndef ANDROID   
-   fseek(ntcz->header->fin, ntcz->expectedFilePos, SEEK_SET);
+      fseek(ntcz->header->fin, ntcz->expectedFilePos, SEEK_SET);
 #endif   
-   ntcz->uncompressedSize = tcz->header->uncompressedSizes[pos];
+   }
+   ntcz->remaining = ntcz->uncompressedSize = tcz->header->uncompressedSizes[pos];
 end:
    UNLOCKVAR(tcz);
    return ntcz;
@@ -326,9 +461,8 @@ TCZFile tczOpen(FILE* fin, CharP fileName)
    heap = tcz->tempHeap = tcz->header->hheap;
    IF_HEAP_ERROR(heap)
    {
-      heapDestroy(heap);
       //alert("opentcz ERROR: %d\nat %s (%d)",heap->errorCode, heap->errorFile, heap->errorLine);
-      tczClose(tcz);
+      tczClose(tcz); // destroys the heap, which also closes the file
       return null;
    }
    n = tczRead32(tcz);
@@ -350,8 +484,31 @@ TCZFile tczOpen(FILE* fin, CharP fileName)
       *names = (CharP)heapAlloc(heap, len+1);
       tczRead(tcz, *names, len);
    }
+   if ((attr & ATTR_PRELINKED) != 0) // the chunks are used in place, so each one must start aligned and fit before the next one
+   {
+      offsets = tcz->header->offsets;
+      for (i = 0; i < n; i++)
+         if ((offsets[i] & 7) != 0 || tcz->header->uncompressedSizes[i] < 0 || offsets[i] + tcz->header->uncompressedSizes[i] > offsets[i+1])
+            HEAP_ERROR(heap, HEAP_ZIP_ERROR);
+   }
    tcz->tempHeap = null; // not necessary, but safe
    inflateEnd(&tcz->zs);
+#ifndef ANDROID
+   if ((attr & ATTR_PRELINKED) != 0)
+   {
+      int32 size;
+      fseek(fin, 0, SEEK_END);
+      size = (int32)ftell(fin);
+      fseek(fin, tcz->header->realFilePos, SEEK_SET);
+      if (size < tcz->header->offsets[n]) // truncated
+      {
+         tczClose(tcz);
+         return null;
+      }
+      if ((tcz->header->map = mapFile(fin, size)) != null) // if the file can't be mapped, it is read as usual
+         tcz->header->mapSize = size;
+   }
+#endif
    return tcz; // do NOT close this tcz here! it will be closed later
 }
 
@@ -18,6 +18,7 @@
 #define ATTR_WINDOWSIZE_320X480 64
 #define ATTR_WINDOWSIZE_480X640 128
 #define ATTR_WINDOWSIZE_600X800 256
+#define ATTR_PRELINKED 512 // chunks are stored uncompressed and 8-byte aligned; the constant pool and the method code are used in place
 
 #define TCZ_BUFFER_SIZE 4096
 typedef struct TTCZFile TTCZFile;
@@ -38,6 +39,8 @@ struct TTCZFileHeader // common members to all instances
 #else      
    FILE* fin;
 #endif   
+   uint8* map; // the whole file mapped in memory, for prelinked tczs; null if not prelinked or if the platform can't map files
+   int32 mapSize;
    int32 instanceCount;
    int32 realFilePos; // the current seek position
    ConstantPool cp; // this is the Global constant pool that came in this tcz file
@@ -54,6 +57,8 @@ struct TTCZFile
    int32 expectedFilePos; // the expected seek position (may change if several instances are processing the same file)
    Heap tempHeap; // can be assigned by the user to branch to an error handler if something wrong happens
    int32 uncompressedSize;
+   bool stored; // the chunk is not compressed (prelinked tcz)
+   int32 remaining; // bytes left to be read from a stored chunk
    z_stream zs;
 };
 
@@ -69,6 +74,16 @@ int32 tczRead32BE(TCZFile f);
 int16 tczRead16BE(TCZFile f);
 /// Reads a 8-bit value from the given tcz.
 int8  tczRead8(TCZFile f);
+/// Skips the padding that aligns the next read of a stored chunk to the given power of 2 (up to 8).
+void tczAlign(TCZFile f, int32 n);
+/// Returns a pointer to the next count bytes of a stored chunk inside the mapped file, skipping them.
+/// Returns null if the file is not mapped; in this case, the bytes must be read with tczRead.
+VoidP tczMap(TCZFile f, int32 count);
+/// Returns the size of the tcz file, which is the end of its last entry.
+int32 getTCZSize(TCZFile tcz);
+/// Returns the crc32 of the contents table of the tcz (the names, offsets and uncompressed sizes of its entries),
+/// which changes when any entry changes.
+int32 getTCZHash(TCZFile tcz);
 /// Closes a file open by tczFindName and tczOpen
 void tczClose(TCZFile tcz);
 /// Locates the name and also positions the stream at the place to start reading it
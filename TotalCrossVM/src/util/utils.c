@@ -855,6 +855,11 @@ TC_API int32 getTimeStamp()
    return privateGetTimeStamp() - firstTS;
 }
 
+TC_API int64 getTimeStampMicro()
+{
+   return privateGetTimeStampMicro();
+}
+
 #ifndef WIN32
 TC_API void Sleep(uint32 ms)
 {
@@ -928,6 +933,56 @@ TC_API CharP TCHARP2CharPBuf(TCHARP from, CharP to)
 #endif
 }
 
+TC_API CharP String2CharPBufLen(TCObject str, int32 len, CharP buffer)
+{
+   if (!String_isLatin1(str))
+      return buffer == null ? JCharP2CharP(String_charsStart(str), len) : JCharP2CharPBuf(String_charsStart(str), len, buffer);
+   if (buffer != null || (buffer = (CharP)xmalloc(len+1)) != null) // the chars of a compact string are already the bytes
+   {
+      xmemmove(buffer, String_latin1Start(str), len);
+      buffer[len] = 0;
+   }
+   return buffer;
+}
+
+TC_API JCharP String2JCharPBufLen(TCObject str, int32 len, JCharP buffer)
+{
+   uint8* src;
+   JCharP dst;
+   if (buffer == null && (buffer = (JCharP)xmalloc((len+1) << 1)) == null)
+      return null;
+   if (!String_isLatin1(str))
+      JCharPDupBuf(String_charsStart(str), len, buffer);
+   else
+   {
+      for (src = String_latin1Start(str), dst = buffer; len-- > 0;)
+         *dst++ = *src++;
+      *dst = 0;
+   }
+   return buffer;
+}
+
+TC_API TCHARP String2TCHARPBufLen(TCObject str, int32 len, TCHARP buffer)
+{
+#ifdef UNICODE
+   return String2JCharPBufLen(str, len, buffer);
+#else
+   return String2CharPBufLen(str, len, buffer);
+#endif
+}
+
+JCharP String2JCharPBuf(Context currentContext, TCObject str, JCharP buffer, int32 bufLen)
+{
+   int32 len = String_charsLen(str);
+   uint8* src;
+   JCharP dst;
+   if (!String_isLatin1(str) || len > bufLen)
+      return widenString(currentContext, str);
+   for (src = String_latin1Start(str), dst = buffer; len-- > 0;)
+      *dst++ = *src++;
+   return buffer;
+}
+
 TC_API CharP hstrdup(CharP s, Heap h) // duplicates a string allocating from a Heap
 {
    int32 n = (s ? xstrlen(s) : 0) + 1;
@@ -957,6 +1012,20 @@ void jstring2CharPEnv(jstring src, char* dest, JNIEnv* env)
       dest[0] = 0;
    (*env)->ReleaseStringUTFChars(env, src, str);
 }
+jstring String2jstring(JNIEnv* env, TCObject str)
+{
+   jstring ret;
+   JCharP chars;
+   if (str == null)
+      return null;
+   if (!String_isLatin1(str))
+      return (*env)->NewString(env, (jchar*)String_charsStart(str), String_charsLen(str));
+   if ((chars = String2JCharP(str)) == null)
+      return null;
+   ret = (*env)->NewString(env, (jchar*)chars, String_charsLen(str));
+   xfree(chars);
+   return ret;
+}
 #endif
 
 #ifdef ENABLE_TEST_SUITE
@@ -117,6 +117,9 @@ typedef int32 (*getFreeMemoryFunc)(bool maxblock);
 /// Returns a time stamp
 TC_API int32 getTimeStamp();
 typedef int32 (*getTimeStampFunc)();
+/// Returns a time stamp in microseconds, to be used only to compute elapsed times
+TC_API int64 getTimeStampMicro();
+typedef int64 (*getTimeStampMicroFunc)();
 /// Normalizes the path, replacing backslahes with slashes.
 TC_API void normalizePath(TCHARP path);
 typedef void (*normalizePathFunc)(TCHARP path);
@@ -134,11 +137,24 @@ typedef TCHARP (*CharP2TCHARPBufFunc)(CharP from, TCHARP to);
 TC_API CharP TCHARP2CharPBuf(TCHARP from, CharP to);
 typedef CharP (*TCHARP2CharPBufFunc)(TCHARP js, CharP buffer);
 
-/// Handy functions to convert a Java String into a char* and TCHAR*
-#define String2CharP(strObj) JCharP2CharP(String_charsStart(strObj), String_charsLen(strObj))
-#define String2CharPBuf(strObj, buf) JCharP2CharPBuf(String_charsStart(strObj), String_charsLen(strObj), buf)
-#define String2TCHARP(strObj) JCharP2TCHARP(String_charsStart(strObj), String_charsLen(strObj))
-#define String2TCHARPBuf(strObj, buf) JCharP2TCHARPBuf(String_charsStart(strObj), String_charsLen(strObj), buf)
+/// Converts the first len chars of a Java String into a char*, stored in the buffer or in a new one if it is null. Compact strings are not widened.
+TC_API CharP String2CharPBufLen(TCObject str, int32 len, CharP buffer);
+typedef CharP (*String2CharPBufLenFunc)(TCObject str, int32 len, CharP buffer);
+/// Copies the first len chars of a Java String as UTF-16 into the buffer, or into a new one if it is null, ending with 0.
+/// A compact string is widened into the copy and stays compact.
+TC_API JCharP String2JCharPBufLen(TCObject str, int32 len, JCharP buffer);
+/// Calls String2JCharPBufLen in UNICODE platforms and String2CharPBufLen in the others
+TC_API TCHARP String2TCHARPBufLen(TCObject str, int32 len, TCHARP buffer);
+typedef TCHARP (*String2TCHARPBufLenFunc)(TCObject str, int32 len, TCHARP buffer);
+/// Handy macros to convert a whole Java String into a char*, JChar* and TCHAR*
+#define String2CharPBuf(strObj, buf) String2CharPBufLen(strObj, String_charsLen(strObj), buf)
+#define String2CharP(strObj) String2CharPBuf(strObj, null)
+#define String2JCharP(strObj) String2JCharPBufLen(strObj, String_charsLen(strObj), null)
+#define String2TCHARP(strObj) String2TCHARPBufLen(strObj, String_charsLen(strObj), null)
+#define String2TCHARPBuf(strObj, buf) String2TCHARPBufLen(strObj, String_charsLen(strObj), buf)
+/// Returns the UTF-16 chars of a Java String. A compact string with up to bufLen chars is widened into the buffer; a longer one
+/// into a temporary array, as by widenString, so null is returned if there's no memory.
+JCharP String2JCharPBuf(Context currentContext, TCObject str, JCharP buffer, int32 bufLen);
 
 #ifdef WINCE
    #define strcpyTCHAR lstrcpy
@@ -153,6 +169,8 @@ typedef CharP (*TCHARP2CharPBufFunc)(TCHARP js, CharP buffer);
 #ifdef ANDROID
 void jstring2CharP(jstring src, char* dest);
 void jstring2CharPEnv(jstring src, char* dest, JNIEnv* env);
+/// Creates a Java String in the Android VM with the chars of the given one, or returns null if it is null. A compact string is widened into a copy.
+jstring String2jstring(JNIEnv* env, TCObject str);
 #endif
 
 #ifdef __cplusplus
@@ -50,6 +50,16 @@ static int32 privateGetTimeStamp()
    return GetTickCount() & 0x3FFFFFFF;
 }
 
+static int64 privateGetTimeStampMicro()
+{
+   static LARGE_INTEGER freq;
+   LARGE_INTEGER now;
+   if (freq.QuadPart == 0 && !QueryPerformanceFrequency(&freq))
+      return (int64)GetTickCount() * 1000;
+   QueryPerformanceCounter(&now);
+   return (int64)(now.QuadPart / freq.QuadPart * 1000000 + now.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+}
+
 static Err privateListFiles(TCHARP path, int32 slot, TCHARPs** list, int32* count, Heap h, int32 options)
 {
    WIN32_FIND_DATA findData;